@@ -13,6 +13,9 @@
 #include <QtNetwork/QTcpSocket>
 #include <QtCore/QTimer>
 
+#include <array>
+#include <charconv>
+
 QGC_LOGGING_CATEGORY(ADSBTCPLinkLog, "qgc.adsb.adsbtcplink")
 
 ADSBTCPLink::ADSBTCPLink(const QString &hostAddress, quint16 port, QObject *parent)
@@ -64,11 +67,12 @@ ADSBTCPLink::~ADSBTCPLink()
 
 void ADSBTCPLink::_readBytes()
 {
-    while (m_socket && m_socket->canReadLine()) {
-        const QByteArray bytes = m_socket->readLine();
-        m_lineBuffer.append(QString::fromLocal8Bit(bytes));
+    if (!m_socket) {
+        return;
     }
 
+    (void) m_buffer.append(m_socket->readAll());
+
     // Start or restart the timer to process lines
     if (!m_processTimer->isActive()) {
         m_processTimer->start();
@@ -77,148 +81,215 @@ void ADSBTCPLink::_readBytes()
 
 void ADSBTCPLink::_processLines()
 {
-    int linesProcessed = 0;
-    while (!m_lineBuffer.isEmpty() && (linesProcessed < s_maxLinesToProcess)) {
-        const QString line = m_lineBuffer.takeFirst();
-        _parseLine(line);
-        ++linesProcessed;
-    }
-
-    // Stop the timer if there are no more lines to process
-    if (m_lineBuffer.isEmpty()) {
-        m_processTimer->stop();
-    }
-}
-
-void ADSBTCPLink::_parseLine(const QString &line)
-{
-    if (line.size() <= 4) {
-        return;
-    }
-
-    if (!line.startsWith(QStringLiteral("MSG"))) {
-        return;
+    QList<ADSBVehicle::ADSBVehicleInfo_t> updates;
+
+    const QByteArrayView buffer(m_buffer);
+    qsizetype lineStart = 0;
+    qsizetype newline;
+    while ((newline = buffer.indexOf('\n', lineStart)) >= 0) {
+        ADSBVehicle::ADSBVehicleInfo_t adsbInfo;
+        if (ADSB::parseSBS1Line(buffer.sliced(lineStart, newline - lineStart), adsbInfo)) {
+            updates.append(adsbInfo);
+        }
+        lineStart = newline + 1;
     }
 
-    const int msgType = line.at(4).digitValue();
-    if (msgType == ADSB::ADSBMessageType::Unsupported) {
-        qCDebug(ADSBTCPLinkLog) << "ADSB Invalid message type " << msgType;
-        return;
+    // Keep the partial last line for the next read, the buffer keeps its capacity
+    if ((m_buffer.size() - lineStart) > s_maxLineLength) {
+        qCDebug(ADSBTCPLinkLog) << "ADSB dropping" << (m_buffer.size() - lineStart) << "bytes without line ending";
+        m_buffer.clear();
+    } else {
+        (void) m_buffer.remove(0, lineStart);
     }
 
-    // Skip unsupported mesg types to avoid parsing
-    if ((msgType == ADSB::ADSBMessageType::SurfacePosition) || (msgType > ADSB::ADSBMessageType::SurveillanceId)) {
-        return;
-    }
+    // Nothing left to process until more lines arrive
+    m_processTimer->stop();
 
-    qCDebug(ADSBTCPLinkLog) << "ADSB SBS-1" << line;
-
-    const QStringList values = line.split(QChar(','));
-    if (values.size() <= 4) {
-        return;
+    if (!updates.isEmpty()) {
+        emit adsbVehicleUpdates(updates);
     }
+}
 
-    bool icaoOk;
-    const uint32_t icaoAddress = values.at(4).toUInt(&icaoOk, 16);
-    if (!icaoOk) {
-        return;
-    }
-
-    ADSBVehicle::ADSBVehicleInfo_t adsbInfo;
-    adsbInfo.icaoAddress = icaoAddress;
-
-    switch (msgType) {
-        case ADSB::ADSBMessageType::IdentificationAndCategory:
-        case ADSB::ADSBMessageType::SurveillanceAltitude:
-        case ADSB::ADSBMessageType::SurveillanceId:
-            _parseAndEmitCallsign(adsbInfo, values);
-            break;
-
-        case ADSB::ADSBMessageType::AirbornePosition:
-            _parseAndEmitLocation(adsbInfo, values);
-            break;
-
-        case ADSB::ADSBMessageType::AirborneVelocity:
-            _parseAndEmitHeading(adsbInfo, values);
+namespace {
+
+/// Fields of an SBS-1 MSG line
+enum SBS1Field {
+    FieldMessageType    = 1,
+    FieldHexIdent       = 4,
+    FieldCallsign       = 10,
+    FieldAltitude       = 11,
+    FieldTrack          = 13,
+    FieldLatitude       = 14,
+    FieldLongitude      = 15,
+    FieldAlert          = 19,
+    FieldCount          = 22
+};
+
+/// Splits a line into views of its comma separated fields
+///     @return Number of fields found, at most FieldCount
+int _splitFields(QByteArrayView line, std::array<QByteArrayView, FieldCount> &fields)
+{
+    int count = 0;
+    qsizetype fieldStart = 0;
+    while (count < FieldCount) {
+        const qsizetype comma = line.indexOf(',', fieldStart);
+        if (comma < 0) {
+            fields[count++] = line.sliced(fieldStart);
             break;
+        }
+        fields[count++] = line.sliced(fieldStart, comma - fieldStart);
+        fieldStart = comma + 1;
+    }
+    return count;
+}
 
-        default:
-            break;
+/// Converts a whole field to an integer, like QString::toInt surrounding whitespace is ignored
+template<typename T>
+bool _toInteger(QByteArrayView field, T &value, int base = 10)
+{
+    field = field.trimmed();
+    if (field.isEmpty()) {
+        return false;
     }
+    const char *const end = field.data() + field.size();
+    const std::from_chars_result result = std::from_chars(field.data(), end, value, base);
+    return (result.ec == std::errc()) && (result.ptr == end);
 }
 
-void ADSBTCPLink::_parseAndEmitCallsign(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const QStringList &values)
+bool _parseCallsign(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const std::array<QByteArrayView, FieldCount> &fields, int fieldCount)
 {
-    if (values.size() <= 10) {
-        return;
+    if (fieldCount <= FieldCallsign) {
+        return false;
     }
 
-    const QString callsign = values.at(10).trimmed();
+    const QByteArrayView callsign = fields[FieldCallsign].trimmed();
     if (callsign.isEmpty()) {
-        return;
+        return false;
     }
 
-    adsbInfo.callsign = callsign;
+    adsbInfo.callsign = QString::fromLatin1(callsign);
     adsbInfo.availableFlags = ADSBVehicle::CallsignAvailable;
 
-    emit adsbVehicleUpdate(adsbInfo);
+    return true;
 }
 
-void ADSBTCPLink::_parseAndEmitLocation(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const QStringList &values)
+bool _parseLocation(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const std::array<QByteArrayView, FieldCount> &fields, int fieldCount)
 {
-    if (values.size() <= 19) {
-        return;
+    if (fieldCount <= FieldAlert) {
+        return false;
     }
 
     // Altitude is either Barometric - based on pressure, in ft
     // or HAE - as reported by GPS - based on WGS84 Ellipsoid, in ft
-    // If altitude ends with H, we have HAE
-    // There's a slight difference between Barometric alt and HAE, but it would require
-    // knowledge about Geoid shape in particular Lat, Lon. It's not worth complicating the code
-    QString altitudeStr = values.at(11);
-    if (altitudeStr.endsWith('H')) {
+    // If altitude ends with H, we have HAE. The difference between HAE and AMSL would require
+    // knowledge about Geoid shape in particular Lat, Lon. It's not worth complicating the code,
+    // but barometric altitude must not be compared against GPS altitude as is.
+    QByteArrayView altitudeStr = fields[FieldAltitude].trimmed();
+    const bool geometricAltitude = altitudeStr.endsWith('H');
+    if (geometricAltitude) {
         altitudeStr.chop(1);
     }
 
-    bool altOk, latOk, lonOk, alertOk;
-    const int modeCAltitude = altitudeStr.toInt(&altOk);
-    const double lat = values.at(14).toDouble(&latOk);
-    const double lon = values.at(15).toDouble(&lonOk);
-    const int alert = values.at(19).toInt(&alertOk);
+    // std::from_chars for floating point is still missing from some of the standard libraries we
+    // build with, QByteArrayView::toDouble doesn't allocate either
+    int modeCAltitude = 0;
+    int alert = 0;
+    bool latOk, lonOk;
+    const bool altOk = _toInteger(altitudeStr, modeCAltitude);
+    const double lat = fields[FieldLatitude].toDouble(&latOk);
+    const double lon = fields[FieldLongitude].toDouble(&lonOk);
+    const bool alertOk = _toInteger(fields[FieldAlert], alert);
 
     if (!altOk || !latOk || !lonOk || !alertOk) {
-        return;
+        return false;
     }
 
     if (qFuzzyIsNull(lat) && qFuzzyIsNull(lon)) {
-        return;
+        return false;
     }
 
-    const double altitude = modeCAltitude * 0.3048;
-    const QGeoCoordinate location(lat, lon);
-
-    adsbInfo.location = location;
-    adsbInfo.altitude = altitude;
+    adsbInfo.location = QGeoCoordinate(lat, lon);
+    adsbInfo.altitude = modeCAltitude * 0.3048;
     adsbInfo.alert = (alert == 1);
     adsbInfo.availableFlags = ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable | ADSBVehicle::AlertAvailable;
+    if (geometricAltitude) {
+        adsbInfo.availableFlags |= ADSBVehicle::AltitudeGeometric;
+    }
 
-    emit adsbVehicleUpdate(adsbInfo);
+    return true;
 }
 
-void ADSBTCPLink::_parseAndEmitHeading(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const QStringList &values)
+bool _parseHeading(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const std::array<QByteArrayView, FieldCount> &fields, int fieldCount)
 {
-    if (values.size() <= 13) {
-        return;
+    if (fieldCount <= FieldTrack) {
+        return false;
     }
 
     bool headingOk;
-    const double heading = values.at(13).toDouble(&headingOk);
+    const double heading = fields[FieldTrack].toDouble(&headingOk);
     if (!headingOk) {
-        return;
+        return false;
     }
 
     adsbInfo.heading = heading;
     adsbInfo.availableFlags = ADSBVehicle::HeadingAvailable;
 
-    emit adsbVehicleUpdate(adsbInfo);
+    return true;
+}
+
+} // namespace
+
+bool ADSB::parseSBS1Line(QByteArrayView line, ADSBVehicle::ADSBVehicleInfo_t &adsbInfo)
+{
+    line = line.trimmed();
+    if (line.size() <= 4) {
+        return false;
+    }
+
+    if (!line.startsWith("MSG")) {
+        return false;
+    }
+
+    const char typeChar = line.at(4);
+    if ((typeChar < '0') || (typeChar > '9')) {
+        qCDebug(ADSBTCPLinkLog) << "ADSB Invalid message type " << typeChar;
+        return false;
+    }
+    const int msgType = typeChar - '0';
+
+    // Skip unsupported mesg types to avoid parsing
+    if ((msgType == ADSB::ADSBMessageType::SurfacePosition) || (msgType > ADSB::ADSBMessageType::SurveillanceId)) {
+        return false;
+    }
+
+    qCDebug(ADSBTCPLinkLog) << "ADSB SBS-1" << line;
+
+    std::array<QByteArrayView, FieldCount> fields;
+    const int fieldCount = _splitFields(line, fields);
+    if (fieldCount <= FieldHexIdent) {
+        return false;
+    }
+
+    uint32_t icaoAddress = 0;
+    if (!_toInteger(fields[FieldHexIdent], icaoAddress, 16)) {
+        return false;
+    }
+
+    adsbInfo.icaoAddress = icaoAddress;
+
+    switch (msgType) {
+        case ADSB::ADSBMessageType::IdentificationAndCategory:
+        case ADSB::ADSBMessageType::SurveillanceAltitude:
+        case ADSB::ADSBMessageType::SurveillanceId:
+            return _parseCallsign(adsbInfo, fields, fieldCount);
+
+        case ADSB::ADSBMessageType::AirbornePosition:
+            return _parseLocation(adsbInfo, fields, fieldCount);
+
+        case ADSB::ADSBMessageType::AirborneVelocity:
+            return _parseHeading(adsbInfo, fields, fieldCount);
+
+        default:
+            return false;
+    }
 }
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <QtCore/QByteArray>
+#include <QtCore/QByteArrayView>
 #include <QtCore/QLoggingCategory>
 
 #include "ADSBVehicle.h"
@@ -31,6 +33,13 @@ enum ADSBMessageType {
     Unsupported = -1
 };
 
+/// Parses a line of SBS-1 (BaseStation) data in place. Fields are looked at through views into the
+/// line, nothing is allocated except the callsign string of identification messages.
+///     @param line The line to parse, with or without the line ending.
+///     @param adsbInfo The ADS-B vehicle info structure to fill in.
+///     @return true if the line held an update.
+bool parseSBS1Line(QByteArrayView line, ADSBVehicle::ADSBVehicleInfo_t &adsbInfo);
+
 } // namespace ADSB
 
 /// The ADSBTCPLink class handles the TCP connection to an ADS-B server
@@ -50,9 +59,9 @@ public:
     ~ADSBTCPLink();
 
 signals:
-    /// Emitted when an ADS-B vehicle update is received.
-    ///     @param vehicleInfo The updated vehicle information.
-    void adsbVehicleUpdate(const ADSBVehicle::ADSBVehicleInfo_t &vehicleInfo);
+    /// Emitted once per processing interval with the updates parsed from all buffered lines.
+    ///     @param vehicleInfos The updated vehicle information, in the order received.
+    void adsbVehicleUpdates(const QList<ADSBVehicle::ADSBVehicleInfo_t> &vehicleInfos);
 
     /// Emitted when an error occurs.
     ///     @param errorMsg The error message.
@@ -62,33 +71,14 @@ private slots:
     /// Reads bytes from the TCP socket.
     void _readBytes();
 
-    /// Processes buffered lines of ADS-B data.
+    /// Parses all buffered lines of ADS-B data and emits the updates as one batch.
     void _processLines();
 
 private:
-    /// Parses a line of ADS-B data.
-    ///     @param line The line to parse.
-    void _parseLine(const QString &line);
-
-    /// Parses and emits the callsign from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitCallsign(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const QStringList &values);
-
-    /// Parses and emits the location from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitLocation(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const QStringList &values);
-
-    /// Parses and emits the heading from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitHeading(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, const QStringList &values);
-
     QTcpSocket *m_socket = nullptr;     ///< Pointer to the TCP socket used for connection
     QTimer *m_processTimer = nullptr;   ///< Timer for periodic processing of ADS-B data
-    QStringList m_lineBuffer;           ///< Buffer for storing incoming lines of ADS-B data
+    QByteArray m_buffer;                ///< Bytes received but not processed yet, ends with a partial line
 
     static constexpr int s_processInterval = 50;     ///< Interval for processing lines
-    static constexpr int s_maxLinesToProcess = 100;  ///< Maximum number of lines to process per timer timeout
+    static constexpr qsizetype s_maxLineLength = 1024;  ///< Longer partial lines are dropped as garbage
 };
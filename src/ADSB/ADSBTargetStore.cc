@@ -0,0 +1,210 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBTargetStore.h"
+
+#include <QtCore/QtMath>
+#include <QtCore/QtNumeric>
+
+/// Meters per degree of latitude, and of longitude at the equator
+static constexpr double kMetersPerDegree = 111320.0;
+
+int ADSBTargetStore::update(const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo, qint64 nowMSecs)
+{
+    int index = indexOf(vehicleInfo.icaoAddress);
+    if (index < 0) {
+        index = count();
+        _icaoAddress.push_back(vehicleInfo.icaoAddress);
+        _latitude.push_back(qQNaN());
+        _longitude.push_back(qQNaN());
+        _altitude.push_back(qQNaN());
+        _heading.push_back(qQNaN());
+        _callsign.emplace_back();
+        _alert.push_back(0);
+        _availableFlags.push_back(0);
+        _lastUpdateMSecs.push_back(nowMSecs);
+        _icaoToIndex.insert(vehicleInfo.icaoAddress, index);
+    }
+
+    uint32_t flags = vehicleInfo.availableFlags;
+    if (!(flags & ADSBVehicle::AltitudeAvailable)) {
+        // The altitude reference only means something together with an altitude
+        flags &= ~static_cast<uint32_t>(ADSBVehicle::AltitudeGeometric);
+    }
+    if (flags & ADSBVehicle::CallsignAvailable) {
+        _callsign[index] = vehicleInfo.callsign;
+    }
+    if (flags & ADSBVehicle::LocationAvailable) {
+        const double latitude = vehicleInfo.location.latitude();
+        const double longitude = vehicleInfo.location.longitude();
+        if (!hasLocation(index) || (_latCell(latitude) != _latCell(_latitude[index])) || (_lonCell(longitude) != _lonCell(_longitude[index]))) {
+            _indexDirty = true;
+        }
+        _latitude[index] = latitude;
+        _longitude[index] = longitude;
+    }
+    if (flags & ADSBVehicle::AltitudeAvailable) {
+        _altitude[index] = vehicleInfo.altitude;
+        // The reference comes with each altitude, it isn't sticky like the other flags
+        _availableFlags[index] &= ~static_cast<uint32_t>(ADSBVehicle::AltitudeGeometric);
+    }
+    if (flags & ADSBVehicle::HeadingAvailable) {
+        _heading[index] = vehicleInfo.heading;
+    }
+    if (flags & ADSBVehicle::AlertAvailable) {
+        _alert[index] = vehicleInfo.alert ? 1 : 0;
+    }
+    _availableFlags[index] |= flags;
+    _lastUpdateMSecs[index] = nowMSecs;
+
+    return index;
+}
+
+void ADSBTargetStore::removeAt(int index)
+{
+    if ((index < 0) || (index >= count())) {
+        return;
+    }
+
+    (void) _icaoToIndex.remove(_icaoAddress[index]);
+
+    const int last = count() - 1;
+    if (index != last) {
+        _icaoAddress[index]     = _icaoAddress[last];
+        _latitude[index]        = _latitude[last];
+        _longitude[index]       = _longitude[last];
+        _altitude[index]        = _altitude[last];
+        _heading[index]         = _heading[last];
+        _callsign[index]        = std::move(_callsign[last]);
+        _alert[index]           = _alert[last];
+        _availableFlags[index]  = _availableFlags[last];
+        _lastUpdateMSecs[index] = _lastUpdateMSecs[last];
+        _icaoToIndex[_icaoAddress[index]] = index;
+    }
+
+    _icaoAddress.pop_back();
+    _latitude.pop_back();
+    _longitude.pop_back();
+    _altitude.pop_back();
+    _heading.pop_back();
+    _callsign.pop_back();
+    _alert.pop_back();
+    _availableFlags.pop_back();
+    _lastUpdateMSecs.pop_back();
+
+    // Indices held by the grid moved
+    _indexDirty = true;
+}
+
+QList<uint32_t> ADSBTargetStore::expired(qint64 nowMSecs, qint64 timeoutMSecs) const
+{
+    QList<uint32_t> icaoAddresses;
+    for (size_t i = 0; i < _lastUpdateMSecs.size(); i++) {
+        if ((nowMSecs - _lastUpdateMSecs[i]) > timeoutMSecs) {
+            icaoAddresses.append(_icaoAddress[i]);
+        }
+    }
+    return icaoAddresses;
+}
+
+ADSBVehicle::ADSBVehicleInfo_t ADSBTargetStore::info(int index) const
+{
+    ADSBVehicle::ADSBVehicleInfo_t vehicleInfo;
+    vehicleInfo.icaoAddress     = _icaoAddress[index];
+    vehicleInfo.callsign        = _callsign[index];
+    vehicleInfo.location        = QGeoCoordinate(_latitude[index], _longitude[index]);
+    vehicleInfo.altitude        = _altitude[index];
+    vehicleInfo.heading         = _heading[index];
+    vehicleInfo.alert           = _alert[index] != 0;
+    vehicleInfo.availableFlags  = _availableFlags[index];
+    return vehicleInfo;
+}
+
+QList<int> ADSBTargetStore::targetsWithin(const QGeoCoordinate& coordinate, double radiusMeters)
+{
+    QList<int> indices;
+    if (!coordinate.isValid() || (radiusMeters < 0)) {
+        return indices;
+    }
+
+    if (_indexDirty) {
+        _rebuildIndex();
+    }
+
+    const double latSpan = radiusMeters / kMetersPerDegree;
+    const double cosLat = qCos(qDegreesToRadians(coordinate.latitude()));
+    const double lonSpan = (cosLat > 0.01) ? (radiusMeters / (kMetersPerDegree * cosLat)) : 360.0;
+    const int lonCellCount = _lonCellCount();
+
+    const int minLatCell = _latCell(coordinate.latitude() - latSpan);
+    const int maxLatCell = _latCell(coordinate.latitude() + latSpan);
+    int minLonCell = _lonCell(coordinate.longitude() - lonSpan);
+    int maxLonCell = _lonCell(coordinate.longitude() + lonSpan);
+    if ((maxLonCell - minLonCell + 1) >= lonCellCount) {
+        // Close to the poles or a huge radius, every longitude
+        minLonCell = _lonCell(-180.0);
+        maxLonCell = minLonCell + lonCellCount - 1;
+    }
+
+    for (int latCell = minLatCell; latCell <= maxLatCell; latCell++) {
+        for (int lonCell = minLonCell; lonCell <= maxLonCell; lonCell++) {
+            // Cells past the antimeridian wrap around
+            const auto it = _grid.constFind(_cellKey(latCell, _wrapLonCell(lonCell)));
+            if (it == _grid.constEnd()) {
+                continue;
+            }
+            for (const int index : it.value()) {
+                const QGeoCoordinate target(_latitude[index], _longitude[index]);
+                if (coordinate.distanceTo(target) <= radiusMeters) {
+                    indices.append(index);
+                }
+            }
+        }
+    }
+
+    return indices;
+}
+
+void ADSBTargetStore::_rebuildIndex()
+{
+    _grid.clear();
+    for (int i = 0; i < count(); i++) {
+        if (hasLocation(i)) {
+            _grid[_cellKey(_latCell(_latitude[i]), _wrapLonCell(_lonCell(_longitude[i])))].append(i);
+        }
+    }
+    _indexDirty = false;
+}
+
+quint64 ADSBTargetStore::_cellKey(int latCell, int lonCell) const
+{
+    return (static_cast<quint64>(static_cast<uint32_t>(latCell)) << 32) | static_cast<uint32_t>(lonCell);
+}
+
+int ADSBTargetStore::_latCell(double latitude) const
+{
+    return qFloor(latitude / _cellDegrees);
+}
+
+int ADSBTargetStore::_lonCell(double longitude) const
+{
+    return qFloor(longitude / _cellDegrees);
+}
+
+int ADSBTargetStore::_lonCellCount() const
+{
+    return qCeil(360.0 / _cellDegrees);
+}
+
+int ADSBTargetStore::_wrapLonCell(int lonCell) const
+{
+    const int lonCellCount = _lonCellCount();
+    const int westCell = _lonCell(-180.0);
+    return westCell + ((((lonCell - westCell) % lonCellCount) + lonCellCount) % lonCellCount);
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtPositioning/QGeoCoordinate>
+
+#include <vector>
+
+#include "ADSBVehicle.h"
+
+/// Compact store of ADS-B targets, one array per field. Scans over all targets like expiry and
+/// proximity only touch the fields they need. Targets are addressed by index, removing a target
+/// moves the last one into its place.
+///
+/// Targets with a location are also kept in a uniform latitude/longitude grid, so radius queries
+/// only look at the targets in the cells the radius overlaps instead of all of them.
+class ADSBTargetStore
+{
+public:
+    ADSBTargetStore() = default;
+
+    static constexpr double defaultCellDegrees = 0.1;
+
+    int count(void) const { return static_cast<int>(_icaoAddress.size()); }
+
+    /// @return Index of the target, -1 if not found
+    int indexOf(uint32_t icaoAddress) const { return _icaoToIndex.value(icaoAddress, -1); }
+
+    /// Adds the target if needed and applies the fields set in vehicleInfo.availableFlags
+    ///     @return Index of the target
+    int update(const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo, qint64 nowMSecs);
+
+    void removeAt(int index);
+
+    /// @return ICAO addresses of the targets without an update for timeoutMSecs
+    QList<uint32_t> expired(qint64 nowMSecs, qint64 timeoutMSecs) const;
+
+    /// @return All known fields of the target, with availableFlags set for them
+    ADSBVehicle::ADSBVehicleInfo_t info(int index) const;
+
+    uint32_t    icaoAddress     (int index) const { return _icaoAddress[index]; }
+    double      latitude        (int index) const { return _latitude[index]; }
+    double      longitude       (int index) const { return _longitude[index]; }
+    double      altitude        (int index) const { return _altitude[index]; }     ///< NaN for not available
+    double      heading         (int index) const { return _heading[index]; }      ///< NaN for not available
+    bool        hasLocation     (int index) const { return _availableFlags[index] & ADSBVehicle::LocationAvailable; }
+    bool        altitudeGeometric(int index) const { return _availableFlags[index] & ADSBVehicle::AltitudeGeometric; }   ///< false: barometric
+
+    /// @return Indices of the targets within radiusMeters horizontal distance of coordinate
+    QList<int> targetsWithin(const QGeoCoordinate& coordinate, double radiusMeters);
+
+    /// Grid cell size in degrees, 0.1 degree is about 11 km north/south
+    void setCellDegrees(double cellDegrees) { _cellDegrees = cellDegrees; _indexDirty = true; }
+
+private:
+    void            _rebuildIndex   (void);
+    quint64         _cellKey        (int latCell, int lonCell) const;
+    int             _latCell        (double latitude) const;
+    int             _lonCell        (double longitude) const;
+    int             _lonCellCount   (void) const;
+    int             _wrapLonCell    (int lonCell) const;
+
+    std::vector<uint32_t>   _icaoAddress;
+    std::vector<double>     _latitude;
+    std::vector<double>     _longitude;
+    std::vector<double>     _altitude;
+    std::vector<double>     _heading;
+    std::vector<QString>    _callsign;
+    std::vector<uint8_t>    _alert;
+    std::vector<uint32_t>   _availableFlags;
+    std::vector<qint64>     _lastUpdateMSecs;
+
+    QHash<uint32_t, int>        _icaoToIndex;
+    QHash<quint64, QList<int>>  _grid;          ///< Target indices by grid cell
+    bool                        _indexDirty     = true;
+    double                      _cellDegrees    = defaultCellDegrees;
+};
@@ -60,14 +60,23 @@ void ADSBVehicle::update(const ADSBVehicleInfo_t & vehicleInfo)
     }
     if (vehicleInfo.availableFlags & AlertAvailable) {
         if (vehicleInfo.alert != _alert) {
+            const bool oldAlert = alert();
             _alert = vehicleInfo.alert;
-            emit alertChanged();
+            if (alert() != oldAlert) {
+                emit alertChanged();
+            }
         }
     }
-    _lastUpdateTimer.restart();
 }
 
-bool ADSBVehicle::expired()
+void ADSBVehicle::setConflict(bool conflict)
 {
-    return _lastUpdateTimer.hasExpired(expirationTimeoutMs);
+    if (conflict != _conflict) {
+        const bool oldAlert = alert();
+        _conflict = conflict;
+        if (alert() != oldAlert) {
+            emit alertChanged();
+        }
+    }
 }
+
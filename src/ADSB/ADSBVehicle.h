@@ -10,7 +10,6 @@
 #pragma once
 
 #include <QtCore/QObject>
-#include <QtCore/QElapsedTimer>
 #include <QtCore/QLoggingCategory>
 #include <QtPositioning/QGeoCoordinate>
 
@@ -25,7 +24,7 @@ class ADSBVehicle : public QObject
     Q_PROPERTY(QGeoCoordinate   coordinate  READ coordinate     NOTIFY coordinateChanged)
     Q_PROPERTY(double           altitude    READ altitude       NOTIFY altitudeChanged)     // NaN for not available
     Q_PROPERTY(double           heading     READ heading        NOTIFY headingChanged)      // NaN for not available
-    Q_PROPERTY(bool             alert       READ alert          NOTIFY alertChanged)        // Collision path
+    Q_PROPERTY(bool             alert       READ alert          NOTIFY alertChanged)        // Collision path, reported or too close to one of our vehicles
 
 public:
     typedef struct {
@@ -47,6 +46,7 @@ public:
         AltitudeAvailable =     1 << 3,
         HeadingAvailable =      1 << 4,
         AlertAvailable =        1 << 5,
+        AltitudeGeometric =     1 << 6,     ///< Altitude is geometric (GNSS), otherwise barometric pressure altitude
     };
 
     int             icaoAddress (void) const { return static_cast<int>(_icaoAddress); }
@@ -54,12 +54,12 @@ public:
     QGeoCoordinate  coordinate  (void) const { return _coordinate; }
     double          altitude    (void) const { return _altitude; }
     double          heading     (void) const { return _heading; }
-    bool            alert       (void) const { return _alert; }
+    bool            alert       (void) const { return _alert || _conflict; }
 
     void update(const ADSBVehicleInfo_t &vehicleInfo);
 
-    /// check if the vehicle is expired and should be removed
-    bool expired();
+    /// Set by ADSBVehicleManager while the target is in conflict with one of our vehicles
+    void setConflict(bool conflict);
 
 signals:
     void coordinateChanged();
@@ -75,10 +75,7 @@ private:
     double          _altitude;
     double          _heading;
     bool            _alert;
-
-    QElapsedTimer   _lastUpdateTimer;
-
-    static constexpr qint64 expirationTimeoutMs = 120000;   ///< timeout with no update in ms after which the vehicle is removed.
+    bool            _conflict = false;
 };
 
 Q_DECLARE_METATYPE(ADSBVehicle::ADSBVehicleInfo_t)
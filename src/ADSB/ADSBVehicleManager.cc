@@ -14,11 +14,36 @@
 #include "ADSBTCPLink.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtCore/QtNumeric>
+
 QGC_LOGGING_CATEGORY(ADSBVehicleManagerLog, "qgc.adsb.adsbvehiclemanager")
 
+/// Copies the fields available in from over into
+static void _mergeVehicleInfo(ADSBVehicle::ADSBVehicleInfo_t& into, const ADSBVehicle::ADSBVehicleInfo_t& from)
+{
+    if (from.availableFlags & ADSBVehicle::CallsignAvailable) {
+        into.callsign = from.callsign;
+    }
+    if (from.availableFlags & ADSBVehicle::LocationAvailable) {
+        into.location = from.location;
+    }
+    if (from.availableFlags & ADSBVehicle::AltitudeAvailable) {
+        into.altitude = from.altitude;
+        into.availableFlags &= ~static_cast<uint32_t>(ADSBVehicle::AltitudeGeometric);
+    }
+    if (from.availableFlags & ADSBVehicle::HeadingAvailable) {
+        into.heading = from.heading;
+    }
+    if (from.availableFlags & ADSBVehicle::AlertAvailable) {
+        into.alert = from.alert;
+    }
+    into.availableFlags |= from.availableFlags;
+}
+
 ADSBVehicleManager::ADSBVehicleManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
 {
+    _clock.start();
 }
 
 void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
@@ -28,23 +53,35 @@ void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
     _adsbVehicleCleanupTimer.setSingleShot(false);
     _adsbVehicleCleanupTimer.start(1000);
 
+    connect(&_updateTimer, &QTimer::timeout, this, &ADSBVehicleManager::_applyPendingUpdates);
+    _updateTimer.setSingleShot(false);
+    _updateTimer.start(updateIntervalMSecs);
+
     ADSBVehicleManagerSettings* settings = toolbox->settingsManager()->adsbVehicleManagerSettings();
     if (settings->adsbServerConnectEnabled()->rawValue().toBool()) {
         _tcpLink = new ADSBTCPLink(settings->adsbServerHostAddress()->rawValue().toString(), settings->adsbServerPort()->rawValue().toUInt(), this);
-        connect(_tcpLink, &ADSBTCPLink::adsbVehicleUpdate,  this, &ADSBVehicleManager::adsbVehicleUpdate,   Qt::AutoConnection);
+        connect(_tcpLink, &ADSBTCPLink::adsbVehicleUpdates, this, &ADSBVehicleManager::adsbVehicleUpdates,  Qt::AutoConnection);
         connect(_tcpLink, &ADSBTCPLink::errorOccurred, this, &ADSBVehicleManager::_tcpError, Qt::AutoConnection);
     }
 }
 
 void ADSBVehicleManager::_cleanupStaleVehicles()
+{
+    _removeExpired(_clock.elapsed());
+}
+
+void ADSBVehicleManager::_removeExpired(qint64 nowMSecs)
 {
     // Remove all expired ADSB vehicles
-    for (int i=_adsbVehicles.count()-1; i>=0; i--) {
-        ADSBVehicle* adsbVehicle = _adsbVehicles.value<ADSBVehicle*>(i);
-        if (adsbVehicle->expired()) {
-            qCDebug(ADSBVehicleManagerLog) << "Expired " << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
-            _adsbVehicles.removeAt(i);
-            _adsbICAOMap.remove(adsbVehicle->icaoAddress());
+    const QList<uint32_t> expired = _targets.expired(nowMSecs, expirationTimeoutMSecs);
+    for (const uint32_t icaoAddress : expired) {
+        qCDebug(ADSBVehicleManagerLog) << "Expired " << QStringLiteral("%1").arg(icaoAddress, 0, 16);
+        _targets.removeAt(_targets.indexOf(icaoAddress));
+        (void) _pendingUpdates.remove(icaoAddress);
+        (void) _conflicts.remove(icaoAddress);
+        ADSBVehicle* adsbVehicle = _adsbICAOMap.take(icaoAddress);
+        if (adsbVehicle) {
+            (void) _adsbVehicles.removeOne(adsbVehicle);
             adsbVehicle->deleteLater();
         }
     }
@@ -52,18 +89,134 @@ void ADSBVehicleManager::_cleanupStaleVehicles()
 
 void ADSBVehicleManager::adsbVehicleUpdate(const ADSBVehicle::ADSBVehicleInfo_t vehicleInfo)
 {
-    uint32_t icaoAddress = vehicleInfo.icaoAddress;
-
-    if (_adsbICAOMap.contains(icaoAddress)) {
-        _adsbICAOMap[icaoAddress]->update(vehicleInfo);
+    const auto it = _pendingUpdates.find(vehicleInfo.icaoAddress);
+    if (it == _pendingUpdates.end()) {
+        _pendingUpdates.insert(vehicleInfo.icaoAddress, vehicleInfo);
     } else {
-        if (vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable) {
-            ADSBVehicle* adsbVehicle = new ADSBVehicle(vehicleInfo, this);
-            _adsbICAOMap[icaoAddress] = adsbVehicle;
-            _adsbVehicles.append(adsbVehicle);
-            qCDebug(ADSBVehicleManagerLog) << "Added " << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
+        _mergeVehicleInfo(it.value(), vehicleInfo);
+    }
+}
+
+void ADSBVehicleManager::adsbVehicleUpdates(const QList<ADSBVehicle::ADSBVehicleInfo_t>& vehicleInfos)
+{
+    for (const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo : vehicleInfos) {
+        adsbVehicleUpdate(vehicleInfo);
+    }
+}
+
+void ADSBVehicleManager::_applyPendingUpdates()
+{
+    if (!_pendingUpdates.isEmpty()) {
+        const qint64 now = _clock.elapsed();
+        QList<QObject*> added;
+
+        for (auto it = _pendingUpdates.cbegin(); it != _pendingUpdates.cend(); ++it) {
+            const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo = it.value();
+
+            // Targets only show up once their location is known
+            if ((_targets.indexOf(vehicleInfo.icaoAddress) < 0) && !(vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable)) {
+                continue;
+            }
+            const int index = _targets.update(vehicleInfo, now);
+
+            ADSBVehicle* adsbVehicle = _adsbICAOMap.value(vehicleInfo.icaoAddress);
+            if (adsbVehicle) {
+                adsbVehicle->update(vehicleInfo);
+            } else {
+                adsbVehicle = new ADSBVehicle(_targets.info(index), this);
+                _adsbICAOMap[vehicleInfo.icaoAddress] = adsbVehicle;
+                added.append(adsbVehicle);
+                qCDebug(ADSBVehicleManagerLog) << "Added " << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
+            }
+        }
+        _pendingUpdates.clear();
+
+        if (!added.isEmpty()) {
+            _adsbVehicles.append(added);
+        }
+    }
+
+    _updateConflicts();
+}
+
+QList<uint32_t> ADSBVehicleManager::trafficWithin(const QGeoCoordinate& coordinate, double radiusMeters)
+{
+    QList<uint32_t> icaoAddresses;
+    const QList<int> indices = _targets.targetsWithin(coordinate, radiusMeters);
+    for (const int index : indices) {
+        icaoAddresses.append(_targets.icaoAddress(index));
+    }
+    return icaoAddresses;
+}
+
+void ADSBVehicleManager::ownShipUpdate(int vehicleId, const OwnShip_t& ownShip)
+{
+    _ownShips[vehicleId] = ownShip;
+}
+
+void ADSBVehicleManager::ownShipRemoved(int vehicleId)
+{
+    (void) _ownShips.remove(vehicleId);
+}
+
+bool ADSBVehicleManager::_verticallySeparated(const OwnShip_t& ownShip, int index) const
+{
+    const double targetAltitude = _targets.altitude(index);
+    if (qIsNaN(ownShip.altitude) || qIsNaN(targetAltitude)) {
+        return false;
+    }
+
+    // Own altitude is from GPS, only geometric target altitudes are directly comparable with it
+    const double separationMeters = _targets.altitudeGeometric(index) ? conflictAltitudeMeters : (conflictAltitudeMeters + pressureAltitudeMarginMeters);
+    return qAbs(targetAltitude - ownShip.altitude) > separationMeters;
+}
+
+void ADSBVehicleManager::_updateConflicts()
+{
+    QSet<uint32_t> conflicts;
+
+    if (_targets.count() > 0) {
+        for (auto it = _ownShips.cbegin(); it != _ownShips.cend(); ++it) {
+            const OwnShip_t& ownShip = it.value();
+            if (!ownShip.coordinate.isValid()) {
+                continue;
+            }
+
+            const QList<int> nearby = _targets.targetsWithin(ownShip.coordinate, conflictRadiusMeters);
+            for (const int index : nearby) {
+                const uint32_t icaoAddress = _targets.icaoAddress(index);
+                // A vehicle with ADS-B out sees its own transponder
+                if ((ownShip.icaoAddress != 0) && (icaoAddress == ownShip.icaoAddress)) {
+                    continue;
+                }
+                if (_verticallySeparated(ownShip, index)) {
+                    continue;
+                }
+                conflicts.insert(icaoAddress);
+            }
+        }
+    }
+
+    if (conflicts == _conflicts) {
+        return;
+    }
+
+    for (const uint32_t icaoAddress : std::as_const(_conflicts)) {
+        if (!conflicts.contains(icaoAddress)) {
+            if (ADSBVehicle* adsbVehicle = _adsbICAOMap.value(icaoAddress)) {
+                adsbVehicle->setConflict(false);
+            }
+        }
+    }
+    for (const uint32_t icaoAddress : std::as_const(conflicts)) {
+        if (!_conflicts.contains(icaoAddress)) {
+            qCDebug(ADSBVehicleManagerLog) << "Conflict " << QStringLiteral("%1").arg(icaoAddress, 0, 16);
+            if (ADSBVehicle* adsbVehicle = _adsbICAOMap.value(icaoAddress)) {
+                adsbVehicle->setConflict(true);
+            }
         }
     }
+    _conflicts = conflicts;
 }
 
 void ADSBVehicleManager::_tcpError(const QString errorMsg)
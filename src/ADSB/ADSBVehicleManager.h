@@ -9,22 +9,36 @@
 
 #pragma once
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QTimer>
 #include <QtCore/QLoggingCategory>
 
 #include "QGCToolbox.h"
 #include "QmlObjectListModel.h"
+#include "ADSBTargetStore.h"
 #include "ADSBVehicle.h"
 
 Q_DECLARE_LOGGING_CATEGORY(ADSBVehicleManagerLog)
 
 class ADSBTCPLink;
 
+/// Tracks ADS-B traffic from the ADS-B server and from our vehicles.
+///
+/// Updates are queued and applied together on the update tick, so a busy feed changes each target
+/// at most once per tick. Targets are held in an ADSBTargetStore, the ADSBVehicle objects in
+/// adsbVehicles only mirror it for the map. Each tick the store's spatial index is used to find
+/// traffic close to our vehicles, which is flagged as an alert.
+///
+/// Our vehicles report their own position through ownShipUpdate, so this doesn't depend on Vehicle.
 class ADSBVehicleManager : public QGCTool
 {
     Q_OBJECT
     Q_PROPERTY(QmlObjectListModel* adsbVehicles READ adsbVehicles CONSTANT)
 
+    friend class ADSBVehicleManagerTest;    // Unit test
+
 public:
     ADSBVehicleManager(QGCApplication* app, QGCToolbox* toolbox);
 
@@ -32,16 +46,51 @@ public:
 
     QmlObjectListModel* adsbVehicles(void) { return &_adsbVehicles; }
 
+    /// @return ICAO addresses of the traffic within radiusMeters horizontal distance of coordinate
+    QList<uint32_t> trafficWithin(const QGeoCoordinate& coordinate, double radiusMeters);
+
+    typedef struct {
+        QGeoCoordinate  coordinate;
+        double          altitude;       ///< Geometric (GPS) altitude AMSL, NaN for not available
+        uint32_t        icaoAddress;    ///< Our own transponder, 0 for not known
+    } OwnShip_t;
+
+    /// Position of one of our vehicles, checked against traffic on each update tick
+    void ownShipUpdate(int vehicleId, const OwnShip_t& ownShip);
+    void ownShipRemoved(int vehicleId);
+
+    static constexpr int    updateIntervalMSecs         = 200;
+    static constexpr qint64 expirationTimeoutMSecs      = 120000;   ///< Targets without an update for this long are removed
+    static constexpr double conflictRadiusMeters        = 2000;
+    static constexpr double conflictAltitudeMeters      = 300;      ///< Only used if both altitudes are known
+    /// Added to conflictAltitudeMeters for barometric targets, since pressure altitude is off from
+    /// GPS altitude by the local QNH and temperature deviation from standard atmosphere
+    static constexpr double pressureAltitudeMarginMeters = 300;
+
 public slots:
     void adsbVehicleUpdate(const ADSBVehicle::ADSBVehicleInfo_t vehicleInfo);
+    void adsbVehicleUpdates(const QList<ADSBVehicle::ADSBVehicleInfo_t>& vehicleInfos);
     void _tcpError(const QString errorMsg);
 
 private slots:
     void _cleanupStaleVehicles(void);
+    void _applyPendingUpdates(void);
 
 private:
+    void _removeExpired(qint64 nowMSecs);
+    void _updateConflicts(void);
+    /// @return true: Target is known to be far enough above or below ownShip
+    bool _verticallySeparated(const OwnShip_t& ownShip, int index) const;
+
     QmlObjectListModel _adsbVehicles;
-    QMap<uint32_t, ADSBVehicle*> _adsbICAOMap;
+    QHash<uint32_t, ADSBVehicle*> _adsbICAOMap;
     QTimer _adsbVehicleCleanupTimer;
     ADSBTCPLink* _tcpLink = nullptr;
+
+    ADSBTargetStore _targets;
+    QHash<uint32_t, ADSBVehicle::ADSBVehicleInfo_t> _pendingUpdates;   ///< Merged updates per target since the last tick
+    QTimer _updateTimer;
+    QElapsedTimer _clock;
+    QSet<uint32_t> _conflicts;
+    QHash<int, OwnShip_t> _ownShips;    ///< By vehicle id
 };
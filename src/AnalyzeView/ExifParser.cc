@@ -3,6 +3,7 @@
 
 #include <QtCore/QtEndian>
 #include <QtCore/QDateTime>
+#include <QtCore/QIODevice>
 
 QGC_LOGGING_CATEGORY(ExifParserLog, "qgc.analyzeview.exifparser")
 
@@ -58,10 +59,221 @@ namespace {
         char c[0xa3];
         readable_s readable;
     };
+
+    // JPEG segment markers
+    constexpr uint8_t markerSOI = 0xD8;
+    constexpr uint8_t markerEOI = 0xD9;
+    constexpr uint8_t markerSOS = 0xDA;
+    constexpr uint8_t markerAPP1 = 0xE1;
+
+    // The TIFF header follows the marker, segment length and "Exif\0\0"
+    constexpr int app1TiffOffset = 10;
+
+    constexpr uint16_t tagGpsIfd = 0x8825;
+    constexpr uint16_t tagGpsLatRef = 1;
+    constexpr uint16_t tagGpsLat = 2;
+    constexpr uint16_t tagGpsLonRef = 3;
+    constexpr uint16_t tagGpsLon = 4;
+    constexpr uint16_t tagGpsAltRef = 5;
+    constexpr uint16_t tagGpsAlt = 6;
+
+    constexpr uint16_t typeByte = 1;
+    constexpr uint16_t typeAscii = 2;
+    constexpr uint16_t typeRational = 5;
+
+    // Bounds checked access to the TIFF structure of an APP1 segment, in either byte order
+    class TiffView {
+    public:
+        explicit TiffView(const QByteArray& app1)
+        {
+            if (app1.size() < (app1TiffOffset + 8)) {
+                return;
+            }
+
+            _data = app1.constData() + app1TiffOffset;
+            _size = app1.size() - app1TiffOffset;
+            if (memcmp(_data, "II\x2A\x00", 4) == 0) {
+                _valid = true;
+            } else if (memcmp(_data, "MM\x00\x2A", 4) == 0) {
+                _valid = true;
+                _bigEndian = true;
+            }
+        }
+
+        bool isValid() const { return _valid; }
+        bool isBigEndian() const { return _bigEndian; }
+
+        bool contains(qint64 offset, qint64 length) const { return (offset >= 0) && ((offset + length) <= _size); }
+
+        uint16_t u16(qint64 offset) const
+        {
+            if (!contains(offset, 2)) {
+                return 0;
+            }
+            return _bigEndian ? qFromBigEndian<uint16_t>(_data + offset) : qFromLittleEndian<uint16_t>(_data + offset);
+        }
+
+        uint32_t u32(qint64 offset) const
+        {
+            if (!contains(offset, 4)) {
+                return 0;
+            }
+            return _bigEndian ? qFromBigEndian<uint32_t>(_data + offset) : qFromLittleEndian<uint32_t>(_data + offset);
+        }
+
+        uint32_t ifd0() const { return u32(4); }
+
+        // Offset of the entry for tag in the IFD at ifdOffset, -1 if there is none
+        qint64 findEntry(qint64 ifdOffset, uint16_t tag) const
+        {
+            if (!contains(ifdOffset, 2)) {
+                return -1;
+            }
+
+            const uint16_t count = u16(ifdOffset);
+            for (uint16_t i = 0; i < count; i++) {
+                const qint64 entry = ifdOffset + 2 + (12 * i);
+                if (!contains(entry, 12)) {
+                    return -1;
+                }
+                if (u16(entry) == tag) {
+                    return entry;
+                }
+            }
+
+            return -1;
+        }
+
+        // Offset of the value of an entry with the given type and count, -1 if the entry doesn't match
+        qint64 valueOffset(qint64 entry, uint16_t type, uint32_t count) const
+        {
+            if ((entry < 0) || (u16(entry + 2) != type) || (u32(entry + 4) != count)) {
+                return -1;
+            }
+
+            const qint64 size = ((type == typeRational) ? 8 : 1) * count;
+            const qint64 offset = (size <= 4) ? (entry + 8) : u32(entry + 8);
+            return contains(offset, size) ? offset : -1;
+        }
+
+    private:
+        const char* _data = nullptr;
+        qsizetype _size = 0;
+        bool _valid = false;
+        bool _bigEndian = false;
+    };
+
+    // Value offsets of the GPS IFD position tags, -1 for tags the image doesn't have
+    struct GpsValues {
+        qint64 latRef = -1;
+        qint64 lat = -1;
+        qint64 lonRef = -1;
+        qint64 lon = -1;
+        qint64 altRef = -1;
+        qint64 alt = -1;
+    };
+
+    GpsValues findGpsValues(const TiffView& tiff)
+    {
+        GpsValues values;
+
+        const qint64 gpsIfdEntry = tiff.findEntry(tiff.ifd0(), tagGpsIfd);
+        if (gpsIfdEntry < 0) {
+            return values;
+        }
+
+        const qint64 gpsIfd = tiff.u32(gpsIfdEntry + 8);
+        values.latRef = tiff.valueOffset(tiff.findEntry(gpsIfd, tagGpsLatRef), typeAscii, 2);
+        values.lat = tiff.valueOffset(tiff.findEntry(gpsIfd, tagGpsLat), typeRational, 3);
+        values.lonRef = tiff.valueOffset(tiff.findEntry(gpsIfd, tagGpsLonRef), typeAscii, 2);
+        values.lon = tiff.valueOffset(tiff.findEntry(gpsIfd, tagGpsLon), typeRational, 3);
+        values.altRef = tiff.valueOffset(tiff.findEntry(gpsIfd, tagGpsAltRef), typeByte, 1);
+        values.alt = tiff.valueOffset(tiff.findEntry(gpsIfd, tagGpsAlt), typeRational, 1);
+        return values;
+    }
+
+    // Degrees, minutes and thousandths of seconds as three rationals
+    void toDegreesMinutesSeconds(double value, uint32_t rationals[6])
+    {
+        const double degrees = fabs(value);
+        const double minutes = (degrees - floor(degrees)) * 60.0;
+
+        rationals[0] = static_cast<uint32_t>(degrees);
+        rationals[1] = 1;
+        rationals[2] = static_cast<uint32_t>(minutes);
+        rationals[3] = 1;
+        rationals[4] = static_cast<uint32_t>((minutes - floor(minutes)) * 60000.0);
+        rationals[5] = 1000;
+    }
+
+    double fromDegreesMinutesSeconds(const TiffView& tiff, qint64 offset)
+    {
+        double value = 0;
+        double scale = 1;
+        for (int i = 0; i < 3; i++) {
+            const uint32_t denominator = tiff.u32(offset + (i * 8) + 4);
+            if (denominator != 0) {
+                value += (static_cast<double>(tiff.u32(offset + (i * 8))) / denominator) / scale;
+            }
+            scale *= 60.0;
+        }
+        return value;
+    }
+
+    void putU32(char* data, uint32_t value, bool bigEndian)
+    {
+        if (bigEndian) {
+            qToBigEndian<uint32_t>(value, data);
+        } else {
+            qToLittleEndian<uint32_t>(value, data);
+        }
+    }
 }
 
 namespace ExifParser {
 
+QByteArray readApp1(QIODevice& file, qint64* app1Offset)
+{
+    const QByteArray soi = file.read(2);
+    if ((soi.size() != 2) || (static_cast<uint8_t>(soi[0]) != 0xFF) || (static_cast<uint8_t>(soi[1]) != markerSOI)) {
+        return QByteArray();
+    }
+
+    // Walk the segments in front of the image data, seeking over the ones we don't need
+    while (true) {
+        const qint64 segmentOffset = file.pos();
+        const QByteArray header = file.read(4);
+        if ((header.size() != 4) || (static_cast<uint8_t>(header[0]) != 0xFF)) {
+            return QByteArray();
+        }
+
+        const uint8_t marker = static_cast<uint8_t>(header[1]);
+        if ((marker == markerSOS) || (marker == markerEOI)) {
+            return QByteArray();
+        }
+
+        const uint16_t length = qFromBigEndian<uint16_t>(header.constData() + 2);
+        if (length < 2) {
+            return QByteArray();
+        }
+
+        if (marker == markerAPP1) {
+            const QByteArray segment = header + file.read(length - 2);
+            if (segment.size() != (length + 2)) {
+                return QByteArray();
+            }
+            if (segment.mid(4, 6) == QByteArrayLiteral("Exif\0\0")) {
+                if (app1Offset) {
+                    *app1Offset = segmentOffset;
+                }
+                return segment;
+            }
+        } else if (!file.seek(segmentOffset + 2 + length)) {
+            return QByteArray();
+        }
+    }
+}
+
 double readTime(const QByteArray &buf)
 {
     // find creation date header index
@@ -110,6 +322,41 @@ double readTime(const QByteArray &buf)
     return (tagTime.toMSecsSinceEpoch() / 1000.0);
 }
 
+bool readGps(const QByteArray& app1, GeoTagWorker::cameraFeedbackPacket& geotag)
+{
+    const TiffView tiff(app1);
+    if (!tiff.isValid()) {
+        return false;
+    }
+
+    const GpsValues values = findGpsValues(tiff);
+    if ((values.latRef < 0) || (values.lat < 0) || (values.lonRef < 0) || (values.lon < 0)) {
+        return false;
+    }
+
+    geotag.latitude = fromDegreesMinutesSeconds(tiff, values.lat);
+    if (app1.at(app1TiffOffset + values.latRef) == 'S') {
+        geotag.latitude = -geotag.latitude;
+    }
+    geotag.longitude = fromDegreesMinutesSeconds(tiff, values.lon);
+    if (app1.at(app1TiffOffset + values.lonRef) == 'W') {
+        geotag.longitude = -geotag.longitude;
+    }
+
+    geotag.altitude = 0;
+    if (values.alt >= 0) {
+        const uint32_t denominator = tiff.u32(values.alt + 4);
+        if (denominator != 0) {
+            geotag.altitude = static_cast<float>(tiff.u32(values.alt)) / denominator;
+        }
+        if ((values.altRef >= 0) && (app1.at(app1TiffOffset + values.altRef) == 1)) {
+            geotag.altitude = -geotag.altitude;
+        }
+    }
+
+    return true;
+}
+
 bool write(QByteArray& buf, const GeoTagWorker::cameraFeedbackPacket& geotag)
 {
     static const QByteArray app1Header("\xff\xe1", 2);
@@ -188,19 +435,8 @@ bool write(QByteArray& buf, const GeoTagWorker::cameraFeedbackPacket& geotag)
     gpsData.readable.fields.finishedDataField = 0;
 
     // Filling up the additional information that does not fit into the fields
-    gpsData.readable.extendedData.gpsLat[0] = abs(static_cast<int>(geotag.latitude));
-    gpsData.readable.extendedData.gpsLat[1] = 1;
-    gpsData.readable.extendedData.gpsLat[2] = static_cast<int>((fabs(geotag.latitude) - (floor(fabs(geotag.latitude))) * 60.0));
-    gpsData.readable.extendedData.gpsLat[3] = 1;
-    gpsData.readable.extendedData.gpsLat[4] = static_cast<int>(((fabs(geotag.latitude) * 60.0) - (floor(fabs(geotag.latitude) * 60.0)) * 60000.0));
-    gpsData.readable.extendedData.gpsLat[5] = 1000;
-
-    gpsData.readable.extendedData.gpsLon[0] = abs(static_cast<int>(geotag.longitude));
-    gpsData.readable.extendedData.gpsLon[1] = 1;
-    gpsData.readable.extendedData.gpsLon[2] = static_cast<int>((fabs(geotag.longitude) - (floor(fabs(geotag.longitude))) * 60.0));
-    gpsData.readable.extendedData.gpsLon[3] = 1;
-    gpsData.readable.extendedData.gpsLon[4] = static_cast<int>(((fabs(geotag.longitude) * 60.0) - (floor(fabs(geotag.longitude) * 60.0)) * 60000.0));
-    gpsData.readable.extendedData.gpsLon[5] = 1000;
+    toDegreesMinutesSeconds(geotag.latitude, gpsData.readable.extendedData.gpsLat);
+    toDegreesMinutesSeconds(geotag.longitude, gpsData.readable.extendedData.gpsLon);
 
     gpsData.readable.extendedData.gpsAlt[0] = geotag.altitude * 100.f;
     gpsData.readable.extendedData.gpsAlt[1] = 100;
@@ -242,4 +478,50 @@ bool write(QByteArray& buf, const GeoTagWorker::cameraFeedbackPacket& geotag)
     return true;
 }
 
+bool patchGps(QIODevice& file, const GeoTagWorker::cameraFeedbackPacket& geotag)
+{
+    qint64 app1Offset = 0;
+    if (!file.seek(0)) {
+        return false;
+    }
+    QByteArray app1 = readApp1(file, &app1Offset);
+
+    const TiffView tiff(app1);
+    if (!tiff.isValid()) {
+        return false;
+    }
+    const GpsValues values = findGpsValues(tiff);
+    if ((values.latRef < 0) || (values.lat < 0) || (values.lonRef < 0) || (values.lon < 0) || (values.alt < 0)) {
+        return false;
+    }
+    const bool bigEndian = tiff.isBigEndian();
+
+    // Only values change, so the segment keeps its size and all offsets stay valid
+    char* const data = app1.data() + app1TiffOffset;
+
+    uint32_t rationals[6];
+    data[values.latRef] = (geotag.latitude > 0) ? 'N' : 'S';
+    toDegreesMinutesSeconds(geotag.latitude, rationals);
+    for (int i = 0; i < 6; i++) {
+        putU32(data + values.lat + (i * 4), rationals[i], bigEndian);
+    }
+
+    data[values.lonRef] = (geotag.longitude > 0) ? 'E' : 'W';
+    toDegreesMinutesSeconds(geotag.longitude, rationals);
+    for (int i = 0; i < 6; i++) {
+        putU32(data + values.lon + (i * 4), rationals[i], bigEndian);
+    }
+
+    if (values.altRef >= 0) {
+        data[values.altRef] = (geotag.altitude < 0) ? 1 : 0;
+    }
+    putU32(data + values.alt, static_cast<uint32_t>(fabs(geotag.altitude) * 100.f), bigEndian);
+    putU32(data + values.alt + 4, 100, bigEndian);
+
+    if (!file.seek(app1Offset)) {
+        return false;
+    }
+    return (file.write(app1) == app1.size());
+}
+
 }
@@ -5,9 +5,26 @@
 
 #include "GeoTagWorker.h"
 
+class QIODevice;
+
 Q_DECLARE_LOGGING_CATEGORY(ExifParserLog)
 
 namespace ExifParser {
+    /// Reads only the leading JPEG segments up to the Exif APP1 segment, instead of the whole image
+    ///     @param[out] app1Offset File offset of the segment
+    /// @return The APP1 segment starting at its marker, empty if the file has none
+    QByteArray readApp1(QIODevice& file, qint64* app1Offset = nullptr);
+
     double readTime(const QByteArray& buf);
+
+    /// @param app1 APP1 segment as returned by readApp1
+    /// @return false: no GPS position in the image
+    bool readGps(const QByteArray& app1, GeoTagWorker::cameraFeedbackPacket& geotag);
+
     bool write(QByteArray& buf, const GeoTagWorker::cameraFeedbackPacket& geotag);
+
+    /// Overwrites the position of an image which already has a GPS IFD, without rewriting the rest of the file.
+    /// The GPS IFD must hold latitude, longitude and altitude tags.
+    /// @return false: image can't be patched and has not been changed, use write instead
+    bool patchGps(QIODevice& file, const GeoTagWorker::cameraFeedbackPacket& geotag);
 };
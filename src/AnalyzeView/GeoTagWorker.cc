@@ -14,11 +14,15 @@
 #include "QGCLoggingCategory.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QThreadPool>
 
 QGC_LOGGING_CATEGORY(GeoTagWorkerLog, "qgc.analyzeview.geotagworker")
 
 GeoTagWorker::GeoTagWorker()
     : _cancel(false)
+    , _maxThreads(QThread::idealThreadCount())
 {
 
 }
@@ -26,6 +30,9 @@ GeoTagWorker::GeoTagWorker()
 void GeoTagWorker::run()
 {
     _cancel = false;
+    _stageError.clear();
+    _exifStats = StageStats();
+    _tagStats = StageStats();
     emit progressChanged(1);
     double nSteps = 5;
 
@@ -45,46 +52,49 @@ void GeoTagWorker::run()
     emit progressChanged((100/nSteps));
 
     // Parse EXIF
-    _imageTime.clear();
-    for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
-        }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(ExifParser::readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
+    if (!_readImageTimes((100/nSteps), (100/nSteps))) {
         if (_cancel) {
             qCDebug(GeotaggingLog) << "Tagging cancelled";
             emit error(tr("Tagging cancelled"));
-            return;
+        } else {
+            emit error(_stageError);
         }
+        return;
     }
 
-    // Load log
+    // Parse log. Neither parser holds the whole log in memory: ULogs are streamed in chunks, PX4 logs
+    // are scanned through a memory map.
     bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
     QFile file(_logFile);
     if (!file.open(QIODevice::ReadOnly)) {
         emit error(tr("Geotagging failed. Couldn't open log file."));
         return;
     }
-    QByteArray log = file.readAll();
-    file.close();
+
+    const GeoTagWorker::ParseProgress parseProgress = [this, nSteps](double progress) {
+        emit progressChanged(2*(100/nSteps) + (100/nSteps)*qBound(0.0, progress, 1.0));
+        return !_cancel;
+    };
 
     // Instantiate appropriate parser
     _triggerList.clear();
     bool parseComplete = false;
     QString errorString;
     if (isULog) {
-        parseComplete = ULogParser::getTagsFromLog(log, _triggerList, errorString);
+        parseComplete = ULogParser::getTagsFromLog(file, _triggerList, errorString, parseProgress);
     } else {
-        parseComplete = PX4LogParser::getTagsFromLog(log, _triggerList);
+        const qint64 logSize = file.size();
+        uchar* const mappedLog = file.map(0, logSize);
+        if (mappedLog) {
+            const QByteArray log = QByteArray::fromRawData(reinterpret_cast<const char*>(mappedLog), logSize);
+            parseComplete = PX4LogParser::getTagsFromLog(log, _triggerList, parseProgress);
+            (void) file.unmap(mappedLog);
+        } else {
+            qCDebug(GeoTagWorkerLog) << "Unable to map log, reading it instead" << file.errorString();
+            parseComplete = PX4LogParser::getTagsFromLog(file.readAll(), _triggerList, parseProgress);
+        }
     }
+    file.close();
 
     if (!parseComplete) {
         if (_cancel) {
@@ -123,51 +133,13 @@ void GeoTagWorker::run()
     }
 
     // Tag images
-    auto maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
-    maxIndex = std::min(maxIndex, _imageList.count());
-    for(int i = 0; i < maxIndex; i++) {
-        int imageIndex = _imageIndices[i];
-        if (imageIndex >= _imageList.count()) {
-            emit error(tr("Geotagging failed. Requesting image #%1, but only %2 images present.").arg(imageIndex).arg(_imageList.count()));
-            return;
-        }
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
-        }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
-
-        if (!ExifParser::write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
-            return;
-        } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
-            }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
-                return;
-            }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
-        }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
-
+    if (!_tagImages(4*(100/nSteps), (100/nSteps))) {
         if (_cancel) {
             qCDebug(GeotaggingLog) << "Tagging cancelled";
             emit error(tr("Tagging cancelled"));
-            return;
+        } else {
+            emit error(_stageError);
         }
-    }
-
-    if (_cancel) {
-        qCDebug(GeotaggingLog) << "Tagging cancelled";
-        emit error(tr("Tagging cancelled"));
         return;
     }
 
@@ -189,3 +161,217 @@ bool GeoTagWorker::triggerFiltering()
     }
     return true;
 }
+
+bool GeoTagWorker::_readImageTimes(double progressStart, double progressRange)
+{
+    // QFileInfo caches lazily and can't be shared between threads, so the jobs only get the paths
+    QStringList imagePaths;
+    for (const QFileInfo& imageInfo : _imageList) {
+        imagePaths.append(imageInfo.absoluteFilePath());
+    }
+
+    _imageTime.clear();
+    _imageTime.resize(_imageList.count());
+    // Every job writes its own slot, there is no shared state to lock
+    double* const imageTimes = _imageTime.data();
+    std::atomic<qint64> bytesRead{0};
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool success = _runParallel(static_cast<int>(imagePaths.count()), [this, &imagePaths, imageTimes, &bytesRead](int index) {
+        QFile file(imagePaths.at(index));
+        if (!file.open(QIODevice::ReadOnly)) {
+            _setStageError(tr("Geotagging failed. Couldn't open an image."));
+            return false;
+        }
+
+        // The capture time is in the Exif APP1 segment at the front of the file, the image data isn't needed
+        QByteArray exif = ExifParser::readApp1(file);
+        if (exif.isEmpty()) {
+            (void) file.seek(0);
+            exif = file.readAll();
+        }
+        bytesRead += exif.size();
+
+        imageTimes[index] = ExifParser::readTime(exif);
+        return true;
+    }, progressStart, progressRange);
+
+    _exifStats.images = _imageList.count();
+    _exifStats.bytes = bytesRead;
+    _exifStats.msecs = timer.elapsed();
+    _logStats("EXIF read", _exifStats);
+
+    return success;
+}
+
+bool GeoTagWorker::_tagImages(double progressStart, double progressRange)
+{
+    struct TagJob {
+        QString source;
+        QString target;
+        int     triggerIndex;
+    };
+
+    qsizetype maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
+    maxIndex = std::min(maxIndex, _imageList.count());
+    QList<TagJob> jobs;
+    jobs.reserve(maxIndex);
+    QHash<int, qsizetype> jobForImage;
+    for (qsizetype i = 0; i < maxIndex; i++) {
+        const int imageIndex = _imageIndices[i];
+        if ((imageIndex < 0) || (imageIndex >= _imageList.count())) {
+            _stageError = tr("Geotagging failed. Requesting image #%1, but only %2 images present.").arg(imageIndex).arg(_imageList.count());
+            return false;
+        }
+
+        // An image tagged twice keeps the last trigger, and two jobs never write the same file
+        if (jobForImage.contains(imageIndex)) {
+            jobs[jobForImage.value(imageIndex)].triggerIndex = _triggerIndices[i];
+            continue;
+        }
+        jobForImage.insert(imageIndex, jobs.count());
+
+        const QFileInfo& imageInfo = _imageList.at(imageIndex);
+        TagJob job;
+        job.source = imageInfo.absoluteFilePath();
+        if(_saveDirectory == "") {
+            job.target = _imageDirectory + "/TAGGED/" + imageInfo.fileName();
+        } else {
+            job.target = _saveDirectory + "/" + imageInfo.fileName();
+        }
+        job.triggerIndex = _triggerIndices[i];
+        jobs.append(job);
+    }
+
+    std::atomic<qint64> bytesWritten{0};
+    std::atomic<int> patchedCount{0};
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool success = _runParallel(static_cast<int>(jobs.count()), [this, &jobs, &bytesWritten, &patchedCount](int index) {
+        const TagJob& job = jobs.at(index);
+        bool patched = false;
+        qint64 bytes = 0;
+        if (!_tagImage(job.source, job.target, _triggerList.at(job.triggerIndex), patched, bytes)) {
+            return false;
+        }
+
+        bytesWritten += bytes;
+        if (patched) {
+            patchedCount++;
+        }
+        return true;
+    }, progressStart, progressRange);
+
+    _tagStats.images = static_cast<int>(jobs.count());
+    _tagStats.bytes = bytesWritten;
+    _tagStats.msecs = timer.elapsed();
+    _tagStats.patched = patchedCount;
+    _logStats("Tagging", _tagStats);
+
+    return success;
+}
+
+bool GeoTagWorker::_tagImage(const QString& source, const QString& target, const cameraFeedbackPacket& geotag, bool& patched, qint64& bytesWritten)
+{
+    // Images which already have a GPS IFD are copied and only their GPS values overwritten
+    const QFileInfo targetInfo(target);
+    const bool sameFile = targetInfo.exists() && (QFileInfo(source).canonicalFilePath() == targetInfo.canonicalFilePath());
+    if (!sameFile) {
+        (void) QFile::remove(target);
+    }
+    if (sameFile || QFile::copy(source, target)) {
+        // The copy keeps the permissions of the source, which may well be read only
+        (void) QFile::setPermissions(target, QFile::permissions(target) | QFile::WriteOwner);
+        QFile fileCopy(target);
+        if (fileCopy.open(QIODevice::ReadWrite) && ExifParser::patchGps(fileCopy, geotag)) {
+            patched = true;
+            bytesWritten = fileCopy.size();
+            return true;
+        }
+    }
+
+    // Everything else gets the GPS IFD inserted, which rewrites the whole file
+    QFile fileRead(source);
+    if (!fileRead.open(QIODevice::ReadOnly)) {
+        _setStageError(tr("Geotagging failed. Couldn't open an image."));
+        return false;
+    }
+    QByteArray imageBuffer = fileRead.readAll();
+    fileRead.close();
+
+    if (!ExifParser::write(imageBuffer, geotag)) {
+        _setStageError(tr("Geotagging failed. Couldn't write to image."));
+        return false;
+    }
+
+    QFile fileWrite(target);
+    if (!fileWrite.open(QFile::WriteOnly | QFile::Truncate)) {
+        _setStageError(tr("Geotagging failed. Couldn't write to an image."));
+        return false;
+    }
+    if (fileWrite.write(imageBuffer) != imageBuffer.size()) {
+        _setStageError(tr("Geotagging failed. Couldn't write to an image."));
+        return false;
+    }
+
+    patched = false;
+    bytesWritten = imageBuffer.size();
+    return true;
+}
+
+bool GeoTagWorker::_runParallel(int count, const std::function<bool(int index)>& job, double progressStart, double progressRange)
+{
+    if (count <= 0) {
+        return !_cancel;
+    }
+
+    std::atomic<int> completed{0};
+    std::atomic<bool> failed{false};
+
+    // A private pool keeps the number of images in memory bounded and leaves the global pool alone
+    QThreadPool pool;
+    pool.setMaxThreadCount(_maxThreads);
+    for (int i = 0; i < count; i++) {
+        pool.start([this, &job, &completed, &failed, i]() {
+            if (_cancel || failed) {
+                return;
+            }
+            if (!job(i)) {
+                failed = true;
+            }
+            completed++;
+        });
+    }
+
+    while (!pool.waitForDone(_progressIntervalMSecs)) {
+        emit progressChanged(progressStart + ((progressRange * completed) / count));
+        if (_cancel || failed) {
+            // Drop the jobs which haven't started yet
+            pool.clear();
+        }
+    }
+    emit progressChanged(progressStart + ((progressRange * completed) / count));
+
+    return !failed && !_cancel;
+}
+
+void GeoTagWorker::_setStageError(const QString& errorMsg)
+{
+    QMutexLocker locker(&_stageErrorMutex);
+    if (_stageError.isEmpty()) {
+        _stageError = errorMsg;
+    }
+}
+
+void GeoTagWorker::_logStats(const char* stage, const StageStats& stats)
+{
+    const double seconds = qMax<qint64>(stats.msecs, 1) / 1000.0;
+    qCDebug(GeotaggingLog) << stage << stats.images << "images in" << stats.msecs << "ms:"
+                           << (stats.images / seconds) << "images/s"
+                           << ((stats.bytes / (1024.0 * 1024.0)) / seconds) << "MB/s"
+                           << "patched in place:" << stats.patched;
+}
@@ -14,6 +14,10 @@
 #include <QtCore/QThread>
 #include <QtCore/QFileInfoList>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+
+#include <atomic>
+#include <functional>
 
 Q_DECLARE_LOGGING_CATEGORY(GeoTagWorkerLog)
 
@@ -34,6 +38,10 @@ public:
 
     void cancelTagging      () { _cancel = true; }
 
+    /// Number of images read or tagged at the same time, defaults to the number of cores
+    void setMaxThreads      (int count)                     { _maxThreads = qMax(1, count); }
+    int  maxThreads         () const { return _maxThreads; }
+
     struct cameraFeedbackPacket {
         double timestamp;
         double timestampUTC;
@@ -46,6 +54,20 @@ public:
         uint8_t captureResult;
     };
 
+    /// Throughput of one of the image stages of the last run
+    struct StageStats {
+        int     images  = 0;
+        qint64  bytes   = 0;    ///< Image bytes read for the EXIF stage, written for the tag stage
+        qint64  msecs   = 0;
+        int     patched = 0;    ///< Tag stage: images whose GPS tags were patched in place instead of rewritten
+    };
+
+    StageStats exifStats    () const { return _exifStats; }
+    StageStats tagStats     () const { return _tagStats; }
+
+    /// Log parsers report progress as the fraction of the log parsed so far. Returning false cancels parsing.
+    typedef std::function<bool(double progress)> ParseProgress;
+
 protected:
     void run() final;
 
@@ -56,8 +78,17 @@ signals:
 
 private:
     bool triggerFiltering();
+    bool _readImageTimes(double progressStart, double progressRange);
+    bool _tagImages(double progressStart, double progressRange);
+    bool _tagImage(const QString& source, const QString& target, const cameraFeedbackPacket& geotag, bool& patched, qint64& bytesWritten);
+    /// Runs job for 0..count-1 on a pool of _maxThreads threads, reporting progress while it waits
+    ///     @return false: a job failed or tagging was cancelled
+    bool _runParallel(int count, const std::function<bool(int index)>& job, double progressStart, double progressRange);
+    void _setStageError(const QString& errorMsg);
+    static void _logStats(const char* stage, const StageStats& stats);
 
-    bool                    _cancel;
+    std::atomic<bool>       _cancel;
+    int                     _maxThreads;
     QString                 _logFile;
     QString                 _imageDirectory;
     QString                 _saveDirectory;
@@ -66,4 +97,10 @@ private:
     QList<cameraFeedbackPacket> _triggerList;
     QList<int>              _imageIndices;
     QList<int>              _triggerIndices;
+    StageStats              _exifStats;
+    StageStats              _tagStats;
+    QMutex                  _stageErrorMutex;
+    QString                 _stageError;
+
+    static constexpr int    _progressIntervalMSecs = 100;
 };
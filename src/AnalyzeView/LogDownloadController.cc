@@ -20,8 +20,8 @@
 
 #define kTimeOutMilliseconds 500
 #define kGUIRateMilliseconds 17
-#define kTableBins           512
-#define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kWindowBins          4096   // Bins asked for by a single data request
+#define kGapMergeBins        128    // Bins resent cost about as much as the round trip of another request
 
 QGC_LOGGING_CATEGORY(LogDownloadControllerLog, "qgc.analyzeview.logdownloadcontroller")
 
@@ -252,27 +252,10 @@ LogDownloadController::_logData(uint32_t ofs, uint16_t id, uint8_t count, const
     bool result = false;
     uint32_t timeout_time = kTimeOutMilliseconds;
     if(ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / kChunkSize;
-        if (chunk != _downloadData->current_chunk) {
-            qCWarning(LogDownloadControllerLog) << "Ignored packet for out of order chunk actual:expected" << chunk << _downloadData->current_chunk;
-            return;
-        }
-        const uint16_t bin = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qCWarning(LogDownloadControllerLog) << "Out of range bin received";
-        } else
-            _downloadData->chunk_table.setBit(bin);
-        if (_downloadData->file.pos() != ofs) {
-            // Seek to correct position
-            if (!_downloadData->file.seek(ofs)) {
-                qCWarning(LogDownloadControllerLog) << "Error while seeking log file offset";
-                return;
-            }
-        }
+        const uint32_t bin = ofs / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
 
-        //-- Write chunk to file
-        if(_downloadData->file.write((const char*)data, count)) {
-            _downloadData->written += count;
+        //-- Buffer the data, it is written to the file in blocks
+        if(_downloadData->writeBin(bin, data, count)) {
             _downloadData->rate_bytes += count;
             _updateDataRate();
             result = true;
@@ -281,18 +264,17 @@ LogDownloadController::_logData(uint32_t ofs, uint16_t id, uint8_t count, const
             //-- Reset timer
             _timer.start(timeout_time);
             //-- Do we have it all?
-            if(_logComplete()) {
-                _downloadData->entry->setStatus(tr("Downloaded"));
+            if(_downloadData->complete()) {
+                if(_downloadData->flush()) {
+                    _downloadData->entry->setStatus(tr("Downloaded"));
+                } else {
+                    _downloadData->entry->setStatus(tr("Error"));
+                }
                 //-- Check for more
                 _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk*kChunkSize,
-                                _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if (bin < _downloadData->chunk_table.size() - 1 && _downloadData->chunk_table.at(bin+1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
+            } else if (bin + 1 == _downloadData->request_end) {
+                // Everything asked for went by, ask for what is still missing right away
+                _requestNextData();
             }
         } else {
             qCWarning(LogDownloadControllerLog) << "Error while writing log file chunk";
@@ -305,21 +287,6 @@ LogDownloadController::_logData(uint32_t ofs, uint16_t id, uint8_t count, const
     }
 }
 
-
-//----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_chunkComplete() const
-{
-    return _downloadData->chunkEquals(true);
-}
-
-//----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_logComplete() const
-{
-    return _chunkComplete() && (_downloadData->current_chunk+1) == _downloadData->numChunks();
-}
-
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::_receivedAllData()
@@ -328,7 +295,7 @@ LogDownloadController::_receivedAllData()
     //-- Anything queued up for download?
     if(_prepareLogDownload()) {
         //-- Request Log
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+        _requestNextData();
         _timer.start(kTimeOutMilliseconds);
     } else {
         _resetSelection();
@@ -340,11 +307,9 @@ LogDownloadController::_receivedAllData()
 void
 LogDownloadController::_findMissingData()
 {
-    if (_logComplete()) {
+    if (_downloadData->complete()) {
          _receivedAllData();
          return;
-    } else if (_chunkComplete()) {
-        _downloadData->advanceChunk();
     }
 
     _retries++;
@@ -362,23 +327,44 @@ LogDownloadController::_findMissingData()
 
     _updateDataRate();
 
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
-        }
+    _requestNextData(_retries);
+}
+
+//----------------------------------------------------------------------------------------
+// Vehicles serve one data request at a time, a new one replaces whatever is being sent. So a request
+// starts at the first missing bin and takes in the holes which follow, as long as the bins received
+// in between are few enough that resending them is cheaper than another round trip. Where nothing was
+// received yet it runs for a whole window.
+void
+LogDownloadController::_requestNextData(int retryCount)
+{
+    const uint32_t numBins = _downloadData->numBins();
+    _downloadData->first_missing = _downloadData->nextMissing(_downloadData->first_missing, numBins);
+    const uint32_t start = _downloadData->first_missing;
+    if (start >= numBins) {
+        return;
     }
 
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
+    const uint32_t limit = qMin(start + kWindowBins, numBins);
+    uint32_t end = start;
+    while (end < limit) {
+        //-- Skip over the hole
+        while (end < limit && !_downloadData->bin_table.testBit(end)) {
+            end++;
+        }
+        //-- Take in the next one if it's close
+        const uint32_t next = _downloadData->nextMissing(end, limit);
+        if (next >= limit || (next - end) > kGapMergeBins) {
             break;
         }
+        end = next;
     }
 
-    const uint32_t pos = _downloadData->current_chunk*kChunkSize + start*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-                   len = (end - start)*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-    _requestLogData(_downloadData->ID, pos, len, _retries);
+    _downloadData->request_end = end;
+    _requestLogData(_downloadData->ID,
+                    start * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
+                    (end - start) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
+                    retryCount);
 }
 
 //----------------------------------------------------------------------------------------
@@ -548,8 +534,6 @@ LogDownloadController::_prepareLogDownload()
         if(!_downloadData->file.resize(entry->size())) {
             qCWarning(LogDownloadControllerLog) << "Failed to allocate space for log file:" <<  _downloadData->filename;
         } else {
-            _downloadData->current_chunk = 0;
-            _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
             _downloadData->elapsed.start();
             result = true;
         }
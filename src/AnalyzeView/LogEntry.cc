@@ -12,47 +12,100 @@
 #include "MAVLinkLib.h"
 #include "QGCLoggingCategory.h"
 
-#include <QtCore/QtMath>
+#include <cstring>
 
-#define kTableBins 512
-#define kChunkSize (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kBinSize   MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN
+// Smallest number of bins which is also a multiple of 4 KiB, so blocks start on bin and page boundaries
+#define kBlockBins 2048
 
 QGC_LOGGING_CATEGORY(LogEntryLog, "qgc.analyzeview.logentry")
 
 //-----------------------------------------------------------------------------
 LogDownloadData::LogDownloadData(QGCLogEntry* entry_)
-    : ID(entry_->id())
+    : bins_received(0)
+    , first_missing(0)
+    , request_end(0)
+    , block(kBlockBins * kBinSize, '\0')
+    , block_table(kBlockBins, false)
+    , block_index(0)
+    , ID(entry_->id())
     , entry(entry_)
     , written(0)
     , rate_bytes(0)
     , rate_avg(0)
 {
-
+    bin_table = QBitArray(numBins(), false);
 }
 
-void LogDownloadData::advanceChunk()
+// The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the file
+uint32_t LogDownloadData::numBins() const
 {
-       current_chunk++;
-       chunk_table = QBitArray(chunkBins(), false);
+    return (entry->size() + kBinSize - 1) / kBinSize;
 }
 
-// The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-uint32_t LogDownloadData::chunkBins() const
+// The first bin from bin up to end which wasn't received, end if there is none
+uint32_t LogDownloadData::nextMissing(uint32_t bin, uint32_t end) const
 {
-    return qMin(qCeil((entry->size() - current_chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
-                kTableBins);
+    while (bin < end && bin_table.testBit(bin)) {
+        bin++;
+    }
+    return bin;
 }
 
-// The number of kChunkSize chunks in the file
-uint32_t LogDownloadData::numChunks() const
+// Buffers a received bin. Data goes to the file a block at a time, when a bin for another block arrives.
+// Returns false if writing the file failed.
+bool LogDownloadData::writeBin(uint32_t bin, const uint8_t* data, uint32_t count)
 {
-    return qCeil(entry->size() / static_cast<qreal>(kChunkSize));
+    if (bin >= numBins() || bin_table.testBit(bin)) {
+        // Resent by a request which overlapped data we already have
+        return true;
+    }
+
+    const uint32_t blockIndex = bin / kBlockBins;
+    if (blockIndex != block_index) {
+        if (!flush()) {
+            return false;
+        }
+        block_index = blockIndex;
+    }
+
+    count = qMin(count, static_cast<uint32_t>(kBinSize));
+    char* binData = block.data() + ((bin % kBlockBins) * kBinSize);
+    memcpy(binData, data, count);
+    memset(binData + count, 0, kBinSize - count);
+    block_table.setBit(bin % kBlockBins);
+
+    bin_table.setBit(bin);
+    bins_received++;
+    written += count;
+    return true;
 }
 
-// True if all bins in the chunk have been set to val
-bool LogDownloadData::chunkEquals(const bool val) const
+// Writes the buffered bins of the current block, one write for each run of consecutive bins
+bool LogDownloadData::flush()
 {
-    return chunk_table == QBitArray(chunk_table.size(), val);
+    const qint64 blockOffset = static_cast<qint64>(block_index) * kBlockBins * kBinSize;
+    int start = 0;
+    while (start < kBlockBins) {
+        if (!block_table.testBit(start)) {
+            start++;
+            continue;
+        }
+        int end = start;
+        while (end < kBlockBins && block_table.testBit(end)) {
+            end++;
+        }
+
+        const qint64 offset = blockOffset + (start * kBinSize);
+        const qint64 length = qMin(static_cast<qint64>((end - start) * kBinSize), static_cast<qint64>(entry->size()) - offset);
+        if (!file.seek(offset) || file.write(block.constData() + (start * kBinSize), length) != length) {
+            qCWarning(LogEntryLog) << "Error writing log file" << file.errorString();
+            return false;
+        }
+        start = end;
+    }
+    block_table.fill(false);
+    return true;
 }
 
 //----------------------------------------------------------------------------------------
@@ -14,6 +14,7 @@
 #include <QtCore/QString>
 #include <QtCore/QBitArray>
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
 #include <QtCore/QLoggingCategory>
 #include <QtQmlIntegration/QtQmlIntegration>
 
@@ -71,8 +72,13 @@ private:
 struct LogDownloadData {
     LogDownloadData(QGCLogEntry* entry);
 
-    QBitArray     chunk_table;
-    uint32_t      current_chunk;
+    QBitArray     bin_table;        ///< Bins of the whole log which were received
+    uint32_t      bins_received;
+    uint32_t      first_missing;    ///< Every bin before this one was received
+    uint32_t      request_end;      ///< Bin past the end of the outstanding data request
+    QByteArray    block;            ///< Write buffer for one block of bins
+    QBitArray     block_table;      ///< Bins of the block which are in the write buffer
+    uint32_t      block_index;
     QFile         file;
     QString       filename;
     uint          ID;
@@ -82,8 +88,9 @@ struct LogDownloadData {
     qreal         rate_avg;
     QElapsedTimer elapsed;
 
-    void advanceChunk();
-    uint32_t chunkBins() const;
-    uint32_t numChunks() const;
-    bool chunkEquals(const bool val) const;
+    uint32_t numBins() const;
+    bool complete() const { return bins_received == numBins(); }
+    uint32_t nextMissing(uint32_t bin, uint32_t end) const;
+    bool writeBin(uint32_t bin, const uint8_t* data, uint32_t count);
+    bool flush();
 };
@@ -117,13 +117,20 @@ MAVLinkInspectorController::_findVehicle(uint8_t id)
 void
 MAVLinkInspectorController::_refreshFrequency()
 {
+    MultiVehicleManager* multiVehicleManager = qgcApp()->toolbox()->multiVehicleManager();
     for(int i = 0; i < _systems.count(); i++) {
         QGCMAVLinkSystem* v = qobject_cast<QGCMAVLinkSystem*>(_systems.get(i));
         if(v) {
+            // Handler timing is kept per message id by the vehicle, so all components of a message share it
+            Vehicle* vehicle = multiVehicleManager->getVehicleById(v->id());
             for(int i = 0; i < v->messages()->count(); i++) {
                 QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(v->messages()->get(i));
                 if(m) {
                     m->updateFreq();
+                    if(vehicle) {
+                        const Vehicle::MessageHandlerStats stats = vehicle->messageHandlerStats(m->id());
+                        m->setHandlerStats(stats.count, stats.totalNsecs, stats.maxNsecs);
+                    }
                 }
             }
         }
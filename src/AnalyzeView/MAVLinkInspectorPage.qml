@@ -157,6 +157,9 @@ AnalyzePage {
                         QGCLabel { text: qsTr("Actual Rate:") }
                         QGCLabel { text: curMessage ? curMessage.actualRateHz.toFixed(1) + qsTr("Hz") : "" }
 
+                        QGCLabel { text: qsTr("Handler Time:") }
+                        QGCLabel { text: curMessage ? curMessage.handlerAvgUSecs.toFixed(1) + qsTr("us avg, ") + curMessage.handlerMaxUSecs.toFixed(1) + qsTr("us max") : "" }
+
                         QGCLabel { text: qsTr("Set Rate:") }
                         QGCComboBox {
                             id: msgRateCombo
@@ -81,6 +81,26 @@ QGCMAVLinkMessage::updateFreq()
     emit actualRateHzChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessage::setHandlerStats(quint64 count, qint64 totalNsecs, qint64 maxNsecs)
+{
+    if (count < _lastHandlerCount) {
+        // Vehicle went away and came back
+        _lastHandlerCount = 0;
+        _lastHandlerTotalNsecs = 0;
+    }
+    const quint64 newCount = count - _lastHandlerCount;
+    if (newCount == 0) {
+        return;
+    }
+    _handlerAvgUSecs = static_cast<qreal>(totalNsecs - _lastHandlerTotalNsecs) / newCount / 1000.0;
+    _handlerMaxUSecs = maxNsecs / 1000.0;
+    _lastHandlerCount = count;
+    _lastHandlerTotalNsecs = totalNsecs;
+    emit handlerTimeChanged();
+}
+
 void QGCMAVLinkMessage::setSelected(bool sel)
 {
     if (_selected != sel) {
@@ -41,6 +41,8 @@ public:
     Q_PROPERTY(QmlObjectListModel*  fields          READ fields         CONSTANT)
     Q_PROPERTY(bool                 fieldSelected   READ fieldSelected  NOTIFY fieldSelectedChanged)
     Q_PROPERTY(bool                 selected        READ selected       NOTIFY selectedChanged)
+    Q_PROPERTY(qreal                handlerAvgUSecs READ handlerAvgUSecs NOTIFY handlerTimeChanged)  ///< Average vehicle handler time over the last update
+    Q_PROPERTY(qreal                handlerMaxUSecs READ handlerMaxUSecs NOTIFY handlerTimeChanged)  ///< Longest vehicle handler time seen
 
     QGCMAVLinkMessage   (QObject* parent, mavlink_message_t* message);
     ~QGCMAVLinkMessage  ();
@@ -56,12 +58,16 @@ public:
     QmlObjectListModel* fields          () { return &_fields; }
     bool                fieldSelected   () const { return _fieldSelected; }
     bool                selected        () const { return _selected; }
+    qreal               handlerAvgUSecs () const { return _handlerAvgUSecs; }
+    qreal               handlerMaxUSecs () const { return _handlerMaxUSecs; }
 
     void                updateFieldSelection();
     void                update          (mavlink_message_t* message);
     void                updateFreq      ();
     void                setSelected     (bool sel);
     void                setTargetRateHz (int32_t rate);
+    /// Updates the handler timing from the running totals kept by Vehicle for this message id
+    void                setHandlerStats (quint64 count, qint64 totalNsecs, qint64 maxNsecs);
 
 signals:
     void countChanged();
@@ -69,6 +75,7 @@ signals:
     void targetRateHzChanged();
     void fieldSelectedChanged();
     void selectedChanged();
+    void handlerTimeChanged();
 
 private:
     void _updateFields(void);
@@ -82,4 +89,8 @@ private:
     mavlink_message_t   _message;
     bool                _fieldSelected  = false;
     bool                _selected       = false;
+    qreal               _handlerAvgUSecs        = 0.0;
+    qreal               _handlerMaxUSecs        = 0.0;
+    quint64             _lastHandlerCount       = 0;
+    qint64              _lastHandlerTotalNsecs  = 0;
 };
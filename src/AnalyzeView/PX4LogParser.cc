@@ -14,7 +14,6 @@ static constexpr const char gposHeaderHeader[5] = {static_cast<char>(0xA3), stat
 // header for GPOS message
 static constexpr const char gposHeader[4] = {static_cast<char>(0xA3), static_cast<char>(0x95), static_cast<char>(0x10), static_cast<char>(0x00)};
 static constexpr const int gposOffsets[3] = {3, 7, 11};
-static constexpr const int gposLengths[3] = {4, 4, 4};
 
 // header for trigger message header
 static constexpr const char triggerHeaderHeader[] = {static_cast<char>(0xA3), static_cast<char>(0x95), static_cast<char>(0x80), static_cast<char>(0x37), static_cast<char>(0x00)};
@@ -22,21 +21,31 @@ static constexpr const char triggerHeaderHeader[] = {static_cast<char>(0xA3), st
 // header for trigger message
 static constexpr const char triggerHeader[4] = {static_cast<char>(0xA3), static_cast<char>(0x95), static_cast<char>(0x37), static_cast<char>(0x00)};
 static constexpr const int triggerOffsets[2] = {3, 11};
-static constexpr const int triggerLengths[2] = {8, 4};
+
+// progress is reported every 1% of the log
+static constexpr const int progressSteps = 100;
+
+/// Reads a little endian value straight out of the log, 0 if it would run past the end
+template<typename T>
+static T readField(const QByteArray& log, qsizetype index)
+{
+    if ((index < 0) || ((index + static_cast<qsizetype>(sizeof(T))) > log.size())) {
+        return T{};
+    }
+    return qFromLittleEndian<T>(log.constData() + index);
+}
 
 namespace PX4LogParser {
 
-bool getTagsFromLog(const QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+bool getTagsFromLog(const QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, const GeoTagWorker::ParseProgress& progress)
 {
     // extract header information: message lengths
-    const uint8_t* iptr = reinterpret_cast<const uint8_t*>(log.mid(log.indexOf(gposHeaderHeader) + 4, 1).constData());
-    const int gposHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
-
-    iptr = reinterpret_cast<const uint8_t*>(log.mid(log.indexOf(triggerHeaderHeader) + 4, 1).constData());
-    const int triggerHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
+    const int gposHeaderOffset = static_cast<int>(readField<uint8_t>(log, log.indexOf(gposHeaderHeader) + 4));
+    const int triggerHeaderOffset = static_cast<int>(readField<uint8_t>(log, log.indexOf(triggerHeaderHeader) + 4));
 
     // extract trigger data
-    int index = 1;
+    qsizetype index = 1;
+    qsizetype nextProgressIndex = 0;
     int sequence = -1;
     while(index < log.length() - 1) {
         // first extract trigger
@@ -47,6 +56,13 @@ bool getTagsFromLog(const QByteArray& log, QList<GeoTagWorker::cameraFeedbackPac
             break;
         }
 
+        if (progress && (index >= nextProgressIndex)) {
+            if (!progress(static_cast<double>(index) / log.size())) {
+                return false;
+            }
+            nextProgressIndex = index + qMax<qsizetype>(log.size() / progressSteps, 1);
+        }
+
         if (log.indexOf(header, index + 1) != (index + triggerHeaderOffset)) {
             continue;
         }
@@ -54,10 +70,8 @@ bool getTagsFromLog(const QByteArray& log, QList<GeoTagWorker::cameraFeedbackPac
         GeoTagWorker::cameraFeedbackPacket feedback;
         (void) memset(&feedback, 0, sizeof(feedback));
 
-        const uint64_t* const time = reinterpret_cast<const uint64_t*>(log.mid(index + triggerOffsets[0], triggerLengths[0]).data());
-        const double timeDouble = static_cast<double>(qFromLittleEndian(*time)) / 1.0e6;
-        const uint32_t* const seq = reinterpret_cast<const uint32_t*>(log.mid(index + triggerOffsets[1], triggerLengths[1]).data());
-        const int seqInt = static_cast<int>(qFromLittleEndian(*seq));
+        const double timeDouble = static_cast<double>(readField<uint64_t>(log, index + triggerOffsets[0])) / 1.0e6;
+        const int seqInt = static_cast<int>(readField<uint32_t>(log, index + triggerOffsets[1]));
         // Assume that logging has not skipped more than 20 triggers. This prevents wrong header detection.
         if ((sequence >= seqInt) || ((sequence + 20) < seqInt)) {
             continue;
@@ -69,7 +83,7 @@ bool getTagsFromLog(const QByteArray& log, QList<GeoTagWorker::cameraFeedbackPac
 
         // second extract position
         while (true) {
-            const int gposIndex = log.indexOf(gposHeader, index + 1);
+            const qsizetype gposIndex = log.indexOf(gposHeader, index + 1);
             if (gposIndex < 0) {
                 (void) cameraFeedback.append(feedback);
                 break;
@@ -78,15 +92,12 @@ bool getTagsFromLog(const QByteArray& log, QList<GeoTagWorker::cameraFeedbackPac
 
             // verify that at an offset of gposHeaderOffset the next log message starts
             if ((gposIndex + gposHeaderOffset) == log.indexOf(header, gposIndex + 1)) {
-                const int32_t* const lat = reinterpret_cast<const int32_t*>(log.mid(gposIndex + gposOffsets[0], gposLengths[0]).constData());
-                feedback.latitude = static_cast<double>(qFromLittleEndian(*lat)) / 1.0e7;
+                feedback.latitude = static_cast<double>(readField<int32_t>(log, gposIndex + gposOffsets[0])) / 1.0e7;
 
-                const int32_t* const lon = reinterpret_cast<const int32_t*>(log.mid(gposIndex + gposOffsets[1], gposLengths[1]).constData());
-                feedback.longitude = static_cast<double>(qFromLittleEndian(*lon)) / 1.0e7;
+                feedback.longitude = static_cast<double>(readField<int32_t>(log, gposIndex + gposOffsets[1])) / 1.0e7;
                 feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
 
-                const float* const alt = reinterpret_cast<const float*>(log.mid(gposIndex + gposOffsets[2], gposLengths[2]).constData());
-                feedback.altitude = qFromLittleEndian(*alt);
+                feedback.altitude = readField<float>(log, gposIndex + gposOffsets[2]);
 
                 (void) cameraFeedback.append(feedback);
                 break;
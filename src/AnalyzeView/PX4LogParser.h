@@ -9,5 +9,8 @@
 Q_DECLARE_LOGGING_CATEGORY(PX4LogParserLog)
 
 namespace PX4LogParser {
-    bool getTagsFromLog(const QByteArray &log, QList<GeoTagWorker::cameraFeedbackPacket> &cameraFeedback);
+    /// The log is only read from, so it can be a memory mapped file wrapped by QByteArray::fromRawData
+    ///     @param progress Called as the log is scanned with the fraction parsed, returning false cancels
+    /// @return false: cancelled
+    bool getTagsFromLog(const QByteArray &log, QList<GeoTagWorker::cameraFeedbackPacket> &cameraFeedback, const GeoTagWorker::ParseProgress &progress = GeoTagWorker::ParseProgress());
 }
@@ -1,6 +1,12 @@
 #include "ULogParser.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtCore/QBuffer>
+#include <QtCore/QSet>
+#include <QtCore/QtEndian>
+
+#include <limits>
+
 QGC_LOGGING_CATEGORY(ULogParserLog, "qgc.analyzeview.ulogparser")
 
 namespace {
@@ -8,6 +14,10 @@ namespace {
 #define ULOG_FILE_HEADER_LEN 16
 #define ULOG_MSG_HEADER_LEN 3
 
+/// Large enough for a chunk plus the largest message left over from the previous one
+constexpr qint64 _readChunkSize = 1024 * 1024;
+constexpr qint64 _bufferSize = _readChunkSize + ULOG_MSG_HEADER_LEN + std::numeric_limits<uint16_t>::max();
+
 enum class ULogMessageType : uint8_t {
     FORMAT = 'F',
     DATA = 'D',
@@ -20,27 +30,6 @@ enum class ULogMessageType : uint8_t {
     LOGGING = 'L',
 };
 
-struct ULogMessageHeader {
-    uint16_t msgSize;
-    uint8_t msgType;
-};
-
-struct ULogMessageFormat {
-    uint16_t msgSize;
-    uint8_t msgType;
-
-    char format[2096];
-};
-
-struct ULogMessageAddLogged {
-    uint16_t msgSize;
-    uint8_t msgType;
-
-    uint8_t multiID;
-    uint16_t msgID;
-    char msgName[255];
-};
-
 constexpr const char _ULogMagic[8] = {'U', 'L', 'o', 'g', static_cast<char>(0x01), static_cast<char>(0x12), static_cast<char>(0x35)};
 
 int sizeOfType(QStringView typeName)
@@ -116,105 +105,176 @@ void parseFieldFormat(const QString &fields, QMap<QString, int> &cameraCaptureOf
     }
 }
 
+/// camera_capture field offsets, resolved once from its FORMAT message
+struct CameraCaptureFormat {
+    bool valid = false;
+    int timestamp = 0;
+    int timestampUTC = 0;
+    int seq = 0;
+    int lat = 0;
+    int lon = 0;
+    int alt = 0;
+    int groundDistance = 0;
+    int result = 0;
+};
+
+CameraCaptureFormat parseCameraCaptureFormat(const QString &fields)
+{
+    QMap<QString, int> offsets;
+    parseFieldFormat(fields, offsets);
+
+    CameraCaptureFormat format;
+    format.valid = true;
+    format.timestamp = offsets.value(QStringLiteral("timestamp"));
+    format.timestampUTC = offsets.value(QStringLiteral("timestamp_utc"));
+    format.seq = offsets.value(QStringLiteral("seq"));
+    format.lat = offsets.value(QStringLiteral("lat"));
+    format.lon = offsets.value(QStringLiteral("lon"));
+    format.alt = offsets.value(QStringLiteral("alt"));
+    format.groundDistance = offsets.value(QStringLiteral("ground_distance"));
+    format.result = offsets.value(QStringLiteral("result"));
+    return format;
+}
+
+bool decodeCameraCapture(const CameraCaptureFormat &format, const char *data, int dataSize, GeoTagWorker::cameraFeedbackPacket &feedback)
+{
+    // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
+    const auto readField = [data, dataSize](void *field, int offset, int size) {
+        if ((offset < 0) || ((offset + size) > dataSize)) {
+            return false;
+        }
+        (void) memcpy(field, data + offset, size);
+        return true;
+    };
+
+    (void) memset(&feedback, 0, sizeof(feedback));
+
+    if (!readField(&feedback.timestamp, format.timestamp, 8) ||
+        !readField(&feedback.timestampUTC, format.timestampUTC, 8) ||
+        !readField(&feedback.imageSequence, format.seq, 4) ||
+        !readField(&feedback.latitude, format.lat, 8) ||
+        !readField(&feedback.longitude, format.lon, 8) ||
+        !readField(&feedback.altitude, format.alt, 4) ||
+        !readField(&feedback.groundDistance, format.groundDistance, 4) ||
+        !readField(&feedback.captureResult, format.result, 1)) {
+        return false;
+    }
+
+    feedback.timestamp /= 1.0e6; // to seconds
+    feedback.timestampUTC /= 1.0e6; // to seconds
+    feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
+
+    return true;
+}
+
 } // namespace
 
 namespace ULogParser {
 
-bool getTagsFromLog(const QByteArray &log, QList<GeoTagWorker::cameraFeedbackPacket> &cameraFeedback, QString &errorMessage)
+bool getTagsFromLog(QIODevice &log, QList<GeoTagWorker::cameraFeedbackPacket> &cameraFeedback, QString &errorMessage, const GeoTagWorker::ParseProgress &progress)
 {
     errorMessage.clear();
 
-    if (!log.contains(_ULogMagic)) {
+    const QByteArray fileHeader = log.read(ULOG_FILE_HEADER_LEN);
+    if ((fileHeader.size() < ULOG_FILE_HEADER_LEN) || !fileHeader.startsWith(_ULogMagic)) {
         errorMessage = QT_TR_NOOP("Could not detect ULog file header magic");
         return false;
     }
 
-    int index = ULOG_FILE_HEADER_LEN;
-    bool geotagFound = false;
-    QMap<QString /*fieldname*/, int /*fieldOffset*/> cameraCaptureOffsets;
-    int cameraCaptureMsgID = -1;
+    const qint64 logSize = log.size();
+    qint64 bytesRead = fileHeader.size();
 
-    while(index < (log.length() - 1)) {
+    // Messages are consumed out of a buffer which is only ever refilled in place, leftovers of the
+    // previous chunk are moved to the front first.
+    QByteArray buffer;
+    buffer.reserve(_bufferSize);
+    qsizetype pos = 0;
+    bool atEnd = false;
 
-        ULogMessageHeader header;
-        (void) memset(&header, 0, sizeof(header));
-        (void) memcpy(&header, log.constData() + index, ULOG_MSG_HEADER_LEN);
+    CameraCaptureFormat cameraCaptureFormat;
+    QSet<uint16_t> cameraCaptureMsgIDs;
 
-        switch (header.msgType) {
-            case static_cast<int>(ULogMessageType::FORMAT):
-            {
-                ULogMessageFormat format_msg;
-                (void) memset(&format_msg, 0, sizeof(format_msg));
-                (void) memcpy(&format_msg, log.constData() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+    while (true) {
+        const qsizetype available = buffer.size() - pos;
+        qsizetype messageLength = ULOG_MSG_HEADER_LEN;
+        if (available >= ULOG_MSG_HEADER_LEN) {
+            messageLength += qFromLittleEndian<uint16_t>(buffer.constData() + pos);
+        }
+
+        if (available < messageLength) {
+            if (atEnd) {
+                break;
+            }
 
-                const QString fmt(format_msg.format);
-                const int posSeparator = fmt.indexOf(':');
-                const QString messageName = fmt.left(posSeparator);
-                const QString messageFields = fmt.mid(posSeparator + 1, header.msgSize - posSeparator - 1);
+            (void) buffer.remove(0, pos);
+            pos = 0;
+            const qsizetype leftover = buffer.size();
+            buffer.resize(leftover + _readChunkSize);
+            const qint64 count = log.read(buffer.data() + leftover, _readChunkSize);
+            buffer.resize(leftover + qMax<qint64>(count, 0));
+            if (count <= 0) {
+                atEnd = true;
+            }
+            bytesRead += qMax<qint64>(count, 0);
 
-                if(messageName == QLatin1String("camera_capture")) {
-                    parseFieldFormat(messageFields, cameraCaptureOffsets);
-                }
+            if (progress && (logSize > 0) && !progress(static_cast<double>(bytesRead) / logSize)) {
+                errorMessage = QT_TR_NOOP("Log parsing cancelled");
+                return false;
+            }
+            continue;
+        }
+
+        const uint8_t msgType = static_cast<uint8_t>(buffer.at(pos + 2));
+        const char* const payload = buffer.constData() + pos + ULOG_MSG_HEADER_LEN;
+        const int payloadSize = static_cast<int>(messageLength - ULOG_MSG_HEADER_LEN);
+        pos += messageLength;
 
+        switch (msgType) {
+            case static_cast<int>(ULogMessageType::FORMAT):
+            {
+                // name:type field;type field;...
+                const QByteArray format = QByteArray::fromRawData(payload, payloadSize);
+                const qsizetype posSeparator = format.indexOf(':');
+                if ((posSeparator > 0) && (format.left(posSeparator) == "camera_capture")) {
+                    const qsizetype fieldsEnd = format.indexOf('\0', posSeparator);
+                    const QByteArray fields = format.mid(posSeparator + 1, (fieldsEnd < 0) ? -1 : (fieldsEnd - posSeparator - 1));
+                    cameraCaptureFormat = parseCameraCaptureFormat(QString::fromLatin1(fields));
+                }
                 break;
             }
 
             case static_cast<int>(ULogMessageType::ADD_LOGGED_MSG):
             {
-                ULogMessageAddLogged addLoggedMsg;
-                (void) memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
-                (void) memcpy(&addLoggedMsg, log.constData() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                const QString messageName(addLoggedMsg.msgName);
-
-                if(messageName.contains(QLatin1String("camera_capture"))) {
-                    cameraCaptureMsgID = addLoggedMsg.msgID;
-                    geotagFound = true;
+                // multi_id:uint8_t msg_id:uint16_t message_name:char[]
+                if (payloadSize < 3) {
+                    break;
+                }
+                const QByteArray messageName = QByteArray::fromRawData(payload + 3, payloadSize - 3);
+                if (messageName.contains("camera_capture")) {
+                    (void) cameraCaptureMsgIDs.insert(qFromLittleEndian<uint16_t>(payload + 1));
                 }
-
                 break;
             }
 
             case static_cast<int>(ULogMessageType::DATA):
             {
-                uint16_t msgID = -1;
-                (void) memcpy(&msgID, log.constData() + index + ULOG_MSG_HEADER_LEN, 2);
-
-                if (geotagFound && (msgID == cameraCaptureMsgID)) {
-                    // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
-                    GeoTagWorker::cameraFeedbackPacket feedback;
-                    (void) memset(&feedback, 0, sizeof(feedback));
-
-                    const char* const data = log.constData() + index + 5;
-
-                    (void) memcpy(&feedback.timestamp, data + cameraCaptureOffsets.value(QStringLiteral("timestamp")), 8);
-                    feedback.timestamp /= 1.0e6; // to seconds
-
-                    (void) memcpy(&feedback.timestampUTC, data + cameraCaptureOffsets.value(QStringLiteral("timestamp_utc")), 8);
-                    feedback.timestampUTC /= 1.0e6; // to seconds
-
-                    (void) memcpy(&feedback.imageSequence, data + cameraCaptureOffsets.value(QStringLiteral("seq")), 4);
-                    (void) memcpy(&feedback.latitude, data + cameraCaptureOffsets.value(QStringLiteral("lat")), 8);
-                    (void) memcpy(&feedback.longitude, data + cameraCaptureOffsets.value(QStringLiteral("lon")), 8);
-
-                    feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-
-                    (void) memcpy(&feedback.altitude, data + cameraCaptureOffsets.value(QStringLiteral("alt")), 4);
-                    (void) memcpy(&feedback.groundDistance, data + cameraCaptureOffsets.value(QStringLiteral("ground_distance")), 4);
-                    (void) memcpy(&feedback.captureResult, data + cameraCaptureOffsets.value(QStringLiteral("result")), 1);
+                // msg_id:uint16_t data:uint8_t[]
+                if ((payloadSize < 2) || !cameraCaptureFormat.valid || !cameraCaptureMsgIDs.contains(qFromLittleEndian<uint16_t>(payload))) {
+                    break;
+                }
 
+                GeoTagWorker::cameraFeedbackPacket feedback;
+                if (decodeCameraCapture(cameraCaptureFormat, payload + 2, payloadSize - 2, feedback)) {
                     (void) cameraFeedback.append(feedback);
+                } else {
+                    qCWarning(ULogParserLog) << "Truncated camera_capture message";
                 }
-
                 break;
             }
 
             default:
                 break;
         }
-
-        index += (3 + header.msgSize);
-
     }
 
     if (cameraFeedback.isEmpty()) {
@@ -225,4 +285,16 @@ bool getTagsFromLog(const QByteArray &log, QList<GeoTagWorker::cameraFeedbackPac
     return true;
 }
 
+bool getTagsFromLog(const QByteArray &log, QList<GeoTagWorker::cameraFeedbackPacket> &cameraFeedback, QString &errorMessage)
+{
+    QBuffer buffer;
+    buffer.setData(log);
+    if (!buffer.open(QIODevice::ReadOnly)) {
+        errorMessage = QT_TR_NOOP("Could not read ULog");
+        return false;
+    }
+
+    return getTagsFromLog(buffer, cameraFeedback, errorMessage);
+}
+
 } // namespace ULogParser
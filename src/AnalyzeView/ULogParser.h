@@ -7,9 +7,17 @@
 
 #include "GeoTagWorker.h"
 
+class QIODevice;
+
 Q_DECLARE_LOGGING_CATEGORY(ULogParserLog)
 
 namespace ULogParser {
-    /// @return true: failed, errorMessage set
+    /// Streams the log through a fixed size buffer, so memory use does not grow with the log size.
+    /// Only the camera_capture definitions are kept and only its DATA messages are decoded.
+    ///     @param progress Called after each chunk read with the fraction of the log parsed, returning false cancels
+    /// @return false: failed or cancelled, errorMessage set
+    bool getTagsFromLog(QIODevice &log, QList<GeoTagWorker::cameraFeedbackPacket> &cameraFeedback, QString &errorMessage, const GeoTagWorker::ParseProgress &progress = GeoTagWorker::ParseProgress());
+
+    /// @return false: failed, errorMessage set
     bool getTagsFromLog(const QByteArray &log, QList<GeoTagWorker::cameraFeedbackPacket> &cameraFeedback, QString &errorMessage);
 }
@@ -0,0 +1,292 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogReplayIndex.h"
+#include "MAVLinkFrameParser.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(LogReplayIndexLog, "qgc.comms.logreplayindex")
+
+/// Largest record: timestamp followed by a signed MAVLink 2 frame with full payload
+static constexpr int kMaxRecordSize = LogReplayIndex::timestampSize + MAVLINK_MAX_PACKET_LEN;
+
+LogReplayIndex::LogReplayIndex(QObject* parent)
+    : QThread(parent)
+{
+}
+
+LogReplayIndex::~LogReplayIndex()
+{
+    cancel();
+}
+
+void LogReplayIndex::build(const QString& logFilename)
+{
+    cancel();
+
+    _logFilename = logFilename;
+    _ready = false;
+    _cancel = false;
+    start(QThread::LowPriority);
+}
+
+void LogReplayIndex::cancel()
+{
+    _cancel = true;
+    (void) wait();
+}
+
+quint64 LogReplayIndex::parseTimestamp(const char* bytes)
+{
+    quint64 timestamp = qFromBigEndian<quint64>(bytes);
+    const quint64 currentTimestamp = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+
+    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
+    // little endian, so switch it.
+    if (timestamp > currentTimestamp) {
+        timestamp = qbswap(timestamp);
+    }
+
+    return timestamp;
+}
+
+LogReplayIndex::Entry LogReplayIndex::entryForTime(quint64 timeUSecs) const
+{
+    if (_entries.empty()) {
+        return Entry{ 0, 0 };
+    }
+
+    auto it = std::upper_bound(_entries.cbegin(), _entries.cend(), timeUSecs, [](quint64 time, const Entry& entry) {
+        return time < entry.timeUSecs;
+    });
+    if (it != _entries.cbegin()) {
+        --it;
+    }
+    return *it;
+}
+
+qint64 LogReplayIndex::findRecord(QIODevice& log, quint64 timeUSecs, quint64& recordTimeUSecs) const
+{
+    if (!_ready) {
+        return -1;
+    }
+
+    qint64 offset = entryForTime(timeUSecs).offset;
+    while (true) {
+        if (!log.seek(offset)) {
+            return -1;
+        }
+        const QByteArray record = log.read(kMaxRecordSize);
+        if (record.size() <= timestampSize) {
+            return -1;
+        }
+
+        const int frameLength = MAVLinkFrameParser::frameLengthAt(reinterpret_cast<const uint8_t*>(record.constData()) + timestampSize, record.size() - timestampSize);
+        if (frameLength == 0) {
+            // Truncated record at the end of the log
+            return -1;
+        }
+        if (frameLength < 0) {
+            // Not on a record boundary, resync the same way the index scan does
+            offset++;
+            continue;
+        }
+
+        const quint64 recordTime = parseTimestamp(record.constData());
+        if (recordTime >= timeUSecs) {
+            recordTimeUSecs = recordTime;
+            return offset;
+        }
+        offset += timestampSize + frameLength;
+    }
+}
+
+void LogReplayIndex::run()
+{
+    _entries.clear();
+    _startTimeUSecs = 0;
+    _endTimeUSecs = 0;
+    _recordCount = 0;
+    _loadedFromSidecar = false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool success = false;
+    if (_sidecarEnabled && _loadSidecar()) {
+        _loadedFromSidecar = true;
+        success = true;
+    } else {
+        success = _scanLog();
+        if (success && _sidecarEnabled && !_cancel) {
+            _saveSidecar();
+        }
+    }
+
+    if (_cancel) {
+        return;
+    }
+
+    success = success && !_entries.empty() && (_endTimeUSecs > _startTimeUSecs);
+    qCDebug(LogReplayIndexLog) << "Index" << (_loadedFromSidecar ? "loaded" : "built") << "success:" << success << "records:" << _recordCount
+                               << "entries:" << _entries.size() << "msecs:" << timer.elapsed();
+
+    _ready = success;
+    emit built(success);
+}
+
+void LogReplayIndex::_addRecord(quint64 timeUSecs, qint64 offset)
+{
+    if (_recordCount == 0) {
+        _startTimeUSecs = timeUSecs;
+    }
+    _endTimeUSecs = timeUSecs;
+    _recordCount++;
+
+    // Records where the clock jumped backwards stay out of the index so it remains sorted, a seek
+    // walks over them instead.
+    if (_entries.empty() || (timeUSecs >= _entries.back().timeUSecs + (static_cast<quint64>(_intervalMSecs) * 1000))) {
+        _entries.push_back(Entry{ timeUSecs, offset });
+    }
+}
+
+bool LogReplayIndex::_scanLog()
+{
+    QFile file(_logFilename);
+    if (!file.open(QFile::ReadOnly)) {
+        qCWarning(LogReplayIndexLog) << "Unable to open log" << _logFilename << file.errorString();
+        return false;
+    }
+
+    // Walk the log one record at a time out of large buffered reads. A record is a timestamp followed
+    // by a single frame, so frames are validated in place instead of byte by byte through the
+    // MAVLink parser.
+    QByteArray buffer;
+    qint64 bufferOffset = 0;    ///< File offset of buffer[0]
+    qsizetype pos = 0;
+    bool atEnd = false;
+
+    while (!_cancel) {
+        if (!atEnd && ((buffer.size() - pos) < kMaxRecordSize)) {
+            buffer.remove(0, pos);
+            bufferOffset += pos;
+            pos = 0;
+            const QByteArray chunk = file.read(_readChunkSize);
+            if (chunk.isEmpty()) {
+                atEnd = true;
+            } else {
+                buffer.append(chunk);
+            }
+            continue;
+        }
+
+        const qsizetype available = buffer.size() - pos;
+        if (available <= timestampSize) {
+            break;
+        }
+
+        const char* const record = buffer.constData() + pos;
+        const int frameLength = MAVLinkFrameParser::frameLengthAt(reinterpret_cast<const uint8_t*>(record) + timestampSize, static_cast<int>(available - timestampSize));
+        if (frameLength > 0) {
+            _addRecord(parseTimestamp(record), bufferOffset + pos);
+            pos += timestampSize + frameLength;
+        } else if (frameLength == 0) {
+            // Truncated last record
+            break;
+        } else {
+            // Corrupt data, look for the next record boundary
+            pos++;
+        }
+    }
+
+    return !_cancel;
+}
+
+bool LogReplayIndex::_loadSidecar()
+{
+    QFile file(sidecarFilename(_logFilename));
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    const QFileInfo logInfo(_logFilename);
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, version;
+    qint64 logSize, logModified;
+    qint32 intervalMSecs;
+    quint64 startTimeUSecs, endTimeUSecs, recordCount, entryCount;
+    stream >> magic >> version >> logSize >> logModified >> intervalMSecs >> startTimeUSecs >> endTimeUSecs >> recordCount >> entryCount;
+
+    if ((stream.status() != QDataStream::Ok) || (magic != _sidecarMagic) || (version != _sidecarVersion)) {
+        qCDebug(LogReplayIndexLog) << "Ignoring unreadable sidecar" << file.fileName();
+        return false;
+    }
+    if ((logSize != logInfo.size()) || (logModified != logInfo.lastModified().toMSecsSinceEpoch()) || (intervalMSecs != _intervalMSecs)) {
+        qCDebug(LogReplayIndexLog) << "Ignoring stale sidecar" << file.fileName();
+        return false;
+    }
+    // Each entry takes 16 bytes, don't trust a count the file can't hold
+    if (entryCount > static_cast<quint64>(file.size() / 16)) {
+        return false;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(entryCount);
+    for (quint64 i = 0; (i < entryCount) && !_cancel; i++) {
+        Entry entry;
+        stream >> entry.timeUSecs >> entry.offset;
+        entries.push_back(entry);
+    }
+    if ((stream.status() != QDataStream::Ok) || _cancel) {
+        return false;
+    }
+
+    _entries = std::move(entries);
+    _startTimeUSecs = startTimeUSecs;
+    _endTimeUSecs = endTimeUSecs;
+    _recordCount = recordCount;
+    return true;
+}
+
+void LogReplayIndex::_saveSidecar()
+{
+    const QFileInfo logInfo(_logFilename);
+
+    QSaveFile file(sidecarFilename(_logFilename));
+    if (!file.open(QFile::WriteOnly)) {
+        // Logs may well live in read only locations, the index is just rebuilt next time
+        qCDebug(LogReplayIndexLog) << "Unable to write sidecar" << file.fileName() << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << _sidecarMagic << _sidecarVersion << static_cast<qint64>(logInfo.size()) << static_cast<qint64>(logInfo.lastModified().toMSecsSinceEpoch())
+           << static_cast<qint32>(_intervalMSecs) << _startTimeUSecs << _endTimeUSecs << _recordCount << static_cast<quint64>(_entries.size());
+    for (const Entry& entry : _entries) {
+        stream << entry.timeUSecs << entry.offset;
+    }
+
+    if (!file.commit()) {
+        qCDebug(LogReplayIndexLog) << "Unable to write sidecar" << file.fileName() << file.errorString();
+    }
+}
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+#include <QtCore/QThread>
+
+#include <atomic>
+#include <vector>
+
+class QIODevice;
+
+Q_DECLARE_LOGGING_CATEGORY(LogReplayIndexLog)
+
+/// Sparse time to file offset index of a telemetry log (tlog).
+///
+/// The log is scanned on the index thread, so replay can start before a long log has been read
+/// through. Every intervalMSecs of log time one record is added to the index. A seek then looks up
+/// the closest record before the target time in O(log n) and only has to walk the records of a
+/// single interval.
+///
+/// The index can be saved next to the log as a sidecar file. It is used instead of scanning the
+/// next time the same log is opened, as long as the log size and modification time still match.
+class LogReplayIndex : public QThread
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        quint64 timeUSecs;  ///< Timestamp of the record
+        qint64  offset;     ///< File offset of the record, which starts with the timestamp
+    };
+
+    LogReplayIndex(QObject* parent = nullptr);
+    ~LogReplayIndex();
+
+    /// Starts building the index on the index thread. built is emitted when done.
+    void build(const QString& logFilename);
+    /// Stops a build in progress and waits for the index thread to exit
+    void cancel();
+
+    void setIntervalMSecs(int msecs) { _intervalMSecs = msecs; }
+    void setSidecarEnabled(bool enabled) { _sidecarEnabled = enabled; }
+
+    /// The accessors below are only valid once isReady returns true
+    bool isReady() const { return _ready; }
+    bool loadedFromSidecar() const { return _loadedFromSidecar; }
+    quint64 startTimeUSecs() const { return _startTimeUSecs; }
+    quint64 endTimeUSecs() const { return _endTimeUSecs; }
+    quint64 recordCount() const { return _recordCount; }
+    const std::vector<Entry>& entries() const { return _entries; }
+
+    /// @return The last entry at or before timeUSecs, the first entry if timeUSecs is before it
+    Entry entryForTime(quint64 timeUSecs) const;
+
+    /// Finds the first record at or after timeUSecs by walking the log from the closest index entry
+    ///     @param[out] recordTimeUSecs Timestamp of the record found
+    ///     @return File offset of the record, -1 if there is none
+    qint64 findRecord(QIODevice& log, quint64 timeUSecs, quint64& recordTimeUSecs) const;
+
+    /// Parses a big endian record timestamp. Old logs which stored it little endian are detected by the
+    /// timestamp being in the future.
+    ///     @return Unix timestamp in microseconds UTC
+    static quint64 parseTimestamp(const char* bytes);
+
+    static QString sidecarFilename(const QString& logFilename) { return logFilename + QStringLiteral(".idx"); }
+
+    static constexpr int defaultIntervalMSecs = 250;
+    static constexpr int timestampSize = sizeof(quint64);
+
+signals:
+    /// Emitted from the index thread when a build finishes without being cancelled
+    ///     @param success false: log could not be read or holds no records
+    void built(bool success);
+
+protected:
+    void run() final;
+
+private:
+    void _addRecord(quint64 timeUSecs, qint64 offset);
+    bool _scanLog();
+    bool _loadSidecar();
+    void _saveSidecar();
+
+    QString                 _logFilename;
+    int                     _intervalMSecs      = defaultIntervalMSecs;
+    bool                    _sidecarEnabled     = true;
+
+    std::vector<Entry>      _entries;
+    quint64                 _startTimeUSecs     = 0;
+    quint64                 _endTimeUSecs       = 0;
+    quint64                 _recordCount        = 0;
+    bool                    _loadedFromSidecar  = false;
+
+    std::atomic<bool>       _ready              {false};
+    std::atomic<bool>       _cancel             {false};
+
+    static constexpr quint32    _sidecarMagic       = 0x51474958;   // "QGIX"
+    static constexpr quint32    _sidecarVersion     = 1;
+    static constexpr qint64     _readChunkSize      = 1024 * 1024;
+};
@@ -9,6 +9,7 @@
 
 
 #include "LogReplayLink.h"
+#include "LogReplayIndex.h"
 #include "LinkManager.h"
 #include "QGCApplication.h"
 #include "MultiVehicleManager.h"
@@ -17,7 +18,6 @@
 #endif
 
 #include <QtCore/QFileInfo>
-#include <QtCore/QtEndian>
 #include <QtTest/QSignalSpy>
 
 LogReplayLinkConfiguration::LogReplayLinkConfiguration(const QString& name)
@@ -77,6 +77,7 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     , _playbackStartLogTimeUSecs (0)
     , _mavlink                   (nullptr)
     , _logFileSize               (0)
+    , _index                     (new LogReplayIndex(this))
 {
     if (!_logReplayConfig) {
         qWarning() << "Internal error";
@@ -90,6 +91,7 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     QObject::connect(this, &LogReplayLink::_playOnThread,               this, &LogReplayLink::_play);
     QObject::connect(this, &LogReplayLink::_pauseOnThread,              this, &LogReplayLink::_pause);
     QObject::connect(this, &LogReplayLink::_setPlaybackSpeedOnThread,   this, &LogReplayLink::_setPlaybackSpeed);
+    QObject::connect(_index, &LogReplayIndex::built,                    this, &LogReplayLink::_indexBuilt);
     
     moveToThread(this);
 }
@@ -142,6 +144,7 @@ void LogReplayLink::run(void)
     exec();
     
     _readTickTimer.stop();
+    _index->cancel();
 }
 
 void LogReplayLink::_replayError(const QString& errorMsg)
@@ -160,16 +163,11 @@ void LogReplayLink::_writeBytes(const QByteArray &bytes)
 /// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
 quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
 {
-    quint64 timestamp = qFromBigEndian(*((quint64*)(bytes.constData())));
-    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
-    
-    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
-    // little endian, so switch it.
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
+    if (bytes.size() < cbTimestamp) {
+        return 0;
     }
-    
-    return timestamp;
+
+    return LogReplayIndex::parseTimestamp(bytes.constData());
 }
 
 /// Reads the next mavlink message from the log
@@ -233,39 +231,12 @@ quint64 LogReplayLink::_seekToNextMavlinkMessage(mavlink_message_t* nextMsg)
     return 0;
 }
 
-quint64 LogReplayLink::_findLastTimestamp(void)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    quint64             lastTimestamp = 0;
-    mavlink_message_t   msg;
-
-    // We read through the entire file looking for the last good timestamp. This can be somewhat slow, but trying to work from the
-    // end of the file can be way slower due to all the seeking back and forth required. So instead we take the simple reliable approach.
-
-    _logFile.reset();
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.bytesAvailable() > cbTimestamp) {
-        lastTimestamp = _parseTimestamp(_logFile.read(cbTimestamp));
-
-        bool endOfMessage = false;
-        while (!endOfMessage && _logFile.getChar(&nextByte)) {
-            endOfMessage = mavlink_parse_char(_mavlinkChannel, nextByte, &msg, &status);
-        }
-    }
-
-    return lastTimestamp;
-}
-
 bool LogReplayLink::_loadLogFile(void)
 {
     QString errorMsg;
     QString logFilename = _logReplayConfig->logFilename();
     QFileInfo logFileInfo;
-    int logDurationSecondsTotal;
     quint64 startTimeUSecs;
-    quint64 endTimeUSecs;
 
     if (_logFile.isOpen()) {
         errorMsg = tr("Attempt to load new log while log being played");
@@ -281,25 +252,22 @@ bool LogReplayLink::_loadLogFile(void)
     _logFileSize = logFileInfo.size();
     
     startTimeUSecs = _parseTimestamp(_logFile.read(cbTimestamp));
-    endTimeUSecs = _findLastTimestamp();
-
-    if (endTimeUSecs <= startTimeUSecs) {
+    if (startTimeUSecs == 0) {
         errorMsg = tr("The log file '%1' is corrupt or empty.").arg(logFilename);
         goto Error;
     }
 
-    // Remember the start and end time so we can move around this _logFile with the slider.
-    _logEndTimeUSecs = endTimeUSecs;
+    // The end time is only known once the index is built. Scanning a long log takes a while, so playback
+    // starts right away and the duration is filled in by _indexBuilt.
+    _logEndTimeUSecs = 0;
     _logStartTimeUSecs = startTimeUSecs;
-    _logDurationUSecs = endTimeUSecs - startTimeUSecs;
+    _logDurationUSecs = 0;
     _logCurrentTimeUSecs = startTimeUSecs;
 
     // Reset our log file so when we go to read it for the first time, we start at the beginning.
     _logFile.reset();
 
-    logDurationSecondsTotal = (_logDurationUSecs) / 1000000;
-    
-    emit logFileStats(logDurationSecondsTotal);
+    _index->build(logFilename);
     
     return true;
     
@@ -330,7 +298,7 @@ void LogReplayLink::_readNextLogEntry(void)
         // Read the next mavlink message from the log
         qint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
         emit bytesReceived(this, bytes);
-        emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
+        emit playbackPercentCompleteChanged(_percentComplete());
 
         if (_logFile.atEnd()) {
             _finishPlayback();
@@ -416,47 +384,83 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
         percentComplete = 100;
     }
     
-    qreal percentCompleteMult = percentComplete / 100.0;
-    
-    // But if we have a timestamped MAVLink log, then actually aim to hit that percentage in terms of
-    // time through the file.
-    qint64 newFilePos = (qint64)(percentCompleteMult * (qreal)_logFile.size());
-
-    // Now seek to the appropriate position, failing gracefully if we can't.
-    if (!_logFile.seek(newFilePos)) {
+    bool seeked;
+    if (_index->isReady()) {
+        const quint64 targetUSecs = _logStartTimeUSecs + static_cast<quint64>((percentComplete / 100.0) * _logDurationUSecs);
+        seeked = _seekToTime(targetUSecs);
+    } else {
+        // Index is still being built, the best we can do is estimate the position from the file size
+        seeked = _seekToFilePosition(percentComplete);
+    }
+    if (!seeked) {
         _replayError(tr("Unable to seek to new position"));
         return;
     }
 
+    _signalCurrentLogTimeSecs();
+
+    // Now update the UI with our actual final position.
+    emit playbackPercentCompleteChanged(_percentComplete());
+}
+
+/// Positions the log on the first message at or after the specified time
+bool LogReplayLink::_seekToTime(quint64 timeUSecs)
+{
+    quint64 recordTimeUSecs = 0;
+    const qint64 recordOffset = _index->findRecord(_logFile, timeUSecs, recordTimeUSecs);
+    if (recordOffset < 0) {
+        return false;
+    }
+
+    // Leave the file at the start of the message, the same place _seekToNextMavlinkMessage leaves it
+    if (!_logFile.seek(recordOffset + cbTimestamp)) {
+        return false;
+    }
+    mavlink_reset_channel_status(_mavlinkChannel);
+    _logCurrentTimeUSecs = recordTimeUSecs;
+
+    return true;
+}
+
+/// Positions the log on the first message after the specified percentage of the file size
+bool LogReplayLink::_seekToFilePosition(qreal percentComplete)
+{
+    const qint64 newFilePos = static_cast<qint64>((percentComplete / 100.0) * _logFile.size());
+    if (!_logFile.seek(newFilePos)) {
+        return false;
+    }
+
     // But we do align to the next MAVLink message for consistency.
     mavlink_message_t dummy;
     _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
 
-    // Now calculate the current file location based on time.
-    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
+    return true;
+}
 
-    // Calculate the effective baud rate of the file in bytes/s.
-    qreal baudRate = _logFile.size() / (qreal)_logDurationUSecs / 1e6;
+qreal LogReplayLink::_percentComplete(void) const
+{
+    if ((_logDurationUSecs == 0) || (_logCurrentTimeUSecs < _logStartTimeUSecs)) {
+        return 0;
+    }
 
-    // And the desired time is:
-    qreal desiredTimeUSecs = percentCompleteMult * _logDurationUSecs;
+    return qMin(100.0, (static_cast<qreal>(_logCurrentTimeUSecs - _logStartTimeUSecs) / _logDurationUSecs) * 100.0);
+}
 
-    // And now jump the necessary number of bytes in the proper direction
-    qint64 offset = (newRelativeTimeUSecs - desiredTimeUSecs) * baudRate;
-    if (!_logFile.seek(_logFile.pos() + offset)) {
-        _replayError(tr("Unable to seek to new position"));
+void LogReplayLink::_indexBuilt(bool success)
+{
+    if (!success) {
+        _replayError(tr("The log file '%1' is corrupt or empty.").arg(_logReplayConfig->logFilename()));
+        _pause();
         return;
     }
 
-    // And scan until we reach the start of a MAVLink message. We make sure to record this timestamp for
-    // smooth jumping around the file.
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
-    _signalCurrentLogTimeSecs();
+    // Remember the start and end time so we can move around this _logFile with the slider.
+    _logStartTimeUSecs = _index->startTimeUSecs();
+    _logEndTimeUSecs = _index->endTimeUSecs();
+    _logDurationUSecs = _logEndTimeUSecs - _logStartTimeUSecs;
 
-    // Now update the UI with our actual final position.
-    newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
-    percentComplete = (newRelativeTimeUSecs / _logDurationUSecs) * 100;
-    emit playbackPercentCompleteChanged(percentComplete);
+    emit logFileStats(_logDurationUSecs / 1000000);
+    emit playbackPercentCompleteChanged(_percentComplete());
 }
 
 void LogReplayLink::_setPlaybackSpeed(qreal playbackSpeed)
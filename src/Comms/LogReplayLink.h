@@ -17,6 +17,7 @@
 #include <QtCore/QFile>
 
 class LinkManager;
+class LogReplayIndex;
 class MAVLinkProtocol;
 
 class LogReplayLinkConfiguration : public LinkConfiguration
@@ -96,6 +97,7 @@ private slots:
     void _play              (void);
     void _pause             (void);
     void _setPlaybackSpeed  (qreal playbackSpeed);
+    void _indexBuilt        (bool success);
 
 private:
 
@@ -105,8 +107,10 @@ private:
     void    _replayError                (const QString& errorMsg);
     quint64 _parseTimestamp             (const QByteArray& bytes);
     quint64 _seekToNextMavlinkMessage   (mavlink_message_t* nextMsg);
-    quint64 _findLastTimestamp          (void);
     quint64 _readNextMavlinkMessage     (QByteArray& bytes);
+    bool    _seekToTime                 (quint64 timeUSecs);
+    bool    _seekToFilePosition         (qreal percentComplete);
+    qreal   _percentComplete            (void) const;
     bool    _loadLogFile                (void);
     void    _finishPlayback             (void);
     void    _resetPlaybackToBeginning   (void);
@@ -135,6 +139,7 @@ private:
     MAVLinkProtocol*    _mavlink;
     QFile               _logFile;
     quint64             _logFileSize;
+    LogReplayIndex*     _index;             ///< Time to file offset index, built in the background after the log is opened
 
     static const int cbTimestamp = sizeof(quint64);
 };
@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLatencyHistogram.h"
+
+#include <QtCore/QVariantMap>
+
+void MAVLinkLatencyHistogram::reset()
+{
+    _counts.fill(0);
+    _sampleCount = 0;
+    _totalUsecs = 0;
+    _maxUsecs = 0;
+}
+
+void MAVLinkLatencyHistogram::addSample(qint64 latencyUsecs)
+{
+    int bucket = 0;
+    while (bucket < static_cast<int>(_bucketUpperUsecs.size()) && latencyUsecs > _bucketUpperUsecs[bucket]) {
+        bucket++;
+    }
+    _counts[bucket]++;
+    _sampleCount++;
+    _totalUsecs += latencyUsecs;
+    _maxUsecs = qMax(_maxUsecs, latencyUsecs);
+}
+
+qint64 MAVLinkLatencyHistogram::percentileUsecs(double percentile) const
+{
+    if (_sampleCount == 0) {
+        return 0;
+    }
+
+    const double target = _sampleCount * (percentile / 100.0);
+    uint64_t runningCount = 0;
+    for (int i = 0; i < bucketCount; i++) {
+        runningCount += _counts[i];
+        if (runningCount >= target) {
+            return (i < static_cast<int>(_bucketUpperUsecs.size())) ? _bucketUpperUsecs[i] : _maxUsecs;
+        }
+    }
+    return _maxUsecs;
+}
+
+QVariantList MAVLinkLatencyHistogram::buckets(void) const
+{
+    QVariantList list;
+    for (int i = 0; i < bucketCount; i++) {
+        QVariantMap bucket;
+        bucket[QStringLiteral("upperUsecs")] = (i < static_cast<int>(_bucketUpperUsecs.size())) ? _bucketUpperUsecs[i] : -1;
+        bucket[QStringLiteral("count")] = static_cast<qulonglong>(_counts[i]);
+        list.append(bucket);
+    }
+    return list;
+}
+
+QString MAVLinkLatencyHistogram::summary(void) const
+{
+    QString buckets;
+    for (int i = 0; i < bucketCount; i++) {
+        if (i < static_cast<int>(_bucketUpperUsecs.size())) {
+            buckets += QStringLiteral("<=%1us:%2 ").arg(_bucketUpperUsecs[i]).arg(_counts[i]);
+        } else {
+            buckets += QStringLiteral(">%1us:%2").arg(_bucketUpperUsecs.back()).arg(_counts[i]);
+        }
+    }
+    return QStringLiteral("samples:%1 mean:%2us p50:%3us p99:%4us max:%5us [%6]")
+            .arg(_sampleCount)
+            .arg(meanUsecs(), 0, 'f', 0)
+            .arg(percentileUsecs(50))
+            .arg(percentileUsecs(99))
+            .arg(_maxUsecs)
+            .arg(buckets);
+}
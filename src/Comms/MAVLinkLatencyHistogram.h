@@ -0,0 +1,51 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QVariantList>
+
+#include <array>
+
+/// Histogram of message latency from byte arrival on a link until the Vehicle the message
+/// is from has updated its FactGroups with it. Only accessed from the gui thread.
+class MAVLinkLatencyHistogram
+{
+public:
+    MAVLinkLatencyHistogram() { reset(); }
+
+    void reset();
+    void addSample(qint64 latencyUsecs);
+
+    uint64_t sampleCount(void) const { return _sampleCount; }
+    qint64 maxUsecs(void) const { return _maxUsecs; }
+    double meanUsecs(void) const { return _sampleCount ? static_cast<double>(_totalUsecs) / _sampleCount : 0; }
+
+    /// @return Approximate latency for the specified percentile (0-100) in usecs, upper bound of the bucket it falls in
+    qint64 percentileUsecs(double percentile) const;
+
+    /// @return List of { "upperUsecs": <bucket upper bound, -1 for overflow>, "count": <count> } maps
+    QVariantList buckets(void) const;
+
+    /// @return Single line summary suitable for logging
+    QString summary(void) const;
+
+    static constexpr int bucketCount = 14;
+
+private:
+    static constexpr std::array<qint64, bucketCount - 1> _bucketUpperUsecs = {
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000
+    };
+
+    std::array<uint64_t, bucketCount> _counts;
+    uint64_t    _sampleCount;
+    qint64      _totalUsecs;
+    qint64      _maxUsecs;
+};
@@ -0,0 +1,279 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogWriter.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+QGC_LOGGING_CATEGORY(MAVLinkLogWriterLog, "qgc.comms.mavlinklogwriter")
+
+MAVLinkLogWriter::MAVLinkLogWriter(QObject* parent, int bufferSize, int bufferCount)
+    : QThread       (parent)
+    , _bufferSize   (bufferSize)
+{
+    // Need at least two buffers so one can be filled while the other is written
+    bufferCount = qMax(bufferCount, 2);
+
+    _buffers.resize(bufferCount);
+    _bufferMessageCounts.resize(bufferCount, 0);
+    for (QByteArray& buffer: _buffers) {
+        buffer.reserve(_bufferSize);
+    }
+}
+
+MAVLinkLogWriter::~MAVLinkLogWriter()
+{
+    (void) stopWriting();
+}
+
+bool MAVLinkLogWriter::startWriting(QFile* file)
+{
+    if (isRunning()) {
+        qCWarning(MAVLinkLogWriterLog) << "startWriting called while already writing";
+        return false;
+    }
+
+    QMutexLocker locker(&_mutex);
+
+    _file = file;
+    _stopRequested = false;
+    _writeError = false;
+    _pendingBytes = 0;
+    _fillIndex = 0;
+    _freeBuffers.clear();
+    _fullBuffers.clear();
+    for (int i=0; i<static_cast<int>(_buffers.size()); i++) {
+        _buffers[i].resize(0);
+        _bufferMessageCounts[i] = 0;
+        if (i != _fillIndex) {
+            _freeBuffers.enqueue(i);
+        }
+    }
+    _accepting = true;
+
+    locker.unlock();
+
+    start();
+    return true;
+}
+
+bool MAVLinkLogWriter::stopWriting()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _accepting = false;
+        _stopRequested = true;
+        _dataAvailable.wakeAll();
+        _bufferAvailable.wakeAll();
+    }
+
+    if (isRunning()) {
+        (void) wait();
+    }
+
+    _file = nullptr;
+    return !_writeError;
+}
+
+bool MAVLinkLogWriter::append(quint64 timestampUsecs, const char* data, int length)
+{
+    const int recordSize = _timestampSize + length;
+
+    QMutexLocker locker(&_mutex);
+
+    if (!_accepting || _writeError) {
+        return false;
+    }
+
+    if (_buffers[_fillIndex].size() + recordSize > _bufferSize) {
+        if (recordSize > _bufferSize) {
+            qCWarning(MAVLinkLogWriterLog) << "Record larger than buffer size" << recordSize;
+            _messagesDropped++;
+            return true;
+        }
+        while (!_rotateFillBuffer()) {
+            if (_overflowPolicy == DropOnOverflow) {
+                _messagesDropped++;
+                return true;
+            }
+            _producerStalls++;
+            _bufferAvailable.wait(&_mutex);
+            if (!_accepting || _writeError) {
+                return false;
+            }
+        }
+        _dataAvailable.wakeOne();
+    }
+
+    QByteArray& buffer = _buffers[_fillIndex];
+    const qsizetype offset = buffer.size();
+    buffer.resize(offset + recordSize);
+    char* const record = buffer.data() + offset;
+    qToBigEndian(timestampUsecs, record);
+    (void) memcpy(record + _timestampSize, data, length);
+    _bufferMessageCounts[_fillIndex]++;
+
+    _pendingBytes += recordSize;
+    const int percent = static_cast<int>((_pendingBytes * 100) / (static_cast<qsizetype>(_bufferSize) * static_cast<qsizetype>(_buffers.size())));
+    if (percent > _queueHighWaterPercent) {
+        _queueHighWaterPercent = percent;
+    }
+
+    return true;
+}
+
+bool MAVLinkLogWriter::_rotateFillBuffer()
+{
+    if (_freeBuffers.isEmpty()) {
+        return false;
+    }
+    _fullBuffers.enqueue(_fillIndex);
+    _fillIndex = _freeBuffers.dequeue();
+    return true;
+}
+
+void MAVLinkLogWriter::resetStats()
+{
+    _messagesWritten = 0;
+    _bytesWritten = 0;
+    _messagesDropped = 0;
+    _producerStalls = 0;
+    _syncCount = 0;
+    _queueHighWaterPercent = 0;
+    _maxWriteMSecs = 0;
+    emit statsChanged();
+}
+
+void MAVLinkLogWriter::run()
+{
+    QElapsedTimer syncTimer;
+    QElapsedTimer statsTimer;
+    syncTimer.start();
+    statsTimer.start();
+
+    QMutexLocker locker(&_mutex);
+
+    while (true) {
+        if (_fullBuffers.isEmpty() && !_stopRequested) {
+            (void) _dataAvailable.wait(&_mutex, static_cast<unsigned long>(_flushIntervalMSecs.load()));
+        }
+
+        if (_fullBuffers.isEmpty() && !_buffers[_fillIndex].isEmpty()) {
+            // Flush interval expired, or we are stopping. Since the writer isn't holding a buffer
+            // at this point there is always a free one to swap in.
+            (void) _rotateFillBuffer();
+        }
+
+        if (_fullBuffers.isEmpty()) {
+            if (_stopRequested) {
+                break;
+            }
+            continue;
+        }
+
+        const int index = _fullBuffers.dequeue();
+        const QByteArray& buffer = _buffers[index];
+        const qsizetype bufferBytes = buffer.size();
+
+        // The buffer is owned by the writer thread until it goes back on the free list
+        locker.unlock();
+        const bool success = _writeBuffer(buffer);
+        if (success) {
+            _messagesWritten += _bufferMessageCounts[index];
+            _bytesWritten += bufferBytes;
+        }
+        const int syncIntervalMSecs = _syncIntervalMSecs;
+        if (success && (syncIntervalMSecs > 0) && syncTimer.hasExpired(syncIntervalMSecs)) {
+            _syncFile();
+            syncTimer.restart();
+        }
+        if (statsTimer.hasExpired(_statsIntervalMSecs)) {
+            _publishStats();
+            statsTimer.restart();
+        }
+        locker.relock();
+
+        _buffers[index].resize(0);
+        _bufferMessageCounts[index] = 0;
+        _pendingBytes -= bufferBytes;
+        _freeBuffers.enqueue(index);
+        _bufferAvailable.wakeAll();
+
+        if (!success) {
+            _writeError = true;
+            _bufferAvailable.wakeAll();
+            break;
+        }
+    }
+
+    locker.unlock();
+
+    if (!_writeError) {
+        _syncFile();
+    }
+    _publishStats();
+}
+
+void MAVLinkLogWriter::_publishStats()
+{
+    // The QThread object itself lives on the thread which created it, so this lands there
+    (void) QMetaObject::invokeMethod(this, [this]() {
+        emit statsChanged();
+    }, Qt::QueuedConnection);
+}
+
+bool MAVLinkLogWriter::_writeBuffer(const QByteArray& buffer)
+{
+    QElapsedTimer writeTimer;
+    writeTimer.start();
+
+    // Use the raw pointer overload so QIODevice copies the data instead of holding on to a
+    // shallow copy of our buffer, which would force a re-allocation on the next fill.
+    if (_file->write(buffer.constData(), buffer.size()) != buffer.size() || !_file->flush()) {
+        qCWarning(MAVLinkLogWriterLog) << "Write failed" << _file->fileName() << _file->errorString();
+        return false;
+    }
+
+    const int writeMSecs = static_cast<int>(writeTimer.elapsed());
+    if (writeMSecs > _maxWriteMSecs) {
+        _maxWriteMSecs = writeMSecs;
+    }
+
+    return true;
+}
+
+void MAVLinkLogWriter::_syncFile()
+{
+    const int handle = _file->handle();
+    if (handle < 0) {
+        return;
+    }
+
+#ifdef Q_OS_WIN
+    const int result = _commit(handle);
+#else
+    const int result = ::fsync(handle);
+#endif
+    if (result != 0) {
+        qCWarning(MAVLinkLogWriterLog) << "Sync failed" << _file->fileName();
+    } else {
+        _syncCount++;
+    }
+}
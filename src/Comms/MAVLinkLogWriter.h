@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <atomic>
+#include <vector>
+
+class QFile;
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogWriterLog)
+
+/// Writes telemetry log (tlog) records on a dedicated thread.
+///
+/// Callers append timestamp/frame pairs into the current fill buffer, which only costs a memcpy
+/// under a short lock. Full buffers are handed to the writer thread through a bounded ring of
+/// buffers while the caller keeps filling the next one. Partially filled buffers are also flushed
+/// after flushIntervalMSecs so the log on disk never lags far behind. The file is fsync'ed every
+/// syncIntervalMSecs.
+///
+/// If the disk can't keep up and all buffers are in use, new records are either dropped or the
+/// caller is blocked depending on the overflow policy. Both cases are counted and exposed as properties.
+class MAVLinkLogWriter : public QThread
+{
+    Q_OBJECT
+
+    Q_PROPERTY(quint64  messagesWritten         READ messagesWritten        NOTIFY statsChanged)
+    Q_PROPERTY(quint64  bytesWritten            READ bytesWritten           NOTIFY statsChanged)
+    Q_PROPERTY(quint64  messagesDropped         READ messagesDropped        NOTIFY statsChanged)
+    Q_PROPERTY(quint64  producerStalls          READ producerStalls         NOTIFY statsChanged)
+    Q_PROPERTY(int      queueHighWaterPercent   READ queueHighWaterPercent  NOTIFY statsChanged)
+    Q_PROPERTY(int      maxWriteMSecs           READ maxWriteMSecs          NOTIFY statsChanged)
+
+public:
+    enum OverflowPolicy {
+        DropOnOverflow,     ///< Drop the record when no buffer is free, the caller never waits on the disk
+        BlockOnOverflow,    ///< Wait for the writer thread to free up a buffer
+    };
+
+    MAVLinkLogWriter(QObject* parent = nullptr, int bufferSize = defaultBufferSize, int bufferCount = defaultBufferCount);
+    ~MAVLinkLogWriter();
+
+    /// Starts the writer thread on an already opened file. The caller must not touch the file
+    /// until stopWriting returns.
+    ///     @return false: Writer is already running
+    bool startWriting(QFile* file);
+
+    /// Writes out all queued records, syncs the file and stops the writer thread
+    ///     @return false: A write error occurred during this session
+    bool stopWriting();
+
+    /// Queues a record consisting of a big endian timestamp followed by the data. Thread safe.
+    ///     @return false: Writer not running or a previous write failed
+    bool append(quint64 timestampUsecs, const char* data, int length);
+
+    bool isWriting() const { return _accepting; }
+    bool writeError() const { return _writeError; }
+
+    void setOverflowPolicy(OverflowPolicy policy) { _overflowPolicy = policy; }
+    void setFlushIntervalMSecs(int msecs) { _flushIntervalMSecs = msecs; }
+    /// @param msecs 0 to only sync when writing stops
+    void setSyncIntervalMSecs(int msecs) { _syncIntervalMSecs = msecs; }
+
+    quint64 messagesWritten() const     { return _messagesWritten; }
+    quint64 bytesWritten() const        { return _bytesWritten; }
+    quint64 messagesDropped() const     { return _messagesDropped; }
+    quint64 producerStalls() const      { return _producerStalls; }
+    quint64 syncCount() const           { return _syncCount; }
+    int queueHighWaterPercent() const   { return _queueHighWaterPercent; }
+    int maxWriteMSecs() const           { return _maxWriteMSecs; }
+
+    Q_INVOKABLE void resetStats();
+
+    static constexpr int defaultBufferSize          = 64 * 1024;
+    static constexpr int defaultBufferCount         = 16;
+    static constexpr int defaultFlushIntervalMSecs  = 250;
+    static constexpr int defaultSyncIntervalMSecs   = 5000;
+
+signals:
+    /// Emitted on the thread which owns the writer, at most once a second while writing
+    void statsChanged();
+
+protected:
+    void run() final;
+
+private:
+    /// Moves the fill buffer to the write queue. Must be called with _mutex held.
+    ///     @return false: No free buffer to continue filling into
+    bool _rotateFillBuffer();
+    bool _writeBuffer(const QByteArray& buffer);
+    void _syncFile();
+    /// Queues statsChanged to the owning thread, the writer thread never emits it directly
+    void _publishStats();
+
+    QFile*                      _file                   = nullptr;
+    const int                   _bufferSize;
+    std::vector<QByteArray>     _buffers;
+    std::vector<int>            _bufferMessageCounts;
+    int                         _fillIndex              = 0;
+    QQueue<int>                 _freeBuffers;
+    QQueue<int>                 _fullBuffers;
+    qsizetype                   _pendingBytes           = 0;    ///< Bytes queued but not yet written
+    bool                        _stopRequested          = false;
+
+    QMutex                      _mutex;
+    QWaitCondition              _dataAvailable;
+    QWaitCondition              _bufferAvailable;
+
+    std::atomic<bool>           _accepting              {false};
+    std::atomic<bool>           _writeError             {false};
+    std::atomic<OverflowPolicy> _overflowPolicy         {DropOnOverflow};
+    std::atomic<int>            _flushIntervalMSecs     {defaultFlushIntervalMSecs};
+    std::atomic<int>            _syncIntervalMSecs      {defaultSyncIntervalMSecs};
+
+    std::atomic<quint64>        _messagesWritten        {0};
+    std::atomic<quint64>        _bytesWritten           {0};
+    std::atomic<quint64>        _messagesDropped        {0};
+    std::atomic<quint64>        _producerStalls         {0};
+    std::atomic<quint64>        _syncCount              {0};
+    std::atomic<int>            _queueHighWaterPercent  {0};
+    std::atomic<int>            _maxWriteMSecs          {0};
+
+    static constexpr int        _timestampSize          = sizeof(quint64);
+    static constexpr qint64     _statsIntervalMSecs     = 1000;
+};
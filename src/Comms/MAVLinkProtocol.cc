@@ -9,6 +9,7 @@
 
 #include "MAVLinkProtocol.h"
 #include "LinkManager.h"
+#include "MAVLinkLogWriter.h"
 #include "QGCApplication.h"
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
@@ -19,12 +20,15 @@
 #include <QtCore/QMetaType>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
 
 #include <QtQml/QtQml>
 
 Q_DECLARE_METATYPE(mavlink_message_t)
 
 QGC_LOGGING_CATEGORY(MAVLinkProtocolLog, "MAVLinkProtocolLog")
+QGC_LOGGING_CATEGORY(MAVLinkProtocolLatencyLog, "MAVLinkProtocolLatencyLog")
 
 static QObject* mavlinkSingletonFactory(QQmlEngine*, QJSEngine*)
 {
@@ -48,6 +52,7 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     , _logSuspendReplay(false)
     , _vehicleWasArmed(false)
     , _tempLogFile(QString("%2.%3").arg(_tempLogFileTemplate).arg(_logFileExtension))
+    , _logWriter(new MAVLinkLogWriter(this))
     , _linkMgr(nullptr)
     , _multiVehicleManager(nullptr)
 {
@@ -57,10 +62,20 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     memset(firstMessage,        1, sizeof(firstMessage));
     memset(&_status,            0, sizeof(_status));
     memset(&_message,           0, sizeof(_message));
+
+    _latencyTimer.start();
+    _latencyLogTimer.start();
+    _latencyStatsTimer.start();
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
 {
+    if (_protocolThread) {
+        // Nothing drains the message queues anymore
+        _setGuiThreadWaiting(true);
+        _protocolThread->quit();
+        _protocolThread->wait();
+    }
     storeSettings();
     _closeLogFile();
 }
@@ -68,17 +83,25 @@ MAVLinkProtocol::~MAVLinkProtocol()
 void MAVLinkProtocol::setVersion(unsigned version)
 {
     QList<SharedLinkInterfacePtr> sharedLinks = _linkMgr->links();
+    QList<uint8_t> mavlinkChannels;
 
     for (int i = 0; i < sharedLinks.length(); i++) {
-        mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(sharedLinks[i].get()->mavlinkChannel());
+        mavlinkChannels.append(sharedLinks[i].get()->mavlinkChannel());
+    }
 
-        // Set flags for version
-        if (version < 200) {
-            mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-        } else {
-            mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    // The channel status flags are also updated as messages are decoded
+    _runOnProtocolThread([mavlinkChannels, version]() {
+        for (const uint8_t mavlinkChannel: mavlinkChannels) {
+            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+
+            // Set flags for version
+            if (version < 200) {
+                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+            } else {
+                mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+            }
         }
-    }
+    });
 
     _current_version = version;
 }
@@ -91,6 +114,7 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    _multiVehicleManager =   _toolbox->multiVehicleManager();
 
    qmlRegisterSingletonType<QGCMAVLink>("MAVLink", 1, 0, "MAVLink", mavlinkSingletonFactory);
+   qmlRegisterUncreatableType<MAVLinkLogWriter>("QGroundControl", 1, 0, "MAVLinkLogWriter", "Reference only");
    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
 
    loadSettings();
@@ -105,6 +129,19 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded, this, &MAVLinkProtocol::_vehicleCountChanged);
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkProtocol::_vehicleCountChanged);
 
+   // Settings used while processing messages are cached so they can be read from the protocol thread
+   AppSettings* appSettings = _app->toolbox()->settingsManager()->appSettings();
+   connect(appSettings->forwardMavlink(),           &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateCachedSettings);
+   connect(appSettings->disableAllPersistence(),    &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateCachedSettings);
+   connect(appSettings->telemetrySave(),            &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateCachedSettings);
+   connect(appSettings->telemetrySaveNotArmed(),    &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateCachedSettings);
+   connect(_linkMgr, &LinkManager::mavlinkSupportForwardingEnabledChanged, this, &MAVLinkProtocol::_updateCachedSettings);
+   _updateCachedSettings();
+
+   if (appSettings->mavlinkProtocolThread()->rawValue().toBool()) {
+       _startProtocolThread();
+   }
+
    emit versionCheckChanged(m_enable_version_check);
 }
 
@@ -135,14 +172,40 @@ void MAVLinkProtocol::storeSettings()
 
 void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 {
-    int channel = link->mavlinkChannel();
-    totalReceiveCounter[channel] = 0;
-    totalLossCounter[channel]    = 0;
-    runningLossPercent[channel]  = 0.0f;
-    for(int i = 0; i < 256; i++) {
-        firstMessage[channel][i] =  1;
+    // The counters and the parser are used by whichever thread decodes messages
+    _runOnProtocolThread([this, link]() {
+        int channel = link->mavlinkChannel();
+        totalReceiveCounter[channel] = 0;
+        totalLossCounter[channel]    = 0;
+        runningLossPercent[channel]  = 0.0f;
+        for(int i = 0; i < 256; i++) {
+            firstMessage[channel][i] =  1;
+        }
+        _frameParsers[channel].reset();
+        link->setDecodedFirstMavlinkPacket(false);
+    });
+}
+
+/// Runs function on the protocol thread and waits for it to finish. Without a protocol thread, or when
+/// called on it, the function is run right away.
+void MAVLinkProtocol::_runOnProtocolThread(const std::function<void(void)>& function)
+{
+    if (!_protocolThread || !_protocolThread->isRunning() || (QThread::currentThread() == _protocolThread)) {
+        function();
+        return;
     }
-    link->setDecodedFirstMavlinkPacket(false);
+
+    // The protocol thread may be waiting on the gui thread to make room in a message queue
+    _setGuiThreadWaiting(true);
+    (void) QMetaObject::invokeMethod(_protocolThreadContext, function, Qt::BlockingQueuedConnection);
+    _setGuiThreadWaiting(false);
+}
+
+void MAVLinkProtocol::_setGuiThreadWaiting(bool waiting)
+{
+    QMutexLocker queueSpaceLocker(&_queueSpaceMutex);
+    _guiThreadWaiting = waiting;
+    _queueSpaceCondition.wakeAll();
 }
 
 /**
@@ -153,25 +216,13 @@ void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 
 void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
 
-    uint8_t bytes_time[sizeof(quint64)];
-
     Q_UNUSED(link);
     if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-
+        // The timestamp is prepended by the log writer, so there is no need to copy the bytes here
         quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
 
-        qToBigEndian(time,bytes_time);
-
-        b.insert(0,QByteArray((const char*)bytes_time,sizeof(bytes_time)));
-
-        int len = b.length();
-
-        if(_tempLogFile.write(b) != len)
-        {
-            // If there's an error logging data, raise an alert and stop logging.
-            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-            _stopLogging();
-            _logSuspendError = true;
+        if (!_logWriter->append(time, b.constData(), b.size())) {
+            _logWriteFailed();
         }
     }
 
@@ -180,13 +231,70 @@ void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
 /**
  * This method parses all incoming bytes and constructs a MAVLink packet.
  * It can handle multiple links in parallel, as each link has it's own buffer/
- * parsing state machine.
+ * parsing state machine. Frames are located in bulk by MAVLinkFrameParser and
+ * the raw frame bytes are reused for forwarding and logging.
  * @param link The interface to read from
  * @see LinkInterface
  **/
 
 void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 {
+    linkBytesReceived(link, b);
+}
+
+/// Connected directly to LinkInterface::bytesReceived, so this is called on the link's thread.
+/// The arrival time is captured here and the bytes are then handed to either the gui thread
+/// or the protocol thread for processing.
+void MAVLinkProtocol::linkBytesReceived(LinkInterface* link, const QByteArray& b)
+{
+    const qint64 arrivalNsecs = _latencyTimer.nsecsElapsed();
+    (void) QMetaObject::invokeMethod(_receiveContext(), [this, link, b, arrivalNsecs]() {
+        _receiveBytes(link, b, arrivalNsecs);
+    });
+}
+
+/// Connected directly to LinkInterface::bytesSent, so this is called on the link's thread.
+void MAVLinkProtocol::linkBytesSent(LinkInterface* link, const QByteArray& b)
+{
+    (void) QMetaObject::invokeMethod(_receiveContext(), [this, link, b]() {
+        logSentBytes(link, b);
+    });
+}
+
+QObject* MAVLinkProtocol::_receiveContext(void)
+{
+    return _protocolThread ? _protocolThreadContext : this;
+}
+
+void MAVLinkProtocol::_receiveBytes(LinkInterface* link, const QByteArray& b, qint64 arrivalNsecs)
+{
+    if (_protocolThread) {
+        // The link list can't be accessed from this thread. Holding the mutex while the buffer is
+        // parsed keeps the link from going away underneath us, since unregisterLink waits on it.
+        QMutexLocker threadLinksLocker(&_threadLinksMutex);
+        const auto threadLink = _threadLinks.constFind(link);
+        if (threadLink == _threadLinks.constEnd()) {
+            qCDebug(MAVLinkProtocolLog) << "receiveBytes: link gone!" << b.size() << " bytes arrived too late";
+            return;
+        }
+
+        const WeakLinkInterfacePtr weakLink = threadLink.value();
+        const uint8_t mavlinkChannel = link->mavlinkChannel();
+        const uint64_t badCRCCount = _frameParsers[mavlinkChannel].badCRCCount();
+        (void) _frameParsers[mavlinkChannel].parse(b, [this, link, &weakLink, mavlinkChannel, arrivalNsecs, &threadLinksLocker](const MAVLinkFrameParser::Frame& frame) {
+            if (!_decodeFrame(mavlinkChannel, frame)) {
+                return true;
+            }
+            _handleFrame(link, mavlinkChannel, frame, arrivalNsecs);
+            const bool linkValid = _queueMessage(link, weakLink, mavlinkChannel, arrivalNsecs, threadLinksLocker);
+            memset(&_status,  0, sizeof(_status));
+            memset(&_message, 0, sizeof(_message));
+            return linkValid;
+        });
+        _countRejectedFrames(mavlinkChannel, badCRCCount);
+        return;
+    }
+
     // Since receiveBytes signals cross threads we can end up with signals in the queue
     // that come through after the link is disconnected. For these we just drop the data
     // since the link is closed.
@@ -197,195 +305,372 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
     }
 
     uint8_t mavlinkChannel = link->mavlinkChannel();
+    const uint64_t badCRCCount = _frameParsers[mavlinkChannel].badCRCCount();
 
-    for (int position = 0; position < b.size(); position++) {
-        if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
-            // Got a valid message
-            if (!link->decodedFirstMavlinkPacket()) {
-                link->setDecodedFirstMavlinkPacket(true);
-                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-                    // Set all links to v2
-                    setVersion(200);
-                }
-            }
+    (void) _frameParsers[mavlinkChannel].parse(b, [this, link, &linkPtr, mavlinkChannel, arrivalNsecs](const MAVLinkFrameParser::Frame& frame) {
+        if (!_decodeFrame(mavlinkChannel, frame)) {
+            return true;
+        }
 
-            //-----------------------------------------------------------------
-            // MAVLink Status
-            uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
-            uint8_t expectedSeq = lastSeq + 1;
-            // Increase receive counter
-            totalReceiveCounter[mavlinkChannel]++;
-            // Determine what the next expected sequence number is, accounting for
-            // never having seen a message for this system/component pair.
-            if(firstMessage[_message.sysid][_message.compid]) {
-                firstMessage[_message.sysid][_message.compid] = 0;
-                lastSeq     = _message.seq;
-                expectedSeq = _message.seq;
-            }
-            // And if we didn't encounter that sequence number, record the error
-            //int foo = 0;
-            if (_message.seq != expectedSeq)
-            {
-                //foo = 1;
-                int lostMessages = 0;
-                //-- Account for overflow during packet loss
-                if(_message.seq < expectedSeq) {
-                    lostMessages = (_message.seq + 255) - expectedSeq;
-                } else {
-                    lostMessages = _message.seq - expectedSeq;
-                }
-                // Log how many were lost
-                totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
-            }
+        _handleFrame(link, mavlinkChannel, frame, arrivalNsecs);
 
-            // And update the last sequence number for this system/component pair
-            lastIndex[_message.sysid][_message.compid] = _message.seq;;
-            // Calculate new loss ratio
-            uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
-            float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
-            receiveLossPercent *= 100.0f;
-            receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
-            runningLossPercent[mavlinkChannel] = receiveLossPercent;
-
-            //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
-
-            //-----------------------------------------------------------------
-            // MAVLink forwarding
-            bool forwardingEnabled = _app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool();
-            if (_message.msgid == MAVLINK_MSG_ID_SETUP_SIGNING) {
-                forwardingEnabled = false;
-            }
-            if (forwardingEnabled) {
-                SharedLinkInterfacePtr forwardingLink = _linkMgr->mavlinkForwardingLink();
-
-                if (forwardingLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingLink->writeBytesThreadSafe((const char*)buf, len);
-                }
-            }
+        // Anyone handling the message could close the connection, which deletes the link,
+        // so we check if it's expired
+        if (1 == linkPtr.use_count()) {
+            return false;
+        }
 
-            // MAVLink forwarding support
-            bool forwardingSupportEnabled = _linkMgr->mavlinkSupportForwardingEnabled();
-            if (_message.msgid == MAVLINK_MSG_ID_SETUP_SIGNING) {
-                forwardingSupportEnabled = false;
-            }
-            if (forwardingSupportEnabled) {
-                SharedLinkInterfacePtr forwardingSupportLink = _linkMgr->mavlinkForwardingSupportLink();
-
-                if (forwardingSupportLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingSupportLink->writeBytesThreadSafe((const char*)buf, len);
-                }
-            }
+        // Reset message parsing
+        memset(&_status,  0, sizeof(_status));
+        memset(&_message, 0, sizeof(_message));
 
-            //-----------------------------------------------------------------
-            // Log data
-            if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN+sizeof(quint64)];
-
-                // Write the uint64 time in microseconds in big endian format before the message.
-                // This timestamp is saved in UTC time. We are only saving in ms precision because
-                // getting more than this isn't possible with Qt without a ton of extra code.
-                quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-                qToBigEndian(time, buf);
-
-                // Then write the message to the buffer
-                int len = mavlink_msg_to_send_buffer(buf + sizeof(quint64), &_message);
-
-                // Determine how many bytes were written by adding the timestamp size to the message size
-                len += sizeof(quint64);
-
-                // Now write this timestamp/message pair to the log.
-                QByteArray b(reinterpret_cast<const char*>(buf), len);
-                if(_tempLogFile.write(b) != len)
-                {
-                    // If there's an error logging data, raise an alert and stop logging.
-                    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-                    _stopLogging();
-                    _logSuspendError = true;
-                }
-
-                // Check for the vehicle arming going by. This is used to trigger log save.
-                if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                    mavlink_heartbeat_t state;
-                    mavlink_msg_heartbeat_decode(&_message, &state);
-                    if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
-                        _vehicleWasArmed = true;
-                    }
-                }
-            }
+        return true;
+    });
 
-            if (_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                _startLogging();
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&_message, &heartbeat);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, heartbeat.autopilot, heartbeat.type);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
-                _startLogging();
-                mavlink_high_latency_t highLatency;
-                mavlink_msg_high_latency_decode(&_message, &highLatency);
-                // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
-                _startLogging();
-                mavlink_high_latency2_t highLatency2;
-                mavlink_msg_high_latency2_decode(&_message, &highLatency2);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, highLatency2.autopilot, highLatency2.type);
+    _countRejectedFrames(mavlinkChannel, badCRCCount);
+}
+
+/// mavlink_parse_char counts every bad frame as a parse error and a drop in the channel status.
+/// Do the same for the frames the block parser threw away, so link statistics stay the same.
+///     @param previousBadCRCCount Bad frame count of the channel parser before the buffer was parsed
+void MAVLinkProtocol::_countRejectedFrames(uint8_t mavlinkChannel, uint64_t previousBadCRCCount)
+{
+    const uint64_t badCRCCount = _frameParsers[mavlinkChannel].badCRCCount();
+
+    // The parser is reset along with the link metadata, which may happen while handling a message
+    if (badCRCCount <= previousBadCRCCount) {
+        return;
+    }
+
+    const uint64_t rejected = badCRCCount - previousBadCRCCount;
+    mavlink_status_t* const mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+    mavlinkStatus->parse_error += static_cast<uint8_t>(rejected);
+    mavlinkStatus->packet_rx_drop_count += static_cast<uint16_t>(rejected);
+}
+
+/// Decodes a frame found by the frame parser into _message
+///     @return false: frame was rejected (bad signature)
+bool MAVLinkProtocol::_decodeFrame(uint8_t mavlinkChannel, const MAVLinkFrameParser::Frame& frame)
+{
+    mavlink_status_t* const mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+
+    if (frame.isSigned() || mavlinkStatus->signing) {
+        // Signature verification is done by mavlink_parse_char, so signed traffic still runs
+        // through the byte parser. Since the frame is complete the parser ends up idle again.
+        for (int i = 0; i < frame.length; i++) {
+            if (mavlink_parse_char(mavlinkChannel, frame.data[i], &_message, &_status)) {
+                return true;
             }
+        }
+        return false;
+    }
 
-#if 0
-            // Given the current state of SiK Radio firmwares there is no way to make the code below work.
-            // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
-            // packet even if the vehicle is sending Mavlink 2.
+    MAVLinkFrameParser::decode(frame, &_message);
 
-            // Detect if we are talking to an old radio not supporting v2
-            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-            if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
-                if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
-                && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    _radio_version_mismatch_count++;
-                }
+    // Keep the channel status in sync the same way mavlink_parse_char would
+    if (frame.isMavlink1()) {
+        mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    } else {
+        mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+    mavlinkStatus->current_rx_seq = _message.seq;
+    mavlinkStatus->packet_rx_success_count++;
+
+    return true;
+}
+
+void MAVLinkProtocol::_handleFrame(LinkInterface* link, uint8_t mavlinkChannel, const MAVLinkFrameParser::Frame& frame, qint64 arrivalNsecs)
+{
+    if (!link->decodedFirstMavlinkPacket()) {
+        link->setDecodedFirstMavlinkPacket(true);
+        mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+        if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+            qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+            mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+            // Set all links to v2. setVersion walks the link list, which must be done from the gui thread.
+            if (_protocolThread) {
+                (void) QMetaObject::invokeMethod(this, [this]() { setVersion(200); }, Qt::QueuedConnection);
+            } else {
+                setVersion(200);
             }
+        }
+    }
 
-            if (_radio_version_mismatch_count == 5) {
-                // Warn the user if the radio continues to send v1 while the link uses v2
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
-                // Set to flag warning already shown
-                _radio_version_mismatch_count = -1;
-                // Flick link back to v1
-                qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    //-----------------------------------------------------------------
+    // MAVLink Status
+    uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
+    uint8_t expectedSeq = lastSeq + 1;
+    // Increase receive counter
+    totalReceiveCounter[mavlinkChannel]++;
+    // Determine what the next expected sequence number is, accounting for
+    // never having seen a message for this system/component pair.
+    if(firstMessage[_message.sysid][_message.compid]) {
+        firstMessage[_message.sysid][_message.compid] = 0;
+        lastSeq     = _message.seq;
+        expectedSeq = _message.seq;
+    }
+    // And if we didn't encounter that sequence number, record the error
+    //int foo = 0;
+    if (_message.seq != expectedSeq)
+    {
+        //foo = 1;
+        int lostMessages = 0;
+        //-- Account for overflow during packet loss
+        if(_message.seq < expectedSeq) {
+            lostMessages = (_message.seq + 255) - expectedSeq;
+        } else {
+            lostMessages = _message.seq - expectedSeq;
+        }
+        // Log how many were lost
+        totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
+    }
+
+    // And update the last sequence number for this system/component pair
+    lastIndex[_message.sysid][_message.compid] = _message.seq;;
+    // Calculate new loss ratio
+    uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
+    float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
+    receiveLossPercent *= 100.0f;
+    receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
+    runningLossPercent[mavlinkChannel] = receiveLossPercent;
+
+    //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
+
+    //-----------------------------------------------------------------
+    // MAVLink forwarding
+    bool forwardingEnabled = _forwardMavlink;
+    if (_message.msgid == MAVLINK_MSG_ID_SETUP_SIGNING) {
+        forwardingEnabled = false;
+    }
+    if (forwardingEnabled && _protocolThread) {
+        // Link list is not thread safe, use the forwarding link cached by registerLink
+        if (_threadForwardingLink) {
+            _threadForwardingLink->writeBytesThreadSafe(reinterpret_cast<const char*>(frame.data), frame.length);
+        }
+    } else if (forwardingEnabled) {
+        SharedLinkInterfacePtr forwardingLink = _linkMgr->mavlinkForwardingLink();
+
+        if (forwardingLink) {
+            forwardingLink->writeBytesThreadSafe(reinterpret_cast<const char*>(frame.data), frame.length);
+        }
+    }
+
+    // MAVLink forwarding support
+    bool forwardingSupportEnabled = _supportForwardingEnabled;
+    if (_message.msgid == MAVLINK_MSG_ID_SETUP_SIGNING) {
+        forwardingSupportEnabled = false;
+    }
+    if (forwardingSupportEnabled && _protocolThread) {
+        if (_threadForwardingSupportLink) {
+            _threadForwardingSupportLink->writeBytesThreadSafe(reinterpret_cast<const char*>(frame.data), frame.length);
+        }
+    } else if (forwardingSupportEnabled) {
+        SharedLinkInterfacePtr forwardingSupportLink = _linkMgr->mavlinkForwardingSupportLink();
+
+        if (forwardingSupportLink) {
+            forwardingSupportLink->writeBytesThreadSafe(reinterpret_cast<const char*>(frame.data), frame.length);
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // Log data
+    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
+        // The log writer writes the uint64 time in microseconds in big endian format before the message.
+        // This timestamp is saved in UTC time. We are only saving in ms precision because
+        // getting more than this isn't possible with Qt without a ton of extra code.
+        quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+
+        // The raw frame bytes are queued as is, the actual file write happens on the log writer thread
+        if (!_logWriter->append(time, reinterpret_cast<const char*>(frame.data), frame.length)) {
+            _logWriteFailed();
+        }
+
+        // Check for the vehicle arming going by. This is used to trigger log save.
+        if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            mavlink_heartbeat_t state;
+            mavlink_msg_heartbeat_decode(&_message, &state);
+            if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
+                _vehicleWasArmed = true;
             }
+        }
+    }
+
+    if ((_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) || (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) || (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2)) {
+        _startLogging();
+    }
+
+#if 0
+    // Given the current state of SiK Radio firmwares there is no way to make the code below work.
+    // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
+    // packet even if the vehicle is sending Mavlink 2.
+
+    // Detect if we are talking to an old radio not supporting v2
+    mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+    if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
+        if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
+        && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+            _radio_version_mismatch_count++;
+        }
+    }
+
+    if (_radio_version_mismatch_count == 5) {
+        // Warn the user if the radio continues to send v1 while the link uses v2
+        emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
+        // Set to flag warning already shown
+        _radio_version_mismatch_count = -1;
+        // Flick link back to v1
+        qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+        mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    }
 #endif
 
-            // Update MAVLink status on every 32th packet
-            if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
-                emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
-            }
+    // Update MAVLink status on every 32th packet
+    if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
+        emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
+    }
+
+    // On the protocol thread the message is queued for the gui thread by _receiveBytes
+    if (!_protocolThread) {
+        _emitMessage(link, _message, arrivalNsecs);
+    }
+}
+
+/// Emits the vehicle heartbeat info and message received signals for a decoded message.
+/// Always called on the gui thread.
+void MAVLinkProtocol::_emitMessage(LinkInterface* link, const mavlink_message_t& message, qint64 arrivalNsecs)
+{
+    if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, heartbeat.autopilot, heartbeat.type);
+    } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
+        // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
+    } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
+        mavlink_high_latency2_t highLatency2;
+        mavlink_msg_high_latency2_decode(&message, &highLatency2);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, highLatency2.autopilot, highLatency2.type);
+    }
 
-            // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-            // kind of inefficient, but no issue for a groundstation pc.
-            // It buys as reentrancy for the whole code over all threads
-            emit messageReceived(link, _message);
+    // The packet is emitted as a whole, as it is only 255 - 261 bytes short
+    // kind of inefficient, but no issue for a groundstation pc.
+    // It buys as reentrancy for the whole code over all threads
+    // Vehicle is connected directly and calls factGroupsUpdated from within its handler
+    _deliveryArrivalNsecs = arrivalNsecs;
+    emit messageReceived(link, message);
+    _deliveryArrivalNsecs = -1;
+}
+
+void MAVLinkProtocol::factGroupsUpdated(void)
+{
+    // Only the first Vehicle to update its FactGroups counts, which is the one the message is from
+    if (_deliveryArrivalNsecs < 0) {
+        return;
+    }
+
+    _latencyHistogram.addSample((_latencyTimer.nsecsElapsed() - _deliveryArrivalNsecs) / 1000);
+    _deliveryArrivalNsecs = -1;
+
+    if (_latencyStatsTimer.elapsed() > _latencyStatsIntervalMSecs) {
+        _latencyStatsTimer.restart();
+        emit latencyStatsChanged();
+    }
+    if (_latencyLogTimer.elapsed() > _latencyLogIntervalMSecs) {
+        _latencyLogTimer.restart();
+        qCDebug(MAVLinkProtocolLatencyLog) << (_protocolThread ? "protocol thread" : "gui thread") << _latencyHistogram.summary();
+    }
+}
+
+void MAVLinkProtocol::resetLatencyHistogram(void)
+{
+    _latencyHistogram.reset();
+    _latencyStatsTimer.restart();
+    emit latencyStatsChanged();
+}
 
-            // Anyone handling the message could close the connection, which deletes the link,
-            // so we check if it's expired
-            if (1 == linkPtr.use_count()) {
-                break;
+/// Hands the decoded message over to the gui thread. Called on the protocol thread.
+///     @param threadLinksLocker Holds _threadLinksMutex, released while waiting for the gui thread
+///     @return false: The link went away while waiting
+bool MAVLinkProtocol::_queueMessage(LinkInterface* link, const WeakLinkInterfacePtr& weakLink, uint8_t mavlinkChannel, qint64 arrivalNsecs, QMutexLocker<QMutex>& threadLinksLocker)
+{
+    QGCSPSCQueue<QueuedMessage>* const queue = _messageQueues[mavlinkChannel].get();
+    const QueuedMessage queuedMessage = { weakLink, _message, arrivalNsecs };
+
+    while (!queue->tryPush(queuedMessage)) {
+        // The gui thread has fallen behind. Apply back pressure to the link rather than dropping
+        // messages. The link list is released meanwhile so the gui thread can still change it.
+        _scheduleDrain();
+        threadLinksLocker.unlock();
+        const bool queueSpace = _waitForQueueSpace(queue);
+        threadLinksLocker.relock();
+
+        // A new link may have been registered at the same address meanwhile, so compare ownership
+        const WeakLinkInterfacePtr threadLink = _threadLinks.value(link);
+        if (threadLink.owner_before(weakLink) || weakLink.owner_before(threadLink) || weakLink.expired()) {
+            return false;
+        }
+        if (!queueSpace) {
+            // The gui thread is waiting on us, so it won't drain the queue until we move on
+            if ((_queueOverflowCount++ % 100) == 0) {
+                qCWarning(MAVLinkProtocolLog) << "Message queue overflow, messages dropped:" << _queueOverflowCount;
             }
+            return true;
+        }
+    }
 
-            // Reset message parsing
-            memset(&_status,  0, sizeof(_status));
-            memset(&_message, 0, sizeof(_message));
+    _scheduleDrain();
+
+    return true;
+}
+
+/// Waits for the gui thread to make room in a full message queue. Called on the protocol thread.
+///     @return false: The gui thread is waiting on the protocol thread
+bool MAVLinkProtocol::_waitForQueueSpace(const QGCSPSCQueue<QueuedMessage>* queue)
+{
+    QMutexLocker queueSpaceLocker(&_queueSpaceMutex);
+
+    while (queue->size() >= queue->capacity()) {
+        if (_guiThreadWaiting) {
+            return false;
         }
+        (void) _queueSpaceCondition.wait(&_queueSpaceMutex, _queueSpaceWaitMSecs);
+    }
+
+    return true;
+}
+
+void MAVLinkProtocol::_scheduleDrain(void)
+{
+    // Only a single drain is outstanding at any time. This coalesces all messages which arrive
+    // before the gui thread gets around to it into a single event loop pass.
+    if (!_drainPending.exchange(true)) {
+        (void) QMetaObject::invokeMethod(this, &MAVLinkProtocol::_drainMessageQueues, Qt::QueuedConnection);
     }
 }
 
+void MAVLinkProtocol::_drainMessageQueues(void)
+{
+    _drainPending = false;
+
+    QueuedMessage queuedMessage;
+    for (const std::unique_ptr<QGCSPSCQueue<QueuedMessage>>& queue: _messageQueues) {
+        // Only take what is there now, anything arriving while we work is picked up by the next drain
+        size_t count = queue->size();
+        while (count-- && queue->tryPop(queuedMessage)) {
+            // Anyone handling a previous message could have closed the connection
+            const SharedLinkInterfacePtr link = queuedMessage.link.lock();
+            if (!link || !_linkMgr->containsLink(link.get())) {
+                continue;
+            }
+            _emitMessage(link.get(), queuedMessage.message, queuedMessage.arrivalNsecs);
+        }
+    }
+
+    // Let a protocol thread which is waiting for room know about it
+    QMutexLocker queueSpaceLocker(&_queueSpaceMutex);
+    _queueSpaceCondition.wakeAll();
+}
+
 /**
  * @return The name of this protocol
  **/
@@ -421,16 +706,83 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
 {
     int count = _multiVehicleManager->vehicles()->count();
     if (count == 0) {
-        // Last vehicle is gone, close out logging
-        _stopLogging();
+        // Last vehicle is gone, close out logging. The log file belongs to the protocol thread if there is one.
+        if (_protocolThread) {
+            (void) QMetaObject::invokeMethod(_protocolThreadContext, [this]() { _stopLogging(); }, Qt::QueuedConnection);
+        } else {
+            _stopLogging();
+        }
         _radio_version_mismatch_count = 0;
     }
 }
 
+void MAVLinkProtocol::_updateCachedSettings(void)
+{
+    AppSettings* appSettings = _app->toolbox()->settingsManager()->appSettings();
+
+    _forwardMavlink             = appSettings->forwardMavlink()->rawValue().toBool();
+    _disableAllPersistence      = appSettings->disableAllPersistence()->rawValue().toBool();
+    _telemetrySave              = appSettings->telemetrySave()->rawValue().toBool();
+    _telemetrySaveNotArmed      = appSettings->telemetrySaveNotArmed()->rawValue().toBool();
+    _supportForwardingEnabled   = _linkMgr->mavlinkSupportForwardingEnabled();
+}
+
+void MAVLinkProtocol::_startProtocolThread(void)
+{
+    for (std::unique_ptr<QGCSPSCQueue<QueuedMessage>>& queue: _messageQueues) {
+        queue = std::make_unique<QGCSPSCQueue<QueuedMessage>>(_messageQueueCapacity);
+    }
+
+    _protocolThreadContext = new QObject();
+    _protocolThread = new QThread(this);
+    _protocolThread->setObjectName(QStringLiteral("MAVLinkProtocol"));
+    _protocolThreadContext->moveToThread(_protocolThread);
+    connect(_protocolThread, &QThread::finished, _protocolThreadContext, &QObject::deleteLater);
+    _protocolThread->start();
+
+    qCDebug(MAVLinkProtocolLog) << "MAVLink processing running on protocol thread";
+}
+
+void MAVLinkProtocol::registerLink(const SharedLinkInterfacePtr& link)
+{
+    if (!_protocolThread) {
+        return;
+    }
+
+    QMutexLocker threadLinksLocker(&_threadLinksMutex);
+    _threadLinks.insert(link.get(), link);
+    _updateThreadForwardingLinks();
+}
+
+void MAVLinkProtocol::unregisterLink(LinkInterface* link)
+{
+    if (!_protocolThread) {
+        return;
+    }
+
+    QMutexLocker threadLinksLocker(&_threadLinksMutex);
+    _threadLinks.remove(link);
+    _updateThreadForwardingLinks();
+}
+
+/// Must be called with _threadLinksMutex held
+void MAVLinkProtocol::_updateThreadForwardingLinks(void)
+{
+    // The link manager may still hold a link which is being unregistered, so only take registered ones
+    LinkInterface* forwardingLink = _linkMgr->mavlinkForwardingLink().get();
+    LinkInterface* forwardingSupportLink = _linkMgr->mavlinkForwardingSupportLink().get();
+
+    _threadForwardingLink = _threadLinks.contains(forwardingLink) ? forwardingLink : nullptr;
+    _threadForwardingSupportLink = _threadLinks.contains(forwardingSupportLink) ? forwardingSupportLink : nullptr;
+}
+
 /// @brief Closes the log file if it is open
 bool MAVLinkProtocol::_closeLogFile(void)
 {
     if (_tempLogFile.isOpen()) {
+        // Make sure everything queued has hit the disk before looking at the file
+        (void) _logWriter->stopWriting();
+
         if (_tempLogFile.size() == 0) {
             // Don't save zero byte files
             _tempLogFile.remove();
@@ -450,13 +802,12 @@ void MAVLinkProtocol::_startLogging(void)
     if (qgcApp()->runningUnitTests()) {
         return;
     }
-    AppSettings* appSettings = _app->toolbox()->settingsManager()->appSettings();
-    if(appSettings->disableAllPersistence()->rawValue().toBool()) {
+    if(_disableAllPersistence) {
         return;
     }
 #ifdef __mobile__
     //-- Mobile build don't write to /tmp unless told to do so
-    if (!appSettings->telemetrySave()->rawValue().toBool()) {
+    if (!_telemetrySave) {
         return;
     }
 #endif
@@ -473,6 +824,7 @@ void MAVLinkProtocol::_startLogging(void)
             }
 
             qCDebug(MAVLinkProtocolLog) << "Temp log" << _tempLogFile.fileName();
+            (void) _logWriter->startWriting(&_tempLogFile);
             emit checkTelemetrySavePath();
 
             _logSuspendError = false;
@@ -480,13 +832,20 @@ void MAVLinkProtocol::_startLogging(void)
     }
 }
 
+/// Called when the log writer reports that a write to the log file failed
+void MAVLinkProtocol::_logWriteFailed(void)
+{
+    // If there's an error logging data, raise an alert and stop logging.
+    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
+    _stopLogging();
+    _logSuspendError = true;
+}
+
 void MAVLinkProtocol::_stopLogging(void)
 {
     if (_tempLogFile.isOpen()) {
         if (_closeLogFile()) {
-            if ((_vehicleWasArmed || _app->toolbox()->settingsManager()->appSettings()->telemetrySaveNotArmed()->rawValue().toBool()) &&
-                _app->toolbox()->settingsManager()->appSettings()->telemetrySave()->rawValue().toBool() &&
-                !_app->toolbox()->settingsManager()->appSettings()->disableAllPersistence()->rawValue().toBool()) {
+            if ((_vehicleWasArmed || _telemetrySaveNotArmed) && _telemetrySave && !_disableAllPersistence) {
                 emit saveTelemetryLog(_tempLogFile.fileName());
             } else {
                 QFile::remove(_tempLogFile.fileName());
@@ -10,19 +10,32 @@
 #pragma once
 
 #include "LinkInterface.h"
+#include "MAVLinkFrameParser.h"
+#include "MAVLinkLatencyHistogram.h"
 #include "QGCMAVLink.h"
+#include "QGCSPSCQueue.h"
 #include "QGCTemporaryFile.h"
 #include "QGCToolbox.h"
 
 #include <QtCore/QString>
 #include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+#include <QtCore/QHash>
+#include <QtCore/QWaitCondition>
+
+#include <atomic>
+#include <functional>
+#include <memory>
 
 class LinkManager;
+class MAVLinkLogWriter;
 class MultiVehicleManager;
 class QGCApplication;
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkProtocolLog)
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkProtocolLatencyLog)
 
 /**
  * @brief MAVLink micro air vehicle protocol reference implementation.
@@ -34,6 +47,12 @@ class MAVLinkProtocol : public QGCTool
 {
     Q_OBJECT
 
+    Q_PROPERTY(quint64  latencySampleCount  READ latencySampleCount NOTIFY latencyStatsChanged)
+    Q_PROPERTY(double   latencyMeanUsecs    READ latencyMeanUsecs   NOTIFY latencyStatsChanged)
+    Q_PROPERTY(qint64   latencyP50Usecs     READ latencyP50Usecs    NOTIFY latencyStatsChanged)
+    Q_PROPERTY(qint64   latencyP99Usecs     READ latencyP99Usecs    NOTIFY latencyStatsChanged)
+    Q_PROPERTY(qint64   latencyMaxUsecs     READ latencyMaxUsecs    NOTIFY latencyStatsChanged)
+
 public:
     MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox);
     ~MAVLinkProtocol();
@@ -71,10 +90,40 @@ public:
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
+    /// true: Parsing, loss accounting, forwarding and logging run on a dedicated protocol thread.
+    /// Decoded messages are handed to the gui thread through a lock-free queue per channel.
+    bool protocolThreadEnabled() const { return _protocolThread != nullptr; }
+
+    /// Latency from byte arrival until the Vehicle has updated its FactGroups with the message
+    const MAVLinkLatencyHistogram& latencyHistogram() const { return _latencyHistogram; }
+    Q_INVOKABLE void resetLatencyHistogram();
+
+    quint64 latencySampleCount  (void) const { return _latencyHistogram.sampleCount(); }
+    double  latencyMeanUsecs    (void) const { return _latencyHistogram.meanUsecs(); }
+    qint64  latencyP50Usecs     (void) const { return _latencyHistogram.percentileUsecs(50); }
+    qint64  latencyP99Usecs     (void) const { return _latencyHistogram.percentileUsecs(99); }
+    qint64  latencyMaxUsecs     (void) const { return _latencyHistogram.maxUsecs(); }
+
+    /// Called by Vehicle once its FactGroups have handled the message currently being delivered
+    /// by messageReceived. Takes the latency sample for that message. Gui thread only.
+    void factGroupsUpdated(void);
+
+    /// Writes the telemetry log on a background thread
+    MAVLinkLogWriter* logWriter() { return _logWriter; }
+
+    /// Called by LinkManager as links are created and removed. Tells the protocol thread which links are valid.
+    void registerLink(const SharedLinkInterfacePtr& link);
+    void unregisterLink(LinkInterface* link);
+
 public slots:
     /** @brief Receive bytes from a communication interface */
     void receiveBytes(LinkInterface* link, QByteArray b);
 
+    /// Must be connected to LinkInterface::bytesReceived/bytesSent with Qt::DirectConnection.
+    /// Dispatches the bytes to the thread which runs the protocol.
+    void linkBytesReceived(LinkInterface* link, const QByteArray& b);
+    void linkBytesSent(LinkInterface* link, const QByteArray& b);
+
     /** @brief Log bytes sent from a communication interface */
     void logSentBytes(LinkInterface* link, QByteArray b);
 
@@ -105,6 +154,7 @@ protected:
 
     mavlink_message_t _message;
     mavlink_status_t _status;
+    MAVLinkFrameParser _frameParsers[MAVLINK_COMM_NUM_BUFFERS];   ///< Bulk frame parser per channel
 
     bool        versionMismatchIgnore;
     int         systemId;
@@ -126,6 +176,9 @@ signals:
 
     void mavlinkMessageStatus(int uasId, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent);
 
+    /// Emitted at most once a second as latency samples come in, and on reset
+    void latencyStatsChanged(void);
+
     /**
      * @brief Emitted if a new radio status packet received
      *
@@ -148,21 +201,76 @@ signals:
 
 private slots:
     void _vehicleCountChanged(void);
+    void _updateCachedSettings(void);
+    void _drainMessageQueues(void);
 
 private:
+    struct QueuedMessage {
+        WeakLinkInterfacePtr link;          ///< Weak, so a deleted link can't be mistaken for a new one at the same address
+        mavlink_message_t   message;
+        qint64              arrivalNsecs;
+    };
+
+    QObject* _receiveContext(void);
+    void _receiveBytes(LinkInterface* link, const QByteArray& b, qint64 arrivalNsecs);
+    bool _decodeFrame(uint8_t mavlinkChannel, const MAVLinkFrameParser::Frame& frame);
+    void _runOnProtocolThread(const std::function<void(void)>& function);
+    void _setGuiThreadWaiting(bool waiting);
+    void _countRejectedFrames(uint8_t mavlinkChannel, uint64_t previousBadCRCCount);
+    void _handleFrame(LinkInterface* link, uint8_t mavlinkChannel, const MAVLinkFrameParser::Frame& frame, qint64 arrivalNsecs);
+    void _emitMessage(LinkInterface* link, const mavlink_message_t& message, qint64 arrivalNsecs);
+    bool _queueMessage(LinkInterface* link, const WeakLinkInterfacePtr& weakLink, uint8_t mavlinkChannel, qint64 arrivalNsecs, QMutexLocker<QMutex>& threadLinksLocker);
+    bool _waitForQueueSpace(const QGCSPSCQueue<QueuedMessage>* queue);
+    void _scheduleDrain(void);
+    void _startProtocolThread(void);
+    void _updateThreadForwardingLinks(void);
     bool _closeLogFile(void);
     void _startLogging(void);
     void _stopLogging(void);
+    void _logWriteFailed(void);
 
-    bool _logSuspendError;      ///< true: Logging suspended due to error
-    bool _logSuspendReplay;     ///< true: Logging suspended due to replay
+    bool _logSuspendError;                  ///< true: Logging suspended due to error
+    std::atomic<bool> _logSuspendReplay;    ///< true: Logging suspended due to replay
     bool _vehicleWasArmed;      ///< true: Vehicle was armed during log sequence
 
     QGCTemporaryFile    _tempLogFile;            ///< File to log to
     static constexpr const char* _tempLogFileTemplate   = "FlightDataXXXXXX";   ///< Template for temporary log file
     static constexpr const char* _logFileExtension      = "mavlink";            ///< Extension for log files
+    MAVLinkLogWriter*   _logWriter;              ///< Batched writes to _tempLogFile
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
+
+    // Cached settings, see _updateCachedSettings
+    std::atomic<bool>       _forwardMavlink             {false};
+    std::atomic<bool>       _supportForwardingEnabled   {false};
+    std::atomic<bool>       _disableAllPersistence      {false};
+    std::atomic<bool>       _telemetrySave              {false};
+    std::atomic<bool>       _telemetrySaveNotArmed      {false};
+
+    // Protocol thread support
+    QThread*                _protocolThread             = nullptr;  ///< nullptr: Protocol runs on the gui thread
+    QObject*                _protocolThreadContext      = nullptr;  ///< Lives on _protocolThread, used to dispatch work to it
+    QMutex                  _threadLinksMutex;                      ///< Protects the _thread* link members below
+    QHash<LinkInterface*, WeakLinkInterfacePtr> _threadLinks;
+    LinkInterface*          _threadForwardingLink       = nullptr;
+    LinkInterface*          _threadForwardingSupportLink = nullptr;
+    std::unique_ptr<QGCSPSCQueue<QueuedMessage>> _messageQueues[MAVLINK_COMM_NUM_BUFFERS];   ///< Per link, each link owns its channel while it exists
+    std::atomic<bool>       _drainPending               {false};
+    QMutex                  _queueSpaceMutex;                       ///< Protects _guiThreadWaiting, used with _queueSpaceCondition
+    QWaitCondition          _queueSpaceCondition;                   ///< Woken as the gui thread drains the message queues
+    bool                    _guiThreadWaiting           = false;    ///< true: gui thread is blocked on the protocol thread
+    uint64_t                _queueOverflowCount         = 0;
+
+    QElapsedTimer           _latencyTimer;
+    QElapsedTimer           _latencyLogTimer;
+    QElapsedTimer           _latencyStatsTimer;
+    MAVLinkLatencyHistogram _latencyHistogram;
+    qint64                  _deliveryArrivalNsecs       = -1;       ///< Arrival time of the message messageReceived is delivering, -1 for none
+
+    static constexpr size_t _messageQueueCapacity       = 256;
+    static constexpr int    _queueSpaceWaitMSecs        = 100;
+    static constexpr qint64 _latencyLogIntervalMSecs    = 10000;
+    static constexpr qint64 _latencyStatsIntervalMSecs  = 1000;
 };
 
@@ -831,6 +831,24 @@ void MockLink::_handleParamRequestList(const mavlink_message_t& msg)
     Q_ASSERT(request.target_system == _vehicleSystemId);
     Q_ASSERT(request.target_component == MAV_COMP_ID_ALL);
 
+    if (_sendParamHashCheck) {
+        mavlink_param_union_t   valueUnion;
+        valueUnion.type = MAV_PARAM_TYPE_UINT32;
+        valueUnion.param_uint32 = _paramHashCheck;
+
+        mavlink_message_t responseMsg;
+        mavlink_msg_param_value_pack_chan(_vehicleSystemId,
+                                          _vehicleComponentId,
+                                          mavlinkChannel(),
+                                          &responseMsg,
+                                          "_HASH_CHECK",
+                                          valueUnion.param_float,
+                                          MAV_PARAM_TYPE_UINT32,
+                                          0,
+                                          -1);
+        respondWithMavlinkMessage(responseMsg);
+    }
+
     // Start the worker routine
     _currentParamRequestListComponentIndex = 0;
     _currentParamRequestListParamIndex = 0;
@@ -904,6 +922,17 @@ void MockLink::_handleParamSet(const mavlink_message_t& msg)
 
     qCDebug(MockLinkLog) << "_handleParamSet" << componentId << paramId << request.param_type;
 
+    if (strcmp(paramId, "_HASH_CHECK") == 0) {
+        mavlink_param_union_t valueUnion;
+        valueUnion.param_float = request.param_value;
+        if (_sendParamHashCheck && (valueUnion.param_uint32 == _paramHashCheck)) {
+            // QGC loaded the parameters from its cache, stop the stream like PX4 does
+            qCDebug(MockLinkLog) << "_HASH_CHECK matched, stopping param stream";
+            _currentParamRequestListComponentIndex = -1;
+        }
+        return;
+    }
+
     Q_ASSERT(_mapParamName2Value.contains(componentId));
     Q_ASSERT(_mapParamName2MavParamType.contains(componentId));
     Q_ASSERT(_mapParamName2Value[componentId].contains(paramId));
@@ -956,6 +985,8 @@ void MockLink::_handleParamRequestRead(const mavlink_message_t& msg)
 
     Q_ASSERT(_mapParamName2Value.contains(componentId));
 
+    _receivedParamRequestReadIndices.append(request.param_index);
+
     char paramId[MAVLINK_MSG_PARAM_REQUEST_READ_FIELD_PARAM_ID_LEN + 1];
     paramId[0] = 0;
 
@@ -1694,7 +1725,9 @@ void MockLink::_logDownloadWorker(void)
                                            _logDownloadCurrentOffset,
                                            bytesToRead,
                                            &buffer[0]);
-            respondWithMavlinkMessage(responseMsg);
+            if (_logDownloadLossPercent == 0 || QRandomGenerator::global()->bounded(100) >= _logDownloadLossPercent) {
+                respondWithMavlinkMessage(responseMsg);
+            }
 
             _logDownloadCurrentOffset += bytesToRead;
             _logDownloadBytesRemaining -= bytesToRead;
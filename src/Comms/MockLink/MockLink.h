@@ -18,6 +18,7 @@
 #include <QtPositioning/QGeoCoordinate>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
 #include <QtCore/QMap>
 #include <QtCore/QMutex>
 
@@ -154,6 +155,12 @@ public:
     /// Returns the filename for the simulated log file. Only available after a download is requested.
     QString logDownloadFile(void) { return _logDownloadFilename; }
 
+    /// Sets the size of the simulated log file. Must be called before the log is requested.
+    void setLogDownloadFileSize(uint32_t size) { _logDownloadFileSize = size; }
+
+    /// Sets the percentage of LOG_DATA packets which are lost
+    void setLogDownloadLossPercent(int percent) { _logDownloadLossPercent = percent; }
+
     Q_INVOKABLE void setCommLost                    (bool commLost)   { _commLost = commLost; }
     Q_INVOKABLE void simulateConnectionRemoved      (void);
     static MockLink* startPX4MockLink               (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
@@ -178,6 +185,14 @@ public:
     void clearReceivedMavCommandCounts(void) { _receivedMavCommandCountMap.clear(); }
     int receivedMavCommandCount(MAV_CMD command) { return _receivedMavCommandCountMap[command]; }
 
+    /// Sends _HASH_CHECK with the specified value ahead of the parameter stream, like PX4 does. The stream is
+    /// stopped if QGC sets _HASH_CHECK to the same value. Must be called before the parameters are requested.
+    void setParamHashCheck(uint32_t hash) { _paramHashCheck = hash; _sendParamHashCheck = true; }
+
+    /// Parameter indices of the PARAM_REQUEST_READ messages received, -1 for reads by name
+    void clearReceivedParamRequestReads(void) { _receivedParamRequestReadIndices.clear(); }
+    QList<int> receivedParamRequestReadIndices(void) const { return _receivedParamRequestReadIndices; }
+
     typedef enum {
         FailRequestMessageNone,
         FailRequestMessageCommandAcceptedMsgNotSent,
@@ -310,9 +325,13 @@ private:
 
     int _currentParamRequestListComponentIndex; // Current component index for param request list workflow, -1 for no request in progress
     int _currentParamRequestListParamIndex;     // Current parameter index for param request list workflow
+    bool        _sendParamHashCheck = false;    // true: Send _HASH_CHECK ahead of the parameter stream
+    uint32_t    _paramHashCheck     = 0;        // Value sent as _HASH_CHECK
+    QList<int>  _receivedParamRequestReadIndices;
 
     static const uint16_t _logDownloadLogId = 0;        ///< Id of siumulated log file
-    static const uint32_t _logDownloadFileSize = 1000;  ///< Size of simulated log file
+    uint32_t _logDownloadFileSize = 1000;               ///< Size of simulated log file
+    int      _logDownloadLossPercent = 0;               ///< Percentage of LOG_DATA packets which are lost
 
     QString     _logDownloadFilename;       ///< Filename for log download which is in progress
     uint32_t    _logDownloadCurrentOffset;  ///< Current offset we are sending from
@@ -12,6 +12,8 @@
 #include "MockLink.h"
 #include "QGCTemporaryFile.h"
 
+#include <QtCore/QTimer>
+
 MockLinkFTP::MockLinkFTP(uint8_t systemIdServer, uint8_t componentIdServer, MockLink* mockLink)
     : _systemIdServer   (systemIdServer)
     , _componentIdServer(componentIdServer)
@@ -172,7 +174,8 @@ void MockLinkFTP::_readCommand(uint8_t senderSystemId, uint8_t senderComponentId
         return;
     }
     
-    uint8_t cBytesToRead = (uint8_t)qMin((qint64)sizeof(response.data), _currentFile.size() - readOffset);
+    qint64 cBytesRequested = request->hdr.size ? request->hdr.size : sizeof(response.data);
+    uint8_t cBytesToRead = (uint8_t)qMin(qMin((qint64)sizeof(response.data), cBytesRequested), _currentFile.size() - readOffset);
     _currentFile.seek(readOffset);
     QByteArray bytes = _currentFile.read(cBytesToRead);
     memcpy(response.data, bytes.constData(), cBytesToRead);
@@ -402,14 +405,25 @@ void MockLinkFTP::_sendResponse(uint8_t targetSystemId, uint8_t targetComponentI
                                                  (uint8_t*)request);            // Payload
 
     // kCmdOpenFileRO and kCmdResetSessions don't support retry so we can't drop those
-    if (_randomDropsEnabled && request->hdr.req_opcode != MavlinkFTP::kCmdOpenFileRO && request->hdr.req_opcode != MavlinkFTP::kCmdResetSessions) {
-        if ((rand() % 5) == 0) {
+    if (request->hdr.req_opcode != MavlinkFTP::kCmdOpenFileRO && request->hdr.req_opcode != MavlinkFTP::kCmdResetSessions) {
+        if (_randomDropsEnabled && (rand() % 5) == 0) {
             qDebug() << "MockLinkFTP: Random drop of outgoing packet";
             return;
         }
+        if (_responseLossPercent > 0 && (rand() % 100) < _responseLossPercent) {
+            return;
+        }
     }
     
-    _mockLink->respondWithMavlinkMessage(_lastReply);
+    if (_responseLatencyMSecs > 0) {
+        // Runs on the MockLink thread, responses sent together arrive together and in order
+        const mavlink_message_t reply = _lastReply;
+        QTimer::singleShot(_responseLatencyMSecs, Qt::PreciseTimer, _mockLink, [this, reply]() {
+            _mockLink->respondWithMavlinkMessage(reply);
+        });
+    } else {
+        _mockLink->respondWithMavlinkMessage(_lastReply);
+    }
 }
 
 /// @brief Generates the next sequence number given an incoming sequence number. Handles generating
@@ -63,6 +63,12 @@ public:
     void enableRandromDrops(bool enable) { _randomDropsEnabled = enable; }
     void enableBinParamFile(bool enable) { _BinParamFileEnabled = enable; }
 
+    /// @brief Sets the percentage of responses which are lost. Open and Reset responses are never lost.
+    void setResponseLossPercent(int percent) { _responseLossPercent = percent; }
+
+    /// @brief Sets the delay before each response is sent, to simulate a slow link
+    void setResponseLatencyMSecs(int msecs) { _responseLatencyMSecs = msecs; }
+
     static constexpr const char* sizeFilenamePrefix = "mocklink-size-";
 
 signals:
@@ -101,6 +107,8 @@ private:
     mavlink_message_t       _lastReply;
     bool                    _randomDropsEnabled = false;
     bool                    _BinParamFileEnabled = false;
+    int                     _responseLossPercent    = 0;
+    int                     _responseLatencyMSecs   = 0;
 
     static const uint8_t    _sessionId          = 1;    ///< We only support a single fixed session
 };
@@ -8,6 +8,7 @@
  ****************************************************************************/
 
 #include "Fact.h"
+#include "FactGroup.h"
 #include "FactValueSliderListModel.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
@@ -672,8 +673,11 @@ void Fact::_sendValueChangedSignal(QVariant value)
     if (_sendValueChangedSignals) {
         emit valueChanged(value);
         _deferredValueChangeSignal = false;
-    } else {
+    } else if (!_deferredValueChangeSignal) {
         _deferredValueChangeSignal = true;
+        if (_deferredSignalGroup) {
+            _deferredSignalGroup->_factSignalDeferred(this);
+        }
     }
 }
 
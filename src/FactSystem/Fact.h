@@ -15,6 +15,7 @@
 
 #include "FactMetaData.h"
 
+class FactGroup;
 class FactValueSliderListModel;
 
 /// @brief A Fact is used to hold a single value within the system.
@@ -149,6 +150,10 @@ public:
     void clearDeferredValueChangeSignal(void) { _deferredValueChangeSignal = false; }
     void sendDeferredValueChangedSignal(void);
 
+    /// Group which publishes the deferred valueChanged signals. It is told the first time the Fact is left
+    /// with a deferred signal, so it only has to visit changed Facts.
+    void setDeferredSignalGroup(FactGroup* factGroup) { _deferredSignalGroup = factGroup; }
+
     // C++ methods
 
     /// Sets and sends new value to vehicle even if value is the same
@@ -207,6 +212,7 @@ protected:
     FactMetaData*               _metaData;
     bool                        _sendValueChangedSignals;
     bool                        _deferredValueChangeSignal;
+    FactGroup*                  _deferredSignalGroup = nullptr;
     FactValueSliderListModel*   _valueSliderModel;
     bool                        _ignoreQGCRebootRequired;
 
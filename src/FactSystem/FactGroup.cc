@@ -9,9 +9,12 @@
 
 
 #include "FactGroup.h"
+#include "QGCLoggingCategory.h"
 
 #include <QtQml/QQmlEngine>
 
+QGC_LOGGING_CATEGORY(FactGroupLog, "qgc.factsystem.factgroup")
+
 FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent, bool ignoreCamelCase)
     : QObject(parent)
     , _updateRateMSecs(updateRateMsecs)
@@ -44,6 +47,7 @@ void FactGroup::_setupTimer()
         _updateTimer.setSingleShot(false);
         _updateTimer.setInterval(_updateRateMSecs);
         _updateTimer.start();
+        _signalRateTimer.start();
     }
 }
 
@@ -124,6 +128,10 @@ void FactGroup::_addFact(Fact* fact, const QString& name)
     }
 
     fact->setSendValueChangedSignals(_updateRateMSecs == 0);
+    fact->setDeferredSignalGroup(this);
+    if (fact->deferredValueChangeSignal()) {
+        _dirtyFacts.append(fact);
+    }
     if (_nameToFactMetaDataMap.contains(name)) {
         fact->setMetaData(_nameToFactMetaDataMap[name], true /* setDefaultFromMetaData */);
     }
@@ -147,8 +155,31 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
 
 void FactGroup::_updateAllValues(void)
 {
-    for(Fact* fact: _nameToFactMap) {
-        fact->sendDeferredValueChangedSignal();
+    _publishDirtyFacts();
+
+    if (_signalRateTimer.isValid() && (_signalRateTimer.elapsed() >= _signalRateWindowMSecs)) {
+        _signalsPerSecond = (_signalsInWindow * 1000.0) / _signalRateTimer.restart();
+        _signalsInWindow = 0;
+        qCDebug(FactGroupLog) << metaObject()->className() << objectName() << "signals/sec" << _signalsPerSecond << "total" << _signalsEmitted;
+    }
+}
+
+void FactGroup::_factSignalDeferred(Fact* fact)
+{
+    _dirtyFacts.append(fact);
+}
+
+void FactGroup::_publishDirtyFacts(void)
+{
+    // Facts changed from within a valueChanged handler go onto the fresh dirty list and wait for the next update
+    QList<Fact*> dirtyFacts;
+    dirtyFacts.swap(_dirtyFacts);
+    for (Fact* fact: dirtyFacts) {
+        if (fact->deferredValueChangeSignal()) {
+            fact->sendDeferredValueChangedSignal();
+            _signalsEmitted++;
+            _signalsInWindow++;
+        }
     }
 }
 
@@ -166,6 +197,10 @@ void FactGroup::setLiveUpdates(bool liveUpdates)
     for(Fact* fact: _nameToFactMap) {
         fact->setSendValueChangedSignals(liveUpdates);
     }
+    if (liveUpdates) {
+        // Nothing publishes the values changed since the last update otherwise
+        _publishDirtyFacts();
+    }
 }
 
 
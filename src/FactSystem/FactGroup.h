@@ -13,12 +13,16 @@
 #include <QtCore/QMap>
 #include <QtCore/QTimer>
 #include <QtCore/QJsonArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
 
 #include "Fact.h"
 #include "MAVLinkLib.h"
 
 class Vehicle;
 
+Q_DECLARE_LOGGING_CATEGORY(FactGroupLog)
+
 /// Used to group Facts together into an object hierarachy.
 class FactGroup : public QObject
 {
@@ -54,6 +58,18 @@ public:
     /// Allows a FactGroup to parse incoming messages and fill in values
     virtual void handleMessage(Vehicle* vehicle, mavlink_message_t& message);
 
+    /// Message ids handleMessage is interested in. Vehicle only offers a group the messages listed here, so
+    /// an override must be kept in sync with the handleMessage switch. An empty list means no messages.
+    /// The default of allMessageIds offers every message, for groups which don't declare theirs.
+    virtual QList<uint32_t> handledMessageIds(void) const { return { allMessageIds }; }
+
+    static constexpr uint32_t allMessageIds = UINT32_MAX;
+
+    /// Instrumentation: deferred valueChanged signals published by this group
+    quint64 signalsEmitted      (void) const { return _signalsEmitted; }
+    /// Instrumentation: deferred valueChanged signals published per second, over the last full second
+    double  signalsPerSecond    (void) const { return _signalsPerSecond; }
+
 signals:
     void factNamesChanged           (void);
     void factGroupNamesChanged      (void);
@@ -76,10 +92,23 @@ protected:
     QStringList                     _factNames;
 
 private:
-    void    _setupTimer (void);
-    QString _camelCase  (const QString& text);
+    void    _setupTimer         (void);
+    QString _camelCase          (const QString& text);
+    void    _factSignalDeferred (Fact* fact);
+    void    _publishDirtyFacts  (void);
 
     bool    _ignoreCamelCase    = false;
     QTimer  _updateTimer;
     bool    _telemetryAvailable = false;
+
+    QList<Fact*>    _dirtyFacts;    ///< Facts holding a deferred valueChanged signal, in the order they changed
+
+    quint64         _signalsEmitted         = 0;
+    quint64         _signalsInWindow        = 0;
+    double          _signalsPerSecond       = 0;
+    QElapsedTimer   _signalRateTimer;
+
+    static constexpr qint64 _signalRateWindowMSecs = 1000;
+
+    friend class Fact;
 };
@@ -0,0 +1,193 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterCache.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(ParameterCacheLog, "qgc.factsystem.parametercache")
+
+// Record layout
+static constexpr int kNameOffset    = 0;
+static constexpr int kValueOffset   = 16;
+static constexpr int kIndexOffset   = 20;
+static constexpr int kTypeOffset    = 22;
+
+ParameterCache::~ParameterCache()
+{
+    close();
+}
+
+bool ParameterCache::open(const QString& filename)
+{
+    close();
+
+    _file.setFileName(filename);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 fileSize = _file.size();
+    const uchar* const data = (fileSize >= headerSize) ? _file.map(0, fileSize) : nullptr;
+    if (!data) {
+        qCDebug(ParameterCacheLog) << "Unable to map" << filename;
+        close();
+        return false;
+    }
+
+    const quint32 magic = qFromLittleEndian<quint32>(data);
+    const quint16 version = qFromLittleEndian<quint16>(data + 4);
+    const quint16 fileRecordSize = qFromLittleEndian<quint16>(data + 6);
+    const quint32 count = qFromLittleEndian<quint32>(data + 8);
+    if ((magic != fileMagic) || (version != fileVersion) || (fileRecordSize != recordSize) || (fileSize != (headerSize + (static_cast<qint64>(count) * recordSize)))) {
+        qCDebug(ParameterCacheLog) << "Ignoring unreadable cache" << filename;
+        close();
+        return false;
+    }
+
+    _records = data + headerSize;
+    _count = static_cast<int>(count);
+    _linkUSecsPerParam = qFromLittleEndian<quint32>(data + 12);
+    return true;
+}
+
+void ParameterCache::close()
+{
+    // Closing the file unmaps it
+    _file.close();
+    _records = nullptr;
+    _count = 0;
+    _linkUSecsPerParam = 0;
+}
+
+QString ParameterCache::name(int record) const
+{
+    const char* const name = reinterpret_cast<const char*>(_record(record) + kNameOffset);
+    return QString::fromLatin1(name, static_cast<qsizetype>(strnlen(name, nameLength)));
+}
+
+int ParameterCache::paramIndex(int record) const
+{
+    return qFromLittleEndian<quint16>(_record(record) + kIndexOffset);
+}
+
+MAV_PARAM_TYPE ParameterCache::type(int record) const
+{
+    return static_cast<MAV_PARAM_TYPE>(_record(record)[kTypeOffset]);
+}
+
+mavlink_param_union_t ParameterCache::value(int record) const
+{
+    mavlink_param_union_t value;
+    (void) memcpy(value.bytes, _record(record) + kValueOffset, sizeof(value.bytes));
+    value.type = type(record);
+    return value;
+}
+
+ParameterCache::Entry ParameterCache::entry(int record) const
+{
+    return Entry{ name(record), paramIndex(record), type(record), value(record) };
+}
+
+int ParameterCache::find(const QString& name) const
+{
+    char key[nameLength] = {};
+    const QByteArray latin1 = name.toLatin1();
+    if (latin1.size() > nameLength) {
+        return -1;
+    }
+    (void) memcpy(key, latin1.constData(), latin1.size());
+
+    // Names are zero padded, so comparing the whole field gives name order
+    int first = 0;
+    int last = _count;
+    while (first < last) {
+        const int middle = first + ((last - first) / 2);
+        const int result = memcmp(_record(middle) + kNameOffset, key, nameLength);
+        if (result == 0) {
+            return middle;
+        } else if (result < 0) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return -1;
+}
+
+quint32 ParameterCache::hash(const std::function<bool(int record)>& skip) const
+{
+    // Same as the vehicle: name and value bytes of each parameter in name order
+    quint32 crc32Value = 0;
+    for (int record = 0; record < _count; record++) {
+        if (skip && skip(record)) {
+            continue;
+        }
+        const uchar* const data = _record(record);
+        crc32Value = QGC::crc32(data + kNameOffset, static_cast<unsigned>(strnlen(reinterpret_cast<const char*>(data + kNameOffset), nameLength)), crc32Value);
+        crc32Value = QGC::crc32(data + kValueOffset, static_cast<unsigned>(typeSize(type(record))), crc32Value);
+    }
+    return crc32Value;
+}
+
+bool ParameterCache::save(const QString& filename, QList<Entry> entries, quint32 linkUSecsPerParam)
+{
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.name < b.name;
+    });
+
+    QByteArray bytes(headerSize + (entries.count() * recordSize), '\0');
+    uchar* const data = reinterpret_cast<uchar*>(bytes.data());
+    qToLittleEndian<quint32>(fileMagic, data);
+    qToLittleEndian<quint16>(fileVersion, data + 4);
+    qToLittleEndian<quint16>(recordSize, data + 6);
+    qToLittleEndian<quint32>(static_cast<quint32>(entries.count()), data + 8);
+    qToLittleEndian<quint32>(linkUSecsPerParam, data + 12);
+
+    uchar* record = data + headerSize;
+    for (const Entry& entry : entries) {
+        const QByteArray name = entry.name.toLatin1();
+        (void) memcpy(record + kNameOffset, name.constData(), qMin<qsizetype>(name.size(), nameLength));
+        (void) memcpy(record + kValueOffset, entry.value.bytes, sizeof(entry.value.bytes));
+        qToLittleEndian<quint16>(static_cast<quint16>(entry.index), record + kIndexOffset);
+        record[kTypeOffset] = static_cast<uchar>(entry.type);
+        record += recordSize;
+    }
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly) || (file.write(bytes) != bytes.size()) || !file.commit()) {
+        qCWarning(ParameterCacheLog) << "Unable to write" << filename << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+int ParameterCache::typeSize(MAV_PARAM_TYPE type)
+{
+    switch (type) {
+    case MAV_PARAM_TYPE_UINT8:
+    case MAV_PARAM_TYPE_INT8:
+        return 1;
+    case MAV_PARAM_TYPE_UINT16:
+    case MAV_PARAM_TYPE_INT16:
+        return 2;
+    case MAV_PARAM_TYPE_UINT32:
+    case MAV_PARAM_TYPE_INT32:
+    case MAV_PARAM_TYPE_REAL32:
+        return 4;
+    default:
+        return 0;
+    }
+}
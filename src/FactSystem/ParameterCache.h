@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+
+#include <functional>
+
+#include "MAVLinkLib.h"
+
+Q_DECLARE_LOGGING_CATEGORY(ParameterCacheLog)
+
+/// On disk cache of the parameters of one vehicle component.
+///
+/// The file is a small header followed by fixed size records sorted by parameter name. Each record
+/// holds the name, the parameter index on the vehicle, the MAV_PARAM_TYPE and the raw value as sent
+/// in PARAM_VALUE. All integers are little endian. The file is memory mapped when read, nothing is
+/// deserialized up front.
+class ParameterCache
+{
+public:
+    struct Entry {
+        QString                 name;
+        int                     index;  ///< Parameter index on the vehicle
+        MAV_PARAM_TYPE          type;
+        mavlink_param_union_t   value;  ///< Only the value bytes are used, not type
+    };
+
+    ParameterCache() = default;
+    ~ParameterCache();
+
+    /// Maps a cache file and validates its header and size
+    ///     @return false: No usable cache, the file is left closed
+    bool open(const QString& filename);
+    void close();
+    bool isOpen() const { return _records != nullptr; }
+
+    int count() const { return _count; }
+    QString name(int record) const;
+    int paramIndex(int record) const;
+    MAV_PARAM_TYPE type(int record) const;
+    mavlink_param_union_t value(int record) const;
+    Entry entry(int record) const;
+
+    /// Binary search by name
+    ///     @return Record of the parameter, -1 if not in the cache
+    int find(const QString& name) const;
+
+    /// Link time per parameter of the full load the cache was written after, 0 if unknown
+    quint32 linkUSecsPerParam() const { return _linkUSecsPerParam; }
+
+    /// Computes the parameter set hash the vehicle sends as _HASH_CHECK
+    ///     @param skip Returns true for records which don't take part in the hash
+    quint32 hash(const std::function<bool(int record)>& skip = {}) const;
+
+    /// Writes a cache file, entries are sorted by name first
+    static bool save(const QString& filename, QList<Entry> entries, quint32 linkUSecsPerParam);
+
+    /// Size of the value of a MAV_PARAM_TYPE in bytes
+    static int typeSize(MAV_PARAM_TYPE type);
+
+    static constexpr quint32 fileMagic = 0x51475043;    // "QGPC"
+    static constexpr quint16 fileVersion = 3;
+    static constexpr int headerSize = 16;
+    static constexpr int recordSize = 24;
+    static constexpr int nameLength = 16;
+
+private:
+    const uchar* _record(int record) const { return _records + (record * recordSize); }
+
+    QFile           _file;
+    const uchar*    _records = nullptr;
+    int             _count = 0;
+    quint32         _linkUSecsPerParam = 0;
+};
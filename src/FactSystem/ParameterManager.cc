@@ -8,6 +8,7 @@
  ****************************************************************************/
 
 #include "ParameterManager.h"
+#include "ParameterCache.h"
 #include "QGCApplication.h"
 #include "FirmwarePlugin.h"
 #include "CompInfoParam.h"
@@ -101,6 +102,10 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     _waitingParamTimeoutTimer.setInterval(3000);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    _paramCacheWriteTimer.setSingleShot(true);
+    _paramCacheWriteTimer.setInterval(2000);
+    connect(&_paramCacheWriteTimer, &QTimer::timeout, this, &ParameterManager::_writeDirtyParamCaches);
+
     // Ensure the cache directory exists
     QFileInfo(QSettings().fileName()).dir().mkdir("ParamCache");
 }
@@ -181,39 +186,39 @@ void ParameterManager::mavlinkMessageReceived(mavlink_message_t message)
         paramUnion.param_float  = param_value.param_value;
         paramUnion.type         = param_value.param_type;
 
-        QVariant parameterValue;
+        const QVariant parameterValue = _paramUnionToVariant(paramUnion);
 
-        switch (paramUnion.type) {
-        case MAV_PARAM_TYPE_REAL32:
-            parameterValue = QVariant(paramUnion.param_float);
-            break;
-        case MAV_PARAM_TYPE_UINT8:
-            parameterValue = QVariant(paramUnion.param_uint8);
-            break;
-        case MAV_PARAM_TYPE_INT8:
-            parameterValue = QVariant(paramUnion.param_int8);
-            break;
-        case MAV_PARAM_TYPE_UINT16:
-            parameterValue = QVariant(paramUnion.param_uint16);
-            break;
-        case MAV_PARAM_TYPE_INT16:
-            parameterValue = QVariant(paramUnion.param_int16);
-            break;
-        case MAV_PARAM_TYPE_UINT32:
-            parameterValue = QVariant(paramUnion.param_uint32);
-            break;
-        case MAV_PARAM_TYPE_INT32:
-            parameterValue = QVariant(paramUnion.param_int32);
-            break;
-        default:
-            qCritical() << "ParameterManager::_handleParamValue - unsupported MAV_PARAM_TYPE" << paramUnion.type;
-            break;
+        if (!_initialLoadComplete && (parameterName != "_HASH_CHECK")) {
+            _initialLoadLinkCount++;
         }
 
         _handleParamValue(message.compid, parameterName, param_value.param_count, param_value.param_index, static_cast<MAV_PARAM_TYPE>(param_value.param_type), parameterValue);
     }
 }
 
+QVariant ParameterManager::_paramUnionToVariant(const mavlink_param_union_t& paramUnion)
+{
+    switch (paramUnion.type) {
+    case MAV_PARAM_TYPE_REAL32:
+        return QVariant(paramUnion.param_float);
+    case MAV_PARAM_TYPE_UINT8:
+        return QVariant(paramUnion.param_uint8);
+    case MAV_PARAM_TYPE_INT8:
+        return QVariant(paramUnion.param_int8);
+    case MAV_PARAM_TYPE_UINT16:
+        return QVariant(paramUnion.param_uint16);
+    case MAV_PARAM_TYPE_INT16:
+        return QVariant(paramUnion.param_int16);
+    case MAV_PARAM_TYPE_UINT32:
+        return QVariant(paramUnion.param_uint32);
+    case MAV_PARAM_TYPE_INT32:
+        return QVariant(paramUnion.param_int32);
+    default:
+        qCritical() << "ParameterManager::_handleParamValue - unsupported MAV_PARAM_TYPE" << paramUnion.type;
+        return QVariant();
+    }
+}
+
 /// Called whenever a parameter is updated or first seen.
 void ParameterManager::_handleParamValue(int componentId, QString parameterName, int parameterCount, int parameterIndex, MAV_PARAM_TYPE mavParamType, QVariant parameterValue)
 {
@@ -372,6 +377,11 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
 
     _updateProgressBar();
 
+    // The index is needed to write the cache, 65535 is a named read or unrequested update
+    if ((parameterIndex >= 0) && (parameterIndex < 65535)) {
+        _paramIndexMap[componentId][parameterName] = parameterIndex;
+    }
+
     Fact* fact = nullptr;
     if (_mapCompId2FactMap.contains(componentId) && _mapCompId2FactMap[componentId].contains(parameterName)) {
         fact = _mapCompId2FactMap[componentId][parameterName];
@@ -399,6 +409,11 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
         if (_prevWaitingReadParamIndexCount + _prevWaitingReadParamNameCount != 0 && readWaitingParamCount == 0) {
             // All reads just finished, update the cache
             _writeLocalParamCache(_vehicle->id(), componentId);
+        } else if (_initialLoadComplete && readWaitingParamCount == 0) {
+            // Keep the cache in step with writes and updates after the initial load. Otherwise the hash check
+            // on the next connect fails because of our own changes.
+            _dirtyParamCacheComponents.insert(componentId);
+            _paramCacheWriteTimer.start();
         }
     }
 
@@ -519,6 +534,9 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
 
     if (!_initialLoadComplete) {
         _initialRequestTimeoutTimer.start();
+        if (!_initialLoadTimer.isValid()) {
+            _initialLoadTimer.start();
+        }
     }
 
     if (_tryftp && (componentId == MAV_COMP_ID_ALL || componentId == MAV_COMP_ID_AUTOPILOT1)) {
@@ -806,47 +824,11 @@ void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& pa
     SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
     if (sharedLink) {
         mavlink_param_set_t     p;
-        mavlink_param_union_t   union_value;
 
         memset(&p, 0, sizeof(p));
 
         p.param_type = factTypeToMavType(valueType);
-
-        switch (valueType) {
-        case FactMetaData::valueTypeUint8:
-            union_value.param_uint8 = (uint8_t)value.toUInt();
-            break;
-
-        case FactMetaData::valueTypeInt8:
-            union_value.param_int8 = (int8_t)value.toInt();
-            break;
-
-        case FactMetaData::valueTypeUint16:
-            union_value.param_uint16 = (uint16_t)value.toUInt();
-            break;
-
-        case FactMetaData::valueTypeInt16:
-            union_value.param_int16 = (int16_t)value.toInt();
-            break;
-
-        case FactMetaData::valueTypeUint32:
-            union_value.param_uint32 = (uint32_t)value.toUInt();
-            break;
-
-        case FactMetaData::valueTypeFloat:
-            union_value.param_float = value.toFloat();
-            break;
-
-        default:
-            qCritical() << "Unsupported fact falue type" << valueType;
-            // fall through
-
-        case FactMetaData::valueTypeInt32:
-            union_value.param_int32 = (int32_t)value.toInt();
-            break;
-        }
-
-        p.param_value = union_value.param_float;
+        p.param_value = _variantToParamUnion(valueType, value).param_float;
         p.target_system = (uint8_t)_vehicle->id();
         p.target_component = (uint8_t)componentId;
 
@@ -862,20 +844,74 @@ void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& pa
     }
 }
 
+mavlink_param_union_t ParameterManager::_variantToParamUnion(FactMetaData::ValueType_t valueType, const QVariant& value)
+{
+    mavlink_param_union_t union_value;
+
+    memset(&union_value, 0, sizeof(union_value));
+    union_value.type = factTypeToMavType(valueType);
+
+    switch (valueType) {
+    case FactMetaData::valueTypeUint8:
+        union_value.param_uint8 = (uint8_t)value.toUInt();
+        break;
+
+    case FactMetaData::valueTypeInt8:
+        union_value.param_int8 = (int8_t)value.toInt();
+        break;
+
+    case FactMetaData::valueTypeUint16:
+        union_value.param_uint16 = (uint16_t)value.toUInt();
+        break;
+
+    case FactMetaData::valueTypeInt16:
+        union_value.param_int16 = (int16_t)value.toInt();
+        break;
+
+    case FactMetaData::valueTypeUint32:
+        union_value.param_uint32 = (uint32_t)value.toUInt();
+        break;
+
+    case FactMetaData::valueTypeFloat:
+        union_value.param_float = value.toFloat();
+        break;
+
+    default:
+        qCritical() << "Unsupported fact falue type" << valueType;
+        // fall through
+
+    case FactMetaData::valueTypeInt32:
+        union_value.param_int32 = (int32_t)value.toInt();
+        break;
+    }
+
+    return union_value;
+}
+
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    CacheMapName2ParamTypeVal cacheMap;
+    QList<ParameterCache::Entry> entries;
+    const QHash<QString, int>& indexMap = _paramIndexMap[componentId];
 
     for (const QString& paramName: _mapCompId2FactMap[componentId].keys()) {
         const Fact *fact = _mapCompId2FactMap[componentId][paramName];
-        cacheMap[paramName] = ParamTypeVal(fact->type(), fact->rawValue());
+        entries.append(ParameterCache::Entry{ paramName, indexMap.value(paramName, -1), factTypeToMavType(fact->type()), _variantToParamUnion(fact->type(), fact->rawValue()) });
+    }
+
+    // Remember how long a full load over the link took, that is what the cache saves next time
+    if (!_initialLoadComplete && (_initialLoadCacheCount == 0) && (_initialLoadLinkCount > 0) && _initialLoadTimer.isValid()) {
+        _linkUSecsPerParam = static_cast<quint32>((_initialLoadTimer.nsecsElapsed() / 1000) / _initialLoadLinkCount);
     }
 
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    (void) ParameterCache::save(parameterCacheFile(vehicleId, componentId), entries, _linkUSecsPerParam);
+}
 
-    QDataStream ds(&cacheFile);
-    ds << cacheMap;
+void ParameterManager::_writeDirtyParamCaches(void)
+{
+    for (const int componentId: std::as_const(_dirtyParamCacheComponents)) {
+        _writeLocalParamCache(_vehicle->id(), componentId);
+    }
+    _dirtyParamCacheComponents.clear();
 }
 
 QDir ParameterManager::parameterCacheDir()
@@ -886,55 +922,49 @@ QDir ParameterManager::parameterCacheDir()
 
 QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
 {
-    return parameterCacheDir().filePath(QString("%1_%2.v2").arg(vehicleId).arg(componentId));
+    return parameterCacheDir().filePath(QString("%1_%2.v3").arg(vehicleId).arg(componentId));
 }
 
 void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
 {
     qCInfo(ParameterManagerLog) << "Attemping load from cache";
 
-    uint32_t crc32_value = 0;
-    /* The datastructure of the cache table */
-    CacheMapName2ParamTypeVal cacheMap;
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (!cacheFile.exists()) {
+    ParameterCache cache;
+    if (!cache.open(parameterCacheFile(vehicleId, componentId))) {
         /* no local cache, just wait for them to come in*/
         return;
     }
-    cacheFile.open(QIODevice::ReadOnly);
-
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cacheFile);
-    ds >> cacheMap;
 
     /* compute the crc of the local cache to check against the remote */
-
-    for (const QString& name: cacheMap.keys()) {
-        const ParamTypeVal&             paramTypeVal    = cacheMap[name];
-        const FactMetaData::ValueType_t fact_type       = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-
-        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->factMetaDataForName(name, fact_type)->volatileValue()) {
+    QList<int> volatileRecords;
+    CompInfoParam* const compInfoParam = _vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1);
+    const uint32_t crc32_value = cache.hash([&](int record) {
+        const QString name = cache.name(record);
+        if (compInfoParam->factMetaDataForName(name, mavTypeToFactType(cache.type(record)))->volatileValue()) {
             // Does not take part in CRC
             qCDebug(ParameterManagerLog) << "Volatile parameter" << name;
-        } else {
-            const void *vdat = paramTypeVal.second.constData();
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
-            crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
+            volatileRecords.append(record);
+            return true;
         }
-    }
+        return false;
+    });
 
     /* if the two param set hashes match, just load from the disk */
     if (crc32_value == hash_value.toUInt()) {
-        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
-
-        int count = cacheMap.count();
-        int index = 0;
-        for (const QString& name: cacheMap.keys()) {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            const MAV_PARAM_TYPE mavParamType = factTypeToMavType(fact_type);
-            _handleParamValue(componentId, name, count, index++, mavParamType, paramTypeVal.second);
+        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(parameterCacheFile(vehicleId, componentId)).absoluteFilePath());
+
+        const int count = cache.count();
+        _initialLoadCacheCount += count;
+        _linkUSecsPerParam = cache.linkUSecsPerParam();
+        for (int record = 0; record < count; record++) {
+            const ParameterCache::Entry entry = cache.entry(record);
+            // Wait list bookkeeping runs on 0..count-1, the vehicle index is kept for the next cache write
+            _handleParamValue(componentId, entry.name, count, record, entry.type, _paramUnionToVariant(entry.value));
+            if (entry.index != 65535) {
+                _paramIndexMap[componentId][entry.name] = entry.index;
+            } else {
+                _paramIndexMap[componentId].remove(entry.name);
+            }
         }
 
         SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
@@ -959,6 +989,22 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
             _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
         }
 
+        // Volatile parameters are left out of the hash, so their cached values may be out of date. Only those
+        // are read back from the vehicle.
+        for (const int record : volatileRecords) {
+            const QString name = cache.name(record);
+            const int paramIndex = cache.paramIndex(record);
+            if (!_waitingReadParamNameMap[componentId].contains(name)) {
+                _waitingReadParamNameBatchCount++;
+            }
+            _waitingReadParamNameMap[componentId][name] = 0;
+            _readParameterRaw(componentId, (paramIndex == 65535) ? name : QString(), (paramIndex == 65535) ? -1 : paramIndex);
+        }
+        if (!volatileRecords.isEmpty()) {
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Reading" << volatileRecords.count() << "volatile parameters after cache load";
+            _waitingParamTimeoutTimer.start();
+        }
+
         // Give the user some feedback things loaded properly
         QVariantAnimation *ani = new QVariantAnimation(this);
         ani->setEasingCurve(QEasingCurve::OutCubic);
@@ -979,12 +1025,14 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
 
         ani->start(QAbstractAnimation::DeleteWhenStopped);
     } else {
-        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
+        // There is no per parameter hash, so without a match every value has to come from the vehicle
+        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(parameterCacheFile(vehicleId, componentId)).absoluteFilePath());
         if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
             _debugCacheCRC[componentId] = true;
-            _debugCacheMap[componentId] = cacheMap;
-            for (const QString& name: cacheMap.keys()) {
-                _debugCacheParamSeen[componentId][name] = false;
+            for (int record = 0; record < cache.count(); record++) {
+                const ParameterCache::Entry entry = cache.entry(record);
+                _debugCacheMap[componentId][entry.name] = ParamTypeVal(mavTypeToFactType(entry.type), _paramUnionToVariant(entry.value));
+                _debugCacheParamSeen[componentId][entry.name] = false;
             }
             qgcApp()->showAppMessage(tr("Parameter cache CRC match failed"));
         }
@@ -1192,6 +1240,15 @@ void ParameterManager::_checkInitialLoadComplete(void)
 
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Initial load complete";
 
+    const qint64 initialLoadMSecs = _initialLoadTimer.isValid() ? _initialLoadTimer.elapsed() : 0;
+    if (_initialLoadCacheCount > 0) {
+        const qint64 linkMSecs = (static_cast<qint64>(_initialLoadCacheCount) * _linkUSecsPerParam) / 1000;
+        qCInfo(ParameterManagerLog) << _logVehiclePrefix(-1) << "Parameters ready in" << initialLoadMSecs << "ms - from cache:" << _initialLoadCacheCount
+                                    << "from vehicle:" << _initialLoadLinkCount << "estimated saving:" << (_linkUSecsPerParam ? QString::number(linkMSecs - initialLoadMSecs) : QStringLiteral("unknown")) << "ms";
+    } else {
+        qCInfo(ParameterManagerLog) << _logVehiclePrefix(-1) << "Parameters ready in" << initialLoadMSecs << "ms - from vehicle:" << _initialLoadLinkCount;
+    }
+
     // Check for index based load failures
     QString indexList;
     bool initialLoadFailures = false;
@@ -12,6 +12,9 @@
 #include <QtCore/QObject>
 #include <QtCore/QMap>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QTimer>
 #include <QtCore/QString>
 #include <QtCore/QLoggingCategory>
@@ -33,6 +36,7 @@ class ParameterManager : public QObject
     Q_OBJECT
 
     friend class ParameterEditorController;
+    friend class ParameterManagerTest;  // Unit test
 
 public:
     /// @param uas Uas which this set of facts is associated with
@@ -117,6 +121,7 @@ private:
     void    _readParameterRaw                   (int componentId, const QString& paramName, int paramIndex);
     void    _sendParamSetToVehicle              (int componentId, const QString& paramName, FactMetaData::ValueType_t valueType, const QVariant& value);
     void    _writeLocalParamCache               (int vehicleId, int componentId);
+    void    _writeDirtyParamCaches              (void);
     void    _tryCacheHashLoad                   (int vehicleId, int componentId, QVariant hash_value);
     void    _loadMetaData                       (void);
     void    _clearMetaData                      (void);
@@ -132,6 +137,8 @@ private:
     bool    _parseParamFile                     (const QString& filename);
 
     static QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
+    static QVariant _paramUnionToVariant(const mavlink_param_union_t& paramUnion);
+    static mavlink_param_union_t _variantToParamUnion(FactMetaData::ValueType_t valueType, const QVariant& value);
 
     Vehicle*            _vehicle;
     MAVLinkProtocol*    _mavlink;
@@ -185,6 +192,14 @@ private:
     QTimer _initialRequestTimeoutTimer;
     QTimer _waitingParamTimeoutTimer;
 
+    QMap<int, QHash<QString, int>>  _paramIndexMap;             ///< Key: Component id, Value: Map { Key: parameter name, Value: parameter index on the vehicle }
+    QSet<int>                       _dirtyParamCacheComponents; ///< Components whose cache is waiting for _paramCacheWriteTimer
+    QTimer                          _paramCacheWriteTimer;      ///< Batches up cache writes for parameter updates after the initial load
+    QElapsedTimer                   _initialLoadTimer;          ///< Started by the first parameter request
+    int                             _initialLoadCacheCount = 0; ///< Parameters of the initial load which came from the cache
+    int                             _initialLoadLinkCount = 0;  ///< Parameters of the initial load which came over the link
+    quint32                         _linkUSecsPerParam = 0;     ///< Link time per parameter of the last full load, used to report cache savings
+
     Fact _defaultFact;   ///< Used to return default fact, when parameter not found
 
     /* MavFTP */
@@ -248,7 +248,8 @@ FlightMap {
         showText: !pipMode
     }
 
-    // Add trajectory lines to the map
+    // Add trajectory lines to the map. The closed part of the path only ever grows at its end and the open tail is at
+    // most a chunk long, so while flying neither polyline has to be rebuilt from the whole path.
     MapPolyline {
         id:         trajectoryPolyline
         line.width: 3
@@ -256,21 +257,54 @@ FlightMap {
         z:          QGroundControl.zOrderTrajectoryLines
         visible:    !pipMode
 
+        property var _trajectoryPoints: _activeVehicle ? _activeVehicle.trajectoryPoints : null
+        property int _level:            _trajectoryPoints ? _trajectoryPoints.levelForZoom(_root.zoomLevel, _root.center.latitude) : 0
+
+        on_LevelChanged: _reload()
+
+        function _reload() {
+            path = _trajectoryPoints ? _trajectoryPoints.closedList(_level) : []
+            trajectoryTailPolyline.path = _trajectoryPoints ? _trajectoryPoints.tailList(_level) : []
+        }
+
+        function _clear() {
+            path = []
+            trajectoryTailPolyline.path = []
+        }
+
+        function _appendClosedChunk() {
+            var coordinates = _trajectoryPoints.closedList(_level, pathLength())
+            for (var i = 0; i < coordinates.length; i++) {
+                addCoordinate(coordinates[i])
+            }
+            trajectoryTailPolyline.path = _trajectoryPoints.tailList(_level)
+        }
+
         Connections {
             target:                 QGroundControl.multiVehicleManager
             function onActiveVehicleChanged(activeVehicle) {
-                trajectoryPolyline.path = _activeVehicle ? _activeVehicle.trajectoryPoints.list() : []
+                trajectoryPolyline._reload()
             }
         }
 
         Connections {
-            target:                             _activeVehicle ? _activeVehicle.trajectoryPoints : null
-            onPointAdded: (coordinate) =>       trajectoryPolyline.addCoordinate(coordinate)
-            onUpdateLastPoint: (coordinate) =>  trajectoryPolyline.replaceCoordinate(trajectoryPolyline.pathLength() - 1, coordinate)
-            onPointsCleared:                    trajectoryPolyline.path = []
+            target:                             trajectoryPolyline._trajectoryPoints
+            onPointAdded: (coordinate) =>       trajectoryTailPolyline.addCoordinate(coordinate)
+            onUpdateLastPoint: (coordinate) =>  trajectoryTailPolyline.replaceCoordinate(trajectoryTailPolyline.pathLength() - 1, coordinate)
+            onPointsCleared:                    trajectoryPolyline._clear()
+            onPathReset:                        trajectoryPolyline._reload()
+            onChunkClosed:                      trajectoryPolyline._appendClosedChunk()
         }
     }
 
+    MapPolyline {
+        id:         trajectoryTailPolyline
+        line.width: 3
+        line.color: "red"
+        z:          QGroundControl.zOrderTrajectoryLines
+        visible:    !pipMode
+    }
+
     // Add the vehicles to the map
     MapItemView {
         model: QGroundControl.multiVehicleManager.vehicles
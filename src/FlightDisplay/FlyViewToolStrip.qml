@@ -23,6 +23,23 @@ ToolStrip {
         id: flyViewToolStripActionList
 
         onDisplayPreFlightChecklist: _root.displayPreFlightChecklist()
+        onSaveTrajectory:            trajectoryFileDialog.openForSave()
+    }
+
+    QGCFileDialog {
+        id:             trajectoryFileDialog
+        folder:         QGroundControl.settingsManager.appSettings.telemetrySavePath
+        title:          qsTr("Save Vehicle Track")
+        nameFilters:    [ qsTr("KML Files (*.%1)").arg(QGroundControl.settingsManager.appSettings.kmlFileExtension), qsTr("CSV Files (*.csv)") ]
+        defaultSuffix:  QGroundControl.settingsManager.appSettings.kmlFileExtension
+
+        onAcceptedForSave: (file) => {
+            var activeVehicle = QGroundControl.multiVehicleManager.activeVehicle
+            if (activeVehicle) {
+                activeVehicle.trajectoryPoints.saveToFile(file)
+            }
+            close()
+        }
     }
 
     model: flyViewToolStripActionList.model
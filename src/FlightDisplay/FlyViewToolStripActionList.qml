@@ -16,6 +16,7 @@ ToolStripActionList {
     id: _root
 
     signal displayPreFlightChecklist
+    signal saveTrajectory
 
     model: [
         ToolStripAction {
@@ -53,6 +54,14 @@ ToolStripActionList {
             }
         },
         PreFlightCheckListShowAction { onTriggered: displayPreFlightChecklist() },
+        ToolStripAction {
+            text:           qsTr("Track")
+            iconSource:     "/qmlimages/LogDownloadIcon"
+            enabled:        _activeVehicle !== null
+            onTriggered:    saveTrajectory()
+
+            property var _activeVehicle: QGroundControl.multiVehicleManager.activeVehicle
+        },
         GuidedActionTakeoff { },
         GuidedActionLand { },
         GuidedActionRTL { },
@@ -0,0 +1,261 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFrameParser.h"
+#include "QGCLoggingCategory.h"
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(MAVLinkFrameParserLog, "qgc.mavlink.mavlinkframeparser")
+
+uint32_t MAVLinkFrameParser::Frame::msgid() const
+{
+    if (isMavlink1()) {
+        return data[5];
+    }
+    return static_cast<uint32_t>(data[7]) | (static_cast<uint32_t>(data[8]) << 8) | (static_cast<uint32_t>(data[9]) << 16);
+}
+
+void MAVLinkFrameParser::reset()
+{
+    _partial.clear();
+    _validFrameCount = 0;
+    _badCRCCount = 0;
+    _droppedByteCount = 0;
+    _unknownMsgIdCount = 0;
+}
+
+int MAVLinkFrameParser::_findStx(const uint8_t* data, int start, int size)
+{
+    for (int i = start; i < size; i++) {
+        if (data[i] == MAVLINK_STX || data[i] == MAVLINK_STX_MAVLINK1) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+MAVLinkFrameParser::FrameCheck MAVLinkFrameParser::_checkFrame(const uint8_t* data, int size, int& frameLength, bool& unknownMsgId)
+{
+    unknownMsgId = false;
+
+    const bool mavlink1 = data[0] == MAVLINK_STX_MAVLINK1;
+    const int headerLen = mavlink1 ? headerLenV1 : headerLenV2;
+
+    uint8_t incompatFlags = 0;
+    if (!mavlink1 && size > 2) {
+        incompatFlags = data[2];
+        if (incompatFlags & ~MAVLINK_IFLAG_MASK) {
+            // Unsupported incompat flag, same as mavlink_parse_char we treat this as a bad frame
+            return FrameInvalid;
+        }
+    }
+
+    if (size < headerLen) {
+        frameLength = headerLen;
+        return FrameIncomplete;
+    }
+
+    const uint8_t payloadLen = data[1];
+    const uint32_t msgid = mavlink1 ? data[5] : (static_cast<uint32_t>(data[7]) | (static_cast<uint32_t>(data[8]) << 8) | (static_cast<uint32_t>(data[9]) << 16));
+
+    frameLength = headerLen + payloadLen + MAVLINK_NUM_CHECKSUM_BYTES;
+    if (incompatFlags & MAVLINK_IFLAG_SIGNED) {
+        frameLength += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    if (size < frameLength) {
+        return FrameIncomplete;
+    }
+
+    // Same as mavlink_parse_char, a message id which is not in the CRC_EXTRA table is
+    // checked with a crc extra of 0 and passed on if that matches
+    const mavlink_msg_entry_t* const msgEntry = mavlink_get_msg_entry(msgid);
+    unknownMsgId = !msgEntry;
+
+    uint16_t crc = crc_calculate(data + 1, static_cast<uint16_t>(headerLen - 1 + payloadLen));
+    crc_accumulate(msgEntry ? msgEntry->crc_extra : 0, &crc);
+
+    const uint8_t* const ck = data + headerLen + payloadLen;
+    const uint16_t rxCrc = static_cast<uint16_t>(ck[0] | (ck[1] << 8));
+
+    return (crc == rxCrc) ? FrameValid : FrameInvalid;
+}
+
+int MAVLinkFrameParser::frameLengthAt(const uint8_t* data, int size)
+{
+    if (size < 1) {
+        return 0;
+    }
+    if (data[0] != MAVLINK_STX && data[0] != MAVLINK_STX_MAVLINK1) {
+        return -1;
+    }
+
+    int frameLength = 0;
+    bool unknownMsgId = false;
+    switch (_checkFrame(data, size, frameLength, unknownMsgId)) {
+    case FrameValid:
+        return frameLength;
+    case FrameIncomplete:
+        return 0;
+    case FrameInvalid:
+    default:
+        return -1;
+    }
+}
+
+bool MAVLinkFrameParser::_scan(const uint8_t* data, int size, int& consumed, int& frameCount, const FrameCallback& frameCallback)
+{
+    int pos = 0;
+
+    while (pos < size) {
+        const int stx = _findStx(data, pos, size);
+        if (stx < 0) {
+            _droppedByteCount += size - pos;
+            pos = size;
+            break;
+        }
+        _droppedByteCount += stx - pos;
+        pos = stx;
+
+        int frameLength = 0;
+        bool unknownMsgId = false;
+        switch (_checkFrame(data + pos, size - pos, frameLength, unknownMsgId)) {
+        case FrameIncomplete:
+            consumed = pos;
+            return true;
+        case FrameInvalid:
+            // Resync on the next STX following this one
+            _badCRCCount++;
+            _droppedByteCount++;
+            pos++;
+            break;
+        case FrameValid:
+        {
+            _validFrameCount++;
+            if (unknownMsgId) {
+                _unknownMsgIdCount++;
+            }
+            frameCount++;
+            Frame frame;
+            frame.data = data + pos;
+            frame.length = frameLength;
+            pos += frameLength;
+            if (!frameCallback(frame)) {
+                consumed = pos;
+                return false;
+            }
+            break;
+        }
+        }
+    }
+
+    consumed = size;
+    return true;
+}
+
+int MAVLinkFrameParser::parse(const QByteArray& bytes, const FrameCallback& frameCallback)
+{
+    const uint8_t* const data = reinterpret_cast<const uint8_t*>(bytes.constData());
+    const int size = bytes.size();
+    int offset = 0;
+    int frameCount = 0;
+
+    // First finish off any frame left over from the previous buffer
+    while (!_partial.isEmpty()) {
+        int frameLength = 0;
+        bool unknownMsgId = false;
+        const FrameCheck check = _checkFrame(reinterpret_cast<const uint8_t*>(_partial.constData()), _partial.size(), frameLength, unknownMsgId);
+
+        if (check == FrameIncomplete) {
+            const int take = qMin(frameLength - static_cast<int>(_partial.size()), size - offset);
+            if (take <= 0) {
+                return frameCount;
+            }
+            _partial.append(bytes.constData() + offset, take);
+            offset += take;
+        } else if (check == FrameValid) {
+            _validFrameCount++;
+            if (unknownMsgId) {
+                _unknownMsgIdCount++;
+            }
+            frameCount++;
+            Frame frame;
+            frame.data = reinterpret_cast<const uint8_t*>(_partial.constData());
+            frame.length = frameLength;
+            const bool keepGoing = frameCallback(frame);
+            _partial.clear();
+            if (!keepGoing) {
+                return frameCount;
+            }
+        } else {
+            // Bad frame: rescan everything after its STX. This is the uncommon path so
+            // it's fine to pay for a copy here.
+            _badCRCCount++;
+            _droppedByteCount++;
+            const QByteArray rescan = _partial.mid(1) + bytes.mid(offset);
+            _partial.clear();
+            return frameCount + parse(rescan, frameCallback);
+        }
+    }
+
+    int consumed = 0;
+    if (!_scan(data + offset, size - offset, consumed, frameCount, frameCallback)) {
+        return frameCount;
+    }
+
+    if (offset + consumed < size) {
+        _partial = QByteArray(bytes.constData() + offset + consumed, size - offset - consumed);
+    }
+
+    return frameCount;
+}
+
+void MAVLinkFrameParser::decode(const Frame& frame, mavlink_message_t* message)
+{
+    const uint8_t* const data = frame.data;
+    int headerLen;
+
+    message->magic = data[0];
+    message->len = data[1];
+    if (frame.isMavlink1()) {
+        headerLen = headerLenV1;
+        message->incompat_flags = 0;
+        message->compat_flags = 0;
+        message->seq = data[2];
+        message->sysid = data[3];
+        message->compid = data[4];
+        message->msgid = data[5];
+    } else {
+        headerLen = headerLenV2;
+        message->incompat_flags = data[2];
+        message->compat_flags = data[3];
+        message->seq = data[4];
+        message->sysid = data[5];
+        message->compid = data[6];
+        message->msgid = frame.msgid();
+    }
+
+    const uint8_t* const payload = data + headerLen;
+    char* const msgPayload = _MAV_PAYLOAD_NON_CONST(message);
+    (void) memcpy(msgPayload, payload, message->len);
+
+    // Zero-fill the payload to cope with trimmed mavlink 2 payloads
+    const mavlink_msg_entry_t* const msgEntry = mavlink_get_msg_entry(message->msgid);
+    if (msgEntry && (message->len < msgEntry->max_msg_len)) {
+        (void) memset(msgPayload + message->len, 0, msgEntry->max_msg_len - message->len);
+    }
+
+    message->ck[0] = payload[message->len];
+    message->ck[1] = payload[message->len + 1];
+    message->checksum = static_cast<uint16_t>(message->ck[0] | (message->ck[1] << 8));
+
+    if (frame.isSigned()) {
+        (void) memcpy(message->signature, payload + message->len + MAVLINK_NUM_CHECKSUM_BYTES, MAVLINK_SIGNATURE_BLOCK_LEN);
+    }
+}
@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QLoggingCategory>
+
+#include <functional>
+
+#include "MAVLinkLib.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkFrameParserLog)
+
+/// Block oriented MAVLink framer. Instead of running every byte through mavlink_parse_char
+/// it scans a whole buffer for STX markers, validates the frame checksum in one pass and
+/// hands out views into the original buffer. The raw frame bytes can then be used as is
+/// for forwarding and logging without having to re-serialize the decoded message.
+///
+/// Frames which are split across two buffers are carried over to the next call to parse.
+/// Only the bytes of the partial frame are copied.
+class MAVLinkFrameParser
+{
+public:
+    /// View onto a single CRC valid frame. The data pointer is only valid for the
+    /// duration of the frame callback.
+    struct Frame {
+        const uint8_t*  data    = nullptr;  ///< Points to the STX byte of the frame
+        int             length  = 0;        ///< Total frame length including checksum and signature
+
+        bool isMavlink1() const { return data[0] == MAVLINK_STX_MAVLINK1; }
+        bool isSigned() const { return !isMavlink1() && (data[2] & MAVLINK_IFLAG_SIGNED); }
+        uint32_t msgid() const;
+    };
+
+    /// Called for each valid frame found. Return false to stop parsing the remainder of the buffer.
+    typedef std::function<bool(const Frame& frame)> FrameCallback;
+
+    MAVLinkFrameParser() = default;
+
+    /// Resets the parser to its initial state, throwing away any partial frame
+    void reset();
+
+    /// Scans the buffer for complete frames and calls frameCallback for each one
+    ///     @return Number of valid frames found
+    int parse(const QByteArray& bytes, const FrameCallback& frameCallback);
+
+    /// Decodes the frame into a mavlink_message_t the same way mavlink_parse_char would do
+    /// for an unsigned frame. Signature verification is not handled here, signed frames or
+    /// channels with signing enabled must go through mavlink_parse_char.
+    static void decode(const Frame& frame, mavlink_message_t* message);
+
+    /// Checks whether a CRC valid frame starts at data[0]
+    ///     @return Total frame length, 0 if size is too short to tell, -1 if there is no valid frame
+    static int frameLengthAt(const uint8_t* data, int size);
+
+    uint64_t validFrameCount(void) const    { return _validFrameCount; }
+    uint64_t badCRCCount(void) const        { return _badCRCCount; }
+    uint64_t droppedByteCount(void) const   { return _droppedByteCount; }
+    uint64_t unknownMsgIdCount(void) const  { return _unknownMsgIdCount; }   ///< Valid frames with a message id not in the CRC_EXTRA table
+
+    static constexpr int headerLenV1 = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+    static constexpr int headerLenV2 = MAVLINK_CORE_HEADER_LEN + 1;
+
+private:
+    enum FrameCheck {
+        FrameValid,
+        FrameInvalid,
+        FrameIncomplete
+    };
+
+    /// Checks whether a valid frame starts at data[0]
+    ///     @param[out] frameLength Total length of the frame if known
+    ///     @param[out] unknownMsgId true: Message id is not in the CRC_EXTRA table, checked with a crc extra of 0
+    static FrameCheck _checkFrame(const uint8_t* data, int size, int& frameLength, bool& unknownMsgId);
+
+    /// @return Offset of next STX byte at or after start, -1 for none
+    static int _findStx(const uint8_t* data, int start, int size);
+
+    /// Scans a contiguous block of data.
+    ///     @param[out] consumed Number of bytes fully processed, the remainder is an incomplete frame
+    ///     @return false: callback requested stop
+    bool _scan(const uint8_t* data, int size, int& consumed, int& frameCount, const FrameCallback& frameCallback);
+
+    QByteArray  _partial;                   ///< Incomplete frame carried over from previous buffer
+    uint64_t    _validFrameCount    = 0;
+    uint64_t    _badCRCCount        = 0;
+    uint64_t    _droppedByteCount   = 0;
+    uint64_t    _unknownMsgIdCount  = 0;
+};
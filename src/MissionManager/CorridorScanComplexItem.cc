@@ -210,12 +210,8 @@ void CorridorScanComplexItem::_rebuildCorridorPolygon(void)
     _surveyAreaPolygon.appendVertices(rgCoord);
 }
 
-void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
+CorridorScanComplexItem::TransectJob_t CorridorScanComplexItem::_transectJob(void)
 {
-    if (_ignoreRecalc) {
-        return;
-    }
-
     // If the transects are getting rebuilt then any previsouly loaded mission items are now invalid
     if (_loadedMissionItemsParent) {
         _loadedMissionItems.clear();
@@ -223,16 +219,37 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
         _loadedMissionItemsParent = nullptr;
     }
 
-    double transectSpacing = _calcTransectSpacing();
-    double fullWidth = _corridorWidthFact.rawValue().toDouble();
+    TransectSnapshot_t snapshot;
+    snapshot.polyline           = _corridorPolyline.coordinateList();
+    snapshot.transectSpacing    = _calcTransectSpacing();
+    snapshot.corridorWidth      = _corridorWidthFact.rawValue().toDouble();
+    snapshot.transectCount      = _calcTransectCount();
+    snapshot.entryPoint         = _entryPoint;
+    snapshot.turnaroundDistance = _hasTurnaround() ? _turnAroundDistanceFact.rawValue().toDouble() : 0;
+
+    // Each transect offsets and intersects every edge of the polyline
+    const qint64 cost = static_cast<qint64>(snapshot.transectCount) * snapshot.polyline.count();
+
+    return TransectJob_t{ [snapshot](const TransectCanceled_t& canceled) { return _buildTransects(snapshot, canceled); }, cost };
+}
+
+QList<QList<TransectStyleComplexItem::CoordInfo_t>> CorridorScanComplexItem::_buildTransects(const TransectSnapshot_t& snapshot, const TransectCanceled_t& canceled)
+{
+    QList<QList<CoordInfo_t>> rgTransects;
+
+    double transectSpacing = snapshot.transectSpacing;
+    double fullWidth = snapshot.corridorWidth;
     double halfWidth = fullWidth / 2.0;
-    int transectCount = _calcTransectCount();
+    int transectCount = snapshot.transectCount;
     double normalizedTransectPosition = transectSpacing / 2.0;
 
-    if (_corridorPolyline.count() >= 2) {
+    if (snapshot.polyline.count() >= 2) {
         // First build up the transects all going the same direction
-        //qDebug() << "_rebuildTransectsPhase1";
+        //qDebug() << "_buildTransects";
         for (int i=0; i<transectCount; i++) {
+            if (canceled()) {
+                return rgTransects;
+            }
             //qDebug() << "start transect";
             double offsetDistance;
             if (transectCount == 1) {
@@ -245,7 +262,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
 
             // Turn transect into CoordInfo transect
             QList<TransectStyleComplexItem::CoordInfo_t> transect;
-            QList<QGeoCoordinate> transectCoords = _corridorPolyline.offsetPolyline(offsetDistance);
+            QList<QGeoCoordinate> transectCoords = QGCMapPolyline::offsetPolyline(snapshot.polyline, offsetDistance);
             for (int j=1; j<transectCoords.count() - 1; j++) {
                 TransectStyleComplexItem::CoordInfo_t coordInfo = { transectCoords[j], CoordTypeInterior };
                 transect.append(coordInfo);
@@ -256,9 +273,9 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             transect.append(coordInfo);
 
             // Extend the transect ends for turnaround
-            if (_hasTurnaround()) {
+            if (snapshot.turnaroundDistance > 0) {
                 QGeoCoordinate turnaroundCoord;
-                double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+                double turnAroundDistance = snapshot.turnaroundDistance;
 
                 double azimuth = transectCoords[0].azimuthTo(transectCoords[1]);
                 turnaroundCoord = transectCoords[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -280,7 +297,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             }
 #endif
 
-            _transects.append(transect);
+            rgTransects.append(transect);
             normalizedTransectPosition += transectSpacing;
         }
 
@@ -292,7 +309,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
 
         bool reverseTransects = false;
         bool reverseVertices = false;
-        switch (_entryPoint) {
+        switch (snapshot.entryPoint) {
         case 0:
             reverseTransects = false;
             reverseVertices = false;
@@ -312,26 +329,26 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
         }
         if (reverseTransects) {
             QList<QList<TransectStyleComplexItem::CoordInfo_t>> reversedTransects;
-            for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: _transects) {
+            for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: rgTransects) {
                 reversedTransects.prepend(transect);
             }
-            _transects = reversedTransects;
+            rgTransects = reversedTransects;
         }
         if (reverseVertices) {
-            for (int i=0; i<_transects.count(); i++) {
+            for (int i=0; i<rgTransects.count(); i++) {
                 QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
-                for (const TransectStyleComplexItem::CoordInfo_t& vertex: _transects[i]) {
+                for (const TransectStyleComplexItem::CoordInfo_t& vertex: rgTransects[i]) {
                     reversedVertices.prepend(vertex);
                 }
-                _transects[i] = reversedVertices;
+                rgTransects[i] = reversedVertices;
             }
         }
 
         // Adjust to lawnmower pattern
         reverseVertices = false;
-        for (int i=0; i<_transects.count(); i++) {
+        for (int i=0; i<rgTransects.count(); i++) {
             // We must reverse the vertices for every other transect in order to make a lawnmower pattern
-            QList<TransectStyleComplexItem::CoordInfo_t> transectVertices = _transects[i];
+            QList<TransectStyleComplexItem::CoordInfo_t> transectVertices = rgTransects[i];
             if (reverseVertices) {
                 reverseVertices = false;
                 QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
@@ -350,9 +367,11 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             } else {
                 reverseVertices = true;
             }
-            _transects[i] = transectVertices;
+            rgTransects[i] = transectVertices;
         }
     }
+
+    return rgTransects;
 }
 
 void CorridorScanComplexItem::_recalcCameraShots(void)
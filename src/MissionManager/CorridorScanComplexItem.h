@@ -67,10 +67,24 @@ private slots:
     void _updateWizardMode              (void);
 
     // Overrides from TransectStyleComplexItem
-    void _rebuildTransectsPhase1    (void) final;
     void _recalcCameraShots         (void) final;
 
 private:
+    /// Everything the transects are built from, copied so the build can run on a worker thread
+    typedef struct {
+        QList<QGeoCoordinate>   polyline;
+        double                  transectSpacing;
+        double                  corridorWidth;
+        int                     transectCount;
+        int                     entryPoint;
+        double                  turnaroundDistance;     ///< 0 for no turnaround
+    } TransectSnapshot_t;
+
+    // Overrides from TransectStyleComplexItem
+    TransectJob_t _transectJob(void) final;
+
+    static QList<QList<CoordInfo_t>> _buildTransects(const TransectSnapshot_t& snapshot, const TransectCanceled_t& canceled);
+
     double  _calcTransectSpacing    (void) const;
     int     _calcTransectCount      (void) const;
     void    _saveCommon             (QJsonObject& complexObject);
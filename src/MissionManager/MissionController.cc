@@ -32,6 +32,7 @@
 #include "MissionCommandTree.h"
 #include "QGC.h"
 #include "QGCLoggingCategory.h"
+#include "TerrainTileManager.h"
 
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
@@ -55,6 +56,7 @@ MissionController::MissionController(PlanMasterController* masterController, QOb
 
     connect(&_updateTimer,                                  &QTimer::timeout,                           this, &MissionController::_updateTimeout);
     connect(_planViewSettings->takeoffItemNotRequired(),    &Fact::rawValueChanged,                     this, &MissionController::_takeoffItemNotRequiredChanged);
+    connect(_planViewSettings->showGimbalOnlyWhenSet(),     &Fact::rawValueChanged,                     this, &MissionController::_recalcAllFlightLegs);
     connect(this,                                           &MissionController::missionDistanceChanged, this, &MissionController::recalcTerrainProfile);
 
     // The follow is used to compress multiple recalc calls in a row to into a single call.
@@ -1001,6 +1003,7 @@ void MissionController::_initLoadedVisualItems(QmlObjectListModel* loadedVisualI
     MissionController::_scanForAdditionalSettings(_visualItems, _masterController);
 
     _initAllVisualItems();
+    _prefetchTerrain();
 
     if (_visualItems->count() > 1) {
         _firstItemAdded();
@@ -1009,6 +1012,31 @@ void MissionController::_initLoadedVisualItems(QmlObjectListModel* loadedVisualI
     }
 }
 
+/// Starts loading terrain tiles for the whole flight path of a newly loaded plan. The terrain queries made
+/// by the flight path segments and complex items are then answered together once the tiles are in, rather
+/// than each segment waiting on its own tile downloads.
+void MissionController::_prefetchTerrain(void)
+{
+    if (qgcApp()->runningUnitTests()) {
+        return;
+    }
+
+    QList<QGeoCoordinate> path;
+    for (int i=0; i<_visualItems->count(); i++) {
+        VisualMissionItem* visualItem = _visualItems->value<VisualMissionItem*>(i);
+        if (visualItem->specifiesCoordinate() && visualItem->coordinate().isValid()) {
+            path.append(visualItem->coordinate());
+            if (!visualItem->exitCoordinateSameAsEntry()) {
+                path.append(visualItem->exitCoordinate());
+            }
+        }
+    }
+
+    if (path.count()) {
+        TerrainTileManager::instance()->prefetchPath(path);
+    }
+}
+
 bool MissionController::load(const QJsonObject& json, QString& errorString)
 {
     QString errorStr;
@@ -1179,11 +1207,7 @@ FlightPathSegment* MissionController::_createFlightPathSegmentWorker(VisualItemP
     connect(pair.second, &VisualMissionItem::coordinateChanged,     segment,    &FlightPathSegment::setCoordinate2);
     connect(pair.second, &VisualMissionItem::amslEntryAltChanged,   segment,    &FlightPathSegment::setCoord2AMSLAlt);
 
-    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-
     connect(segment,    &FlightPathSegment::totalDistanceChanged,       this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
     connect(segment,    &FlightPathSegment::amslTerrainHeightsChanged,  this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
     connect(segment,    &FlightPathSegment::terrainCollisionChanged,    this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
 
@@ -1432,7 +1456,7 @@ void MissionController::_recalcFlightPathSegments(void)
     // Anything left in the old table is an obsolete line object that can go
     qDeleteAll(oldSegmentTable);
 
-    emit _recalcMissionFlightStatusSignal();
+    _recalcAllFlightLegs();
 
     if (_waypointPath.count() == 0) {
         // MapPolyLine has a bug where if you change from a path which has elements to an empty path the line drawn
@@ -1449,294 +1473,454 @@ void MissionController::_recalcFlightPathSegments(void)
     }
 }
 
-void MissionController::_updateBatteryInfo(int waypointIndex)
+void MissionController::_updateBatteryInfo(void)
 {
     if (_missionFlightStatus.mAhBattery != 0) {
         _missionFlightStatus.hoverAmpsTotal = (_missionFlightStatus.hoverTime / 60.0) * _missionFlightStatus.hoverAmps;
         _missionFlightStatus.cruiseAmpsTotal = (_missionFlightStatus.cruiseTime / 60.0) * _missionFlightStatus.cruiseAmps;
         _missionFlightStatus.batteriesRequired = ceil((_missionFlightStatus.hoverAmpsTotal + _missionFlightStatus.cruiseAmpsTotal) / _missionFlightStatus.ampMinutesAvailable);
+
         // FIXME: Battery change point code pretty much doesn't work. The reason is that is treats complex items as a black box. It needs to be able to look
         // inside complex items in order to determine a swap point that is interior to a complex item. Current the swap point display in PlanToolbar is
         // disabled to do this problem.
-        if (waypointIndex != -1 && _missionFlightStatus.batteriesRequired == 2 && _missionFlightStatus.batteryChangePoint == -1) {
-            _missionFlightStatus.batteryChangePoint = waypointIndex - 1;
+        _missionFlightStatus.batteryChangePoint = -1;
+        for (int i=0; i<_flightLegs.count() && _missionFlightStatus.batteriesRequired >= 2 && _missionFlightStatus.batteryChangePoint == -1; i++) {
+            const FlightLeg_t& leg = _flightLegs[i];
+            for (int checkpoint=0; checkpoint<leg.checkpointCount; checkpoint++) {
+                double hoverAmpsTotal = ((_flightLegTotals[i].hoverTime + leg.checkpointHoverTime[checkpoint]) / 60.0) * _missionFlightStatus.hoverAmps;
+                double cruiseAmpsTotal = ((_flightLegTotals[i].cruiseTime + leg.checkpointCruiseTime[checkpoint]) / 60.0) * _missionFlightStatus.cruiseAmps;
+                if (ceil((hoverAmpsTotal + cruiseAmpsTotal) / _missionFlightStatus.ampMinutesAvailable) == 2) {
+                    _missionFlightStatus.batteryChangePoint = leg.checkpointSeqNum[checkpoint] - 1;
+                    break;
+                }
+            }
         }
+        if (_missionFlightStatus.batteryChangePoint == -1) {
+            _missionFlightStatus.batteryChangePoint = 0;
+        }
+    }
+}
+
+/// Remembers the leg times at a waypoint so the battery change point can be found from the running totals
+void MissionController::_addBatteryCheckpoint(FlightLeg_t& leg, int waypointIndex)
+{
+    if (waypointIndex != -1 && leg.checkpointCount < 2) {
+        leg.checkpointSeqNum[leg.checkpointCount] = waypointIndex;
+        leg.checkpointHoverTime[leg.checkpointCount] = leg.totals.hoverTime;
+        leg.checkpointCruiseTime[leg.checkpointCount] = leg.totals.cruiseTime;
+        leg.checkpointCount++;
     }
 }
 
-void MissionController::_addHoverTime(double hoverTime, double hoverDistance, int waypointIndex)
+void MissionController::_addHoverTime(FlightLeg_t& leg, double hoverTime, double hoverDistance, int waypointIndex)
 {
-    _missionFlightStatus.totalTime += hoverTime;
-    _missionFlightStatus.hoverTime += hoverTime;
-    _missionFlightStatus.hoverDistance += hoverDistance;
-    _missionFlightStatus.totalDistance += hoverDistance;
-    _updateBatteryInfo(waypointIndex);
+    leg.totals.hoverTime += hoverTime;
+    leg.totals.hoverDistance += hoverDistance;
+    _addBatteryCheckpoint(leg, waypointIndex);
 }
 
-void MissionController::_addCruiseTime(double cruiseTime, double cruiseDistance, int waypointIndex)
+void MissionController::_addCruiseTime(FlightLeg_t& leg, double cruiseTime, double cruiseDistance, int waypointIndex)
 {
-    _missionFlightStatus.totalTime += cruiseTime;
-    _missionFlightStatus.cruiseTime += cruiseTime;
-    _missionFlightStatus.cruiseDistance += cruiseDistance;
-    _missionFlightStatus.totalDistance += cruiseDistance;
-    _updateBatteryInfo(waypointIndex);
+    leg.totals.cruiseTime += cruiseTime;
+    leg.totals.cruiseDistance += cruiseDistance;
+    _addBatteryCheckpoint(leg, waypointIndex);
 }
 
 /// Adds the specified time to the appropriate hover or cruise time values.
+///     @param leg          Leg to add the values to
 ///     @param vtolInHover true: vtol is currrent in hover mode
 ///     @param hoverTime    Amount of time tp add to hover
 ///     @param cruiseTime   Amount of time to add to cruise
 ///     @param extraTime    Amount of additional time to add to hover/cruise
 ///     @param seqNum       Sequence number of waypoint for these values, -1 for no waypoint associated
-void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum)
+void MissionController::_addTimeDistance(FlightLeg_t& leg, bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum)
 {
     if (_controllerVehicle->vtol()) {
         if (vtolInHover) {
-            _addHoverTime(hoverTime, distance, seqNum);
-            _addHoverTime(extraTime, 0, -1);
+            _addHoverTime(leg, hoverTime, distance, seqNum);
+            _addHoverTime(leg, extraTime, 0, -1);
         } else {
-            _addCruiseTime(cruiseTime, distance, seqNum);
-            _addCruiseTime(extraTime, 0, -1);
+            _addCruiseTime(leg, cruiseTime, distance, seqNum);
+            _addCruiseTime(leg, extraTime, 0, -1);
         }
     } else {
         if (_controllerVehicle->multiRotor()) {
-            _addHoverTime(hoverTime, distance, seqNum);
-            _addHoverTime(extraTime, 0, -1);
+            _addHoverTime(leg, hoverTime, distance, seqNum);
+            _addHoverTime(leg, extraTime, 0, -1);
         } else {
-            _addCruiseTime(cruiseTime, distance, seqNum);
-            _addCruiseTime(extraTime, 0, -1);
+            _addCruiseTime(leg, cruiseTime, distance, seqNum);
+            _addCruiseTime(leg, extraTime, 0, -1);
         }
     }
 }
 
-void MissionController::_recalcMissionFlightStatus()
+bool MissionController::_sameFlightWalkState(const FlightWalkState_t& state1, const FlightWalkState_t& state2)
 {
-    if (!_visualItems->count()) {
-        return;
+    return state1.lastFlyThroughVI == state2.lastFlyThroughVI &&
+            state1.firstCoordinateItem == state2.firstCoordinateItem &&
+            state1.linkStartToHome == state2.linkStartToHome &&
+            state1.foundRTL == state2.foundRTL &&
+            state1.status.vtolMode == state2.status.vtolMode &&
+            QGC::fuzzyCompare(state1.status.cruiseSpeed, state2.status.cruiseSpeed) &&
+            QGC::fuzzyCompare(state1.status.hoverSpeed, state2.status.hoverSpeed) &&
+            QGC::fuzzyCompare(state1.status.vehicleSpeed, state2.status.vehicleSpeed) &&
+            QGC::fuzzyCompare(state1.status.vehicleYaw, state2.status.vehicleYaw) &&
+            QGC::fuzzyCompare(state1.status.gimbalYaw, state2.status.gimbalYaw) &&
+            QGC::fuzzyCompare(state1.status.gimbalPitch, state2.status.gimbalPitch);
+}
+
+/// Marks the flight status of the signalling item as needing a recalc
+void MissionController::_visualItemFlightLegChanged(void)
+{
+    VisualMissionItem* item = qobject_cast<VisualMissionItem*>(sender());
+    if (item == _settingsItem) {
+        // Home position takes part in the legs of all items
+        _flightLegs.clear();
+    } else if (item) {
+        _dirtyFlightLegItems.insert(item);
     }
+    emit _recalcMissionFlightStatusSignal();
+}
 
-    bool                firstCoordinateItem =           true;
-    VisualMissionItem*  lastFlyThroughVI =   qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+void MissionController::_recalcAllFlightLegs(void)
+{
+    _flightLegs.clear();
+    emit _recalcMissionFlightStatusSignal();
+}
 
-    bool homePositionValid = _settingsItem->coordinate().isValid();
+/// Walks a single visual item. The per item values are updated on the item, the flight status results go to leg.
+///     @param state Walk state prior to the item, updated to the state after it
+void MissionController::_calcFlightLeg(FlightWalkState_t& state, FlightLeg_t& leg)
+{
+    VisualMissionItem*      item =              leg.item;
+    SimpleMissionItem*      simpleItem =        qobject_cast<SimpleMissionItem*>(item);
+    ComplexMissionItem*     complexItem =       qobject_cast<ComplexMissionItem*>(item);
+    MissionFlightStatus_t&  status =            state.status;
+    bool                    homePositionValid = _settingsItem->coordinate().isValid();
+
+    leg.stateIn                 = state;
+    leg.totals                  = FlightTotals_t();
+    leg.hasLeg                  = false;
+    leg.legDistance             = 0;
+    leg.maxTelemetryDistance    = 0;
+    leg.minAMSLAltitude         = qQNaN();
+    leg.maxAMSLAltitude         = qQNaN();
+    leg.checkpointCount         = 0;
+
+    if (simpleItem && simpleItem->mavCommand() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
+        state.foundRTL = true;
+    }
+
+    // Assume the worst
+    item->setAzimuth(0);
+    item->setDistance(0);
+
+    // Gimbal states reflect the state AFTER executing the item
+
+    // ROI commands cancel out previous gimbal yaw/pitch
+    if (simpleItem) {
+        switch (simpleItem->command()) {
+        case MAV_CMD_NAV_ROI:
+        case MAV_CMD_DO_SET_ROI_LOCATION:
+        case MAV_CMD_DO_SET_ROI_WPNEXT_OFFSET:
+        case MAV_CMD_DO_GIMBAL_MANAGER_PITCHYAW:
+            status.gimbalYaw      = qQNaN();
+            status.gimbalPitch    = qQNaN();
+            break;
+        default:
+            break;
+        }
+    }
 
-    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus";
+    // Look for specific gimbal changes
+    double gimbalYaw = item->specifiedGimbalYaw();
+    if (!qIsNaN(gimbalYaw) || _planViewSettings->showGimbalOnlyWhenSet()->rawValue().toBool()) {
+        status.gimbalYaw = gimbalYaw;
+    }
+    double gimbalPitch = item->specifiedGimbalPitch();
+    if (!qIsNaN(gimbalPitch) || _planViewSettings->showGimbalOnlyWhenSet()->rawValue().toBool()) {
+        status.gimbalPitch = gimbalPitch;
+    }
 
-    // If home position is valid we can calculate distances between all waypoints.
-    // If home position is not valid we can only calculate distances between waypoints which are
-    // both relative altitude.
+    // We don't need to do any more processing if:
+    //  Mission Settings Item
+    //  We are after an RTL command
+    if (item != _settingsItem && !state.foundRTL) {
+        // We must set the mission flight status prior to querying for any values from the item. This is because things like
+        // current speed, gimbal, vtol state  impact the values.
+        item->setMissionFlightStatus(status);
 
-    // No values for first item
-    lastFlyThroughVI->setAltDifference(0);
-    lastFlyThroughVI->setAzimuth(0);
-    lastFlyThroughVI->setDistance(0);
-    lastFlyThroughVI->setDistanceFromStart(0);
+        // Link back to home if first item is takeoff and we have home position
+        if (state.firstCoordinateItem && simpleItem && (simpleItem->mavCommand() == MAV_CMD_NAV_TAKEOFF || simpleItem->mavCommand() == MAV_CMD_NAV_VTOL_TAKEOFF)) {
+            if (homePositionValid) {
+                state.linkStartToHome = true;
+                if (_controllerVehicle->multiRotor() || _controllerVehicle->vtol()) {
+                    // We have to special case takeoff, assuming vehicle takes off straight up to specified altitude
+                    double azimuth, distance, altDifference;
+                    _calcPrevWaypointValues(_settingsItem, simpleItem, &azimuth, &distance, &altDifference);
+                    double takeoffTime = qAbs(altDifference) / _appSettings->offlineEditingAscentSpeed()->rawValue().toDouble();
+                    _addHoverTime(leg, takeoffTime, 0, -1);
+                }
+            }
+        }
 
-    _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
+        _addTimeDistance(leg, status.vtolMode == QGCMAVLink::VehicleClassMultiRotor, 0, 0, item->additionalTimeDelay(), 0, -1);
 
-    _resetMissionFlightStatus();
+        if (item->specifiesCoordinate()) {
 
-    bool   linkStartToHome =            false;
-    bool   foundRTL =                   false;
-    double totalHorizontalDistance =    0;
+            // Keep track of the min/max AMSL altitude for entire mission so we can calculate altitude percentages in terrain status display
+            if (simpleItem) {
+                leg.minAMSLAltitude = leg.maxAMSLAltitude = item->amslEntryAlt();
+            } else {
+                // Complex item
+                leg.minAMSLAltitude = complexItem->minAMSLAltitude();
+                leg.maxAMSLAltitude = complexItem->maxAMSLAltitude();
+            }
 
-    for (int i=0; i<_visualItems->count(); i++) {
-        VisualMissionItem*  item =          qobject_cast<VisualMissionItem*>(_visualItems->get(i));
-        SimpleMissionItem*  simpleItem =    qobject_cast<SimpleMissionItem*>(item);
-        ComplexMissionItem* complexItem =   qobject_cast<ComplexMissionItem*>(item);
+            if (!item->isStandaloneCoordinate()) {
+                state.firstCoordinateItem = false;
 
-        if (simpleItem && simpleItem->mavCommand() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
-            foundRTL = true;
-        }
+                // Update vehicle yaw assuming direction to next waypoint and/or mission item change
+                if (simpleItem) {
+                    double newVehicleYaw = simpleItem->specifiedVehicleYaw();
+                    if (qIsNaN(newVehicleYaw)) {
+                        // No specific vehicle yaw set. Current vehicle yaw is determined from flight path segment direction.
+                        if (simpleItem != state.lastFlyThroughVI) {
+                            status.vehicleYaw = state.lastFlyThroughVI->exitCoordinate().azimuthTo(simpleItem->coordinate());
+                        }
+                    } else {
+                        status.vehicleYaw = newVehicleYaw;
+                    }
+                    simpleItem->setMissionVehicleYaw(status.vehicleYaw);
+                }
 
-        // Assume the worst
-        item->setAzimuth(0);
-        item->setDistance(0);
-        item->setDistanceFromStart(0);
+                if (state.lastFlyThroughVI != _settingsItem || state.linkStartToHome) {
+                    // This is a subsequent waypoint or we are forcing the first waypoint back to home
+                    double azimuth, distance, altDifference;
 
-        // Gimbal states reflect the state AFTER executing the item
+                    _calcPrevWaypointValues(item, state.lastFlyThroughVI, &azimuth, &distance, &altDifference);
+                    leg.hasLeg = true;
+                    leg.legDistance = distance;
+                    leg.totals.horizontalDistance += distance;
+                    item->setAltDifference(altDifference);
+                    item->setAzimuth(azimuth);
+                    item->setDistance(distance);
 
-        // ROI commands cancel out previous gimbal yaw/pitch
-        if (simpleItem) {
-            switch (simpleItem->command()) {
-            case MAV_CMD_NAV_ROI:
-            case MAV_CMD_DO_SET_ROI_LOCATION:
-            case MAV_CMD_DO_SET_ROI_WPNEXT_OFFSET:
-            case MAV_CMD_DO_GIMBAL_MANAGER_PITCHYAW:
-                _missionFlightStatus.gimbalYaw      = qQNaN();
-                _missionFlightStatus.gimbalPitch    = qQNaN();
-                break;
-            default:
-                break;
-            }
-        }
+                    leg.maxTelemetryDistance = qMax(leg.maxTelemetryDistance, _calcDistanceToHome(item, _settingsItem));
 
-        // Look for specific gimbal changes
-        double gimbalYaw = item->specifiedGimbalYaw();
-        if (!qIsNaN(gimbalYaw) || _planViewSettings->showGimbalOnlyWhenSet()->rawValue().toBool()) {
-            _missionFlightStatus.gimbalYaw = gimbalYaw;
-        }
-        double gimbalPitch = item->specifiedGimbalPitch();
-        if (!qIsNaN(gimbalPitch) || _planViewSettings->showGimbalOnlyWhenSet()->rawValue().toBool()) {
-            _missionFlightStatus.gimbalPitch = gimbalPitch;
-        }
-
-        // We don't need to do any more processing if:
-        //  Mission Settings Item
-        //  We are after an RTL command
-        if (i != 0 && !foundRTL) {
-            // We must set the mission flight status prior to querying for any values from the item. This is because things like
-            // current speed, gimbal, vtol state  impact the values.
-            item->setMissionFlightStatus(_missionFlightStatus);
-
-            // Link back to home if first item is takeoff and we have home position
-            if (firstCoordinateItem && simpleItem && (simpleItem->mavCommand() == MAV_CMD_NAV_TAKEOFF || simpleItem->mavCommand() == MAV_CMD_NAV_VTOL_TAKEOFF)) {
-                if (homePositionValid) {
-                    linkStartToHome = true;
-                    if (_controllerVehicle->multiRotor() || _controllerVehicle->vtol()) {
-                        // We have to special case takeoff, assuming vehicle takes off straight up to specified altitude
-                        double azimuth, distance, altDifference;
-                        _calcPrevWaypointValues(_settingsItem, simpleItem, &azimuth, &distance, &altDifference);
-                        double takeoffTime = qAbs(altDifference) / _appSettings->offlineEditingAscentSpeed()->rawValue().toDouble();
-                        _addHoverTime(takeoffTime, 0, -1);
-                    }
+                    // Calculate time/distance
+                    double hoverTime = distance / status.hoverSpeed;
+                    double cruiseTime = distance / status.cruiseSpeed;
+                    _addTimeDistance(leg, status.vtolMode == QGCMAVLink::VehicleClassMultiRotor, hoverTime, cruiseTime, 0, distance, item->sequenceNumber());
                 }
-            }
 
-            _addTimeDistance(_missionFlightStatus.vtolMode == QGCMAVLink::VehicleClassMultiRotor, 0, 0, item->additionalTimeDelay(), 0, -1);
+                if (complexItem) {
+                    // Add in distance/time inside complex items as well
+                    double distance = complexItem->complexDistance();
+                    leg.maxTelemetryDistance = qMax(leg.maxTelemetryDistance, complexItem->greatestDistanceTo(complexItem->exitCoordinate()));
 
-            if (item->specifiesCoordinate()) {
+                    double hoverTime = distance / status.hoverSpeed;
+                    double cruiseTime = distance / status.cruiseSpeed;
+                    _addTimeDistance(leg, status.vtolMode == QGCMAVLink::VehicleClassMultiRotor, hoverTime, cruiseTime, 0, distance, item->sequenceNumber());
 
-                // Keep track of the min/max AMSL altitude for entire mission so we can calculate altitude percentages in terrain status display
-                if (simpleItem) {
-                    double amslAltitude = item->amslEntryAlt();
-                    _minAMSLAltitude = std::fmin(_minAMSLAltitude, amslAltitude);
-                    _maxAMSLAltitude = std::fmax(_maxAMSLAltitude, amslAltitude);
-                } else {
-                    // Complex item
-                    double complexMinAMSLAltitude = complexItem->minAMSLAltitude();
-                    double complexMaxAMSLAltitude = complexItem->maxAMSLAltitude();
-                    _minAMSLAltitude = std::fmin(_minAMSLAltitude, complexMinAMSLAltitude);
-                    _maxAMSLAltitude = std::fmax(_maxAMSLAltitude, complexMaxAMSLAltitude);
+                    leg.totals.horizontalDistance += distance;
                 }
 
-                if (!item->isStandaloneCoordinate()) {
-                    firstCoordinateItem = false;
 
-                    // Update vehicle yaw assuming direction to next waypoint and/or mission item change
-                    if (simpleItem) {
-                        double newVehicleYaw = simpleItem->specifiedVehicleYaw();
-                        if (qIsNaN(newVehicleYaw)) {
-                            // No specific vehicle yaw set. Current vehicle yaw is determined from flight path segment direction.
-                            if (simpleItem != lastFlyThroughVI) {
-                                _missionFlightStatus.vehicleYaw = lastFlyThroughVI->exitCoordinate().azimuthTo(simpleItem->coordinate());
-                            }
-                        } else {
-                            _missionFlightStatus.vehicleYaw = newVehicleYaw;
-                        }
-                        simpleItem->setMissionVehicleYaw(_missionFlightStatus.vehicleYaw);
-                    }
+                state.lastFlyThroughVI = item;
+            }
+        }
+    }
 
-                    if (lastFlyThroughVI != _settingsItem || linkStartToHome) {
-                        // This is a subsequent waypoint or we are forcing the first waypoint back to home
-                        double azimuth, distance, altDifference;
+    // Speed, VTOL states changes are processed last since they take affect on the next item
 
-                        _calcPrevWaypointValues(item, lastFlyThroughVI, &azimuth, &distance, &altDifference);
-                        totalHorizontalDistance += distance;
-                        item->setAltDifference(altDifference);
-                        item->setAzimuth(azimuth);
-                        item->setDistance(distance);
-                        item->setDistanceFromStart(totalHorizontalDistance);
+    double newSpeed = item->specifiedFlightSpeed();
+    if (!qIsNaN(newSpeed)) {
+        if (_controllerVehicle->multiRotor()) {
+            status.hoverSpeed = newSpeed;
+        } else if (_controllerVehicle->vtol()) {
+            if (status.vtolMode == QGCMAVLink::VehicleClassMultiRotor) {
+                status.hoverSpeed = newSpeed;
+            } else {
+                status.cruiseSpeed = newSpeed;
+            }
+        } else {
+            status.cruiseSpeed = newSpeed;
+        }
+        status.vehicleSpeed = newSpeed;
+    }
 
-                        _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, _calcDistanceToHome(item, _settingsItem));
+    // Update VTOL state
+    if (simpleItem && _controllerVehicle->vtol()) {
+        switch (simpleItem->command()) {
+        case MAV_CMD_NAV_TAKEOFF:       // This will do a fixed wing style takeoff
+        case MAV_CMD_NAV_VTOL_TAKEOFF:  // Vehicle goes straight up and then transitions to FW
+        case MAV_CMD_NAV_LAND:
+            status.vtolMode = QGCMAVLink::VehicleClassFixedWing;
+            break;
+        case MAV_CMD_NAV_VTOL_LAND:
+            status.vtolMode = QGCMAVLink::VehicleClassMultiRotor;
+            break;
+        case MAV_CMD_DO_VTOL_TRANSITION:
+        {
+            int transitionState = simpleItem->missionItem().param1();
+            if (transitionState == MAV_VTOL_STATE_MC) {
+                status.vtolMode = QGCMAVLink::VehicleClassMultiRotor;
+            } else if (transitionState == MAV_VTOL_STATE_FW) {
+                status.vtolMode = QGCMAVLink::VehicleClassFixedWing;
+            }
+        }
+            break;
+        default:
+            break;
+        }
+    }
+}
 
-                        // Calculate time/distance
-                        double hoverTime = distance / _missionFlightStatus.hoverSpeed;
-                        double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
-                        _addTimeDistance(_missionFlightStatus.vtolMode == QGCMAVLink::VehicleClassMultiRotor, hoverTime, cruiseTime, 0, distance, item->sequenceNumber());
-                    }
+/// Recalculates the mission flight status. Results are cached per visual item along with running totals. Only the items
+/// from the first changed one on are walked again, and only until the walk state matches the cached state again. Past that
+/// point the running totals are shifted which is cheap compared to walking the items.
+void MissionController::_recalcMissionFlightStatus()
+{
+    const int itemCount = _visualItems->count();
+    if (!itemCount) {
+        return;
+    }
 
-                    if (complexItem) {
-                        // Add in distance/time inside complex items as well
-                        double distance = complexItem->complexDistance();
-                        _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, complexItem->greatestDistanceTo(complexItem->exitCoordinate()));
+    bool homePositionValid = _settingsItem->coordinate().isValid();
 
-                        double hoverTime = distance / _missionFlightStatus.hoverSpeed;
-                        double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
-                        _addTimeDistance(_missionFlightStatus.vtolMode == QGCMAVLink::VehicleClassMultiRotor, hoverTime, cruiseTime, 0, distance, item->sequenceNumber());
+    // If home position is valid we can calculate distances between all waypoints.
+    // If home position is not valid we can only calculate distances between waypoints which are
+    // both relative altitude.
 
-                        totalHorizontalDistance += distance;
-                    }
+    // The cache is only usable if it still holds exactly the current items
+    QSet<VisualMissionItem*> dirtyItems;
+    dirtyItems.swap(_dirtyFlightLegItems);
+    bool fullRecalc = _flightLegs.count() != itemCount;
+    int startIndex = itemCount;
+    int lastDirtyIndex = -1;
+    for (int i=0; i<itemCount && !fullRecalc; i++) {
+        if (_flightLegs[i].item != _visualItems->get(i)) {
+            fullRecalc = true;
+        } else if (dirtyItems.contains(_flightLegs[i].item)) {
+            startIndex = qMin(startIndex, i);
+            lastDirtyIndex = i;
+        }
+    }
 
+    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus fullRecalc:startIndex" << fullRecalc << startIndex;
 
-                    lastFlyThroughVI = item;
-                }
-            }
+    FlightWalkState_t state;
+    if (fullRecalc) {
+        startIndex = 0;
+        _flightLegs.resize(itemCount);
+        _flightLegTotals.resize(itemCount + 1);
+        _flightLegTotals[0] = FlightTotals_t();
+        for (int i=0; i<itemCount; i++) {
+            _flightLegs[i].item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
         }
 
-        // Speed, VTOL states changes are processed last since they take affect on the next item
+        _resetMissionFlightStatus();
 
-        double newSpeed = item->specifiedFlightSpeed();
-        if (!qIsNaN(newSpeed)) {
-            if (_controllerVehicle->multiRotor()) {
-                _missionFlightStatus.hoverSpeed = newSpeed;
-            } else if (_controllerVehicle->vtol()) {
-                if (_missionFlightStatus.vtolMode == QGCMAVLink::VehicleClassMultiRotor) {
-                    _missionFlightStatus.hoverSpeed = newSpeed;
-                } else {
-                    _missionFlightStatus.cruiseSpeed = newSpeed;
-                }
-            } else {
-                _missionFlightStatus.cruiseSpeed = newSpeed;
-            }
-            _missionFlightStatus.vehicleSpeed = newSpeed;
+        state.status                = _missionFlightStatus;
+        state.lastFlyThroughVI      = _flightLegs[0].item;
+        state.firstCoordinateItem   = true;
+        state.linkStartToHome       = false;
+        state.foundRTL              = false;
+
+        // No values for first item
+        state.lastFlyThroughVI->setAltDifference(0);
+        state.lastFlyThroughVI->setAzimuth(0);
+        state.lastFlyThroughVI->setDistance(0);
+        state.lastFlyThroughVI->setDistanceFromStart(0);
+    } else if (startIndex < itemCount) {
+        state = _flightLegs[startIndex].stateIn;
+    } else {
+        state = _flightWalkStateOut;
+    }
+
+    // A changed item also changes the leg to the next fly through item, so the walk has to get past that one before it can stop
+    int  walkEndIndex =     itemCount;
+    bool legOutPending =    false;
+    for (int i=startIndex; i<itemCount; i++) {
+        FlightLeg_t& leg = _flightLegs[i];
+
+        if (!fullRecalc && i > lastDirtyIndex && !legOutPending && _sameFlightWalkState(state, leg.stateIn)) {
+            walkEndIndex = i;
+            state = _flightWalkStateOut;
+            break;
         }
 
-        // Update VTOL state
-        if (simpleItem && _controllerVehicle->vtol()) {
-            switch (simpleItem->command()) {
-            case MAV_CMD_NAV_TAKEOFF:       // This will do a fixed wing style takeoff
-            case MAV_CMD_NAV_VTOL_TAKEOFF:  // Vehicle goes straight up and then transitions to FW
-            case MAV_CMD_NAV_LAND:
-                _missionFlightStatus.vtolMode = QGCMAVLink::VehicleClassFixedWing;
-                break;
-            case MAV_CMD_NAV_VTOL_LAND:
-                _missionFlightStatus.vtolMode = QGCMAVLink::VehicleClassMultiRotor;
-                break;
-            case MAV_CMD_DO_VTOL_TRANSITION:
-            {
-                int transitionState = simpleItem->missionItem().param1();
-                if (transitionState == MAV_VTOL_STATE_MC) {
-                    _missionFlightStatus.vtolMode = QGCMAVLink::VehicleClassMultiRotor;
-                } else if (transitionState == MAV_VTOL_STATE_FW) {
-                    _missionFlightStatus.vtolMode = QGCMAVLink::VehicleClassFixedWing;
-                }
-            }
-                break;
-            default:
-                break;
-            }
+        VisualMissionItem* lastFlyThroughVI = state.lastFlyThroughVI;
+        _calcFlightLeg(state, leg);
+        if (dirtyItems.contains(leg.item)) {
+            legOutPending = true;
+        } else if (state.lastFlyThroughVI != lastFlyThroughVI) {
+            legOutPending = false;
         }
     }
-    lastFlyThroughVI->setMissionVehicleYaw(_missionFlightStatus.vehicleYaw);
+    if (walkEndIndex == itemCount) {
+        _flightWalkStateOut = state;
+    }
+    state.lastFlyThroughVI->setMissionVehicleYaw(state.status.vehicleYaw);
+
+    // Update the running totals. Past the walked items they only shift, so stop as soon as they come out the same.
+    for (int i=startIndex; i<itemCount; i++) {
+        const FlightLeg_t&      leg =   _flightLegs[i];
+        const FlightTotals_t&   prior = _flightLegTotals[i];
+        FlightTotals_t          total;
+
+        total.hoverTime             = prior.hoverTime + leg.totals.hoverTime;
+        total.cruiseTime            = prior.cruiseTime + leg.totals.cruiseTime;
+        total.hoverDistance         = prior.hoverDistance + leg.totals.hoverDistance;
+        total.cruiseDistance        = prior.cruiseDistance + leg.totals.cruiseDistance;
+        total.horizontalDistance    = prior.horizontalDistance + leg.totals.horizontalDistance;
+
+        const FlightTotals_t& previousTotal = _flightLegTotals[i + 1];
+        if (i >= walkEndIndex &&
+                total.hoverTime == previousTotal.hoverTime && total.cruiseTime == previousTotal.cruiseTime &&
+                total.hoverDistance == previousTotal.hoverDistance && total.cruiseDistance == previousTotal.cruiseDistance &&
+                total.horizontalDistance == previousTotal.horizontalDistance) {
+            break;
+        }
+
+        _flightLegTotals[i + 1] = total;
+        leg.item->setDistanceFromStart(leg.hasLeg ? prior.horizontalDistance + leg.legDistance : 0);
+    }
 
     // Add the information for the final segment back to home
-    if (foundRTL && lastFlyThroughVI != _settingsItem && homePositionValid) {
+    FlightLeg_t finalLeg = {};
+    if (state.foundRTL && state.lastFlyThroughVI != _settingsItem && homePositionValid) {
         double azimuth, distance, altDifference;
-        _calcPrevWaypointValues(lastFlyThroughVI, _settingsItem, &azimuth, &distance, &altDifference);
+        _calcPrevWaypointValues(state.lastFlyThroughVI, _settingsItem, &azimuth, &distance, &altDifference);
 
         // Calculate time/distance
-        double hoverTime = distance / _missionFlightStatus.hoverSpeed;
-        double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
+        double hoverTime = distance / state.status.hoverSpeed;
+        double cruiseTime = distance / state.status.cruiseSpeed;
         double landTime = qAbs(altDifference) / _appSettings->offlineEditingDescentSpeed()->rawValue().toDouble();
-        _addTimeDistance(_missionFlightStatus.vtolMode == QGCMAVLink::VehicleClassMultiRotor, hoverTime, cruiseTime, distance, landTime, -1);
+        _addTimeDistance(finalLeg, state.status.vtolMode == QGCMAVLink::VehicleClassMultiRotor, hoverTime, cruiseTime, distance, landTime, -1);
     }
 
-    if (_missionFlightStatus.mAhBattery != 0 && _missionFlightStatus.batteryChangePoint == -1) {
-        _missionFlightStatus.batteryChangePoint = 0;
+    const FlightTotals_t& totals = _flightLegTotals[itemCount];
+    _missionFlightStatus                = state.status;
+    _missionFlightStatus.hoverTime      = totals.hoverTime + finalLeg.totals.hoverTime;
+    _missionFlightStatus.cruiseTime     = totals.cruiseTime + finalLeg.totals.cruiseTime;
+    _missionFlightStatus.hoverDistance  = totals.hoverDistance + finalLeg.totals.hoverDistance;
+    _missionFlightStatus.cruiseDistance = totals.cruiseDistance + finalLeg.totals.cruiseDistance;
+    _missionFlightStatus.totalTime      = _missionFlightStatus.hoverTime + _missionFlightStatus.cruiseTime;
+    _missionFlightStatus.totalDistance  = _missionFlightStatus.hoverDistance + _missionFlightStatus.cruiseDistance;
+    _updateBatteryInfo();
+
+    double previousMinAMSLAltitude = _minAMSLAltitude;
+    double previousMaxAMSLAltitude = _maxAMSLAltitude;
+    _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
+    for (const FlightLeg_t& leg : _flightLegs) {
+        _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, leg.maxTelemetryDistance);
+        _minAMSLAltitude = std::fmin(_minAMSLAltitude, leg.minAMSLAltitude);
+        _maxAMSLAltitude = std::fmax(_maxAMSLAltitude, leg.maxAMSLAltitude);
     }
 
-    if (linkStartToHome) {
+    if (state.linkStartToHome) {
         // Home position is taken into account for min/max values
         _minAMSLAltitude = std::fmin(_minAMSLAltitude, _settingsItem->plannedHomePositionAltitude()->rawValue().toDouble());
         _maxAMSLAltitude = std::fmax(_maxAMSLAltitude, _settingsItem->plannedHomePositionAltitude()->rawValue().toDouble());
@@ -1754,10 +1938,16 @@ void MissionController::_recalcMissionFlightStatus()
     emit minAMSLAltitudeChanged         (_minAMSLAltitude);
     emit maxAMSLAltitudeChanged         (_maxAMSLAltitude);
 
-    // Walk the list again calculating altitude percentages
+    // Walk the list again calculating altitude percentages. Unless the altitude range changed only the walked items need it.
+    int percentStartIndex = 0;
+    int percentEndIndex = itemCount;
+    if (!fullRecalc && QGC::fuzzyCompare(_minAMSLAltitude, previousMinAMSLAltitude) && QGC::fuzzyCompare(_maxAMSLAltitude, previousMaxAMSLAltitude)) {
+        percentStartIndex = startIndex;
+        percentEndIndex = walkEndIndex;
+    }
     double altRange = _maxAMSLAltitude - _minAMSLAltitude;
-    for (int i=0; i<_visualItems->count(); i++) {
-        VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
+    for (int i=percentStartIndex; i<percentEndIndex; i++) {
+        VisualMissionItem* item = _flightLegs[i].item;
 
         if (item->specifiesCoordinate()) {
             double amslAlt = item->amslEntryAlt();
@@ -1933,6 +2123,10 @@ void MissionController::_deinitAllVisualItems(void)
 
     disconnect(_visualItems, &QmlObjectListModel::dirtyChanged, this, &MissionController::dirtyChanged);
     disconnect(_visualItems, &QmlObjectListModel::countChanged, this, &MissionController::_updateContainsItems);
+
+    // Cached flight status belongs to the old items
+    _flightLegs.clear();
+    _dirtyFlightLegItems.clear();
 }
 
 void MissionController::_initVisualItem(VisualMissionItem* visualItem)
@@ -1940,13 +2134,16 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     setDirty(false);
 
     connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(visualItem, &VisualMissionItem::coordinateChanged,                          this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::amslEntryAltChanged,                        this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::amslExitAltChanged,                         this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_visualItemFlightLegChanged);
+    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_visualItemFlightLegChanged);
     connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_recalcSequence);
 
     if (visualItem->isSimpleItem()) {
@@ -1960,10 +2157,10 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     } else {
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(visualItem);
         if (complexItem) {
-            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_visualItemFlightLegChanged);
+            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_visualItemFlightLegChanged);
+            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_visualItemFlightLegChanged);
+            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_visualItemFlightLegChanged);
             connect(complexItem, &ComplexMissionItem::isIncompleteChanged,          this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
         } else {
             qWarning() << "ComplexMissionItem not found";
@@ -2008,8 +2205,8 @@ void MissionController::_managerVehicleChanged(Vehicle* managerVehicle)
     connect(_missionManager, &MissionManager::lastCurrentIndexChanged,  this, &MissionController::resumeMissionIndexChanged);
     connect(_missionManager, &MissionManager::resumeMissionReady,       this, &MissionController::resumeMissionReady);
     connect(_missionManager, &MissionManager::resumeMissionUploadFail,  this, &MissionController::resumeMissionUploadFail);
-    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_recalcAllFlightLegs);
+    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_recalcAllFlightLegs);
     connect(_managerVehicle, &Vehicle::vehicleTypeChanged,              this, &MissionController::complexMissionItemNamesChanged);
 
     emit complexMissionItemNamesChanged();
@@ -11,6 +11,8 @@
 
 #include <QtCore/QHash>
 #include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QSet>
 #include <QtCore/QLoggingCategory>
 
 #include "PlanElementController.h"
@@ -320,14 +322,52 @@ private slots:
     void _recalcAll                             (void);
     void _managerVehicleChanged                 (Vehicle* managerVehicle);
     void _takeoffItemNotRequiredChanged         (void);
+    void _visualItemFlightLegChanged            (void);
+    void _recalcAllFlightLegs                   (void);
 
 private:
+    typedef struct {
+        double hoverTime;
+        double cruiseTime;
+        double hoverDistance;
+        double cruiseDistance;
+        double horizontalDistance;  ///< Distance used for distanceFromStart
+    } FlightTotals_t;
+
+    /// State carried from one item to the next while walking the mission
+    typedef struct {
+        MissionFlightStatus_t   status;                 ///< Only the state values are used, totals are kept per leg
+        VisualMissionItem*      lastFlyThroughVI;
+        bool                    firstCoordinateItem;
+        bool                    linkStartToHome;
+        bool                    foundRTL;
+    } FlightWalkState_t;
+
+    /// Flight status results of a single visual item. The results only depend on the walk state prior
+    /// to the item, the item itself and the previous fly through item. So once the walk state matches
+    /// the cached one again after an edit, the remaining items don't need to be walked.
+    typedef struct {
+        VisualMissionItem*      item;
+        FlightWalkState_t       stateIn;
+        FlightTotals_t          totals;
+        bool                    hasLeg;                 ///< Item has a leg from the previous fly through item
+        double                  legDistance;
+        double                  maxTelemetryDistance;
+        double                  minAMSLAltitude;
+        double                  maxAMSLAltitude;
+        int                     checkpointCount;        ///< Battery checks done within the item, at most one for the leg and one for a complex item
+        int                     checkpointSeqNum[2];
+        double                  checkpointHoverTime[2];
+        double                  checkpointCruiseTime[2];
+    } FlightLeg_t;
+
     void                    _init                               (void);
     void                    _recalcSequence                     (void);
     void                    _recalcChildItems                   (void);
     void                    _recalcAllWithCoordinate            (const QGeoCoordinate& coordinate);
     void                    _recalcROISpecialVisuals            (void);
     void                    _initAllVisualItems                 (void);
+    void                    _prefetchTerrain                    (void);
     void                    _deinitAllVisualItems               (void);
     void                    _initVisualItem                     (VisualMissionItem* item);
     void                    _deinitVisualItem                   (VisualMissionItem* item);
@@ -344,13 +384,15 @@ private:
     void                    _scanForAdditionalSettings          (QmlObjectListModel* visualItems, PlanMasterController* masterController);
     void                    _setPlannedHomePositionFromFirstCoordinate(const QGeoCoordinate& clickCoordinate);
     void                    _resetMissionFlightStatus           (void);
-    void                    _addHoverTime                       (double hoverTime, double hoverDistance, int waypointIndex);
-    void                    _addCruiseTime                      (double cruiseTime, double cruiseDistance, int wayPointIndex);
-    void                    _updateBatteryInfo                  (int waypointIndex);
     bool                    _loadItemsFromJson                  (const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
     void                    _initLoadedVisualItems              (QmlObjectListModel* loadedVisualItems);
     FlightPathSegment*      _addFlightPathSegment               (FlightPathSegmentHashTable& prevItemPairHashTable, VisualItemPair& pair, bool mavlinkTerrainFrame);
-    void                    _addTimeDistance                    (bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum);
+    void                    _calcFlightLeg                      (FlightWalkState_t& state, FlightLeg_t& leg);
+    void                    _addTimeDistance                    (FlightLeg_t& leg, bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum);
+    void                    _addHoverTime                       (FlightLeg_t& leg, double hoverTime, double hoverDistance, int waypointIndex);
+    void                    _addCruiseTime                      (FlightLeg_t& leg, double cruiseTime, double cruiseDistance, int waypointIndex);
+    void                    _addBatteryCheckpoint               (FlightLeg_t& leg, int waypointIndex);
+    void                    _updateBatteryInfo                  (void);
     VisualMissionItem*      _insertSimpleMissionItemWorker      (QGeoCoordinate coordinate, MAV_CMD command, int visualItemIndex, bool makeCurrentItem);
     void                    _insertComplexMissionItemWorker     (const QGeoCoordinate& mapCenterCoordinate, ComplexMissionItem* complexItem, int visualItemIndex, bool makeCurrentItem);
     bool                    _isROIBeginItem                     (SimpleMissionItem* simpleItem);
@@ -360,6 +402,7 @@ private:
     void                    _firstItemAdded                     (void);
 
     static double           _calcDistanceToHome                 (VisualMissionItem* currentItem, VisualMissionItem* homeItem);
+    static bool             _sameFlightWalkState                (const FlightWalkState_t& state1, const FlightWalkState_t& state2);
     static double           _normalizeLat                       (double lat);
     static double           _normalizeLon                       (double lon);
     static bool             _convertToMissionItems              (QmlObjectListModel* visualMissionItems, QList<MissionItem*>& rgMissionItems, QObject* missionItemParent);
@@ -381,6 +424,10 @@ private:
     bool                        _itemsRequested =               false;
     bool                        _inRecalcSequence =             false;
     MissionFlightStatus_t       _missionFlightStatus;
+    QList<FlightLeg_t>          _flightLegs;                    ///< Per visual item flight status cache, empty forces a full recalc
+    QList<FlightTotals_t>       _flightLegTotals;               ///< Prefix sums of the leg totals, entry i is the total prior to item i
+    FlightWalkState_t           _flightWalkStateOut;            ///< Walk state after the last item
+    QSet<VisualMissionItem*>    _dirtyFlightLegItems;
     AppSettings*                _appSettings =                  nullptr;
     double                      _progressPct =                  0;
     int                         _currentPlanViewSeqNum =        -1;
@@ -19,6 +19,7 @@
 #include "QGCApplication.h"
 #include "Vehicle.h"
 #include "QGCLoggingCategory.h"
+#include "SurveyGeometry.h"
 
 #include <QtGui/QPolygonF>
 #include <QtCore/QJsonArray>
@@ -426,7 +427,7 @@ bool SurveyComplexItem::_gridAngleIsNorthSouthTransects()
     return gridAngle < 45.0 || (gridAngle > 360.0 - 45.0) || (gridAngle > 90.0 + 45.0 && gridAngle < 270.0 - 45.0);
 }
 
-void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects)
+void SurveyComplexItem::_adjustTransectsToEntryPointLocation(int entryPoint, QList<QList<QGeoCoordinate>>& transects)
 {
     if (transects.count() == 0) {
         return;
@@ -435,10 +436,10 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
     bool reversePoints = false;
     bool reverseTransects = false;
 
-    if (_entryPoint == EntryLocationBottomLeft || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationBottomLeft || entryPoint == EntryLocationBottomRight) {
         reversePoints = true;
     }
-    if (_entryPoint == EntryLocationTopRight || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationTopRight || entryPoint == EntryLocationBottomRight) {
         reverseTransects = true;
     }
 
@@ -451,7 +452,7 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
         _reverseTransectOrder(transects);
     }
 
-    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << _entryPoint;
+    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << entryPoint;
 }
 
 QPointF SurveyComplexItem::_rotatePoint(const QPointF& point, const QPointF& origin, double angle)
@@ -528,48 +529,10 @@ void SurveyComplexItem::_intersectLinesWithRect(const QList<QLineF>& lineList, c
 
 void SurveyComplexItem::_intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines)
 {
-    resultLines.clear();
-
-    for (int i=0; i<lineList.count(); i++) {
-        const QLineF& line = lineList[i];
-        QList<QPointF> intersections;
-
-        // Intersect the line with all the polygon edges
-        for (int j=0; j<polygon.count()-1; j++) {
-            QPointF intersectPoint;
-            QLineF polygonLine = QLineF(polygon[j], polygon[j+1]);
-
-            auto intersect = line.intersects(polygonLine, &intersectPoint);
-            if (intersect == QLineF::BoundedIntersection) {
-                if (!intersections.contains(intersectPoint)) {
-                    intersections.append(intersectPoint);
-                }
-            }
-        }
-
-        // We now have one or more intersection points all along the same line. Find the two
-        // which are furthest away from each other to form the transect.
-        if (intersections.count() > 1) {
-            QPointF firstPoint;
-            QPointF secondPoint;
-            double currentMaxDistance = 0;
-
-            for (int i=0; i<intersections.count(); i++) {
-                for (int j=0; j<intersections.count(); j++) {
-                    QLineF lineTest(intersections[i], intersections[j]);
-                    \
-                    double newMaxDistance = lineTest.length();
-                    if (newMaxDistance > currentMaxDistance) {
-                        firstPoint = intersections[i];
-                        secondPoint = intersections[j];
-                        currentMaxDistance = newMaxDistance;
-                    }
-                }
-            }
-
-            resultLines += QLineF(firstPoint, secondPoint);
-        }
-    }
+    // Each line becomes the segment between its two intersections with the polygon which are furthest
+    // away from each other. Edges are swept in order across the lines so imported boundaries with
+    // thousands of vertices don't cost lines x edges intersection tests.
+    SurveyGeometry::clipParallelLines(lineList, polygon, resultLines);
 }
 
 /// Adjust the line segments such that they are all going the same direction with respect to going from P1->P2
@@ -627,20 +590,8 @@ double SurveyComplexItem::_turnaroundDistance(void) const
     return _turnAroundDistanceFact.rawValue().toDouble();
 }
 
-void SurveyComplexItem::_rebuildTransectsPhase1(void)
+SurveyComplexItem::TransectJob_t SurveyComplexItem::_transectJob(void)
 {
-    _rebuildTransectsPhase1WorkerSinglePolygon(false /* refly */);
-    if (_refly90DegreesFact.rawValue().toBool()) {
-        _rebuildTransectsPhase1WorkerSinglePolygon(true /* refly */);
-    }
-}
-
-void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
-{
-    if (_ignoreRecalc) {
-        return;
-    }
-
     // If the transects are getting rebuilt then any previously loaded mission items are now invalid
     if (_loadedMissionItemsParent) {
         _loadedMissionItems.clear();
@@ -648,18 +599,66 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         _loadedMissionItemsParent = nullptr;
     }
 
-    if (_surveyAreaPolygon.count() < 3) {
+    TransectSnapshot_t snapshot;
+    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
+        snapshot.polygon.append(_surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate());
+    }
+    snapshot.gridAngle              = _gridAngleFact.rawValue().toDouble();
+    snapshot.gridSpacing            = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    snapshot.entryPoint             = _entryPoint;
+    snapshot.flyAlternateTransects  = _flyAlternateTransectsFact.rawValue().toBool();
+    snapshot.refly90Degrees         = _refly90DegreesFact.rawValue().toBool();
+    snapshot.hoverAndCapture        = triggerCamera() && hoverAndCaptureEnabled();
+    snapshot.triggerDistance        = triggerDistance();
+    snapshot.turnaroundDistance     = _hasTurnaround() ? _turnAroundDistanceFact.rawValue().toDouble() : 0;
+
+    // Every generated line is tested against every polygon edge, hover points add a coordinate each
+    qint64 cost = 0;
+    if (snapshot.polygon.count() >= 3) {
+        double maxExtent = 0;
+        for (const QGeoCoordinate& vertex: snapshot.polygon) {
+            maxExtent = qMax(maxExtent, 2.0 * snapshot.polygon[0].distanceTo(vertex));
+        }
+        const double lineSpacing = snapshot.gridSpacing < 0.5 ? 100000 : snapshot.gridSpacing;
+        const qint64 lineCount = static_cast<qint64>((maxExtent + 2000.0) / lineSpacing) + 1;
+        cost = lineCount * snapshot.polygon.count();
+        if (snapshot.hoverAndCapture && (snapshot.triggerDistance > 0)) {
+            cost += static_cast<qint64>((maxExtent / lineSpacing) * (maxExtent / snapshot.triggerDistance));
+        }
+        if (snapshot.refly90Degrees) {
+            cost *= 2;
+        }
+    }
+
+    return TransectJob_t{ [snapshot](const TransectCanceled_t& canceled) { return _buildTransects(snapshot, canceled); }, cost };
+}
+
+QList<QList<TransectStyleComplexItem::CoordInfo_t>> SurveyComplexItem::_buildTransects(const TransectSnapshot_t& snapshot, const TransectCanceled_t& canceled)
+{
+    QList<QList<CoordInfo_t>> transects;
+
+    _buildTransectsSinglePolygon(snapshot, false /* refly */, canceled, transects);
+    if (snapshot.refly90Degrees && !transects.isEmpty() && !canceled()) {
+        _buildTransectsSinglePolygon(snapshot, true /* refly */, canceled, transects);
+    }
+
+    return transects;
+}
+
+void SurveyComplexItem::_buildTransectsSinglePolygon(const TransectSnapshot_t& snapshot, bool refly, const TransectCanceled_t& canceled, QList<QList<CoordInfo_t>>& rgTransects)
+{
+    if (snapshot.polygon.count() < 3) {
         return;
     }
 
     // Convert polygon to NED
 
     QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
+    QGeoCoordinate tangentOrigin = snapshot.polygon[0];
+    qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon Convert polygon to NED - count:tangentOrigin" << snapshot.polygon.count() << tangentOrigin;
+    for (int i=0; i<snapshot.polygon.count(); i++) {
         double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
+        QGeoCoordinate vertex = snapshot.polygon[i];
         if (i == 0) {
             // This avoids a nan calculation that comes out of convertGeoToNed
             x = y = 0;
@@ -667,13 +666,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
             QGCGeo::convertGeoToNed(vertex, tangentOrigin, y, x, down);
         }
         polygonPoints += QPointF(x, y);
-        qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
+        qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
     }
 
     // Generate transects
 
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    double gridAngle = snapshot.gridAngle;
+    double gridSpacing = snapshot.gridSpacing;
     if (gridSpacing < 0.5) {
         // We can't let gridSpacing get too small otherwise we will end up with too many transects.
         // So we limit to 0.5 meter spacing as min and set to huge value which will cause a single
@@ -683,13 +682,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
 
     gridAngle = _clampGridAngle90(gridAngle);
     gridAngle += refly ? 90 : 0;
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Clamped grid angle" << gridAngle;
+    qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon Clamped grid angle" << gridAngle;
 
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
+    qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
 
     // Convert polygon to bounding rect
 
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Polygon";
+    qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon Polygon";
     QPolygonF polygon;
     for (int i=0; i<polygonPoints.count(); i++) {
         qCDebug(SurveyComplexItemLog) << "Vertex" << polygonPoints[i];
@@ -719,6 +718,9 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         lineList += QLineF(_rotatePoint(QPointF(transectX, transectYTop), boundingCenter, gridAngle), _rotatePoint(QPointF(transectX, transectYBottom), boundingCenter, gridAngle));
         transectX += gridSpacing;
     }
+    if (canceled()) {
+        return;
+    }
 
     // Now intersect the lines with the polygon
     QList<QLineF> intersectLines;
@@ -733,7 +735,6 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
     //      Create a single transect which goes through the center of the polygon
     //      Intersect it with the polygon
     if (intersectLines.count() < 2) {
-        _surveyAreaPolygon.center();
         QLineF firstLine = lineList.first();
         QPointF lineCenter = firstLine.pointAt(0.5);
         QPointF centerOffset = boundingCenter - lineCenter;
@@ -748,6 +749,9 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
     // can be in varied directions depending on the order of the intesecting sides.
     QList<QLineF> resultLines;
     _adjustLineDirection(intersectLines, resultLines);
+    if (canceled()) {
+        return;
+    }
 
     // Convert from NED to Geo
     QList<QList<QGeoCoordinate>> transects;
@@ -763,13 +767,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         transects.append(transect);
     }
 
-    _adjustTransectsToEntryPointLocation(transects);
+    _adjustTransectsToEntryPointLocation(snapshot.entryPoint, transects);
 
     if (refly) {
-        _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
+        _optimizeTransectsForShortestDistance(rgTransects.last().last().coord, transects);
     }
 
-    if (_flyAlternateTransectsFact.rawValue().toBool()) {
+    if (snapshot.flyAlternateTransects) {
         QList<QList<QGeoCoordinate>> alternatingTransects;
         for (int i=0; i<transects.count(); i++) {
             if (!(i & 1)) {
@@ -802,8 +806,12 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         transects[i] = transectVertices;
     }
 
-    // Convert to CoordInfo transects and append to _transects
+    // Convert to CoordInfo transects and append to rgTransects
     for (const QList<QGeoCoordinate>& transect : transects) {
+        if (canceled()) {
+            return;
+        }
+
         QGeoCoordinate                                  coord;
         QList<TransectStyleComplexItem::CoordInfo_t>    coordInfoTransect;
         TransectStyleComplexItem::CoordInfo_t           coordInfo;
@@ -814,14 +822,14 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         coordInfoTransect.append(coordInfo);
 
         // For hover and capture we need points for each camera location within the transect
-        if (triggerCamera() && hoverAndCaptureEnabled()) {
+        if (snapshot.hoverAndCapture) {
             double transectLength = transect[0].distanceTo(transect[1]);
             double transectAzimuth = transect[0].azimuthTo(transect[1]);
-            if (triggerDistance() < transectLength) {
-                int cInnerHoverPoints = static_cast<int>(floor(transectLength / triggerDistance()));
+            if (snapshot.triggerDistance < transectLength) {
+                int cInnerHoverPoints = static_cast<int>(floor(transectLength / snapshot.triggerDistance));
                 qCDebug(SurveyComplexItemLog) << "cInnerHoverPoints" << cInnerHoverPoints;
                 for (int i=0; i<cInnerHoverPoints; i++) {
-                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(triggerDistance() * (i + 1), transectAzimuth);
+                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(snapshot.triggerDistance * (i + 1), transectAzimuth);
                     TransectStyleComplexItem::CoordInfo_t coordInfo = { hoverCoord, CoordTypeInteriorHoverTrigger };
                     coordInfoTransect.insert(1 + i, coordInfo);
                 }
@@ -829,9 +837,9 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         }
 
         // Extend the transect ends for turnaround
-        if (_hasTurnaround()) {
+        if (snapshot.turnaroundDistance > 0) {
             QGeoCoordinate turnaroundCoord;
-            double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+            double turnAroundDistance = snapshot.turnaroundDistance;
 
             double azimuth = transect[0].azimuthTo(transect[1]);
             turnaroundCoord = transect[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -846,13 +854,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
             coordInfoTransect.append(coordInfo);
         }
 
-        _transects.append(coordInfoTransect);
+        rgTransects.append(coordInfoTransect);
     }
 }
 
 #if 0
-    // Splitting polygons is not supported since this code would get stuck in a infinite loop
-    // Code is left here in case someone wants to try to resurrect it
+    // Splitting polygons is not supported. The transects of the pieces are not yet joined up
+    // sensibly, code is left here in case someone wants to try to resurrect it.
 
 void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
 {
@@ -898,7 +906,7 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
 
     // Create list of separate polygons
     QList<QPolygonF> polygons{};
-    _PolygonDecomposeConvex(polygon, polygons);
+    SurveyGeometry::decomposeConvex(polygon, polygons);
 
     // iterate over polygons
     for (auto p = polygons.begin(); p != polygons.end(); ++p) {
@@ -919,162 +927,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
         }
 
 
-        // close polygon
-        *p << p->front();
-        // build transects for this polygon
+        // build transects for this polygon, pieces come back closed
         // TODO figure out tangent origin
         // TODO improve selection of entry points
 //        qCDebug(SurveyComplexItemLog) << "Transects from polynom p " << p;
         _rebuildTransectsFromPolygon(refly, *p, tangentOrigin, vMatch);
     }
 }
-
-void SurveyComplexItem::_PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons)
-{
-	// this follows "Mark Keil's Algorithm" https://mpen.ca/406/keil
-    int decompSize = std::numeric_limits<int>::max();
-    if (polygon.size() < 3) return;
-    if (polygon.size() == 3) {
-        decomposedPolygons << polygon;
-        return;
-    }
-
-    QList<QPolygonF> decomposedPolygonsMin{};
-
-    for (auto vertex = polygon.begin(); vertex != polygon.end(); ++vertex)
-    {
-        // is vertex reflex?
-        bool vertexIsReflex = _VertexIsReflex(polygon, vertex);
-
-        if (!vertexIsReflex) continue;
-
-        for (auto vertexOther = polygon.begin(); vertexOther != polygon.end(); ++vertexOther)
-        {
-            auto vertexBefore = vertex == polygon.begin() ? polygon.end() - 1 : vertex - 1;
-            auto vertexAfter = vertex == polygon.end() - 1 ? polygon.begin() : vertex + 1;
-            if (vertexOther == vertex) continue;
-            if (vertexAfter == vertexOther) continue;
-            if (vertexBefore == vertexOther) continue;
-            bool canSee = _VertexCanSeeOther(polygon, vertex, vertexOther);
-            if (!canSee) continue;
-
-            QPolygonF polyLeft;
-            auto v = vertex;
-            auto polyLeftContainsReflex = false;
-            while ( v != vertexOther) {
-                if (v != vertex && _VertexIsReflex(polygon, v)) {
-                    polyLeftContainsReflex = true;
-                }
-                polyLeft << *v;
-                ++v;
-                if (v == polygon.end()) v = polygon.begin();
-            }
-            polyLeft << *vertexOther;
-            auto polyLeftValid = !(polyLeftContainsReflex && polyLeft.size() == 3);
-
-            QPolygonF polyRight;
-            v = vertexOther;
-            auto polyRightContainsReflex = false;
-            while ( v != vertex) {
-                if (v != vertex && _VertexIsReflex(polygon, v)) {
-                    polyRightContainsReflex = true;
-                }
-                polyRight << *v;
-                ++v;
-                if (v == polygon.end()) v = polygon.begin();
-            }
-            polyRight << *vertex;
-            auto polyRightValid = !(polyRightContainsReflex && polyRight.size() == 3);
-
-            if (!polyLeftValid || ! polyRightValid) {
-//                decompSize = std::numeric_limits<int>::max();
-                continue;
-            }
-
-            // recursion
-            QList<QPolygonF> polyLeftDecomposed{};
-            _PolygonDecomposeConvex(polyLeft, polyLeftDecomposed);
-
-            QList<QPolygonF> polyRightDecomposed{};
-            _PolygonDecomposeConvex(polyRight, polyRightDecomposed);
-
-            // compositon
-            auto subSize = polyLeftDecomposed.size() + polyRightDecomposed.size();
-            if ((polyLeftContainsReflex && polyLeftDecomposed.size() == 1)
-                    || (polyRightContainsReflex && polyRightDecomposed.size() == 1))
-            {
-                // don't accept polygons that contian reflex vertices and were not split
-                subSize = std::numeric_limits<int>::max();
-            }
-            if (subSize < decompSize) {
-                decompSize = subSize;
-                decomposedPolygonsMin = polyLeftDecomposed + polyRightDecomposed;
-            }
-        }
-
-    }
-
-    // assemble output
-    if (decomposedPolygonsMin.size() > 0) {
-        decomposedPolygons << decomposedPolygonsMin;
-    } else {
-        decomposedPolygons << polygon;
-    }
-
-    return;
-}
-
-bool SurveyComplexItem::_VertexCanSeeOther(const QPolygonF& polygon, const QPointF* vertexA, const QPointF* vertexB) {
-    if (vertexA == vertexB) return false;
-    auto vertexAAfter = vertexA + 1 == polygon.end() ? polygon.begin() : vertexA + 1;
-    auto vertexABefore = vertexA == polygon.begin() ? polygon.end() - 1 : vertexA - 1;
-    if (vertexAAfter == vertexB) return false;
-    if (vertexABefore == vertexB) return false;
-//    qCDebug(SurveyComplexItemLog) << "_VertexCanSeeOther false after first checks ";
-
-    bool visible = true;
-//    auto diff = *vertexA - *vertexB;
-    QLineF lineAB{*vertexA, *vertexB};
-    auto distanceAB = lineAB.length();//sqrtf(diff.x() * diff.x() + diff.y()*diff.y());
-
-//    qCDebug(SurveyComplexItemLog) << "_VertexCanSeeOther distanceAB " << distanceAB;
-    for (auto vertexC = polygon.begin(); vertexC != polygon.end(); ++vertexC)
-    {
-        if (vertexC == vertexA) continue;
-        if (vertexC == vertexB) continue;
-        auto vertexD = vertexC + 1 == polygon.end() ? polygon.begin() : vertexC + 1;
-        if (vertexD == vertexA) continue;
-        if (vertexD == vertexB) continue;
-        QLineF lineCD(*vertexC, *vertexD);
-        QPointF intersection{};
-
-        auto intersects = lineAB.intersects(lineCD, &intersection);
-        if (intersects == QLineF::IntersectType::BoundedIntersection) {
-//            auto diffIntersection = *vertexA - intersection;
-//            auto distanceIntersection = sqrtf(diffIntersection.x() * diffIntersection.x() + diffIntersection.y()*diffIntersection.y());
-//            qCDebug(SurveyComplexItemLog) << "*vertexA " << *vertexA << "*vertexB " << *vertexB  << " intersection " << intersection;
-
-            QLineF lineIntersection{*vertexA, intersection};
-            auto distanceIntersection = lineIntersection.length();//sqrtf(diff.x() * diff.x() + diff.y()*diff.y());
-            qCDebug(SurveyComplexItemLog) << "_VertexCanSeeOther distanceIntersection " << distanceIntersection;
-            if (distanceIntersection < distanceAB) {
-                visible = false;
-                break;
-            }
-        }
-
-    }
-
-    return visible;
-}
-
-bool SurveyComplexItem::_VertexIsReflex(const QPolygonF& polygon, QList<QPointF>::const_iterator& vertexIter) {
-    auto vertexBefore = vertex == polygon.begin() ? polygon.end() - 1 : vertex - 1;
-    auto vertexAfter = vertex == polygon.end() - 1 ? polygon.begin() : vertex + 1;
-    auto area = (((vertex->x() - vertexBefore->x())*(vertexAfter->y() - vertexBefore->y()))-((vertexAfter->x() - vertexBefore->x())*(vertex->y() - vertexBefore->y())));
-    return area > 0;
-
-}
 #endif
 
 void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF& polygon, const QGeoCoordinate& tangentOrigin, const QPointF* const transitionPoint)
@@ -1170,7 +1029,7 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         transects.append(transect);
     }
 
-    _adjustTransectsToEntryPointLocation(transects);
+    _adjustTransectsToEntryPointLocation(_entryPoint, transects);
 
     if (refly) {
         _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
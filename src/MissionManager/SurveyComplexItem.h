@@ -90,7 +90,6 @@ private slots:
     void _updateWizardMode              (void);
 
     // Overrides from TransectStyleComplexItem
-    void _rebuildTransectsPhase1        (void) final;
     void _recalcCameraShots             (void) final;
 
 private:
@@ -101,21 +100,40 @@ private:
         CameraTriggerHoverAndCapture
     };
 
-    QPointF _rotatePoint(const QPointF& point, const QPointF& origin, double angle);
+    /// Everything the transects are built from, copied so the build can run on a worker thread
+    typedef struct {
+        QList<QGeoCoordinate>   polygon;
+        double                  gridAngle;
+        double                  gridSpacing;
+        int                     entryPoint;
+        bool                    flyAlternateTransects;
+        bool                    refly90Degrees;
+        bool                    hoverAndCapture;        ///< Camera is triggering and hover and capture is enabled
+        double                  triggerDistance;
+        double                  turnaroundDistance;     ///< 0 for no turnaround
+    } TransectSnapshot_t;
+
+    // Overrides from TransectStyleComplexItem
+    TransectJob_t _transectJob(void) final;
+
+    static QList<QList<CoordInfo_t>> _buildTransects(const TransectSnapshot_t& snapshot, const TransectCanceled_t& canceled);
+    static void _buildTransectsSinglePolygon(const TransectSnapshot_t& snapshot, bool refly, const TransectCanceled_t& canceled, QList<QList<CoordInfo_t>>& rgTransects);
+
+    static QPointF _rotatePoint(const QPointF& point, const QPointF& origin, double angle);
     void _intersectLinesWithRect(const QList<QLineF>& lineList, const QRectF& boundRect, QList<QLineF>& resultLines);
-    void _intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines);
-    void _adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines);
+    static void _intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines);
+    static void _adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines);
     bool _nextTransectCoord(const QList<QGeoCoordinate>& transectPoints, int pointIndex, QGeoCoordinate& coord);
     bool _appendMissionItemsWorker(QList<MissionItem*>& items, QObject* missionItemParent, int& seqNum, bool hasRefly, bool buildRefly);
-    void _optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, QList<QList<QGeoCoordinate>>& transects);
+    static void _optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, QList<QList<QGeoCoordinate>>& transects);
     qreal _ccw(QPointF pt1, QPointF pt2, QPointF pt3);
     qreal _dp(QPointF pt1, QPointF pt2);
     void _swapPoints(QList<QPointF>& points, int index1, int index2);
-    void _reverseTransectOrder(QList<QList<QGeoCoordinate>>& transects);
-    void _reverseInternalTransectPoints(QList<QList<QGeoCoordinate>>& transects);
-    void _adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects);
+    static void _reverseTransectOrder(QList<QList<QGeoCoordinate>>& transects);
+    static void _reverseInternalTransectPoints(QList<QList<QGeoCoordinate>>& transects);
+    static void _adjustTransectsToEntryPointLocation(int entryPoint, QList<QList<QGeoCoordinate>>& transects);
     bool _gridAngleIsNorthSouthTransects();
-    double _clampGridAngle90(double gridAngle);
+    static double _clampGridAngle90(double gridAngle);
     bool _imagesEverywhere(void) const;
     bool _triggerCamera(void) const;
     bool _hasTurnaround(void) const;
@@ -124,22 +142,14 @@ private:
     bool _loadV3(const QJsonObject& complexObject, int sequenceNumber, QString& errorString);
     bool _loadV4V5(const QJsonObject& complexObject, int sequenceNumber, QString& errorString, int version, bool forPresets);
     void _saveCommon(QJsonObject& complexObject);
-    void _rebuildTransectsPhase1Worker(bool refly);
-    void _rebuildTransectsPhase1WorkerSinglePolygon(bool refly);
     /// Adds to the _transects array from one polygon
     void _rebuildTransectsFromPolygon(bool refly, const QPolygonF& polygon, const QGeoCoordinate& tangentOrigin, const QPointF* const transitionPoint);
 
 #if 0
-    // Splitting polygons is not supported since this code would get stuck in a infinite loop
-    // Code is left here in case someone wants to try to resurrect it
+    // Splitting polygons is not supported. The transects of the pieces are not yet joined up
+    // sensibly, code is left here in case someone wants to try to resurrect it.
 
     void _rebuildTransectsPhase1WorkerSplitPolygons(bool refly);
-
-    // Decompose polygon into list of convex sub polygons
-    void _PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons);
-    // return true if vertex a can see vertex b
-    bool _VertexCanSeeOther(const QPolygonF& polygon, const QPointF* vertexA, const QPointF* vertexB);
-    bool _VertexIsReflex(const QPolygonF& polygon, QList<QPointF>::const_iterator& vertexIter);
 #endif
 
     QMap<QString, FactMetaData*> _metaDataMap;
@@ -0,0 +1,548 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SurveyGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/// Extent of a line or polygon edge across the sweep direction
+struct SweepEntry {
+    double  sMin;
+    double  sMax;
+    int     index;
+};
+
+struct Crossing {
+    int     edge;
+    double  t;          ///< Position along the line
+    QPointF point;
+};
+
+/// @return Twice the signed area of triangle abc, positive when abc turns left
+double _cross(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    return ((bx - ax) * (cy - ay)) - ((by - ay) * (cx - ax));
+}
+
+double _cross(const QPointF& a, const QPointF& b, const QPointF& c)
+{
+    return _cross(a.x(), a.y(), b.x(), b.y(), c.x(), c.y());
+}
+
+/// Vertex of the ring being triangulated
+struct EarNode {
+    int         vertex  = 0;        ///< Index into the vertex list
+    double      x       = 0;
+    double      y       = 0;
+    uint32_t    z       = 0;        ///< z-order of the position
+    EarNode*    prev    = nullptr;
+    EarNode*    next    = nullptr;
+    EarNode*    prevZ   = nullptr;  ///< Neighbours in z-order
+    EarNode*    nextZ   = nullptr;
+};
+
+/// Ear clipping triangulation of a counter-clockwise ring. Past a handful of vertices, the vertices
+/// which could fall inside an ear are found through a z-order index instead of walking the ring.
+class EarClipper
+{
+public:
+    explicit EarClipper(const std::vector<QPointF>& points)
+        : _nodes(points.size())
+    {
+        const int count = static_cast<int>(points.size());
+        for (int i=0; i<count; i++) {
+            EarNode& node = _nodes[i];
+            node.vertex = i;
+            node.x = points[i].x();
+            node.y = points[i].y();
+            node.prev = &_nodes[(i + count - 1) % count];
+            node.next = &_nodes[(i + 1) % count];
+        }
+        if (count > _zIndexMinVertices) {
+            _buildZIndex();
+        }
+    }
+
+    /// @param triangles[out] Vertex indices, three per counter-clockwise triangle
+    void triangulate(std::vector<int>& triangles)
+    {
+        if (_nodes.size() < 3) {
+            return;
+        }
+
+        EarNode* ear = &_nodes[0];
+        EarNode* stop = ear;
+        bool filtered = false;
+
+        while (ear->prev != ear->next) {
+            EarNode* const next = ear->next;
+
+            if (_isEar(ear)) {
+                _clip(ear, triangles);
+                // Continuing two vertices on avoids fans of sliver triangles
+                ear = next->next;
+                stop = ear;
+                filtered = false;
+                continue;
+            }
+
+            ear = next;
+            if (ear == stop) {
+                // A full trip around the ring without an ear
+                if (!filtered) {
+                    // Flat or repeated vertices can block every ear
+                    ear = _filter(ear);
+                    filtered = true;
+                } else {
+                    // The ring isn't simple, clip anyway so the triangulation always finishes
+                    EarNode* const forcedNext = ear->next;
+                    _clip(ear, triangles);
+                    ear = forcedNext;
+                }
+                stop = ear;
+            }
+        }
+    }
+
+private:
+    void _clip(EarNode* ear, std::vector<int>& triangles)
+    {
+        triangles.push_back(ear->prev->vertex);
+        triangles.push_back(ear->vertex);
+        triangles.push_back(ear->next->vertex);
+        _remove(ear);
+    }
+
+    void _remove(EarNode* node)
+    {
+        node->next->prev = node->prev;
+        node->prev->next = node->next;
+        if (node->prevZ) {
+            node->prevZ->nextZ = node->nextZ;
+        }
+        if (node->nextZ) {
+            node->nextZ->prevZ = node->prevZ;
+        }
+    }
+
+    /// Removes repeated and flat vertices
+    ///     @return A vertex still in the ring
+    EarNode* _filter(EarNode* start)
+    {
+        EarNode* node = start;
+        EarNode* end = start;
+        bool again;
+        do {
+            again = false;
+            const bool repeated = (node->x == node->next->x) && (node->y == node->next->y);
+            if ((node->prev != node->next) && (repeated || (_cross(node->prev->x, node->prev->y, node->x, node->y, node->next->x, node->next->y) == 0))) {
+                EarNode* const prev = node->prev;
+                _remove(node);
+                node = end = prev;
+                again = true;
+            } else {
+                node = node->next;
+            }
+        } while (again || (node != end));
+
+        return end;
+    }
+
+    static bool _inTriangle(const EarNode* a, const EarNode* b, const EarNode* c, const EarNode* p)
+    {
+        return (_cross(a->x, a->y, b->x, b->y, p->x, p->y) >= 0) &&
+               (_cross(b->x, b->y, c->x, c->y, p->x, p->y) >= 0) &&
+               (_cross(c->x, c->y, a->x, a->y, p->x, p->y) >= 0);
+    }
+
+    static bool _isReflex(const EarNode* p)
+    {
+        return _cross(p->prev->x, p->prev->y, p->x, p->y, p->next->x, p->next->y) <= 0;
+    }
+
+    /// Only reflex vertices need checking, if any vertex is inside the ear one of them is as well
+    static bool _blocksEar(const EarNode* a, const EarNode* b, const EarNode* c, const EarNode* p)
+    {
+        return (p != a) && (p != b) && (p != c) && _isReflex(p) && _inTriangle(a, b, c, p);
+    }
+
+    bool _isEar(const EarNode* ear) const
+    {
+        const EarNode* a = ear->prev;
+        const EarNode* b = ear;
+        const EarNode* c = ear->next;
+
+        if (_cross(a->x, a->y, b->x, b->y, c->x, c->y) <= 0) {
+            return false;
+        }
+
+        if (!_zIndexed) {
+            for (const EarNode* p = c->next; p != a; p = p->next) {
+                if (_blocksEar(a, b, c, p)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Everything inside the bounding box of the ear lies between the z-order of its corners
+        const uint32_t minZ = _zOrder(std::min({ a->x, b->x, c->x }), std::min({ a->y, b->y, c->y }));
+        const uint32_t maxZ = _zOrder(std::max({ a->x, b->x, c->x }), std::max({ a->y, b->y, c->y }));
+
+        for (const EarNode* p = ear->nextZ; p && (p->z <= maxZ); p = p->nextZ) {
+            if (_blocksEar(a, b, c, p)) {
+                return false;
+            }
+        }
+        for (const EarNode* p = ear->prevZ; p && (p->z >= minZ); p = p->prevZ) {
+            if (_blocksEar(a, b, c, p)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void _buildZIndex()
+    {
+        double maxX = _nodes[0].x;
+        double maxY = _nodes[0].y;
+        _minX = maxX;
+        _minY = maxY;
+        for (const EarNode& node : _nodes) {
+            _minX = std::min(_minX, node.x);
+            _minY = std::min(_minY, node.y);
+            maxX = std::max(maxX, node.x);
+            maxY = std::max(maxY, node.y);
+        }
+        const double size = std::max(maxX - _minX, maxY - _minY);
+        _zScale = (size > 0) ? (32767.0 / size) : 0;
+
+        std::vector<EarNode*> sorted;
+        sorted.reserve(_nodes.size());
+        for (EarNode& node : _nodes) {
+            node.z = _zOrder(node.x, node.y);
+            sorted.push_back(&node);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const EarNode* a, const EarNode* b) {
+            return a->z < b->z;
+        });
+        for (size_t i=1; i<sorted.size(); i++) {
+            sorted[i - 1]->nextZ = sorted[i];
+            sorted[i]->prevZ = sorted[i - 1];
+        }
+
+        _zIndexed = true;
+    }
+
+    /// Interleaves the bits of the position on a 32767 x 32767 grid over the ring
+    uint32_t _zOrder(double x, double y) const
+    {
+        uint32_t ix = static_cast<uint32_t>((x - _minX) * _zScale);
+        uint32_t iy = static_cast<uint32_t>((y - _minY) * _zScale);
+
+        ix = (ix | (ix << 8)) & 0x00FF00FF;
+        ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+        ix = (ix | (ix << 2)) & 0x33333333;
+        ix = (ix | (ix << 1)) & 0x55555555;
+
+        iy = (iy | (iy << 8)) & 0x00FF00FF;
+        iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+        iy = (iy | (iy << 2)) & 0x33333333;
+        iy = (iy | (iy << 1)) & 0x55555555;
+
+        return ix | (iy << 1);
+    }
+
+    static constexpr int _zIndexMinVertices = 80;
+
+    std::vector<EarNode>    _nodes;
+    bool                    _zIndexed   = false;
+    double                  _minX       = 0;
+    double                  _minY       = 0;
+    double                  _zScale     = 0;
+};
+
+/// @return Vertices of the polygon without repeats or the closing vertex, counter-clockwise
+std::vector<QPointF> _counterClockwiseRing(const QPolygonF& polygon)
+{
+    std::vector<QPointF> points;
+    points.reserve(polygon.count());
+    for (const QPointF& point : polygon) {
+        if (points.empty() || (points.back() != point)) {
+            points.push_back(point);
+        }
+    }
+    while ((points.size() > 1) && (points.back() == points.front())) {
+        points.pop_back();
+    }
+
+    double area2 = 0;
+    for (size_t i=0; i<points.size(); i++) {
+        const QPointF& a = points[i];
+        const QPointF& b = points[(i + 1) % points.size()];
+        area2 += (a.x() * b.y()) - (b.x() * a.y());
+    }
+    if (area2 < 0) {
+        std::reverse(points.begin(), points.end());
+    }
+
+    return points;
+}
+
+int _findPiece(std::vector<int>& pieces, int piece)
+{
+    while (pieces[piece] != piece) {
+        pieces[piece] = pieces[pieces[piece]];
+        piece = pieces[piece];
+    }
+    return piece;
+}
+
+} // namespace
+
+namespace SurveyGeometry {
+
+void clipParallelLines(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines)
+{
+    resultLines.clear();
+
+    const int vertexCount = polygon.count();
+    if (lineList.isEmpty() || (vertexCount < 2)) {
+        return;
+    }
+
+    // Sweep across the lines along the normal of the first one, t runs along the lines
+    const QLineF& firstLine = lineList.first();
+    const double length = firstLine.length();
+    if (length == 0) {
+        return;
+    }
+    const double alongX = firstLine.dx() / length;
+    const double alongY = firstLine.dy() / length;
+    const auto across = [alongX, alongY](const QPointF& point) {
+        return (point.y() * alongX) - (point.x() * alongY);
+    };
+
+    const bool closed = polygon.first() == polygon.last();
+    const int edgeCount = closed ? (vertexCount - 1) : vertexCount;
+
+    std::vector<SweepEntry> edges;
+    edges.reserve(edgeCount);
+    double extent = 1;
+    for (int i=0; i<edgeCount; i++) {
+        const double s1 = across(polygon[i]);
+        const double s2 = across(polygon[(i + 1) % vertexCount]);
+        edges.push_back({ std::min(s1, s2), std::max(s1, s2), i });
+        extent = std::max({ extent, std::abs(s1), std::abs(s2) });
+    }
+
+    // The exact crossing test is left to QLineF::intersects, the sweep only has to never miss an
+    // edge. A little slack covers lines which are not perfectly parallel after rotation.
+    const double tolerance = extent * 1e-9;
+
+    std::vector<SweepEntry> lines;
+    lines.reserve(lineList.count());
+    for (int i=0; i<lineList.count(); i++) {
+        const double s1 = across(lineList[i].p1());
+        const double s2 = across(lineList[i].p2());
+        lines.push_back({ std::min(s1, s2) - tolerance, std::max(s1, s2) + tolerance, i });
+    }
+
+    const auto bySMin = [](const SweepEntry& a, const SweepEntry& b) {
+        return a.sMin < b.sMin;
+    };
+    std::sort(edges.begin(), edges.end(), bySMin);
+    std::sort(lines.begin(), lines.end(), bySMin);
+
+    std::vector<QLineF> clippedLines(lineList.count());
+    std::vector<bool> clipped(lineList.count(), false);
+    std::vector<int> activeEdges;
+    std::vector<Crossing> crossings;
+    size_t nextEdge = 0;
+
+    for (const SweepEntry& sweepLine : lines) {
+        while ((nextEdge < edges.size()) && (edges[nextEdge].sMin <= sweepLine.sMax)) {
+            activeEdges.push_back(static_cast<int>(nextEdge++));
+        }
+
+        const QLineF& line = lineList[sweepLine.index];
+        crossings.clear();
+        for (size_t i=0; i<activeEdges.size(); ) {
+            const SweepEntry& edge = edges[activeEdges[i]];
+            if (edge.sMax < sweepLine.sMin) {
+                // Lines are visited in order across, no later line can reach this edge
+                activeEdges[i] = activeEdges.back();
+                activeEdges.pop_back();
+                continue;
+            }
+
+            QPointF point;
+            const QLineF polygonLine(polygon[edge.index], polygon[(edge.index + 1) % vertexCount]);
+            if (line.intersects(polygonLine, &point) == QLineF::BoundedIntersection) {
+                crossings.push_back({ edge.index, (point.x() * alongX) + (point.y() * alongY), point });
+            }
+            i++;
+        }
+
+        if (crossings.size() < 2) {
+            continue;
+        }
+
+        // The two crossings furthest apart are the ones furthest along each way. Ties go to the
+        // first edge, which is the crossing kept when the same point is hit through two edges.
+        std::sort(crossings.begin(), crossings.end(), [](const Crossing& a, const Crossing& b) {
+            return a.edge < b.edge;
+        });
+        size_t first = 0;
+        size_t last = 0;
+        for (size_t i=1; i<crossings.size(); i++) {
+            if (crossings[i].t < crossings[first].t) {
+                first = i;
+            }
+            if (crossings[i].t > crossings[last].t) {
+                last = i;
+            }
+        }
+        if (crossings[first].point == crossings[last].point) {
+            // Only touches the polygon at a single point
+            continue;
+        }
+
+        const QPointF& startPoint = crossings[std::min(first, last)].point;
+        const QPointF& endPoint = crossings[std::max(first, last)].point;
+        clippedLines[sweepLine.index] = QLineF(startPoint, endPoint);
+        clipped[sweepLine.index] = true;
+    }
+
+    for (int i=0; i<lineList.count(); i++) {
+        if (clipped[i]) {
+            resultLines.append(clippedLines[i]);
+        }
+    }
+}
+
+void decomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& convexPolygons)
+{
+    convexPolygons.clear();
+
+    const std::vector<QPointF> points = _counterClockwiseRing(polygon);
+    if (points.size() < 3) {
+        return;
+    }
+
+    std::vector<int> triangles;
+    triangles.reserve((points.size() - 2) * 3);
+    EarClipper(points).triangulate(triangles);
+
+    // Half edges of the triangles, edge e starts at vertex triangles[e]
+    const int edgeCount = static_cast<int>(triangles.size());
+    std::vector<int> next(edgeCount);
+    std::vector<int> prev(edgeCount);
+    std::vector<int> twin(edgeCount, -1);
+    std::unordered_map<uint64_t, int> edgeLookup;
+    edgeLookup.reserve(edgeCount);
+
+    const auto edgeKey = [](int from, int to) {
+        return (static_cast<uint64_t>(from) << 32) | static_cast<uint32_t>(to);
+    };
+
+    for (int e=0; e<edgeCount; e++) {
+        const int triangle = e - (e % 3);
+        next[e] = triangle + (((e % 3) + 1) % 3);
+        prev[e] = triangle + (((e % 3) + 2) % 3);
+    }
+    for (int e=0; e<edgeCount; e++) {
+        const int from = triangles[e];
+        const int to = triangles[next[e]];
+        const auto other = edgeLookup.find(edgeKey(to, from));
+        if ((other != edgeLookup.end()) && (twin[other->second] == -1)) {
+            twin[e] = other->second;
+            twin[other->second] = e;
+        } else {
+            (void) edgeLookup.emplace(edgeKey(from, to), e);
+        }
+    }
+
+    // Hertel-Mehlhorn: drop each diagonal which leaves the merged piece convex at both its ends
+    std::vector<int> pieces(edgeCount / 3);
+    std::iota(pieces.begin(), pieces.end(), 0);
+    std::vector<bool> removed(edgeCount, false);
+
+    for (int h=0; h<edgeCount; h++) {
+        const int t = twin[h];
+        if (t < h) {
+            // Polygon edge, or a diagonal already looked at from the other side
+            continue;
+        }
+        const int pieceH = _findPiece(pieces, h / 3);
+        const int pieceT = _findPiece(pieces, t / 3);
+        if (pieceH == pieceT) {
+            continue;
+        }
+
+        // Without the diagonal u-v the piece enters u along prev[h] and leaves along next[t],
+        // and enters v along prev[t] and leaves along next[h].
+        const QPointF& u = points[triangles[h]];
+        const QPointF& v = points[triangles[t]];
+        const QPointF& beforeU = points[triangles[prev[h]]];
+        const QPointF& afterU = points[triangles[next[next[t]]]];
+        const QPointF& beforeV = points[triangles[prev[t]]];
+        const QPointF& afterV = points[triangles[next[next[h]]]];
+        if ((_cross(beforeU, u, afterU) < 0) || (_cross(beforeV, v, afterV) < 0)) {
+            continue;
+        }
+
+        next[prev[h]] = next[t];
+        prev[next[t]] = prev[h];
+        next[prev[t]] = next[h];
+        prev[next[h]] = prev[t];
+        removed[h] = true;
+        removed[t] = true;
+        pieces[pieceT] = pieceH;
+    }
+
+    std::vector<bool> visited(edgeCount, false);
+    for (int e=0; e<edgeCount; e++) {
+        if (removed[e] || visited[e]) {
+            continue;
+        }
+
+        QPolygonF piece;
+        int walk = e;
+        do {
+            visited[walk] = true;
+            piece << points[triangles[walk]];
+            walk = next[walk];
+        } while (walk != e);
+        piece << piece.first();
+
+        convexPolygons.append(piece);
+    }
+}
+
+double signedArea2(const QPolygonF& polygon)
+{
+    double area2 = 0;
+    const int count = polygon.count();
+    for (int i=0; i<count; i++) {
+        const QPointF& a = polygon[i];
+        const QPointF& b = polygon[(i + 1) % count];
+        area2 += (a.x() * b.y()) - (b.x() * a.y());
+    }
+    return area2;
+}
+
+} // namespace SurveyGeometry
@@ -0,0 +1,42 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QLineF>
+#include <QtCore/QList>
+#include <QtGui/QPolygonF>
+
+/// Planar polygon routines used to lay out survey transects. They work on NED points in meters, are
+/// thread safe and scale to imported boundaries with many thousands of vertices.
+namespace SurveyGeometry {
+
+/// Clips parallel lines to a polygon with a scanline sweep. Polygon edges are sorted into an edge
+/// table by their extent across the lines, so each line is only tested against the edges it can
+/// cross instead of against all of them.
+///     @param lineList Parallel lines, such as the transects of a survey grid
+///     @param polygon Polygon to clip to, the closing edge is added if the first vertex isn't repeated
+///     @param resultLines[out] For each line which crosses the polygon, the segment between the two
+///                             crossings furthest apart, in the order of lineList. The segment starts
+///                             at the crossing of the polygon edge which comes first.
+void clipParallelLines(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines);
+
+/// Splits a simple polygon into convex polygons. The polygon is triangulated by ear clipping, with
+/// the ear tests looked up through a z-order index, then triangles are merged back together across
+/// every diagonal which leaves both ends convex (Hertel-Mehlhorn). The result has at most four
+/// times the minimum number of pieces.
+///     @param polygon Polygon to split, may be open or closed, in either winding
+///     @param convexPolygons[out] Closed counter-clockwise convex polygons. Self-intersecting input
+///                                gives overlapping pieces.
+void decomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& convexPolygons);
+
+/// @return Twice the signed area of a polygon, positive for counter-clockwise winding
+double signedArea2(const QPolygonF& polygon);
+
+} // namespace SurveyGeometry
@@ -20,7 +20,10 @@
 #include "KMLPlanDomDocument.h"
 #include "Vehicle.h"
 #include "QGCLoggingCategory.h"
+#include "TerrainTileManager.h"
 
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QJsonArray>
 
 QGC_LOGGING_CATEGORY(TransectStyleComplexItemLog, "TransectStyleComplexItemLog")
@@ -106,6 +109,12 @@ TransectStyleComplexItem::TransectStyleComplexItem(PlanMasterController* masterC
     setDirty(false);
 }
 
+TransectStyleComplexItem::~TransectStyleComplexItem()
+{
+    // A running build only uses what it captured, it is left to finish on its own
+    _cancelTransectJob();
+}
+
 void TransectStyleComplexItem::_setCameraShots(int cameraShots)
 {
     if (_cameraShots != cameraShots) {
@@ -128,6 +137,9 @@ void TransectStyleComplexItem::setDirty(bool dirty)
 
 void TransectStyleComplexItem::_save(QJsonObject& complexObject)
 {
+    // Camera shots, transect points and mission items must all come from the latest geometry
+    waitForTransects();
+
     QJsonObject innerObject;
 
     innerObject[JsonHelper::jsonVersionKey] =       2;
@@ -232,6 +244,9 @@ bool TransectStyleComplexItem::_load(const QJsonObject& complexObject, bool forP
     }
 
     if (!forPresets) {
+        // The loaded transects replace anything still being built
+        _cancelTransectJob();
+
         // Load visual transect points
         if (!JsonHelper::loadGeoCoordinateArray(innerObject[_jsonVisualTransectPointsKey], false /* altitudeRequired */, _visualTransectPoints, errorString)) {
             return false;
@@ -389,18 +404,93 @@ void TransectStyleComplexItem::_rebuildTransects(void)
         return;
     }
 
+    // Anything still being built is for geometry which no longer exists
+    _cancelTransectJob();
+
+    const TransectJob_t job = _transectJob();
+    if (job.build && (job.cost >= _backgroundTransectJobCost)) {
+        // The current transects stay up until the new ones are ready
+        _startTransectJob(job);
+        return;
+    }
+
     _transects.clear();
     _rgPathHeightInfo.clear();
     _rgFlightPathCoordInfo.clear();
 
-    _rebuildTransectsPhase1();
+    if (job.build) {
+        _transects = job.build([]() { return false; });
+    } else {
+        _rebuildTransectsPhase1();
+    }
+
+    _publishTransects();
+}
+
+void TransectStyleComplexItem::_startTransectJob(const TransectJob_t& job)
+{
+    const quint64 generation = _transectJobGeneration;
+    const auto build = job.build;
+
+    qCDebug(TransectStyleComplexItemLog) << "_startTransectJob generation:cost" << generation << job.cost;
+
+    _transectJobFuture = QtConcurrent::run([build](QPromise<QList<QList<CoordInfo_t>>>& promise) {
+        QList<QList<CoordInfo_t>> transects = build([&promise]() { return promise.isCanceled(); });
+        if (!promise.isCanceled()) {
+            promise.addResult(transects);
+        }
+    });
+
+    auto watcher = new QFutureWatcher<QList<QList<CoordInfo_t>>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        _transectJobFinished(generation);
+    });
+    watcher->setFuture(_transectJobFuture);
+}
+
+void TransectStyleComplexItem::_cancelTransectJob(void)
+{
+    _transectJobGeneration++;
+    _transectJobFuture.cancel();
+    _transectJobFuture = QFuture<QList<QList<CoordInfo_t>>>();
+}
 
+void TransectStyleComplexItem::_transectJobFinished(quint64 generation)
+{
+    if (generation != _transectJobGeneration) {
+        // Superseded by newer geometry
+        qCDebug(TransectStyleComplexItemLog) << "_transectJobFinished dropping stale generation" << generation;
+        return;
+    }
+    if (_transectJobFuture.resultCount() == 0) {
+        // Already published by waitForTransects
+        return;
+    }
+
+    _transects = _transectJobFuture.result();
+    _transectJobFuture = QFuture<QList<QList<CoordInfo_t>>>();
+    _rgPathHeightInfo.clear();
+    _rgFlightPathCoordInfo.clear();
+
+    _publishTransects();
+}
+
+void TransectStyleComplexItem::waitForTransects(void)
+{
+    _transectJobFuture.waitForFinished();
+    _transectJobFinished(_transectJobGeneration);
+}
+
+/// Updates everything which is derived from _transects
+void TransectStyleComplexItem::_publishTransects(void)
+{
     _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
 
     switch (_cameraCalc.distanceMode()) {
     case QGroundControlQmlGlobal::AltitudeModeMixed:
     case QGroundControlQmlGlobal::AltitudeModeNone:
-        qCWarning(TransectStyleComplexItemLog) << "Internal Error: _rebuildTransects - invalid _cameraCalc.distanceMode()" << _cameraCalc.distanceMode();
+        qCWarning(TransectStyleComplexItemLog) << "Internal Error: _publishTransects - invalid _cameraCalc.distanceMode()" << _cameraCalc.distanceMode();
         return;
     case QGroundControlQmlGlobal::AltitudeModeRelative:
     case QGroundControlQmlGlobal::AltitudeModeAbsolute:
@@ -556,6 +646,23 @@ void TransectStyleComplexItem::_queryTransectsPathHeightInfo(void)
     emit readyForSaveStateChanged();
 
     if (_transects.count()) {
+        // Get the tiles for the whole survey area coming in right away. By the time the query timer
+        // fires the path query can then be answered in one go. Rebuilds which stay within the area
+        // prefetched last time, such as spacing or camera changes, don't prefetch again.
+        if (!qgcApp()->runningUnitTests()) {
+            QList<QGeoCoordinate> transectPoints;
+            for (const QList<CoordInfo_t>& transect: _transects) {
+                for (const CoordInfo_t& coordInfo: transect) {
+                    transectPoints.append(coordInfo.coord);
+                }
+            }
+            const QGeoRectangle bounds(transectPoints);
+            if (!_terrainPrefetchBounds.isValid() || !_terrainPrefetchBounds.contains(bounds)) {
+                _terrainPrefetchBounds = bounds;
+                TerrainTileManager::instance()->prefetchPath(transectPoints);
+            }
+        }
+
         // We don't actually send the query until this timer times out. This way we only send
         // the latest request if we get a bunch in a row.
         _terrainPolyPathQueryTimer.start();
@@ -1110,6 +1217,9 @@ void TransectStyleComplexItem::_handleHoverAndCaptureEnabled(QVariant enabled)
 
 void TransectStyleComplexItem::appendMissionItems(QList<MissionItem*>& items, QObject* missionItemParent)
 {
+    // Mission items are always built from the latest geometry
+    waitForTransects();
+
     if (_loadedMissionItems.count()) {
         // We have mission items from the loaded plan, use those
         _appendLoadedMissionItems(items, missionItemParent);
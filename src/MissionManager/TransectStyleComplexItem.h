@@ -16,7 +16,11 @@
 #include "CameraCalc.h"
 #include "TerrainQuery.h"
 
+#include <QtCore/QFuture>
 #include <QtCore/QLoggingCategory>
+#include <QtPositioning/QGeoRectangle>
+
+#include <functional>
 
 Q_DECLARE_LOGGING_CATEGORY(TransectStyleComplexItemLog)
 
@@ -28,6 +32,7 @@ class TransectStyleComplexItem : public ComplexMissionItem
 
 public:
     TransectStyleComplexItem(PlanMasterController* masterController, bool flyView, QString settignsGroup);
+    ~TransectStyleComplexItem();
 
     Q_PROPERTY(QGCMapPolygon*   surveyAreaPolygon           READ surveyAreaPolygon                                  CONSTANT)
     Q_PROPERTY(CameraCalc*      cameraCalc                  READ cameraCalc                                         CONSTANT)
@@ -72,6 +77,10 @@ public:
 
     // Used internally only by unit tests
     int _transectCount(void) const { return _transects.count(); }
+    bool _transectJobPending(void) const { return _transectJobFuture.isRunning() || (_transectJobFuture.resultCount() > 0); }
+
+    /// Waits for a background transect build and publishes it if it is still current
+    void waitForTransects(void);
 
     // Overrides from ComplexMissionItem
     int     lastSequenceNumber  (void) const final;
@@ -135,7 +144,7 @@ protected slots:
     void _rebuildTransects                  (void);
 
 protected:
-    virtual void _rebuildTransectsPhase1    (void) = 0; ///< Rebuilds the _transects array
+    virtual void _rebuildTransectsPhase1    (void) { }  ///< Rebuilds the _transects array, only used if _transectJob returns no job
     virtual void _recalcCameraShots         (void) = 0;
 
     void    _save                           (QJsonObject& saveObject);
@@ -180,6 +189,22 @@ protected:
     QList<double>                               _rgFlyThroughMissionItemCoordsTerrainHeights;
     QList<CoordInfo_t>                          _rgFlightPathCoordInfo;                         ///< Fully calculated flight path (including terrain if needed)
 
+    /// Returns true once a build has been superseded by newer geometry
+    typedef std::function<bool(void)> TransectCanceled_t;
+
+    /// Transect build which only uses the values it captured, so it can be run on a worker thread
+    typedef struct {
+        std::function<QList<QList<CoordInfo_t>>(const TransectCanceled_t& canceled)> build;
+        qint64 cost;    ///< Rough number of edge tests the build needs, cheap builds are run right away
+    } TransectJob_t;
+
+    /// Snapshots the current geometry into a transect build. Called on the GUI thread every time the
+    /// transects need to be rebuilt. The default returns no job, _rebuildTransectsPhase1 is used instead.
+    virtual TransectJob_t _transectJob(void) { return TransectJob_t{ nullptr, 0 }; }
+
+    /// Builds at or above this cost are run in the background
+    static constexpr qint64 _backgroundTransectJobCost = 20000;
+
     bool            _ignoreRecalc =     false;
     double          _complexDistance =  qQNaN();
     int             _cameraShots =      0;
@@ -239,10 +264,18 @@ private:
     double  _altitudeBetweenCoords                                          (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double percentTowardsTo);
     int     _maxPathHeight                                                  (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo, int fromIndex, int toIndex, double& maxHeight);
     BuildMissionItemsState_t _buildMissionItemsState                        (void) const;
+    void    _startTransectJob                                               (const TransectJob_t& job);
+    void    _cancelTransectJob                                              (void);
+    void    _transectJobFinished                                            (quint64 generation);
+    void    _publishTransects                                               (void);
 
     TerrainPolyPathQuery*       _currentTerrainPolyPathQuery        = nullptr;
     TerrainAtCoordinateQuery*   _currentTerrainAtCoordinateQuery    = nullptr;
     QTimer                      _terrainPolyPathQueryTimer;
+    QGeoRectangle               _terrainPrefetchBounds;             ///< Area covered by the transects the terrain tiles were last prefetched for
+
+    QFuture<QList<QList<CoordInfo_t>>>  _transectJobFuture;
+    quint64                             _transectJobGeneration = 0;     ///< Bumped on every rebuild, older results are dropped
 
     // Deprecated json keys
     static constexpr const char* _jsonTerrainFollowKeyDeprecated       = "FollowTerrain";
@@ -266,15 +266,20 @@ QGeoCoordinate QGCMapPolyline::vertexCoordinate(int vertex) const
 }
 
 QList<QPointF> QGCMapPolyline::nedPolyline(void)
+{
+    return nedPolyline(coordinateList());
+}
+
+QList<QPointF> QGCMapPolyline::nedPolyline(const QList<QGeoCoordinate>& coords)
 {
     QList<QPointF>  nedPolyline;
 
-    if (count() > 0) {
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+    if (coords.count() > 0) {
+        QGeoCoordinate  tangentOrigin = coords[0];
 
-        for (int i=0; i<_polylinePath.count(); i++) {
+        for (int i=0; i<coords.count(); i++) {
             double y, x, down;
-            QGeoCoordinate vertex = vertexCoordinate(i);
+            QGeoCoordinate vertex = coords[i];
             if (i == 0) {
                 // This avoids a nan calculation that comes out of convertGeoToNed
                 x = y = 0;
@@ -288,16 +293,20 @@ QList<QPointF> QGCMapPolyline::nedPolyline(void)
     return nedPolyline;
 }
 
-
 QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
+{
+    return offsetPolyline(coordinateList(), distance);
+}
+
+QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(const QList<QGeoCoordinate>& coords, double distance)
 {
     QList<QGeoCoordinate> rgNewPolyline;
 
     // I'm sure there is some beautiful famous algorithm to do this, but here is a brute force method
 
-    if (count() > 1) {
+    if (coords.count() > 1) {
         // Convert the polygon to NED
-        QList<QPointF> rgNedVertices = nedPolyline();
+        QList<QPointF> rgNedVertices = nedPolyline(coords);
 
         // Walk the edges, offsetting by the specified distance
         QList<QLineF> rgOffsetEdges;
@@ -318,7 +327,7 @@ QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
             rgOffsetEdges.append(offsetEdge);
         }
 
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+        QGeoCoordinate  tangentOrigin = coords[0];
 
         // Add first vertex
         QGeoCoordinate coord;
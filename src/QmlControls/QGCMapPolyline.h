@@ -52,6 +52,9 @@ public:
     /// @return Offset set of vertices
     QList<QGeoCoordinate> offsetPolyline(double distance);
 
+    /// Offsets the edges of a list of vertices, safe to use from any thread
+    static QList<QGeoCoordinate> offsetPolyline(const QList<QGeoCoordinate>& coords, double distance);
+
     /// Loads a polyline from a KML file
     /// @return true: success
     Q_INVOKABLE bool loadKMLFile(const QString& kmlFile);
@@ -78,6 +81,7 @@ public:
 
     /// Convert polyline to NED and return (D is ignored)
     QList<QPointF> nedPolyline(void);
+    static QList<QPointF> nedPolyline(const QList<QGeoCoordinate>& coords);
 
     /// Returns the length of the polyline in meters
     double length(void) const;
@@ -78,6 +78,8 @@ void QGroundControlQmlGlobal::setToolbox(QGCToolbox* toolbox)
     _missionCommandTree     = toolbox->missionCommandTree();
     _videoManager           = toolbox->videoManager();
     _mavlinkLogManager      = toolbox->mavlinkLogManager();
+    _mavlinkLogWriter       = toolbox->mavlinkProtocol()->logWriter();
+    _mavlinkProtocol        = toolbox->mavlinkProtocol();
     _corePlugin             = toolbox->corePlugin();
     _firmwarePluginManager  = toolbox->firmwarePluginManager();
     _settingsManager        = toolbox->settingsManager();
@@ -23,6 +23,8 @@ class ADSBVehicleManager;
 class FactGroup;
 class LinkManager;
 class MAVLinkLogManager;
+class MAVLinkLogWriter;
+class MAVLinkProtocol;
 class MissionCommandTree;
 class MultiVehicleManager;
 class QGCCorePlugin;
@@ -38,6 +40,8 @@ Q_MOC_INCLUDE("ADSBVehicleManager.h")
 Q_MOC_INCLUDE("FactGroup.h")
 Q_MOC_INCLUDE("LinkManager.h")
 Q_MOC_INCLUDE("MAVLinkLogManager.h")
+Q_MOC_INCLUDE("MAVLinkLogWriter.h")
+Q_MOC_INCLUDE("MAVLinkProtocol.h")
 Q_MOC_INCLUDE("MissionCommandTree.h")
 Q_MOC_INCLUDE("MultiVehicleManager.h")
 Q_MOC_INCLUDE("QGCCorePlugin.h")
@@ -78,6 +82,8 @@ public:
     Q_PROPERTY(QGCPositionManager*  qgcPositionManger       READ    qgcPositionManger       CONSTANT)
     Q_PROPERTY(VideoManager*        videoManager            READ    videoManager            CONSTANT)
     Q_PROPERTY(MAVLinkLogManager*   mavlinkLogManager       READ    mavlinkLogManager       CONSTANT)
+    Q_PROPERTY(MAVLinkLogWriter*    mavlinkLogWriter        READ    mavlinkLogWriter        CONSTANT)
+    Q_PROPERTY(MAVLinkProtocol*     mavlinkProtocol         READ    mavlinkProtocol         CONSTANT)
     Q_PROPERTY(SettingsManager*     settingsManager         READ    settingsManager         CONSTANT)
     Q_PROPERTY(ADSBVehicleManager*  adsbVehicleManager      READ    adsbVehicleManager      CONSTANT)
     Q_PROPERTY(QGCCorePlugin*       corePlugin              READ    corePlugin              CONSTANT)
@@ -175,6 +181,8 @@ public:
     MissionCommandTree*     missionCommandTree  ()  { return _missionCommandTree; }
     VideoManager*           videoManager        ()  { return _videoManager; }
     MAVLinkLogManager*      mavlinkLogManager   ()  { return _mavlinkLogManager; }
+    MAVLinkLogWriter*       mavlinkLogWriter    ()  { return _mavlinkLogWriter; }
+    MAVLinkProtocol*        mavlinkProtocol     ()  { return _mavlinkProtocol; }
     QGCCorePlugin*          corePlugin          ()  { return _corePlugin; }
     SettingsManager*        settingsManager     ()  { return _settingsManager; }
 #ifndef NO_SERIAL_LINK
@@ -265,6 +273,8 @@ private:
     MissionCommandTree*     _missionCommandTree     = nullptr;
     VideoManager*           _videoManager           = nullptr;
     MAVLinkLogManager*      _mavlinkLogManager      = nullptr;
+    MAVLinkLogWriter*       _mavlinkLogWriter       = nullptr;
+    MAVLinkProtocol*        _mavlinkProtocol        = nullptr;
     QGCCorePlugin*          _corePlugin             = nullptr;
     FirmwarePluginManager*  _firmwarePluginManager  = nullptr;
     SettingsManager*        _settingsManager        = nullptr;
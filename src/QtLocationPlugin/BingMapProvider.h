@@ -24,6 +24,8 @@ protected:
 
 public:
     bool isBingProvider() const final { return true; }
+    // Tiles are spread over ecn.t0-ecn.t3
+    int concurrentDownloads() const final { return 16; }
 
 private:
     QString _getURL(int x, int y, int zoom) const final;
@@ -18,6 +18,8 @@ protected:
 
 public:
     bool isElevationProvider() const final { return true; }
+    // Terrain servers are single hosts that rate limit aggressive clients
+    int concurrentDownloads() const override { return 2; }
     virtual QByteArray serialize(const QByteArray &image) const = 0;
 };
 
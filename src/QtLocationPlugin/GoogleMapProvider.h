@@ -43,6 +43,10 @@ protected:
         , _versionRequest(versionRequest)
         , _version(version) {}
 
+public:
+    // Tiles are spread over mt0-mt3
+    int concurrentDownloads() const final { return 16; }
+
 private:
     void _getSecGoogleWords(int x, int y, QString& sec1, QString& sec2) const;
     QString _getURL(int x, int y, int zoom) const final;
@@ -64,6 +64,11 @@ public:
     virtual bool isElevationProvider() const { return false; }
     virtual bool isBingProvider() const { return false; }
 
+    /// Number of tile requests kept in flight when downloading an offline tile set from this provider.
+    /// QNetworkAccessManager runs at most 6 HTTP/1.1 requests in parallel per host, so providers which
+    /// spread tiles over several servers can go higher.
+    virtual int concurrentDownloads() const { return 6; }
+
     virtual QGCTileSet getTileCount(int zoom, double topleftLon,
                                     double topleftLat, double bottomRightLon,
                                     double bottomRightLat) const;
@@ -18,23 +18,27 @@
 #include "QGCCachedTileSet.h"
 
 #include "ElevationMapProvider.h"
+#include "MapsSettings.h"
 #include "QGCMapEngine.h"
 #include "QGCMapEngineManager.h"
 #include "QGCMapTasks.h"
 #include "QGCMapUrlEngine.h"
+#include "QGCTileDownloader.h"
 #include "QGeoFileTileCacheQGC.h"
 #include "QGeoTileFetcherQGC.h"
+#include "SettingsManager.h"
 
 #include <QGCApplication.h>
-#include <QGCFileDownload.h>
 #include <QGCLoggingCategory.h>
 #include <TerrainTile.h>
 
+#include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkProxy>
 
 QGC_LOGGING_CATEGORY(QGCCachedTileSetLog, "qgc.qtlocation.qgccachedtileset")
 
 #define TILE_BATCH_SIZE 256
+#define RATE_INTERVAL_MSECS 1000
 
 QGCCachedTileSet::QGCCachedTileSet(const QString &name, QObject *parent)
     : QObject(parent)
@@ -67,6 +71,9 @@ void QGCCachedTileSet::createDownloadTask()
         setErrorCount(0);
         setDownloading(true);
         _noMoreTiles = false;
+        setDownloadRate(0.);
+        _rateTileCount = 0;
+        _rateTimer.start();
     }
 
     QGCGetTileDownloadListTask* const task = new QGCGetTileDownloadListTask(_id, TILE_BATCH_SIZE);
@@ -89,18 +96,42 @@ void QGCCachedTileSet::resumeDownloadTask()
     createDownloadTask();
 }
 
-void QGCCachedTileSet::_tileListFetched(const QQueue<QGCTile*> &tiles)
+void QGCCachedTileSet::cancelDownloadTask()
+{
+    if (_downloader) {
+        _downloader->stop();
+    }
+    setDownloading(false);
+    setDownloadRate(0.);
+}
+
+void QGCCachedTileSet::_tileListFetched(const QList<quint64> &tiles)
 {
     _batchRequested = false;
     if (tiles.size() < TILE_BATCH_SIZE) {
         _noMoreTiles = true;
     }
 
+    if (!_downloading) {
+        return;
+    }
+
     if (tiles.isEmpty()) {
-        _doneWithDownload();
+        if (!_downloader || _downloader->isIdle()) {
+            _doneWithDownload();
+        }
         return;
     }
 
+    if (!_downloader) {
+        _createDownloader();
+    }
+
+    _downloader->enqueue(tiles);
+}
+
+void QGCCachedTileSet::_createDownloader()
+{
     if (!_networkManager) {
         _networkManager = new QNetworkAccessManager(this);
 #ifndef __mobile__
@@ -110,8 +141,18 @@ void QGCCachedTileSet::_tileListFetched(const QQueue<QGCTile*> &tiles)
 #endif
     }
 
-    (void) _tilesToDownload.append(tiles);
-    _prepareDownload();
+    const int mapId = UrlFactory::getQtMapIdFromProviderType(_type);
+    _downloader = new QGCTileDownloader(_networkManager, [mapId](int x, int y, int zoom) {
+        return QGeoTileFetcherQGC::getNetworkRequest(mapId, x, y, zoom);
+    }, this);
+    // The user setting overrides the limit of the map provider
+    const int maxConcurrent = qgcApp()->toolbox()->settingsManager()->mapsSettings()->maxConcurrentTileDownloads()->rawValue().toInt();
+    _downloader->setMaxConcurrent((maxConcurrent > 0) ? maxConcurrent : QGeoTileFetcherQGC::concurrentDownloads(_type));
+
+    (void) connect(_downloader, &QGCTileDownloader::tileDownloaded, this, &QGCCachedTileSet::_tileDownloaded);
+    (void) connect(_downloader, &QGCTileDownloader::tileFailed, this, &QGCCachedTileSet::_tileFailed);
+    (void) connect(_downloader, &QGCTileDownloader::queueLow, this, &QGCCachedTileSet::_downloaderQueueLow);
+    (void) connect(_downloader, &QGCTileDownloader::finished, this, &QGCCachedTileSet::_downloaderFinished);
 }
 
 void QGCCachedTileSet::_doneWithDownload()
@@ -131,87 +172,40 @@ void QGCCachedTileSet::_doneWithDownload()
     }
 
     setDownloading(false);
+    setDownloadRate(0.);
 
     emit completeChanged();
 }
 
-void QGCCachedTileSet::_prepareDownload()
+void QGCCachedTileSet::_downloaderQueueLow()
 {
-    if (_tilesToDownload.isEmpty()) {
-        if (_noMoreTiles) {
-            _doneWithDownload();
-        } else if (!_batchRequested) {
-            createDownloadTask();
-        }
-        return;
-    }
-
-    for (qsizetype i = _replies.count(); i < QGeoTileFetcherQGC::concurrentDownloads(_type); i++) {
-        if (_tilesToDownload.isEmpty()) {
-            break;
-        }
-
-        QGCTile* const tile = _tilesToDownload.dequeue();
-        const int mapId = UrlFactory::getQtMapIdFromProviderType(tile->type());
-        QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(mapId, tile->x(), tile->y(), tile->z());
-        request.setOriginatingObject(this);
-        request.setAttribute(QNetworkRequest::User, tile->hash());
-
-        QNetworkReply* const reply = _networkManager->get(request);
-        reply->setParent(this);
-        QGCFileDownload::setIgnoreSSLErrorsIfNeeded(*reply);
-        (void) connect(reply, &QNetworkReply::finished, this, &QGCCachedTileSet::_networkReplyFinished);
-        (void) connect(reply, &QNetworkReply::errorOccurred, this, &QGCCachedTileSet::_networkReplyError);
-        (void) _replies.insert(tile->hash(), reply);
-
-        delete tile;
-        if (!_batchRequested && !_noMoreTiles && (_tilesToDownload.count() < (QGeoTileFetcherQGC::concurrentDownloads(_type) * 10))) {
-            createDownloadTask();
-        }
+    if (_downloading && !_batchRequested && !_noMoreTiles) {
+        createDownloadTask();
     }
 }
 
-void QGCCachedTileSet::_networkReplyFinished()
+void QGCCachedTileSet::_downloaderFinished()
 {
-    QNetworkReply* const reply = qobject_cast<QNetworkReply*>(QObject::sender());
-    if (!reply) {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "NULL Reply";
-        return;
-    }
-    reply->deleteLater();
-
-    if (reply->error() != QNetworkReply::NoError) {
-        return;
-    }
-
-    if (!reply->isOpen()) {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Empty Reply";
+    if (!_downloading) {
         return;
     }
 
-    const QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-    if (hash.isEmpty()) {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Empty Hash";
-        return;
+    if (_noMoreTiles) {
+        _doneWithDownload();
+    } else if (!_batchRequested) {
+        createDownloadTask();
     }
+}
 
-    if (_replies.contains(hash)) {
-        (void) _replies.remove(hash);
-    } else {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Reply not in list: " << hash;
-    }
+void QGCCachedTileSet::_tileDownloaded(quint64 tile, const QByteArray &data)
+{
+    const QString hash = UrlFactory::getTileHash(_type, QGCTile::packedX(tile), QGCTile::packedY(tile), QGCTile::packedZ(tile));
     qCDebug(QGCCachedTileSetLog) << "Tile fetched:" << hash;
 
-    QByteArray image = reply->readAll();
-    if (image.isEmpty()) {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Empty Image";
-        return;
-    }
-
-    const QString type = UrlFactory::tileHashToType(hash);
-    const SharedMapProvider mapProvider = UrlFactory::getMapProviderFromProviderType(type);
+    const SharedMapProvider mapProvider = UrlFactory::getMapProviderFromProviderType(_type);
     Q_CHECK_PTR(mapProvider);
 
+    QByteArray image = data;
     if (mapProvider->isElevationProvider()) {
         const SharedElevationProvider elevationProvider = std::dynamic_pointer_cast<const ElevationProvider>(mapProvider);
         image = elevationProvider->serialize(image);
@@ -227,53 +221,43 @@ void QGCCachedTileSet::_networkReplyFinished()
         return;
     }
 
-    QGeoFileTileCacheQGC::cacheTile(type, hash, image, format, _id);
+    QGeoFileTileCacheQGC::cacheTile(_type, hash, image, format, _id);
 
     QGCUpdateTileDownloadStateTask* const task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
     getQGCMapEngine()->addTask(task);
 
     setSavedTileSize(_savedTileSize + image.size());
     setSavedTileCount(_savedTileCount + 1);
+    _updateDownloadRate();
 
     if (_savedTileCount % 10 == 0) {
         const quint32 avg = _savedTileSize / _savedTileCount;
         setTotalTileSize(avg * _totalTileCount);
         setUniqueTileSize(avg * _uniqueTileCount);
     }
-
-    _prepareDownload();
 }
 
-void QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
+void QGCCachedTileSet::_updateDownloadRate()
 {
-    QNetworkReply* const reply = qobject_cast<QNetworkReply*>(QObject::sender());
-    if (!reply) {
-        return;
-    }
-    qCDebug(QGCCachedTileSetLog) << Q_FUNC_INFO << "Error fetching tile" << reply->errorString();
-
-    setErrorCount(_errorCount + 1);
+    _rateTileCount++;
 
-    const QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-    if (hash.isEmpty()) {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Empty Hash";
-        return;
+    const qint64 elapsed = _rateTimer.elapsed();
+    if (elapsed >= RATE_INTERVAL_MSECS) {
+        setDownloadRate((_rateTileCount * 1000.) / elapsed);
+        _rateTileCount = 0;
+        _rateTimer.restart();
     }
+}
 
-    if (_replies.contains(hash)) {
-        (void) _replies.remove(hash);
-    } else {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Reply not in list:" << hash;
-    }
+void QGCCachedTileSet::_tileFailed(quint64 tile, const QString &errorString)
+{
+    const QString hash = UrlFactory::getTileHash(_type, QGCTile::packedX(tile), QGCTile::packedY(tile), QGCTile::packedZ(tile));
+    qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Error fetching tile" << hash << errorString;
 
-    if (error != QNetworkReply::OperationCanceledError) {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Error:" << reply->errorString();
-    }
+    setErrorCount(_errorCount + 1);
 
     QGCUpdateTileDownloadStateTask* const task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, hash);
     getQGCMapEngine()->addTask(task);
-
-    _prepareDownload();
 }
 
 void QGCCachedTileSet::setSelected(bool sel)
@@ -292,6 +276,11 @@ QString QGCCachedTileSet::errorCountStr() const
     return qgcApp()->numberToString(_errorCount);
 }
 
+QString QGCCachedTileSet::downloadRateStr() const
+{
+    return tr("%1 tiles/s").arg(_downloadRate, 0, 'f', 1);
+}
+
 QString QGCCachedTileSet::totalTileCountStr() const
 {
     return qgcApp()->numberToString(_totalTileCount);
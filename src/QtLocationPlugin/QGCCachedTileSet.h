@@ -19,17 +19,16 @@
 #pragma once
 
 #include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QHash>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
-#include <QtCore/QQueue>
 #include <QtCore/QString>
-#include <QtNetwork/QNetworkReply>
 
 Q_DECLARE_LOGGING_CATEGORY(QGCCachedTileSetLog)
 
-class QGCTile;
 class QGCMapEngineManager;
+class QGCTileDownloader;
 class QNetworkAccessManager;
 
 class QGCCachedTileSet : public QObject
@@ -66,6 +65,8 @@ class QGCCachedTileSet : public QObject
     Q_PROPERTY(bool         downloading         READ    downloading         NOTIFY downloadingChanged)
     Q_PROPERTY(quint32      errorCount          READ    errorCount          NOTIFY errorCountChanged)
     Q_PROPERTY(QString      errorCountStr       READ    errorCountStr       NOTIFY errorCountChanged)
+    Q_PROPERTY(double       downloadRate        READ    downloadRate        NOTIFY downloadRateChanged)
+    Q_PROPERTY(QString      downloadRateStr     READ    downloadRateStr     NOTIFY downloadRateChanged)
     Q_PROPERTY(bool         selected            READ    selected            WRITE  setSelected  NOTIFY selectedChanged)
 
 public:
@@ -74,7 +75,7 @@ public:
 
     Q_INVOKABLE void createDownloadTask();
     Q_INVOKABLE void resumeDownloadTask();
-    Q_INVOKABLE void cancelDownloadTask() { setDownloading(false); }
+    Q_INVOKABLE void cancelDownloadTask();
 
     const QString &name() const { return _name; }
     const QString &mapTypeStr() const { return _mapTypeStr; }
@@ -109,6 +110,9 @@ public:
     bool downloading() const { return _downloading; }
     quint32 errorCount() const { return _errorCount; }
     QString errorCountStr() const;
+    /// Tiles saved per second while downloading
+    double downloadRate() const { return _downloadRate; }
+    QString downloadRateStr() const;
     bool selected() const { return _selected; }
 
     void setManager(QGCMapEngineManager *mgr) { _manager = mgr; }
@@ -137,6 +141,7 @@ public:
     void setDeleting(bool del) { if (del != _deleting) { _deleting = del; emit deletingChanged(); } }
     void setDownloading(bool down) { if (down != _downloading) { _downloading = down; emit downloadingChanged(); } }
     void setErrorCount(quint32 count) { if (count != _errorCount) { _errorCount = count; emit errorCountChanged(); } }
+    void setDownloadRate(double rate) { if (rate != _downloadRate) { _downloadRate = rate; emit downloadRateChanged(); } }
 
 signals:
     void deletingChanged();
@@ -149,17 +154,21 @@ signals:
     void savedTileSizeChanged();
     void completeChanged();
     void errorCountChanged();
+    void downloadRateChanged();
     void selectedChanged();
     void nameChanged();
 
 private slots:
-    void _tileListFetched(const QQueue<QGCTile*> &tiles);
-    void _networkReplyFinished();
-    void _networkReplyError(QNetworkReply::NetworkError error);
+    void _tileListFetched(const QList<quint64> &tiles);
+    void _tileDownloaded(quint64 tile, const QByteArray &data);
+    void _tileFailed(quint64 tile, const QString &errorString);
+    void _downloaderQueueLow();
+    void _downloaderFinished();
 
 private:
-    void _prepareDownload();
+    void _createDownloader();
     void _doneWithDownload();
+    void _updateDownloadRate();
 
     QString _name;
     QString _mapTypeStr;
@@ -176,6 +185,9 @@ private:
     quint32 _savedTileCount = 0;
     quint64 _savedTileSize = 0;
     quint32 _errorCount = 0;
+    double _downloadRate = 0.;
+    quint32 _rateTileCount = 0;
+    QElapsedTimer _rateTimer;
     int _minZoom = 3;
     int _maxZoom = 3;
     bool _defaultSet = false;
@@ -186,8 +198,7 @@ private:
     bool _selected = false;
     QDateTime _creationDate;
 
-    QHash<QString, QNetworkReply*> _replies;
-    QQueue<QGCTile*> _tilesToDownload;
     QGCMapEngineManager *_manager = nullptr;
     QNetworkAccessManager *_networkManager = nullptr;
+    QGCTileDownloader *_downloader = nullptr;
 };
@@ -190,13 +190,14 @@ public:
     quint64 setID() const { return m_setID; }
     int count() const { return m_count; }
 
-    void setTileListFetched(const QQueue<QGCTile*> &tiles)
+    /// @param tiles Tile coordinates packed with QGCTile::pack
+    void setTileListFetched(const QList<quint64> &tiles)
     {
         emit tileListFetched(tiles);
     }
 
 signals:
-    void tileListFetched(QQueue<QGCTile*> tiles);
+    void tileListFetched(QList<quint64> tiles);
 
 private:
     const quint64 m_setID = 0;
@@ -30,6 +30,16 @@ public:
     void setHash(const QString &hash) { m_hash = hash; }
     void setType(const QString &type) { m_type = type; }
 
+    /// Packs tile coordinates into a single integer for compact download queues. Tile x/y fit in 28
+    /// bits up to zoom 28.
+    static constexpr quint64 pack(int x, int y, int z)
+    {
+        return (static_cast<quint64>(z) << 56) | (static_cast<quint64>(x) << 28) | static_cast<quint64>(y);
+    }
+    static constexpr int packedX(quint64 tile) { return static_cast<int>((tile >> 28) & 0xFFFFFFF); }
+    static constexpr int packedY(quint64 tile) { return static_cast<int>(tile & 0xFFFFFFF); }
+    static constexpr int packedZ(quint64 tile) { return static_cast<int>(tile >> 56); }
+
 private:
     int m_x = 0;
     int m_y = 0;
@@ -0,0 +1,300 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheReaderPool.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCCacheTile.h"
+#include "QGCMapTasks.h"
+
+#include <QtCore/QScopedPointer>
+#include <QtCore/QThread>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+/// One reader thread of the pool. Owns a read-only connection and the prepared fetch statement for it.
+class QGCCacheReader : public QThread
+{
+public:
+    QGCCacheReader(QGCCacheReaderPool* pool, int index)
+        : _pool     (pool)
+        , _session  (QStringLiteral("QGeoTileReaderSession%1_%2").arg(reinterpret_cast<quintptr>(pool), 0, 16).arg(index))
+    {
+    }
+
+    ~QGCCacheReader()
+    {
+        (void) wait();
+    }
+
+    /// Set when the reader is started, cleared once it no longer services the queue. Guarded by the pool mutex.
+    bool active = false;
+
+protected:
+    void run() final;
+
+private:
+    bool _connect();
+    void _disconnect();
+    void _fetch(QGCFetchTileTask* task);
+
+    QGCCacheReaderPool* const       _pool;
+    const QString                   _session;
+    QScopedPointer<QSqlDatabase>    _db;
+    QScopedPointer<QSqlQuery>       _fetchQuery;
+};
+
+//-----------------------------------------------------------------------------
+void QGCCacheReader::run()
+{
+    if (_pool->_databaseValid) {
+        (void) _connect();
+    }
+
+    QMutexLocker lock(&_pool->_mutex);
+    while (!_pool->_stopping && !_pool->_suspended) {
+        if (!_pool->_taskQueue.isEmpty()) {
+            QGCFetchTileTask* task = _pool->_taskQueue.dequeue();
+
+            // Don't need the lock while running the task.
+            lock.unlock();
+            _fetch(task);
+            task->deleteLater();
+            lock.relock();
+            continue;
+        }
+
+        _pool->_idleReaders++;
+        const bool woken = _pool->_taskAvailable.wait(&_pool->_mutex, QGCCacheReaderPool::_idleTimeoutMSecs);
+        _pool->_idleReaders--;
+        //-- If nothing to do, close connection and leave thread
+        if (!woken && _pool->_taskQueue.isEmpty()) {
+            break;
+        }
+    }
+    active = false;
+    lock.unlock();
+
+    _disconnect();
+}
+
+//-----------------------------------------------------------------------------
+bool QGCCacheReader::_connect()
+{
+    _db.reset(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session)));
+    _db->setDatabaseName(_pool->_databasePath);
+    _db->setConnectOptions("QSQLITE_OPEN_READONLY");
+    if (!_db->open()) {
+        qCWarning(QGCTileCacheLog) << "Map Cache SQL error (reader open db):" << _db->lastError().text();
+        _disconnect();
+        return false;
+    }
+
+    _fetchQuery.reset(new QSqlQuery(*_db));
+    _fetchQuery->setForwardOnly(true);
+    if (!_fetchQuery->prepare(QGCCacheReaderPool::fetchTileSql)) {
+        // Database may not be created yet, try again on the next fetch
+        qCDebug(QGCTileCacheLog) << "Map Cache SQL error (reader prepare):" << _fetchQuery->lastError().text();
+        _disconnect();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReader::_disconnect()
+{
+    _fetchQuery.reset();
+    if (_db) {
+        _db->close();
+        _db.reset();
+        QSqlDatabase::removeDatabase(_session);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReader::_fetch(QGCFetchTileTask* task)
+{
+    //-- Database went away (failed init, reset or import in progress), don't read through a stale connection
+    if (!_pool->_databaseValid) {
+        _disconnect();
+        task->setError("No Cache Database");
+        return;
+    }
+
+    //-- Pending tiles are checked first: they are only dropped after the commit, so a tile is
+    //   always either still pending or already visible to the query below.
+    QGCCacheTile* tile = _pool->_findPendingTile(task->hash());
+    if (!tile) {
+        if (!_fetchQuery && !_connect()) {
+            task->setError("No Cache Database");
+            return;
+        }
+        tile = QGCCacheReaderPool::fetchTile(*_fetchQuery, task->hash());
+    }
+    _pool->_fetchCount++;
+    if (tile) {
+        _pool->_hitCount++;
+        qCDebug(QGCTileCacheLog) << "_fetch() (Found in DB or pending) HASH:" << task->hash();
+        task->setTileFetched(tile);
+    } else {
+        qCDebug(QGCTileCacheLog) << "_fetch() (NOT in DB) HASH:" << task->hash();
+        task->setError("Tile not in cache database");
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCCacheReaderPool::QGCCacheReaderPool()
+{
+    setReaderCount(defaultReaderCount());
+}
+
+//-----------------------------------------------------------------------------
+QGCCacheReaderPool::~QGCCacheReaderPool()
+{
+    quit();
+    qDeleteAll(_readers);
+}
+
+//-----------------------------------------------------------------------------
+int QGCCacheReaderPool::defaultReaderCount()
+{
+    return qBound(2, QThread::idealThreadCount() / 2, 4);
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::setReaderCount(int count)
+{
+    quit();
+    qDeleteAll(_readers);
+    _readers.clear();
+    for (int i = 0; i < count; i++) {
+        _readers.push_back(new QGCCacheReader(this, i));
+    }
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::enqueue(QGCFetchTileTask* task)
+{
+    QMutexLocker lock(&_mutex);
+    _taskQueue.enqueue(task);
+    if (_suspended) {
+        return;
+    }
+    // Bring up another reader if the ones already waiting can't cover the queue
+    if (_taskQueue.count() > _idleReaders) {
+        _startReader();
+    }
+    _taskAvailable.wakeOne();
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::_startReader()
+{
+    for (QGCCacheReader* reader: _readers) {
+        if (!reader->active) {
+            if (reader->isRunning()) {
+                // Reader is on its way out after going idle, it no longer needs the mutex
+                (void) reader->wait();
+            }
+            reader->active = true;
+            reader->start(QThread::HighPriority);
+            return;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::_stopReaders()
+{
+    _taskAvailable.wakeAll();
+    _mutex.unlock();
+    for (QGCCacheReader* reader: _readers) {
+        (void) reader->wait();
+    }
+    _mutex.lock();
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::quit()
+{
+    QMutexLocker lock(&_mutex);
+    while (!_taskQueue.isEmpty()) {
+        delete _taskQueue.dequeue();
+    }
+    _stopping = true;
+    _stopReaders();
+    _stopping = false;
+    lock.unlock();
+
+    QMutexLocker pendingLock(&_pendingMutex);
+    _pendingTiles.clear();
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::addPendingTile(const QGCCacheTile& tile)
+{
+    QMutexLocker lock(&_pendingMutex);
+    (void) _pendingTiles.insert(tile.hash(), { tile.img(), tile.format(), tile.type() });
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::removePendingTiles(const QStringList& hashes)
+{
+    QMutexLocker lock(&_pendingMutex);
+    for (const QString& hash: hashes) {
+        (void) _pendingTiles.remove(hash);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCCacheTile* QGCCacheReaderPool::_findPendingTile(const QString& hash)
+{
+    QMutexLocker lock(&_pendingMutex);
+    const auto it = _pendingTiles.constFind(hash);
+    if (it == _pendingTiles.constEnd()) {
+        return nullptr;
+    }
+    return new QGCCacheTile(hash, it->img, it->format, it->type);
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::suspend()
+{
+    QMutexLocker lock(&_mutex);
+    _suspended = true;
+    _stopReaders();
+}
+
+//-----------------------------------------------------------------------------
+void QGCCacheReaderPool::resume()
+{
+    QMutexLocker lock(&_mutex);
+    _suspended = false;
+    const int count = qMin(static_cast<int>(_taskQueue.count()), readerCount());
+    for (int i = 0; i < count; i++) {
+        _startReader();
+    }
+    _taskAvailable.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+QGCCacheTile* QGCCacheReaderPool::fetchTile(QSqlQuery& query, const QString& hash)
+{
+    QGCCacheTile* tile = nullptr;
+    query.bindValue(0, hash);
+    if (query.exec() && query.next()) {
+        tile = new QGCCacheTile(hash, query.value(0).toByteArray(), query.value(1).toString(), query.value(2).toString());
+    }
+    // Reset the statement so the connection doesn't hold on to its read snapshot, which would keep
+    // the writer from checkpointing the WAL.
+    query.finish();
+    return tile;
+}
@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QWaitCondition>
+
+#include <atomic>
+#include <vector>
+
+class QGCCacheReader;
+class QGCCacheTile;
+class QGCFetchTileTask;
+class QSqlQuery;
+
+/// Serves QGCFetchTileTasks from a pool of threads, each with its own read-only connection to the
+/// tile cache database. Together with the writer connection in WAL mode this lets map tile reads
+/// run concurrently with each other and with tile saves or imports on the cache worker thread.
+///
+/// Reader threads are started on demand and exit again after being idle for a while, same as the
+/// cache worker.
+class QGCCacheReaderPool
+{
+public:
+    QGCCacheReaderPool();
+    ~QGCCacheReaderPool();
+
+    void setDatabaseFile(const QString& path) { _databasePath = path; }
+
+    /// Must be called before the first task is queued
+    void setReaderCount(int count);
+    int readerCount() const { return static_cast<int>(_readers.size()); }
+
+    /// Queues the task and takes ownership of it. Thread safe.
+    void enqueue(QGCFetchTileTask* task);
+
+    /// Drops all queued tasks and stops the reader threads
+    void quit();
+
+    /// Stops the reader threads and closes their connections so the writer can replace or drop the
+    /// database. Tasks queued in the meantime are held until resume is called.
+    void suspend();
+    void resume();
+
+    /// Mirrors the cache worker's database state. While the database isn't valid readers fail
+    /// fetches without touching it and close any connection they still hold.
+    void setDatabaseValid(bool valid) { _databaseValid = valid; }
+    bool databaseValid() const { return _databaseValid; }
+
+    /// Tiles queued for saving but not committed yet. The cache worker batches saves, so without
+    /// these a tile which was just downloaded would miss in the pool until the batch is written.
+    /// Thread safe.
+    void addPendingTile(const QGCCacheTile& tile);
+    /// Called once the tiles are committed (or the commit failed)
+    void removePendingTiles(const QStringList& hashes);
+
+    quint64 fetchCount() const { return _fetchCount; }
+    quint64 hitCount() const { return _hitCount; }
+
+    /// Looks up a tile using a query prepared from fetchTileSql
+    ///     @return Tile, nullptr if it is not in the cache
+    static QGCCacheTile* fetchTile(QSqlQuery& query, const QString& hash);
+
+    static constexpr const char* fetchTileSql = "SELECT tile, format, type FROM Tiles WHERE hash = ?";
+
+    static int defaultReaderCount();
+
+private:
+    /// Starts a reader which isn't servicing the queue yet. Must be called with _mutex held.
+    void _startReader();
+    /// Wakes all readers and waits for them to exit. Must be called with _mutex held, the mutex is
+    /// released while waiting.
+    void _stopReaders();
+    /// @return Copy of the pending tile, nullptr if there is none for hash
+    QGCCacheTile* _findPendingTile(const QString& hash);
+
+    struct PendingTile {
+        QByteArray  img;
+        QString     format;
+        QString     type;
+    };
+
+    QString                         _databasePath;
+    std::vector<QGCCacheReader*>    _readers;
+
+    QMutex                          _mutex;
+    QWaitCondition                  _taskAvailable;
+    QQueue<QGCFetchTileTask*>       _taskQueue;
+    int                             _idleReaders    = 0;
+    bool                            _suspended      = false;
+    bool                            _stopping       = false;
+    std::atomic<bool>               _databaseValid  {false};
+
+    QMutex                          _pendingMutex;
+    QHash<QString, PendingTile>     _pendingTiles;
+
+    std::atomic<quint64>            _fetchCount     {0};
+    std::atomic<quint64>            _hitCount       {0};
+
+    static constexpr unsigned long  _idleTimeoutMSecs = 5000;
+
+    friend class QGCCacheReader;
+};
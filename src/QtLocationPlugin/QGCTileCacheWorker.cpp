@@ -45,9 +45,15 @@ QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 #define LONG_TIMEOUT        5
 #define SHORT_TIMEOUT       2
 
+//-- Tile saves are committed in batches of up to this many writes, or after this long
+#define MAX_PENDING_WRITES      500
+#define PENDING_WRITES_MSECS    500
+
 //-----------------------------------------------------------------------------
 QGCCacheWorker::QGCCacheWorker(QObject* parent)
     : QThread(parent)
+    // Unique per worker so a second cache (e.g. in unit tests) doesn't take over this one's connection
+    , _session(kSession + QString::number(reinterpret_cast<quintptr>(this), 16))
     , _db(nullptr)
     , _valid(false)
     , _failed(false)
@@ -71,6 +77,7 @@ void
 QGCCacheWorker::setDatabaseFile(const QString& path)
 {
     _databasePath = path;
+    _readerPool.setDatabaseFile(path);
 }
 
 //-----------------------------------------------------------------------------
@@ -78,6 +85,7 @@ void
 QGCCacheWorker::quit()
 {
     QMutexLocker lock(&_taskQueueMutex);
+    _stopRequested = true;
     while(_taskQueue.count()) {
         QGCMapTask* task = _taskQueue.dequeue();
         delete task;
@@ -86,6 +94,7 @@ QGCCacheWorker::quit()
     if(this->isRunning()) {
         _waitc.wakeAll();
     }
+    _readerPool.quit();
 }
 
 //-----------------------------------------------------------------------------
@@ -98,7 +107,19 @@ QGCCacheWorker::enqueueTask(QGCMapTask* task)
         task->deleteLater();
         return false;
     }
+    //-- Tile reads don't need to wait behind saves and imports
+    if(_readerPool.readerCount() > 0) {
+        if(task->type() == QGCMapTask::taskFetchTile) {
+            _readerPool.enqueue(static_cast<QGCFetchTileTask*>(task));
+            return true;
+        }
+        //-- Readers serve the tile from memory until its batch is committed
+        if(task->type() == QGCMapTask::taskCacheTile) {
+            _readerPool.addPendingTile(*static_cast<QGCSaveTileTask*>(task)->tile());
+        }
+    }
     QMutexLocker lock(&_taskQueueMutex);
+    _stopRequested = false;
     _taskQueue.enqueue(task);
     lock.unlock(); // don't need to hold the mutex any more
     if(this->isRunning()) {
@@ -121,16 +142,28 @@ QGCCacheWorker::run()
     }
     _deleteBingNoTileTiles();
     QMutexLocker lock(&_taskQueueMutex);
-    while(true) {
+    while(!_stopRequested) {
         QGCMapTask* task;
         if(_taskQueue.count()) {
             task = _taskQueue.dequeue();
 
             // Don't need the lock while running the task.
             lock.unlock();
-            _runTask(task);
+            if(_isBatchedWrite(task)) {
+                if(_pendingWrites.isEmpty()) {
+                    _pendingWritesTimer.start();
+                }
+                _pendingWrites.append(task);
+                if(_pendingWrites.count() >= MAX_PENDING_WRITES) {
+                    _flushPendingWrites();
+                }
+            } else {
+                //-- Everything else must see the writes queued ahead of it
+                _flushPendingWrites();
+                _runTask(task);
+                task->deleteLater();
+            }
             lock.relock();
-            task->deleteLater();
             //-- Check for update timeout
             size_t count = static_cast<size_t>(_taskQueue.count());
             if(count > 100) {
@@ -147,6 +180,21 @@ QGCCacheWorker::run()
                     lock.relock();
                 }
             }
+        } else if(!_pendingWrites.isEmpty()) {
+            //-- Give more tiles a chance to join the pending transaction
+            const qint64 remaining = PENDING_WRITES_MSECS - _pendingWritesTimer.elapsed();
+            if(remaining > 0) {
+                (void) _waitc.wait(lock.mutex(), static_cast<unsigned long>(remaining));
+            }
+            //-- A wake-up may be spurious, only flush once the batch window is over or we are asked to quit
+            if(!_taskQueue.count() && (_stopRequested || _pendingWritesTimer.elapsed() >= PENDING_WRITES_MSECS)) {
+                lock.unlock();
+                _flushPendingWrites();
+                if(_valid) {
+                    _updateTotals();
+                }
+                lock.relock();
+            }
         } else {
             //-- Wait a bit before shutting things down
             unsigned long timeoutMilliseconds = 5000;
@@ -158,9 +206,58 @@ QGCCacheWorker::run()
         }
     }
     lock.unlock();
+    _flushPendingWrites();
     _disconnectDB();
 }
 
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_isBatchedWrite(QGCMapTask* task)
+{
+    switch(task->type()) {
+        case QGCMapTask::taskCacheTile:
+            return true;
+        case QGCMapTask::taskUpdateTileDownloadState:
+            //-- Single tile state changes come in with every downloaded tile
+            return static_cast<QGCUpdateTileDownloadStateTask*>(task)->hash() != "*";
+        default:
+            return false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_flushPendingWrites()
+{
+    if(_pendingWrites.isEmpty()) {
+        return;
+    }
+    //-- One commit for the whole batch instead of one per tile
+    const bool transaction = _valid && _db->transaction();
+    for(QGCMapTask* task: _pendingWrites) {
+        _runTask(task);
+    }
+    if(transaction && !_db->commit()) {
+        qCWarning(QGCTileCacheLog) << "Map Cache SQL error (commit pending writes):" << _db->lastError().text();
+        _db->rollback();
+        //-- Counted tiles did not make it in
+        _invalidateTotals();
+    }
+    qCDebug(QGCTileCacheLog) << "_flushPendingWrites()" << _pendingWrites.count() << "writes in" << _pendingWritesTimer.elapsed() << "ms";
+    QStringList savedHashes;
+    for(QGCMapTask* task: _pendingWrites) {
+        if(task->type() == QGCMapTask::taskCacheTile) {
+            savedHashes.append(static_cast<QGCSaveTileTask*>(task)->tile()->hash());
+        }
+        task->deleteLater();
+    }
+    //-- Only now the readers can find the tiles in the database
+    if(_readerPool.readerCount() > 0) {
+        _readerPool.removePendingTiles(savedHashes);
+    }
+    _pendingWrites.clear();
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_runTask(QGCMapTask *task)
@@ -245,6 +342,9 @@ QGCCacheWorker::_deleteBingNoTileTiles()
                 qCWarning(QGCTileCacheLog) << "Delete failed";
             }
         }
+        if (!idsToDelete.isEmpty()) {
+            _invalidateTotals();
+        }
     } else {
         qCWarning(QGCTileCacheLog) << "_deleteBingNoTileTiles query failed";
     }
@@ -288,21 +388,26 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 {
     if(_valid) {
         QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
-        QSqlQuery query(*_db);
-        query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-        query.addBindValue(task->tile()->hash());
-        query.addBindValue(task->tile()->format());
-        query.addBindValue(task->tile()->img());
-        query.addBindValue(task->tile()->img().size());
-        query.addBindValue(task->tile()->type());
-        query.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
-        if(query.exec()) {
-            quint64 tileID = query.lastInsertId().toULongLong();
+        QSqlQuery* query = _preparedQuery(_saveTileQuery, "INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
+        QSqlQuery* setQuery = _preparedQuery(_saveSetTileQuery, "INSERT INTO SetTiles(tileID, setID) VALUES(?, ?)");
+        if(!query || !setQuery) {
+            return;
+        }
+        query->bindValue(0, task->tile()->hash());
+        query->bindValue(1, task->tile()->format());
+        query->bindValue(2, task->tile()->img());
+        query->bindValue(3, task->tile()->img().size());
+        query->bindValue(4, task->tile()->type());
+        query->bindValue(5, QDateTime::currentDateTime().toSecsSinceEpoch());
+        if(query->exec()) {
+            quint64 tileID = query->lastInsertId().toULongLong();
             quint64 setID = task->tile()->tileSet() == UINT64_MAX ? _getDefaultTileSet() : task->tile()->tileSet();
-            QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-            query.prepare(s);
-            if(!query.exec()) {
-                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
+            setQuery->bindValue(0, tileID);
+            setQuery->bindValue(1, setID);
+            if(!setQuery->exec()) {
+                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << setQuery->lastError().text();
+            } else {
+                _countSavedTile(setID, task->tile()->img().size());
             }
             qCDebug(QGCTileCacheLog) << "_saveTile() HASH:" << task->tile()->hash();
         } else {
@@ -321,22 +426,13 @@ QGCCacheWorker::_getTile(QGCMapTask* mtask)
     if(!_testTask(mtask)) {
         return;
     }
-    bool found = false;
     QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
-    if(query.exec(s)) {
-        if(query.next()) {
-            const QByteArray& arrray   = query.value(0).toByteArray();
-            const QString& format  = query.value(1).toString();
-            const QString& type = query.value(2).toString();
-            qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
-            QGCCacheTile* tile = new QGCCacheTile(task->hash(), arrray, format, type);
-            task->setTileFetched(tile);
-            found = true;
-        }
-    }
-    if(!found) {
+    QSqlQuery* query = _preparedQuery(_fetchTileQuery, QGCCacheReaderPool::fetchTileSql);
+    QGCCacheTile* tile = query ? QGCCacheReaderPool::fetchTile(*query, task->hash()) : nullptr;
+    if(tile) {
+        qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
+        task->setTileFetched(tile);
+    } else {
         qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
         task->setError("Tile not in cache database");
     }
@@ -391,71 +487,123 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
         set->setTotalTileSize(_defaultSize);
         return;
     }
+    //-- Counting the tiles of a set means joining over the whole cache, so the totals are kept
+    //   up to date as tiles are saved and only recounted after changes which touch many tiles.
+    QHash<quint64, SetTotals>::const_iterator it = _setTotals.constFind(set->id());
+    if(it == _setTotals.constEnd()) {
+        SetTotals totals;
+        if(!_countSetTotals(set->id(), totals)) {
+            return;
+        }
+        it = _setTotals.insert(set->id(), totals);
+    }
+    set->setSavedTileCount(it->savedCount);
+    set->setSavedTileSize(it->savedSize);
+    qCDebug(QGCTileCacheLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
+    //-- Update (estimated) size
+    quint64 avg = UrlFactory::averageSizeForType(set->type());
+    if(set->totalTileCount() <= set->savedTileCount()) {
+        //-- We're done so the saved size is the total size
+        set->setTotalTileSize(set->savedTileSize());
+    } else {
+        //-- Otherwise we need to estimate it.
+        if(set->savedTileCount() > 10 && set->savedTileSize()) {
+            avg = set->savedTileSize() / set->savedTileCount();
+        }
+        set->setTotalTileSize(avg * set->totalTileCount());
+    }
+    //-- Now figure out the count for tiles unique to this set. This is only accurate when all tiles are downloaded
+    quint32 ucount = it->uniqueCount;
+    quint64 usize  = it->uniqueSize;
+    //-- If we haven't downloaded it all, estimate size of unique tiles
+    quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
+    if(!ucount) {
+        usize = expectedUcount * avg;
+    } else {
+        expectedUcount = ucount;
+    }
+    set->setUniqueTileCount(expectedUcount);
+    set->setUniqueTileSize(usize);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_countSetTotals(quint64 setID, SetTotals& totals)
+{
     QSqlQuery subquery(*_db);
-    QString sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(set->id());
-    qCDebug(QGCTileCacheLog) << "_updateSetTotals(): " << sq;
+    QString sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(setID);
+    qCDebug(QGCTileCacheLog) << "_countSetTotals(): " << sq;
+    if(!subquery.exec(sq) || !subquery.next()) {
+        return false;
+    }
+    totals.savedCount = subquery.value(0).toUInt();
+    totals.savedSize  = subquery.value(1).toULongLong();
+    sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(setID);
     if(subquery.exec(sq)) {
         if(subquery.next()) {
-            set->setSavedTileCount(subquery.value(0).toUInt());
-            set->setSavedTileSize(subquery.value(1).toULongLong());
-            qCDebug(QGCTileCacheLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
-            //-- Update (estimated) size
-            quint64 avg = UrlFactory::averageSizeForType(set->type());
-            if(set->totalTileCount() <= set->savedTileCount()) {
-                //-- We're done so the saved size is the total size
-                set->setTotalTileSize(set->savedTileSize());
-            } else {
-                //-- Otherwise we need to estimate it.
-                if(set->savedTileCount() > 10 && set->savedTileSize()) {
-                    avg = set->savedTileSize() / set->savedTileCount();
-                }
-                set->setTotalTileSize(avg * set->totalTileCount());
-            }
-            //-- Now figure out the count for tiles unique to this set
-            quint32 ucount = 0;
-            quint64 usize  = 0;
-            sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(set->id());
-            if(subquery.exec(sq)) {
-                if(subquery.next()) {
-                    //-- This is only accurate when all tiles are downloaded
-                    ucount = subquery.value(0).toUInt();
-                    usize  = subquery.value(1).toULongLong();
-                }
-            }
-            //-- If we haven't downloaded it all, estimate size of unique tiles
-            quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
-            if(!ucount) {
-                usize = expectedUcount * avg;
-            } else {
-                expectedUcount = ucount;
-            }
-            set->setUniqueTileCount(expectedUcount);
-            set->setUniqueTileSize(usize);
+            totals.uniqueCount = subquery.value(0).toUInt();
+            totals.uniqueSize  = subquery.value(1).toULongLong();
         }
     }
+    return true;
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCCacheWorker::_updateTotals()
+QGCCacheWorker::_countSavedTile(quint64 setID, quint64 size)
 {
-    QSqlQuery query(*_db);
-    QString s;
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
-    if(query.exec(s)) {
-        if(query.next()) {
-            _totalCount = query.value(0).toUInt();
-            _totalSize  = query.value(1).toULongLong();
+    //-- A newly inserted tile is only linked to the one set, so it is also unique to it
+    if(_totalsValid) {
+        _totalCount++;
+        _totalSize += size;
+        if(setID == _getDefaultTileSet()) {
+            _defaultCount++;
+            _defaultSize += size;
         }
     }
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
-    if(query.exec(s)) {
-        if(query.next()) {
-            _defaultCount = query.value(0).toUInt();
-            _defaultSize  = query.value(1).toULongLong();
+    QHash<quint64, SetTotals>::iterator it = _setTotals.find(setID);
+    if(it != _setTotals.end()) {
+        it->savedCount++;
+        it->savedSize += size;
+        it->uniqueCount++;
+        it->uniqueSize += size;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_invalidateTotals()
+{
+    _totalsValid = false;
+    _setTotals.clear();
+    _defaultSet = UINT64_MAX;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_updateTotals()
+{
+    //-- Only recount when something other than tile saves changed the cache
+    if(!_totalsValid) {
+        QSqlQuery query(*_db);
+        QString s;
+        s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
+        qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
+        if(query.exec(s)) {
+            if(query.next()) {
+                _totalCount = query.value(0).toUInt();
+                _totalSize  = query.value(1).toULongLong();
+            }
+        }
+        s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
+        qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
+        if(query.exec(s)) {
+            if(query.next()) {
+                _defaultCount = query.value(0).toUInt();
+                _defaultSize  = query.value(1).toULongLong();
+            }
         }
+        _totalsValid = true;
     }
     emit updateTotals(_totalCount, _totalSize, _defaultCount, _defaultSize);
     _lastUpdate = time(nullptr);
@@ -465,12 +613,13 @@ QGCCacheWorker::_updateTotals()
 quint64 QGCCacheWorker::_findTile(const QString hash)
 {
     quint64 tileID = 0;
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tileID FROM Tiles WHERE hash = \"%1\"").arg(hash);
-    if(query.exec(s)) {
-        if(query.next()) {
-            tileID = query.value(0).toULongLong();
+    QSqlQuery* query = _preparedQuery(_findTileQuery, "SELECT tileID FROM Tiles WHERE hash = ?");
+    if(query) {
+        query->bindValue(0, hash);
+        if(query->exec() && query->next()) {
+            tileID = query->value(0).toULongLong();
         }
+        query->finish();
     }
     return tileID;
 }
@@ -545,6 +694,8 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
                 }
             }
             _db->commit();
+            //-- Linking already cached tiles changes which tiles are unique to a set
+            _invalidateTotals();
             //-- Done
             _updateSetTotals(task->tileSet());
             task->setTileSetSaved();
@@ -561,27 +712,33 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
     if(!_testTask(mtask)) {
         return;
     }
-    QQueue<QGCTile*> tiles;
+    QList<quint64> tiles;
+    QStringList hashes;
     QGCGetTileDownloadListTask* task = static_cast<QGCGetTileDownloadListTask*>(mtask);
     QSqlQuery query(*_db);
-    QString s = QString("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
+    QString s = QString("SELECT hash, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
     if(query.exec(s)) {
+        tiles.reserve(task->count());
+        hashes.reserve(task->count());
         while(query.next()) {
-            QGCTile* tile = new QGCTile;
-            // tile->setTileSet(task->setID());
-            tile->setHash(query.value("hash").toString());
-            tile->setType(UrlFactory::getProviderTypeFromQtMapId(query.value("type").toInt()));
-            tile->setX(query.value("x").toInt());
-            tile->setY(query.value("y").toInt());
-            tile->setZ(query.value("z").toInt());
-            tiles.enqueue(tile);
+            hashes.append(query.value(0).toString());
+            tiles.append(QGCTile::pack(query.value(1).toInt(), query.value(2).toInt(), query.value(3).toInt()));
         }
-        for(int i = 0; i < tiles.size(); i++) {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->hash());
-            if(!query.exec(s)) {
+        //-- Mark the whole batch in one transaction instead of one commit per tile
+        (void) _db->transaction();
+        query.prepare("UPDATE TilesDownload SET state = ? WHERE setID = ? AND hash = ?");
+        for(const QString& hash: hashes) {
+            query.addBindValue(static_cast<int>(QGCTile::StateDownloading));
+            query.addBindValue(task->setID());
+            query.addBindValue(hash);
+            if(!query.exec()) {
                 qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
             }
         }
+        if(!_db->commit()) {
+            qCWarning(QGCTileCacheLog) << "Map Cache SQL error (commit TilesDownload state):" << _db->lastError().text();
+            (void) _db->rollback();
+        }
     }
     task->setTileListFetched(tiles);
 }
@@ -594,19 +751,29 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
         return;
     }
     QGCUpdateTileDownloadStateTask* task = static_cast<QGCUpdateTileDownloadStateTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s;
+    QSqlQuery* query = nullptr;
     if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
+        query = _preparedQuery(_downloadCompleteQuery, "DELETE FROM TilesDownload WHERE setID = ? AND hash = ?");
+        if(query) {
+            query->bindValue(0, task->setID());
+            query->bindValue(1, task->hash());
+        }
+    } else if(task->hash() == "*") {
+        query = _preparedQuery(_downloadSetStateQuery, "UPDATE TilesDownload SET state = ? WHERE setID = ?");
+        if(query) {
+            query->bindValue(0, static_cast<int>(task->state()));
+            query->bindValue(1, task->setID());
+        }
     } else {
-        if(task->hash() == "*") {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
-        } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->hash());
+        query = _preparedQuery(_downloadStateQuery, "UPDATE TilesDownload SET state = ? WHERE setID = ? AND hash = ?");
+        if(query) {
+            query->bindValue(0, static_cast<int>(task->state()));
+            query->bindValue(1, task->setID());
+            query->bindValue(2, task->hash());
         }
     }
-    if(!query.exec(s)) {
-        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+    if(query && !query->exec()) {
+        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query->lastError().text();
     }
 }
 
@@ -636,6 +803,7 @@ QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
             if(!query.exec(s))
                 break;
         }
+        _invalidateTotals();
         task->setPruned();
     }
 }
@@ -667,6 +835,7 @@ QGCCacheWorker::_deleteTileSet(qulonglong id)
     query.exec(s);
     s = QString("DELETE FROM SetTiles WHERE setID = %1").arg(id);
     query.exec(s);
+    _invalidateTotals();
     _updateTotals();
 }
 
@@ -694,6 +863,9 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
         return;
     }
     QGCResetTask* task = static_cast<QGCResetTask*>(mtask);
+    //-- Readers must not see the tables disappear underneath them
+    _readerPool.suspend();
+    _clearPreparedQueries();
     QSqlQuery query(*_db);
     QString s;
     s = QString("DROP TABLE Tiles");
@@ -705,6 +877,9 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
     s = QString("DROP TABLE TilesDownload");
     query.exec(s);
     _valid = _createDB(*_db);
+    _invalidateTotals();
+    _updateReaderPoolState();
+    _readerPool.resume();
     task->setResetCompleted();
 }
 
@@ -719,9 +894,9 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
     //-- If replacing, simply copy over it
     if(task->replace()) {
         //-- Close and delete old database
+        _readerPool.suspend();
         _disconnectDB();
-        QFile file(_databasePath);
-        file.remove();
+        _removeDatabaseFiles();
         //-- Copy given database
         QFile::copy(task->path(), _databasePath);
         task->setProgress(25);
@@ -730,6 +905,8 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
             task->setProgress(50);
             _connectDB();
         }
+        _updateReaderPoolState();
+        _readerPool.resume();
         task->setProgress(100);
     } else {
         //-- Open imported set
@@ -884,6 +1061,7 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
             task->setError("Error opening import database");
         }
     }
+    _invalidateTotals();
     task->setImportCompleted();
 }
 
@@ -1028,6 +1206,7 @@ QGCCacheWorker::_init()
         qCritical() << "Could not find suitable cache directory.";
         _failed = true;
     }
+    _updateReaderPoolState();
     return _failed;
 }
 
@@ -1035,10 +1214,23 @@ QGCCacheWorker::_init()
 bool
 QGCCacheWorker::_connectDB()
 {
-    _db.reset(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession)));
+    _db.reset(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session)));
     _db->setDatabaseName(_databasePath);
-    _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+    // No shared cache here: it would put the reader connections back behind table level locks
     _valid = _db->open();
+    _invalidateTotals();
+    if(_valid) {
+        //-- WAL lets the read-only connections keep reading while this one writes. NORMAL sync is
+        //   still safe against corruption in WAL mode and saves an fsync on every tile commit.
+        QSqlQuery query(*_db);
+        if(!query.exec("PRAGMA journal_mode=WAL")) {
+            qCWarning(QGCTileCacheLog) << "Map Cache SQL error (journal_mode):" << query.lastError().text();
+        }
+        if(!query.exec("PRAGMA synchronous=NORMAL")) {
+            qCWarning(QGCTileCacheLog) << "Map Cache SQL error (synchronous):" << query.lastError().text();
+        }
+    }
+    _updateReaderPoolState();
     return _valid;
 }
 
@@ -1124,18 +1316,63 @@ QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
         }
     }
     if(!res) {
-        QFile file(_databasePath);
-        file.remove();
+        _removeDatabaseFiles();
     }
     return res;
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_updateReaderPoolState()
+{
+    _readerPool.setDatabaseValid(_valid && !_failed);
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_disconnectDB()
 {
+    _clearPreparedQueries();
     if (_db) {
         _db.reset();
-        QSqlDatabase::removeDatabase(kSession);
+        QSqlDatabase::removeDatabase(_session);
     }
 }
+
+//-----------------------------------------------------------------------------
+QSqlQuery*
+QGCCacheWorker::_preparedQuery(QScopedPointer<QSqlQuery>& query, const char* sql)
+{
+    if(!query) {
+        query.reset(new QSqlQuery(*_db));
+        query->setForwardOnly(true);
+        if(!query->prepare(QString::fromLatin1(sql))) {
+            qCWarning(QGCTileCacheLog) << "Map Cache SQL error (prepare):" << sql << query->lastError().text();
+            query.reset();
+        }
+    }
+    return query.data();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_removeDatabaseFiles()
+{
+    QFile::remove(_databasePath);
+    //-- Stale WAL files must not be applied to whatever database takes this one's place
+    QFile::remove(_databasePath + QStringLiteral("-wal"));
+    QFile::remove(_databasePath + QStringLiteral("-shm"));
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_clearPreparedQueries()
+{
+    _saveTileQuery.reset();
+    _saveSetTileQuery.reset();
+    _fetchTileQuery.reset();
+    _findTileQuery.reset();
+    _downloadCompleteQuery.reset();
+    _downloadStateQuery.reset();
+    _downloadSetStateQuery.reset();
+}
@@ -18,18 +18,25 @@
 
 #pragma once
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QString>
 #include <QtCore/QThread>
 #include <QtCore/QQueue>
+#include <QtCore/QScopedPointer>
 #include <QtCore/QMutex>
 #include <QtCore/QWaitCondition>
 #include <QtSql/QSqlDatabase>
 #include <QtCore/QLoggingCategory>
 
+#include "QGCTileCacheReaderPool.h"
+
 Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheLog)
 
 class QGCMapTask;
 class QGCCachedTileSet;
+class QSqlQuery;
 
 //-----------------------------------------------------------------------------
 class QGCCacheWorker : public QThread
@@ -43,10 +50,23 @@ public:
     bool    enqueueTask     (QGCMapTask* task);
     void    setDatabaseFile (const QString& path);
 
+    /// Sets the number of read-only connections serving tile fetches. 0 runs fetches on the
+    /// writer thread together with all other tasks. Must be called before the first task is queued.
+    void    setReadConnectionCount  (int count) { _readerPool.setReaderCount(count); }
+    int     readConnectionCount     () const    { return _readerPool.readerCount(); }
+    const QGCCacheReaderPool& readerPool() const { return _readerPool; }
+
 protected:
     void    run             ();
 
 private:
+    struct SetTotals {
+        quint32 savedCount  = 0;
+        quint64 savedSize   = 0;
+        quint32 uniqueCount = 0;
+        quint64 uniqueSize  = 0;
+    };
+
     void        _runTask                (QGCMapTask* task);
 
     void        _saveTile               (QGCMapTask* mtask);
@@ -67,13 +87,26 @@ private:
     quint64     _findTile               (const QString hash);
     bool        _findTileSetID          (const QString name, quint64& setID);
     void        _updateSetTotals        (QGCCachedTileSet* set);
+    bool        _countSetTotals         (quint64 setID, SetTotals& totals);
     bool        _init                   ();
     bool        _connectDB              ();
     bool        _createDB               (QSqlDatabase& db, bool createDefault = true);
     void        _disconnectDB           ();
+    /// Gates the reader pool on _valid/_failed, must follow every change to either
+    void        _updateReaderPoolState  ();
     quint64     _getDefaultTileSet      ();
     void        _updateTotals           ();
     void        _deleteTileSet          (qulonglong id);
+    /// Returns the statement for sql, preparing it on the writer connection the first time around
+    QSqlQuery*  _preparedQuery          (QScopedPointer<QSqlQuery>& query, const char* sql);
+    void        _clearPreparedQueries   ();
+    bool        _isBatchedWrite         (QGCMapTask* task);
+    /// Runs all pending tile saves and download state updates in a single transaction
+    void        _flushPendingWrites     ();
+    void        _countSavedTile         (quint64 setID, quint64 size);
+    /// Forces a recount of the cache totals, for changes that touch more than single new tiles
+    void        _invalidateTotals       ();
+    void        _removeDatabaseFiles    ();
 
 signals:
     void        updateTotals            (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
@@ -81,9 +114,21 @@ signals:
 private:
     QQueue<QGCMapTask*>             _taskQueue;
     QMutex                          _taskQueueMutex;
+    bool                            _stopRequested = false;     ///< Set by quit(), guarded by _taskQueueMutex
     QWaitCondition                  _waitc;
     QString                         _databasePath;
+    const QString                   _session;
     QScopedPointer<QSqlDatabase>    _db;
+    QScopedPointer<QSqlQuery>       _saveTileQuery;
+    QScopedPointer<QSqlQuery>       _saveSetTileQuery;
+    QScopedPointer<QSqlQuery>       _fetchTileQuery;
+    QScopedPointer<QSqlQuery>       _findTileQuery;
+    QScopedPointer<QSqlQuery>       _downloadCompleteQuery;
+    QScopedPointer<QSqlQuery>       _downloadStateQuery;
+    QScopedPointer<QSqlQuery>       _downloadSetStateQuery;
+    QList<QGCMapTask*>              _pendingWrites;
+    QElapsedTimer                   _pendingWritesTimer;
+    QGCCacheReaderPool              _readerPool;
     std::atomic_bool                _valid;
     bool                            _failed;
     quint64                         _defaultSet;
@@ -93,6 +138,8 @@ private:
     quint32                         _defaultCount;
     time_t                          _lastUpdate;
     int                             _updateTimeout;
+    bool                            _totalsValid = false;
+    QHash<quint64, SetTotals>       _setTotals;     ///< Per set totals counted so far, kept current as tiles are saved
 
     static constexpr const char*      kDefaultSet     = "Default Tile Set";
 };
@@ -0,0 +1,204 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileDownloader.h"
+#include "QGCTile.h"
+
+#include <QGCFileDownload.h>
+#include <QGCLoggingCategory.h>
+
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+
+QGC_LOGGING_CATEGORY(QGCTileDownloaderLog, "qgc.qtlocation.qgctiledownloader")
+
+QGCTileDownloader::QGCTileDownloader(QNetworkAccessManager *networkManager, const RequestFactory &requestFactory, QObject *parent)
+    : QObject(parent)
+    , _networkManager(networkManager)
+    , _requestFactory(requestFactory)
+{
+    // qCDebug(QGCTileDownloaderLog) << Q_FUNC_INFO << this;
+}
+
+QGCTileDownloader::~QGCTileDownloader()
+{
+    stop();
+
+    // qCDebug(QGCTileDownloaderLog) << Q_FUNC_INFO << this;
+}
+
+void QGCTileDownloader::setMaxConcurrent(int count)
+{
+    _maxConcurrent = qMax(1, count);
+    _lowWaterMark = _maxConcurrent * 10;
+}
+
+void QGCTileDownloader::enqueue(const QList<quint64> &tiles)
+{
+    if (tiles.isEmpty()) {
+        return;
+    }
+
+    _queue.reserve(_queue.count() + tiles.count());
+    for (const quint64 tile : tiles) {
+        _queue.enqueue(tile);
+    }
+
+    _startDownloads();
+}
+
+void QGCTileDownloader::stop()
+{
+    _generation++;
+    _queue.clear();
+    _attempts.clear();
+    _retriesWaiting = 0;
+
+    const QSet<QNetworkReply*> replies = _replies;
+    _replies.clear();
+    for (QNetworkReply *reply : replies) {
+        (void) disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+void QGCTileDownloader::_startDownloads()
+{
+    while ((_replies.count() < _maxConcurrent) && !_queue.isEmpty()) {
+        const quint64 tile = _queue.dequeue();
+
+        QNetworkRequest request = _requestFactory(QGCTile::packedX(tile), QGCTile::packedY(tile), QGCTile::packedZ(tile));
+        if (request.url().isEmpty()) {
+            _fail(tile, QStringLiteral("No tile url"));
+            continue;
+        }
+        request.setAttribute(QNetworkRequest::User, tile);
+        // All requests share the manager's connections, HTTP/2 capable servers get them multiplexed
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+        QNetworkReply *const reply = _networkManager->get(request);
+        reply->setParent(this);
+        QGCFileDownload::setIgnoreSSLErrorsIfNeeded(*reply);
+        (void) connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            _replyFinished(reply);
+        });
+        (void) _replies.insert(reply);
+    }
+
+    if (_queue.count() < _lowWaterMark) {
+        emit queueLow();
+    }
+
+    _checkFinished();
+}
+
+void QGCTileDownloader::_replyFinished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (!_replies.remove(reply)) {
+        return;
+    }
+
+    const quint64 tile = reply->request().attribute(QNetworkRequest::User).toULongLong();
+    if (reply->error() == QNetworkReply::NoError) {
+        const QByteArray data = reply->readAll();
+        if (data.isEmpty()) {
+            _fail(tile, QStringLiteral("Empty reply"));
+        } else {
+            (void) _attempts.remove(tile);
+            _downloadedCount++;
+            emit tileDownloaded(tile, data);
+        }
+    } else {
+        const int attempt = _attempts.value(tile, 0);
+        if (_isRetryable(reply) && (attempt < _maxRetries)) {
+            _retry(tile, attempt + 1, reply);
+        } else {
+            qCDebug(QGCTileDownloaderLog) << "Giving up on tile" << QGCTile::packedZ(tile) << QGCTile::packedX(tile) << QGCTile::packedY(tile) << reply->errorString();
+            _fail(tile, reply->errorString());
+        }
+    }
+
+    _startDownloads();
+}
+
+void QGCTileDownloader::_retry(quint64 tile, int attempt, QNetworkReply *reply)
+{
+    _attempts[tile] = attempt;
+    _retryCount++;
+    _retriesWaiting++;
+
+    // Exponential backoff with +-50% jitter so tiles which failed together don't retry in lockstep
+    const double jitter = 0.5 + QRandomGenerator::global()->generateDouble();
+    int delayMSecs = static_cast<int>(_retryDelayMSecs * (1 << (attempt - 1)) * jitter);
+
+    // Servers which are shedding load may tell us how long to stay away
+    const QByteArray retryAfter = reply->rawHeader(QByteArrayLiteral("Retry-After"));
+    bool ok = false;
+    const int retryAfterSecs = retryAfter.toInt(&ok);
+    if (ok && (retryAfterSecs > 0)) {
+        delayMSecs = qMax(delayMSecs, qMin(retryAfterSecs, 60) * 1000);
+    }
+
+    qCDebug(QGCTileDownloaderLog) << "Retry" << attempt << "in" << delayMSecs << "ms for tile" << QGCTile::packedZ(tile) << QGCTile::packedX(tile) << QGCTile::packedY(tile) << reply->errorString();
+
+    const quint32 generation = _generation;
+    QTimer::singleShot(delayMSecs, this, [this, tile, generation]() {
+        if (generation != _generation) {
+            return;
+        }
+        _retriesWaiting--;
+        // Retried tiles go ahead of the queue so a set doesn't finish with a tail of slow retries
+        _queue.prepend(tile);
+        _startDownloads();
+    });
+}
+
+void QGCTileDownloader::_fail(quint64 tile, const QString &errorString)
+{
+    (void) _attempts.remove(tile);
+    _failedCount++;
+    emit tileFailed(tile, errorString);
+}
+
+void QGCTileDownloader::_checkFinished()
+{
+    if (isIdle()) {
+        emit finished();
+    }
+}
+
+bool QGCTileDownloader::_isRetryable(const QNetworkReply *reply)
+{
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if ((status == 429) || (status >= 500)) {
+        return true;
+    }
+
+    switch (reply->error()) {
+    // Requests aborted through stop() never get here, so a cancel means the transfer timed out
+    case QNetworkReply::OperationCanceledError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::InternalServerError:
+    case QNetworkReply::ServiceUnavailableError:
+    case QNetworkReply::UnknownServerError:
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,100 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QQueue>
+#include <QtCore/QSet>
+#include <QtNetwork/QNetworkRequest>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTileDownloaderLog)
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/// Downloads map tiles with a bounded number of requests in flight. Tiles are queued as packed
+/// coordinates (see QGCTile::pack) so large offline sets don't hold an object per tile. Failed
+/// requests which may succeed later (timeouts, 5xx, 429) are retried with jittered exponential
+/// backoff before giving up on the tile.
+class QGCTileDownloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Builds the request for a tile, an empty url skips the tile
+    typedef std::function<QNetworkRequest(int x, int y, int zoom)> RequestFactory;
+
+    QGCTileDownloader(QNetworkAccessManager *networkManager, const RequestFactory &requestFactory, QObject *parent = nullptr);
+    ~QGCTileDownloader();
+
+    /// Also sets the queue low water mark to ten times the count
+    void setMaxConcurrent(int count);
+    int maxConcurrent() const { return _maxConcurrent; }
+    void setMaxRetries(int count) { _maxRetries = count; }
+    int maxRetries() const { return _maxRetries; }
+    /// Delay before the first retry, doubled for each further one and jittered by +-50%
+    void setRetryDelayMSecs(int msecs) { _retryDelayMSecs = msecs; }
+
+    /// Queues packed tiles and starts downloading them
+    void enqueue(const QList<quint64> &tiles);
+    /// Drops queued tiles and pending retries and aborts the requests in flight. No signals are
+    /// emitted for any of them.
+    void stop();
+
+    int queuedCount() const { return _queue.count(); }
+    int activeCount() const { return _replies.count(); }
+    bool isIdle() const { return (_queue.isEmpty() && _replies.isEmpty() && (_retriesWaiting == 0)); }
+
+    quint64 downloadedCount() const { return _downloadedCount; }
+    quint64 failedCount() const { return _failedCount; }
+    quint64 retryCount() const { return _retryCount; }
+
+signals:
+    void tileDownloaded(quint64 tile, const QByteArray &data);
+    /// Emitted once retries are used up or the error can't be fixed by retrying
+    void tileFailed(quint64 tile, const QString &errorString);
+    /// The queue dropped below the low water mark, time to queue more tiles
+    void queueLow();
+    /// Nothing queued, in flight or waiting to be retried
+    void finished();
+
+private:
+    void _startDownloads();
+    void _replyFinished(QNetworkReply *reply);
+    void _retry(quint64 tile, int attempt, QNetworkReply *reply);
+    void _fail(quint64 tile, const QString &errorString);
+    void _checkFinished();
+
+    static bool _isRetryable(const QNetworkReply *reply);
+
+    QNetworkAccessManager *_networkManager = nullptr;
+    RequestFactory _requestFactory;
+
+    QQueue<quint64> _queue;
+    QSet<QNetworkReply*> _replies;
+    /// Retries done so far, only for tiles which failed at least once
+    QHash<quint64, int> _attempts;
+    int _retriesWaiting = 0;
+    /// Bumped by stop() so retry timers scheduled before it do nothing
+    quint32 _generation = 0;
+
+    int _maxConcurrent = 6;
+    int _lowWaterMark = 60;
+    int _maxRetries = 3;
+    int _retryDelayMSecs = 500;
+
+    quint64 _downloadedCount = 0;
+    quint64 _failedCount = 0;
+    quint64 _retryCount = 0;
+};
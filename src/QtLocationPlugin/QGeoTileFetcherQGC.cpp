@@ -98,6 +98,12 @@ void QGeoTileFetcherQGC::handleReply(QGeoTiledMapReply *reply, const QGeoTileSpe
     }
 }
 
+int QGeoTileFetcherQGC::concurrentDownloads(QStringView type)
+{
+    const SharedMapProvider mapProvider = UrlFactory::getMapProviderFromProviderType(type);
+    return (mapProvider ? mapProvider->concurrentDownloads() : 6);
+}
+
 QNetworkRequest QGeoTileFetcherQGC::getNetworkRequest(int mapId, int x, int y, int zoom)
 {
     const SharedMapProvider mapProvider = UrlFactory::getMapProviderFromQtMapId(mapId);
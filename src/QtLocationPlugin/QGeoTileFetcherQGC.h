@@ -23,7 +23,7 @@ public:
     static QNetworkRequest getNetworkRequest(int mapId, int x, int y, int zoom);
     /* Note: QNetworkAccessManager queues the requests it receives. The number of requests executed in parallel is dependent on the protocol.
      * Currently, for the HTTP protocol on desktop platforms, 6 requests are executed in parallel for one host/port combination. */
-    static uint32_t concurrentDownloads(const QString &type) { Q_UNUSED(type); return 6; }
+    static int concurrentDownloads(QStringView type);
 
 private:
     QGeoTiledMapReply* getTileImage(const QGeoTileSpec &spec) final;
@@ -548,6 +548,13 @@ Item {
                         QGCLabel {  text: qsTr("Downloaded:"); width: infoView._labelWidth; }
                         QGCLabel {  text: (offlineMapView._currentSelection ? offlineMapView._currentSelection.savedTileCountStr : "") + " (" + (offlineMapView._currentSelection ? offlineMapView._currentSelection.savedTileSizeStr : "") + ")"; horizontalAlignment: Text.AlignRight; width: infoView._valueWidth; }
                     }
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        visible:    offlineMapView && offlineMapView._currentSelection && !_defaultSet && offlineMapView._currentSelection.downloading
+                        QGCLabel {  text: qsTr("Rate:"); width: infoView._labelWidth; }
+                        QGCLabel {  text: offlineMapView._currentSelection ? offlineMapView._currentSelection.downloadRateStr : ""; horizontalAlignment: Text.AlignRight; width: infoView._valueWidth; }
+                    }
                     Row {
                         spacing:    ScreenTools.defaultFontPixelWidth
                         anchors.horizontalCenter: parent.horizontalCenter
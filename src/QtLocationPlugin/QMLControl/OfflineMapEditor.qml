@@ -284,6 +284,13 @@ FlightMap {
                     QGCLabel {  text: qsTr("Downloaded:"); width: infoView._labelWidth; }
                     QGCLabel {  text: (tileSet ? tileSet.savedTileCountStr : "") + " (" + (tileSet ? tileSet.savedTileSizeStr : "") + ")"; horizontalAlignment: Text.AlignRight; width: infoView._valueWidth; }
                 }
+                Row {
+                    spacing:    ScreenTools.defaultFontPixelWidth
+                    anchors.horizontalCenter: parent.horizontalCenter
+                    visible:    tileSet && !_defaultSet && tileSet.downloading
+                    QGCLabel {  text: qsTr("Rate:"); width: infoView._labelWidth; }
+                    QGCLabel {  text: tileSet ? tileSet.downloadRateStr : ""; horizontalAlignment: Text.AlignRight; width: infoView._valueWidth; }
+                }
                 Row {
                     spacing:    ScreenTools.defaultFontPixelWidth
                     anchors.horizontalCenter: parent.horizontalCenter
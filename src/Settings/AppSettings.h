@@ -64,6 +64,7 @@ public:
     DEFINE_SETTINGFACT(loginAirLink)
     DEFINE_SETTINGFACT(passAirLink)
     DEFINE_SETTINGFACT(mavlink2SigningKey)
+    DEFINE_SETTINGFACT(mavlinkProtocolThread)
 
     // Although this is a global setting it only affects ArduPilot vehicle since PX4 automatically starts the stream from the vehicle side
     DEFINE_SETTINGFACT(apmStartMavlinkStreams)
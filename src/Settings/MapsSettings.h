@@ -21,4 +21,5 @@ public:
 
     DEFINE_SETTINGFACT(maxCacheDiskSize)
     DEFINE_SETTINGFACT(maxCacheMemorySize)
+    DEFINE_SETTINGFACT(maxConcurrentTileDownloads)
 };
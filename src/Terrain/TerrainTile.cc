@@ -16,17 +16,32 @@
 #include <QtCore/QJsonArray>
 #include <QtCore/QtNumeric>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "qgc.terrain.terraintile");
 
 TerrainTile::TerrainTile(const QByteArray& byteArray)
 {
+    const int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
+    const int cTileBytesAvailable = byteArray.size();
+
+    if (cTileBytesAvailable < cTileHeaderBytes) {
+        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for TileInfo_s header";
+        return;
+    }
+
     // Copy tile info
-    _tileInfo = *reinterpret_cast<const TileInfo_t*>(byteArray.constData());
+    (void) memcpy(&_tileInfo, byteArray.constData(), sizeof(TileInfo_t));
 
     // Check feasibility
     if ((_tileInfo.neLon - _tileInfo.swLon) < 0.0 || (_tileInfo.neLat - _tileInfo.swLat) < 0.0) {
         qCWarning(TerrainTileLog) << this << "Tile extent is infeasible";
-        _isValid = false;
+        return;
+    }
+    if (_tileInfo.gridSizeLat <= 0 || _tileInfo.gridSizeLon <= 0) {
+        qCWarning(TerrainTileLog) << this << "Tile grid is empty";
         return;
     }
 
@@ -39,32 +54,19 @@ TerrainTile::TerrainTile(const QByteArray& byteArray)
     qCDebug(TerrainTileLog) << this << "TileInfo: min, max, avg: " << _tileInfo.minElevation << _tileInfo.maxElevation << _tileInfo.avgElevation;
     qCDebug(TerrainTileLog) << this << "TileInfo: cell size:     " << _cellSizeLat << _cellSizeLon;
 
-    int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
-    int cTileBytesAvailable = byteArray.size();
-
-    if (cTileBytesAvailable < cTileHeaderBytes) {
-        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for TileInfo_s header";
-        return;
-    }
-
-    int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _tileInfo.gridSizeLat * _tileInfo.gridSizeLon;
+    const int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _tileInfo.gridSizeLat * _tileInfo.gridSizeLon;
     if (cTileBytesAvailable < cTileHeaderBytes + cTileDataBytes) {
         qCWarning(TerrainTileLog) << "Terrain tile binary data too small for tile data";
         return;
     }
 
-    _elevationData.resize(_tileInfo.gridSizeLat);
-    for (int k = 0; k < _tileInfo.gridSizeLat; k++) {
-        _elevationData[k].resize(_tileInfo.gridSizeLon);
-    }
-
-    int valueIndex = 0;
-    const int16_t* pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _tileInfo.gridSizeLat; i++) {
-        for (int j = 0; j < _tileInfo.gridSizeLon; j++) {
-            _elevationData[i][j] = pTileData[valueIndex++];
-        }
+    // Keep a shallow copy of the serialized tile and read the grid from it in place. The header size is a
+    // multiple of 8 so the grid is suitably aligned unless the caller handed us raw data at an odd address.
+    _tileData = byteArray;
+    if ((reinterpret_cast<quintptr>(_tileData.constData()) % alignof(int16_t)) != 0) {
+        _tileData = QByteArray(byteArray.constData(), byteArray.size());
     }
+    _elevationData = reinterpret_cast<const int16_t*>(_tileData.constData() + cTileHeaderBytes);
 
     _isValid = true;
 }
@@ -81,41 +83,83 @@ double TerrainTile::elevation(const QGeoCoordinate& coordinate) const
         return qQNaN();
     }
 
-    const double latDeltaSw = coordinate.latitude() - _tileInfo.swLat;
-    const double lonDeltaSw = coordinate.longitude() - _tileInfo.swLon;
+    const double latitude = coordinate.latitude();
+    const double longitude = coordinate.longitude();
+    double elevation;
+    elevations(&latitude, &longitude, &elevation, 1);
 
-    const int16_t latIndex = qFloor(latDeltaSw / _cellSizeLat);
-    const int16_t lonIndex = qFloor(lonDeltaSw / _cellSizeLon);
-
-    const bool latIndexInvalid = latIndex < 0 || latIndex > (_tileInfo.gridSizeLat - 1);
-    const bool lonIndexInvalid = lonIndex < 0 || lonIndex > (_tileInfo.gridSizeLon - 1);
-
-    if (latIndexInvalid || lonIndexInvalid) {
+    if (qIsNaN(elevation)) {
         qCWarning(TerrainTileLog) << this << "Internal error: coordinate" << coordinate << "outside tile bounds";
-        return qQNaN();
     }
 
-    if (latIndex >= _elevationData.size() || lonIndex >= _elevationData[latIndex].size()) {
-        qCWarning(TerrainTileLog).noquote() << this << "Internal error: _elevationData size inconsistent _tileInfo << coordinate" << coordinate 
-            << "\n\t_tillIndo.gridSizeLat: " << _tileInfo.gridSizeLat << " _tileInfo.gridSizeLon: " << _tileInfo.gridSizeLon
-            << "\n\t_data.size(): " << _elevationData.size() << " _elevationData[latIndex].size(): " << _elevationData[latIndex].size();
-        return qQNaN();
-    }
-    const auto elevation = _elevationData[latIndex][lonIndex];
+#ifdef QT_DEBUG
+    qCDebug(TerrainTileLog) << this << "coordinate:" << coordinate << "elevation:" << elevation;
+#endif
+
+    return elevation;
+}
 
-    // Print warning if elevation is outside min/max of tile meta data
-    if (elevation < _tileInfo.minElevation) {
-        qCWarning(TerrainTileLog) << this << "Warning: elevation read is below min elevation in tile:" << elevation << "<" << _tileInfo.minElevation;
+void TerrainTile::elevations(const double* latitudes, const double* longitudes, double* elevations, qsizetype count) const
+{
+    if (!_isValid) {
+        std::fill(elevations, elevations + count, qQNaN());
+        return;
     }
-    else if (elevation > _tileInfo.maxElevation) {
-        qCWarning(TerrainTileLog) << this << "Warning: elevation read is above max elevation in tile:" << elevation << ">" << _tileInfo.maxElevation;
+
+    const int16_t* const grid = _elevationData;
+    const int rows = _tileInfo.gridSizeLat;
+    const int cols = _tileInfo.gridSizeLon;
+    const double maxRow = rows - 1;
+    const double maxCol = cols - 1;
+    const double swLat = _tileInfo.swLat;
+    const double swLon = _tileInfo.swLon;
+    const double latScale = 1.0 / _cellSizeLat;
+    const double lonScale = 1.0 / _cellSizeLon;
+    const double nan = qQNaN();
+
+    for (qsizetype i = 0; i < count; i++) {
+        // Position in cell units from the south west corner
+        const double latPos = (latitudes[i] - swLat) * latScale;
+        const double lonPos = (longitudes[i] - swLon) * lonScale;
+        const bool inside = (latPos >= 0.0) & (latPos <= rows) & (lonPos >= 0.0) & (lonPos <= cols);
+
+        // Values sit at cell centers, clamp to the outer ring of centers. Note the argument order
+        // of std::max which also maps NaN to 0 so the indices below are always in range.
+        const double y = std::min(std::max(0.0, latPos - 0.5), maxRow);
+        const double x = std::min(std::max(0.0, lonPos - 0.5), maxCol);
+        const int row0 = static_cast<int>(y);
+        const int col0 = static_cast<int>(x);
+        const int row1 = std::min(row0 + 1, rows - 1);
+        const int col1 = std::min(col0 + 1, cols - 1);
+        const double fy = y - row0;
+        const double fx = x - col0;
+
+        const double v00 = grid[row0 * cols + col0];
+        const double v01 = grid[row0 * cols + col1];
+        const double v10 = grid[row1 * cols + col0];
+        const double v11 = grid[row1 * cols + col1];
+
+        const double south = v00 + (v01 - v00) * fx;
+        const double north = v10 + (v11 - v10) * fx;
+        const double elevation = south + (north - south) * fy;
+
+        elevations[i] = inside ? elevation : nan;
     }
+}
 
-#ifdef QT_DEBUG
-    qCDebug(TerrainTileLog) << this << "latIndex, lonIndex:" << latIndex << lonIndex << "elevation:" << elevation;
-#endif
+QList<double> TerrainTile::elevations(const QList<QGeoCoordinate>& coordinates) const
+{
+    const qsizetype count = coordinates.count();
+    std::vector<double> latitudes(count);
+    std::vector<double> longitudes(count);
+    for (qsizetype i = 0; i < count; i++) {
+        latitudes[i] = coordinates[i].latitude();
+        longitudes[i] = coordinates[i].longitude();
+    }
 
-    return static_cast<double>(elevation);
+    QList<double> result(count);
+    elevations(latitudes.data(), longitudes.data(), result.data(), count);
+    return result;
 }
 
 QByteArray TerrainTile::serializeFromAirMapJson(const QByteArray& input)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QtPositioning/QGeoCoordinate>
+#include <QtCore/QByteArray>
 #include <QtCore/QList>
 #include <QtCore/QLoggingCategory>
 
@@ -19,7 +20,8 @@ public:
     ~TerrainTile();
 
     /**
-    * Constructor from serialized elevation data (either from file or web)
+    * Constructor from serialized elevation data (either from file or web). The elevation grid
+    * is read in place from the byte array, which is implicitly shared rather than copied.
     *
     * @param document
     */
@@ -32,14 +34,42 @@ public:
     */
     bool isValid(void) const { return _isValid; }
 
+    /**
+    * Size of the serialized tile data held by this tile
+    */
+    qsizetype dataSize(void) const { return _tileData.size(); }
+
+    /**
+    * Check whether the coordinate falls within the tile bounds
+    */
+    bool contains(double latitude, double longitude) const {
+        return _isValid && latitude >= _tileInfo.swLat && latitude <= _tileInfo.neLat && longitude >= _tileInfo.swLon && longitude <= _tileInfo.neLon;
+    }
+
     /**
     * Evaluates the elevation at the given coordinate
     *
     * @param coordinate
-    * @return elevation
+    * @return elevation, NaN if outside of tile
     */
     double elevation(const QGeoCoordinate& coordinate) const;
 
+    /**
+    * Evaluates the elevations for a batch of coordinates using bilinear interpolation between
+    * the grid values, which are taken to be at the center of their cells. Latitudes and longitudes
+    * are passed as separate arrays so the loop is free of calls and branches and can be vectorized.
+    *
+    * @param latitudes Array of count latitudes
+    * @param longitudes Array of count longitudes
+    * @param[out] elevations Array of count elevations, NaN for coordinates outside of the tile
+    */
+    void elevations(const double* latitudes, const double* longitudes, double* elevations, qsizetype count) const;
+
+    /**
+    * Convenience overload of elevations for a list of coordinates
+    */
+    QList<double> elevations(const QList<QGeoCoordinate>& coordinates) const;
+
     /**
     * Accessor for the minimum elevation of the tile
     *
@@ -83,11 +113,12 @@ private:
         int16_t gridSizeLon;
     } TileInfo_t;
 
-    TileInfo_t              _tileInfo;
-    QList<QList<int16_t>>   _elevationData; // 2D elevation data array
-    double                  _cellSizeLat;   /// data grid size in latitude direction
-    double                  _cellSizeLon;   /// data grid size in longitude direction
-    bool                    _isValid;       /// data loaded is valid
+    TileInfo_t              _tileInfo{};
+    QByteArray              _tileData;                  ///< Serialized tile, shared with the caller
+    const int16_t*          _elevationData  = nullptr;  ///< Row major grid of gridSizeLat x gridSizeLon values, points into _tileData
+    double                  _cellSizeLat    = 0;        ///< data grid size in latitude direction
+    double                  _cellSizeLon    = 0;        ///< data grid size in longitude direction
+    bool                    _isValid        = false;    ///< data loaded is valid
 
     // Json keys
     static constexpr const char*  _jsonStatusKey        = "status";
@@ -0,0 +1,132 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileCache.h"
+#include "QGCLoggingCategory.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+QGC_LOGGING_CATEGORY(TerrainTileCacheLog, "qgc.terrain.terraintilecache")
+
+TerrainTileCache::TerrainTileCache(qint64 maxBytes)
+    : _maxBytes(maxBytes)
+{
+
+}
+
+qint64 TerrainTileCache::_tileBytes(const TerrainTile& tile)
+{
+    return static_cast<qint64>(sizeof(TerrainTile)) + tile.dataSize();
+}
+
+TerrainTileCache::SharedTile TerrainTileCache::find(quint64 key)
+{
+    Shard& shard = _shard(key);
+    QReadLocker locker(&shard.lock);
+
+    const auto it = shard.entries.constFind(key);
+    if (it == shard.entries.constEnd()) {
+        _missCount++;
+        return nullptr;
+    }
+
+    _hitCount++;
+    it.value()->lastAccess.store(++_accessTick, std::memory_order_relaxed);
+    return it.value()->tile;
+}
+
+bool TerrainTileCache::contains(quint64 key) const
+{
+    const Shard& shard = _shard(key);
+    QReadLocker locker(&shard.lock);
+    return shard.entries.contains(key);
+}
+
+void TerrainTileCache::insert(quint64 key, const TerrainTile& tile)
+{
+    const qint64 bytes = _tileBytes(tile);
+    auto entry = std::make_shared<Entry>(std::make_shared<const TerrainTile>(tile), bytes, ++_accessTick);
+
+    Shard& shard = _shard(key);
+    QWriteLocker locker(&shard.lock);
+
+    const auto it = shard.entries.constFind(key);
+    if (it != shard.entries.constEnd()) {
+        shard.bytes -= it.value()->bytes;
+        _totalBytes -= it.value()->bytes;
+    }
+    shard.entries.insert(key, entry);
+    shard.bytes += bytes;
+    _totalBytes += bytes;
+
+    if (shard.bytes > (_maxBytes / _shardCount)) {
+        _evict(shard);
+    }
+}
+
+void TerrainTileCache::_evict(Shard& shard)
+{
+    // Evict down to 3/4 of the shard budget so we don't have to scan the shard on every insert
+    const qint64 lowWater = ((_maxBytes / _shardCount) * 3) / 4;
+
+    std::vector<std::pair<quint64, quint64>> byAge;    // (lastAccess, key)
+    byAge.reserve(shard.entries.size());
+    for (auto it = shard.entries.constBegin(); it != shard.entries.constEnd(); it++) {
+        byAge.emplace_back(it.value()->lastAccess.load(std::memory_order_relaxed), it.key());
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    int evicted = 0;
+    for (const auto& ageKey: byAge) {
+        if (shard.bytes <= lowWater) {
+            break;
+        }
+        const auto it = shard.entries.constFind(ageKey.second);
+        shard.bytes -= it.value()->bytes;
+        _totalBytes -= it.value()->bytes;
+        shard.entries.erase(it);
+        evicted++;
+    }
+
+    _evictionCount += evicted;
+    qCDebug(TerrainTileCacheLog) << "Evicted" << evicted << "tiles, total bytes" << _totalBytes.load() << "hits" << _hitCount.load() << "misses" << _missCount.load();
+}
+
+void TerrainTileCache::setMaxBytes(qint64 maxBytes)
+{
+    _maxBytes = maxBytes;
+    for (Shard& shard: _shards) {
+        QWriteLocker locker(&shard.lock);
+        if (shard.bytes > (_maxBytes / _shardCount)) {
+            _evict(shard);
+        }
+    }
+}
+
+void TerrainTileCache::clear()
+{
+    for (Shard& shard: _shards) {
+        QWriteLocker locker(&shard.lock);
+        _totalBytes -= shard.bytes;
+        shard.bytes = 0;
+        shard.entries.clear();
+    }
+}
+
+int TerrainTileCache::tileCount() const
+{
+    int count = 0;
+    for (const Shard& shard: _shards) {
+        QReadLocker locker(&shard.lock);
+        count += shard.entries.count();
+    }
+    return count;
+}
@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "TerrainTile.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QReadWriteLock>
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainTileCacheLog)
+
+/// Bounded in-memory cache of decoded terrain tiles keyed by a packed integer tile id.
+///
+/// The cache is split into shards, each with its own read/write lock, so lookups for different
+/// tiles don't contend and lookups for the same tile only take a shared lock. Recency is tracked
+/// with an atomic access tick per entry which lookups can bump under the shared lock. Once a shard
+/// goes over its share of the byte budget the least recently used tiles are evicted in one batch.
+///
+/// Tiles are handed out as shared pointers so a caller can keep using a tile after it is evicted.
+class TerrainTileCache
+{
+public:
+    typedef std::shared_ptr<const TerrainTile> SharedTile;
+
+    TerrainTileCache(qint64 maxBytes = defaultMaxBytes);
+
+    /// Packs tile x/y/zoom into a single key. x and y must fit into 24 bits.
+    static quint64 tileKey(int x, int y, int zoom) {
+        return (static_cast<quint64>(zoom & 0xFFFF) << 48) | (static_cast<quint64>(x & 0xFFFFFF) << 24) | static_cast<quint64>(y & 0xFFFFFF);
+    }
+    static int tileX(quint64 key) { return static_cast<int>((key >> 24) & 0xFFFFFF); }
+    static int tileY(quint64 key) { return static_cast<int>(key & 0xFFFFFF); }
+
+    /// @return nullptr if the tile is not in the cache
+    SharedTile find(quint64 key);
+
+    /// Adds the tile to the cache, replacing an existing entry for the same key
+    void insert(quint64 key, const TerrainTile& tile);
+
+    bool contains(quint64 key) const;
+    void clear();
+
+    qint64 maxBytes() const { return _maxBytes; }
+    void setMaxBytes(qint64 maxBytes);
+
+    quint64 hitCount() const        { return _hitCount; }
+    quint64 missCount() const       { return _missCount; }
+    quint64 evictionCount() const   { return _evictionCount; }
+    qint64  totalBytes() const      { return _totalBytes; }
+    int     tileCount() const;
+
+    static constexpr qint64 defaultMaxBytes = 64 * 1024 * 1024;
+
+private:
+    struct Entry {
+        Entry(const SharedTile& tile_, qint64 bytes_, quint64 tick)
+            : tile(tile_), bytes(bytes_), lastAccess(tick) {}
+
+        SharedTile                  tile;
+        qint64                      bytes;
+        std::atomic<quint64>        lastAccess;
+    };
+
+    struct Shard {
+        mutable QReadWriteLock                      lock;
+        QHash<quint64, std::shared_ptr<Entry>>      entries;
+        qint64                                      bytes = 0;
+    };
+
+    Shard& _shard(quint64 key) { return _shards[qHash(key) % _shardCount]; }
+    const Shard& _shard(quint64 key) const { return _shards[qHash(key) % _shardCount]; }
+
+    /// Evicts least recently used entries until the shard is below its low water mark. Must be called with the shard write locked.
+    void _evict(Shard& shard);
+
+    static qint64 _tileBytes(const TerrainTile& tile);
+
+    static constexpr int            _shardCount = 16;
+    std::array<Shard, _shardCount>  _shards;
+    std::atomic<qint64>             _maxBytes;
+    std::atomic<quint64>            _accessTick     {0};
+    std::atomic<quint64>            _hitCount       {0};
+    std::atomic<quint64>            _missCount      {0};
+    std::atomic<quint64>            _evictionCount  {0};
+    std::atomic<qint64>             _totalBytes     {0};
+};
@@ -20,6 +20,9 @@
 #include <QtNetwork/QNetworkProxy>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
+#include <QtCore/QtMath>
+
+#include <vector>
 
 QGC_LOGGING_CATEGORY(TerrainTileManagerLog, "qgc.terrain.terraintilemanager")
 
@@ -59,9 +62,8 @@ void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQu
         QList<double> altitudes;
 
         if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
-            qCDebug(TerrainTileManagerLog) << "TerrainTileManager::addPathQuery queue count" << _requestQueue.count();
-            QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModeCoordinates, 0, 0, coordinates };
-            _requestQueue.append(queuedRequestInfo);
+            qCDebug(TerrainTileManagerLog) << "TerrainTileManager::addCoordinateQuery queue count" << _requestQueue.count();
+            _queueRequest(terrainQueryInterface, QueryMode::QueryModeCoordinates, 0, 0, coordinates);
             return;
         }
 
@@ -120,8 +122,7 @@ void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInt
     QList<double> altitudes;
     if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
         qCDebug(TerrainTileManagerLog) << "TerrainTileManager::addPathQuery queue count" << _requestQueue.count();
-        QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModePath, distanceBetween, finalDistanceBetween, coordinates };
-        _requestQueue.append(queuedRequestInfo);
+        _queueRequest(terrainQueryInterface, QueryMode::QueryModePath, distanceBetween, finalDistanceBetween, coordinates);
         return;
     }
 
@@ -142,61 +143,117 @@ bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate>&
 {
     error = false;
 
-    for (const QGeoCoordinate& coordinate: coordinates) {
-        QString tileHash = _getTileHash(coordinate);
-        qCDebug(TerrainTileManagerLog) << "TerrainTileManager::getAltitudesForCoordinates hash:coordinate" << tileHash << coordinate;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<double> elevations;
+    latitudes.reserve(coordinates.count());
+    longitudes.reserve(coordinates.count());
+    altitudes.reserve(altitudes.count() + coordinates.count());
+
+    qsizetype runStart = 0;
+    while (runStart < coordinates.count()) {
+        const QGeoCoordinate& coordinate = coordinates[runStart];
+        const quint64 tileKey = _getTileKey(coordinate);
+        qCDebug(TerrainTileManagerLog) << "TerrainTileManager::getAltitudesForCoordinates key:coordinate" << tileKey << coordinate;
+
+        // Holding on to the shared tile keeps it alive even if it is evicted while we use it
+        const TerrainTileCache::SharedTile sharedTile = _tileCache.find(tileKey);
+        if (!sharedTile) {
+            // Request every missing tile for the remaining coordinates at once instead of finding
+            // them one round trip at a time.
+            const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
+            quint64 lastKey = 0;
+            for (qsizetype i = runStart; i < coordinates.count(); i++) {
+                const int x = provider->long2tileX(coordinates[i].longitude(), 1);
+                const int y = provider->lat2tileY(coordinates[i].latitude(), 1);
+                const quint64 key = TerrainTileCache::tileKey(x, y, 1);
+                if ((i == runStart) || (key != lastKey)) {
+                    _fetchTile(x, y);
+                    lastKey = key;
+                }
+            }
+
+            return false;
+        }
+        const TerrainTile& tile = *sharedTile;
+
+        // Paths and survey grids are spatially coherent, so gather the run of coordinates which fall in
+        // this tile and look them all up in one batch instead of hashing each coordinate.
+        latitudes.clear();
+        longitudes.clear();
+        qsizetype runEnd = runStart;
+        while (runEnd < coordinates.count()) {
+            const double latitude = coordinates[runEnd].latitude();
+            const double longitude = coordinates[runEnd].longitude();
+            if ((runEnd != runStart) && !tile.contains(latitude, longitude)) {
+                break;
+            }
+            latitudes.push_back(latitude);
+            longitudes.push_back(longitude);
+            runEnd++;
+        }
+
+        elevations.resize(latitudes.size());
+        tile.elevations(latitudes.data(), longitudes.data(), elevations.data(), static_cast<qsizetype>(elevations.size()));
 
-        _tilesMutex.lock();
-        if (_tiles.contains(tileHash)) {
-            double elevation = _tiles[tileHash].elevation(coordinate);
+        for (const double elevation: elevations) {
             if (qIsNaN(elevation)) {
                 error = true;
-                qCWarning(TerrainTileManagerLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
-            } else {
-                qCDebug(TerrainTileManagerLog) << "TerrainTileManager::getAltitudesForCoordinates returning elevation from tile cache" << elevation;
             }
             altitudes.push_back(elevation);
+        }
+        if (error) {
+            qCWarning(TerrainTileManagerLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
         } else {
-            if (_state != State::Downloading) {
-                const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
-                QGeoTileSpec spec;
-                spec.setX(provider->long2tileX(coordinate.longitude(), 1));
-                spec.setY(provider->lat2tileY(coordinate.latitude(), 1));
-                spec.setZoom(1);
-                spec.setMapId(provider->getMapId());
-                const QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(spec.mapId(), spec.x(), spec.y(), spec.zoom());
-                QGeoTiledMapReplyQGC * const reply = new QGeoTiledMapReplyQGC(_networkManager, request, spec);
-                (void) connect(reply, &QGeoTiledMapReplyQGC::finished, this, &TerrainTileManager::_terrainDone);
-                _state = State::Downloading;
-            }
-            _tilesMutex.unlock();
-
-            return false;
+            qCDebug(TerrainTileManagerLog) << "TerrainTileManager::getAltitudesForCoordinates returning" << elevations.size() << "elevations from tile cache";
         }
-        _tilesMutex.unlock();
+
+        runStart = runEnd;
     }
 
     return true;
 }
 
-void TerrainTileManager::_tileFailed(void)
+void TerrainTileManager::_queueRequest(TerrainOfflineAirMapQuery* terrainQueryInterface, QueryMode queryMode, double distanceBetween, double finalDistanceBetween, const QList<QGeoCoordinate>& coordinates)
+{
+    const QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, queryMode, distanceBetween, finalDistanceBetween, coordinates, _tileKeysForCoordinates(coordinates) };
+    _requestQueue.append(queuedRequestInfo);
+}
+
+QSet<quint64> TerrainTileManager::_tileKeysForCoordinates(const QList<QGeoCoordinate>& coordinates)
+{
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
+
+    QSet<quint64> tileKeys;
+    for (const QGeoCoordinate& coordinate: coordinates) {
+        (void) tileKeys.insert(TerrainTileCache::tileKey(provider->long2tileX(coordinate.longitude(), 1), provider->lat2tileY(coordinate.latitude(), 1), 1));
+    }
+
+    return tileKeys;
+}
+
+/// Fails the queued requests which need the tile, requests waiting on other tiles stay queued
+void TerrainTileManager::_tileFailed(quint64 tileKey)
 {
     QList<double> noAltitudes;
 
-    for (const QueuedRequestInfo_t& requestInfo: _requestQueue) {
+    for (int i = _requestQueue.count() - 1; i >= 0; i--) {
+        const QueuedRequestInfo_t& requestInfo = _requestQueue[i];
+        if (!requestInfo.tileKeys.contains(tileKey)) {
+            continue;
+        }
         if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
             requestInfo.terrainQueryInterface->_signalCoordinateHeights(false, noAltitudes);
         } else if (requestInfo.queryMode == QueryMode::QueryModePath) {
             requestInfo.terrainQueryInterface->_signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
         }
+        _requestQueue.removeAt(i);
     }
-    _requestQueue.clear();
 }
 
 void TerrainTileManager::_terrainDone()
 {
     QGeoTiledMapReplyQGC* reply = qobject_cast<QGeoTiledMapReplyQGC*>(QObject::sender());
-    _state = State::Idle;
 
     if (!reply) {
         qCWarning(TerrainTileManagerLog) << "Elevation tile fetched but invalid reply data type.";
@@ -207,42 +264,75 @@ void TerrainTileManager::_terrainDone()
     // remove from download queue
     const QByteArray responseBytes = reply->mapImageData();
     const QGeoTileSpec spec = reply->tileSpec();
-    const QString hash = UrlFactory::getTileHash(kMapType, spec.x(), spec.y(), spec.zoom());
+    const quint64 tileKey = TerrainTileCache::tileKey(spec.x(), spec.y(), spec.zoom());
+
+    _activeDownloads--;
+    (void) _requestedTiles.remove(tileKey);
+    while (!_tileFetchQueue.isEmpty() && (_activeDownloads < _maxConcurrentDownloads)) {
+        const QPoint tile = _tileFetchQueue.dequeue();
+        _startTileDownload(tile.x(), tile.y());
+    }
 
     // handle potential errors
     if (reply->error() != QGeoTiledMapReplyQGC::NoError) {
         qCWarning(TerrainTileManagerLog) << "Elevation tile fetching returned error (" << reply->error() << ")";
-        _tileFailed();
+        _tileFailed(tileKey);
         return;
     }
     if (responseBytes.isEmpty()) {
         qCWarning(TerrainTileManagerLog) << "Error in fetching elevation tile. Empty response.";
-        _tileFailed();
+        _tileFailed(tileKey);
         return;
     }
 
     qCDebug(TerrainTileManagerLog) << "Received some bytes of terrain data:" << responseBytes.size();
 
-    TerrainTile* terrainTile = new TerrainTile(responseBytes);
-    if (terrainTile->isValid()) {
-        _tilesMutex.lock();
-        if (!_tiles.contains(hash)) {
-            _tiles.insert(hash, *terrainTile);
-        } else {
-            delete terrainTile;
+    const TerrainTile terrainTile(responseBytes);
+    if (terrainTile.isValid()) {
+        if (!_tileCache.contains(tileKey)) {
+            _tileCache.insert(tileKey, terrainTile);
         }
-        _tilesMutex.unlock();
     } else {
-        delete terrainTile;
         qCWarning(TerrainTileManagerLog) << "Received invalid tile";
+        _tileFailed(tileKey);
+        return;
+    }
+
+    // Answer the waiting queries which now have all their tiles, the rest keep waiting on their own downloads
+    _retryQueuedRequests();
+}
+
+/// @return true: All tiles needed by the request are cached. Tiles which were evicted while the
+///               request waited are fetched again.
+bool TerrainTileManager::_requestTilesReady(const QueuedRequestInfo_t& requestInfo)
+{
+    bool ready = true;
+
+    for (const quint64 tileKey: requestInfo.tileKeys) {
+        if (_tileCache.contains(tileKey)) {
+            continue;
+        }
+        ready = false;
+        if (!_requestedTiles.contains(tileKey)) {
+            _fetchTile(TerrainTileCache::tileX(tileKey), TerrainTileCache::tileY(tileKey));
+        }
     }
 
+    return ready;
+}
+
+void TerrainTileManager::_retryQueuedRequests(void)
+{
     // now try to query the data again
     for (int i = _requestQueue.count() - 1; i >= 0; i--) {
         bool error;
         QList<double> altitudes;
         QueuedRequestInfo_t& requestInfo = _requestQueue[i];
 
+        if (!_requestTilesReady(requestInfo)) {
+            continue;
+        }
+
         if (getAltitudesForCoordinates(requestInfo.coordinates, altitudes, error)) {
             if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
                 if (error) {
@@ -268,17 +358,106 @@ void TerrainTileManager::_terrainDone()
     }
 }
 
-QString TerrainTileManager::_getTileHash(const QGeoCoordinate &coordinate)
+/// Queues the tile for download unless it is already cached or requested
+void TerrainTileManager::_fetchTile(int x, int y)
+{
+    const quint64 tileKey = TerrainTileCache::tileKey(x, y, 1);
+    if (_requestedTiles.contains(tileKey) || _tileCache.contains(tileKey)) {
+        return;
+    }
+    _requestedTiles.insert(tileKey);
+
+    if (_activeDownloads < _maxConcurrentDownloads) {
+        _startTileDownload(x, y);
+    } else {
+        _tileFetchQueue.enqueue(QPoint(x, y));
+    }
+}
+
+void TerrainTileManager::_startTileDownload(int x, int y)
+{
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
+    QGeoTileSpec spec;
+    spec.setX(x);
+    spec.setY(y);
+    spec.setZoom(1);
+    spec.setMapId(provider->getMapId());
+    const QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(spec.mapId(), spec.x(), spec.y(), spec.zoom());
+    QGeoTiledMapReplyQGC * const reply = new QGeoTiledMapReplyQGC(_networkManager, request, spec);
+    (void) connect(reply, &QGeoTiledMapReplyQGC::finished, this, &TerrainTileManager::_terrainDone);
+    _activeDownloads++;
+
+    qCDebug(TerrainTileManagerLog) << "Downloading tile" << x << y << "active:queued" << _activeDownloads << _tileFetchQueue.count();
+}
+
+void TerrainTileManager::prefetchPath(const QList<QGeoCoordinate>& path, double bufferMeters)
+{
+    const QList<QPoint> tiles = tilesForPath(path, bufferMeters);
+    qCDebug(TerrainTileManagerLog) << "prefetchPath path points:tiles" << path.count() << tiles.count();
+
+    for (const QPoint& tile: tiles) {
+        _fetchTile(tile.x(), tile.y());
+    }
+}
+
+QList<QPoint> TerrainTileManager::tilesForPath(const QList<QGeoCoordinate>& path, double bufferMeters)
+{
+    static constexpr double metersPerDegreeLat = 111320.0;
+
+    QList<QPoint> tiles;
+    QSet<quint64> tileKeys;
+
+    if (path.isEmpty()) {
+        return tiles;
+    }
+
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
+
+    // Each sample covers a box of the buffer plus half the sample spacing, so the boxes of
+    // neighbouring samples overlap and no tile along the segment is missed.
+    const double halfBoxMeters = bufferMeters + (_corridorSampleMeters / 2.0);
+    auto addSample = [&](const QGeoCoordinate& sample) {
+        const double latDelta = halfBoxMeters / metersPerDegreeLat;
+        const double lonDelta = halfBoxMeters / (metersPerDegreeLat * qMax(qCos(qDegreesToRadians(sample.latitude())), 0.01));
+        const int x0 = provider->long2tileX(sample.longitude() - lonDelta, 1);
+        const int x1 = provider->long2tileX(sample.longitude() + lonDelta, 1);
+        const int y0 = provider->lat2tileY(sample.latitude() - latDelta, 1);
+        const int y1 = provider->lat2tileY(sample.latitude() + latDelta, 1);
+        for (int x = x0; x <= x1; x++) {
+            for (int y = y0; y <= y1; y++) {
+                const quint64 key = TerrainTileCache::tileKey(x, y, 1);
+                if (!tileKeys.contains(key)) {
+                    tileKeys.insert(key);
+                    tiles.append(QPoint(x, y));
+                }
+            }
+        }
+    };
+
+    addSample(path.first());
+    for (qsizetype i = 1; i < path.count(); i++) {
+        const QGeoCoordinate& from = path[i - 1];
+        const QGeoCoordinate& to = path[i];
+        const int steps = qMax(1, qCeil(from.distanceTo(to) / _corridorSampleMeters));
+        for (int step = 1; step <= steps; step++) {
+            const double fraction = static_cast<double>(step) / steps;
+            addSample(QGeoCoordinate(from.latitude() + ((to.latitude() - from.latitude()) * fraction), from.longitude() + ((to.longitude() - from.longitude()) * fraction)));
+        }
+    }
+
+    return tiles;
+}
+
+quint64 TerrainTileManager::_getTileKey(const QGeoCoordinate &coordinate)
 {
     const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
 
-    const QString result = UrlFactory::getTileHash(
-        provider->getMapName(),
+    const quint64 result = TerrainTileCache::tileKey(
         provider->long2tileX(coordinate.longitude(), 1),
         provider->lat2tileY(coordinate.latitude(), 1),
         1
     );
 
-    qCDebug(TerrainQueryVerboseLog) << "Computing unique tile hash for" << coordinate << result;
+    qCDebug(TerrainQueryVerboseLog) << "Computing unique tile key for" << coordinate << result;
     return result;
 }
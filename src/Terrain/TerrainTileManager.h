@@ -10,12 +10,15 @@
 #pragma once
 
 #include "TerrainTile.h"
+#include "TerrainTileCache.h"
 
 #include <QtCore/QObject>
+#include <QtCore/QPoint>
+#include <QtCore/QQueue>
+#include <QtCore/QSet>
 #include <QtPositioning/QGeoCoordinate>
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
-#include <QtCore/QMutex>
 #include <QtCore/QLoggingCategory>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileManagerLog)
@@ -34,6 +37,18 @@ public:
     void addPathQuery               (TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& startPoint, const QGeoCoordinate& endPoint);
     bool getAltitudesForCoordinates (const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error);
 
+    /// Starts downloading all tiles which cover the path plus bufferMeters to either side. Tiles are fetched
+    /// in parallel, each query waiting on tiles is answered as soon as the last tile it needs is in.
+    void prefetchPath               (const QList<QGeoCoordinate>& path, double bufferMeters = defaultPrefetchBufferMeters);
+
+    /// @return x/y of the tiles which cover the path plus bufferMeters to either side
+    static QList<QPoint> tilesForPath(const QList<QGeoCoordinate>& path, double bufferMeters);
+
+    static constexpr double defaultPrefetchBufferMeters = 100;
+
+    /// Decoded tiles held in memory, exposes hit/miss/eviction counters
+    const TerrainTileCache& tileCache() const { return _tileCache; }
+
     static TerrainTileManager* instance();
     static QList<QGeoCoordinate> pathQueryToCoords(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double& distanceBetween, double& finalDistanceBetween);
 
@@ -41,11 +56,6 @@ private slots:
     void _terrainDone();
 
 private:
-    enum class State {
-        Idle,
-        Downloading,
-    };
-
     enum QueryMode {
         QueryModeCoordinates,
         QueryModePath,
@@ -58,15 +68,27 @@ private:
         double                      distanceBetween;        // Distance between each returned height
         double                      finalDistanceBetween;   // Distance between for final height
         QList<QGeoCoordinate>       coordinates;
+        QSet<quint64>               tileKeys;               // Tiles needed to answer the request
     } QueuedRequestInfo_t;
 
-    void    _tileFailed                         (void);
-    QString _getTileHash                        (const QGeoCoordinate& coordinate);
+    void    _queueRequest                       (TerrainOfflineAirMapQuery* terrainQueryInterface, QueryMode queryMode, double distanceBetween, double finalDistanceBetween, const QList<QGeoCoordinate>& coordinates);
+    void    _tileFailed                         (quint64 tileKey);
+    void    _retryQueuedRequests                (void);
+    bool    _requestTilesReady                  (const QueuedRequestInfo_t& requestInfo);
+    static QSet<quint64> _tileKeysForCoordinates(const QList<QGeoCoordinate>& coordinates);
+    void    _fetchTile                          (int x, int y);
+    void    _startTileDownload                  (int x, int y);
+    quint64 _getTileKey                         (const QGeoCoordinate& coordinate);
 
     QList<QueuedRequestInfo_t>  _requestQueue;
-    State                       _state = State::Idle;
     QNetworkAccessManager*      _networkManager = nullptr;
 
-    QMutex                      _tilesMutex;
-    QHash<QString, TerrainTile> _tiles;
+    QSet<quint64>               _requestedTiles;        ///< Tiles being downloaded or waiting in _tileFetchQueue
+    QQueue<QPoint>              _tileFetchQueue;        ///< Tiles waiting for a free download slot
+    int                         _activeDownloads = 0;
+
+    static constexpr int        _maxConcurrentDownloads = 4;
+    static constexpr double     _corridorSampleMeters   = 250;  ///< Spacing of samples along path, well below tile size
+
+    TerrainTileCache            _tileCache;
 };
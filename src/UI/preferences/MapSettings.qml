@@ -210,6 +210,10 @@ Item {
             LabelledFactTextField {
                 fact: _mapsSettings.maxCacheMemorySize
             }    
+
+            LabelledFactTextField {
+                fact: _mapsSettings.maxConcurrentTileDownloads
+            }
         }
 
         QGCFileDialog {
@@ -30,6 +30,8 @@ SettingsPage {
     property bool   _isAPM:                     _activeVehicle ? _activeVehicle.apmFirmware : true
     property bool   _showAPMStreamRates:        QGroundControl.apmFirmwareSupported && _settingsManager.apmMavlinkStreamRateSettings.visible && _isAPM
     property var     _apmStartMavlinkStreams:   _appSettings.apmStartMavlinkStreams
+    property var    _logWriter:                 QGroundControl.mavlinkLogWriter
+    property var    _mavlinkProtocol:           QGroundControl.mavlinkProtocol
 
     SettingsGroupLayout {
         Layout.fillWidth:   true
@@ -67,6 +69,27 @@ SettingsPage {
             checked:            QGroundControl.isVersionCheckEnabled
             onClicked:          QGroundControl.isVersionCheckEnabled = checked
         }
+
+        FactCheckBoxSlider {
+            Layout.fillWidth:   true
+            text:               qsTr("Process MAVLink on separate thread")
+            fact:               _appSettings.mavlinkProtocolThread
+            visible:            fact.visible
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Message latency (median / 99%)")
+            labelText:          _mavlinkProtocol.latencySampleCount ?
+                                    qsTr("%1 / %2 ms").arg((_mavlinkProtocol.latencyP50Usecs / 1000).toFixed(1)).arg((_mavlinkProtocol.latencyP99Usecs / 1000).toFixed(1)) :
+                                    _notConnectedStr
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Message latency (max)")
+            labelText:          _mavlinkProtocol.latencySampleCount ? qsTr("%1 ms").arg((_mavlinkProtocol.latencyMaxUsecs / 1000).toFixed(1)) : _notConnectedStr
+        }
     }
 
     SettingsGroupLayout {
@@ -162,6 +185,30 @@ SettingsPage {
             visible:            fact.visible
             property Fact _saveCsvTelemetry: _appSettings.saveCsvTelemetry
         }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Log messages written")
+            labelText:          _logWriter.messagesWritten
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Log messages dropped")
+            labelText:          _logWriter.messagesDropped
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Log buffer high water")
+            labelText:          _logWriter.queueHighWaterPercent + '%'
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Log slowest write")
+            labelText:          _logWriter.maxWriteMSecs + " ms"
+        }
     }
 
     SettingsGroupLayout {
@@ -32,6 +32,12 @@ SettingsPage {
     property bool   _videoAutoStreamConfig:     _videoManager.autoStreamConfigured
     property real   _urlFieldWidth:             ScreenTools.defaultFontPixelWidth * 25
     property bool   _requiresUDPPort:           _isUDP264 || _isUDP265 || _isMPEGTS
+    property var    _latencyStats:              _videoManager.latencyStats
+    property bool   _hasLatencyStats:           _latencyStats.frames !== undefined && _latencyStats.frames > 0
+
+    function _latencyString(ms) {
+        return _hasLatencyStats ? qsTr("%1 ms").arg(ms.toFixed(1)) : "-"
+    }
 
     SettingsGroupLayout {
         Layout.fillWidth:   true
@@ -122,6 +128,13 @@ SettingsPage {
             visible:            _videoSettings.recordingFormat.visible
         }
 
+        LabelledFactTextField {
+            Layout.fillWidth:   true
+            label:              qsTr("Pre-Record Buffer")
+            fact:               _videoSettings.recordingPreroll
+            visible:            _isGst && fact.visible
+        }
+
         FactCheckBoxSlider {
             Layout.fillWidth:   true
             text:               qsTr("Auto-Delete Saved Recordings")
@@ -137,4 +150,54 @@ SettingsPage {
             enabled:            _videoSettings.enableStorageLimit.rawValue
         }
     }
+
+    SettingsGroupLayout {
+        Layout.fillWidth:   true
+        heading:            qsTr("Video Latency")
+        headingDescription: qsTr("From arrival of a frame to its display")
+        visible:            _isGst && _videoSettings.latencyStats.visible
+
+        FactCheckBoxSlider {
+            Layout.fillWidth:   true
+            text:               qsTr("Measure Latency")
+            fact:               _videoSettings.latencyStats
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Median / 95% / 99%")
+            labelText:          _hasLatencyStats ? qsTr("%1 / %2 / %3 ms").arg(_latencyStats.median.toFixed(1)).arg(_latencyStats.p95.toFixed(1)).arg(_latencyStats.p99.toFixed(1)) : "-"
+            visible:            _videoSettings.latencyStats.rawValue
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Jitter")
+            labelText:          _latencyString(_latencyStats.jitter)
+            visible:            _videoSettings.latencyStats.rawValue
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Parse / Decode / Render")
+            labelText:          _hasLatencyStats ? qsTr("%1 / %2 / %3 ms").arg(_latencyStats.parse.toFixed(1)).arg(_latencyStats.decode.toFixed(1)).arg(_latencyStats.render.toFixed(1)) : "-"
+            visible:            _videoSettings.latencyStats.rawValue
+        }
+
+        LabelledLabel {
+            Layout.fillWidth:   true
+            label:              qsTr("Dropped Frames")
+            labelText:          _hasLatencyStats ? _latencyStats.droppedFrames : "-"
+            visible:            _videoSettings.latencyStats.rawValue
+        }
+
+        LabelledButton {
+            Layout.fillWidth:   true
+            label:              qsTr("Frame Latency")
+            buttonText:         qsTr("Export CSV")
+            enabled:            _hasLatencyStats
+            visible:            _videoSettings.latencyStats.rawValue
+            onClicked:          _videoManager.exportLatencyStats()
+        }
+    }
 }
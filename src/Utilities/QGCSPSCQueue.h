@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/// @file
+///     @brief Bounded lock-free single producer/single consumer queue.
+///
+///     Exactly one thread may call tryPush and exactly one (other) thread may call tryPop.
+///     Capacity is rounded up to a power of two.
+
+template <typename T>
+class QGCSPSCQueue
+{
+public:
+    explicit QGCSPSCQueue(size_t capacity)
+        : _capacity(_roundUpPowerOfTwo(capacity))
+        , _mask(_capacity - 1)
+        , _slots(new T[_capacity])
+    {
+    }
+
+    QGCSPSCQueue(const QGCSPSCQueue&) = delete;
+    QGCSPSCQueue& operator=(const QGCSPSCQueue&) = delete;
+
+    /// Producer side
+    ///     @return false: queue is full
+    bool tryPush(const T& value)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if ((head - _tail.load(std::memory_order_acquire)) == _capacity) {
+            return false;
+        }
+        _slots[head & _mask] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side
+    ///     @return false: queue is empty
+    bool tryPop(T& value)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = _slots[tail & _mask];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Approximate number of queued entries, exact when called from either end with the other idle
+    size_t size() const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+    bool isEmpty() const { return size() == 0; }
+    size_t capacity() const { return _capacity; }
+
+private:
+    static size_t _roundUpPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<T[]> _slots;
+
+    // Keep the producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> _head{0};  ///< Written by producer
+    alignas(64) std::atomic<size_t> _tail{0};  ///< Written by consumer
+};
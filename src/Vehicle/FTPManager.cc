@@ -15,8 +15,10 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QDir>
+#include <QtCore/QtMath>
 
 QGC_LOGGING_CATEGORY(FTPManagerLog, "FTPManagerLog")
+QGC_LOGGING_CATEGORY(FTPManagerStatsLog, "FTPManagerStatsLog")
 
 FTPManager::FTPManager(Vehicle* vehicle)
     : QObject   (vehicle)
@@ -24,7 +26,8 @@ FTPManager::FTPManager(Vehicle* vehicle)
 {
     _ackOrNakTimeoutTimer.setSingleShot(true);
     // Mock link responds immediately if at all, speed up unit tests with faster timoue
-    _ackOrNakTimeoutTimer.setInterval(qgcApp()->runningUnitTests() ? 10 : _ackOrNakTimeoutMsecs);
+    _minAckTimeoutMSecs = qgcApp()->runningUnitTests() ? 10 : _ackOrNakTimeoutMsecs;
+    _ackOrNakTimeoutTimer.setInterval(_minAckTimeoutMSecs);
     connect(&_ackOrNakTimeoutTimer, &QTimer::timeout, this, &FTPManager::_ackOrNakTimeout);
     
     // Make sure we don't have bad structure packing
@@ -54,6 +57,7 @@ bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QStr
     _downloadState.reset();
     _downloadState.toDir.setPath(toDir);
     _downloadState.checksize = checksize;
+    _downloadState.elapsedTimer.start();
 
     if (!_parseURI(fromCompId, fromURI, _downloadState.fullPathOnVehicle, _ftpCompId)) {
         qCWarning(FTPManagerLog) << "_parseURI failed";
@@ -184,9 +188,17 @@ void FTPManager::_downloadComplete(const QString& errorMsg)
     QString downloadFilePath    = _downloadState.toDir.absoluteFilePath(_downloadState.fileName);
     QString error               = errorMsg;
 
+    qCDebug(FTPManagerStatsLog) << "Download" << _downloadState.fileName << (errorMsg.isEmpty() ? "complete" : "failed")
+                                << "- bytes:" << _downloadState.bytesWritten
+                                << "msecs:" << (_downloadState.lastWriteUSecs / 1000)
+                                << "bytes/sec:" << qRound64(downloadBytesPerSecond())
+                                << "rtt msecs:" << _downloadState.srttMSecs << "+/-" << _downloadState.rttVarMSecs
+                                << "read window:" << _readWindow();
+
     _ackOrNakTimeoutTimer.stop();
     _rgStateMachine.clear();
     _currentStateMachineIndex = -1;
+    _downloadState.rgReadRequests.clear();
     if (_downloadState.file.isOpen()) {
         _downloadState.file.close();
         if (!errorMsg.isEmpty()) {
@@ -237,9 +249,11 @@ void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
     
     MavlinkFTP::Request* request = (MavlinkFTP::Request*)&data.payload[0];
 
-    // Ignore old/reordered packets (handle wrap-around properly)
+    // Ignore old/reordered packets (handle wrap-around properly). Reads of missing data are answered ahead of the
+    // burst which was requested after them, so those are matched to their request by sequence number instead.
     uint16_t actualIncomingSeqNumber = request->hdr.seqNumber;
-    if ((uint16_t)((_expectedIncomingSeqNumber - 1) - actualIncomingSeqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
+    if (_missingBlockReadIndex(request) == -1 &&
+            (uint16_t)((_expectedIncomingSeqNumber - 1) - actualIncomingSeqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
         qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: Received old packet seqNum expected:actual" << _expectedIncomingSeqNumber << actualIncomingSeqNumber
                                << "hdr.opcode:hdr.req_opcode" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode));
 
@@ -367,6 +381,9 @@ void FTPManager::_burstReadFileWorker(bool firstRequest)
         _expectedIncomingSeqNumber -= 2;
     }
 
+    // The first packet of a resent burst may answer either request, so it can't be timed
+    _downloadState.burstSentUSecs = firstRequest ? (_downloadState.elapsedTimer.nsecsElapsed() / 1000) : -1;
+
     _sendRequestExpectAck(&request);
 }
 
@@ -379,6 +396,13 @@ void FTPManager::_burstReadFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
 {
     MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
 
+    if (requestOpCode == MavlinkFTP::kCmdReadFile) {
+        // Response to a read of missing data sent along with the burst
+        if (_missingBlockReadAckOrNak(ackOrNak) && _downloadState.fileSize != 0) {
+            emit commandProgress((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize);
+        }
+        return;
+    }
     if (requestOpCode != MavlinkFTP::kCmdBurstReadFile) {
         qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
@@ -414,18 +438,24 @@ void FTPManager::_burstReadFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
             }
         }
 
-        _downloadState.file.seek(ackOrNak->hdr.offset);
-        int bytesWritten = _downloadState.file.write((const char*)ackOrNak->data, ackOrNak->hdr.size);
-        if (bytesWritten != ackOrNak->hdr.size) {
+        if (_downloadState.burstSentUSecs >= 0) {
+            _addRttSample(_downloadState.burstSentUSecs);
+            _downloadState.burstSentUSecs = -1;
+        }
+
+        if (!_writeDownloadData(ackOrNak->hdr.offset, ackOrNak->data, ackOrNak->hdr.size)) {
             _downloadComplete(tr("Download failed: Error saving file"));
             return;
         }
-        _downloadState.bytesWritten += ackOrNak->hdr.size;
         _downloadState.expectedOffset = ackOrNak->hdr.offset + ackOrNak->hdr.size;
 
         if (ackOrNak->hdr.burstComplete) {
-            // The current burst is done, request next one in offset sequence
+            // The current burst is done, request next one in offset sequence. The holes found so far are read
+            // again ahead of it, instead of one at a time once the whole file went by. Reads which weren't
+            // answered by now were lost, since they were sent before the burst which just completed.
             _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
+            _requeueMissingBlockReads();
+            _sendMissingBlockReads();
             _burstReadFileWorker(true /* firstRequest */);
         } else {
             // Still within a burst, next ack should come automatically
@@ -563,29 +593,15 @@ void FTPManager::_listDirectoryTimeout(void)
 
 void FTPManager::_fillMissingBlocksWorker(bool firstRequest)
 {
-    if (_downloadState.rgMissingData.count()) {
-        MavlinkFTP::Request request{};
-        MissingData_t&      missingData = _downloadState.rgMissingData.first();
-
-        uint32_t cBytesToRead = qMin((uint32_t)sizeof(request.data), missingData.cBytesMissing);
-
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksBegin: offset:cBytesToRead" << missingData.offset << cBytesToRead;
-
-        request.hdr.session                 = _downloadState.sessionId;
-        request.hdr.opcode                  = MavlinkFTP::kCmdReadFile;
-        request.hdr.offset                  = missingData.offset;
-        request.hdr.size                    = cBytesToRead;
-
-        if (firstRequest) {
-            _downloadState.retryCount = 0;
-        } else {
-            // Must used same sequence number as previous request
-            _expectedIncomingSeqNumber -= 2;
-        }
-        _downloadState.expectedOffset = request.hdr.offset;
-
-        _sendRequestExpectAck(&request);
+    if (firstRequest) {
+        _downloadState.retryCount = 0;
+        _sendMissingBlockReads();
     } else {
+        // Ask for the outstanding reads again
+        _resendMissingBlockReads();
+    }
+
+    if (_downloadState.rgReadRequests.isEmpty()) {
         // We should have the full file now
         if (_downloadState.checksize == false || _downloadState.bytesWritten == _downloadState.fileSize) {
             _advanceStateMachine();
@@ -598,6 +614,8 @@ void FTPManager::_fillMissingBlocksWorker(bool firstRequest)
 
 void FTPManager::_fillMissingBlocksBegin(void)
 {
+    // Reads still outstanding from the burst were lost along the way
+    _requeueMissingBlockReads();
     _fillMissingBlocksWorker(true /* firstRequest */);
 }
 
@@ -609,83 +627,224 @@ void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
         qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-        return;
+
+    if (_missingBlockReadAckOrNak(ackOrNak)) {
+        // Progress was made, keep the window full
+        _ackOrNakTimeoutTimer.start();
+        _fillMissingBlocksWorker(true /* firstReqeust */);
+
+        // Emit progress last, as cancel could be called in there
+        if (_downloadState.fileSize != 0) {
+            emit commandProgress((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize);
+        }
     }
-    if (ackOrNak->hdr.session != _downloadState.sessionId) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _downloadState.sessionId;
-        return;
+}
+
+void FTPManager::_fillMissingBlocksTimeout(void)
+{
+    if (++_downloadState.retryCount > _maxRetry) {
+        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout retries exceeded");
+        _downloadComplete(tr("Download failed"));
+    } else {
+        // Ask for outstanding reads again
+        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout: retrying - retryCount(%1) outstanding(%2)").arg(_downloadState.retryCount).arg(_downloadState.rgReadRequests.count());
+        _fillMissingBlocksWorker(false /* firstReqeust */);
     }
+}
 
-    _ackOrNakTimeoutTimer.stop();
+int FTPManager::_readWindow(void) const
+{
+    if (_maxOutstandingReads > 0) {
+        return _maxOutstandingReads;
+    }
+    return _vehicle->apmFirmware() ? _apmMaxOutstandingReads : _defaultMaxOutstandingReads;
+}
 
-    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Ack offset:size" << ackOrNak->hdr.offset << ackOrNak->hdr.size;
+/// Sends reads for missing data until the read window is full. Each read gets its own sequence number so
+/// the responses can be matched to them in any order.
+void FTPManager::_sendMissingBlockReads(void)
+{
+    const int readWindow = _readWindow();
+    while (_downloadState.rgReadRequests.count() < readWindow && _downloadState.rgMissingData.count()) {
+        MavlinkFTP::Request request{};
+        MissingData_t&      missingData = _downloadState.rgMissingData.first();
 
-        if (ackOrNak->hdr.offset != _downloadState.expectedOffset) {
-            if (++_downloadState.retryCount > _maxRetry) {
-                qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: offset mismatch, retries exceeded");
-                _downloadComplete(tr("Download failed"));
-                return;
-            }
+        uint32_t cBytesToRead = qMin((uint32_t)sizeof(request.data), missingData.cBytesMissing);
 
-            // Ask for current offset again
-            qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: Ack offset mismatch retry, retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-            _fillMissingBlocksWorker(false /* firstReqeust */);
-            return;
-        }
+        qCDebug(FTPManagerLog) << "_sendMissingBlockReads: offset:cBytesToRead" << missingData.offset << cBytesToRead;
 
-        _downloadState.file.seek(ackOrNak->hdr.offset);
-        int bytesWritten = _downloadState.file.write((const char*)ackOrNak->data, ackOrNak->hdr.size);
-        if (bytesWritten != ackOrNak->hdr.size) {
-            _downloadComplete(tr("Download failed: Error saving file"));
-            return;
-        }
-        _downloadState.bytesWritten += ackOrNak->hdr.size;
+        request.hdr.session                 = _downloadState.sessionId;
+        request.hdr.opcode                  = MavlinkFTP::kCmdReadFile;
+        request.hdr.offset                  = missingData.offset;
+        request.hdr.size                    = cBytesToRead;
+        _sendRequestExpectAck(&request);
 
-        MissingData_t& missingData = _downloadState.rgMissingData.first();
-        missingData.offset += ackOrNak->hdr.size;
-        missingData.cBytesMissing -= ackOrNak->hdr.size;
+        ReadRequest_t readRequest;
+        readRequest.offset      = missingData.offset;
+        readRequest.cBytes      = cBytesToRead;
+        readRequest.seqNumber   = request.hdr.seqNumber;
+        readRequest.sentUSecs   = _downloadState.elapsedTimer.nsecsElapsed() / 1000;
+        readRequest.retried     = false;
+        _downloadState.rgReadRequests.append(readRequest);
+
+        missingData.offset          += cBytesToRead;
+        missingData.cBytesMissing   -= cBytesToRead;
         if (missingData.cBytesMissing == 0) {
-            // This block is finished, remove it
             _downloadState.rgMissingData.takeFirst();
         }
+    }
+}
 
-        // Move on to fill in possible next hole
-        _fillMissingBlocksWorker(true /* firstReqeust */);
+/// Resends all outstanding reads of missing data with their original sequence numbers
+void FTPManager::_resendMissingBlockReads(void)
+{
+    for (ReadRequest_t& readRequest: _downloadState.rgReadRequests) {
+        MavlinkFTP::Request request{};
 
-        // Emit progress last, as cancel could be called in there
-        if (_downloadState.fileSize != 0) {
-            emit commandProgress((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize);
+        request.hdr.session     = _downloadState.sessionId;
+        request.hdr.opcode      = MavlinkFTP::kCmdReadFile;
+        request.hdr.offset      = readRequest.offset;
+        request.hdr.size        = readRequest.cBytes;
+        request.hdr.seqNumber   = readRequest.seqNumber;
+        readRequest.retried     = true;
+
+        _sendRequest(&request);
+    }
+}
+
+/// Moves the outstanding reads of missing data back to the missing data list
+void FTPManager::_requeueMissingBlockReads(void)
+{
+    for (const ReadRequest_t& readRequest: _downloadState.rgReadRequests) {
+        MissingData_t missingData;
+        missingData.offset          = readRequest.offset;
+        missingData.cBytesMissing   = readRequest.cBytes;
+        _downloadState.rgMissingData.append(missingData);
+    }
+    _downloadState.rgReadRequests.clear();
+}
+
+/// @return Index into rgReadRequests of the read the response belongs to, -1 if it isn't the response to an outstanding read
+int FTPManager::_missingBlockReadIndex(const MavlinkFTP::Request* response) const
+{
+    if (response->hdr.req_opcode == MavlinkFTP::kCmdReadFile) {
+        for (int i=0; i<_downloadState.rgReadRequests.count(); i++) {
+            if ((uint16_t)(_downloadState.rgReadRequests[i].seqNumber + 1) == response->hdr.seqNumber) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+/// Handles the response to a read of missing data
+///     @return true: the response was used and the download continues
+bool FTPManager::_missingBlockReadAckOrNak(const MavlinkFTP::Request* ackOrNak)
+{
+    int index = _missingBlockReadIndex(ackOrNak);
+    if (index == -1) {
+        qCDebug(FTPManagerLog) << "_missingBlockReadAckOrNak: Disregarding response to unknown read seqNumber" << ackOrNak->hdr.seqNumber;
+        return false;
+    }
+    if (ackOrNak->hdr.session != _downloadState.sessionId) {
+        qCDebug(FTPManagerLog) << "_missingBlockReadAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _downloadState.sessionId;
+        return false;
+    }
+
+    ReadRequest_t readRequest = _downloadState.rgReadRequests.takeAt(index);
+
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        qCDebug(FTPManagerLog) << "_missingBlockReadAckOrNak: Ack offset:size" << ackOrNak->hdr.offset << ackOrNak->hdr.size;
+
+        if (!readRequest.retried) {
+            _addRttSample(readRequest.sentUSecs);
+        }
+
+        MissingData_t missingData;
+        if (ackOrNak->hdr.offset != readRequest.offset) {
+            // Read it again later
+            qCDebug(FTPManagerLog) << "_missingBlockReadAckOrNak: Ack offset mismatch actual:expected" << ackOrNak->hdr.offset << readRequest.offset;
+            missingData.offset          = readRequest.offset;
+            missingData.cBytesMissing   = readRequest.cBytes;
+            _downloadState.rgMissingData.append(missingData);
+            return true;
         }
+
+        uint32_t cBytes = qMin((uint32_t)ackOrNak->hdr.size, readRequest.cBytes);
+        if (!_writeDownloadData(readRequest.offset, ackOrNak->data, cBytes)) {
+            _downloadComplete(tr("Download failed: Error saving file"));
+            return false;
+        }
+        if (cBytes < readRequest.cBytes) {
+            // Short read, the rest still has to come
+            missingData.offset          = readRequest.offset + cBytes;
+            missingData.cBytesMissing   = readRequest.cBytes - cBytes;
+            _downloadState.rgMissingData.append(missingData);
+        }
+        return true;
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
 
-        if (errorCode == MavlinkFTP::kErrEOF) {
-            qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak EOF";
-            if (_downloadState.checksize == false || _downloadState.bytesWritten == _downloadState.fileSize) {
-                // We've successfully complete filling in all missing blocks
-                _advanceStateMachine();
-                return;
+        if (errorCode == MavlinkFTP::kErrEOF && _downloadState.checksize == false) {
+            // The file is shorter than the size given by the open, nothing past this read exists
+            qCDebug(FTPManagerLog) << "_missingBlockReadAckOrNak EOF offset" << readRequest.offset;
+            for (int i=_downloadState.rgMissingData.count()-1; i>=0; i--) {
+                if (_downloadState.rgMissingData[i].offset >= readRequest.offset) {
+                    _downloadState.rgMissingData.removeAt(i);
+                }
             }
+            return true;
         }
 
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+        qCDebug(FTPManagerLog) << "_missingBlockReadAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
         _downloadComplete(tr("Download failed"));
     }
+
+    return false;
 }
 
-void FTPManager::_fillMissingBlocksTimeout(void)
+bool FTPManager::_writeDownloadData(uint32_t offset, const uint8_t* data, uint32_t cBytes)
 {
-    if (++_downloadState.retryCount > _maxRetry) {
-        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout retries exceeded");
-        _downloadComplete(tr("Download failed"));
+    _downloadState.file.seek(offset);
+    if (_downloadState.file.write((const char*)data, cBytes) != cBytes) {
+        return false;
+    }
+    _downloadState.bytesWritten     += cBytes;
+    _downloadState.lastWriteUSecs   = _downloadState.elapsedTimer.nsecsElapsed() / 1000;
+    return true;
+}
+
+double FTPManager::downloadBytesPerSecond(void) const
+{
+    if (_downloadState.lastWriteUSecs <= 0) {
+        return 0;
+    }
+    return (double)_downloadState.bytesWritten * 1000000.0 / (double)_downloadState.lastWriteUSecs;
+}
+
+/// Adds a round trip time measurement, smoothed the same way as TCP does (RFC 6298)
+///     @param sentUSecs Time the request was sent, relative to the start of the download
+void FTPManager::_addRttSample(qint64 sentUSecs)
+{
+    double rttMSecs = (double)((_downloadState.elapsedTimer.nsecsElapsed() / 1000) - sentUSecs) / 1000.0;
+
+    if (_downloadState.rttSampleCount == 0) {
+        _downloadState.srttMSecs    = rttMSecs;
+        _downloadState.rttVarMSecs  = rttMSecs / 2.0;
     } else {
-        // Ask for current offset again
-        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout: retrying - retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-        _fillMissingBlocksWorker(false /* firstReqeust */);
+        _downloadState.rttVarMSecs  = (0.75 * _downloadState.rttVarMSecs) + (0.25 * qAbs(_downloadState.srttMSecs - rttMSecs));
+        _downloadState.srttMSecs    = (0.875 * _downloadState.srttMSecs) + (0.125 * rttMSecs);
     }
+    _downloadState.rttSampleCount++;
+}
+
+/// @return Time to wait for an ack. Same as the TCP retransmission timeout, but never shorter than the minimum.
+int FTPManager::_ackTimeoutMSecs(void) const
+{
+    if (_downloadState.rttSampleCount == 0) {
+        return _minAckTimeoutMSecs;
+    }
+    return qMax(_minAckTimeoutMSecs, qCeil(_downloadState.srttMSecs + (4.0 * _downloadState.rttVarMSecs)));
 }
 
 void FTPManager::_resetSessionsBegin(void)
@@ -728,14 +887,20 @@ void FTPManager::_resetSessionsTimeout(void)
 
 void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
 {
-    _ackOrNakTimeoutTimer.start();
+    request->hdr.seqNumber = _expectedIncomingSeqNumber + 1;    // Outgoing is 1 past last incoming
+    _expectedIncomingSeqNumber += 2;
+
+    _sendRequest(request);
+}
+
+/// Sends a request with the sequence number already set in it
+void FTPManager::_sendRequest(MavlinkFTP::Request* request)
+{
+    _ackOrNakTimeoutTimer.start(_ackTimeoutMSecs());
     
     SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
     if (sharedLink) {
-        request->hdr.seqNumber = _expectedIncomingSeqNumber + 1;    // Outgoing is 1 past last incoming
-        _expectedIncomingSeqNumber += 2;
-
-        qCDebug(FTPManagerLog) << "_sendRequestExpectAck opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) << "seqNumber:" << request->hdr.seqNumber;
+        qCDebug(FTPManagerLog) << "_sendRequest opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) << "seqNumber:" << request->hdr.seqNumber;
 
         mavlink_message_t message;
         mavlink_msg_file_transfer_protocol_pack_chan(qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
@@ -748,7 +913,7 @@ void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
                                                      (uint8_t*)request);                                    // Payload
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     } else {
-        qCDebug(FTPManagerLog) << "_sendRequestExpectAck No primary link. Allowing timeout to fail sequence.";
+        qCDebug(FTPManagerLog) << "_sendRequest No primary link. Allowing timeout to fail sequence.";
     }
 }
 
@@ -13,10 +13,12 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QTimer>
 #include <QtCore/QLoggingCategory>
 
 Q_DECLARE_LOGGING_CATEGORY(FTPManagerLog)
+Q_DECLARE_LOGGING_CATEGORY(FTPManagerStatsLog)
 
 class Vehicle;
 
@@ -56,6 +58,20 @@ public:
     /// This will emit downloadComplete() when done, and if there's currently a download in progress
     void cancelDownload();
 
+    /// Smoothed round trip time of the requests of the current or last download, as done for TCP
+    ///     @return Round trip time in msecs, 0 if nothing was measured yet
+    double downloadRttMSecs(void) const { return _downloadState.srttMSecs; }
+
+    /// @return Average throughput of the current or last download in bytes per second, 0 if nothing was written yet
+    double downloadBytesPerSecond(void) const;
+
+    /// Sets the number of reads of missing data which are kept in flight at the same time. By default the
+    /// window is sized to what the autopilot can queue.
+    void setMaxOutstandingReads(int count) { _maxOutstandingReads = qMax(count, 1); }
+
+    /// Sets the shortest time to wait for an ack. The wait grows with the measured round trip time of the link.
+    void setMinAckTimeoutMSecs(int msecs) { _minAckTimeoutMSecs = msecs; }
+
     static constexpr const char* mavlinkFTPScheme = "mftp";
 
 signals:
@@ -85,11 +101,20 @@ private:
         uint32_t cBytesMissing;
     };
 
+    struct ReadRequest_t {
+        uint32_t    offset;
+        uint32_t    cBytes;
+        uint16_t    seqNumber;      ///< Sequence number the read was sent with, the response comes back with one more
+        qint64      sentUSecs;      ///< Time the read was sent, relative to the start of the download
+        bool        retried;        ///< Read was resent, so the response can't be used to measure round trip time
+    };
+
     struct DownloadState_t {
         uint8_t                 sessionId;
         uint32_t                expectedOffset;         ///< offset which should be coming next
         uint32_t                bytesWritten;
         QList<MissingData_t>    rgMissingData;
+        QList<ReadRequest_t>    rgReadRequests;         ///< Reads of missing data waiting for a response
         QString                 fullPathOnVehicle;      ///< Fully qualified path to file on vehicle
         QDir                    toDir;                  ///< Directory to download file to
         QString                 fileName;               ///< Filename (no path) for download file
@@ -97,6 +122,12 @@ private:
         QFile                   file;
         int                     retryCount;
         bool                    checksize;
+        QElapsedTimer           elapsedTimer;           ///< Started with the download
+        qint64                  burstSentUSecs;         ///< Time the current burst was requested, -1 once answered or if resent
+        qint64                  lastWriteUSecs;         ///< Time the last data was written
+        double                  srttMSecs;              ///< Smoothed round trip time
+        double                  rttVarMSecs;            ///< Round trip time variation
+        int                     rttSampleCount;
 
         bool inProgress() const { return fileSize > 0; }
 
@@ -106,9 +137,15 @@ private:
             bytesWritten    = 0;
             retryCount      = 0;
             fileSize        = 0;
+            burstSentUSecs  = -1;
+            lastWriteUSecs  = 0;
+            srttMSecs       = 0;
+            rttVarMSecs     = 0;
+            rttSampleCount  = 0;
             fullPathOnVehicle.clear();
             fileName.clear();
             rgMissingData.clear();
+            rgReadRequests.clear();
             file.close();
         }
     };
@@ -151,6 +188,16 @@ private:
     void    _resetSessionsTimeout       (void);
     QString _errorMsgFromNak            (const MavlinkFTP::Request* nak);
     void    _sendRequestExpectAck       (MavlinkFTP::Request* request);
+    void    _sendRequest                (MavlinkFTP::Request* request);
+    int     _ackTimeoutMSecs            (void) const;
+    void    _addRttSample               (qint64 sentUSecs);
+    bool    _writeDownloadData          (uint32_t offset, const uint8_t* data, uint32_t cBytes);
+    void    _sendMissingBlockReads      (void);
+    int     _readWindow                 (void) const;
+    void    _resendMissingBlockReads    (void);
+    void    _requeueMissingBlockReads   (void);
+    int     _missingBlockReadIndex      (const MavlinkFTP::Request* response) const;
+    bool    _missingBlockReadAckOrNak   (const MavlinkFTP::Request* ackOrNak);
     void    _downloadCompleteNoError    (void) { _downloadComplete(QString()); }
     void    _downloadComplete           (const QString& errorMsg);
     void    _fillRequestDataWithString(MavlinkFTP::Request* request, const QString& str);
@@ -175,8 +222,12 @@ private:
     QTimer                  _ackOrNakTimeoutTimer;
     int                     _currentStateMachineIndex   = -1;
     uint16_t                _expectedIncomingSeqNumber  = 0;
+    int                     _minAckTimeoutMSecs         = _ackOrNakTimeoutMsecs;
+    int                     _maxOutstandingReads        = 0;    ///< 0: Sized to the autopilot, see _readWindow
     
-    static const int _ackOrNakTimeoutMsecs  = 1000;
-    static const int _maxRetry              = 3;
+    static const int _ackOrNakTimeoutMsecs          = 1000;
+    static const int _maxRetry                      = 3;
+    static const int _defaultMaxOutstandingReads    = 4;
+    static const int _apmMaxOutstandingReads        = 3;    ///< ArduPilot drops requests beyond its queue of 5, leave room for the burst read and others
 };
 
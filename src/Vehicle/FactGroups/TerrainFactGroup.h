@@ -24,6 +24,9 @@ public:
     Fact* blocksPending () { return &_blocksPendingFact; }
     Fact* blocksLoaded  () { return &_blocksLoadedFact; }
 
+    // Overrides from FactGroup
+    QList<uint32_t> handledMessageIds(void) const override { return {}; } ///< Filled in by TerrainProtocolHandler
+
 private:
     const QString _blocksPendingFactName =  QStringLiteral("blocksPending");
     const QString _blocksLoadedFactName =   QStringLiteral("blocksLoaded");
@@ -88,6 +88,15 @@ void VehicleBatteryFactGroup::handleMessage(Vehicle* vehicle, mavlink_message_t&
     }
 }
 
+QList<uint32_t> VehicleBatteryFactGroup::handledMessageIds(void) const
+{
+    return {
+        MAVLINK_MSG_ID_HIGH_LATENCY,
+        MAVLINK_MSG_ID_HIGH_LATENCY2,
+        MAVLINK_MSG_ID_BATTERY_STATUS,
+    };
+}
+
 void VehicleBatteryFactGroup::_handleHighLatency(Vehicle* vehicle, mavlink_message_t& message)
 {
     mavlink_high_latency_t highLatency;
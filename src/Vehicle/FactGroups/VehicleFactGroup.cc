@@ -110,6 +110,21 @@ void VehicleFactGroup::handleMessage(Vehicle* vehicle, mavlink_message_t& messag
     }
 }
 
+QList<uint32_t> VehicleFactGroup::handledMessageIds(void) const
+{
+    return {
+        MAVLINK_MSG_ID_ATTITUDE,
+        MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
+        MAVLINK_MSG_ID_ALTITUDE,
+        MAVLINK_MSG_ID_VFR_HUD,
+        MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT,
+        MAVLINK_MSG_ID_RAW_IMU,
+#ifndef NO_ARDUPILOT_DIALECT
+        MAVLINK_MSG_ID_RANGEFINDER,
+#endif
+    };
+}
+
 void VehicleFactGroup::_handleAttitudeWorker(double rollRadians, double pitchRadians, double yawRadians)
 {
     double roll = QGC::limitAngleToPMPIf(rollRadians);
@@ -25,6 +25,13 @@ void VehicleGPS2FactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_message
     }
 }
 
+QList<uint32_t> VehicleGPS2FactGroup::handledMessageIds(void) const
+{
+    return {
+        MAVLINK_MSG_ID_GPS2_RAW,
+    };
+}
+
 void VehicleGPS2FactGroup::_handleGps2Raw(mavlink_message_t& message)
 {
     mavlink_gps2_raw_t gps2Raw;
@@ -53,6 +53,13 @@ void VehicleGeneratorFactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_me
     }
 }
 
+QList<uint32_t> VehicleGeneratorFactGroup::handledMessageIds(void) const
+{
+    return {
+        MAVLINK_MSG_ID_GENERATOR_STATUS,
+    };
+}
+
 void VehicleGeneratorFactGroup::_handleGeneratorStatus(mavlink_message_t& message)
 {
     mavlink_generator_status_t generator;
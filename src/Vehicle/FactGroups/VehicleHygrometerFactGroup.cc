@@ -36,6 +36,13 @@ void VehicleHygrometerFactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_m
     }
 }
 
+QList<uint32_t> VehicleHygrometerFactGroup::handledMessageIds(void) const
+{
+    return {
+        MAVLINK_MSG_ID_HYGROMETER_SENSOR,
+    };
+}
+
 void VehicleHygrometerFactGroup::_handleHygrometerSensor(mavlink_message_t& message)
 {
     mavlink_hygrometer_sensor_t hygrometer;
@@ -29,6 +29,7 @@ public:
 
     // Overrides from FactGroup
     virtual void handleMessage(Vehicle* vehicle, mavlink_message_t& message) override;
+    virtual QList<uint32_t> handledMessageIds(void) const override;
 
 protected:
     void _handleHygrometerSensor        (mavlink_message_t& message);
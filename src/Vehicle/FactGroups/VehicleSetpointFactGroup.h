@@ -35,6 +35,7 @@ public:
 
     // Overrides from FactGroup
     void handleMessage(Vehicle* vehicle, mavlink_message_t& message) override;
+    QList<uint32_t> handledMessageIds(void) const override;
 
 private:
     const QString _rollFactName =       QStringLiteral("roll");
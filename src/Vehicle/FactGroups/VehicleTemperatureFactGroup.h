@@ -29,6 +29,7 @@ public:
 
     // Overrides from FactGroup
     void handleMessage(Vehicle* vehicle, mavlink_message_t& message) override;
+    QList<uint32_t> handledMessageIds(void) const override;
 
 private:
     void _handleScaledPressure  (mavlink_message_t& message);
@@ -9,6 +9,13 @@
 
 #include "TrajectoryPoints.h"
 #include "Vehicle.h"
+#include "QGCApplication.h"
+#include "AppSettings.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QtMath>
 
 TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
     : QObject       (parent)
@@ -33,24 +40,94 @@ void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
                 // The new position IS NOT colinear with the last segment. Append the new position to the list.
                 _lastAzimuth = _lastPoint.azimuthTo(coordinate);
                 _lastPoint = coordinate;
-                _points.append(QVariant::fromValue(coordinate));
-                emit pointAdded(coordinate);
+                _appendPoint(coordinate);
             } else {
                 // The new position IS colinear with the last segment. Don't add a new point, just update
                 // the last point to be the new position.
                 _lastPoint = coordinate;
-                _points[_points.count() - 1] = QVariant::fromValue(coordinate);
+                _store.replaceLast(coordinate, QDateTime::currentMSecsSinceEpoch());
                 emit updateLastPoint(coordinate);
             }
         }
     } else {
         // Add the very first trajectory point to the list
         _lastPoint = coordinate;
-        _points.append(QVariant::fromValue(coordinate));
-        emit pointAdded(coordinate);
+        _appendPoint(coordinate);
+    }
+}
+
+void TrajectoryPoints::_appendPoint(const QGeoCoordinate& coordinate)
+{
+    const int previousCompactionCount = _store.compactionCount();
+
+    const bool changed = _store.append(coordinate, QDateTime::currentMSecsSinceEpoch());
+    emit pointAdded(coordinate);
+    if (!changed) {
+        return;
+    }
+
+    if (_store.compactionCount() != previousCompactionCount) {
+        emit pathReset();
+    } else {
+        emit chunkClosed();
     }
 }
 
+QVariantList TrajectoryPoints::closedList(int level, int first) const
+{
+    level = qBound(0, level, TrajectoryStore::levelCount - 1);
+
+    QVariantList points;
+    const int closedPathSize = _store.closedPathSize(level);
+    for (int i = qMax(0, first); i < closedPathSize; i++) {
+        points.append(QVariant::fromValue(_store.pathCoordinate(level, i)));
+    }
+    return points;
+}
+
+QVariantList TrajectoryPoints::tailList(int level) const
+{
+    level = qBound(0, level, TrajectoryStore::levelCount - 1);
+
+    QVariantList points;
+    const int pathSize = _store.pathSize(level);
+    for (int i = qMax(0, _store.closedPathSize(level) - 1); i < pathSize; i++) {
+        points.append(QVariant::fromValue(_store.pathCoordinate(level, i)));
+    }
+    return points;
+}
+
+void TrajectoryPoints::saveToFile(const QString& filename) const
+{
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    QString trackFilename = filename;
+    if (QFileInfo(filename).suffix().isEmpty()) {
+        trackFilename += QStringLiteral(".%1").arg(AppSettings::kmlFileExtension);
+    }
+
+    QString errorString;
+    bool success;
+    if (QFileInfo(trackFilename).suffix().compare(QStringLiteral("csv"), Qt::CaseInsensitive) == 0) {
+        success = _store.saveToCsv(trackFilename, errorString);
+    } else {
+        success = _store.saveToKml(trackFilename, tr("%1 Trajectory").arg(QCoreApplication::applicationName()), tr("Trajectory"), errorString);
+    }
+
+    if (!success) {
+        qgcApp()->showAppMessage(tr("Trajectory save error %1 : %2").arg(trackFilename, errorString));
+    }
+}
+
+int TrajectoryPoints::levelForZoom(double zoomLevel, double latitude) const
+{
+    // Web mercator ground resolution for 256 pixel tiles
+    const double metersPerPixel = 156543.03392 * qCos(qDegreesToRadians(latitude)) / qPow(2.0, zoomLevel);
+    return TrajectoryStore::levelForResolution(metersPerPixel);
+}
+
 void TrajectoryPoints::start(void)
 {
     clear();
@@ -64,7 +141,7 @@ void TrajectoryPoints::stop(void)
 
 void TrajectoryPoints::clear(void)
 {
-    _points.clear();
+    _store.clear();
     _lastPoint = QGeoCoordinate();
     _lastAzimuth = qQNaN();
     emit pointsCleared();
@@ -9,12 +9,17 @@
 
 #pragma once
 
+#include "TrajectoryStore.h"
+
 #include <QtPositioning/QGeoCoordinate>
 #include <QtCore/QObject>
 #include <QtCore/QVariantList>
 
 class Vehicle;
 
+/// Vehicle trajectory for display on the map. Maps pick a level of detail for their zoom with
+/// levelForZoom and then show the path as its closed part, which only ever grows at the end, plus
+/// the short open tail which follows the vehicle.
 class TrajectoryPoints : public QObject
 {
     Q_OBJECT
@@ -22,7 +27,20 @@ class TrajectoryPoints : public QObject
 public:
     TrajectoryPoints(Vehicle* vehicle, QObject* parent = nullptr);
 
-    Q_INVOKABLE QVariantList list(void) const { return _points; }
+    /// @return The closed part of the path at the level of detail starting at path index first
+    Q_INVOKABLE QVariantList closedList(int level, int first = 0) const;
+    /// @return The open tail of the path at the level of detail, starting with the last closed point
+    ///         so it joins up with the closed part
+    Q_INVOKABLE QVariantList tailList(int level) const;
+
+    /// Saves the full stored track with the time and altitude of every point. Files ending in .csv
+    /// are written as CSV, anything else as KML.
+    Q_INVOKABLE void saveToFile(const QString& filename) const;
+
+    /// @return The level of detail to show at a map zoom level around latitude
+    Q_INVOKABLE int levelForZoom(double zoomLevel, double latitude) const;
+
+    const TrajectoryStore& store(void) const { return _store; }
 
     void start  (void);
     void stop   (void);
@@ -34,13 +52,19 @@ signals:
     void pointAdded     (QGeoCoordinate coordinate);
     void updateLastPoint(QGeoCoordinate coordinate);
     void pointsCleared  (void);
+    /// A chunk of the tail was closed, the closed part of the path grew at every level
+    void chunkClosed    (void);
+    /// The path changed as a whole at every level and has to be loaded again
+    void pathReset      (void);
 
 private slots:
     void _vehicleCoordinateChanged(QGeoCoordinate coordinate);
 
 private:
+    void _appendPoint(const QGeoCoordinate& coordinate);
+
     Vehicle*        _vehicle;
-    QVariantList    _points;
+    TrajectoryStore _store;
     QGeoCoordinate  _lastPoint;
     double          _lastAzimuth;
 
@@ -0,0 +1,373 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryStore.h"
+#include "KMLDomDocument.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTextStream>
+#include <QtCore/QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+constexpr double metersPerDegree = 111319.49;
+
+/// Squared distance from point p to the segment a-b
+double _segmentDistanceSquared(double px, double py, double ax, double ay, double bx, double by)
+{
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    const double lengthSquared = (dx * dx) + (dy * dy);
+
+    double t = 0;
+    if (lengthSquared > 0) {
+        t = std::clamp((((px - ax) * dx) + ((py - ay) * dy)) / lengthSquared, 0.0, 1.0);
+    }
+
+    const double ex = px - (ax + (t * dx));
+    const double ey = py - (ay + (t * dy));
+    return (ex * ex) + (ey * ey);
+}
+
+QString _timeString(qint64 timeMSecs)
+{
+    return QDateTime::fromMSecsSinceEpoch(timeMSecs).toUTC().toString(Qt::ISODateWithMs);
+}
+
+} // namespace
+
+TrajectoryStore::TrajectoryStore(int maxPoints)
+    // Compaction needs room for the open tail
+    : _maxPoints(qMax(maxPoints, 4 * chunkSize))
+{
+}
+
+QGeoCoordinate TrajectoryStore::coordinate(int index) const
+{
+    const float altitude = _altitudes[index];
+    if (std::isnan(altitude)) {
+        return QGeoCoordinate(_latitudes[index], _longitudes[index]);
+    }
+    return QGeoCoordinate(_latitudes[index], _longitudes[index], altitude);
+}
+
+bool TrajectoryStore::append(const QGeoCoordinate& coordinate, qint64 timeMSecs)
+{
+    _latitudes.push_back(coordinate.latitude());
+    _longitudes.push_back(coordinate.longitude());
+    _altitudes.push_back(static_cast<float>(coordinate.altitude()));
+    _timesMSecs.push_back(timeMSecs);
+
+    bool changed = false;
+
+    // The last point can still move, so a chunk is only closed once a point follows it
+    if ((size() - 1 - _closedCount) > chunkSize) {
+        _closeChunk();
+        changed = true;
+    }
+
+    if (size() > _maxPoints) {
+        _compact();
+        changed = true;
+    }
+
+    return changed;
+}
+
+void TrajectoryStore::replaceLast(const QGeoCoordinate& coordinate, qint64 timeMSecs)
+{
+    if (isEmpty()) {
+        return;
+    }
+
+    _latitudes.back() = coordinate.latitude();
+    _longitudes.back() = coordinate.longitude();
+    _altitudes.back() = static_cast<float>(coordinate.altitude());
+    _timesMSecs.back() = timeMSecs;
+}
+
+void TrajectoryStore::clear()
+{
+    _latitudes.clear();
+    _longitudes.clear();
+    _altitudes.clear();
+    _timesMSecs.clear();
+    for (std::vector<uint32_t>& indices : _levelIndices) {
+        indices.clear();
+    }
+    _closedCount = 0;
+}
+
+int TrajectoryStore::closedPathSize(int level) const
+{
+    return (level == 0) ? _closedCount : static_cast<int>(_levelIndices[level].size());
+}
+
+int TrajectoryStore::pathPointIndex(int level, int pathIndex) const
+{
+    const int closedSize = closedPathSize(level);
+    if (pathIndex >= closedSize) {
+        return _closedCount + (pathIndex - closedSize);
+    }
+    return (level == 0) ? pathIndex : static_cast<int>(_levelIndices[level][pathIndex]);
+}
+
+double TrajectoryStore::levelError(int level)
+{
+    double error = 0;
+    for (int i = 1; i <= level; i++) {
+        error += levelTolerances[i];
+    }
+    return error;
+}
+
+int TrajectoryStore::levelForResolution(double metersPerPixel)
+{
+    int level = 0;
+    while (((level + 1) < levelCount) && (levelError(level + 1) <= metersPerPixel)) {
+        level++;
+    }
+    return level;
+}
+
+bool TrajectoryStore::saveToCsv(const QString& filename, QString& errorString) const
+{
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << "Time,Latitude,Longitude,Altitude\n";
+    for (int i = 0; i < size(); i++) {
+        stream << _timeString(_timesMSecs[i])
+               << ',' << QString::number(_latitudes[i], 'f', 7)
+               << ',' << QString::number(_longitudes[i], 'f', 7)
+               << ',';
+        if (!std::isnan(_altitudes[i])) {
+            stream << QString::number(_altitudes[i], 'f', 2);
+        }
+        stream << '\n';
+    }
+    stream.flush();
+
+    if ((stream.status() != QTextStream::Ok) || !file.commit()) {
+        errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TrajectoryStore::saveToKml(const QString& filename, const QString& documentName, const QString& trackName, QString& errorString) const
+{
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    KMLDomDocument trajectoryKML(documentName);
+    trajectoryKML.documentElement().setAttribute(QStringLiteral("xmlns:gx"), QStringLiteral("http://www.google.com/kml/ext/2.2"));
+
+    // Points without an altitude would otherwise be drawn at sea level
+    const bool hasAltitudes = std::none_of(_altitudes.cbegin(), _altitudes.cend(), [](float altitude) { return std::isnan(altitude); });
+
+    QDomElement placemarkElement = trajectoryKML.addPlacemark(trackName, true);
+    QDomElement trackElement = trajectoryKML.createElement(QStringLiteral("gx:Track"));
+    placemarkElement.appendChild(trackElement);
+    trajectoryKML.addTextElement(trackElement, QStringLiteral("altitudeMode"), hasAltitudes ? QStringLiteral("absolute") : QStringLiteral("clampToGround"));
+
+    // gx:Track lists all the times first and then all the coordinates in the same order
+    for (int i = 0; i < size(); i++) {
+        trajectoryKML.addTextElement(trackElement, QStringLiteral("when"), _timeString(_timesMSecs[i]));
+    }
+    for (int i = 0; i < size(); i++) {
+        const double altitude = std::isnan(_altitudes[i]) ? 0 : _altitudes[i];
+        trajectoryKML.addTextElement(trackElement, QStringLiteral("gx:coord"), QStringLiteral("%1 %2 %3")
+                                     .arg(QString::number(_longitudes[i], 'f', 7), QString::number(_latitudes[i], 'f', 7), QString::number(altitude, 'f', 2)));
+    }
+
+    QTextStream stream(&file);
+    stream << trajectoryKML.toString();
+    stream.flush();
+
+    if ((stream.status() != QTextStream::Ok) || !file.commit()) {
+        errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+std::vector<uint32_t> TrajectoryStore::simplify(const std::vector<uint32_t>& indices, double toleranceMeters) const
+{
+    const size_t count = indices.size();
+    if (count <= 2) {
+        return indices;
+    }
+
+    // A local flat projection around the first point is plenty over the length of a chunk
+    const double originLatitude = _latitudes[indices[0]];
+    const double originLongitude = _longitudes[indices[0]];
+    const double longitudeScale = metersPerDegree * qCos(qDegreesToRadians(originLatitude));
+
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    for (size_t i = 0; i < count; i++) {
+        double deltaLongitude = _longitudes[indices[i]] - originLongitude;
+        if (deltaLongitude > 180.0) {
+            deltaLongitude -= 360.0;
+        } else if (deltaLongitude < -180.0) {
+            deltaLongitude += 360.0;
+        }
+        xs[i] = deltaLongitude * longitudeScale;
+        ys[i] = (_latitudes[indices[i]] - originLatitude) * metersPerDegree;
+    }
+
+    std::vector<bool> keep(count, false);
+    keep.front() = true;
+    keep.back() = true;
+
+    const double toleranceSquared = toleranceMeters * toleranceMeters;
+    std::vector<std::pair<size_t, size_t>> segments = { { 0, count - 1 } };
+    while (!segments.empty()) {
+        const auto [first, last] = segments.back();
+        segments.pop_back();
+
+        double maxDistanceSquared = 0;
+        size_t farthest = first;
+        for (size_t i = first + 1; i < last; i++) {
+            const double distanceSquared = _segmentDistanceSquared(xs[i], ys[i], xs[first], ys[first], xs[last], ys[last]);
+            if (distanceSquared > maxDistanceSquared) {
+                maxDistanceSquared = distanceSquared;
+                farthest = i;
+            }
+        }
+
+        if (maxDistanceSquared > toleranceSquared) {
+            keep[farthest] = true;
+            segments.emplace_back(first, farthest);
+            segments.emplace_back(farthest, last);
+        }
+    }
+
+    std::vector<uint32_t> kept;
+    for (size_t i = 0; i < count; i++) {
+        if (keep[i]) {
+            kept.push_back(indices[i]);
+        }
+    }
+    return kept;
+}
+
+void TrajectoryStore::_closeChunk()
+{
+    const uint32_t first = static_cast<uint32_t>(_closedCount);
+    const uint32_t last = first + chunkSize;
+
+    std::vector<uint32_t> indices(chunkSize + 1);
+    for (uint32_t i = 0; i <= chunkSize; i++) {
+        indices[i] = first + i;
+    }
+
+    // Each level is simplified from the points the level below kept. The last point is the first
+    // point of the tail, it only becomes part of a level when the next chunk closes.
+    for (int level = 1; level < levelCount; level++) {
+        indices = simplify(indices, levelTolerances[level]);
+        _levelIndices[level].insert(_levelIndices[level].end(), indices.cbegin(), indices.cend() - 1);
+    }
+
+    _closedCount = static_cast<int>(last);
+}
+
+void TrajectoryStore::_compact()
+{
+    const int targetSize = _maxPoints / 2;
+    const int tailSize = size() - _closedCount;
+
+    int keepLevel = 1;
+    while (((keepLevel + 1) < levelCount) && ((static_cast<int>(_levelIndices[keepLevel].size()) + tailSize) > targetSize)) {
+        keepLevel++;
+    }
+    const std::vector<uint32_t> kept = _levelIndices[keepLevel];
+
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<float> altitudes;
+    std::vector<qint64> timesMSecs;
+    const size_t newSize = kept.size() + tailSize;
+    latitudes.reserve(newSize);
+    longitudes.reserve(newSize);
+    altitudes.reserve(newSize);
+    timesMSecs.reserve(newSize);
+
+    const auto keepPoint = [&](uint32_t index) {
+        latitudes.push_back(_latitudes[index]);
+        longitudes.push_back(_longitudes[index]);
+        altitudes.push_back(_altitudes[index]);
+        timesMSecs.push_back(_timesMSecs[index]);
+    };
+    for (const uint32_t index : kept) {
+        keepPoint(index);
+    }
+    for (int index = _closedCount; index < size(); index++) {
+        keepPoint(static_cast<uint32_t>(index));
+    }
+
+    // Levels up to the kept one are now the stored points themselves. Coarser levels are subsets
+    // of the kept one, so their points are found by position in it.
+    for (int level = 1; level < levelCount; level++) {
+        std::vector<uint32_t>& indices = _levelIndices[level];
+        if (level <= keepLevel) {
+            indices.resize(kept.size());
+            for (uint32_t i = 0; i < indices.size(); i++) {
+                indices[i] = i;
+            }
+        } else {
+            for (uint32_t& index : indices) {
+                index = static_cast<uint32_t>(std::lower_bound(kept.cbegin(), kept.cend(), index) - kept.cbegin());
+            }
+        }
+    }
+
+    _latitudes = std::move(latitudes);
+    _longitudes = std::move(longitudes);
+    _altitudes = std::move(altitudes);
+    _timesMSecs = std::move(timesMSecs);
+    _closedCount = static_cast<int>(kept.size());
+    _compactionCount++;
+
+    // Even the coarsest level may not fit after long enough, then the oldest points go
+    if (size() > targetSize) {
+        _dropFront(qMin(size() - targetSize, _closedCount));
+    }
+}
+
+void TrajectoryStore::_dropFront(int count)
+{
+    _latitudes.erase(_latitudes.begin(), _latitudes.begin() + count);
+    _longitudes.erase(_longitudes.begin(), _longitudes.begin() + count);
+    _altitudes.erase(_altitudes.begin(), _altitudes.begin() + count);
+    _timesMSecs.erase(_timesMSecs.begin(), _timesMSecs.begin() + count);
+
+    for (int level = 1; level < levelCount; level++) {
+        std::vector<uint32_t>& indices = _levelIndices[level];
+        indices.erase(indices.begin(), std::lower_bound(indices.begin(), indices.end(), static_cast<uint32_t>(count)));
+        for (uint32_t& index : indices) {
+            index -= static_cast<uint32_t>(count);
+        }
+    }
+
+    _closedCount -= count;
+}
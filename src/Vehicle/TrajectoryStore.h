@@ -0,0 +1,106 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QtGlobal>
+#include <QtPositioning/QGeoCoordinate>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/// Columnar store of a vehicle trajectory with levels of detail for map display.
+///
+/// Points are kept as contiguous latitude/longitude/altitude/time arrays. Level 0 is the stored
+/// track itself. Every chunkSize points the oldest part of the track is closed and simplified with
+/// Douglas-Peucker once for each coarser level, each level working from the points kept by the one
+/// below it. A path at a level is then the simplified closed part followed by the open tail, so
+/// the map only ever has to append the chunk which was just closed and redraw the tail.
+///
+/// Once more than maxPoints are stored the closed part is compacted down to the finest level which
+/// fits in half of maxPoints, dropping the oldest points if even the coarsest level doesn't.
+class TrajectoryStore
+{
+public:
+    static constexpr int levelCount = 4;
+    static constexpr int chunkSize = 256;
+    static constexpr int defaultMaxPoints = 100000;
+
+    /// Douglas-Peucker tolerance in meters used to build each level from the one below it
+    static constexpr std::array<double, levelCount> levelTolerances = { 0.0, 2.0, 8.0, 32.0 };
+
+    TrajectoryStore(int maxPoints = defaultMaxPoints);
+
+    /// Appends a point to the tail
+    ///     @return true: a chunk was closed or the store compacted
+    bool append(const QGeoCoordinate& coordinate, qint64 timeMSecs);
+    /// Moves the last point of the tail
+    void replaceLast(const QGeoCoordinate& coordinate, qint64 timeMSecs);
+    void clear();
+
+    int size() const { return static_cast<int>(_latitudes.size()); }
+    bool isEmpty() const { return _latitudes.empty(); }
+    double latitude(int index) const { return _latitudes[index]; }
+    double longitude(int index) const { return _longitudes[index]; }
+    /// NaN if the point had no altitude
+    float altitude(int index) const { return _altitudes[index]; }
+    qint64 timeMSecs(int index) const { return _timesMSecs[index]; }
+    QGeoCoordinate coordinate(int index) const;
+
+    /// Index of the first point of the open tail, everything before is simplified
+    int closedCount() const { return _closedCount; }
+    /// Number of times the store was compacted, the stored indices all change when it is
+    int compactionCount() const { return _compactionCount; }
+
+    /// Number of points of the path at a level
+    int pathSize(int level) const { return closedPathSize(level) + (size() - _closedCount); }
+    /// Number of points of the path at a level which come from the closed part
+    int closedPathSize(int level) const;
+    /// Index into the store of a point of the path at a level
+    int pathPointIndex(int level, int pathIndex) const;
+    QGeoCoordinate pathCoordinate(int level, int pathIndex) const { return coordinate(pathPointIndex(level, pathIndex)); }
+
+    /// Largest distance in meters between the track and the path at a level. The tolerances of
+    /// the levels below add up since each level is simplified from the previous one.
+    static double levelError(int level);
+    /// @return The coarsest level which keeps the path within metersPerPixel of the track
+    static int levelForResolution(double metersPerPixel);
+
+    /// Writes every stored point as a CSV row of UTC time, latitude, longitude and altitude. The
+    /// altitude column is left empty for points without one.
+    ///     @return false: errorString is set
+    bool saveToCsv(const QString& filename, QString& errorString) const;
+    /// Writes every stored point to a KML gx:Track, which keeps the time of each point
+    ///     @return false: errorString is set
+    bool saveToKml(const QString& filename, const QString& documentName, const QString& trackName, QString& errorString) const;
+
+    /// Simplifies a polyline, the first and last point are always kept
+    ///     @param indices Store indices of the polyline
+    ///     @return The kept indices in order
+    std::vector<uint32_t> simplify(const std::vector<uint32_t>& indices, double toleranceMeters) const;
+
+private:
+    void _closeChunk();
+    void _compact();
+    void _dropFront(int count);
+
+    std::vector<double>     _latitudes;
+    std::vector<double>     _longitudes;
+    std::vector<float>      _altitudes;
+    std::vector<qint64>     _timesMSecs;
+
+    /// Store indices of the closed part for each level above 0
+    std::array<std::vector<uint32_t>, levelCount> _levelIndices;
+
+    int _closedCount = 0;
+    int _compactionCount = 0;
+    int _maxPoints;
+};
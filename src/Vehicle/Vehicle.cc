@@ -271,6 +271,7 @@ void Vehicle::_commonInit()
     connect(this, &Vehicle::homePositionChanged,    this, &Vehicle::_updateDistanceHeadingToHome);
     connect(this, &Vehicle::hobbsMeterChanged,      this, &Vehicle::_updateHobbsMeter);
     connect(this, &Vehicle::coordinateChanged,      this, &Vehicle::_updateAltAboveTerrain);
+    connect(this, &Vehicle::coordinateChanged,      this, &Vehicle::_updateADSBOwnShip);
     // Initialize alt above terrain to Nan so frontend can display it correctly in case the terrain query had no response
     _altitudeAboveTerrFact.setRawValue(qQNaN());
 
@@ -346,6 +347,9 @@ void Vehicle::_commonInit()
     _addFactGroup(&_efiFactGroup,               _efiFactGroupName);
     _addFactGroup(&_terrainFactGroup,           _terrainFactGroupName);
 
+    // Battery groups are added as batteries show up, the dispatch table is rebuilt with the next message
+    (void) connect(this, &FactGroup::factGroupNamesChanged, this, [this]() { _messageDispatchDirty = true; });
+
     // Add firmware-specific fact groups, if provided
     QMap<QString, FactGroup*>* fwFactGroups = _firmwarePlugin->factGroups();
     if (fwFactGroups) {
@@ -389,6 +393,8 @@ Vehicle::~Vehicle()
 
 void Vehicle::prepareDelete()
 {
+    _toolbox->adsbVehicleManager()->ownShipRemoved(_id);
+
 #if 0
     // I believe this should no longer be needed with new PhtoVideoControl implmenentation.
     // Leaving in for now, just in case it need to come back.
@@ -517,12 +523,12 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     // Battery fact groups are created dynamically as new batteries are discovered
     VehicleBatteryFactGroup::handleMessageForFactGroupCreation(this, message);
 
-    // Let the fact groups take a whack at the mavlink traffic
-    for (FactGroup* factGroup : factGroups()) {
-        factGroup->handleMessage(this, message);
-    }
+    QElapsedTimer handlerTimer;
+    handlerTimer.start();
 
-    this->handleMessage(this, message);
+    // Let the fact groups take a whack at the mavlink traffic
+    _dispatchToFactGroups(message);
+    _mavlink->factGroupsUpdated();
 
     switch (message.msgid) {
     case MAVLINK_MSG_ID_HOME_POSITION:
@@ -653,11 +659,57 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     }
     }
 
+    const qint64 handlerNsecs = handlerTimer.nsecsElapsed();
+    MessageHandlerStats& stats = _messageHandlerStats[message.msgid];
+    stats.count++;
+    stats.totalNsecs += handlerNsecs;
+    stats.maxNsecs = qMax(stats.maxNsecs, handlerNsecs);
+
     // This must be emitted after the vehicle processes the message. This way the vehicle state is up to date when anyone else
     // does processing.
     emit mavlinkMessageReceived(message);
 }
 
+void Vehicle::_dispatchToFactGroups(mavlink_message_t& message)
+{
+    if (_messageDispatchDirty) {
+        _buildMessageDispatch();
+    }
+
+    for (FactGroup* factGroup : std::as_const(_allMessagesFactGroups)) {
+        factGroup->handleMessage(this, message);
+    }
+
+    const auto it = _messageDispatch.constFind(message.msgid);
+    if (it != _messageDispatch.constEnd()) {
+        for (FactGroup* factGroup : it.value()) {
+            factGroup->handleMessage(this, message);
+        }
+    }
+}
+
+void Vehicle::_buildMessageDispatch(void)
+{
+    _messageDispatch.clear();
+    _allMessagesFactGroups.clear();
+
+    QList<FactGroup*> groups = factGroups().values();
+    groups.append(this);
+    for (FactGroup* factGroup : std::as_const(groups)) {
+        const QList<uint32_t> msgIds = factGroup->handledMessageIds();
+        if (msgIds.contains(FactGroup::allMessageIds)) {
+            _allMessagesFactGroups.append(factGroup);
+            continue;
+        }
+        for (const uint32_t msgId : msgIds) {
+            _messageDispatch[msgId].append(factGroup);
+        }
+    }
+
+    _messageDispatchDirty = false;
+    qCDebug(VehicleLog) << "Message dispatch built for" << groups.count() << "fact groups," << _messageDispatch.count() << "message ids";
+}
+
 #if !defined(NO_ARDUPILOT_DIALECT)
 void Vehicle::_handleCameraFeedback(const mavlink_message_t& message)
 {
@@ -3237,6 +3289,24 @@ bool Vehicle::autoDisarm()
     return false;
 }
 
+void Vehicle::_updateADSBOwnShip()
+{
+    static const QString icaoParam = QStringLiteral("ADSB_ICAO_ID");
+
+    ADSBVehicleManager::OwnShip_t ownShip;
+    ownShip.coordinate = _coordinate;
+    ownShip.altitude = _coordinate.altitude();
+    ownShip.icaoAddress = 0;
+    if (_parameterManager->parametersReady() && _parameterManager->parameterExists(ParameterManager::defaultComponentId, icaoParam)) {
+        const int icaoAddress = _parameterManager->getParameter(ParameterManager::defaultComponentId, icaoParam)->rawValue().toInt();
+        if (icaoAddress > 0) {
+            ownShip.icaoAddress = static_cast<uint32_t>(icaoAddress);
+        }
+    }
+
+    _toolbox->adsbVehicleManager()->ownShipUpdate(_id, ownShip);
+}
+
 void Vehicle::_handleADSBVehicle(const mavlink_message_t& message)
 {
     mavlink_adsb_vehicle_t adsbVehicleMsg;
@@ -3259,6 +3329,9 @@ void Vehicle::_handleADSBVehicle(const mavlink_message_t& message)
         if (adsbVehicleMsg.flags & ADSB_FLAGS_VALID_ALTITUDE) {
             vehicleInfo.altitude = (double)adsbVehicleMsg.altitude / 1e3;
             vehicleInfo.availableFlags |= ADSBVehicle::AltitudeAvailable;
+            if (adsbVehicleMsg.altitude_type == ADSB_ALTITUDE_TYPE_GEOMETRIC) {
+                vehicleInfo.availableFlags |= ADSBVehicle::AltitudeGeometric;
+            }
         }
 
         if (adsbVehicleMsg.flags & ADSB_FLAGS_VALID_HEADING) {
@@ -110,6 +110,7 @@ class Vehicle : public VehicleFactGroup
     friend class SendMavCommandWithSignallingTest;  // Unit test
     friend class SendMavCommandWithHandlerTest;     // Unit test
     friend class RequestMessageTest;                // Unit test
+    friend class VehicleMessageDispatchTest;        // Unit test
 
 
 public:
@@ -940,6 +941,7 @@ private slots:
     void _gotProgressUpdate                 (float progressValue);
     void _doSetHomeTerrainReceived          (bool success, QList<double> heights);
     void _updateAltAboveTerrain             ();
+    void _updateADSBOwnShip                 ();
     void _altitudeAboveTerrainReceived      (bool sucess, QList<double> heights);
 
 private:
@@ -1325,6 +1327,30 @@ private:
     QMultiHash<uint8_t, uint16_t> _unsupportedMessageIds;
     uint16_t _lastSetMsgIntervalMsgId = 0;
 
+/*===========================================================================*/
+/*                         MESSAGE DISPATCH                                  */
+/*===========================================================================*/
+public:
+    /// Time spent in the fact group and vehicle handlers for a message id
+    struct MessageHandlerStats {
+        quint64 count       = 0;
+        qint64  totalNsecs  = 0;
+        qint64  maxNsecs    = 0;
+    };
+
+    MessageHandlerStats messageHandlerStats(uint32_t msgId) const { return _messageHandlerStats.value(msgId); }
+
+private:
+    void _dispatchToFactGroups  (mavlink_message_t& message);
+    void _buildMessageDispatch  (void);
+
+    /// Fact groups by the message ids they handle, built from FactGroup::handledMessageIds when the fact groups change.
+    /// The vehicle itself is included and stays last in each list, after its groups.
+    QHash<uint32_t, QList<FactGroup*>>      _messageDispatch;
+    QList<FactGroup*>                       _allMessagesFactGroups;     ///< Groups which don't declare their message ids
+    bool                                    _messageDispatchDirty = true;
+    QHash<uint32_t, MessageHandlerStats>    _messageHandlerStats;
+
 /*===========================================================================*/
 /*                         STATUS TEXT HANDLER                               */
 /*===========================================================================*/
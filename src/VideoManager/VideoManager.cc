@@ -19,6 +19,7 @@
 #include "VideoReceiver.h"
 #include "VideoSettings.h"
 #include "SubtitleWriter.h"
+#include "VideoLatencyStats.h"
 
 #ifdef QGC_GST_STREAMING
 #include "GStreamer.h"
@@ -50,6 +51,9 @@ VideoManager::VideoManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , _subtitleWriter(new SubtitleWriter(this))
 {
+    _latencyStatsTimer.setInterval(1000);
+    connect(&_latencyStatsTimer, &QTimer::timeout, this, &VideoManager::_updateLatencyStats);
+
 #ifndef QGC_GST_STREAMING
     qmlRegisterType<GLVideoItemStub>("org.freedesktop.gstreamer.Qt6GLVideoItem", 1, 0, "GstGLQt6VideoItem");
 #endif
@@ -95,6 +99,11 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
    connect(_videoSettings->tcpUrl(),        &Fact::rawValueChanged, this, &VideoManager::_tcpUrlChanged);
    connect(_videoSettings->aspectRatio(),   &Fact::rawValueChanged, this, &VideoManager::aspectRatioChanged);
    connect(_videoSettings->lowLatencyMode(),&Fact::rawValueChanged, this, &VideoManager::_lowLatencyModeChanged);
+   connect(_videoSettings->recordingPreroll(), &Fact::rawValueChanged, this, &VideoManager::_recordingPrerollChanged);
+   connect(_videoSettings->latencyStats(),  &Fact::rawValueChanged, this, &VideoManager::_latencyStatsEnabledChanged);
+   if (_videoSettings->latencyStats()->rawValue().toBool()) {
+       _latencyStatsTimer.start();
+   }
    MultiVehicleManager *pVehicleMgr = _toolbox->multiVehicleManager();
    connect(pVehicleMgr, &MultiVehicleManager::activeVehicleChanged, this, &VideoManager::_setActiveVehicle);
 
@@ -540,6 +549,96 @@ VideoManager::_lowLatencyModeChanged()
     _restartAllVideos();
 }
 
+//-----------------------------------------------------------------------------
+void
+VideoManager::_recordingPrerollChanged()
+{
+    const unsigned seconds = _videoSettings->recordingPreroll()->rawValue().toUInt();
+    for (VideoReceiverData &videoReceiver : _videoReceiverData) {
+        if (videoReceiver.receiver) {
+            videoReceiver.receiver->setPrerollDuration(seconds);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_latencyStatsEnabledChanged()
+{
+    const bool enabled = _videoSettings->latencyStats()->rawValue().toBool();
+    for (VideoReceiverData &videoReceiver : _videoReceiverData) {
+        if (videoReceiver.receiver) {
+            videoReceiver.receiver->setLatencyStatsEnabled(enabled);
+        }
+    }
+
+    if (enabled) {
+        _latencyStatsTimer.start();
+    } else {
+        _latencyStatsTimer.stop();
+        _latencyStats.clear();
+        emit latencyStatsChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_updateLatencyStats()
+{
+    VideoLatencyStats* const stats = _videoReceiverData[0].receiver ? _videoReceiverData[0].receiver->latencyStats() : nullptr;
+
+    if (stats == nullptr) {
+        if (!_latencyStats.isEmpty()) {
+            _latencyStats.clear();
+            emit latencyStatsChanged();
+        }
+        return;
+    }
+
+    const VideoLatencyStats::Summary_t summary = stats->summary();
+
+    _latencyStats = {
+        { "frames",         summary.frames },
+        { "droppedFrames",  summary.droppedFrames },
+        { "median",         summary.medianMs },
+        { "p95",            summary.p95Ms },
+        { "p99",            summary.p99Ms },
+        { "jitter",         summary.jitterMs },
+        { "parse",          summary.parseMs },
+        { "decode",         summary.decodeMs },
+        { "render",         summary.renderMs },
+    };
+    emit latencyStatsChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::exportLatencyStats()
+{
+    VideoLatencyStats* const stats = _videoReceiverData[0].receiver ? _videoReceiverData[0].receiver->latencyStats() : nullptr;
+
+    if (stats == nullptr || !_videoSettings->latencyStats()->rawValue().toBool()) {
+        _app->showAppMessage(tr("Video latency is not being measured."));
+        return;
+    }
+
+    const QString savePath = _toolbox->settingsManager()->appSettings()->videoSavePath();
+
+    if (savePath.isEmpty()) {
+        _app->showAppMessage(tr("Unable to export video latency. Video save path must be specified in Settings."));
+        return;
+    }
+
+    const QString filename = savePath + "/latency_" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh.mm.ss") + ".csv";
+
+    if (!stats->exportCsv(filename)) {
+        _app->showAppMessage(tr("Unable to write video latency to %1.").arg(filename));
+        return;
+    }
+
+    _app->showAppMessage(tr("Video latency saved to %1.").arg(filename));
+}
+
 //-----------------------------------------------------------------------------
 bool
 VideoManager::hasVideo() const
@@ -840,6 +939,8 @@ VideoManager::_startReceiver(unsigned id)
         return;
     }
 
+    _videoReceiverData[id].receiver->setPrerollDuration(_videoSettings->recordingPreroll()->rawValue().toUInt());
+    _videoReceiverData[id].receiver->setLatencyStatsEnabled(_videoSettings->latencyStats()->rawValue().toBool());
     _videoReceiverData[id].receiver->start(_videoReceiverData[id].uri, timeout, _videoReceiverData[id].lowLatencyStreaming ? -1 : 0);
 }
 
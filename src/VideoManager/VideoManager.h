@@ -13,6 +13,8 @@
 #include <QtCore/QSize>
 #include <QtCore/QRunnable>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QTimer>
+#include <QtCore/QVariantMap>
 
 #include "QGCToolbox.h"
 
@@ -48,6 +50,7 @@ class VideoManager : public QGCTool
     Q_PROPERTY(bool             decoding                READ    decoding                                    NOTIFY decodingChanged)
     Q_PROPERTY(bool             recording               READ    recording                                   NOTIFY recordingChanged)
     Q_PROPERTY(QSize            videoSize               READ    videoSize                                   NOTIFY videoSizeChanged)
+    Q_PROPERTY(QVariantMap      latencyStats            READ    latencyStats                                NOTIFY latencyStatsChanged)
 
 public:
     VideoManager(QGCApplication* app, QGCToolbox* toolbox);
@@ -72,6 +75,8 @@ public:
     bool decoding() const { return _decoding; }
     bool recording() const { return _recording; }
     QSize videoSize() const { return QSize((_videoSize >> 16) & 0xFFFF, _videoSize & 0xFFFF); }
+    /// Latency summary of the primary stream in ms, empty while latency statistics are disabled
+    QVariantMap latencyStats() const { return _latencyStats; }
 
     virtual bool gstreamerEnabled() const;
     virtual bool uvcEnabled() const;
@@ -86,6 +91,9 @@ public:
 
     Q_INVOKABLE void grabImage(const QString& imageFile = QString());
 
+    /// Writes the per frame latency of the primary stream to the video save path
+    Q_INVOKABLE void exportLatencyStats();
+
 signals:
     void hasVideoChanged            ();
     void isGStreamerChanged         ();
@@ -101,6 +109,7 @@ signals:
     void recordingChanged           ();
     void recordingStarted           ();
     void videoSizeChanged           ();
+    void latencyStatsChanged        ();
 
 protected slots:
     void _videoSourceChanged        ();
@@ -108,6 +117,9 @@ protected slots:
     void _rtspUrlChanged            ();
     void _tcpUrlChanged             ();
     void _lowLatencyModeChanged     ();
+    void _recordingPrerollChanged   ();
+    void _latencyStatsEnabledChanged();
+    void _updateLatencyStats        ();
     bool _updateUVC                 ();
     void _setActiveVehicle          (Vehicle* vehicle);
     void _communicationLostChanged  (bool communicationLost);
@@ -150,6 +162,8 @@ protected:
     VideoSettings*          _videoSettings          = nullptr;
     QString                 _uvcVideoSourceID;
     bool                    _fullScreen             = false;
+    QTimer                  _latencyStatsTimer;
+    QVariantMap             _latencyStats;
     Vehicle*                _activeVehicle          = nullptr;
 };
 
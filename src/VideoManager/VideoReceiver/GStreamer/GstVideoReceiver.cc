@@ -32,6 +32,16 @@ QGC_LOGGING_CATEGORY(VideoReceiverLog, "VideoReceiverLog")
 //              |
 //              +-->queue-->_recorderValve[-->_fileSink]
 //
+// With latency statistics enabled, each frame is timed at the tee (after depayload and parse), at
+// the decoder output and when the push into the video sink returns. Nothing queues between the
+// decoder and the sink, so that push returns once the sink has waited for the presentation time and
+// handed the frame to the video item, which draws it with the next scene graph frame. Live sources
+// time stamp buffers on arrival, so the presentation time of a frame also gives the time it came in
+// from the network.
+//
+// With a recording pre-roll, frames reaching the closed _recorderValve are kept in memory starting
+// at a keyframe. Starting a recording pushes them into the file sink ahead of the live frames.
+//
 
 GstVideoReceiver::GstVideoReceiver(QObject* parent)
     : VideoReceiver(parent)
@@ -98,6 +108,9 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
     _timeout = timeout;
     _buffer = buffer;
 
+    _latencyStats.reset();
+    _renderPendingPts.storeRelaxed(GST_CLOCK_TIME_NONE);
+
     qCDebug(VideoReceiverLog) << "Starting" << _uri << ", buffer" << _buffer;
 
     _endOfStream = false;
@@ -151,6 +164,15 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
 
         g_object_set(_recorderValve, "drop", TRUE, nullptr);
 
+        if ((pad = gst_element_get_static_pad(_recorderValve, "sink")) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_get_static_pad() failed";
+            break;
+        }
+
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _prerollProbe, this, nullptr);
+        gst_object_unref(pad);
+        pad = nullptr;
+
         if ((_pipeline = gst_pipeline_new("receiver")) == nullptr) {
             qCCritical(VideoReceiverLog) << "gst_pipeline_new() failed";
             break;
@@ -336,6 +358,13 @@ GstVideoReceiver::stop(void)
 
         gst_element_set_state(_pipeline, GST_STATE_NULL);
 
+        {
+            QMutexLocker lock(&_prerollLock);
+            _clearPreroll();
+            _prerollFlush = false;
+            _prerollPaused = false;
+        }
+
         // FIXME: check if branch is connected and remove all elements from branch
         if (_fileSink != nullptr) {
            _shutdownRecordingBranch();
@@ -566,7 +595,7 @@ GstVideoReceiver::startRecording(const QString& videoFile, FILE_FORMAT format)
     gst_object_unref(probepad);
     probepad = nullptr;
 
-    g_object_set(_recorderValve, "drop", FALSE, nullptr);
+    _startPrerollRecording();
 
     _recording = true;
     qCDebug(VideoReceiverLog) << "Recording started" << _uri;
@@ -598,7 +627,7 @@ GstVideoReceiver::stopRecording(void)
         return;
     }
 
-    g_object_set(_recorderValve, "drop", TRUE, nullptr);
+    _stopPrerollRecording();
 
     _removingRecorder = true;
 
@@ -628,6 +657,47 @@ GstVideoReceiver::takeScreenshot(const QString& imageFile)
     });
 }
 
+void
+GstVideoReceiver::setPrerollDuration(unsigned seconds)
+{
+    if (_needDispatch()) {
+        _slotHandler.dispatch([this, seconds]() {
+            setPrerollDuration(seconds);
+        });
+        return;
+    }
+
+    qCDebug(VideoReceiverLog) << "Recording pre-roll" << seconds << "s" << _uri;
+
+    _prerollSeconds.storeRelaxed(seconds);
+
+    if (seconds == 0) {
+        QMutexLocker lock(&_prerollLock);
+        _clearPreroll();
+        if (_prerollFlush) {
+            // Nothing left to flush, a recording waiting on it starts live
+            _prerollFlush = false;
+            g_object_set(_recorderValve, "drop", FALSE, nullptr);
+        }
+    }
+}
+
+void
+GstVideoReceiver::setLatencyStatsEnabled(bool enabled)
+{
+    if (_needDispatch()) {
+        _slotHandler.dispatch([this, enabled]() {
+            setLatencyStatsEnabled(enabled);
+        });
+        return;
+    }
+
+    qCDebug(VideoReceiverLog) << "Latency statistics" << enabled << _uri;
+
+    _latencyStats.reset();
+    _latencyStatsEnabled.storeRelaxed(enabled);
+}
+
 const char* GstVideoReceiver::_kFileMux[FILE_FORMAT_MAX - FILE_FORMAT_MIN] = {
     "matroskamux",
     "qtmux",
@@ -1055,6 +1125,13 @@ GstVideoReceiver::_onNewDecoderPad(GstPad* pad)
 
     qCDebug(VideoReceiverLog) << "_onNewDecoderPad" << _uri;
 
+    // A frame a removed decoder was still pushing is never rendered
+    _renderPendingPts.storeRelaxed(GST_CLOCK_TIME_NONE);
+
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _decoderProbe, this, nullptr);
+    // Called each time a push from the decoder has returned, which for a frame is after the video sink rendered it
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_IDLE, _renderedProbe, this, nullptr);
+
     if (!_addVideoSink(pad)) {
         qCCritical(VideoReceiverLog) << "_addVideoSink() failed";
     }
@@ -1203,6 +1280,96 @@ GstVideoReceiver::_noteVideoSinkFrame(void)
     }
 }
 
+void
+GstVideoReceiver::_noteLatencyFrame(VideoLatencyStats::Stage stage, GstPad* pad, GstBuffer* buf)
+{
+    if (buf == nullptr || !GST_BUFFER_PTS_IS_VALID(buf) || _pipeline == nullptr) {
+        return;
+    }
+
+    const GstClockTime now = _pipelineClockTime();
+
+    if (!GST_CLOCK_TIME_IS_VALID(now)) {
+        return;
+    }
+
+    const quint64 pts = GST_BUFFER_PTS(buf);
+
+    switch (stage) {
+    case VideoLatencyStats::StageParsed:
+        do {
+            // Only trust the arrival time from the timestamp when it is close, non live sources carry stream time
+            const GstClockTime arrival = _bufferClockTime(pad, buf);
+            const bool arrivalValid = GST_CLOCK_TIME_IS_VALID(arrival) && (arrival <= now) && ((now - arrival) < (10 * GST_SECOND));
+            _latencyStats.noteParsed(pts, arrivalValid ? static_cast<qint64>(arrival) : -1, static_cast<qint64>(now));
+        } while(0);
+        break;
+    case VideoLatencyStats::StageDecoded:
+        _latencyStats.noteDecoded(pts, static_cast<qint64>(now));
+        // Rendered once the push into the video sink returns
+        _renderPendingPts.storeRelaxed(pts);
+        break;
+    default:
+        break;
+    }
+}
+
+void
+GstVideoReceiver::_noteLatencyRendered(quint64 pts)
+{
+    const GstClockTime now = _pipelineClockTime();
+
+    if (GST_CLOCK_TIME_IS_VALID(now)) {
+        _latencyStats.noteRendered(pts, static_cast<qint64>(now));
+    }
+}
+
+GstClockTime
+GstVideoReceiver::_pipelineClockTime(void)
+{
+    if (_pipeline == nullptr) {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    GstClock* clock;
+
+    if ((clock = gst_element_get_clock(_pipeline)) == nullptr) {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    const GstClockTime now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+    clock = nullptr;
+
+    return now;
+}
+
+GstClockTime
+GstVideoReceiver::_bufferClockTime(GstPad* pad, GstBuffer* buf)
+{
+    GstEvent* event;
+
+    if ((event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0)) == nullptr) {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    const GstSegment* segment;
+
+    gst_event_parse_segment(event, &segment);
+
+    // Timestamps only map to running time through a time segment
+    const GstClockTime runningTime = (segment->format == GST_FORMAT_TIME) ? gst_segment_to_running_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buf)) : GST_CLOCK_TIME_NONE;
+
+    gst_event_unref(event);
+    event = nullptr;
+
+    if (!GST_CLOCK_TIME_IS_VALID(runningTime)) {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    return gst_element_get_base_time(_pipeline) + runningTime;
+}
+
 void
 GstVideoReceiver::_noteEndOfStream(void)
 {
@@ -1322,6 +1489,11 @@ GstVideoReceiver::_shutdownRecordingBranch(void)
 
     _removingRecorder = false;
 
+    {
+        QMutexLocker lock(&_prerollLock);
+        _prerollPaused = false;
+    }
+
     if (_recording) {
         _recording = false;
         qCDebug(VideoReceiverLog) << "Recording stopped";
@@ -1333,6 +1505,166 @@ GstVideoReceiver::_shutdownRecordingBranch(void)
     GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-recording-stopped");
 }
 
+void
+GstVideoReceiver::_startPrerollRecording(void)
+{
+    // The pre-roll is pushed from the streaming thread, which then opens the valve so the
+    // live frames follow it in order
+    QMutexLocker lock(&_prerollLock);
+    _prerollPaused = true;
+    _prerollFlush = !_prerollFrames.isEmpty();
+    if (_prerollFlush) {
+        qCDebug(VideoReceiverLog) << "Recording starts with" << _prerollFrames.count() << "pre-roll frames" << _uri;
+    } else {
+        g_object_set(_recorderValve, "drop", FALSE, nullptr);
+    }
+}
+
+void
+GstVideoReceiver::_stopPrerollRecording(void)
+{
+    QMutexLocker lock(&_prerollLock);
+    _prerollFlush = false;
+    _prerollGeneration++;
+    _clearPreroll();
+    g_object_set(_recorderValve, "drop", TRUE, nullptr);
+}
+
+void
+GstVideoReceiver::_notePrerollFrame(GstPad* pad, GstBuffer* buf)
+{
+    QQueue<PrerollFrame_t> frames;
+    quint32 generation;
+
+    {
+        QMutexLocker lock(&_prerollLock);
+
+        if (!_prerollFlush) {
+            if (!_prerollPaused && (_prerollSeconds.loadRelaxed() > 0)) {
+                _appendPreroll(buf);
+            }
+            return;
+        }
+
+        _prerollFlush = false;
+        frames.swap(_prerollFrames);
+        _prerollBytes = 0;
+        generation = _prerollGeneration;
+    }
+
+    // Nothing else pushes on this pad until the probe returns, so the frames stay in order without the lock
+    _flushPreroll(pad, frames, generation);
+
+    QMutexLocker lock(&_prerollLock);
+    if (generation == _prerollGeneration) {
+        // This frame is the first live one through
+        g_object_set(_recorderValve, "drop", FALSE, nullptr);
+    }
+}
+
+void
+GstVideoReceiver::_appendPreroll(GstBuffer* buf)
+{
+    const bool keyframe = !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT);
+
+    // A recording has to start on a keyframe
+    if (_prerollFrames.isEmpty() && !keyframe) {
+        return;
+    }
+
+    _prerollFrames.enqueue({ gst_buffer_ref(buf), keyframe });
+    _prerollBytes += gst_buffer_get_size(buf);
+
+    // Drop whole GOPs from the front as long as the frames from the next keyframe on still cover the pre-roll
+    const GstClockTime duration = _prerollSeconds.loadRelaxed() * GST_SECOND;
+    const GstClockTime last = GST_BUFFER_DTS_OR_PTS(buf);
+
+    while (true) {
+        qsizetype nextKeyframe = 1;
+        while ((nextKeyframe < _prerollFrames.count()) && !_prerollFrames[nextKeyframe].keyframe) {
+            nextKeyframe++;
+        }
+        if (nextKeyframe >= _prerollFrames.count()) {
+            break;
+        }
+
+        const GstClockTime start = GST_BUFFER_DTS_OR_PTS(_prerollFrames[nextKeyframe].buffer);
+        const bool covered = GST_CLOCK_TIME_IS_VALID(start) && GST_CLOCK_TIME_IS_VALID(last) && (last >= start) && ((last - start) >= duration);
+        if (!covered && (_prerollBytes <= _kPrerollMaxBytes)) {
+            break;
+        }
+
+        for (qsizetype i = 0; i < nextKeyframe; i++) {
+            GstBuffer* dropped = _prerollFrames.dequeue().buffer;
+            _prerollBytes -= gst_buffer_get_size(dropped);
+            gst_buffer_unref(dropped);
+        }
+    }
+
+    if (_prerollBytes > _kPrerollMaxBytes) {
+        qCDebug(VideoReceiverLog) << "Pre-roll GOP over" << _kPrerollMaxBytes << "bytes, waiting for the next keyframe";
+        _clearPreroll();
+    }
+}
+
+void
+GstVideoReceiver::_flushPreroll(GstPad* pad, QQueue<PrerollFrame_t>& frames, quint32 generation)
+{
+    GstPad* srcpad;
+
+    if ((srcpad = gst_element_get_static_pad(_recorderValve, "src")) == nullptr) {
+        qCCritical(VideoReceiverLog) << "gst_element_get_static_pad() failed";
+        while (!frames.isEmpty()) {
+            gst_buffer_unref(frames.dequeue().buffer);
+        }
+        return;
+    }
+
+    // The closed valve holds back caps and segment, the file sink needs them ahead of the frames
+    gst_pad_sticky_events_foreach(pad, _copyStickyEvent, srcpad);
+
+    qCDebug(VideoReceiverLog) << "Flushing pre-roll of" << frames.count() << "frames";
+
+    GstFlowReturn ret = GST_FLOW_OK;
+
+    bool stopped = false;
+
+    while (!frames.isEmpty()) {
+        GstBuffer* buffer = frames.dequeue().buffer;
+
+        // The lock is only taken between pushes, a stop never waits on the file sink
+        if (!stopped) {
+            QMutexLocker lock(&_prerollLock);
+            stopped = (generation != _prerollGeneration);
+        }
+
+        if ((ret == GST_FLOW_OK) && !stopped) {
+            ret = gst_pad_push(srcpad, buffer);
+        } else {
+            gst_buffer_unref(buffer);
+        }
+    }
+
+    if (stopped) {
+        qCDebug(VideoReceiverLog) << "Recording stopped during the pre-roll flush";
+    } else if (ret != GST_FLOW_OK) {
+        qCWarning(VideoReceiverLog) << "Pre-roll flush failed" << gst_flow_get_name(ret);
+    }
+
+    gst_object_unref(srcpad);
+    srcpad = nullptr;
+}
+
+void
+GstVideoReceiver::_clearPreroll(void)
+{
+    while (!_prerollFrames.isEmpty()) {
+        gst_buffer_unref(_prerollFrames.dequeue().buffer);
+    }
+
+    _prerollBytes = 0;
+}
+
 bool
 GstVideoReceiver::_needDispatch(void)
 {
@@ -1515,23 +1847,35 @@ GstVideoReceiver::_padProbe(GstElement* element, GstPad* pad, gpointer user_data
 GstPadProbeReturn
 GstVideoReceiver::_teeProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
-    Q_UNUSED(pad)
-    Q_UNUSED(info)
-
     if(user_data != nullptr) {
         GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
         pThis->_noteTeeFrame();
+
+        if (info != nullptr && pThis->_latencyStatsEnabled.loadRelaxed()) {
+            pThis->_noteLatencyFrame(VideoLatencyStats::StageParsed, pad, gst_pad_probe_info_get_buffer(info));
+        }
     }
 
     return GST_PAD_PROBE_OK;
 }
 
 GstPadProbeReturn
-GstVideoReceiver::_videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+GstVideoReceiver::_decoderProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
-    Q_UNUSED(pad)
-    Q_UNUSED(info)
+    if(user_data != nullptr && info != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+
+        if (pThis->_latencyStatsEnabled.loadRelaxed()) {
+            pThis->_noteLatencyFrame(VideoLatencyStats::StageDecoded, pad, gst_pad_probe_info_get_buffer(info));
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
 
+GstPadProbeReturn
+GstVideoReceiver::_videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
     if(user_data != nullptr) {
         GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
 
@@ -1568,6 +1912,26 @@ GstVideoReceiver::_videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer u
     return GST_PAD_PROBE_OK;
 }
 
+GstPadProbeReturn
+GstVideoReceiver::_renderedProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+    Q_UNUSED(info)
+
+    if(user_data != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+
+        // Also called after events and when the probe is added, only a frame leaves a timestamp behind
+        const quint64 pts = pThis->_renderPendingPts.fetchAndStoreRelaxed(GST_CLOCK_TIME_NONE);
+
+        if (pts != GST_CLOCK_TIME_NONE && pThis->_latencyStatsEnabled.loadRelaxed()) {
+            pThis->_noteLatencyRendered(pts);
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
 GstPadProbeReturn
 GstVideoReceiver::_eosProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
@@ -1613,3 +1977,33 @@ GstVideoReceiver::_keyframeWatch(GstPad* pad, GstPadProbeInfo* info, gpointer us
 
     return GST_PAD_PROBE_REMOVE;
 }
+
+GstPadProbeReturn
+GstVideoReceiver::_prerollProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    if (info == nullptr || user_data == nullptr) {
+        qCCritical(VideoReceiverLog) << "Invalid arguments";
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstBuffer* buf = gst_pad_probe_info_get_buffer(info);
+
+    if (buf != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+        pThis->_notePrerollFrame(pad, buf);
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+gboolean
+GstVideoReceiver::_copyStickyEvent(GstPad* pad, GstEvent** event, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    if (GST_EVENT_TYPE(*event) != GST_EVENT_EOS) {
+        gst_pad_store_sticky_event(GST_PAD(user_data), *event);
+    }
+
+    return TRUE;
+}
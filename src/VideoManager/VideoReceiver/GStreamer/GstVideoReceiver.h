@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <QtCore/QAtomicInteger>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QTimer>
 #include <QtCore/QThread>
@@ -23,6 +24,7 @@
 #include <QtCore/QQueue>
 
 #include "VideoReceiver.h"
+#include "VideoLatencyStats.h"
 
 #include <gst/gst.h>
 
@@ -83,10 +85,14 @@ class GstVideoReceiver : public VideoReceiver
 {
     Q_OBJECT
 
+    friend class GstVideoReceiverTest;  // Unit test
+
 public:
     explicit GstVideoReceiver(QObject* parent = nullptr);
     ~GstVideoReceiver(void);
 
+    virtual VideoLatencyStats* latencyStats(void) { return &_latencyStats; }
+
 public slots:
     virtual void start(const QString& uri, unsigned timeout, int buffer = 0);
     virtual void stop(void);
@@ -95,6 +101,8 @@ public slots:
     virtual void startRecording(const QString& videoFile, FILE_FORMAT format);
     virtual void stopRecording(void);
     virtual void takeScreenshot(const QString& imageFile);
+    virtual void setPrerollDuration(unsigned seconds);
+    virtual void setLatencyStatsEnabled(bool enabled);
 
 protected slots:
     virtual void _watchdog(void);
@@ -115,6 +123,30 @@ protected:
     virtual bool _unlinkBranch(GstElement* from);
     virtual void _shutdownDecodingBranch (void);
     virtual void _shutdownRecordingBranch(void);
+    virtual void _notePrerollFrame(GstPad* pad, GstBuffer* buf);
+    virtual void _noteLatencyFrame(VideoLatencyStats::Stage stage, GstPad* pad, GstBuffer* buf);
+    virtual void _noteLatencyRendered(quint64 pts);
+
+    // Pipeline clock time the presentation timestamp of a buffer maps to, GST_CLOCK_TIME_NONE if it doesn't
+    GstClockTime _bufferClockTime(GstPad* pad, GstBuffer* buf);
+    // Current time of the pipeline clock, GST_CLOCK_TIME_NONE without one
+    GstClockTime _pipelineClockTime(void);
+
+    typedef struct {
+        GstBuffer*      buffer;
+        bool            keyframe;
+    } PrerollFrame_t;
+
+    // Hands the pre-roll to a starting recording, the valve opens once it has been pushed
+    void _startPrerollRecording(void);
+    // Closes the valve and cancels a pre-roll flush which is still waiting or under way
+    void _stopPrerollRecording(void);
+    // Called from the streaming thread without _prerollLock held, since pushing runs the file sink.
+    // Stops pushing once the recording of generation is stopped.
+    void _flushPreroll(GstPad* pad, QQueue<PrerollFrame_t>& frames, quint32 generation);
+    // Called with _prerollLock held
+    void _appendPreroll(GstBuffer* buf);
+    void _clearPreroll(void);
 
     bool _needDispatch(void);
     void _dispatchSignal(std::function<void()> emitter);
@@ -126,9 +158,13 @@ protected:
     static gboolean _padProbe(GstElement* element, GstPad* pad, gpointer user_data);
     static gboolean _filterParserCaps(GstElement* bin, GstPad* pad, GstElement* element, GstQuery* query, gpointer data);
     static GstPadProbeReturn _teeProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _decoderProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
     static GstPadProbeReturn _videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _renderedProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
     static GstPadProbeReturn _eosProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
     static GstPadProbeReturn _keyframeWatch(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _prerollProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static gboolean _copyStickyEvent(GstPad* pad, GstEvent** event, gpointer user_data);
 
     bool                _streaming;
     bool                _decoding;
@@ -165,6 +201,22 @@ protected:
 
     bool                _endOfStream;
 
+    //-- Recording pre-roll, encoded frames kept on the recorder branch while its valve is closed
+    QAtomicInteger<unsigned> _prerollSeconds = 0;
+    QMutex              _prerollLock;
+    QQueue<PrerollFrame_t> _prerollFrames;
+    gsize               _prerollBytes = 0;
+    bool                _prerollFlush = false;  ///< Flush and open the valve on the next frame
+    bool                _prerollPaused = false; ///< Recording, nothing to keep
+    quint32             _prerollGeneration = 0; ///< Bumped when a recording stops, a flush already under way then leaves the valve closed
+
+    static constexpr gsize _kPrerollMaxBytes = 64 * 1024 * 1024;
+
+    //-- Latency instrumentation
+    QAtomicInteger<bool> _latencyStatsEnabled = false;
+    QAtomicInteger<quint64> _renderPendingPts = GST_CLOCK_TIME_NONE; ///< Frame the decoder is pushing into the video sink
+    VideoLatencyStats   _latencyStats;
+
     static const char*  _kFileMux[FILE_FORMAT_MAX - FILE_FORMAT_MIN];
 };
 
@@ -0,0 +1,203 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoLatencyStats.h"
+
+#include <QtCore/QSaveFile>
+#include <QtCore/QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+/// Nearest rank percentile, reorders values
+double _percentile(std::vector<double>& values, double percent)
+{
+    if (values.empty()) {
+        return 0;
+    }
+
+    // Smallest value with at least percent of the samples at or below it
+    const double n = static_cast<double>(values.size());
+    const double exactRank = std::ceil((percent * n) / 100.0) - 1;
+    const size_t rank = static_cast<size_t>(std::clamp(exactRank, 0.0, n - 1));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+} // namespace
+
+VideoLatencyStats::VideoLatencyStats(int windowFrames)
+    : _windowFrames(std::max(1, windowFrames))
+{
+    _window.reserve(_windowFrames);
+}
+
+void VideoLatencyStats::noteParsed(quint64 pts, qint64 sourceNs, qint64 parsedNs)
+{
+    QMutexLocker lock(&_lock);
+
+    // A repeated timestamp must not restart the clock of the frame which arrived first
+    if (_inFlight.count(pts) != 0) {
+        return;
+    }
+
+    // Frames never make it to the sink while decoding is stopped, don't let them pile up
+    if (_inFlight.size() >= _kMaxInFlight) {
+        _inFlight.erase(_inFlight.begin());
+    }
+
+    Frame_t frame;
+    frame.pts = pts;
+    frame.clockNs[StageSource] = (sourceNs >= 0) ? sourceNs : parsedNs;
+    frame.clockNs[StageParsed] = parsedNs;
+    frame.clockNs[StageDecoded] = -1;
+    frame.clockNs[StageRendered] = -1;
+    _inFlight[pts] = frame;
+}
+
+void VideoLatencyStats::noteDecoded(quint64 pts, qint64 decodedNs)
+{
+    QMutexLocker lock(&_lock);
+
+    const auto it = _inFlight.find(pts);
+    if (it != _inFlight.end()) {
+        it->second.clockNs[StageDecoded] = decodedNs;
+    }
+}
+
+void VideoLatencyStats::noteRendered(quint64 pts, qint64 renderedNs)
+{
+    QMutexLocker lock(&_lock);
+
+    const auto it = _inFlight.find(pts);
+    if (it == _inFlight.end()) {
+        return;
+    }
+
+    for (auto dropped = _inFlight.begin(); dropped != it; ) {
+        dropped = _inFlight.erase(dropped);
+        _droppedFrames++;
+    }
+
+    Frame_t frame = it->second;
+    _inFlight.erase(it);
+
+    if (frame.clockNs[StageDecoded] < 0) {
+        frame.clockNs[StageDecoded] = renderedNs;
+    }
+    frame.clockNs[StageRendered] = renderedNs;
+
+    const qint64 latencyNs = renderedNs - frame.clockNs[StageSource];
+    if (_lastLatencyNs >= 0) {
+        _jitterNs += (std::abs(latencyNs - _lastLatencyNs) - _jitterNs) / 16.0;
+    }
+    _lastLatencyNs = latencyNs;
+
+    if (static_cast<int>(_window.size()) < _windowFrames) {
+        _window.push_back(frame);
+    } else {
+        _window[_windowNext] = frame;
+    }
+    _windowNext = (_windowNext + 1) % _windowFrames;
+}
+
+void VideoLatencyStats::reset(void)
+{
+    QMutexLocker lock(&_lock);
+
+    _inFlight.clear();
+    _window.clear();
+    _windowNext = 0;
+    _droppedFrames = 0;
+    _jitterNs = 0;
+    _lastLatencyNs = -1;
+}
+
+VideoLatencyStats::Summary_t VideoLatencyStats::summary(void) const
+{
+    QMutexLocker lock(&_lock);
+
+    Summary_t summary;
+    summary.frames = static_cast<int>(_window.size());
+    summary.droppedFrames = _droppedFrames;
+    summary.jitterMs = _jitterNs / 1e6;
+
+    if (_window.empty()) {
+        return summary;
+    }
+
+    std::vector<double> values(_window.size());
+    const auto fill = [this, &values](Stage from, Stage to) {
+        for (size_t i = 0; i < _window.size(); i++) {
+            values[i] = _stageMs(_window[i], from, to);
+        }
+    };
+
+    fill(StageSource, StageRendered);
+    summary.medianMs = _percentile(values, 50);
+    summary.p95Ms = _percentile(values, 95);
+    summary.p99Ms = _percentile(values, 99);
+
+    fill(StageSource, StageParsed);
+    summary.parseMs = _percentile(values, 50);
+    fill(StageParsed, StageDecoded);
+    summary.decodeMs = _percentile(values, 50);
+    fill(StageDecoded, StageRendered);
+    summary.renderMs = _percentile(values, 50);
+
+    return summary;
+}
+
+std::vector<VideoLatencyStats::Frame_t> VideoLatencyStats::frames(void) const
+{
+    QMutexLocker lock(&_lock);
+
+    if (static_cast<int>(_window.size()) < _windowFrames) {
+        return _window;
+    }
+
+    std::vector<Frame_t> frames(_window.cbegin() + _windowNext, _window.cend());
+    frames.insert(frames.end(), _window.cbegin(), _window.cbegin() + _windowNext);
+    return frames;
+}
+
+bool VideoLatencyStats::exportCsv(const QString& filename) const
+{
+    const std::vector<Frame_t> completed = frames();
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << csvHeader << '\n';
+    for (const Frame_t& frame : completed) {
+        stream << frame.pts;
+        for (int stage = 0; stage < StageCount; stage++) {
+            stream << ',' << frame.clockNs[stage];
+        }
+        stream << ',' << _stageMs(frame, StageSource, StageParsed)
+               << ',' << _stageMs(frame, StageParsed, StageDecoded)
+               << ',' << _stageMs(frame, StageDecoded, StageRendered)
+               << ',' << _stageMs(frame, StageSource, StageRendered)
+               << '\n';
+    }
+    stream.flush();
+
+    return (stream.status() == QTextStream::Ok) && file.commit();
+}
+
+double VideoLatencyStats::_stageMs(const Frame_t& frame, Stage from, Stage to)
+{
+    return (frame.clockNs[to] - frame.clockNs[from]) / 1e6;
+}
@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <map>
+#include <vector>
+
+/// Latency a video receiver adds to each frame, from the time it arrives from the network to the
+/// time it is rendered. Frames are matched across stages by presentation timestamp. Stages are
+/// noted from the streaming threads, summaries and exports can be taken from any thread.
+class VideoLatencyStats
+{
+public:
+    enum Stage {
+        StageSource = 0,    ///< Arrival from the network
+        StageParsed,        ///< After depayload and parse
+        StageDecoded,       ///< After decode
+        StageRendered,      ///< Returned by the video sink, after its wait for the presentation time and render
+        StageCount
+    };
+
+    typedef struct {
+        quint64 pts;                    ///< Presentation timestamp in ns
+        qint64  clockNs[StageCount];    ///< Clock time each stage was reached, -1 if not seen
+    } Frame_t;
+
+    typedef struct {
+        int     frames          = 0;    ///< Rendered frames in the window
+        quint64 droppedFrames   = 0;    ///< Frames parsed but never rendered since the last reset
+        double  medianMs        = 0;    ///< Source to render
+        double  p95Ms           = 0;
+        double  p99Ms           = 0;
+        double  jitterMs        = 0;    ///< Smoothed frame to frame change of the latency, as RFC 3550
+        double  parseMs         = 0;    ///< Median time from source to parsed
+        double  decodeMs        = 0;    ///< Median time from parsed to decoded
+        double  renderMs        = 0;    ///< Median time from decoded to rendered
+    } Summary_t;
+
+    /// @param windowFrames Number of rendered frames the summary covers
+    explicit VideoLatencyStats(int windowFrames = 600);
+
+    /// Starts tracking a frame. Earlier stages without a timestamp of their own take this one.
+    /// A timestamp already in flight keeps the times of its first arrival.
+    void noteParsed(quint64 pts, qint64 sourceNs, qint64 parsedNs);
+    void noteDecoded(quint64 pts, qint64 decodedNs);
+    /// Completes a frame. Frames with an earlier timestamp still in flight were dropped, sinks render in order.
+    void noteRendered(quint64 pts, qint64 renderedNs);
+
+    void reset(void);
+
+    Summary_t summary(void) const;
+
+    /// Completed frames in the window, oldest first
+    std::vector<Frame_t> frames(void) const;
+
+    /// Writes the frames in the window, one row per frame with the clock times and stage durations
+    bool exportCsv(const QString& filename) const;
+
+    static constexpr const char* csvHeader = "pts_ns,source_ns,parsed_ns,decoded_ns,rendered_ns,parse_ms,decode_ms,render_ms,total_ms";
+
+private:
+    static double _stageMs(const Frame_t& frame, Stage from, Stage to);
+
+    mutable QMutex              _lock;
+    const int                   _windowFrames;
+    std::map<quint64, Frame_t>  _inFlight;
+    std::vector<Frame_t>        _window;        ///< Ring of completed frames
+    size_t                      _windowNext = 0;
+    quint64                     _droppedFrames = 0;
+    double                      _jitterNs = 0;
+    qint64                      _lastLatencyNs = -1;
+
+    static constexpr size_t     _kMaxInFlight = 256;
+};
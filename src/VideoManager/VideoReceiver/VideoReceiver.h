@@ -18,6 +18,8 @@
 #include <QtCore/QObject>
 #include <QtCore/QSize>
 
+class VideoLatencyStats;
+
 class VideoReceiver : public QObject
 {
     Q_OBJECT
@@ -47,6 +49,9 @@ public:
 
     Q_ENUM(STATUS)
 
+    // Per frame latency, only collected while enabled. nullptr if the receiver can't measure it.
+    virtual VideoLatencyStats* latencyStats(void) { return nullptr; }
+
 signals:
     void timeout(void);
     void streamingChanged(bool active);
@@ -75,4 +80,9 @@ public slots:
     virtual void startRecording(const QString& videoFile, FILE_FORMAT format) = 0;
     virtual void stopRecording(void) = 0;
     virtual void takeScreenshot(const QString& imageFile) = 0;
+
+    // Keeps the last seconds of the stream so startRecording() can include them, 0 disables.
+    // Receivers which can't do this ignore it.
+    virtual void setPrerollDuration(unsigned seconds) { Q_UNUSED(seconds) }
+    virtual void setLatencyStatsEnabled(bool enabled) { Q_UNUSED(enabled) }
 };
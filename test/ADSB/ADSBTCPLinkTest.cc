@@ -0,0 +1,266 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBTCPLinkTest.h"
+#include "ADSBTCPLink.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtTest/QTest>
+
+QList<QByteArray> ADSBTCPLinkTest::_captureLines()
+{
+    QFile file(":/BaseStationSample.sbs");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QList<QByteArray> lines;
+    while (!file.atEnd()) {
+        lines.append(file.readLine());
+    }
+    return lines;
+}
+
+/// The QString/QStringList parser ADSBTCPLink used before, kept as the reference for results and speed
+bool ADSBTCPLinkTest::_splitParseLine(const QString &line, ADSBVehicle::ADSBVehicleInfo_t &adsbInfo)
+{
+    if ((line.size() <= 4) || !line.startsWith(QStringLiteral("MSG"))) {
+        return false;
+    }
+
+    const int msgType = line.at(4).digitValue();
+    if ((msgType < 0) || (msgType == ADSB::SurfacePosition) || (msgType > ADSB::SurveillanceId)) {
+        return false;
+    }
+
+    const QStringList values = line.split(QChar(','));
+    if (values.size() <= 4) {
+        return false;
+    }
+
+    bool icaoOk;
+    adsbInfo.icaoAddress = values.at(4).toUInt(&icaoOk, 16);
+    if (!icaoOk) {
+        return false;
+    }
+
+    switch (msgType) {
+    case ADSB::IdentificationAndCategory:
+    case ADSB::SurveillanceAltitude:
+    case ADSB::SurveillanceId:
+    {
+        if (values.size() <= 10) {
+            return false;
+        }
+        const QString callsign = values.at(10).trimmed();
+        if (callsign.isEmpty()) {
+            return false;
+        }
+        adsbInfo.callsign = callsign;
+        adsbInfo.availableFlags = ADSBVehicle::CallsignAvailable;
+        return true;
+    }
+    case ADSB::AirbornePosition:
+    {
+        if (values.size() <= 19) {
+            return false;
+        }
+        QString altitudeStr = values.at(11);
+        const bool geometricAltitude = altitudeStr.endsWith('H');
+        if (geometricAltitude) {
+            altitudeStr.chop(1);
+        }
+        bool altOk, latOk, lonOk, alertOk;
+        const int modeCAltitude = altitudeStr.toInt(&altOk);
+        const double lat = values.at(14).toDouble(&latOk);
+        const double lon = values.at(15).toDouble(&lonOk);
+        const int alert = values.at(19).toInt(&alertOk);
+        if (!altOk || !latOk || !lonOk || !alertOk || (qFuzzyIsNull(lat) && qFuzzyIsNull(lon))) {
+            return false;
+        }
+        adsbInfo.location = QGeoCoordinate(lat, lon);
+        adsbInfo.altitude = modeCAltitude * 0.3048;
+        adsbInfo.alert = (alert == 1);
+        adsbInfo.availableFlags = ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable | ADSBVehicle::AlertAvailable;
+        if (geometricAltitude) {
+            adsbInfo.availableFlags |= ADSBVehicle::AltitudeGeometric;
+        }
+        return true;
+    }
+    case ADSB::AirborneVelocity:
+    {
+        if (values.size() <= 13) {
+            return false;
+        }
+        bool headingOk;
+        adsbInfo.heading = values.at(13).toDouble(&headingOk);
+        if (!headingOk) {
+            return false;
+        }
+        adsbInfo.availableFlags = ADSBVehicle::HeadingAvailable;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void ADSBTCPLinkTest::_parseLocationTest()
+{
+    ADSBVehicle::ADSBVehicleInfo_t info;
+    QVERIFY(ADSB::parseSBS1Line("MSG,3,1,1,4CA2D6,1,2024/05/18,14:36:10.013,2024/05/18,14:36:10.013,,37000,,,47.45821,8.55512,,,0,1,0,0\r\n", info));
+    QCOMPARE(info.icaoAddress, 0x4CA2D6u);
+    QCOMPARE(info.location, QGeoCoordinate(47.45821, 8.55512));
+    QCOMPARE(info.altitude, 37000 * 0.3048);
+    QVERIFY(info.alert);
+    QCOMPARE(info.availableFlags, static_cast<uint32_t>(ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable | ADSBVehicle::AlertAvailable));
+
+    // HAE altitude and negative coordinates
+    QVERIFY(ADSB::parseSBS1Line("MSG,3,1,1,a1b2c3,1,,,,,,1250H,,,-33.94611,-151.17722,,,0,0,0,0", info));
+    QCOMPARE(info.icaoAddress, 0xA1B2C3u);
+    QCOMPARE(info.location, QGeoCoordinate(-33.94611, -151.17722));
+    QCOMPARE(info.altitude, 1250 * 0.3048);
+    QVERIFY(info.availableFlags & ADSBVehicle::AltitudeGeometric);
+    QVERIFY(!info.alert);
+}
+
+void ADSBTCPLinkTest::_parseCallsignAndHeadingTest()
+{
+    ADSBVehicle::ADSBVehicleInfo_t info;
+    QVERIFY(ADSB::parseSBS1Line("MSG,1,1,1,4B1803,1,2024/05/18,14:36:10.013,2024/05/18,14:36:10.013,SWR8    ,,,,,,,,,,,0\n", info));
+    QCOMPARE(info.icaoAddress, 0x4B1803u);
+    QCOMPARE(info.callsign, QStringLiteral("SWR8"));
+    QCOMPARE(info.availableFlags, static_cast<uint32_t>(ADSBVehicle::CallsignAvailable));
+
+    QVERIFY(ADSB::parseSBS1Line("MSG,4,1,1,4B1803,1,2024/05/18,14:36:10.013,2024/05/18,14:36:10.013,,,420,271.4,,,-1280,,0,0,0,0", info));
+    QCOMPARE(info.heading, 271.4);
+    QCOMPARE(info.availableFlags, static_cast<uint32_t>(ADSBVehicle::HeadingAvailable));
+}
+
+void ADSBTCPLinkTest::_parseRejectTest()
+{
+    static const char *const lines[] = {
+        "",
+        "MSG",
+        "STA,,1,1,4B1803,1,2024/05/18,14:36:10.013,2024/05/18,14:36:10.013,RM",
+        "MSG,X,1,1,4B1803",
+        // Surface position and message types past 6 are skipped
+        "MSG,2,1,1,4B1803,1,,,,,,0,12,90,47.45821,8.55512,,,0,0,0,1",
+        "MSG,8,1,1,4B1803,1,,,,,,,,,,,,,,,,0",
+        // Bad ICAO address
+        "MSG,3,1,1,XYZ,1,,,,,,37000,,,47.45821,8.55512,,,0,0,0,0",
+        "MSG,3,1,1,,1,,,,,,37000,,,47.45821,8.55512,,,0,0,0,0",
+        // Truncated
+        "MSG,3,1,1,4B1803,1,,,,,,37000,,,47.45821,8.55512",
+        "MSG,4,1,1,4B1803,1,,,,,,,420",
+        "MSG,1,1,1,4B1803",
+        // Missing or bad values
+        "MSG,3,1,1,4B1803,1,,,,,,,,,47.45821,8.55512,,,0,0,0,0",
+        "MSG,3,1,1,4B1803,1,,,,,,37000,,,47.4x,8.55512,,,0,0,0,0",
+        "MSG,3,1,1,4B1803,1,,,,,,37000,,,0,0,,,0,0,0,0",
+        "MSG,4,1,1,4B1803,1,,,,,,,420,,,,,,0,0,0,0",
+        "MSG,1,1,1,4B1803,1,,,,,        ,,,,,,,,,,,0",
+    };
+
+    for (const char *const line : lines) {
+        ADSBVehicle::ADSBVehicleInfo_t info;
+        QVERIFY2(!ADSB::parseSBS1Line(line, info), line);
+    }
+}
+
+void ADSBTCPLinkTest::_parseCaptureTest()
+{
+    const QList<QByteArray> lines = _captureLines();
+    QVERIFY(!lines.isEmpty());
+
+    int parsed = 0;
+    for (const QByteArray &line : lines) {
+        ADSBVehicle::ADSBVehicleInfo_t info;
+        ADSBVehicle::ADSBVehicleInfo_t splitInfo;
+        const bool ok = ADSB::parseSBS1Line(line, info);
+        const bool splitOk = _splitParseLine(QString::fromLatin1(line).trimmed(), splitInfo);
+        QCOMPARE(ok, splitOk);
+        if (!ok) {
+            continue;
+        }
+        parsed++;
+
+        QCOMPARE(info.icaoAddress, splitInfo.icaoAddress);
+        QCOMPARE(info.availableFlags, splitInfo.availableFlags);
+        if (info.availableFlags & ADSBVehicle::CallsignAvailable) {
+            QCOMPARE(info.callsign, splitInfo.callsign);
+        }
+        if (info.availableFlags & ADSBVehicle::LocationAvailable) {
+            QCOMPARE(info.location, splitInfo.location);
+            QCOMPARE(info.altitude, splitInfo.altitude);
+            QCOMPARE(info.alert, splitInfo.alert);
+        }
+        if (info.availableFlags & ADSBVehicle::HeadingAvailable) {
+            QCOMPARE(info.heading, splitInfo.heading);
+        }
+    }
+
+    // Position, velocity and identification messages with a callsign
+    QCOMPARE(parsed, 247);
+}
+
+/// Replays the capture through both parsers, the way lines come out of the socket buffer
+void ADSBTCPLinkTest::_benchmarkReplay()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int replayCount = 2000;
+
+    QByteArray capture;
+    for (const QByteArray &line : _captureLines()) {
+        capture.append(line);
+    }
+    QVERIFY(!capture.isEmpty());
+
+    int parsed = 0;
+    qsizetype lineCount = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < replayCount; i++) {
+        const QByteArrayView buffer(capture);
+        qsizetype lineStart = 0;
+        qsizetype newline;
+        while ((newline = buffer.indexOf('\n', lineStart)) >= 0) {
+            ADSBVehicle::ADSBVehicleInfo_t info;
+            if (ADSB::parseSBS1Line(buffer.sliced(lineStart, newline - lineStart), info)) {
+                parsed++;
+            }
+            lineCount++;
+            lineStart = newline + 1;
+        }
+    }
+    const qint64 viewNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    int splitParsed = 0;
+    timer.restart();
+    for (int i = 0; i < replayCount; i++) {
+        const QByteArrayView buffer(capture);
+        qsizetype lineStart = 0;
+        qsizetype newline;
+        while ((newline = buffer.indexOf('\n', lineStart)) >= 0) {
+            ADSBVehicle::ADSBVehicleInfo_t info;
+            if (_splitParseLine(QString::fromLocal8Bit(buffer.sliced(lineStart, newline + 1 - lineStart)).trimmed(), info)) {
+                splitParsed++;
+            }
+            lineStart = newline + 1;
+        }
+    }
+    const qint64 splitNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    QCOMPARE(parsed, splitParsed);
+    qCInfo(UnitTestBenchmarkLog) << "SBS-1 lines:" << lineCount << "updates:" << parsed << "MB:" << ((capture.size() * replayCount) / (1024 * 1024));
+    qCInfo(UnitTestBenchmarkLog) << "  view parser:" << ((lineCount * 1000000000) / viewNsecs) << "lines/s";
+    qCInfo(UnitTestBenchmarkLog) << "  split parser:" << ((lineCount * 1000000000) / splitNsecs) << "lines/s";
+}
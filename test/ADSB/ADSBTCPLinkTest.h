@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "ADSBVehicle.h"
+
+class ADSBTCPLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ADSBTCPLinkTest() = default;
+
+private slots:
+    void _parseLocationTest();
+    void _parseCallsignAndHeadingTest();
+    void _parseRejectTest();
+    void _parseCaptureTest();
+    void _benchmarkReplay();
+
+private:
+    static QList<QByteArray> _captureLines();
+    static bool _splitParseLine(const QString &line, ADSBVehicle::ADSBVehicleInfo_t &adsbInfo);
+};
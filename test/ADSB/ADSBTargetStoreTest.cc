@@ -0,0 +1,217 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBTargetStoreTest.h"
+#include "ADSBTargetStore.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRandomGenerator>
+#include <QtTest/QTest>
+
+#include <algorithm>
+
+ADSBVehicle::ADSBVehicleInfo_t ADSBTargetStoreTest::_locationInfo(uint32_t icaoAddress, double latitude, double longitude, double altitude)
+{
+    ADSBVehicle::ADSBVehicleInfo_t vehicleInfo;
+    vehicleInfo.icaoAddress = icaoAddress;
+    vehicleInfo.location = QGeoCoordinate(latitude, longitude);
+    vehicleInfo.altitude = altitude;
+    vehicleInfo.alert = false;
+    vehicleInfo.availableFlags = ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable | ADSBVehicle::AlertAvailable;
+    return vehicleInfo;
+}
+
+void ADSBTargetStoreTest::_addRandomTargets(ADSBTargetStore& store, int count, const QGeoCoordinate& center, double spreadDegrees, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    for (int i = 0; i < count; i++) {
+        double longitude = center.longitude() + ((random.generateDouble() * 2.0) - 1.0) * spreadDegrees;
+        if (longitude >= 180.0) {
+            longitude -= 360.0;
+        } else if (longitude < -180.0) {
+            longitude += 360.0;
+        }
+        const double latitude = center.latitude() + ((random.generateDouble() * 2.0) - 1.0) * spreadDegrees;
+        (void) store.update(_locationInfo(0x100000 + i, latitude, longitude, 1000 + i), 0);
+    }
+}
+
+QList<int> ADSBTargetStoreTest::_bruteForceWithin(const ADSBTargetStore& store, const QGeoCoordinate& coordinate, double radiusMeters)
+{
+    QList<int> indices;
+    for (int i = 0; i < store.count(); i++) {
+        if (store.hasLocation(i) && (coordinate.distanceTo(QGeoCoordinate(store.latitude(i), store.longitude(i))) <= radiusMeters)) {
+            indices.append(i);
+        }
+    }
+    return indices;
+}
+
+void ADSBTargetStoreTest::_updateTest()
+{
+    ADSBTargetStore store;
+    QCOMPARE(store.indexOf(0xABCDEF), -1);
+
+    const int index = store.update(_locationInfo(0xABCDEF, 47.4, 8.5, 3000), 100);
+    QCOMPARE(index, 0);
+    QCOMPARE(store.count(), 1);
+    QCOMPARE(store.indexOf(0xABCDEF), 0);
+    QVERIFY(store.hasLocation(0));
+    QVERIFY(qIsNaN(store.heading(0)));
+
+    // Partial updates only touch their own fields
+    ADSBVehicle::ADSBVehicleInfo_t heading;
+    heading.icaoAddress = 0xABCDEF;
+    heading.heading = 90;
+    heading.availableFlags = ADSBVehicle::HeadingAvailable;
+    QCOMPARE(store.update(heading, 200), 0);
+
+    ADSBVehicle::ADSBVehicleInfo_t callsign;
+    callsign.icaoAddress = 0xABCDEF;
+    callsign.callsign = QStringLiteral("SWR123");
+    callsign.availableFlags = ADSBVehicle::CallsignAvailable;
+    QCOMPARE(store.update(callsign, 300), 0);
+
+    const ADSBVehicle::ADSBVehicleInfo_t info = store.info(0);
+    QCOMPARE(info.icaoAddress, 0xABCDEFu);
+    QCOMPARE(info.callsign, QStringLiteral("SWR123"));
+    QCOMPARE(info.location, QGeoCoordinate(47.4, 8.5));
+    QCOMPARE(info.altitude, 3000.0);
+    QCOMPARE(info.heading, 90.0);
+    QCOMPARE(info.availableFlags, static_cast<uint32_t>(ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable | ADSBVehicle::AlertAvailable |
+                                                        ADSBVehicle::HeadingAvailable | ADSBVehicle::CallsignAvailable));
+
+    // Expiry goes by the last update
+    QVERIFY(store.expired(1000, 1000).isEmpty());
+    QCOMPARE(store.expired(1301, 1000), QList<uint32_t>({ 0xABCDEF }));
+}
+
+void ADSBTargetStoreTest::_removeTest()
+{
+    ADSBTargetStore store;
+    for (uint32_t i = 0; i < 5; i++) {
+        (void) store.update(_locationInfo(i + 1, 47.0 + (i * 0.01), 8.0, 1000 * i), 0);
+    }
+
+    // The last target moves into the hole
+    store.removeAt(1);
+    QCOMPARE(store.count(), 4);
+    QCOMPARE(store.indexOf(2), -1);
+    QCOMPARE(store.indexOf(5), 1);
+    QCOMPARE(store.icaoAddress(1), 5u);
+    QCOMPARE(store.latitude(1), 47.04);
+    QCOMPARE(store.altitude(1), 4000.0);
+
+    store.removeAt(store.count() - 1);
+    QCOMPARE(store.count(), 3);
+    QCOMPARE(store.indexOf(4), -1);
+
+    store.removeAt(-1);
+    store.removeAt(10);
+    QCOMPARE(store.count(), 3);
+
+    // The spatial index follows the moved targets
+    QList<int> nearby = store.targetsWithin(QGeoCoordinate(47.04, 8.0), 100);
+    QCOMPARE(nearby, QList<int>({ store.indexOf(5) }));
+    for (const uint32_t icaoAddress : { 1u, 3u, 5u }) {
+        const int index = store.indexOf(icaoAddress);
+        QVERIFY(index >= 0);
+        QCOMPARE(store.icaoAddress(index), icaoAddress);
+    }
+}
+
+void ADSBTargetStoreTest::_targetsWithinTest()
+{
+    ADSBTargetStore store;
+    const QGeoCoordinate airport(47.4582, 8.5555);
+    _addRandomTargets(store, 2000, airport, 1.5, 1);
+
+    QRandomGenerator random(2);
+    for (int i = 0; i < 200; i++) {
+        const QGeoCoordinate coordinate(airport.latitude() + ((random.generateDouble() * 2.0) - 1.0) * 1.5,
+                                        airport.longitude() + ((random.generateDouble() * 2.0) - 1.0) * 1.5);
+        const double radius = 500 + random.bounded(30000);
+
+        QList<int> indexed = store.targetsWithin(coordinate, radius);
+        std::sort(indexed.begin(), indexed.end());
+        QCOMPARE(indexed, _bruteForceWithin(store, coordinate, radius));
+    }
+
+    // Targets moving between cells are picked up
+    (void) store.update(_locationInfo(0x100000, 10.0, 10.0, 0), 0);
+    QCOMPARE(store.targetsWithin(QGeoCoordinate(10.0, 10.0), 10), QList<int>({ store.indexOf(0x100000) }));
+
+    QVERIFY(store.targetsWithin(QGeoCoordinate(), 1000).isEmpty());
+}
+
+void ADSBTargetStoreTest::_antimeridianTest()
+{
+    ADSBTargetStore store;
+    _addRandomTargets(store, 500, QGeoCoordinate(-16.0, 179.9), 0.5, 3);
+
+    for (const double longitude : { 179.95, -179.95, 180.0, -180.0 }) {
+        const QGeoCoordinate coordinate(-16.0, longitude);
+        QList<int> indexed = store.targetsWithin(coordinate, 20000);
+        std::sort(indexed.begin(), indexed.end());
+        const QList<int> expected = _bruteForceWithin(store, coordinate, 20000);
+        QVERIFY(!expected.isEmpty());
+        QCOMPARE(indexed, expected);
+    }
+
+    // Near the pole every longitude is in range
+    ADSBTargetStore polar;
+    _addRandomTargets(polar, 200, QGeoCoordinate(89.95, 0.0), 0.04, 4);
+    (void) polar.update(_locationInfo(0x200000, 89.99, 179.0, 0), 0);
+    QList<int> indexed = polar.targetsWithin(QGeoCoordinate(89.99, 0.0), 10000);
+    std::sort(indexed.begin(), indexed.end());
+    QCOMPARE(indexed, _bruteForceWithin(polar, QGeoCoordinate(89.99, 0.0), 10000));
+}
+
+/// Conflict checks around a busy airport: the grid against checking every target
+void ADSBTargetStoreTest::_benchmarkTargetsWithin()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int queryCount = 1000;
+    static constexpr double radiusMeters = 2000;
+    const QGeoCoordinate airport(47.4582, 8.5555);
+
+    for (const int targetCount : { 300, 3000 }) {
+        ADSBTargetStore store;
+        _addRandomTargets(store, targetCount, airport, 2.0, 5);
+
+        QList<QGeoCoordinate> queries;
+        QRandomGenerator random(6);
+        for (int i = 0; i < queryCount; i++) {
+            queries.append(QGeoCoordinate(airport.latitude() + ((random.generateDouble() * 2.0) - 1.0) * 0.2,
+                                          airport.longitude() + ((random.generateDouble() * 2.0) - 1.0) * 0.2));
+        }
+        (void) store.targetsWithin(airport, radiusMeters);
+
+        qsizetype indexedFound = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (const QGeoCoordinate& coordinate : queries) {
+            indexedFound += store.targetsWithin(coordinate, radiusMeters).count();
+        }
+        const qint64 indexedNsecs = timer.nsecsElapsed();
+
+        qsizetype linearFound = 0;
+        timer.restart();
+        for (const QGeoCoordinate& coordinate : queries) {
+            linearFound += _bruteForceWithin(store, coordinate, radiusMeters).count();
+        }
+        const qint64 linearNsecs = timer.nsecsElapsed();
+
+        QCOMPARE(indexedFound, linearFound);
+        qCInfo(UnitTestBenchmarkLog) << "Targets:" << targetCount << "found:" << indexedFound
+                                     << "grid:" << (indexedNsecs / queryCount) << "ns/query"
+                                     << "linear:" << (linearNsecs / queryCount) << "ns/query";
+    }
+}
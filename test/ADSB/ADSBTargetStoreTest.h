@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "ADSBVehicle.h"
+
+class ADSBTargetStore;
+
+class ADSBTargetStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ADSBTargetStoreTest() = default;
+
+private slots:
+    void _updateTest();
+    void _removeTest();
+    void _targetsWithinTest();
+    void _antimeridianTest();
+    void _benchmarkTargetsWithin();
+
+private:
+    static ADSBVehicle::ADSBVehicleInfo_t _locationInfo(uint32_t icaoAddress, double latitude, double longitude, double altitude);
+    static void _addRandomTargets(ADSBTargetStore& store, int count, const QGeoCoordinate& center, double spreadDegrees, quint32 seed);
+    static QList<int> _bruteForceWithin(const ADSBTargetStore& store, const QGeoCoordinate& coordinate, double radiusMeters);
+};
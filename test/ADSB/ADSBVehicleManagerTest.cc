@@ -0,0 +1,168 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBVehicleManagerTest.h"
+#include "ADSBVehicleManager.h"
+#include "QGCApplication.h"
+
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+static const QGeoCoordinate _ownShipCoordinate(47.3977, 8.5456);
+
+ADSBVehicle::ADSBVehicleInfo_t ADSBVehicleManagerTest::_locationInfo(uint32_t icaoAddress, const QGeoCoordinate& location)
+{
+    ADSBVehicle::ADSBVehicleInfo_t vehicleInfo;
+    vehicleInfo.icaoAddress = icaoAddress;
+    vehicleInfo.location = location;
+    vehicleInfo.availableFlags = ADSBVehicle::LocationAvailable;
+    return vehicleInfo;
+}
+
+ADSBVehicle::ADSBVehicleInfo_t ADSBVehicleManagerTest::_altitudeInfo(uint32_t icaoAddress, double altitude, bool geometric)
+{
+    ADSBVehicle::ADSBVehicleInfo_t vehicleInfo;
+    vehicleInfo.icaoAddress = icaoAddress;
+    vehicleInfo.altitude = altitude;
+    vehicleInfo.availableFlags = ADSBVehicle::AltitudeAvailable | (geometric ? ADSBVehicle::AltitudeGeometric : 0);
+    return vehicleInfo;
+}
+
+ADSBVehicle* ADSBVehicleManagerTest::_adsbVehicle(ADSBVehicleManager& manager, uint32_t icaoAddress)
+{
+    return manager._adsbICAOMap.value(icaoAddress);
+}
+
+void ADSBVehicleManagerTest::_batchingTest()
+{
+    ADSBVehicleManager manager(qgcApp(), qgcApp()->toolbox());
+    QmlObjectListModel* const model = manager.adsbVehicles();
+
+    // Nothing shows up until the tick
+    manager.adsbVehicleUpdate(_locationInfo(1, _ownShipCoordinate.atDistanceAndAzimuth(1000, 0)));
+    manager.adsbVehicleUpdate(_altitudeInfo(1, 1000, false));
+    manager.adsbVehicleUpdate(_altitudeInfo(2, 1000, false));
+    QCOMPARE(model->count(), 0);
+
+    // Updates are merged, targets without a location don't show up
+    manager._applyPendingUpdates();
+    QCOMPARE(model->count(), 1);
+    ADSBVehicle* const adsbVehicle = _adsbVehicle(manager, 1);
+    QVERIFY(adsbVehicle);
+    QCOMPARE(adsbVehicle->coordinate(), _ownShipCoordinate.atDistanceAndAzimuth(1000, 0));
+    QCOMPARE(adsbVehicle->altitude(), 1000.0);
+    QVERIFY(!_adsbVehicle(manager, 2));
+
+    // A burst of updates within one tick changes the target once
+    QSignalSpy coordinateSpy(adsbVehicle, &ADSBVehicle::coordinateChanged);
+    QList<ADSBVehicle::ADSBVehicleInfo_t> burst;
+    for (int i = 1; i <= 10; i++) {
+        burst.append(_locationInfo(1, _ownShipCoordinate.atDistanceAndAzimuth(1000 + (i * 10), 0)));
+    }
+    burst.append(_locationInfo(2, _ownShipCoordinate.atDistanceAndAzimuth(1000, 90)));
+    burst.append(_altitudeInfo(2, 2000, false));
+    manager.adsbVehicleUpdates(burst);
+    QCOMPARE(coordinateSpy.count(), 0);
+    manager._applyPendingUpdates();
+    QCOMPARE(coordinateSpy.count(), 1);
+    QCOMPARE(adsbVehicle->coordinate(), _ownShipCoordinate.atDistanceAndAzimuth(1100, 0));
+
+    // New targets are added with everything which came in during the tick
+    QCOMPARE(model->count(), 2);
+    QVERIFY(_adsbVehicle(manager, 2));
+    QCOMPARE(_adsbVehicle(manager, 2)->altitude(), 2000.0);
+}
+
+void ADSBVehicleManagerTest::_expiryTest()
+{
+    ADSBVehicleManager manager(qgcApp(), qgcApp()->toolbox());
+
+    manager.adsbVehicleUpdate(_locationInfo(1, _ownShipCoordinate));
+    manager.adsbVehicleUpdate(_locationInfo(2, _ownShipCoordinate.atDistanceAndAzimuth(1000, 0)));
+    manager._applyPendingUpdates();
+    QCOMPARE(manager.adsbVehicles()->count(), 2);
+
+    const qint64 now = manager._clock.elapsed();
+    manager._removeExpired(now + (ADSBVehicleManager::expirationTimeoutMSecs / 2));
+    QCOMPARE(manager.adsbVehicles()->count(), 2);
+
+    // An update in between keeps a target alive
+    manager._targets.update(_locationInfo(2, _ownShipCoordinate.atDistanceAndAzimuth(1000, 0)), now + ADSBVehicleManager::expirationTimeoutMSecs);
+    manager._removeExpired(now + ADSBVehicleManager::expirationTimeoutMSecs + 1);
+    QCOMPARE(manager.adsbVehicles()->count(), 1);
+    QVERIFY(!_adsbVehicle(manager, 1));
+    QVERIFY(_adsbVehicle(manager, 2));
+    QCOMPARE(manager.trafficWithin(_ownShipCoordinate, 100).count(), 0);
+
+    manager._removeExpired(now + (ADSBVehicleManager::expirationTimeoutMSecs * 2) + 1);
+    QCOMPARE(manager.adsbVehicles()->count(), 0);
+}
+
+void ADSBVehicleManagerTest::_conflictTest()
+{
+    static constexpr uint32_t ownIcao           = 0xABCDEF;
+    static constexpr uint32_t geometricClose    = 1;
+    static constexpr uint32_t geometricAbove    = 2;
+    static constexpr uint32_t baroClose         = 3;
+    static constexpr uint32_t baroAbove         = 4;
+    static constexpr uint32_t noAltitude        = 5;
+    static constexpr uint32_t farAway           = 6;
+
+    ADSBVehicleManager manager(qgcApp(), qgcApp()->toolbox());
+
+    const QGeoCoordinate nearby = _ownShipCoordinate.atDistanceAndAzimuth(500, 45);
+    const double ownAltitude = 100;
+
+    QList<ADSBVehicle::ADSBVehicleInfo_t> updates;
+    for (const uint32_t icaoAddress: { ownIcao, geometricClose, geometricAbove, baroClose, baroAbove, noAltitude }) {
+        updates.append(_locationInfo(icaoAddress, nearby));
+    }
+    updates.append(_locationInfo(farAway, _ownShipCoordinate.atDistanceAndAzimuth(ADSBVehicleManager::conflictRadiusMeters * 2, 0)));
+    updates.append(_altitudeInfo(ownIcao, ownAltitude, true));
+    updates.append(_altitudeInfo(geometricClose, ownAltitude + 200, true));
+    updates.append(_altitudeInfo(geometricAbove, ownAltitude + 400, true));
+    // Pressure altitude gets the extra margin, 400m off is still too close to call
+    updates.append(_altitudeInfo(baroClose, ownAltitude + 400, false));
+    updates.append(_altitudeInfo(baroAbove, ownAltitude + ADSBVehicleManager::conflictAltitudeMeters + ADSBVehicleManager::pressureAltitudeMarginMeters + 100, false));
+    updates.append(_altitudeInfo(farAway, ownAltitude, true));
+    manager.adsbVehicleUpdates(updates);
+
+    // No own ship, no conflicts
+    manager._applyPendingUpdates();
+    QCOMPARE(manager.adsbVehicles()->count(), 7);
+    for (const uint32_t icaoAddress: { ownIcao, geometricClose, geometricAbove, baroClose, baroAbove, noAltitude, farAway }) {
+        QVERIFY(!_adsbVehicle(manager, icaoAddress)->alert());
+    }
+
+    ADSBVehicleManager::OwnShip_t ownShip;
+    ownShip.coordinate = _ownShipCoordinate;
+    ownShip.altitude = ownAltitude;
+    ownShip.icaoAddress = ownIcao;
+    manager.ownShipUpdate(1, ownShip);
+    manager._applyPendingUpdates();
+
+    QVERIFY(!_adsbVehicle(manager, ownIcao)->alert());  // Our own transponder
+    QVERIFY(_adsbVehicle(manager, geometricClose)->alert());
+    QVERIFY(!_adsbVehicle(manager, geometricAbove)->alert());
+    QVERIFY(_adsbVehicle(manager, baroClose)->alert());
+    QVERIFY(!_adsbVehicle(manager, baroAbove)->alert());
+    QVERIFY(_adsbVehicle(manager, noAltitude)->alert());
+    QVERIFY(!_adsbVehicle(manager, farAway)->alert());
+
+    // Switching to a geometric altitude drops the margin
+    manager.adsbVehicleUpdate(_altitudeInfo(baroClose, ownAltitude + 400, true));
+    manager._applyPendingUpdates();
+    QVERIFY(!_adsbVehicle(manager, baroClose)->alert());
+
+    manager.ownShipRemoved(1);
+    manager._applyPendingUpdates();
+    for (const uint32_t icaoAddress: { ownIcao, geometricClose, geometricAbove, baroClose, baroAbove, noAltitude, farAway }) {
+        QVERIFY(!_adsbVehicle(manager, icaoAddress)->alert());
+    }
+}
@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "ADSBVehicle.h"
+
+class ADSBVehicleManager;
+
+class ADSBVehicleManagerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ADSBVehicleManagerTest() = default;
+
+private slots:
+    void _batchingTest();
+    void _expiryTest();
+    void _conflictTest();
+
+private:
+    static ADSBVehicle::ADSBVehicleInfo_t _locationInfo(uint32_t icaoAddress, const QGeoCoordinate& location);
+    static ADSBVehicle::ADSBVehicleInfo_t _altitudeInfo(uint32_t icaoAddress, double altitude, bool geometric);
+    static ADSBVehicle* _adsbVehicle(ADSBVehicleManager& manager, uint32_t icaoAddress);
+};
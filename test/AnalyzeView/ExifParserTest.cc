@@ -2,6 +2,7 @@
 #include "ExifParser.h"
 #include "GeoTagWorker.h"
 
+#include <QtCore/QBuffer>
 #include <QtTest/QTest>
 
 void ExifParserTest::_readTimeTest()
@@ -44,3 +45,51 @@ void ExifParserTest::_writeTest()
     // QVERIFY(outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
     // QCOMPARE(outputFile.write(imageBuffer), imageBuffer.size());
 }
+
+void ExifParserTest::_readApp1Test()
+{
+    QFile file(":/DSCN0010.jpg");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    qint64 app1Offset = -1;
+    const QByteArray app1 = ExifParser::readApp1(file, &app1Offset);
+    QCOMPARE(app1Offset, 2);
+    QVERIFY(app1.startsWith("\xff\xe1"));
+    QVERIFY(app1.size() < file.size());
+
+    // Only the segment is needed for the capture time
+    file.seek(0);
+    QCOMPARE(ExifParser::readTime(app1), ExifParser::readTime(file.readAll()));
+
+    // The original position is there to read back
+    GeoTagWorker::cameraFeedbackPacket geotag;
+    QVERIFY(ExifParser::readGps(app1, geotag));
+    QVERIFY(geotag.latitude > 43.0 && geotag.latitude < 44.0);
+    QVERIFY(geotag.longitude > 11.0 && geotag.longitude < 12.0);
+}
+
+void ExifParserTest::_patchGpsUnsupportedTest()
+{
+    QFile file(":/DSCN0010.jpg");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray imageBuffer = file.readAll();
+    file.close();
+
+    GeoTagWorker::cameraFeedbackPacket data;
+    data.latitude = 37.225;
+    data.longitude = -80.425;
+    data.altitude = 618.4392;
+
+    // The GPS IFD of this image has no altitude, so it must be left alone
+    QBuffer buffer;
+    buffer.setData(imageBuffer);
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    QVERIFY(!ExifParser::patchGps(buffer, data));
+    QCOMPARE(buffer.data(), imageBuffer);
+
+    // Nor is anything which isn't a JPEG
+    QBuffer notJpeg;
+    notJpeg.setData(QByteArray(256, 'x'));
+    QVERIFY(notJpeg.open(QIODevice::ReadWrite));
+    QVERIFY(!ExifParser::patchGps(notJpeg, data));
+}
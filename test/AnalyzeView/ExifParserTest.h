@@ -12,4 +12,6 @@ public:
 private slots:
 	void _readTimeTest();
 	void _writeTest();
+	void _readApp1Test();
+	void _patchGpsUnsupportedTest();
 };
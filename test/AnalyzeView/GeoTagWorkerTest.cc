@@ -0,0 +1,275 @@
+#include "GeoTagWorkerTest.h"
+#include "ExifParser.h"
+#include "GeoTagWorker.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QtEndian>
+#include <QtTest/QTest>
+
+/// Builds a JPEG the way cameras with a GPS receiver write them: JFIF APP0, then an Exif APP1 segment with
+/// the capture time and a GPS IFD, then the image data. The image data is filler, only the segments in
+/// front of it are ever parsed.
+QByteArray GeoTagWorkerTest::_syntheticJpeg(const QDateTime &captureTime, int scanSize)
+{
+    QByteArray tiff;
+    const auto u16 = [&tiff](uint16_t value) {
+        char bytes[2];
+        qToLittleEndian<uint16_t>(value, bytes);
+        tiff.append(bytes, 2);
+    };
+    const auto u32 = [&tiff](uint32_t value) {
+        char bytes[4];
+        qToLittleEndian<uint32_t>(value, bytes);
+        tiff.append(bytes, 4);
+    };
+    const auto entry = [&u16, &u32](uint16_t tag, uint16_t type, uint32_t count, uint32_t value) {
+        u16(tag);
+        u16(type);
+        u32(count);
+        u32(value);
+    };
+
+    // Header
+    tiff.append("II\x2A\x00", 4);
+    u32(8);
+    // IFD0 at 8: Exif and GPS IFD pointers
+    u16(2);
+    entry(0x8769, 4, 1, 38);
+    entry(0x8825, 4, 1, 76);
+    u32(0);
+    // Exif IFD at 38: DateTimeOriginal
+    u16(1);
+    entry(0x9004, 2, 20, 56);
+    u32(0);
+    // Date string at 56
+    tiff.append(captureTime.toString(QStringLiteral("yyyy:MM:dd HH:mm:ss")).toLatin1());
+    tiff.append('\0');
+    // GPS IFD at 76, rationals from 154
+    u16(6);
+    entry(1, 2, 2, 'N');
+    entry(2, 5, 3, 154);
+    entry(3, 2, 2, 'E');
+    entry(4, 5, 3, 178);
+    entry(5, 1, 1, 0);
+    entry(6, 5, 1, 202);
+    u32(0);
+    tiff.append(QByteArray(24 + 24 + 8, '\0'));
+    Q_ASSERT(tiff.size() == 210);
+
+    QByteArray jpeg("\xFF\xD8", 2);
+    jpeg.append("\xFF\xE0\x00\x10" "JFIF\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00", 18);
+
+    char length[2];
+    qToBigEndian<uint16_t>(static_cast<uint16_t>(2 + 6 + tiff.size()), length);
+    jpeg.append("\xFF\xE1", 2);
+    jpeg.append(length, 2);
+    jpeg.append("Exif\x00\x00", 6);
+    jpeg.append(tiff);
+
+    jpeg.append("\xFF\xDA\x00\x0C", 4);
+    jpeg.append(10, '\0');
+    jpeg.append(scanSize, '\x5A');
+    jpeg.append("\xFF\xD9", 2);
+
+    return jpeg;
+}
+
+bool GeoTagWorkerTest::_writeImages(const QString &directory, int count, int scanSize)
+{
+    const QDateTime firstCapture(QDate(2024, 5, 14), QTime(10, 0, 0));
+    for (int i = 0; i < count; i++) {
+        QFile file(QDir(directory).filePath(QStringLiteral("img_%1.jpg").arg(i, 4, 10, QLatin1Char('0'))));
+        if (!file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+        const QByteArray jpeg = _syntheticJpeg(firstCapture.addSecs(i * 2), scanSize);
+        if (file.write(jpeg) != jpeg.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Writes a ULog with a camera_capture message per image. The sequence numbers select the image by index.
+bool GeoTagWorkerTest::_writeULog(const QString &filename, int count)
+{
+    QByteArray log("ULog\x01\x12\x35\x01", 8);
+    log.append(8, '\0');
+
+    const auto appendMessage = [&log](char type, const QByteArray &payload) {
+        char size[2];
+        qToLittleEndian<uint16_t>(static_cast<uint16_t>(payload.size()), size);
+        log.append(size, 2);
+        log.append(type);
+        log.append(payload);
+    };
+
+    appendMessage('F', "camera_capture:uint64_t timestamp;uint64_t timestamp_utc;uint32_t seq;double lat;double lon;"
+                       "float alt;float ground_distance;int8_t result;uint8_t[7] _padding0;");
+    appendMessage('A', QByteArray("\x00\x01\x00", 3) + "camera_capture");
+
+    for (int i = 0; i < count; i++) {
+        QByteArray data("\x01\x00", 2);
+        const auto append = [&data](const auto value) {
+            data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        append(static_cast<uint64_t>((i + 1) * 2000000ull));
+        append(static_cast<uint64_t>(0));
+        append(static_cast<uint32_t>(i));
+        append(_latitude(i));
+        append(_longitude(i));
+        append(_altitude(i));
+        append(10.0f);
+        append(static_cast<int8_t>(1));
+        data.append(7, '\0');
+        appendMessage('D', data);
+    }
+
+    QFile file(filename);
+    return file.open(QIODevice::WriteOnly) && (file.write(log) == log.size());
+}
+
+bool GeoTagWorkerTest::_runWorker(GeoTagWorker &worker)
+{
+    QString errorMsg;
+    double lastProgress = 0;
+    (void) connect(&worker, &GeoTagWorker::error, this, [&errorMsg](QString msg) { errorMsg = msg; }, Qt::DirectConnection);
+    (void) connect(&worker, &GeoTagWorker::progressChanged, this, [&lastProgress](double progress) { lastProgress = progress; }, Qt::DirectConnection);
+
+    worker.start();
+    const bool finished = worker.wait(120000);
+    worker.disconnect(this);
+
+    if (!errorMsg.isEmpty()) {
+        qWarning() << "Geotagging failed:" << errorMsg;
+    }
+    return finished && errorMsg.isEmpty() && (lastProgress == 100);
+}
+
+void GeoTagWorkerTest::_patchGpsTest()
+{
+    const QByteArray jpeg = _syntheticJpeg(QDateTime(QDate(2024, 5, 14), QTime(10, 0, 0)), 4096);
+
+    QBuffer buffer;
+    buffer.setData(jpeg);
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+
+    GeoTagWorker::cameraFeedbackPacket geotag;
+    geotag.latitude = -33.856784;
+    geotag.longitude = 151.215297;
+    geotag.altitude = 21.5f;
+    QVERIFY(ExifParser::patchGps(buffer, geotag));
+
+    // Same size, nothing moved, and the image data is untouched
+    QCOMPARE(buffer.data().size(), jpeg.size());
+    QCOMPARE(buffer.data().right(4096 + 2), jpeg.right(4096 + 2));
+
+    QVERIFY(buffer.seek(0));
+    const QByteArray app1 = ExifParser::readApp1(buffer);
+    GeoTagWorker::cameraFeedbackPacket readBack;
+    QVERIFY(ExifParser::readGps(app1, readBack));
+    QVERIFY(qAbs(readBack.latitude - geotag.latitude) < 1e-5);
+    QVERIFY(qAbs(readBack.longitude - geotag.longitude) < 1e-5);
+    QVERIFY(qAbs(readBack.altitude - geotag.altitude) < 0.01f);
+    QCOMPARE(ExifParser::readTime(app1), QDateTime(QDate(2024, 5, 14), QTime(10, 0, 0)).toMSecsSinceEpoch() / 1000.0);
+}
+
+void GeoTagWorkerTest::_tagImagesTest()
+{
+    static constexpr int syntheticCount = 24;
+
+    QTemporaryDir dir;
+    const QString imageDirectory = dir.filePath(QStringLiteral("images"));
+    const QString saveDirectory = dir.filePath(QStringLiteral("tagged"));
+    QVERIFY(QDir().mkpath(imageDirectory));
+    QVERIFY(QDir().mkpath(saveDirectory));
+    QVERIFY(_writeImages(imageDirectory, syntheticCount, 64 * 1024));
+
+    // An image without GPS altitude can't be patched and goes through the full rewrite
+    QVERIFY(QFile::copy(QStringLiteral(":/DSCN0010.jpg"), QDir(imageDirectory).filePath(QStringLiteral("img_9999.jpg"))));
+    QVERIFY(QFile::setPermissions(QDir(imageDirectory).filePath(QStringLiteral("img_9999.jpg")), QFile::ReadOwner | QFile::WriteOwner));
+
+    const QString logFile = dir.filePath(QStringLiteral("log.ulg"));
+    QVERIFY(_writeULog(logFile, syntheticCount + 1));
+
+    GeoTagWorker worker;
+    worker.setLogFile(logFile);
+    worker.setImageDirectory(imageDirectory);
+    worker.setSaveDirectory(saveDirectory);
+    worker.setMaxThreads(4);
+    QVERIFY(_runWorker(worker));
+
+    QCOMPARE(worker.exifStats().images, syntheticCount + 1);
+    QCOMPARE(worker.tagStats().images, syntheticCount + 1);
+    QCOMPARE(worker.tagStats().patched, syntheticCount);
+
+    // Only the Exif segments were read, not the image data
+    qint64 imageBytes = 0;
+    for (const QFileInfo &info : QDir(imageDirectory).entryInfoList(QDir::Files)) {
+        imageBytes += info.size();
+    }
+    QVERIFY(worker.exifStats().bytes < (imageBytes / 10));
+
+    for (int i = 0; i < syntheticCount; i++) {
+        const QString name = QStringLiteral("img_%1.jpg").arg(i, 4, 10, QLatin1Char('0'));
+        QFile tagged(QDir(saveDirectory).filePath(name));
+        QVERIFY(tagged.open(QIODevice::ReadOnly));
+        QCOMPARE(tagged.size(), QFileInfo(QDir(imageDirectory).filePath(name)).size());
+
+        GeoTagWorker::cameraFeedbackPacket geotag;
+        QVERIFY(ExifParser::readGps(ExifParser::readApp1(tagged), geotag));
+        QVERIFY(qAbs(geotag.latitude - _latitude(i)) < 1e-5);
+        QVERIFY(qAbs(geotag.longitude - _longitude(i)) < 1e-5);
+        QVERIFY(qAbs(geotag.altitude - _altitude(i)) < 0.01f);
+    }
+
+    const QFileInfo rewritten(QDir(saveDirectory).filePath(QStringLiteral("img_9999.jpg")));
+    QVERIFY(rewritten.exists());
+    QVERIFY(rewritten.size() > QFileInfo(QDir(imageDirectory).filePath(QStringLiteral("img_9999.jpg"))).size());
+}
+
+/// Tags a mapping mission worth of images, once on a single thread and once on the default pool,
+/// and reports the throughput of each stage.
+void GeoTagWorkerTest::_benchmarkGeoTag()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int imageCount = 300;
+    static constexpr int scanSize = 512 * 1024;
+
+    QTemporaryDir dir;
+    const QString imageDirectory = dir.filePath(QStringLiteral("images"));
+    QVERIFY(QDir().mkpath(imageDirectory));
+    QVERIFY(_writeImages(imageDirectory, imageCount, scanSize));
+    const QString logFile = dir.filePath(QStringLiteral("log.ulg"));
+    QVERIFY(_writeULog(logFile, imageCount));
+
+    for (const int threads : { 1, QThread::idealThreadCount() }) {
+        const QString saveDirectory = dir.filePath(QStringLiteral("tagged_%1").arg(threads));
+        QVERIFY(QDir().mkpath(saveDirectory));
+
+        GeoTagWorker worker;
+        worker.setLogFile(logFile);
+        worker.setImageDirectory(imageDirectory);
+        worker.setSaveDirectory(saveDirectory);
+        worker.setMaxThreads(threads);
+
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(_runWorker(worker));
+        const qint64 elapsed = qMax<qint64>(timer.elapsed(), 1);
+
+        const GeoTagWorker::StageStats exif = worker.exifStats();
+        const GeoTagWorker::StageStats tag = worker.tagStats();
+        QCOMPARE(tag.patched, imageCount);
+
+        qCInfo(UnitTestBenchmarkLog) << "Threads:" << threads << "images:" << imageCount << "total ms:" << elapsed;
+        qCInfo(UnitTestBenchmarkLog) << "  EXIF read:" << exif.msecs << "ms" << ((exif.images * 1000) / qMax<qint64>(exif.msecs, 1)) << "images/s"
+                                     << "KB read:" << (exif.bytes / 1024);
+        qCInfo(UnitTestBenchmarkLog) << "  tagging:" << tag.msecs << "ms" << ((tag.images * 1000) / qMax<qint64>(tag.msecs, 1)) << "images/s"
+                                     << "MB written:" << (tag.bytes / (1024 * 1024));
+    }
+}
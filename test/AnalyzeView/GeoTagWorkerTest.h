@@ -0,0 +1,28 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class GeoTagWorker;
+
+class GeoTagWorkerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    GeoTagWorkerTest() = default;
+
+private slots:
+    void _patchGpsTest();
+    void _tagImagesTest();
+    void _benchmarkGeoTag();
+
+private:
+    static QByteArray _syntheticJpeg(const QDateTime &captureTime, int scanSize);
+    static bool _writeImages(const QString &directory, int count, int scanSize);
+    static bool _writeULog(const QString &filename, int count);
+    static double _latitude(int index) { return 47.397742 + (index * 0.0001); }
+    static double _longitude(int index) { return -122.084063 + (index * 0.0001); }
+    static float _altitude(int index) { return 480.f + index; }
+
+    bool _runWorker(GeoTagWorker &worker);
+};
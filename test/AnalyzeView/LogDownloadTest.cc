@@ -14,16 +14,23 @@
 #include "MultiSignalSpy.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
 
 LogDownloadTest::LogDownloadTest(void)
 {
 
 }
 
-void LogDownloadTest::downloadTest(void)
+/// Lists the logs of the mock link and downloads the first one
+///     @param fileSize Size of the simulated log
+///     @param lossPercent Percentage of LOG_DATA packets the mock link loses
+void LogDownloadTest::_downloadWorker(uint32_t fileSize, int lossPercent)
 {
-
     _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(fileSize);
+    _mockLink->setLogDownloadLossPercent(lossPercent);
 
     LogDownloadController* controller = new LogDownloadController();
 
@@ -48,13 +55,16 @@ void LogDownloadTest::downloadTest(void)
     qDebug() << model->count();
     model->value<QGCLogEntry*>(0)->setSelected(true);
 
+    // The mock link sends a LOG_DATA packet every 2 msecs
+    const int downloadTimeout = qMax(10000, static_cast<int>(fileSize / 10));
+
     QString downloadTo = QDir::currentPath();
     qDebug() << "download to:" << downloadTo;
     controller->downloadToDirectory(downloadTo);
     QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, 10000));
     _multiSpyLogDownloadController->clearAllSignals();
     if (controller->downloadingLogs()) {
-        QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, 10000));
+        QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, downloadTimeout));
         QCOMPARE(controller->downloadingLogs(), false);
     }
     _multiSpyLogDownloadController->clearAllSignals();
@@ -65,4 +75,90 @@ void LogDownloadTest::downloadTest(void)
     QFile::remove(downloadFile);
 
     delete controller;
+    delete _multiSpyLogDownloadController;
+    _multiSpyLogDownloadController = nullptr;
+
+    _disconnectMockLink();
+}
+
+void LogDownloadTest::downloadTest(void)
+{
+    _downloadWorker(1000, 0);
+}
+
+void LogDownloadTest::downloadLossTest(void)
+{
+    // Gaps which have to be requested again. Write blocks and request windows are covered by logDownloadDataTest.
+    _downloadWorker(32 * 1024, 5);
+}
+
+void LogDownloadTest::logDownloadDataTest(void)
+{
+    static constexpr uint32_t binSize = MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    // Three write blocks and a partial bin at the end
+    static constexpr uint32_t logSize = (3 * 2048 * binSize) + 45;
+    static constexpr uint32_t binCount = (logSize + binSize - 1) / binSize;
+
+    QByteArray expected(logSize, Qt::Uninitialized);
+    for (uint32_t i = 0; i < logSize; i++) {
+        expected[i] = static_cast<char>((i * 7) % 251);
+    }
+
+    QTemporaryDir dir;
+    QGCLogEntry entry(0, QDateTime(), logSize, true);
+    LogDownloadData downloadData(&entry);
+    QCOMPARE(downloadData.numBins(), binCount);
+    downloadData.file.setFileName(dir.filePath("log.bin"));
+    QVERIFY(downloadData.file.open(QIODevice::WriteOnly));
+    QVERIFY(downloadData.file.resize(logSize));
+
+    // Every bin in an order which jumps between blocks, with every fifth one sent twice
+    QList<uint32_t> bins;
+    for (uint32_t i = 0; i < binCount; i++) {
+        bins.append((i * 3001) % binCount);
+        if ((i % 5) == 0) {
+            bins.append((i * 3001) % binCount);
+        }
+    }
+    for (int i = 0; i < bins.count(); i++) {
+        const uint32_t bin = bins[i];
+        const uint32_t offset = bin * binSize;
+        const uint32_t count = qMin(binSize, logSize - offset);
+        QVERIFY(downloadData.writeBin(bin, reinterpret_cast<const uint8_t*>(expected.constData() + offset), count));
+
+        if (i == bins.count() / 2) {
+            QVERIFY(!downloadData.complete());
+            const uint32_t missing = downloadData.nextMissing(0, binCount);
+            QVERIFY(missing < binCount);
+            QVERIFY(!downloadData.bin_table.testBit(missing));
+            QCOMPARE(downloadData.nextMissing(missing, missing), missing);
+        }
+    }
+    QVERIFY(downloadData.complete());
+    QCOMPARE(downloadData.bins_received, binCount);
+    QCOMPARE(downloadData.written, static_cast<uint>(logSize));
+    QCOMPARE(downloadData.nextMissing(0, binCount), binCount);
+    QVERIFY(downloadData.flush());
+    downloadData.file.close();
+
+    QFile file(dir.filePath("log.bin"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.readAll() == expected);
+}
+
+/// Downloads over a link which loses packets, reporting the time taken and the effective rate
+void LogDownloadTest::benchmarkDownload(void)
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr uint32_t fileSize = 256 * 1024;
+
+    qCInfo(UnitTestBenchmarkLog) << "LogDownloadController" << fileSize << "bytes";
+    for (int lossPercent: { 0, 2, 10 }) {
+        QElapsedTimer timer;
+        timer.start();
+        _downloadWorker(fileSize, lossPercent);
+        const qint64 msecs = qMax<qint64>(timer.elapsed(), 1);
+        qCInfo(UnitTestBenchmarkLog) << "  loss:" << lossPercent << "%" << "time:" << msecs << "ms" << "rate:" << ((fileSize * 1000 / msecs) / 1024) << "KB/s";
+    }
 }
@@ -26,8 +26,13 @@ private slots:
     //void cleanup(void) { _cleanup(); }
 
     void downloadTest(void);
+    void downloadLossTest(void);
+    void logDownloadDataTest(void);
+    void benchmarkDownload(void);
 
 private:
+    void _downloadWorker(uint32_t fileSize, int lossPercent);
+
     // LogDownloadController signals
 
     enum {
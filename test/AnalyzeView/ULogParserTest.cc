@@ -2,6 +2,8 @@
 #include "ULogParser.h"
 #include "GeoTagWorker.h"
 
+#include <QtCore/QBuffer>
+#include <QtCore/QtEndian>
 #include <QtTest/QTest>
 
 void ULogParserTest::_getTagsFromLogTest()
@@ -22,3 +24,136 @@ void ULogParserTest::_getTagsFromLogTest()
     // QVERIFY(!qFuzzyIsNull(firstCameraFeedback.timestamp));
     QVERIFY(firstCameraFeedback.imageSequence != 0);
 }
+
+/// Builds a ULog holding camera_capture messages between runs of larger sensor messages, so the
+/// captures straddle the parser's read chunks.
+QByteArray ULogParserTest::_syntheticLog(int captureCount, int fillerPerCapture)
+{
+    QByteArray log("ULog\x01\x12\x35\x01", 8);
+    log.append(8, '\0');    // timestamp
+
+    const auto appendMessage = [&log](char type, const QByteArray &payload) {
+        char size[2];
+        qToLittleEndian<uint16_t>(static_cast<uint16_t>(payload.size()), size);
+        log.append(size, 2);
+        log.append(type);
+        log.append(payload);
+    };
+    const auto appendData = [&appendMessage](uint16_t msgID, const QByteArray &data) {
+        char id[2];
+        qToLittleEndian<uint16_t>(msgID, id);
+        appendMessage('D', QByteArray(id, 2) + data);
+    };
+    const auto appendAddLogged = [&appendMessage](uint16_t msgID, const QByteArray &name) {
+        char id[2];
+        qToLittleEndian<uint16_t>(msgID, id);
+        appendMessage('A', QByteArray(1, '\0') + QByteArray(id, 2) + name);
+    };
+
+    appendMessage('F', "sensor_combined:uint64_t timestamp;float[64] samples;");
+    appendMessage('F', "camera_capture:uint64_t timestamp;uint64_t timestamp_utc;uint32_t seq;double lat;double lon;"
+                       "float alt;float ground_distance;float[4] q;int8_t result;uint8_t[3] _padding0;");
+    appendAddLogged(0, "sensor_combined");
+    appendAddLogged(1, "camera_capture");
+
+    const QByteArray filler(8 + (64 * 4), '\x55');
+    for (int i = 0; i < captureCount; i++) {
+        for (int j = 0; j < fillerPerCapture; j++) {
+            appendData(0, filler);
+        }
+
+        QByteArray capture;
+        const auto append = [&capture](const auto value) {
+            capture.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        append(static_cast<uint64_t>((i + 1) * 1000000ull));
+        append(static_cast<uint64_t>(1700000000000000ull + (i * 1000000ull)));
+        append(static_cast<uint32_t>(i + 1));
+        append(47.0 + (i * 0.0001));
+        append(8.0 + (i * 0.0001));
+        append(500.0f);
+        append(50.0f);
+        for (int q = 0; q < 4; q++) {
+            append(0.5f);
+        }
+        append(static_cast<int8_t>(1));
+        capture.append(3, '\0');
+        appendData(1, capture);
+    }
+
+    return log;
+}
+
+void ULogParserTest::_streamingTest()
+{
+    static constexpr int captureCount = 1000;
+
+    // ~10 MB of log, many times the parser's read chunk
+    const QByteArray log = _syntheticLog(captureCount, 40);
+    QVERIFY(log.size() > (8 * 1024 * 1024));
+
+    QBuffer buffer;
+    buffer.setData(log);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    QList<double> progressReports;
+    QList<GeoTagWorker::cameraFeedbackPacket> cameraFeedback;
+    QString errorMessage;
+    QVERIFY(ULogParser::getTagsFromLog(buffer, cameraFeedback, errorMessage, [&progressReports](double progress) {
+        progressReports.append(progress);
+        return true;
+    }));
+    QVERIFY(errorMessage.isEmpty());
+
+    QCOMPARE(cameraFeedback.count(), captureCount);
+    for (int i = 0; i < captureCount; i++) {
+        const GeoTagWorker::cameraFeedbackPacket &feedback = cameraFeedback[i];
+        QCOMPARE(feedback.imageSequence, static_cast<uint32_t>(i + 1));
+        QCOMPARE(feedback.timestamp, static_cast<double>(i + 1));
+        QCOMPARE(feedback.timestampUTC, 1700000000.0 + i);
+        QVERIFY(qFuzzyCompare(feedback.latitude, 47.0 + (i * 0.0001)));
+        QVERIFY(qFuzzyCompare(feedback.longitude, 8.0 + (i * 0.0001)));
+        QCOMPARE(feedback.altitude, 500.0f);
+        QCOMPARE(feedback.groundDistance, 50.0f);
+        QCOMPARE(feedback.captureResult, static_cast<uint8_t>(1));
+    }
+
+    // Progress is incremental, not a single report at the end
+    QVERIFY(progressReports.count() > 5);
+    for (int i = 1; i < progressReports.count(); i++) {
+        QVERIFY(progressReports[i] >= progressReports[i - 1]);
+    }
+    QCOMPARE(progressReports.constLast(), 1.0);
+
+    // Same result as parsing from memory
+    QList<GeoTagWorker::cameraFeedbackPacket> inMemoryFeedback;
+    QVERIFY(ULogParser::getTagsFromLog(log, inMemoryFeedback, errorMessage));
+    QCOMPARE(inMemoryFeedback.count(), cameraFeedback.count());
+    QCOMPARE(inMemoryFeedback.constLast().imageSequence, cameraFeedback.constLast().imageSequence);
+}
+
+void ULogParserTest::_cancelTest()
+{
+    const QByteArray log = _syntheticLog(200, 40);
+
+    QBuffer buffer;
+    buffer.setData(log);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    int progressReports = 0;
+    QList<GeoTagWorker::cameraFeedbackPacket> cameraFeedback;
+    QString errorMessage;
+    QVERIFY(!ULogParser::getTagsFromLog(buffer, cameraFeedback, errorMessage, [&progressReports](double) {
+        return (++progressReports < 2);
+    }));
+    QVERIFY(!errorMessage.isEmpty());
+    QCOMPARE(progressReports, 2);
+    QVERIFY(buffer.pos() < log.size());
+
+    // Not a ULog at all
+    QBuffer notULog;
+    notULog.setData(QByteArray(1024, 'x'));
+    QVERIFY(notULog.open(QIODevice::ReadOnly));
+    QVERIFY(!ULogParser::getTagsFromLog(notULog, cameraFeedback, errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+}
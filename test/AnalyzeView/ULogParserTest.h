@@ -11,4 +11,9 @@ public:
 
 private slots:
     void _getTagsFromLogTest();
+    void _streamingTest();
+    void _cancelTest();
+
+private:
+    static QByteArray _syntheticLog(int captureCount, int fillerPerCapture);
 };
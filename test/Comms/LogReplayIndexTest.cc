@@ -0,0 +1,245 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogReplayIndexTest.h"
+#include "LogReplayIndex.h"
+#include "MAVLinkLib.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QtEndian>
+#include <QtTest/QTest>
+
+#include <limits>
+
+bool LogReplayIndexTest::_writeLog(QIODevice& log, int recordCount, quint64 stepUSecs, int junkInterval)
+{
+    QByteArray bytes;
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+
+    for (int i = 0; i < recordCount; i++) {
+        if ((junkInterval > 0) && (i > 0) && ((i % junkInterval) == 0)) {
+            bytes.append(QByteArray(3, '\0'));
+        }
+
+        char timestamp[sizeof(quint64)];
+        qToBigEndian<quint64>(_startTimeUSecs + (i * stepUSecs), timestamp);
+        bytes.append(timestamp, sizeof(timestamp));
+
+        mavlink_message_t message;
+        switch (i % 3) {
+        case 0:
+            (void) mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+            (void) mavlink_msg_attitude_pack(1, 1, &message, i, 0.1f, 0.2f, 0.3f, 0.f, 0.f, 0.f);
+            break;
+        default:
+            (void) mavlink_msg_global_position_int_pack(1, 1, &message, i, 473977418, 85455939, 488000, 10000, 0, 0, 0, 9000);
+            break;
+        }
+        const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+        bytes.append(reinterpret_cast<const char*>(buffer), length);
+    }
+
+    return log.write(bytes) == bytes.size();
+}
+
+void LogReplayIndexTest::_testBuildIndex()
+{
+    static constexpr int recordCount = 20000;
+    static constexpr quint64 stepUSecs = 10000;
+
+    QTemporaryDir dir;
+    QFile log(dir.filePath("index.tlog"));
+    QVERIFY(log.open(QFile::ReadWrite));
+    QVERIFY(_writeLog(log, recordCount, stepUSecs, 1000));
+    QVERIFY(log.flush());
+
+    LogReplayIndex index;
+    index.setSidecarEnabled(false);
+    index.build(log.fileName());
+    QVERIFY(index.wait(30000));
+    QVERIFY(index.isReady());
+
+    QCOMPARE(index.recordCount(), static_cast<quint64>(recordCount));
+    QCOMPARE(index.startTimeUSecs(), _startTimeUSecs);
+    QCOMPARE(index.endTimeUSecs(), _startTimeUSecs + ((recordCount - 1) * stepUSecs));
+
+    // 200 seconds of log with an entry every 250 ms
+    const std::vector<LogReplayIndex::Entry>& entries = index.entries();
+    QCOMPARE(entries.size(), static_cast<size_t>(800));
+
+    quint64 previousTime = 0;
+    for (const LogReplayIndex::Entry& entry : entries) {
+        QVERIFY(entry.timeUSecs > previousTime);
+        previousTime = entry.timeUSecs;
+
+        // Each entry points at the timestamp of its record
+        QVERIFY(log.seek(entry.offset));
+        QCOMPARE(LogReplayIndex::parseTimestamp(log.read(sizeof(quint64)).constData()), entry.timeUSecs);
+    }
+}
+
+void LogReplayIndexTest::_testFindRecord()
+{
+    static constexpr int recordCount = 20000;
+    static constexpr quint64 stepUSecs = 10000;
+
+    QTemporaryDir dir;
+    QFile log(dir.filePath("find.tlog"));
+    QVERIFY(log.open(QFile::ReadWrite));
+    QVERIFY(_writeLog(log, recordCount, stepUSecs, 777));
+    QVERIFY(log.flush());
+
+    LogReplayIndex index;
+    index.setSidecarEnabled(false);
+    index.build(log.fileName());
+    QVERIFY(index.wait(30000));
+    QVERIFY(index.isReady());
+
+    QRandomGenerator random(42);
+    const quint64 duration = index.endTimeUSecs() - index.startTimeUSecs();
+    for (int i = 0; i < 500; i++) {
+        const quint64 target = _startTimeUSecs + random.bounded(static_cast<quint64>(duration + 1));
+
+        quint64 recordTime = 0;
+        const qint64 offset = index.findRecord(log, target, recordTime);
+        QVERIFY(offset >= 0);
+
+        // Seeks land exactly on the first record at or after the target
+        const quint64 expected = _startTimeUSecs + ((((target - _startTimeUSecs) + stepUSecs - 1) / stepUSecs) * stepUSecs);
+        QCOMPARE(recordTime, expected);
+        QVERIFY(log.seek(offset));
+        QCOMPARE(LogReplayIndex::parseTimestamp(log.read(sizeof(quint64)).constData()), expected);
+    }
+
+    // Before the start lands on the first record, past the end finds nothing
+    quint64 recordTime = 0;
+    QCOMPARE(index.findRecord(log, 0, recordTime), 0);
+    QCOMPARE(recordTime, _startTimeUSecs);
+    QCOMPARE(index.findRecord(log, index.endTimeUSecs() + 1, recordTime), -1);
+}
+
+void LogReplayIndexTest::_testSidecar()
+{
+    static constexpr int recordCount = 5000;
+    static constexpr quint64 stepUSecs = 20000;
+
+    QTemporaryDir dir;
+    QFile log(dir.filePath("sidecar.tlog"));
+    QVERIFY(log.open(QFile::ReadWrite));
+    QVERIFY(_writeLog(log, recordCount, stepUSecs));
+    log.close();
+
+    LogReplayIndex built;
+    built.build(log.fileName());
+    QVERIFY(built.wait(30000));
+    QVERIFY(built.isReady());
+    QVERIFY(!built.loadedFromSidecar());
+    QVERIFY(QFile::exists(LogReplayIndex::sidecarFilename(log.fileName())));
+
+    LogReplayIndex loaded;
+    loaded.build(log.fileName());
+    QVERIFY(loaded.wait(30000));
+    QVERIFY(loaded.isReady());
+    QVERIFY(loaded.loadedFromSidecar());
+    QCOMPARE(loaded.recordCount(), built.recordCount());
+    QCOMPARE(loaded.startTimeUSecs(), built.startTimeUSecs());
+    QCOMPARE(loaded.endTimeUSecs(), built.endTimeUSecs());
+    QCOMPARE(loaded.entries().size(), built.entries().size());
+    for (size_t i = 0; i < built.entries().size(); i++) {
+        QCOMPARE(loaded.entries()[i].timeUSecs, built.entries()[i].timeUSecs);
+        QCOMPARE(loaded.entries()[i].offset, built.entries()[i].offset);
+    }
+
+    // A different interval can't use the sidecar
+    LogReplayIndex otherInterval;
+    otherInterval.setIntervalMSecs(1000);
+    otherInterval.build(log.fileName());
+    QVERIFY(otherInterval.wait(30000));
+    QVERIFY(!otherInterval.loadedFromSidecar());
+
+    // Neither can a log which changed since
+    QVERIFY(log.open(QFile::WriteOnly | QFile::Truncate));
+    QVERIFY(_writeLog(log, recordCount + 1, stepUSecs));
+    log.close();
+
+    LogReplayIndex rebuilt;
+    rebuilt.build(log.fileName());
+    QVERIFY(rebuilt.wait(30000));
+    QVERIFY(rebuilt.isReady());
+    QVERIFY(!rebuilt.loadedFromSidecar());
+    QCOMPARE(rebuilt.recordCount(), static_cast<quint64>(recordCount + 1));
+}
+
+/// One hour of 100 Hz telemetry. Reports the build time and compares indexed seeks against walking
+/// the log from the start, which is what a seek costs without an index.
+void LogReplayIndexTest::_benchmarkSeek()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int recordCount = 360000;
+    static constexpr quint64 stepUSecs = 10000;
+    static constexpr int seekCount = 20;
+
+    QTemporaryDir dir;
+    QFile log(dir.filePath("benchmark.tlog"));
+    QVERIFY(log.open(QFile::ReadWrite));
+    QVERIFY(_writeLog(log, recordCount, stepUSecs));
+    QVERIFY(log.flush());
+
+    QElapsedTimer timer;
+    timer.start();
+    LogReplayIndex index;
+    index.setSidecarEnabled(false);
+    index.build(log.fileName());
+    QVERIFY(index.wait(60000));
+    QVERIFY(index.isReady());
+    const qint64 buildMSecs = timer.elapsed();
+
+    // A single entry index makes every seek walk from the start of the log
+    LogReplayIndex unindexed;
+    unindexed.setSidecarEnabled(false);
+    unindexed.setIntervalMSecs(std::numeric_limits<int>::max());
+    unindexed.build(log.fileName());
+    QVERIFY(unindexed.wait(60000));
+    QVERIFY(unindexed.isReady());
+    QCOMPARE(unindexed.entries().size(), static_cast<size_t>(1));
+
+    QList<quint64> targets;
+    QRandomGenerator random(7);
+    const quint64 duration = index.endTimeUSecs() - index.startTimeUSecs();
+    for (int i = 0; i < seekCount; i++) {
+        targets.append(_startTimeUSecs + random.bounded(static_cast<quint64>(duration + 1)));
+    }
+
+    quint64 indexedTime = 0;
+    quint64 walkedTime = 0;
+
+    timer.restart();
+    for (const quint64 target : targets) {
+        QVERIFY(index.findRecord(log, target, indexedTime) >= 0);
+    }
+    const qint64 indexedNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    timer.restart();
+    for (const quint64 target : targets) {
+        QVERIFY(unindexed.findRecord(log, target, walkedTime) >= 0);
+    }
+    const qint64 walkedNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+    QCOMPARE(indexedTime, walkedTime);
+
+    qCInfo(UnitTestBenchmarkLog) << "LogReplayIndex" << recordCount << "records" << (log.size() / (1024 * 1024)) << "MB";
+    qCInfo(UnitTestBenchmarkLog) << "  build:" << buildMSecs << "ms" << "entries:" << index.entries().size();
+    qCInfo(UnitTestBenchmarkLog) << "  indexed seek:" << (indexedNsecs / seekCount / 1000) << "us/seek";
+    qCInfo(UnitTestBenchmarkLog) << "  walked seek:" << (walkedNsecs / seekCount / 1000) << "us/seek";
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QIODevice;
+
+class LogReplayIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LogReplayIndexTest() = default;
+
+private slots:
+    void _testBuildIndex();
+    void _testFindRecord();
+    void _testSidecar();
+    void _benchmarkSeek();
+
+private:
+    /// Writes a tlog with records every stepUSecs starting at _startTimeUSecs. Messages alternate
+    /// between a few sizes and a couple of junk bytes are thrown in every junkInterval records.
+    static bool _writeLog(QIODevice& log, int recordCount, quint64 stepUSecs, int junkInterval = 0);
+
+    static constexpr quint64 _startTimeUSecs = 1700000000000000ull;
+};
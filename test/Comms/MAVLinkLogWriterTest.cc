@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogWriterTest.h"
+#include "MAVLinkLogWriter.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QtEndian>
+#include <QtTest/QTest>
+
+void MAVLinkLogWriterTest::_testRecordsWritten()
+{
+    static constexpr int recordCount = 5000;
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    // Small buffers so the test goes through many buffer rotations
+    MAVLinkLogWriter writer(nullptr, 1024, 4);
+    writer.setOverflowPolicy(MAVLinkLogWriter::BlockOnOverflow);
+    QVERIFY(writer.startWriting(&file));
+    QVERIFY(writer.isWriting());
+
+    for (int i = 0; i < recordCount; i++) {
+        const QByteArray payload(1 + (i % 40), static_cast<char>(i));
+        QVERIFY(writer.append(static_cast<quint64>(i), payload.constData(), payload.size()));
+    }
+    QVERIFY(writer.stopWriting());
+    QVERIFY(!writer.isWriting());
+
+    QCOMPARE(writer.messagesWritten(), static_cast<quint64>(recordCount));
+    QCOMPARE(writer.messagesDropped(), static_cast<quint64>(0));
+    QCOMPARE(writer.bytesWritten(), static_cast<quint64>(file.size()));
+
+    // Read back and make sure records are intact and in order
+    QVERIFY(file.seek(0));
+    const QByteArray contents = file.readAll();
+    int offset = 0;
+    for (int i = 0; i < recordCount; i++) {
+        const int payloadLength = 1 + (i % 40);
+        QVERIFY(offset + 8 + payloadLength <= contents.size());
+        QCOMPARE(qFromBigEndian<quint64>(contents.constData() + offset), static_cast<quint64>(i));
+        QCOMPARE(contents.mid(offset + 8, payloadLength), QByteArray(payloadLength, static_cast<char>(i)));
+        offset += 8 + payloadLength;
+    }
+    QCOMPARE(offset, contents.size());
+}
+
+void MAVLinkLogWriterTest::_testDropOnOverflow()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    // With the flush interval well out of the way and the writer unable to take buffers fast
+    // enough, the producer must never block. Whatever can't be queued is counted as dropped.
+    MAVLinkLogWriter writer(nullptr, 256, 2);
+    writer.setFlushIntervalMSecs(60 * 1000);
+    QVERIFY(writer.startWriting(&file));
+
+    static constexpr int recordCount = 100000;
+    const QByteArray payload(100, 'x');
+    for (int i = 0; i < recordCount; i++) {
+        QVERIFY(writer.append(static_cast<quint64>(i), payload.constData(), payload.size()));
+    }
+    QVERIFY(writer.stopWriting());
+
+    QCOMPARE(writer.messagesWritten() + writer.messagesDropped(), static_cast<quint64>(recordCount));
+    QCOMPARE(writer.bytesWritten(), static_cast<quint64>(file.size()));
+    QCOMPARE(writer.producerStalls(), static_cast<quint64>(0));
+    QVERIFY(writer.queueHighWaterPercent() > 0);
+}
+
+void MAVLinkLogWriterTest::_testAppendWhenStopped()
+{
+    MAVLinkLogWriter writer;
+    const char data[] = { 1, 2, 3 };
+
+    QVERIFY(!writer.append(0, data, sizeof(data)));
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QVERIFY(writer.startWriting(&file));
+    QVERIFY(!writer.startWriting(&file));
+    QVERIFY(writer.append(0, data, sizeof(data)));
+    QVERIFY(writer.stopWriting());
+    QVERIFY(!writer.append(0, data, sizeof(data)));
+
+    QCOMPARE(file.size(), static_cast<qint64>(8 + sizeof(data)));
+}
+
+/// Writes 1M typical sized telemetry records and reports the producer side cost, which is what
+/// the receive thread pays, along with the end to end throughput to disk.
+void MAVLinkLogWriterTest::_benchmarkMillionMessages()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int recordCount = 1000000;
+    static constexpr int payloadLength = 40;
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    MAVLinkLogWriter writer;
+    writer.setOverflowPolicy(MAVLinkLogWriter::BlockOnOverflow);
+    QVERIFY(writer.startWriting(&file));
+
+    const QByteArray payload(payloadLength, 'm');
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < recordCount; i++) {
+        (void) writer.append(static_cast<quint64>(i), payload.constData(), payload.size());
+    }
+    const qint64 appendNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+    QVERIFY(writer.stopWriting());
+    const qint64 totalNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    QCOMPARE(writer.messagesWritten(), static_cast<quint64>(recordCount));
+    QCOMPARE(file.size(), static_cast<qint64>(recordCount) * (8 + payloadLength));
+
+    qCInfo(UnitTestBenchmarkLog) << "MAVLinkLogWriter" << recordCount << "messages";
+    qCInfo(UnitTestBenchmarkLog) << "  append:" << (appendNsecs / recordCount) << "ns/msg";
+    qCInfo(UnitTestBenchmarkLog) << "  total:" << (recordCount * 1000000000.0 / totalNsecs) << "msgs/sec"
+                                 << "stalls:" << writer.producerStalls()
+                                 << "high water:" << writer.queueHighWaterPercent() << "%"
+                                 << "max write:" << writer.maxWriteMSecs() << "ms"
+                                 << "syncs:" << writer.syncCount();
+}
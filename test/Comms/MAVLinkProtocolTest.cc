@@ -0,0 +1,264 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkProtocolTest.h"
+#include "MAVLinkProtocol.h"
+#include "MAVLinkFrameParser.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "SettingsManager.h"
+#include "AppSettings.h"
+
+#include <QtCore/QThread>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+#include <memory>
+
+static constexpr int _chunkSize = 100;
+static constexpr int _receiveTimeoutMSecs = 10000;
+
+QByteArray MAVLinkProtocolTest::_buildStream(int messageCount, uint32_t firstTime, uint8_t systemId)
+{
+    QByteArray stream;
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+
+    for (int i = 0; i < messageCount; i++) {
+        mavlink_message_t message;
+        (void) mavlink_msg_attitude_pack_chan(systemId, MAV_COMP_ID_AUTOPILOT1, MAVLINK_COMM_3, &message, firstTime + i, 0.1f * i, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+        const uint16_t len = mavlink_msg_to_send_buffer(buf, &message);
+        stream.append(reinterpret_cast<const char*>(buf), len);
+    }
+
+    return stream;
+}
+
+void MAVLinkProtocolTest::_testRejectedFrameCount()
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    MAVLinkProtocol* const protocol = qgcApp()->toolbox()->mavlinkProtocol();
+    mavlink_status_t* const mavlinkStatus = mavlink_get_channel_status(_mockLink->mavlinkChannel());
+
+    // Corrupt the payload of the first two frames
+    QByteArray stream = _buildStream(4);
+    const int frameLength = stream.size() / 4;
+    for (int i = 0; i < 2; i++) {
+        const int offset = (i * frameLength) + MAVLinkFrameParser::headerLenV2 + 1;
+        stream[offset] = static_cast<char>(stream[offset] ^ 0xFF);
+    }
+
+    // Payload bytes which happen to look like STX are rejected as well, count what the parser sees
+    MAVLinkFrameParser parser;
+    QCOMPARE(parser.parse(stream, [](const MAVLinkFrameParser::Frame&) { return true; }), 2);
+    QVERIFY(parser.badCRCCount() >= 2);
+
+    const uint16_t dropCount = mavlinkStatus->packet_rx_drop_count;
+    const uint8_t parseErrorCount = mavlinkStatus->parse_error;
+
+    protocol->receiveBytes(_mockLink, stream);
+
+    QCOMPARE(static_cast<uint16_t>(mavlinkStatus->packet_rx_drop_count - dropCount), static_cast<uint16_t>(parser.badCRCCount()));
+    QCOMPARE(static_cast<uint8_t>(mavlinkStatus->parse_error - parseErrorCount), static_cast<uint8_t>(parser.badCRCCount()));
+}
+
+MAVLinkProtocol* MAVLinkProtocolTest::_createThreadedProtocol()
+{
+    Fact* const protocolThreadFact = qgcApp()->toolbox()->settingsManager()->appSettings()->mavlinkProtocolThread();
+    const QVariant protocolThread = protocolThreadFact->rawValue();
+
+    protocolThreadFact->setRawValue(true);
+    MAVLinkProtocol* const protocol = new MAVLinkProtocol(qgcApp(), qgcApp()->toolbox());
+    protocol->setToolbox(qgcApp()->toolbox());
+    protocolThreadFact->setRawValue(protocolThread);
+
+    return protocol;
+}
+
+void MAVLinkProtocolTest::_collectTimes(MAVLinkProtocol* protocol, QList<uint32_t>& times)
+{
+    (void) connect(protocol, &MAVLinkProtocol::messageReceived, protocol, [&times](LinkInterface*, const mavlink_message_t& message) {
+        if ((message.sysid == _testSystemId) && (message.msgid == MAVLINK_MSG_ID_ATTITUDE)) {
+            times.append(mavlink_msg_attitude_get_time_boot_ms(&message));
+        }
+    });
+}
+
+void MAVLinkProtocolTest::_feed(MAVLinkProtocol* protocol, LinkInterface* link, const QByteArray& stream)
+{
+    for (int offset = 0; offset < stream.size(); offset += _chunkSize) {
+        protocol->linkBytesReceived(link, stream.mid(offset, _chunkSize));
+    }
+}
+
+void MAVLinkProtocolTest::_testThreadMessageOrder()
+{
+    // Far more than fits in the message queue, so the protocol thread has to wait on the gui thread
+    static constexpr int messageCount = 2000;
+
+    _connectMockLinkNoInitialConnectSequence();
+
+    std::unique_ptr<MAVLinkProtocol> protocol(_createThreadedProtocol());
+    QVERIFY(protocol->protocolThreadEnabled());
+
+    const SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(_mockLink);
+    QVERIFY(link);
+    protocol->resetMetadataForLink(link.get());
+    protocol->registerLink(link);
+
+    QList<uint32_t> times;
+    _collectTimes(protocol.get(), times);
+
+    _feed(protocol.get(), link.get(), _buildStream(messageCount));
+
+    QTRY_COMPARE_WITH_TIMEOUT(times.count(), messageCount, _receiveTimeoutMSecs);
+    for (int i = 0; i < messageCount; i++) {
+        QCOMPARE(times[i], static_cast<uint32_t>(i));
+    }
+
+    protocol->unregisterLink(link.get());
+}
+
+void MAVLinkProtocolTest::_testThreadLinkRemoved()
+{
+    static constexpr int messageCount = 1000;
+
+    _connectMockLinkNoInitialConnectSequence();
+
+    std::unique_ptr<MAVLinkProtocol> protocol(_createThreadedProtocol());
+
+    SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(_mockLink);
+    QVERIFY(link);
+    protocol->resetMetadataForLink(link.get());
+    protocol->registerLink(link);
+
+    QList<uint32_t> times;
+    _collectTimes(protocol.get(), times);
+
+    // The gui thread doesn't get to drain anything before the link goes away
+    _feed(protocol.get(), link.get(), _buildStream(messageCount));
+    protocol->unregisterLink(link.get());
+    link.reset();
+    _disconnectMockLink();
+
+    QTest::qWait(500);
+    QCOMPARE(times.count(), 0);
+
+    // Messages queued for the old link don't show up on a new one, even at the same address
+    _connectMockLinkNoInitialConnectSequence();
+    link = _linkManager->sharedLinkInterfacePointerForLink(_mockLink);
+    QVERIFY(link);
+    protocol->resetMetadataForLink(link.get());
+    protocol->registerLink(link);
+
+    _feed(protocol.get(), link.get(), _buildStream(10, messageCount));
+
+    QTRY_COMPARE_WITH_TIMEOUT(times.count(), 10, _receiveTimeoutMSecs);
+    QTest::qWait(100);
+    QCOMPARE(times.count(), 10);
+    for (int i = 0; i < times.count(); i++) {
+        QCOMPARE(times[i], static_cast<uint32_t>(messageCount + i));
+    }
+
+    protocol->unregisterLink(link.get());
+}
+
+void MAVLinkProtocolTest::_testThreadResetDuringReceive()
+{
+    static constexpr int messageCount = 5000;
+    static constexpr int finalCount = 20;
+
+    _connectMockLinkNoInitialConnectSequence();
+
+    std::unique_ptr<MAVLinkProtocol> protocol(_createThreadedProtocol());
+
+    const SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(_mockLink);
+    QVERIFY(link);
+    protocol->resetMetadataForLink(link.get());
+    protocol->registerLink(link);
+
+    QList<uint32_t> times;
+    _collectTimes(protocol.get(), times);
+
+    // Bytes arrive from another thread, the same as from a real link
+    const QByteArray stream = _buildStream(messageCount);
+    std::unique_ptr<QThread> linkThread(QThread::create([&protocol, &link, &stream]() {
+        _feed(protocol.get(), link.get(), stream);
+    }));
+    linkThread->start();
+
+    int resetCount = 0;
+    while (!linkThread->isFinished()) {
+        protocol->resetMetadataForLink(link.get());
+        resetCount++;
+        QCoreApplication::processEvents();
+    }
+    QVERIFY(linkThread->wait());
+    protocol->resetMetadataForLink(link.get());
+    QVERIFY(resetCount > 0);
+
+    // Once the resets stop everything comes through again
+    _feed(protocol.get(), link.get(), _buildStream(finalCount, messageCount));
+    QTRY_VERIFY_WITH_TIMEOUT(!times.isEmpty() && (times.last() == static_cast<uint32_t>(messageCount + finalCount - 1)), _receiveTimeoutMSecs);
+
+    // Frames split by a reset are lost, but nothing is duplicated or out of order
+    for (int i = 1; i < times.count(); i++) {
+        QVERIFY(times[i] > times[i - 1]);
+    }
+    QVERIFY(times.count() >= finalCount);
+    for (int i = 0; i < finalCount; i++) {
+        QCOMPARE(times[times.count() - finalCount + i], static_cast<uint32_t>(messageCount + i));
+    }
+
+    protocol->unregisterLink(link.get());
+}
+
+void MAVLinkProtocolTest::_testLatencyStats()
+{
+    static constexpr int messageCount = 100;
+
+    _connectMockLinkNoInitialConnectSequence();
+
+    MAVLinkProtocol* const protocol = qgcApp()->toolbox()->mavlinkProtocol();
+    QSignalSpy spyStats(protocol, &MAVLinkProtocol::latencyStatsChanged);
+
+    protocol->resetLatencyHistogram();
+    QCOMPARE(spyStats.count(), 1);
+    QCOMPARE(protocol->latencySampleCount(), 0ull);
+
+    // Nothing is being delivered, so there is nothing to sample
+    protocol->factGroupsUpdated();
+    QCOMPARE(protocol->latencySampleCount(), 0ull);
+
+    // Messages from the vehicle are sampled once its FactGroups have them. Stats are published once a second.
+    QTest::qWait(1100);
+    protocol->receiveBytes(_mockLink, _buildStream(messageCount, 0, static_cast<uint8_t>(_vehicle->id())));
+    QVERIFY(protocol->latencySampleCount() >= static_cast<quint64>(messageCount));
+    QVERIFY(spyStats.count() >= 2);
+    QVERIFY(protocol->latencyP50Usecs() <= protocol->latencyP99Usecs());
+    QVERIFY(protocol->latencyMeanUsecs() <= protocol->latencyMaxUsecs());
+
+    // A protocol no Vehicle is listening to delivers its messages, but never gets to sample them
+    std::unique_ptr<MAVLinkProtocol> threadedProtocol(_createThreadedProtocol());
+
+    const SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(_mockLink);
+    QVERIFY(link);
+    threadedProtocol->resetMetadataForLink(link.get());
+    threadedProtocol->registerLink(link);
+
+    QList<uint32_t> times;
+    _collectTimes(threadedProtocol.get(), times);
+
+    _feed(threadedProtocol.get(), link.get(), _buildStream(messageCount));
+
+    QTRY_COMPARE_WITH_TIMEOUT(times.count(), messageCount, _receiveTimeoutMSecs);
+    QCOMPARE(threadedProtocol->latencySampleCount(), 0ull);
+
+    threadedProtocol->unregisterLink(link.get());
+}
@@ -0,0 +1,45 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkProtocol;
+
+class MAVLinkProtocolTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkProtocolTest() = default;
+
+private slots:
+    void _testRejectedFrameCount();
+    void _testThreadMessageOrder();
+    void _testThreadLinkRemoved();
+    void _testThreadResetDuringReceive();
+    void _testLatencyStats();
+
+private:
+    /// Attitude messages from systemId, by default a system which isn't a vehicle, so nothing but the
+    /// protocol looks at them. The time_boot_ms field counts up from firstTime.
+    static QByteArray _buildStream(int messageCount, uint32_t firstTime = 0, uint8_t systemId = _testSystemId);
+
+    /// Second protocol with the protocol thread running, links have to be registered with it by hand
+    static MAVLinkProtocol* _createThreadedProtocol();
+
+    /// Collects time_boot_ms of the test messages as they come out of protocol
+    static void _collectTimes(MAVLinkProtocol* protocol, QList<uint32_t>& times);
+
+    /// Hands the stream to protocol in chunks which don't line up with the frames
+    static void _feed(MAVLinkProtocol* protocol, LinkInterface* link, const QByteArray& stream);
+
+    static constexpr uint8_t _testSystemId = 250;
+};
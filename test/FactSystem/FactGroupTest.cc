@@ -0,0 +1,179 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupTest.h"
+#include "FactGroup.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+namespace {
+
+/// FactGroup with a number of double Facts whose updates are published by calling update instead of
+/// waiting for the timer
+class TestFactGroup : public FactGroup
+{
+public:
+    TestFactGroup(int factCount, QObject* parent = nullptr)
+        : FactGroup(_testUpdateRateMSecs, parent)
+    {
+        for (int i = 0; i < factCount; i++) {
+            const QString name = QStringLiteral("fact%1").arg(i);
+            Fact* const fact = new Fact(0, name, FactMetaData::valueTypeDouble, this);
+            fact->setMetaData(new FactMetaData(FactMetaData::valueTypeDouble, name, fact));
+            _addFact(fact, name);
+            facts.append(fact);
+        }
+    }
+
+    void update() { _updateAllValues(); }
+
+    QList<Fact*> facts;
+
+private:
+    // Long enough for the timer to never fire during a test
+    static constexpr int _testUpdateRateMSecs = 60 * 60 * 1000;
+};
+
+} // namespace
+
+void FactGroupTest::_testOnlyChangedFactsPublished()
+{
+    TestFactGroup group(10);
+
+    QList<QSignalSpy*> spies;
+    for (Fact* fact : group.facts) {
+        spies.append(new QSignalSpy(fact, &Fact::valueChanged));
+    }
+
+    // Values are held back until the next update
+    group.facts[2]->setRawValue(1.0);
+    group.facts[7]->setRawValue(2.0);
+    group.facts[7]->setRawValue(3.0);
+    for (QSignalSpy* spy : spies) {
+        QCOMPARE(spy->count(), 0);
+    }
+
+    group.update();
+    for (int i = 0; i < spies.count(); i++) {
+        QCOMPARE(spies[i]->count(), ((i == 2) || (i == 7)) ? 1 : 0);
+    }
+    QCOMPARE(spies[7]->constLast().constFirst().toDouble(), 3.0);
+    QCOMPARE(group.signalsEmitted(), 2ull);
+
+    // Nothing changed, nothing published
+    group.update();
+    QCOMPARE(group.signalsEmitted(), 2ull);
+
+    // Setting the same value again isn't a change either
+    group.facts[2]->setRawValue(1.0);
+    group.update();
+    QCOMPARE(spies[2]->count(), 1);
+    QCOMPARE(group.signalsEmitted(), 2ull);
+
+    qDeleteAll(spies);
+}
+
+void FactGroupTest::_testChangeDuringPublish()
+{
+    TestFactGroup group(3);
+
+    // A handler which changes another Fact of the group while it is being published
+    (void) connect(group.facts[0], &Fact::valueChanged, this, [&group]() {
+        group.facts[1]->setRawValue(group.facts[1]->rawValue().toDouble() + 1.0);
+    });
+    QSignalSpy spy1(group.facts[1], &Fact::valueChanged);
+
+    group.facts[0]->setRawValue(5.0);
+    group.update();
+    QCOMPARE(spy1.count(), 0);
+
+    // The change made during publishing goes out with the next update
+    group.update();
+    QCOMPARE(spy1.count(), 1);
+    QCOMPARE(group.signalsEmitted(), 2ull);
+}
+
+void FactGroupTest::_testLiveUpdatesFlush()
+{
+    TestFactGroup group(2);
+    QSignalSpy spy(group.facts[0], &Fact::valueChanged);
+
+    group.facts[0]->setRawValue(1.0);
+    QCOMPARE(spy.count(), 0);
+
+    // Switching to live updates publishes what is pending, after that values go straight through
+    group.setLiveUpdates(true);
+    QCOMPARE(spy.count(), 1);
+    group.facts[0]->setRawValue(2.0);
+    QCOMPARE(spy.count(), 2);
+
+    group.setLiveUpdates(false);
+    group.facts[0]->setRawValue(3.0);
+    QCOMPARE(spy.count(), 2);
+    group.update();
+    QCOMPARE(spy.count(), 3);
+}
+
+void FactGroupTest::_testSignalRate()
+{
+    TestFactGroup group(4);
+    QCOMPARE(group.signalsPerSecond(), 0.0);
+
+    QElapsedTimer timer;
+    timer.start();
+    int published = 0;
+    for (int i = 1; timer.elapsed() < 1100; i++) {
+        for (Fact* fact : group.facts) {
+            fact->setRawValue(static_cast<double>(i));
+        }
+        group.update();
+        published += group.facts.count();
+        QTest::qWait(20);
+    }
+
+    QCOMPARE(group.signalsEmitted(), static_cast<quint64>(published));
+    QVERIFY(group.signalsPerSecond() > 0);
+    QVERIFY(group.signalsPerSecond() <= published);
+}
+
+/// A vehicle worth of groups where only a few Facts change between updates, which is the common case
+/// for telemetry
+void FactGroupTest::_benchmarkUpdate()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int groupCount = 25;
+    static constexpr int factsPerGroup = 30;
+    static constexpr int updateCount = 2000;
+
+    QList<TestFactGroup*> groups;
+    for (int i = 0; i < groupCount; i++) {
+        groups.append(new TestFactGroup(factsPerGroup));
+    }
+
+    for (const int changedPerGroup : { 0, 2, factsPerGroup }) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int update = 0; update < updateCount; update++) {
+            for (TestFactGroup* group : groups) {
+                for (int i = 0; i < changedPerGroup; i++) {
+                    group->facts[i]->setRawValue(static_cast<double>(update));
+                }
+                group->update();
+            }
+        }
+        const qint64 nsecs = timer.nsecsElapsed();
+        qCInfo(UnitTestBenchmarkLog) << "FactGroup update" << groupCount << "groups x" << factsPerGroup << "facts, changed per group:" << changedPerGroup
+                                     << "us/update:" << (nsecs / updateCount / 1000.0);
+    }
+
+    qDeleteAll(groups);
+}
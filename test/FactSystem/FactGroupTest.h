@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class FactGroupTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    FactGroupTest() = default;
+
+private slots:
+    void _testOnlyChangedFactsPublished();
+    void _testChangeDuringPublish();
+    void _testLiveUpdatesFlush();
+    void _testSignalRate();
+    void _benchmarkUpdate();
+};
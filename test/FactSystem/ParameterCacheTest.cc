@@ -0,0 +1,231 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterCacheTest.h"
+#include "QGC.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+#include <cstring>
+
+QList<ParameterCache::Entry> ParameterCacheTest::_entries(int count)
+{
+    static const MAV_PARAM_TYPE types[] = { MAV_PARAM_TYPE_REAL32, MAV_PARAM_TYPE_INT32, MAV_PARAM_TYPE_UINT8, MAV_PARAM_TYPE_INT16 };
+
+    QList<ParameterCache::Entry> entries;
+    for (int i = 0; i < count; i++) {
+        ParameterCache::Entry entry;
+        // Reverse name order so saving has to sort, the last names use all 16 characters
+        entry.name = QStringLiteral("P%1_%2").arg(count - i, 5, 10, QChar('0')).arg((i % 7) ? QStringLiteral("GAIN") : QStringLiteral("LONGNAMEX"));
+        entry.index = i;
+        entry.type = types[i % 4];
+        memset(&entry.value, 0, sizeof(entry.value));
+        entry.value.type = entry.type;
+        switch (entry.type) {
+        case MAV_PARAM_TYPE_REAL32:
+            entry.value.param_float = i * 0.25f;
+            break;
+        case MAV_PARAM_TYPE_INT32:
+            entry.value.param_int32 = -i;
+            break;
+        case MAV_PARAM_TYPE_UINT8:
+            entry.value.param_uint8 = static_cast<uint8_t>(i);
+            break;
+        default:
+            entry.value.param_int16 = static_cast<int16_t>(i * 3);
+            break;
+        }
+        entries.append(entry);
+    }
+    return entries;
+}
+
+void ParameterCacheTest::_saveOpenTest()
+{
+    QTemporaryDir dir;
+    const QString filename = dir.filePath("1_1.v3");
+    const QList<ParameterCache::Entry> entries = _entries(50);
+
+    QVERIFY(ParameterCache::save(filename, entries, 25000));
+    QCOMPARE(QFile(filename).size(), static_cast<qint64>(ParameterCache::headerSize + (50 * ParameterCache::recordSize)));
+
+    ParameterCache cache;
+    QVERIFY(cache.open(filename));
+    QVERIFY(cache.isOpen());
+    QCOMPARE(cache.count(), 50);
+    QCOMPARE(cache.linkUSecsPerParam(), 25000u);
+
+    // Records are in name order and keep everything which was saved
+    for (int record = 1; record < cache.count(); record++) {
+        QVERIFY(cache.name(record - 1) < cache.name(record));
+    }
+    for (const ParameterCache::Entry& entry : entries) {
+        const int record = cache.find(entry.name);
+        QVERIFY(record >= 0);
+        QCOMPARE(cache.name(record), entry.name);
+        QCOMPARE(cache.paramIndex(record), entry.index);
+        QCOMPARE(cache.type(record), entry.type);
+        QCOMPARE(memcmp(cache.value(record).bytes, entry.value.bytes, sizeof(entry.value.bytes)), 0);
+    }
+    QCOMPARE(cache.find(QStringLiteral("P00001")), -1);
+    QCOMPARE(cache.find(QStringLiteral("NAME_LONGER_THAN_16")), -1);
+
+    cache.close();
+    QVERIFY(!cache.isOpen());
+    QCOMPARE(cache.count(), 0);
+}
+
+void ParameterCacheTest::_rejectTest()
+{
+    QTemporaryDir dir;
+    const QString filename = dir.filePath("1_1.v3");
+    QVERIFY(ParameterCache::save(filename, _entries(10), 0));
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray good = file.readAll();
+    file.close();
+
+    const auto write = [&filename](const QByteArray& bytes) {
+        QFile file(filename);
+        return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && (file.write(bytes) == bytes.size());
+    };
+
+    ParameterCache cache;
+    QVERIFY(!cache.open(dir.filePath("missing.v3")));
+
+    // Truncated
+    QVERIFY(write(good.left(good.size() - 1)));
+    QVERIFY(!cache.open(filename));
+    QVERIFY(write(good.left(ParameterCache::headerSize - 1)));
+    QVERIFY(!cache.open(filename));
+
+    // Bad magic and a different version
+    QByteArray bytes = good;
+    bytes[0] = 'X';
+    QVERIFY(write(bytes));
+    QVERIFY(!cache.open(filename));
+    bytes = good;
+    bytes[4] = static_cast<char>(ParameterCache::fileVersion + 1);
+    QVERIFY(write(bytes));
+    QVERIFY(!cache.open(filename));
+    QVERIFY(!cache.isOpen());
+
+    // The old QDataStream cache isn't mistaken for one either
+    QByteArray v2;
+    QDataStream stream(&v2, QIODevice::WriteOnly);
+    stream << QMap<QString, QPair<int, QVariant>>({ { QStringLiteral("P1"), { 0, QVariant(1.0f) } } });
+    QVERIFY(write(v2));
+    QVERIFY(!cache.open(filename));
+
+    QVERIFY(write(good));
+    QVERIFY(cache.open(filename));
+}
+
+void ParameterCacheTest::_hashTest()
+{
+    QTemporaryDir dir;
+    const QString filename = dir.filePath("1_1.v3");
+    const QList<ParameterCache::Entry> entries = _entries(300);
+    QVERIFY(ParameterCache::save(filename, entries, 0));
+
+    ParameterCache cache;
+    QVERIFY(cache.open(filename));
+
+    // The hash the old cache computed: name and value bytes over a QMap keyed by name
+    QMap<QString, ParameterCache::Entry> byName;
+    for (const ParameterCache::Entry& entry : entries) {
+        byName[entry.name] = entry;
+    }
+    quint32 expected = 0;
+    quint32 expectedSkipping = 0;
+    for (const ParameterCache::Entry& entry : std::as_const(byName)) {
+        expected = QGC::crc32(reinterpret_cast<const quint8*>(qPrintable(entry.name)), entry.name.length(), expected);
+        expected = QGC::crc32(entry.value.bytes, ParameterCache::typeSize(entry.type), expected);
+        if (entry.type != MAV_PARAM_TYPE_REAL32) {
+            expectedSkipping = QGC::crc32(reinterpret_cast<const quint8*>(qPrintable(entry.name)), entry.name.length(), expectedSkipping);
+            expectedSkipping = QGC::crc32(entry.value.bytes, ParameterCache::typeSize(entry.type), expectedSkipping);
+        }
+    }
+
+    QCOMPARE(cache.hash(), expected);
+    QCOMPARE(cache.hash([&cache](int record) { return cache.type(record) == MAV_PARAM_TYPE_REAL32; }), expectedSkipping);
+
+    // A single changed value changes the hash
+    QList<ParameterCache::Entry> changed = entries;
+    changed[123].value.bytes[0] ^= 1;
+    QVERIFY(ParameterCache::save(filename, changed, 0));
+    cache.close();
+    QVERIFY(cache.open(filename));
+    QVERIFY(cache.hash() != expected);
+}
+
+/// Load and hash check of 1200 parameters, against the QDataStream of QVariants the cache used to be
+void ParameterCacheTest::_benchmarkLoad()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int paramCount = 1200;
+    static constexpr int loadCount = 200;
+
+    QTemporaryDir dir;
+    const QList<ParameterCache::Entry> entries = _entries(paramCount);
+
+    const QString v3Filename = dir.filePath("1_1.v3");
+    QVERIFY(ParameterCache::save(v3Filename, entries, 0));
+
+    const QString v2Filename = dir.filePath("1_1.v2");
+    {
+        QMap<QString, QPair<int, QVariant>> cacheMap;
+        for (const ParameterCache::Entry& entry : entries) {
+            cacheMap[entry.name] = qMakePair(static_cast<int>(entry.type), QVariant(entry.value.param_float));
+        }
+        QFile file(v2Filename);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QDataStream stream(&file);
+        stream << cacheMap;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    quint32 v2Hash = 0;
+    for (int i = 0; i < loadCount; i++) {
+        QMap<QString, QPair<int, QVariant>> cacheMap;
+        QFile file(v2Filename);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QDataStream stream(&file);
+        stream >> cacheMap;
+        v2Hash = 0;
+        for (auto it = cacheMap.cbegin(); it != cacheMap.cend(); ++it) {
+            v2Hash = QGC::crc32(reinterpret_cast<const quint8*>(qPrintable(it.key())), it.key().length(), v2Hash);
+            v2Hash = QGC::crc32(static_cast<const quint8*>(it.value().second.constData()), sizeof(float), v2Hash);
+        }
+    }
+    const qint64 v2Nsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    timer.restart();
+    quint32 v3Hash = 0;
+    for (int i = 0; i < loadCount; i++) {
+        ParameterCache cache;
+        QVERIFY(cache.open(v3Filename));
+        v3Hash = cache.hash();
+    }
+    const qint64 v3Nsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+    QVERIFY(v3Hash != 0);
+    Q_UNUSED(v2Hash);
+
+    qCInfo(UnitTestBenchmarkLog) << "Parameter cache" << paramCount << "params";
+    qCInfo(UnitTestBenchmarkLog) << "  QDataStream:" << QFile(v2Filename).size() << "bytes" << (v2Nsecs / loadCount / 1000) << "us/load";
+    qCInfo(UnitTestBenchmarkLog) << "  mapped:" << QFile(v3Filename).size() << "bytes" << (v3Nsecs / loadCount / 1000) << "us/load";
+}
@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "ParameterCache.h"
+
+class ParameterCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ParameterCacheTest() = default;
+
+private slots:
+    void _saveOpenTest();
+    void _rejectTest();
+    void _hashTest();
+    void _benchmarkLoad();
+
+private:
+    /// A parameter set the size of an ArduPilot or large PX4 vehicle, in index order
+    static QList<ParameterCache::Entry> _entries(int count);
+};
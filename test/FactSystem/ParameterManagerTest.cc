@@ -13,10 +13,14 @@
 #include "Vehicle.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "ParameterCache.h"
 
+#include <QtCore/QFile>
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
 
+#include <algorithm>
+
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
 {
@@ -235,3 +239,126 @@ void ParameterManagerTest::_FTPChangeParam()
     QCOMPARE(arguments.count(), 1);
     QCOMPARE(arguments.at(0).toFloat(), 0.0f);
 }
+
+/// Waits for the initial parameter load of the vehicle on _mockLink to complete
+///     @return Vehicle, nullptr if the parameters never became ready
+Vehicle* ParameterManagerTest::_waitForParametersReady(void)
+{
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QSignalSpy spyParamsReady(vehicleMgr, &MultiVehicleManager::parameterReadyVehicleAvailableChanged);
+    if (!spyParamsReady.wait(60000) || !spyParamsReady.takeFirst().at(0).toBool()) {
+        return nullptr;
+    }
+    return vehicleMgr->activeVehicle();
+}
+
+/// Connects, does a full parameter load which writes the cache, and disconnects again
+///     @param volatileIndices Returns the cached vehicle indices of the volatile parameters
+///     @return Hash of the cache file as the vehicle would send it in _HASH_CHECK
+quint32 ParameterManagerTest::_cacheHashAfterFullLoad(QList<int>& volatileIndices)
+{
+    _mockLink = MockLink::startPX4MockLink(false);
+    const QString cacheFile = ParameterManager::parameterCacheFile(_mockLink->vehicleId(), MAV_COMP_ID_AUTOPILOT1);
+    (void) QFile::remove(cacheFile);
+
+    Vehicle* vehicle = _waitForParametersReady();
+    if (!vehicle) {
+        return 0;
+    }
+
+    ParameterCache cache;
+    if (!cache.open(cacheFile)) {
+        return 0;
+    }
+
+    ParameterManager* parameterManager = vehicle->parameterManager();
+    const quint32 hash = cache.hash([&](int record) {
+        if (parameterManager->getParameter(MAV_COMP_ID_AUTOPILOT1, cache.name(record))->volatileValue()) {
+            volatileIndices.append(cache.paramIndex(record));
+            return true;
+        }
+        return false;
+    });
+    cache.close();
+
+    _disconnectMockLink();
+
+    return hash;
+}
+
+void ParameterManagerTest::_cacheHitReadsVolatileParams(void)
+{
+    QList<int> volatileIndices;
+    const quint32 hash = _cacheHashAfterFullLoad(volatileIndices);
+    QVERIFY(!_mockLink);
+    QVERIFY(!volatileIndices.isEmpty());
+
+    _mockLink = MockLink::startPX4MockLink(false);
+    _mockLink->setParamHashCheck(hash);
+    Vehicle* vehicle = _waitForParametersReady();
+    QVERIFY(vehicle);
+
+    ParameterCache cache;
+    QVERIFY(cache.open(ParameterManager::parameterCacheFile(vehicle->id(), MAV_COMP_ID_AUTOPILOT1)));
+    QCOMPARE(vehicle->parameterManager()->_initialLoadCacheCount, cache.count());
+
+    // Only the volatile parameters are read back from the vehicle, by the index stored in the cache
+    QList<int> readIndices = _mockLink->receivedParamRequestReadIndices();
+    std::sort(readIndices.begin(), readIndices.end());
+    std::sort(volatileIndices.begin(), volatileIndices.end());
+    QCOMPARE(readIndices, volatileIndices);
+    QVERIFY(!vehicle->parameterManager()->missingParameters());
+}
+
+void ParameterManagerTest::_cacheWriteOnlyWhenDirty(void)
+{
+    _mockLink = MockLink::startPX4MockLink(false);
+    Vehicle* vehicle = _waitForParametersReady();
+    QVERIFY(vehicle);
+
+    ParameterManager* parameterManager = vehicle->parameterManager();
+    const QString cacheFile = ParameterManager::parameterCacheFile(vehicle->id(), MAV_COMP_ID_AUTOPILOT1);
+    QVERIFY(QFile::exists(cacheFile));
+    QVERIFY(QFile::remove(cacheFile));
+
+    // Nothing changed since the full load, so there is nothing to write
+    QVERIFY(!parameterManager->_paramCacheWriteTimer.isActive());
+    QVERIFY(parameterManager->_dirtyParamCacheComponents.isEmpty());
+    parameterManager->_writeDirtyParamCaches();
+    QVERIFY(!QFile::exists(cacheFile));
+
+    // An acknowledged write marks the component dirty and the timer rewrites the cache
+    QSignalSpy spyCacheWrite(&parameterManager->_paramCacheWriteTimer, &QTimer::timeout);
+    Fact* fact = parameterManager->getParameter(MAV_COMP_ID_AUTOPILOT1, "MPC_XY_P");
+    fact->setRawValue(0.5f);
+    QTRY_VERIFY(parameterManager->_paramCacheWriteTimer.isActive());
+    QCOMPARE(parameterManager->_dirtyParamCacheComponents.count(), 1);
+    QVERIFY(spyCacheWrite.wait(5000));
+    QVERIFY(parameterManager->_dirtyParamCacheComponents.isEmpty());
+
+    ParameterCache cache;
+    QVERIFY(cache.open(cacheFile));
+    const int record = cache.find("MPC_XY_P");
+    QVERIFY(record >= 0);
+    QCOMPARE(cache.value(record).param_float, 0.5f);
+}
+
+void ParameterManagerTest::_cacheHashMismatchFullLoad(void)
+{
+    QList<int> volatileIndices;
+    const quint32 hash = _cacheHashAfterFullLoad(volatileIndices);
+    QVERIFY(!_mockLink);
+
+    _mockLink = MockLink::startPX4MockLink(false);
+    _mockLink->setParamHashCheck(hash + 1);
+    Vehicle* vehicle = _waitForParametersReady();
+    QVERIFY(vehicle);
+
+    // Nothing comes from the cache, the vehicle keeps streaming all parameters
+    ParameterCache cache;
+    QVERIFY(cache.open(ParameterManager::parameterCacheFile(vehicle->id(), MAV_COMP_ID_AUTOPILOT1)));
+    QCOMPARE(vehicle->parameterManager()->_initialLoadCacheCount, 0);
+    QVERIFY(vehicle->parameterManager()->_initialLoadLinkCount >= cache.count());
+    QVERIFY(_mockLink->receivedParamRequestReadIndices().isEmpty());
+    QVERIFY(!vehicle->parameterManager()->missingParameters());
+}
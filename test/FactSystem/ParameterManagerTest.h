@@ -14,6 +14,8 @@
 #include "UnitTest.h"
 #include "MockLinkMissionItemHandler.h"
 
+class Vehicle;
+
 class ParameterManagerTest : public UnitTest
 {
     Q_OBJECT
@@ -25,10 +27,14 @@ private slots:
     void _requestListMissingParamFail(void);
     void _FTPnoFailure(void);
     void _FTPChangeParam(void);
-
+    void _cacheHitReadsVolatileParams(void);
+    void _cacheWriteOnlyWhenDirty(void);
+    void _cacheHashMismatchFullLoad(void);
 
 private:
     void _noFailureWorker(MockConfiguration::FailureMode_t failureMode);
+    Vehicle* _waitForParametersReady(void);
+    quint32 _cacheHashAfterFullLoad(QList<int>& volatileIndices);
 };
 
 #endif
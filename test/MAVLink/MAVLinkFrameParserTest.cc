@@ -0,0 +1,261 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFrameParserTest.h"
+#include "MAVLinkFrameParser.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QTest>
+
+static constexpr mavlink_channel_t _testChannel = MAVLINK_COMM_3;
+static constexpr uint32_t _unknownMsgId = 0xFFFFF0;
+
+/// Builds a stream of typical telemetry traffic: heartbeat, attitude and global position
+QByteArray MAVLinkFrameParserTest::_buildStream(int messageCount)
+{
+    QByteArray stream;
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+
+    for (int i = 0; i < messageCount; i++) {
+        mavlink_message_t message;
+
+        switch (i % 3) {
+        case 0:
+            (void) mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _testChannel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+            (void) mavlink_msg_attitude_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _testChannel, &message, i, 0.1f * i, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+            break;
+        default:
+            (void) mavlink_msg_global_position_int_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _testChannel, &message, i, 473977418, 85455938, 488000, 10000, 0, 0, 0, 9000);
+            break;
+        }
+
+        const uint16_t len = mavlink_msg_to_send_buffer(buf, &message);
+        stream.append(reinterpret_cast<const char*>(buf), len);
+    }
+
+    return stream;
+}
+
+/// Builds a frame with a message id which is not in the CRC_EXTRA table, using crcExtra for the checksum
+QByteArray MAVLinkFrameParserTest::_buildUnknownMsgIdFrame(uint8_t crcExtra)
+{
+    mavlink_message_t message;
+    (void) mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _testChannel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    message.msgid = _unknownMsgId;
+    (void) mavlink_finalize_message_chan(&message, 1, MAV_COMP_ID_AUTOPILOT1, _testChannel, MAVLINK_MSG_ID_HEARTBEAT_MIN_LEN, MAVLINK_MSG_ID_HEARTBEAT_LEN, crcExtra);
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buf, &message);
+    return QByteArray(reinterpret_cast<const char*>(buf), len);
+}
+
+void MAVLinkFrameParserTest::_testSingleBuffer()
+{
+    const QByteArray stream = _buildStream(30);
+
+    MAVLinkFrameParser parser;
+    int heartbeatCount = 0;
+    const int frameCount = parser.parse(stream, [&heartbeatCount](const MAVLinkFrameParser::Frame& frame) {
+        if (frame.msgid() == MAVLINK_MSG_ID_HEARTBEAT) {
+            heartbeatCount++;
+        }
+        return true;
+    });
+
+    QCOMPARE(frameCount, 30);
+    QCOMPARE(heartbeatCount, 10);
+    QCOMPARE(parser.badCRCCount(), 0);
+    QCOMPARE(parser.droppedByteCount(), 0);
+}
+
+void MAVLinkFrameParserTest::_testSplitBuffers()
+{
+    const QByteArray stream = _buildStream(30);
+
+    // Feed the stream in odd sized chunks so frames straddle buffer boundaries
+    for (int chunkSize = 1; chunkSize < 20; chunkSize += 3) {
+        MAVLinkFrameParser parser;
+        QByteArray reassembled;
+        int frameCount = 0;
+        for (int offset = 0; offset < stream.size(); offset += chunkSize) {
+            frameCount += parser.parse(stream.mid(offset, chunkSize), [&reassembled](const MAVLinkFrameParser::Frame& frame) {
+                reassembled.append(reinterpret_cast<const char*>(frame.data), frame.length);
+                return true;
+            });
+        }
+        QCOMPARE(frameCount, 30);
+        QCOMPARE(reassembled, stream);
+    }
+}
+
+void MAVLinkFrameParserTest::_testBadCRC()
+{
+    QByteArray stream = _buildStream(3);
+
+    // Corrupt a payload byte of the first frame
+    stream[MAVLinkFrameParser::headerLenV2 + 1] = static_cast<char>(stream[MAVLinkFrameParser::headerLenV2 + 1] ^ 0xFF);
+
+    MAVLinkFrameParser parser;
+    const int frameCount = parser.parse(stream, [](const MAVLinkFrameParser::Frame&) { return true; });
+
+    QCOMPARE(frameCount, 2);
+    QVERIFY(parser.badCRCCount() >= 1);
+}
+
+void MAVLinkFrameParserTest::_testGarbageBetweenFrames()
+{
+    const QByteArray frames = _buildStream(2);
+    const int firstLength = MAVLinkFrameParser::headerLenV2 + static_cast<uint8_t>(frames[1]) + MAVLINK_NUM_CHECKSUM_BYTES;
+
+    QByteArray stream;
+    stream.append("\x01\x02\xFD\x03", 4);
+    stream.append(frames.left(firstLength));
+    stream.append("\x55\xAA\x00", 3);
+    stream.append(frames.mid(firstLength));
+
+    MAVLinkFrameParser parser;
+    const int frameCount = parser.parse(stream, [](const MAVLinkFrameParser::Frame&) { return true; });
+
+    QCOMPARE(frameCount, 2);
+    QVERIFY(parser.droppedByteCount() > 0);
+}
+
+void MAVLinkFrameParserTest::_testDecodeMatchesParseChar()
+{
+    const QByteArray stream = _buildStream(9);
+
+    QList<mavlink_message_t> parsedMessages;
+    mavlink_message_t message;
+    mavlink_status_t status;
+    for (const char byte: stream) {
+        if (mavlink_parse_char(_testChannel, static_cast<uint8_t>(byte), &message, &status)) {
+            parsedMessages.append(message);
+        }
+    }
+    QCOMPARE(parsedMessages.count(), 9);
+
+    MAVLinkFrameParser parser;
+    int index = 0;
+    (void) parser.parse(stream, [&parsedMessages, &index](const MAVLinkFrameParser::Frame& frame) {
+        mavlink_message_t decoded;
+        (void) memset(&decoded, 0, sizeof(decoded));
+        MAVLinkFrameParser::decode(frame, &decoded);
+
+        const mavlink_message_t& expected = parsedMessages[index++];
+        if (decoded.msgid != expected.msgid || decoded.sysid != expected.sysid || decoded.seq != expected.seq ||
+                decoded.len != expected.len || decoded.checksum != expected.checksum ||
+                memcmp(_MAV_PAYLOAD(&decoded), _MAV_PAYLOAD(&expected), expected.len) != 0) {
+            return false;
+        }
+        return true;
+    });
+    QCOMPARE(index, 9);
+}
+
+void MAVLinkFrameParserTest::_testUnknownMsgId()
+{
+    QVERIFY(!mavlink_get_msg_entry(_unknownMsgId));
+
+    // mavlink_parse_char checks unknown message ids with a crc extra of 0, the block parser must do the same
+    const QByteArray heartbeat = _buildStream(1);
+    const QByteArray stream = heartbeat + _buildUnknownMsgIdFrame(0) + heartbeat;
+
+    QList<uint32_t> parsedMsgIds;
+    mavlink_message_t message;
+    mavlink_status_t status;
+    for (const char byte: stream) {
+        if (mavlink_parse_char(_testChannel, static_cast<uint8_t>(byte), &message, &status)) {
+            parsedMsgIds.append(message.msgid);
+        }
+    }
+    QCOMPARE(parsedMsgIds, QList<uint32_t>({ MAVLINK_MSG_ID_HEARTBEAT, _unknownMsgId, MAVLINK_MSG_ID_HEARTBEAT }));
+
+    MAVLinkFrameParser parser;
+    QList<uint32_t> frameMsgIds;
+    const int frameCount = parser.parse(stream, [&frameMsgIds](const MAVLinkFrameParser::Frame& frame) {
+        frameMsgIds.append(frame.msgid());
+        return true;
+    });
+    QCOMPARE(frameCount, 3);
+    QCOMPARE(frameMsgIds, parsedMsgIds);
+    QCOMPARE(parser.unknownMsgIdCount(), 1);
+    QCOMPARE(parser.badCRCCount(), 0);
+    QCOMPARE(MAVLinkFrameParser::frameLengthAt(reinterpret_cast<const uint8_t*>(stream.constData()) + heartbeat.size(), stream.size() - heartbeat.size()),
+             static_cast<int>(_buildUnknownMsgIdFrame(0).size()));
+
+    // Any other crc extra is a bad frame for both
+    const QByteArray badFrame = _buildUnknownMsgIdFrame(50);
+    int parseCharCount = 0;
+    for (const char byte: badFrame) {
+        if (mavlink_parse_char(_testChannel, static_cast<uint8_t>(byte), &message, &status)) {
+            parseCharCount++;
+        }
+    }
+    QCOMPARE(parseCharCount, 0);
+
+    parser.reset();
+    QCOMPARE(parser.parse(badFrame, [](const MAVLinkFrameParser::Frame&) { return true; }), 0);
+    QVERIFY(parser.badCRCCount() >= 1);
+    QCOMPARE(parser.unknownMsgIdCount(), 0);
+}
+
+void MAVLinkFrameParserTest::_benchmarkMessagesPerSecond()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int messageCount = 100000;
+    static constexpr int chunkSize = 1024;
+    const QByteArray stream = _buildStream(messageCount);
+
+    QList<QByteArray> chunks;
+    for (int offset = 0; offset < stream.size(); offset += chunkSize) {
+        chunks.append(stream.mid(offset, chunkSize));
+    }
+
+    QElapsedTimer timer;
+
+    // Current per-byte path: parse and then re-serialize for forwarding/logging
+    timer.start();
+    int perByteCount = 0;
+    mavlink_message_t message;
+    mavlink_status_t status;
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    for (const QByteArray& chunk: chunks) {
+        for (const char byte: chunk) {
+            if (mavlink_parse_char(_testChannel, static_cast<uint8_t>(byte), &message, &status)) {
+                (void) mavlink_msg_to_send_buffer(buf, &message);
+                perByteCount++;
+            }
+        }
+    }
+    const qint64 perByteNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    // Block framer: locate frames and decode, raw frame bytes are reused as is
+    timer.restart();
+    int bulkCount = 0;
+    MAVLinkFrameParser parser;
+    for (const QByteArray& chunk: chunks) {
+        bulkCount += parser.parse(chunk, [&message](const MAVLinkFrameParser::Frame& frame) {
+            MAVLinkFrameParser::decode(frame, &message);
+            return true;
+        });
+    }
+    const qint64 bulkNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    QCOMPARE(perByteCount, messageCount);
+    QCOMPARE(bulkCount, messageCount);
+
+    const double perByteRate = messageCount / (perByteNsecs / 1e9);
+    const double bulkRate = messageCount / (bulkNsecs / 1e9);
+    qCInfo(UnitTestBenchmarkLog) << "mavlink_parse_char msgs/sec:" << qRound64(perByteRate)
+                                 << "MAVLinkFrameParser msgs/sec:" << qRound64(bulkRate)
+                                 << "speedup:" << bulkRate / perByteRate;
+}
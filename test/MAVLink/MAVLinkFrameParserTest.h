@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkFrameParserTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkFrameParserTest() = default;
+
+private slots:
+    void _testSingleBuffer();
+    void _testSplitBuffers();
+    void _testBadCRC();
+    void _testGarbageBetweenFrames();
+    void _testDecodeMatchesParseChar();
+    void _testUnknownMsgId();
+    void _benchmarkMessagesPerSecond();
+
+private:
+    static QByteArray _buildStream(int messageCount);
+    static QByteArray _buildUnknownMsgIdFrame(uint8_t crcExtra);
+};
@@ -17,7 +17,16 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 #include "MultiSignalSpy.h"
-
+#include "SpeedSection.h"
+#include "QGC.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
 #include <QtTest/QTest>
 
 MissionControllerTest::MissionControllerTest(void)
@@ -291,3 +300,145 @@ void MissionControllerTest::_testGlobalAltMode(void)
         }
     }
 }
+
+/// Writes 800Waypoints.mission with its waypoints repeated, each copy shifted north so the legs don't overlap
+///     @return Filename of the scaled mission, empty on error
+QString MissionControllerTest::_writeScaledMission(const QString& dirPath, int copies)
+{
+    QFile sourceFile(":/unittest/800Waypoints.mission");
+    if (!sourceFile.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    QJsonObject json = QJsonDocument::fromJson(sourceFile.readAll()).object();
+    const QJsonArray sourceItems = json["items"].toArray();
+
+    // First item is the takeoff and the last one the RTL, only the waypoints in between are repeated
+    QJsonArray items;
+    items.append(sourceItems.first());
+    for (int copy=0; copy<copies; copy++) {
+        for (int i=1; i<sourceItems.count() - 1; i++) {
+            QJsonObject item = sourceItems[i].toObject();
+            QJsonArray coordinate = item["coordinate"].toArray();
+            if (coordinate[0].toDouble() != 0) {
+                coordinate[0] = coordinate[0].toDouble() + (copy * 0.01);
+            }
+            item["coordinate"] = coordinate;
+            items.append(item);
+        }
+    }
+    items.append(sourceItems.last());
+
+    for (int i=0; i<items.count(); i++) {
+        QJsonObject item = items[i].toObject();
+        item["id"] = i + 1;
+        items[i] = item;
+    }
+    json["items"] = items;
+
+    QFile scaledFile(QDir(dirPath).filePath("Scaled.mission"));
+    if (!scaledFile.open(QIODevice::WriteOnly) || scaledFile.write(QJsonDocument(json).toJson()) == -1) {
+        return QString();
+    }
+    return scaledFile.fileName();
+}
+
+/// Runs the flight status recalc right away instead of waiting for the queued signal
+///     @param full true: Throw away the cached legs first
+void MissionControllerTest::_recalcFlightStatus(bool full)
+{
+    if (full) {
+        QVERIFY(QMetaObject::invokeMethod(_missionController, "_recalcAllFlightLegs", Qt::DirectConnection));
+    }
+    QVERIFY(QMetaObject::invokeMethod(_missionController, "_recalcMissionFlightStatus", Qt::DirectConnection));
+}
+
+void MissionControllerTest::_testIncrementalFlightStatus(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    QTemporaryDir dir;
+    const QString filename = _writeScaledMission(dir.path(), 1);
+    QVERIFY(!filename.isEmpty());
+    _masterController->loadFromFile(filename);
+    QTest::qWait(500); // Recalcs in MissionController are queued to remove dups. Allow return to main message loop.
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    QVERIFY(visualItems->count() > 800);
+    const double originalDistance = _missionController->missionDistance();
+
+    // Move a waypoint and change the speed on an earlier one. Both only walk part of the mission again.
+    const int movedIndex = visualItems->count() / 2;
+    SimpleMissionItem* movedItem = visualItems->value<SimpleMissionItem*>(movedIndex);
+    movedItem->setCoordinate(movedItem->coordinate().atDistanceAndAzimuth(500, 90));
+    SimpleMissionItem* speedItem = visualItems->value<SimpleMissionItem*>(movedIndex / 2);
+    speedItem->speedSection()->setSpecifyFlightSpeed(true);
+    speedItem->speedSection()->flightSpeed()->setRawValue(3.0);
+    QTest::qWait(100);
+
+    const double incrementalDistance = _missionController->missionDistance();
+    const double incrementalTime = _missionController->missionTime();
+    QVERIFY(incrementalDistance > originalDistance);
+
+    QList<double> distances;
+    QList<double> distancesFromStart;
+    QList<double> vehicleYaws;
+    for (int i=0; i<visualItems->count(); i++) {
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+        distances.append(item->distance());
+        distancesFromStart.append(item->distanceFromStart());
+        vehicleYaws.append(item->missionVehicleYaw());
+    }
+
+    // Incremental results must match walking the whole mission
+    _recalcFlightStatus(true);
+    QCOMPARE(_missionController->missionDistance(), incrementalDistance);
+    QCOMPARE(_missionController->missionTime(), incrementalTime);
+    for (int i=0; i<visualItems->count(); i++) {
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+        QCOMPARE(item->distance(), distances[i]);
+        QCOMPARE(item->distanceFromStart(), distancesFromStart[i]);
+        QVERIFY(QGC::fuzzyCompare(item->missionVehicleYaw(), vehicleYaws[i]));
+    }
+}
+
+/// Dragging a single waypoint of a large mission. Compares the recalc after the move against walking the whole mission.
+void MissionControllerTest::_benchmarkFlightStatusRecalc(void)
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int copies = 3;
+    static constexpr int moveCount = 50;
+
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    QTemporaryDir dir;
+    const QString filename = _writeScaledMission(dir.path(), copies);
+    QVERIFY(!filename.isEmpty());
+    _masterController->loadFromFile(filename);
+    QTest::qWait(1000);
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    SimpleMissionItem* movedItem = visualItems->value<SimpleMissionItem*>(visualItems->count() / 2);
+    QVERIFY(movedItem);
+    const QGeoCoordinate startCoordinate = movedItem->coordinate();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i=0; i<moveCount; i++) {
+        movedItem->setCoordinate(startCoordinate.atDistanceAndAzimuth(i * 10, 90));
+        _recalcFlightStatus(false);
+    }
+    const qint64 incrementalNsecs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i=0; i<moveCount; i++) {
+        movedItem->setCoordinate(startCoordinate.atDistanceAndAzimuth(i * 10, 270));
+        _recalcFlightStatus(true);
+    }
+    const qint64 fullNsecs = timer.nsecsElapsed();
+
+    qCInfo(UnitTestBenchmarkLog) << "Flight status recalc" << visualItems->count() << "items";
+    qCInfo(UnitTestBenchmarkLog) << "  incremental:" << (incrementalNsecs / moveCount / 1000) << "us/move";
+    qCInfo(UnitTestBenchmarkLog) << "  full:" << (fullNsecs / moveCount / 1000) << "us/move";
+}
@@ -34,6 +34,8 @@ private slots:
     void _testGlobalAltMode             (void);
     void _testGimbalRecalc              (void);
     void _testVehicleYawRecalc          (void);
+    void _testIncrementalFlightStatus   (void);
+    void _benchmarkFlightStatusRecalc   (void);
 
 private:
 #if 0
@@ -49,6 +51,8 @@ private:
     void _testOfflineToOnlineWorker(MAV_AUTOPILOT firmwareType);
 #endif
     void _setupVisualItemSignals(VisualMissionItem* visualItem);
+    QString _writeScaledMission(const QString& dirPath, int copies);
+    void _recalcFlightStatus(bool full);
 
     // MissiomItems signals
 
@@ -12,6 +12,8 @@
 #include "PlanViewSettings.h"
 #include "MultiSignalSpy.h"
 
+#include <QtTest/QSignalSpy>
+
 SurveyComplexItemTest::SurveyComplexItemTest(void)
 {
     _rgSurveySignals[surveyVisualTransectPointsChangedIndex] =    SIGNAL(visualTransectPointsChanged());
@@ -355,3 +357,60 @@ void SurveyComplexItemTest::_testHoverCaptureItemGeneration(void)
     _testItemGenerationWorker(false /* imagesInTurnaround */, true /* hasTurnaround */, true /* useConditionGate */, expectedCommands);
     _testItemGenerationWorker(false /* imagesInTurnaround */, true /* hasTurnaround */, false /* useConditionGate */, expectedCommands);
 }
+
+/// Polygon large enough for its transects to be built in the background
+QList<QGeoCoordinate> SurveyComplexItemTest::_largePolygon(void)
+{
+    QList<QGeoCoordinate> vertices;
+    for (int i=0; i<360; i++) {
+        vertices.append(_polyVertices[0].atDistanceAndAzimuth(3000, i));
+    }
+    return vertices;
+}
+
+void SurveyComplexItemTest::_testBackgroundTransects(void)
+{
+    QSignalSpy visualTransectPointsSpy(_surveyItem, &SurveyComplexItem::visualTransectPointsChanged);
+
+    // Moving to the large polygon keeps what was there until the new transects are ready
+    _mapPolygon->clear();
+    visualTransectPointsSpy.clear();
+    _mapPolygon->appendVertices(_largePolygon());
+    QVERIFY(_surveyItem->_transectJobPending());
+    QCOMPARE(visualTransectPointsSpy.count(), 0);
+    QTRY_VERIFY(!_surveyItem->_transectJobPending());
+    QCOMPARE(visualTransectPointsSpy.count(), 1);
+    QVERIFY(_surveyItem->_transectCount() > 100);
+
+    // Only the last of a quick run of changes is published
+    visualTransectPointsSpy.clear();
+    for (double gridAngle=10; gridAngle<=50; gridAngle+=10) {
+        _surveyItem->gridAngle()->setRawValue(gridAngle);
+    }
+    QTRY_VERIFY(!_surveyItem->_transectJobPending());
+    QCOMPARE(visualTransectPointsSpy.count(), 1);
+
+    SurveyComplexItem* referenceItem = new SurveyComplexItem(_masterController, false /* flyView */, QString() /* kmlFile */);
+    referenceItem->cameraCalc()->adjustedFootprintSide()->setRawValue(_surveyItem->cameraCalc()->adjustedFootprintSide()->rawValue());
+    referenceItem->cameraCalc()->adjustedFootprintFrontal()->setRawValue(_surveyItem->cameraCalc()->adjustedFootprintFrontal()->rawValue());
+    referenceItem->gridAngle()->setRawValue(50);
+    referenceItem->surveyAreaPolygon()->appendVertices(_largePolygon());
+    referenceItem->waitForTransects();
+    QCOMPARE(_surveyItem->visualTransectPoints(), referenceItem->visualTransectPoints());
+
+    // Mission items are built from the newest geometry even while a build is running
+    _surveyItem->gridAngle()->setRawValue(0);
+    referenceItem->gridAngle()->setRawValue(0);
+    referenceItem->waitForTransects();
+    QList<MissionItem*> items;
+    QList<MissionItem*> referenceItems;
+    _surveyItem->appendMissionItems(items, this);
+    referenceItem->appendMissionItems(referenceItems, this);
+    QVERIFY(!_surveyItem->_transectJobPending());
+    QCOMPARE(items.count(), referenceItems.count());
+    QCOMPARE(_surveyItem->visualTransectPoints(), referenceItem->visualTransectPoints());
+
+    qDeleteAll(items);
+    qDeleteAll(referenceItems);
+    delete referenceItem;
+}
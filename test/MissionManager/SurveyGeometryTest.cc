@@ -0,0 +1,313 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SurveyGeometryTest.h"
+#include "SurveyGeometry.h"
+#include "SHPFileHelper.h"
+#include "QGCGeo.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QtMath>
+#include <QtTest/QTest>
+
+static constexpr int kDenseVertexCount = 10000;
+
+void SurveyGeometryTest::init()
+{
+    UnitTest::init();
+    QVERIFY(_loadFixtures());
+}
+
+void SurveyGeometryTest::cleanup()
+{
+    _fixtures.clear();
+    _fixtureNames.clear();
+    UnitTest::cleanup();
+}
+
+bool SurveyGeometryTest::_loadFixtures()
+{
+    // The shapefile reader needs real files, with the .prj next to the .shp
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+
+    static const QStringList names = { QStringLiteral("MP 19"), QStringLiteral("MP Bonus"), QStringLiteral("Sarah's Farm") };
+    for (const QString& name : names) {
+        for (const char* extension : { ".shp", ".shx", ".prj" }) {
+            const QString filename = name + QLatin1String(extension);
+            if (!QFile::copy(QStringLiteral(":/unittest/") + filename, dir.filePath(filename))) {
+                qWarning() << "Unable to copy" << filename;
+                return false;
+            }
+        }
+
+        QList<QGeoCoordinate> vertices;
+        QString errorString;
+        if (!SHPFileHelper::loadPolygonFromFile(dir.filePath(name + QStringLiteral(".shp")), vertices, errorString) || (vertices.count() < 3)) {
+            qWarning() << "Unable to load" << name << errorString;
+            return false;
+        }
+
+        // Same conversion as the survey, x east and y north
+        QPolygonF polygon;
+        const QGeoCoordinate tangentOrigin = vertices.first();
+        for (const QGeoCoordinate& vertex : vertices) {
+            double x, y, down;
+            QGCGeo::convertGeoToNed(vertex, tangentOrigin, y, x, down);
+            polygon << QPointF(x, y);
+        }
+        polygon << polygon.first();
+
+        _fixtures.append(polygon);
+        _fixtureNames.append(name);
+    }
+
+    return true;
+}
+
+QPolygonF SurveyGeometryTest::_densify(const QPolygonF& polygon, int vertexCount, double& spacing)
+{
+    double perimeter = 0;
+    for (int i=0; i<polygon.count()-1; i++) {
+        perimeter += QLineF(polygon[i], polygon[i+1]).length();
+    }
+    spacing = perimeter / vertexCount;
+
+    QPolygonF dense;
+    bool out = true;
+    for (int i=0; i<polygon.count()-1; i++) {
+        const QLineF edge(polygon[i], polygon[i+1]);
+        const int steps = qMax(1, qRound(edge.length() / spacing));
+        const QPointF normal(-edge.dy() / edge.length(), edge.dx() / edge.length());
+
+        dense << edge.p1();
+        for (int step=0; step<steps; step++) {
+            const QPointF point = edge.pointAt((step + 0.5) / steps);
+            dense << (point + (normal * (out ? 0.25 : -0.25) * spacing));
+            out = !out;
+        }
+    }
+    dense << dense.first();
+
+    return dense;
+}
+
+QList<QLineF> SurveyGeometryTest::_gridLines(const QPolygonF& polygon, double gridAngle, double spacing)
+{
+    const QRectF boundingRect = polygon.boundingRect();
+    const QPointF center = boundingRect.center();
+    const double halfWidth = QLineF(boundingRect.topLeft(), boundingRect.bottomRight()).length() / 2.0;
+
+    const double angle = qDegreesToRadians(gridAngle);
+    const QPointF along(qCos(angle), qSin(angle));
+    const QPointF across(-along.y(), along.x());
+
+    QList<QLineF> lineList;
+    for (double offset = -halfWidth; offset <= halfWidth; offset += spacing) {
+        const QPointF middle = center + (across * offset);
+        lineList += QLineF(middle - (along * halfWidth), middle + (along * halfWidth));
+    }
+    return lineList;
+}
+
+void SurveyGeometryTest::_clipBruteForce(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines)
+{
+    resultLines.clear();
+
+    for (const QLineF& line : lineList) {
+        QList<QPointF> intersections;
+
+        for (int j=0; j<polygon.count()-1; j++) {
+            QPointF intersectPoint;
+            if (line.intersects(QLineF(polygon[j], polygon[j+1]), &intersectPoint) == QLineF::BoundedIntersection) {
+                if (!intersections.contains(intersectPoint)) {
+                    intersections.append(intersectPoint);
+                }
+            }
+        }
+
+        if (intersections.count() > 1) {
+            QPointF firstPoint;
+            QPointF secondPoint;
+            double currentMaxDistance = 0;
+            for (int i=0; i<intersections.count(); i++) {
+                for (int j=0; j<intersections.count(); j++) {
+                    const double newMaxDistance = QLineF(intersections[i], intersections[j]).length();
+                    if (newMaxDistance > currentMaxDistance) {
+                        firstPoint = intersections[i];
+                        secondPoint = intersections[j];
+                        currentMaxDistance = newMaxDistance;
+                    }
+                }
+            }
+            resultLines += QLineF(firstPoint, secondPoint);
+        }
+    }
+}
+
+bool SurveyGeometryTest::_validDecomposition(const QPolygonF& polygon, const QList<QPolygonF>& pieces)
+{
+    const double area = qAbs(SurveyGeometry::signedArea2(polygon));
+    const QRectF boundingRect = polygon.boundingRect();
+    const double tolerance = qMax(boundingRect.width(), boundingRect.height()) * 1e-9;
+
+    double piecesArea = 0;
+    for (const QPolygonF& piece : pieces) {
+        if ((piece.count() < 4) || (piece.first() != piece.last())) {
+            qWarning() << "Piece isn't a closed polygon" << piece;
+            return false;
+        }
+        const int count = piece.count() - 1;
+        for (int i=0; i<count; i++) {
+            const QLineF edgeIn(piece[(i + count - 1) % count], piece[i]);
+            const QLineF edgeOut(piece[i], piece[i + 1]);
+            const double cross = (edgeIn.dx() * edgeOut.dy()) - (edgeIn.dy() * edgeOut.dx());
+            if (cross < -(tolerance * (edgeIn.length() + edgeOut.length()))) {
+                qWarning() << "Piece isn't convex" << piece;
+                return false;
+            }
+        }
+        piecesArea += SurveyGeometry::signedArea2(piece);
+    }
+
+    if (qAbs(piecesArea - area) > (area * 1e-9)) {
+        qWarning() << "Pieces area" << piecesArea << "polygon area" << area;
+        return false;
+    }
+    return true;
+}
+
+void SurveyGeometryTest::_clipTest()
+{
+    for (int i=0; i<_fixtures.count(); i++) {
+        const QPolygonF& fixture = _fixtures[i];
+        double spacing;
+        const QPolygonF dense = _densify(fixture, kDenseVertexCount, spacing);
+        QVERIFY(dense.count() > (kDenseVertexCount / 2));
+
+        for (const double gridAngle : { 0.0, 17.5, 45.0, 90.0, 133.0 }) {
+            // Fixture polygon with a survey sized grid, and the dense one with a line every vertex
+            for (const bool useDense : { false, true }) {
+                const QPolygonF& polygon = useDense ? dense : fixture;
+                const QRectF boundingRect = polygon.boundingRect();
+                const double lineSpacing = useDense ? spacing : (qMax(boundingRect.width(), boundingRect.height()) / 25.0);
+                const QList<QLineF> lineList = _gridLines(polygon, gridAngle, lineSpacing);
+
+                QList<QLineF> expectedLines;
+                QList<QLineF> resultLines;
+                _clipBruteForce(lineList, polygon, expectedLines);
+                SurveyGeometry::clipParallelLines(lineList, polygon, resultLines);
+
+                QVERIFY2(!expectedLines.isEmpty(), qPrintable(_fixtureNames[i]));
+                QCOMPARE(resultLines, expectedLines);
+            }
+        }
+    }
+
+    // An open polygon gets its closing edge
+    QPolygonF square;
+    square << QPointF(0, 0) << QPointF(10, 0) << QPointF(10, 10) << QPointF(0, 10);
+    QList<QLineF> resultLines;
+    SurveyGeometry::clipParallelLines({ QLineF(-5, 5, 15, 5) }, square, resultLines);
+    QCOMPARE(resultLines.count(), 1);
+    QCOMPARE(resultLines[0].length(), 10.0);
+
+    // Lines which miss or only touch the polygon are dropped
+    square << square.first();
+    SurveyGeometry::clipParallelLines({ QLineF(-5, 20, 15, 20), QLineF(10, -5, 10, 15), QLineF(-5, 10, 0, 10) }, square, resultLines);
+    QCOMPARE(resultLines.count(), 1);
+    QCOMPARE(resultLines[0], QLineF(10, 0, 10, 10));
+}
+
+void SurveyGeometryTest::_decomposeTest()
+{
+    for (int i=0; i<_fixtures.count(); i++) {
+        QList<QPolygonF> pieces;
+        SurveyGeometry::decomposeConvex(_fixtures[i], pieces);
+        QVERIFY2(_validDecomposition(_fixtures[i], pieces), qPrintable(_fixtureNames[i]));
+
+        double spacing;
+        const QPolygonF dense = _densify(_fixtures[i], kDenseVertexCount, spacing);
+        SurveyGeometry::decomposeConvex(dense, pieces);
+        QVERIFY2(_validDecomposition(dense, pieces), qPrintable(_fixtureNames[i]));
+    }
+
+    // Convex input stays in one piece either way round, and comes back counter-clockwise
+    QPolygonF square;
+    square << QPointF(0, 0) << QPointF(0, 10) << QPointF(10, 10) << QPointF(10, 0);
+    QList<QPolygonF> pieces;
+    SurveyGeometry::decomposeConvex(square, pieces);
+    QCOMPARE(pieces.count(), 1);
+    QCOMPARE(SurveyGeometry::signedArea2(pieces[0]), 200.0);
+
+    // An L shape needs two pieces
+    QPolygonF lShape;
+    lShape << QPointF(0, 0) << QPointF(20, 0) << QPointF(20, 10) << QPointF(10, 10) << QPointF(10, 20) << QPointF(0, 20) << QPointF(0, 0);
+    SurveyGeometry::decomposeConvex(lShape, pieces);
+    QCOMPARE(pieces.count(), 2);
+    QVERIFY(_validDecomposition(lShape, pieces));
+
+    // Degenerate input gives nothing
+    SurveyGeometry::decomposeConvex(QPolygonF({ QPointF(0, 0), QPointF(1, 1), QPointF(0, 0) }), pieces);
+    QVERIFY(pieces.isEmpty());
+}
+
+void SurveyGeometryTest::_benchmarkClip()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    for (int i=0; i<_fixtures.count(); i++) {
+        double spacing;
+        const QPolygonF dense = _densify(_fixtures[i], kDenseVertexCount, spacing);
+        const QList<QLineF> lineList = _gridLines(dense, 30.0, spacing);
+
+        QList<QLineF> expectedLines;
+        QList<QLineF> resultLines;
+        QElapsedTimer timer;
+
+        timer.start();
+        _clipBruteForce(lineList, dense, expectedLines);
+        const qint64 bruteForceUSecs = timer.nsecsElapsed() / 1000;
+
+        timer.restart();
+        SurveyGeometry::clipParallelLines(lineList, dense, resultLines);
+        const qint64 sweepUSecs = timer.nsecsElapsed() / 1000;
+
+        // Timing is only reported, a loaded machine must not fail the run
+        QCOMPARE(resultLines, expectedLines);
+        qCInfo(UnitTestBenchmarkLog) << _fixtureNames[i] << dense.count() << "vertices" << lineList.count() << "lines";
+        qCInfo(UnitTestBenchmarkLog) << "  all edges:" << bruteForceUSecs << "us";
+        qCInfo(UnitTestBenchmarkLog) << "  sweep:" << sweepUSecs << "us";
+    }
+}
+
+void SurveyGeometryTest::_benchmarkDecompose()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    for (int i=0; i<_fixtures.count(); i++) {
+        qCInfo(UnitTestBenchmarkLog) << _fixtureNames[i];
+        for (const int vertexCount : { 100, 1000, kDenseVertexCount }) {
+            double spacing;
+            const QPolygonF dense = _densify(_fixtures[i], vertexCount, spacing);
+
+            QList<QPolygonF> pieces;
+            QElapsedTimer timer;
+            timer.start();
+            SurveyGeometry::decomposeConvex(dense, pieces);
+            const qint64 usecs = timer.nsecsElapsed() / 1000;
+
+            qCInfo(UnitTestBenchmarkLog) << "  " << dense.count() << "vertices:" << usecs << "us" << pieces.count() << "pieces";
+        }
+    }
+}
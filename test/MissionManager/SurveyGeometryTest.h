@@ -0,0 +1,53 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QtCore/QLineF>
+#include <QtGui/QPolygonF>
+
+class SurveyGeometryTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    SurveyGeometryTest() = default;
+
+protected:
+    void init() final;
+    void cleanup() final;
+
+private slots:
+    void _clipTest();
+    void _decomposeTest();
+    void _benchmarkClip();
+    void _benchmarkDecompose();
+
+private:
+    /// Loads the shapefile fixtures as closed NED polygons
+    bool _loadFixtures();
+
+    /// Replaces each edge with a zig zag so the polygon has about vertexCount vertices
+    ///     @param spacing[out] Distance between the new vertices, the zig zag is a quarter of that either side
+    static QPolygonF _densify(const QPolygonF& polygon, int vertexCount, double& spacing);
+
+    /// Survey style grid over the polygon, rotated by gridAngle degrees
+    static QList<QLineF> _gridLines(const QPolygonF& polygon, double gridAngle, double spacing);
+
+    /// Original all lines against all edges clipping, the reference for the sweep
+    static void _clipBruteForce(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines);
+
+    /// Checks the pieces are convex and cover the area of the polygon
+    static bool _validDecomposition(const QPolygonF& polygon, const QList<QPolygonF>& pieces);
+
+    QList<QPolygonF>    _fixtures;
+    QStringList         _fixtureNames;
+};
@@ -0,0 +1,427 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCTileCacheReaderPool.h"
+#include "QGCCacheTile.h"
+#include "QGCMapTasks.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QSet>
+#include <QtCore/QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtTest/QTest>
+
+QString QGCTileCacheWorkerTest::_tileHash(int x, int y, int z)
+{
+    // Same layout as UrlFactory::getTileHash
+    return QString::asprintf("%010d%08d%08d%03d", 1, x, y, z);
+}
+
+QByteArray QGCTileCacheWorkerTest::_tileBytes(const QString& hash)
+{
+    QByteArray bytes(_tileSize, Qt::Uninitialized);
+    QRandomGenerator generator(qHash(hash));
+    generator.fillRange(reinterpret_cast<quint32*>(bytes.data()), _tileSize / sizeof(quint32));
+    return bytes;
+}
+
+QList<QGCTileCacheWorkerTest::TraceTile> QGCTileCacheWorkerTest::_panZoomTrace()
+{
+    constexpr int viewWidth = 8;
+    constexpr int viewHeight = 5;
+
+    QList<TraceTile> trace;
+    auto addView = [&trace](int left, int top, int z) {
+        for (int y = top; y < top + viewHeight; y++) {
+            for (int x = left; x < left + viewWidth; x++) {
+                trace.append({ x, y, z });
+            }
+        }
+    };
+
+    int z = 16;
+    int left = 34300;
+    int top = 22900;
+    addView(left, top, z);
+
+    // Pan east, each step brings in a new column
+    for (int i = 0; i < 40; i++) {
+        left++;
+        for (int y = top; y < top + viewHeight; y++) {
+            trace.append({ left + viewWidth - 1, y, z });
+        }
+    }
+
+    // Zoom in around the view center
+    for (int i = 0; i < 3; i++) {
+        const int centerX = left + (viewWidth / 2);
+        const int centerY = top + (viewHeight / 2);
+        z++;
+        left = (centerX * 2) - (viewWidth / 2);
+        top = (centerY * 2) - (viewHeight / 2);
+        addView(left, top, z);
+    }
+
+    // Pan north, each step brings in a new row
+    for (int i = 0; i < 30; i++) {
+        top--;
+        for (int x = left; x < left + viewWidth; x++) {
+            trace.append({ x, top, z });
+        }
+    }
+
+    // Zoom out past the starting level
+    for (int i = 0; i < 4; i++) {
+        const int centerX = left + (viewWidth / 2);
+        const int centerY = top + (viewHeight / 2);
+        z--;
+        left = (centerX / 2) - (viewWidth / 2);
+        top = (centerY / 2) - (viewHeight / 2);
+        addView(left, top, z);
+    }
+
+    // And back over the same ground
+    for (qsizetype i = trace.count() - 1; i >= 0; i--) {
+        trace.append(trace[i]);
+    }
+
+    return trace;
+}
+
+bool QGCTileCacheWorkerTest::_initWorker(QGCCacheWorker& worker, const QString& path)
+{
+    _totalTiles = 0;
+    _totalsReceived = false;
+    (void) connect(&worker, &QGCCacheWorker::updateTotals, this, [this](quint32 totalTiles, quint64 totalSize, quint32 defaultTiles, quint64 defaultSize) {
+        _totalTiles = totalTiles;
+        _totalSize = totalSize;
+        _defaultTiles = defaultTiles;
+        _defaultSize = defaultSize;
+        _totalsReceived = true;
+    });
+
+    worker.setDatabaseFile(path);
+    if (!worker.enqueueTask(new QGCMapTask(QGCMapTask::taskInit))) {
+        return false;
+    }
+    return QTest::qWaitFor([this]() { return _totalsReceived; }, 5000);
+}
+
+bool QGCTileCacheWorkerTest::_saveTiles(QGCCacheWorker& worker, const QStringList& hashes, int totalTileCount)
+{
+    for (const QString& hash: hashes) {
+        if (!worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(hash, _tileBytes(hash), QStringLiteral("png"), QStringLiteral("1"))))) {
+            return false;
+        }
+    }
+    // Worker reports totals once its queue drains
+    return QTest::qWaitFor([this, totalTileCount]() { return _totalTiles == static_cast<quint32>(totalTileCount); }, 30000);
+}
+
+void QGCTileCacheWorkerTest::_testFetchFromReaderPool()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = tempDir.filePath(QStringLiteral("cache.db"));
+
+    QGCCacheWorker worker;
+    worker.setReadConnectionCount(2);
+    QVERIFY(_initWorker(worker, path));
+
+    QStringList hashes;
+    for (int i = 0; i < 50; i++) {
+        hashes.append(_tileHash(i, 0, 10));
+    }
+    QVERIFY(_saveTiles(worker, hashes, hashes.count()));
+
+    int hits = 0;
+    int misses = 0;
+    bool contentsMatch = true;
+    for (int i = 0; i < 60; i++) {
+        QGCFetchTileTask* const task = new QGCFetchTileTask(_tileHash(i, 0, 10));
+        (void) connect(task, &QGCFetchTileTask::tileFetched, this, [&hits, &contentsMatch](QGCCacheTile* tile) {
+            contentsMatch &= (tile->img() == _tileBytes(tile->hash()));
+            delete tile;
+            hits++;
+        });
+        (void) connect(task, &QGCMapTask::error, this, [&misses](QGCMapTask::TaskType, const QString&) {
+            misses++;
+        });
+        QVERIFY(worker.enqueueTask(task));
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(hits + misses, 60, 10000);
+    QCOMPARE(hits, 50);
+    QCOMPARE(misses, 10);
+    QVERIFY(contentsMatch);
+
+    // All reads went through the pool
+    QCOMPARE(worker.readerPool().fetchCount(), 60ULL);
+    QCOMPARE(worker.readerPool().hitCount(), 50ULL);
+
+    // Writer switched the cache to WAL
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(path);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec(QStringLiteral("PRAGMA journal_mode")));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toString(), QStringLiteral("wal"));
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    worker.quit();
+    QVERIFY(worker.wait());
+}
+
+void QGCTileCacheWorkerTest::_testResetWhileReading()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    QGCCacheWorker worker;
+    worker.setReadConnectionCount(2);
+    QVERIFY(_initWorker(worker, tempDir.filePath(QStringLiteral("cache.db"))));
+
+    QStringList hashes;
+    for (int i = 0; i < 50; i++) {
+        hashes.append(_tileHash(i, 0, 10));
+    }
+    QVERIFY(_saveTiles(worker, hashes, hashes.count()));
+
+    // Reset lands in the middle of a burst of reads, readers have to let go of the database and come back afterwards
+    int answered = 0;
+    bool resetCompleted = false;
+    for (int i = 0; i < 200; i++) {
+        QGCFetchTileTask* const task = new QGCFetchTileTask(hashes[i % hashes.count()]);
+        (void) connect(task, &QGCFetchTileTask::tileFetched, this, [&answered](QGCCacheTile* tile) { delete tile; answered++; });
+        (void) connect(task, &QGCMapTask::error, this, [&answered](QGCMapTask::TaskType, const QString&) { answered++; });
+        QVERIFY(worker.enqueueTask(task));
+        if (i == 100) {
+            QGCResetTask* const resetTask = new QGCResetTask();
+            (void) connect(resetTask, &QGCResetTask::resetCompleted, this, [&resetCompleted]() { resetCompleted = true; });
+            QVERIFY(worker.enqueueTask(resetTask));
+        }
+    }
+    QTRY_VERIFY_WITH_TIMEOUT(resetCompleted, 10000);
+    QTRY_COMPARE_WITH_TIMEOUT(answered, 200, 10000);
+
+    QVERIFY(_saveTiles(worker, { hashes.first() }, 1));
+    bool found = false;
+    QGCFetchTileTask* const task = new QGCFetchTileTask(hashes.first());
+    (void) connect(task, &QGCFetchTileTask::tileFetched, this, [&found](QGCCacheTile* tile) { delete tile; found = true; });
+    QVERIFY(worker.enqueueTask(task));
+    QTRY_VERIFY_WITH_TIMEOUT(found, 5000);
+
+    worker.quit();
+    QVERIFY(worker.wait());
+}
+
+void QGCTileCacheWorkerTest::_testReaderPoolGatedOnDatabase()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = tempDir.filePath(QStringLiteral("cache.db"));
+    const QString hash = _tileHash(0, 0, 10);
+
+    {
+        QGCCacheWorker worker;
+        QVERIFY(_initWorker(worker, path));
+        QVERIFY(worker.readerPool().databaseValid());
+        QVERIFY(_saveTiles(worker, { hash }, 1));
+        worker.quit();
+        QVERIFY(worker.wait());
+    }
+
+    QGCCacheReaderPool pool;
+    pool.setReaderCount(1);
+    pool.setDatabaseFile(path);
+
+    int hits = 0;
+    int misses = 0;
+    auto fetch = [this, &pool, &hits, &misses, &hash]() {
+        QGCFetchTileTask* const task = new QGCFetchTileTask(hash);
+        (void) connect(task, &QGCFetchTileTask::tileFetched, this, [&hits](QGCCacheTile* tile) { delete tile; hits++; });
+        (void) connect(task, &QGCMapTask::error, this, [&misses](QGCMapTask::TaskType, const QString&) { misses++; });
+        pool.enqueue(task);
+    };
+
+    // Tile is there, but the worker hasn't vouched for the database
+    fetch();
+    QTRY_COMPARE_WITH_TIMEOUT(misses, 1, 5000);
+    QCOMPARE(hits, 0);
+    QCOMPARE(pool.fetchCount(), 0ULL);
+
+    pool.setDatabaseValid(true);
+    fetch();
+    QTRY_COMPARE_WITH_TIMEOUT(hits, 1, 5000);
+    QCOMPARE(misses, 1);
+
+    pool.quit();
+}
+
+void QGCTileCacheWorkerTest::_testFetchPendingSave()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = tempDir.filePath(QStringLiteral("cache.db"));
+    const QString hash = _tileHash(7, 7, 14);
+
+    QGCCacheWorker worker;
+    worker.setReadConnectionCount(2);
+    QVERIFY(_initWorker(worker, path));
+
+    // Read right behind the save, long before the batch is committed
+    QVERIFY(worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(hash, _tileBytes(hash), QStringLiteral("png"), QStringLiteral("1")))));
+    bool found = false;
+    bool missed = false;
+    QGCFetchTileTask* const task = new QGCFetchTileTask(hash);
+    (void) connect(task, &QGCFetchTileTask::tileFetched, this, [&found, &hash](QGCCacheTile* tile) {
+        found = (tile->img() == _tileBytes(hash));
+        delete tile;
+    });
+    (void) connect(task, &QGCMapTask::error, this, [&missed](QGCMapTask::TaskType, const QString&) { missed = true; });
+    QVERIFY(worker.enqueueTask(task));
+    QTRY_VERIFY_WITH_TIMEOUT(found || missed, 5000);
+    QVERIFY(found);
+
+    // Quitting with the batch still pending writes it out
+    worker.quit();
+    QVERIFY(worker.wait());
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(path);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec(QStringLiteral("SELECT COUNT(*) FROM Tiles")));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), 1);
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+}
+
+void QGCTileCacheWorkerTest::_testBatchedSaves()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = tempDir.filePath(QStringLiteral("cache.db"));
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, path));
+
+    // More than one batch worth, with the last batch only going out on the flush timeout
+    QStringList hashes;
+    for (int i = 0; i < 1234; i++) {
+        hashes.append(_tileHash(i, 1, 12));
+    }
+    QVERIFY(_saveTiles(worker, hashes, hashes.count()));
+
+    // Same tile again is ignored and must not be counted twice
+    _totalsReceived = false;
+    QVERIFY(worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(hashes.first(), _tileBytes(hashes.first()), QStringLiteral("png"), QStringLiteral("1")))));
+    QTRY_VERIFY_WITH_TIMEOUT(_totalsReceived, 5000);
+    QCOMPARE(_totalTiles, static_cast<quint32>(hashes.count()));
+
+    // Totals are kept incrementally, they must match a full recount
+    QCOMPARE(_totalSize, static_cast<quint64>(hashes.count()) * _tileSize);
+    QCOMPARE(_defaultTiles, static_cast<quint32>(hashes.count()));
+    QCOMPARE(_defaultSize, _totalSize);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(path);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec(QStringLiteral("SELECT COUNT(size), SUM(size) FROM Tiles")));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toUInt(), _totalTiles);
+        QCOMPARE(query.value(1).toULongLong(), _totalSize);
+        QVERIFY(query.exec(QStringLiteral("SELECT COUNT(*) FROM SetTiles")));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toUInt(), _totalTiles);
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    worker.quit();
+    QVERIFY(worker.wait());
+}
+
+void QGCTileCacheWorkerTest::_benchmarkPanZoomTrace()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    const QList<TraceTile> trace = _panZoomTrace();
+
+    QStringList uniqueHashes;
+    QSet<QString> seen;
+    for (const TraceTile& tile: trace) {
+        const QString hash = _tileHash(tile.x, tile.y, tile.z);
+        if (!seen.contains(hash)) {
+            seen.insert(hash);
+            uniqueHashes.append(hash);
+        }
+    }
+
+    // Most of the area was cached in an earlier session, the rest comes in from the network during the replay
+    QStringList cachedHashes;
+    for (qsizetype i = 0; i < uniqueHashes.count(); i++) {
+        if ((i % 10) != 0) {
+            cachedHashes.append(uniqueHashes[i]);
+        }
+    }
+    const QSet<QString> cachedSet(cachedHashes.cbegin(), cachedHashes.cend());
+    int expectedMinHits = 0;
+    for (const TraceTile& tile: trace) {
+        if (cachedSet.contains(_tileHash(tile.x, tile.y, tile.z))) {
+            expectedMinHits++;
+        }
+    }
+
+    for (const int readConnections: { 0, QGCCacheReaderPool::defaultReaderCount() }) {
+        QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+
+        QGCCacheWorker worker;
+        worker.setReadConnectionCount(readConnections);
+        QVERIFY(_initWorker(worker, tempDir.filePath(QStringLiteral("cache.db"))));
+        QVERIFY(_saveTiles(worker, cachedHashes, cachedHashes.count()));
+
+        int answered = 0;
+        int hits = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (const TraceTile& tile: trace) {
+            const QString hash = _tileHash(tile.x, tile.y, tile.z);
+            QGCFetchTileTask* const task = new QGCFetchTileTask(hash);
+            (void) connect(task, &QGCFetchTileTask::tileFetched, this, [&answered, &hits](QGCCacheTile* cacheTile) {
+                delete cacheTile;
+                hits++;
+                answered++;
+            });
+            (void) connect(task, &QGCMapTask::error, this, [&answered, &worker, hash](QGCMapTask::TaskType, const QString&) {
+                answered++;
+                // Tile is downloaded and saved while the view keeps reading
+                (void) worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(hash, _tileBytes(hash), QStringLiteral("png"), QStringLiteral("1"))));
+            });
+            QVERIFY(worker.enqueueTask(task));
+        }
+        QTRY_COMPARE_WITH_TIMEOUT(answered, static_cast<int>(trace.count()), 60000);
+        const qint64 elapsedMSecs = timer.elapsed();
+
+        QVERIFY(hits >= expectedMinHits);
+        qCInfo(UnitTestBenchmarkLog) << "Pan/zoom trace:" << trace.count() << "requests," << hits << "hits,"
+                                     << readConnections << "read connections:" << elapsedMSecs << "ms";
+
+        worker.quit();
+        QVERIFY(worker.wait());
+    }
+}
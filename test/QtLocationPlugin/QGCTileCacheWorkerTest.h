@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCCacheWorker;
+
+class QGCTileCacheWorkerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QGCTileCacheWorkerTest() = default;
+
+private slots:
+    void _testFetchFromReaderPool();
+    void _testResetWhileReading();
+    void _testReaderPoolGatedOnDatabase();
+    void _testFetchPendingSave();
+    void _testBatchedSaves();
+    void _benchmarkPanZoomTrace();
+
+private:
+    struct TraceTile {
+        int x;
+        int y;
+        int z;
+    };
+
+    /// Tile requests of a map view panning and zooming over an area. A 8x5 tile view pans east,
+    /// zooms in, pans north, zooms out and finally pans back over the same ground.
+    static QList<TraceTile> _panZoomTrace();
+    static QString _tileHash(int x, int y, int z);
+
+    /// Starts the worker on a database in path and waits for it to be ready
+    bool _initWorker(QGCCacheWorker& worker, const QString& path);
+    /// Saves the tiles and waits until the worker has written them
+    bool _saveTiles(QGCCacheWorker& worker, const QStringList& hashes, int totalTileCount);
+    static QByteArray _tileBytes(const QString& hash);
+
+    quint32 _totalTiles = 0;
+    quint64 _totalSize = 0;
+    quint32 _defaultTiles = 0;
+    quint64 _defaultSize = 0;
+    bool _totalsReceived = false;
+
+    static constexpr int _tileSize = 16 * 1024;
+};
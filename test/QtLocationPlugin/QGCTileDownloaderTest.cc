@@ -0,0 +1,290 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileDownloaderTest.h"
+#include "QGCTileDownloader.h"
+#include "QGCTile.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkProxy>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#include <QtTest/QTest>
+
+#include <functional>
+
+namespace {
+
+/// Stand-in for a tile server. Answers "GET /z/x/y" over keep-alive HTTP/1.1 connections after a
+/// delay, so requests overlap the way they do against a real server.
+class TileServerStandIn
+{
+public:
+    /// Returns the HTTP status for a request, hit counts from 1
+    typedef std::function<int(int x, int y, int z, int hit)> StatusFunction;
+
+    TileServerStandIn()
+    {
+        (void) QObject::connect(&_server, &QTcpServer::newConnection, &_server, [this]() {
+            while (QTcpSocket *const socket = _server.nextPendingConnection()) {
+                connectionCount++;
+                (void) QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() { _readRequests(socket); });
+                (void) QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    bool listen() { return _server.listen(QHostAddress::LocalHost); }
+
+    QNetworkRequest request(int x, int y, int z) const
+    {
+        return QNetworkRequest(QUrl(QStringLiteral("http://127.0.0.1:%1/%2/%3/%4").arg(_server.serverPort()).arg(z).arg(x).arg(y)));
+    }
+
+    static QByteArray tileBody(int x, int y, int z)
+    {
+        return QStringLiteral("tile %1/%2/%3").arg(z).arg(x).arg(y).toUtf8();
+    }
+
+    int hits(int x, int y, int z) const { return _hits.value(QGCTile::pack(x, y, z)); }
+
+    int delayMSecs = 5;
+    StatusFunction status;
+
+    int connectionCount = 0;
+    int requestCount = 0;
+    int inFlight = 0;
+    int maxInFlight = 0;
+
+private:
+    void _readRequests(QTcpSocket *socket)
+    {
+        QByteArray &buffer = _buffers[socket];
+        buffer.append(socket->readAll());
+
+        qsizetype end;
+        while ((end = buffer.indexOf("\r\n\r\n")) >= 0) {
+            const QByteArray requestLine = buffer.left(buffer.indexOf("\r\n"));
+            buffer.remove(0, end + 4);
+
+            // GET /z/x/y HTTP/1.1
+            const QList<QByteArray> path = requestLine.split(' ').value(1).split('/');
+            const int z = path.value(1).toInt();
+            const int x = path.value(2).toInt();
+            const int y = path.value(3).toInt();
+            const int hit = ++_hits[QGCTile::pack(x, y, z)];
+
+            requestCount++;
+            inFlight++;
+            maxInFlight = qMax(maxInFlight, inFlight);
+
+            const int code = status ? status(x, y, z, hit) : 200;
+            QTimer::singleShot(delayMSecs, socket, [this, socket, x, y, z, code]() {
+                inFlight--;
+                const QByteArray body = (code == 200) ? tileBody(x, y, z) : QByteArrayLiteral("error");
+                QByteArray response = QStringLiteral("HTTP/1.1 %1 %2\r\n").arg(code).arg((code == 200) ? "OK" : "Error").toUtf8();
+                response += "Content-Type: application/octet-stream\r\n";
+                response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+                response += "Connection: keep-alive\r\n\r\n";
+                response += body;
+                (void) socket->write(response);
+            });
+        }
+    }
+
+    QTcpServer _server;
+    QHash<QTcpSocket*, QByteArray> _buffers;
+    QHash<quint64, int> _hits;
+};
+
+} // namespace
+
+QList<quint64> QGCTileDownloaderTest::_tiles(int count)
+{
+    QList<quint64> tiles;
+    for (int i = 0; i < count; i++) {
+        tiles.append(QGCTile::pack(34300 + (i % 20), 22900 + (i / 20), 16));
+    }
+    return tiles;
+}
+
+void QGCTileDownloaderTest::_testConcurrencyLimit()
+{
+    TileServerStandIn server;
+    QVERIFY(server.listen());
+
+    QNetworkAccessManager networkManager;
+    networkManager.setProxy(QNetworkProxy::NoProxy);
+    QGCTileDownloader downloader(&networkManager, [&server](int x, int y, int z) { return server.request(x, y, z); });
+    downloader.setMaxConcurrent(4);
+
+    QHash<quint64, QByteArray> downloaded;
+    bool finished = false;
+    (void) connect(&downloader, &QGCTileDownloader::tileDownloaded, this, [&downloaded](quint64 tile, const QByteArray &data) {
+        downloaded[tile] = data;
+    });
+    (void) connect(&downloader, &QGCTileDownloader::finished, this, [&finished]() { finished = true; });
+
+    const QList<quint64> tiles = _tiles(120);
+    downloader.enqueue(tiles);
+    QVERIFY(downloader.activeCount() <= 4);
+    QTRY_VERIFY_WITH_TIMEOUT(finished, 10000);
+
+    QCOMPARE(downloaded.count(), tiles.count());
+    for (const quint64 tile : tiles) {
+        QCOMPARE(downloaded.value(tile), TileServerStandIn::tileBody(QGCTile::packedX(tile), QGCTile::packedY(tile), QGCTile::packedZ(tile)));
+    }
+    QCOMPARE(downloader.downloadedCount(), static_cast<quint64>(tiles.count()));
+    QCOMPARE(downloader.failedCount(), 0ull);
+    QVERIFY(downloader.isIdle());
+
+    // Never more requests in flight than allowed, and connections are reused across requests
+    QVERIFY(server.maxInFlight <= 4);
+    QVERIFY(server.maxInFlight >= 2);
+    QVERIFY(server.connectionCount <= 4);
+    QCOMPARE(server.requestCount, tiles.count());
+}
+
+void QGCTileDownloaderTest::_testRetryWithBackoff()
+{
+    TileServerStandIn server;
+    QVERIFY(server.listen());
+    // Every fourth column is busy for its first two requests
+    server.status = [](int x, int, int, int hit) {
+        return (((x % 4) == 0) && (hit <= 2)) ? 503 : 200;
+    };
+
+    QNetworkAccessManager networkManager;
+    networkManager.setProxy(QNetworkProxy::NoProxy);
+    QGCTileDownloader downloader(&networkManager, [&server](int x, int y, int z) { return server.request(x, y, z); });
+    downloader.setMaxConcurrent(4);
+    downloader.setMaxRetries(3);
+    downloader.setRetryDelayMSecs(10);
+
+    int downloadedSignals = 0;
+    int failedSignals = 0;
+    bool finished = false;
+    (void) connect(&downloader, &QGCTileDownloader::tileDownloaded, this, [&downloadedSignals]() { downloadedSignals++; });
+    (void) connect(&downloader, &QGCTileDownloader::tileFailed, this, [&failedSignals]() { failedSignals++; });
+    (void) connect(&downloader, &QGCTileDownloader::finished, this, [&finished]() { finished = true; });
+
+    const QList<quint64> tiles = _tiles(40);
+    int busyTiles = 0;
+    for (const quint64 tile : tiles) {
+        if ((QGCTile::packedX(tile) % 4) == 0) {
+            busyTiles++;
+        }
+    }
+
+    downloader.enqueue(tiles);
+    QTRY_VERIFY_WITH_TIMEOUT(finished, 10000);
+
+    QCOMPARE(downloadedSignals, tiles.count());
+    QCOMPARE(failedSignals, 0);
+    QCOMPARE(downloader.retryCount(), static_cast<quint64>(busyTiles * 2));
+    QCOMPARE(server.requestCount, tiles.count() + (busyTiles * 2));
+}
+
+void QGCTileDownloaderTest::_testGiveUp()
+{
+    TileServerStandIn server;
+    QVERIFY(server.listen());
+    // Tile 0 is never available, tile 1 doesn't exist
+    server.status = [](int x, int, int, int) {
+        return (x == 0) ? 503 : ((x == 1) ? 404 : 200);
+    };
+
+    QNetworkAccessManager networkManager;
+    networkManager.setProxy(QNetworkProxy::NoProxy);
+    QGCTileDownloader downloader(&networkManager, [&server](int x, int y, int z) { return server.request(x, y, z); });
+    downloader.setMaxRetries(2);
+    downloader.setRetryDelayMSecs(10);
+
+    QList<quint64> failed;
+    bool finished = false;
+    (void) connect(&downloader, &QGCTileDownloader::tileFailed, this, [&failed](quint64 tile) { failed.append(tile); });
+    (void) connect(&downloader, &QGCTileDownloader::finished, this, [&finished]() { finished = true; });
+
+    downloader.enqueue({ QGCTile::pack(0, 0, 1), QGCTile::pack(1, 0, 1), QGCTile::pack(0, 1, 1) });
+    QTRY_VERIFY_WITH_TIMEOUT(finished, 10000);
+
+    QCOMPARE(failed.count(), 2);
+    QVERIFY(failed.contains(QGCTile::pack(0, 0, 1)));
+    QVERIFY(failed.contains(QGCTile::pack(1, 0, 1)));
+    QCOMPARE(downloader.downloadedCount(), 1ull);
+    QCOMPARE(downloader.failedCount(), 2ull);
+
+    // Retried up to the limit while busy, but a missing tile is not asked for again
+    QCOMPARE(server.hits(0, 0, 1), 3);
+    QCOMPARE(server.hits(1, 0, 1), 1);
+}
+
+void QGCTileDownloaderTest::_testStop()
+{
+    TileServerStandIn server;
+    QVERIFY(server.listen());
+    server.delayMSecs = 20;
+
+    QNetworkAccessManager networkManager;
+    networkManager.setProxy(QNetworkProxy::NoProxy);
+    QGCTileDownloader downloader(&networkManager, [&server](int x, int y, int z) { return server.request(x, y, z); });
+    downloader.setMaxConcurrent(4);
+
+    int downloadedSignals = 0;
+    (void) connect(&downloader, &QGCTileDownloader::tileDownloaded, this, [&downloader, &downloadedSignals]() {
+        if (++downloadedSignals == 1) {
+            downloader.stop();
+        }
+    });
+
+    downloader.enqueue(_tiles(200));
+    QTRY_COMPARE_WITH_TIMEOUT(downloadedSignals, 1, 10000);
+    QVERIFY(downloader.isIdle());
+
+    // Requests aborted by stop must not report back
+    QTest::qWait(200);
+    QCOMPARE(downloadedSignals, 1);
+    QVERIFY(server.requestCount < 200);
+}
+
+void QGCTileDownloaderTest::_benchmarkConcurrency()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    constexpr int tileCount = 600;
+
+    for (const int concurrent : { 1, 4, 6, 16 }) {
+        TileServerStandIn server;
+        QVERIFY(server.listen());
+        server.delayMSecs = 5;
+
+        QNetworkAccessManager networkManager;
+        networkManager.setProxy(QNetworkProxy::NoProxy);
+        QGCTileDownloader downloader(&networkManager, [&server](int x, int y, int z) { return server.request(x, y, z); });
+        downloader.setMaxConcurrent(concurrent);
+
+        bool finished = false;
+        (void) connect(&downloader, &QGCTileDownloader::finished, this, [&finished]() { finished = true; });
+
+        QElapsedTimer timer;
+        timer.start();
+        downloader.enqueue(_tiles(tileCount));
+        QTRY_VERIFY_WITH_TIMEOUT(finished, 60000);
+        const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+
+        QCOMPARE(downloader.downloadedCount(), static_cast<quint64>(tileCount));
+        // QNetworkAccessManager caps plain HTTP/1.1 at 6 connections per host
+        qCInfo(UnitTestBenchmarkLog) << "Concurrent:" << concurrent << "tiles:" << tileCount << "ms:" << elapsed
+                                     << "tiles/s:" << ((tileCount * 1000) / elapsed) << "max in flight:" << server.maxInFlight
+                                     << "connections:" << server.connectionCount;
+    }
+}
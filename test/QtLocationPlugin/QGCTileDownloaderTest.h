@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCTileDownloaderTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QGCTileDownloaderTest() = default;
+
+private slots:
+    void _testConcurrencyLimit();
+    void _testRetryWithBackoff();
+    void _testGiveUp();
+    void _testStop();
+    void _benchmarkConcurrency();
+
+private:
+    static QList<quint64> _tiles(int count);
+};
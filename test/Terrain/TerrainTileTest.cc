@@ -0,0 +1,303 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+#include "TerrainTile.h"
+#include "TerrainTileCache.h"
+#include "TerrainTileManager.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QThread>
+#include <QtTest/QTest>
+
+#include <atomic>
+
+QByteArray TerrainTileTest::_buildTile(int gridSize)
+{
+    QJsonArray carpet;
+    for (int row = 0; row < gridSize; row++) {
+        QJsonArray rowArray;
+        for (int col = 0; col < gridSize; col++) {
+            rowArray.append(row * gridSize + col);
+        }
+        carpet.append(rowArray);
+    }
+
+    const int maxValue = (gridSize * gridSize) - 1;
+    const QJsonObject data {
+        { "bounds", QJsonObject {
+              { "sw", QJsonArray { _swLat, _swLon } },
+              { "ne", QJsonArray { _swLat + TerrainTile::tileSizeDegrees, _swLon + TerrainTile::tileSizeDegrees } } } },
+        { "stats", QJsonObject { { "min", 0 }, { "max", maxValue }, { "avg", maxValue / 2.0 } } },
+        { "carpet", carpet },
+    };
+    const QJsonObject root { { "status", "success" }, { "data", data } };
+
+    return TerrainTile::serializeFromAirMapJson(QJsonDocument(root).toJson());
+}
+
+void TerrainTileTest::_testCellCenters()
+{
+    static constexpr int gridSize = 10;
+    const TerrainTile tile(_buildTile(gridSize));
+    QVERIFY(tile.isValid());
+
+    const double cellSize = TerrainTile::tileSizeDegrees / gridSize;
+    for (int row = 0; row < gridSize; row++) {
+        for (int col = 0; col < gridSize; col++) {
+            const QGeoCoordinate center(_swLat + (row + 0.5) * cellSize, _swLon + (col + 0.5) * cellSize);
+            QVERIFY(qAbs(tile.elevation(center) - (row * gridSize + col)) < 1e-6);
+        }
+    }
+}
+
+void TerrainTileTest::_testBilinear()
+{
+    static constexpr int gridSize = 10;
+    const TerrainTile tile(_buildTile(gridSize));
+    QVERIFY(tile.isValid());
+
+    const double cellSize = TerrainTile::tileSizeDegrees / gridSize;
+
+    // Half way between four cell centers is the average of the four values
+    const QGeoCoordinate corner(_swLat + 4 * cellSize, _swLon + 6 * cellSize);
+    const double expected = ((3 * gridSize + 5) + (3 * gridSize + 6) + (4 * gridSize + 5) + (4 * gridSize + 6)) / 4.0;
+    QVERIFY(qAbs(tile.elevation(corner) - expected) < 1e-6);
+
+    // A quarter of the way east between two centers
+    const QGeoCoordinate quarter(_swLat + 2.5 * cellSize, _swLon + 1.75 * cellSize);
+    QVERIFY(qAbs(tile.elevation(quarter) - (2 * gridSize + 1.25)) < 1e-6);
+
+    // Outside the ring of cell centers values are clamped to the edge
+    QVERIFY(qAbs(tile.elevation(QGeoCoordinate(_swLat, _swLon)) - 0) < 1e-6);
+    const double nearNorthEast = TerrainTile::tileSizeDegrees - 1e-9;
+    QVERIFY(qAbs(tile.elevation(QGeoCoordinate(_swLat + nearNorthEast, _swLon + nearNorthEast)) - (gridSize * gridSize - 1)) < 1e-6);
+}
+
+void TerrainTileTest::_testOutsideTile()
+{
+    const TerrainTile tile(_buildTile(10));
+    QVERIFY(tile.isValid());
+
+    QVERIFY(qIsNaN(tile.elevation(QGeoCoordinate(_swLat - 0.001, _swLon))));
+    QVERIFY(qIsNaN(tile.elevation(QGeoCoordinate(_swLat, _swLon + 0.011))));
+    QVERIFY(!tile.contains(_swLat - 0.001, _swLon));
+    QVERIFY(tile.contains(_swLat + 0.005, _swLon + 0.005));
+
+    const TerrainTile invalidTile;
+    QVERIFY(!invalidTile.isValid());
+    const QList<double> elevations = invalidTile.elevations(QList<QGeoCoordinate>{ QGeoCoordinate(_swLat, _swLon) });
+    QCOMPARE(elevations.count(), 1);
+    QVERIFY(qIsNaN(elevations[0]));
+}
+
+void TerrainTileTest::_testBatchMatchesSingle()
+{
+    static constexpr int gridSize = 36;
+    const TerrainTile tile(_buildTile(gridSize));
+    QVERIFY(tile.isValid());
+
+    QRandomGenerator random(1234);
+    QList<QGeoCoordinate> coordinates;
+    for (int i = 0; i < 1000; i++) {
+        coordinates.append(QGeoCoordinate(_swLat + random.generateDouble() * 0.0104 - 0.0002, _swLon + random.generateDouble() * 0.0104 - 0.0002));
+    }
+
+    const QList<double> batch = tile.elevations(coordinates);
+    QCOMPARE(batch.count(), coordinates.count());
+    for (int i = 0; i < coordinates.count(); i++) {
+        const double single = tile.elevation(coordinates[i]);
+        if (qIsNaN(single)) {
+            QVERIFY(qIsNaN(batch[i]));
+        } else {
+            QCOMPARE(batch[i], single);
+        }
+    }
+}
+
+/// Compares a per coordinate lookup loop against the batch kernel for 100k points within one tile
+void TerrainTileTest::_benchmark100kPoints()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int pointCount = 100000;
+    static constexpr int gridSize = 36;
+    const TerrainTile tile(_buildTile(gridSize));
+    QVERIFY(tile.isValid());
+
+    QRandomGenerator random(4321);
+    QList<QGeoCoordinate> coordinates;
+    std::vector<double> latitudes(pointCount);
+    std::vector<double> longitudes(pointCount);
+    for (int i = 0; i < pointCount; i++) {
+        latitudes[i] = _swLat + random.generateDouble() * TerrainTile::tileSizeDegrees;
+        longitudes[i] = _swLon + random.generateDouble() * TerrainTile::tileSizeDegrees;
+        coordinates.append(QGeoCoordinate(latitudes[i], longitudes[i]));
+    }
+
+    QElapsedTimer timer;
+
+    timer.start();
+    double singleSum = 0;
+    for (const QGeoCoordinate& coordinate: coordinates) {
+        singleSum += tile.elevation(coordinate);
+    }
+    const qint64 singleNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    timer.restart();
+    const QList<double> listElevations = tile.elevations(coordinates);
+    const qint64 listNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    std::vector<double> elevations(pointCount);
+    timer.restart();
+    tile.elevations(latitudes.data(), longitudes.data(), elevations.data(), pointCount);
+    const qint64 batchNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    double batchSum = 0;
+    for (const double elevation: elevations) {
+        batchSum += elevation;
+    }
+    QVERIFY(qAbs(singleSum - batchSum) < 1e-3);
+    QCOMPARE(listElevations.count(), pointCount);
+
+    qCInfo(UnitTestBenchmarkLog) << "TerrainTile" << pointCount << "points";
+    qCInfo(UnitTestBenchmarkLog) << "  elevation() per point:" << (singleNsecs / pointCount) << "ns/point";
+    qCInfo(UnitTestBenchmarkLog) << "  elevations(list):" << (listNsecs / pointCount) << "ns/point";
+    qCInfo(UnitTestBenchmarkLog) << "  elevations(arrays):" << (batchNsecs / pointCount) << "ns/point"
+                                 << "speedup:" << (static_cast<double>(singleNsecs) / batchNsecs);
+}
+
+void TerrainTileTest::_testCacheHitMiss()
+{
+    const TerrainTile tile(_buildTile(10));
+    TerrainTileCache cache;
+
+    const quint64 key = TerrainTileCache::tileKey(18800, 13700, 1);
+    QVERIFY(key != TerrainTileCache::tileKey(13700, 18800, 1));
+    QCOMPARE(TerrainTileCache::tileX(key), 18800);
+    QCOMPARE(TerrainTileCache::tileY(key), 13700);
+
+    QVERIFY(!cache.find(key));
+    cache.insert(key, tile);
+    const TerrainTileCache::SharedTile found = cache.find(key);
+    QVERIFY(found);
+    QVERIFY(found->isValid());
+    QCOMPARE(found->elevation(QGeoCoordinate(_swLat + 0.0005, _swLon + 0.0005)), tile.elevation(QGeoCoordinate(_swLat + 0.0005, _swLon + 0.0005)));
+
+    QCOMPARE(cache.hitCount(), static_cast<quint64>(1));
+    QCOMPARE(cache.missCount(), static_cast<quint64>(1));
+    QCOMPARE(cache.tileCount(), 1);
+    QVERIFY(cache.totalBytes() >= tile.dataSize());
+
+    // Replacing an entry doesn't double count its size
+    const qint64 bytes = cache.totalBytes();
+    cache.insert(key, tile);
+    QCOMPARE(cache.totalBytes(), bytes);
+    QCOMPARE(cache.tileCount(), 1);
+
+    cache.clear();
+    QCOMPARE(cache.tileCount(), 0);
+    QCOMPARE(cache.totalBytes(), static_cast<qint64>(0));
+}
+
+void TerrainTileTest::_testCacheEviction()
+{
+    const TerrainTile tile(_buildTile(36));
+    const qint64 tileBytes = static_cast<qint64>(sizeof(TerrainTile)) + tile.dataSize();
+
+    // Room for roughly 100 tiles in total
+    TerrainTileCache cache(tileBytes * 100);
+
+    const quint64 hotKey = TerrainTileCache::tileKey(0, 0, 1);
+    cache.insert(hotKey, tile);
+    for (int i = 1; i < 1000; i++) {
+        cache.insert(TerrainTileCache::tileKey(i, i, 1), tile);
+        // Keep one tile in constant use, it must survive eviction
+        QVERIFY(cache.find(hotKey));
+    }
+
+    QVERIFY(cache.evictionCount() > 0);
+    QVERIFY(cache.totalBytes() <= cache.maxBytes());
+    QVERIFY(cache.tileCount() < 1000);
+    QVERIFY(cache.contains(hotKey));
+
+    // A tile handed out stays usable after it is evicted
+    const quint64 lastKey = TerrainTileCache::tileKey(999, 999, 1);
+    const TerrainTileCache::SharedTile held = cache.find(lastKey);
+    QVERIFY(held);
+    cache.setMaxBytes(0);
+    QCOMPARE(cache.tileCount(), 0);
+    QVERIFY(held->isValid());
+}
+
+void TerrainTileTest::_testCacheConcurrentReaders()
+{
+    static constexpr int threadCount = 4;
+    static constexpr int lookupsPerThread = 20000;
+
+    const TerrainTile tile(_buildTile(36));
+    TerrainTileCache cache;
+    for (int i = 0; i < 64; i++) {
+        cache.insert(TerrainTileCache::tileKey(i, 0, 1), tile);
+    }
+
+    QList<QThread*> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < threadCount; t++) {
+        threads.append(QThread::create([&cache, &failures, t]() {
+            for (int i = 0; i < lookupsPerThread; i++) {
+                const int x = (i + t) % 128;
+                const TerrainTileCache::SharedTile found = cache.find(TerrainTileCache::tileKey(x, 0, 1));
+                if ((x < 64) != static_cast<bool>(found)) {
+                    failures++;
+                }
+            }
+        }));
+        threads.last()->start();
+    }
+    for (QThread* thread: threads) {
+        QVERIFY(thread->wait());
+        delete thread;
+    }
+
+    QCOMPARE(failures.load(), 0);
+    QCOMPARE(cache.hitCount() + cache.missCount(), static_cast<quint64>(threadCount * lookupsPerThread));
+}
+
+void TerrainTileTest::_testCorridorTiles()
+{
+    // Single point in the middle of a tile, no buffer
+    const QGeoCoordinate center(_swLat + 0.005, _swLon + 0.005);
+    QList<QPoint> tiles = TerrainTileManager::tilesForPath({ center }, 0);
+    QCOMPARE(tiles.count(), 1);
+    QCOMPARE(tiles[0], QPoint(18800, 13700));
+
+    // West to east across six tile columns
+    const QGeoCoordinate east(_swLat + 0.005, _swLon + 0.055);
+    tiles = TerrainTileManager::tilesForPath({ center, east }, 0);
+    QCOMPARE(tiles.count(), 6);
+    for (int x = 18800; x <= 18805; x++) {
+        QVERIFY(tiles.contains(QPoint(x, 13700)));
+    }
+
+    // A buffer wider than half a tile pulls in the rows to either side, and a column at each end
+    tiles = TerrainTileManager::tilesForPath({ center, east }, 600);
+    QCOMPARE(tiles.count(), 8 * 3);
+    for (int x = 18799; x <= 18806; x++) {
+        for (int y = 13699; y <= 13701; y++) {
+            QVERIFY(tiles.contains(QPoint(x, y)));
+        }
+    }
+
+    QVERIFY(TerrainTileManager::tilesForPath({}, 100).isEmpty());
+}
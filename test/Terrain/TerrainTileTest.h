@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TerrainTileTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TerrainTileTest() = default;
+
+private slots:
+    void _testCellCenters();
+    void _testBilinear();
+    void _testOutsideTile();
+    void _testBatchMatchesSingle();
+    void _benchmark100kPoints();
+    void _testCacheHitMiss();
+    void _testCacheEviction();
+    void _testCacheConcurrentReaders();
+    void _testCorridorTiles();
+
+private:
+    /// Builds a serialized tile with gridSize x gridSize values where value = row * gridSize + col
+    static QByteArray _buildTile(int gridSize);
+
+    static constexpr double _swLat = 47.0;
+    static constexpr double _swLon = 8.0;
+};
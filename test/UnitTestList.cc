@@ -12,8 +12,14 @@
 #include "QGCApplication.h"
 #include "QGCLoggingCategory.h"
 
+// ADSB
+#include "ADSBTargetStoreTest.h"
+#include "ADSBTCPLinkTest.h"
+#include "ADSBVehicleManagerTest.h"
+
 // AnalyzeView
 #include "ExifParserTest.h"
+#include "GeoTagWorkerTest.h"
 // #include "MavlinkLogTest.h"
 // #include "LogDownloadTest.h"
 #include "PX4LogParserTest.h"
@@ -26,16 +32,22 @@
 // #include "RadioConfigTest.h"
 
 // Comms
+#include "LogReplayIndexTest.h"
+#include "MAVLinkLogWriterTest.h"
+#include "MAVLinkProtocolTest.h"
 
 // FactSystem
+#include "FactGroupTest.h"
 #include "FactSystemTestGeneric.h"
 #include "FactSystemTestPX4.h"
+#include "ParameterCacheTest.h"
 #include "ParameterManagerTest.h"
 
 // Geo
 #include "GeoTest.h"
 
 // MAVLink
+#include "MAVLinkFrameParserTest.h"
 #include "StatusTextHandlerTest.h"
 #include "SigningTest.h"
 
@@ -60,6 +72,7 @@
 #include "SpeedSectionTest.h"
 #include "StructureScanComplexItemTest.h"
 #include "SurveyComplexItemTest.h"
+#include "SurveyGeometryTest.h"
 #include "TransectStyleComplexItemTest.h"
 // #include "VisualMissionItemTest.h"
 
@@ -72,8 +85,13 @@
 
 // QmlControls
 
+// QtLocationPlugin
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileDownloaderTest.h"
+
 // Terrain
 #include "TerrainQueryTest.h"
+#include "TerrainTileTest.h"
 
 // UI
 
@@ -90,6 +108,12 @@
 // #include "RequestMessageTest.h"
 // #include "SendMavCommandWithHandlerTest.h"
 // #include "SendMavCommandWithSignalingTest.h"
+#include "TrajectoryStoreTest.h"
+#include "VehicleMessageDispatchTest.h"
+
+// VideoManager
+#include "GstVideoReceiverTest.h"
+#include "VideoLatencyStatsTest.h"
 
 // Missing
 // #include "FlightGearUnitTest.h"
@@ -101,8 +125,14 @@ QGC_LOGGING_CATEGORY(UnitTestsLog, "qgc.test.unittestlist")
 
 int runTests(bool stress, QStringView unitTestOptions)
 {
+	// ADSB
+	UT_REGISTER_TEST(ADSBTargetStoreTest)
+	UT_REGISTER_TEST(ADSBTCPLinkTest)
+	UT_REGISTER_TEST(ADSBVehicleManagerTest)
+
 	// AnalyzeView
 	UT_REGISTER_TEST(ExifParserTest)
+	UT_REGISTER_TEST(GeoTagWorkerTest)
 	// UT_REGISTER_TEST(MavlinkLogTest)
 	// UT_REGISTER_TEST(LogDownloadTest)
 	UT_REGISTER_TEST(PX4LogParserTest)
@@ -115,16 +145,22 @@ int runTests(bool stress, QStringView unitTestOptions)
 	// UT_REGISTER_TEST(RadioConfigTest)
 
 	// Comms
+	UT_REGISTER_TEST(LogReplayIndexTest)
+	UT_REGISTER_TEST(MAVLinkLogWriterTest)
+	UT_REGISTER_TEST(MAVLinkProtocolTest)
 
 	// FactSystem
+	UT_REGISTER_TEST(FactGroupTest)
 	UT_REGISTER_TEST(FactSystemTestGeneric)
 	UT_REGISTER_TEST(FactSystemTestPX4)
+	UT_REGISTER_TEST(ParameterCacheTest)
 	UT_REGISTER_TEST(ParameterManagerTest)
 
 	// Geo
     // UT_REGISTER_TEST(GeoTest)
 
     // MAVLink
+    UT_REGISTER_TEST(MAVLinkFrameParserTest)
     UT_REGISTER_TEST(StatusTextHandlerTest)
     UT_REGISTER_TEST(SigningTest)
 
@@ -149,6 +185,7 @@ int runTests(bool stress, QStringView unitTestOptions)
 	UT_REGISTER_TEST(SpeedSectionTest)
 	UT_REGISTER_TEST(StructureScanComplexItemTest)
 	UT_REGISTER_TEST(SurveyComplexItemTest)
+	UT_REGISTER_TEST(SurveyGeometryTest)
 	UT_REGISTER_TEST(TransectStyleComplexItemTest)
 	// UT_REGISTER_TEST(VisualMissionItemTest)
 
@@ -159,8 +196,13 @@ int runTests(bool stress, QStringView unitTestOptions)
 
 	// QmlControls
 
+	// QtLocationPlugin
+	UT_REGISTER_TEST(QGCTileCacheWorkerTest)
+	UT_REGISTER_TEST(QGCTileDownloaderTest)
+
 	// Terrain
 	// UT_REGISTER_TEST(TerrainQueryTest)
+	UT_REGISTER_TEST(TerrainTileTest)
 
 	// UI
 
@@ -177,6 +219,12 @@ int runTests(bool stress, QStringView unitTestOptions)
 	// UT_REGISTER_TEST(RequestMessageTest)
 	// UT_REGISTER_TEST(SendMavCommandWithHandlerTest)
 	// UT_REGISTER_TEST(SendMavCommandWithSignalingTest)
+	UT_REGISTER_TEST(TrajectoryStoreTest)
+	UT_REGISTER_TEST(VehicleMessageDispatchTest)
+
+	// VideoManager
+	UT_REGISTER_TEST(GstVideoReceiverTest)
+	UT_REGISTER_TEST(VideoLatencyStatsTest)
 
 	// Missing
 	// UT_REGISTER_TEST(FlightGearUnitTest)
@@ -184,6 +232,8 @@ int runTests(bool stress, QStringView unitTestOptions)
 	// UT_REGISTER_TEST(SendMavCommandTest)
 	// UT_REGISTER_TEST(TCPLinkTest)
 
+	UnitTest::setStress(stress);
+
 	int result = 0;
 
     for (int i=0; i < (stress ? 20 : 1); i++) {
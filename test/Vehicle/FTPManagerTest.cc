@@ -14,6 +14,7 @@
 #include "MockLink.h"
 #include "FTPManager.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QStandardPaths>
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
@@ -125,6 +126,88 @@ void FTPManagerTest::_testLostPackets(void)
     _disconnectMockLink();
 }
 
+/// Downloads a file through a link which loses and delays responses
+///     @param bytesPerSecond (optional) Returns the throughput measured by FTPManager
+///     @param rttMSecs (optional) Returns the round trip time measured by FTPManager
+void FTPManagerTest::_lossyDownloadWorker(int fileSize, int lossPercent, int latencyMSecs, int maxOutstandingReads, double* bytesPerSecond, double* rttMSecs)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    QString     filename    = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(fileSize);
+
+    QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+
+    _mockLink->mockLinkFTP()->setResponseLossPercent(lossPercent);
+    _mockLink->mockLinkFTP()->setResponseLatencyMSecs(latencyMSecs);
+    ftpManager->setMaxOutstandingReads(maxOutstandingReads);
+    ftpManager->setMinAckTimeoutMSecs(qMax(10, 5 * latencyMSecs));
+    ftpManager->download(MAV_COMP_ID_AUTOPILOT1, filename, QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+
+    QCOMPARE(spyDownloadComplete.wait(60000), true);
+    QCOMPARE(spyDownloadComplete.count(), 1);
+
+    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    QList<QVariant> arguments = spyDownloadComplete.takeFirst();
+    QVERIFY(arguments[1].toString().isEmpty());
+
+    _verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
+
+    QVERIFY(ftpManager->downloadBytesPerSecond() > 0);
+    if (bytesPerSecond) {
+        *bytesPerSecond = ftpManager->downloadBytesPerSecond();
+    }
+    if (rttMSecs) {
+        *rttMSecs = ftpManager->downloadRttMSecs();
+    }
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testLossAndLatency(void)
+{
+    static constexpr int latencyMSecs = 20;
+
+    double rttMSecs = 0;
+    _lossyDownloadWorker(16 * 1024, 10 /* lossPercent */, latencyMSecs, 8 /* maxOutstandingReads */, nullptr, &rttMSecs);
+
+    // Every response is delayed, allow for timer granularity
+    QVERIFY(rttMSecs >= latencyMSecs / 2);
+}
+
+void FTPManagerTest::_testReadWindow(void)
+{
+    // Holes have to be filled correctly no matter how many reads are in flight
+    for (int maxOutstandingReads: { 1, 3, 32 }) {
+        _lossyDownloadWorker(8 * 1024, 25 /* lossPercent */, 0 /* latencyMSecs */, maxOutstandingReads);
+    }
+}
+
+/// Downloads over a lossy link with latency, with a single read of missing data in flight at a time and with
+/// the default read window
+void FTPManagerTest::_benchmarkLossAndLatency(void)
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int fileSize = 64 * 1024;
+    static constexpr int latencyMSecs = 20;
+
+    qCInfo(UnitTestBenchmarkLog) << "FTPManager download" << fileSize << "bytes" << latencyMSecs << "ms latency";
+    for (int lossPercent: { 0, 5, 15 }) {
+        for (int maxOutstandingReads: { 1, 8 }) {
+            QElapsedTimer timer;
+            timer.start();
+
+            double bytesPerSecond = 0;
+            double rttMSecs = 0;
+            _lossyDownloadWorker(fileSize, lossPercent, latencyMSecs, maxOutstandingReads, &bytesPerSecond, &rttMSecs);
+
+            qCInfo(UnitTestBenchmarkLog) << "  loss:" << lossPercent << "%" << "window:" << maxOutstandingReads
+                                         << "time:" << timer.elapsed() << "ms" << "throughput:" << qRound(bytesPerSecond / 1024.0) << "KB/s" << "rtt:" << rttMSecs << "ms";
+        }
+    }
+}
+
 void FTPManagerTest::_verifyFileSizeAndDelete(const QString& filename, int expectedSize)
 {
     QFileInfo fileInfo(filename);
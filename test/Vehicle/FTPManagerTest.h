@@ -17,6 +17,9 @@ class FTPManagerTest : public UnitTest
 
 private slots:
     void _testLostPackets                               (void);
+    void _testLossAndLatency                            (void);
+    void _testReadWindow                                (void);
+    void _benchmarkLossAndLatency                       (void);
     void _testListDirectory                             (void);
     void _testListDirectoryNoResponse                   (void);
     void _testListDirectoryNakResponse                  (void);
@@ -39,6 +42,7 @@ private:
     void _testCaseWorker            (const TestCase_t& testCase);
     void _sizeTestCaseWorker        (int fileSize);
     void _verifyFileSizeAndDelete   (const QString& filename, int expectedSize);
+    void _lossyDownloadWorker       (int fileSize, int lossPercent, int latencyMSecs, int maxOutstandingReads, double* bytesPerSecond = nullptr, double* rttMSecs = nullptr);
 
     static const TestCase_t _rgTestCases[];
 };
@@ -0,0 +1,289 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryStoreTest.h"
+#include "TrajectoryStore.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QVariantList>
+#include <QtCore/QtMath>
+#include <QtTest/QTest>
+#include <QtXml/QDomDocument>
+
+#include <algorithm>
+
+namespace {
+
+constexpr double metersPerDegree = 111319.49;
+const QGeoCoordinate loiterCenter(47.3977, 8.5456, 500);
+
+} // namespace
+
+QGeoCoordinate TrajectoryStoreTest::_loiterPoint(int i)
+{
+    static constexpr double radius = 150;
+
+    // 2 meter steps around the circle while the wind pushes the center east
+    const double angle = (i * 2.0) / radius;
+    const QGeoCoordinate center = loiterCenter.atDistanceAndAzimuth(i * 0.05, 90);
+    QGeoCoordinate point = center.atDistanceAndAzimuth(radius, qRadiansToDegrees(angle));
+    point.setAltitude(loiterCenter.altitude() + (10 * qSin(angle / 7)));
+    return point;
+}
+
+double TrajectoryStoreTest::_pathError(const TrajectoryStore& store, int level)
+{
+    const double longitudeScale = metersPerDegree * qCos(qDegreesToRadians(loiterCenter.latitude()));
+    const auto x = [&](int index) { return (store.longitude(index) - loiterCenter.longitude()) * longitudeScale; };
+    const auto y = [&](int index) { return (store.latitude(index) - loiterCenter.latitude()) * metersPerDegree; };
+
+    // Every stored point lies between two consecutive path points
+    double maxError = 0;
+    for (int pathIndex = 1; pathIndex < store.pathSize(level); pathIndex++) {
+        const int first = store.pathPointIndex(level, pathIndex - 1);
+        const int last = store.pathPointIndex(level, pathIndex);
+        const double dx = x(last) - x(first);
+        const double dy = y(last) - y(first);
+        const double lengthSquared = (dx * dx) + (dy * dy);
+        for (int index = first + 1; index < last; index++) {
+            double t = 0;
+            if (lengthSquared > 0) {
+                t = std::clamp((((x(index) - x(first)) * dx) + ((y(index) - y(first)) * dy)) / lengthSquared, 0.0, 1.0);
+            }
+            maxError = qMax(maxError, qHypot(x(index) - (x(first) + (t * dx)), y(index) - (y(first) + (t * dy))));
+        }
+    }
+    return maxError;
+}
+
+void TrajectoryStoreTest::_appendTest()
+{
+    TrajectoryStore store;
+    QVERIFY(store.isEmpty());
+
+    QVERIFY(!store.append(QGeoCoordinate(47.1, 8.1, 450), 1000));
+    QVERIFY(!store.append(QGeoCoordinate(47.2, 8.2), 2000));
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.latitude(0), 47.1);
+    QCOMPARE(store.longitude(0), 8.1);
+    QCOMPARE(store.altitude(0), 450.0f);
+    QCOMPARE(store.timeMSecs(0), 1000);
+    QCOMPARE(store.coordinate(0), QGeoCoordinate(47.1, 8.1, 450));
+    QVERIFY(qIsNaN(store.altitude(1)));
+    QCOMPARE(store.coordinate(1).type(), QGeoCoordinate::Coordinate2D);
+
+    store.replaceLast(QGeoCoordinate(47.3, 8.3, 460), 3000);
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.coordinate(1), QGeoCoordinate(47.3, 8.3, 460));
+    QCOMPARE(store.timeMSecs(1), 3000);
+
+    // Nothing is closed until a point follows a full chunk
+    for (int i = 0; i < TrajectoryStore::chunkSize - 1; i++) {
+        QVERIFY(!store.append(_loiterPoint(i), 4000 + i));
+    }
+    QCOMPARE(store.closedCount(), 0);
+    for (int level = 0; level < TrajectoryStore::levelCount; level++) {
+        QCOMPARE(store.pathSize(level), store.size());
+    }
+    QVERIFY(store.append(_loiterPoint(TrajectoryStore::chunkSize), 5000));
+    QCOMPARE(store.closedCount(), TrajectoryStore::chunkSize);
+
+    store.clear();
+    QVERIFY(store.isEmpty());
+    QCOMPARE(store.closedCount(), 0);
+    QCOMPARE(store.pathSize(TrajectoryStore::levelCount - 1), 0);
+}
+
+void TrajectoryStoreTest::_levelsTest()
+{
+    static constexpr int pointCount = 20000;
+
+    TrajectoryStore store;
+    for (int i = 0; i < pointCount; i++) {
+        (void) store.append(_loiterPoint(i), i * 100);
+    }
+    QCOMPARE(store.size(), pointCount);
+    QCOMPARE(store.compactionCount(), 0);
+
+    QCOMPARE(store.pathSize(0), pointCount);
+    for (int level = 1; level < TrajectoryStore::levelCount; level++) {
+        // Paths start and end with the track and get shorter with each level
+        QCOMPARE(store.pathPointIndex(level, 0), 0);
+        QCOMPARE(store.pathPointIndex(level, store.pathSize(level) - 1), pointCount - 1);
+        QVERIFY(store.pathSize(level) < store.pathSize(level - 1));
+
+        // Within the error of the level, with a little room for the flat projections
+        const double error = _pathError(store, level);
+        QVERIFY2(error <= (TrajectoryStore::levelError(level) * 1.01), qPrintable(QStringLiteral("level %1 error %2").arg(level).arg(error)));
+
+        // Each level only keeps points of the level below it
+        int below = 0;
+        for (int i = 0; i < store.closedPathSize(level); i++) {
+            const int index = store.pathPointIndex(level, i);
+            while (store.pathPointIndex(level - 1, below) < index) {
+                below++;
+            }
+            QCOMPARE(store.pathPointIndex(level - 1, below), index);
+        }
+    }
+
+    // The coarsest level of a 150 m loiter is still a circle, not a line
+    const double circleCount = (pointCount * 2.0) / (2 * M_PI * 150);
+    QVERIFY(store.pathSize(TrajectoryStore::levelCount - 1) > (circleCount * 3));
+}
+
+void TrajectoryStoreTest::_compactionTest()
+{
+    static constexpr int maxPoints = 4000;
+
+    TrajectoryStore store(maxPoints);
+    int maxSize = 0;
+    for (int i = 0; i < 200000; i++) {
+        (void) store.append(_loiterPoint(i), i * 100);
+        maxSize = qMax(maxSize, store.size());
+    }
+
+    QVERIFY(store.compactionCount() > 0);
+    QVERIFY(maxSize <= maxPoints);
+
+    // The newest points are kept as they are, older ones thinned out but still in order
+    QCOMPARE(store.coordinate(store.size() - 1), _loiterPoint(199999));
+    QCOMPARE(store.timeMSecs(store.size() - 1), 199999 * 100);
+    for (int i = 1; i < store.size(); i++) {
+        QVERIFY(store.timeMSecs(i) > store.timeMSecs(i - 1));
+    }
+    for (int level = 1; level < TrajectoryStore::levelCount; level++) {
+        for (int i = 1; i < store.pathSize(level); i++) {
+            QVERIFY(store.pathPointIndex(level, i) > store.pathPointIndex(level, i - 1));
+        }
+        QCOMPARE(store.pathPointIndex(level, store.pathSize(level) - 1), store.size() - 1);
+    }
+}
+
+void TrajectoryStoreTest::_levelForResolutionTest()
+{
+    QCOMPARE(TrajectoryStore::levelForResolution(0.1), 0);
+    QCOMPARE(TrajectoryStore::levelForResolution(TrajectoryStore::levelError(1)), 1);
+    QCOMPARE(TrajectoryStore::levelForResolution(TrajectoryStore::levelError(2) - 0.1), 1);
+    QCOMPARE(TrajectoryStore::levelForResolution(1000), TrajectoryStore::levelCount - 1);
+}
+
+/// Three hours of loiter at 10 Hz against the QVariantList the trajectory used to be kept in
+void TrajectoryStoreTest::_saveTest()
+{
+    // Past a chunk so closed and open points are both written, the last point has no altitude
+    static constexpr int pointCount = TrajectoryStore::chunkSize + 50;
+    static constexpr qint64 startMSecs = 1700000000123;
+
+    TrajectoryStore store;
+    for (int i = 0; i < pointCount - 1; i++) {
+        (void) store.append(_loiterPoint(i), startMSecs + (i * 250));
+    }
+    const QGeoCoordinate lastPoint = _loiterPoint(pointCount - 1);
+    (void) store.append(QGeoCoordinate(lastPoint.latitude(), lastPoint.longitude()), startMSecs + ((pointCount - 1) * 250));
+    QVERIFY(store.closedCount() > 0);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString errorString;
+
+    const QString csvFilename = dir.filePath(QStringLiteral("track.csv"));
+    QVERIFY2(store.saveToCsv(csvFilename, errorString), qPrintable(errorString));
+
+    QFile csvFile(csvFilename);
+    QVERIFY(csvFile.open(QIODevice::ReadOnly | QIODevice::Text));
+    const QStringList lines = QString::fromUtf8(csvFile.readAll()).split('\n', Qt::SkipEmptyParts);
+    QCOMPARE(static_cast<int>(lines.size()), pointCount + 1);
+    QCOMPARE(lines.first(), QStringLiteral("Time,Latitude,Longitude,Altitude"));
+    for (int i = 0; i < pointCount; i++) {
+        const QStringList fields = lines[i + 1].split(',');
+        QCOMPARE(static_cast<int>(fields.size()), 4);
+        QCOMPARE(QDateTime::fromString(fields[0], Qt::ISODateWithMs).toMSecsSinceEpoch(), store.timeMSecs(i));
+        QVERIFY(qAbs(fields[1].toDouble() - store.latitude(i)) < 1e-7);
+        QVERIFY(qAbs(fields[2].toDouble() - store.longitude(i)) < 1e-7);
+        if (qIsNaN(store.altitude(i))) {
+            QVERIFY(fields[3].isEmpty());
+        } else {
+            QVERIFY(qAbs(fields[3].toDouble() - store.altitude(i)) < 0.01);
+        }
+    }
+
+    const QString kmlFilename = dir.filePath(QStringLiteral("track.kml"));
+    QVERIFY2(store.saveToKml(kmlFilename, QStringLiteral("Document"), QStringLiteral("Track"), errorString), qPrintable(errorString));
+
+    QFile kmlFile(kmlFilename);
+    QVERIFY(kmlFile.open(QIODevice::ReadOnly));
+    QDomDocument kml;
+    QVERIFY(kml.setContent(&kmlFile));
+
+    const QDomNodeList tracks = kml.elementsByTagName(QStringLiteral("gx:Track"));
+    QCOMPARE(static_cast<int>(tracks.size()), 1);
+    const QDomElement track = tracks.at(0).toElement();
+    // Drawn at sea level otherwise, since the last point has no altitude
+    QCOMPARE(track.firstChildElement(QStringLiteral("altitudeMode")).text(), QStringLiteral("clampToGround"));
+
+    const QDomNodeList whens = track.elementsByTagName(QStringLiteral("when"));
+    const QDomNodeList coords = track.elementsByTagName(QStringLiteral("gx:coord"));
+    QCOMPARE(static_cast<int>(whens.size()), pointCount);
+    QCOMPARE(static_cast<int>(coords.size()), pointCount);
+    for (int i = 0; i < pointCount; i++) {
+        QCOMPARE(QDateTime::fromString(whens.at(i).toElement().text(), Qt::ISODateWithMs).toMSecsSinceEpoch(), store.timeMSecs(i));
+
+        const QStringList values = coords.at(i).toElement().text().split(' ');
+        QCOMPARE(static_cast<int>(values.size()), 3);
+        QVERIFY(qAbs(values[0].toDouble() - store.longitude(i)) < 1e-7);
+        QVERIFY(qAbs(values[1].toDouble() - store.latitude(i)) < 1e-7);
+        const double altitude = qIsNaN(store.altitude(i)) ? 0 : store.altitude(i);
+        QVERIFY(qAbs(values[2].toDouble() - altitude) < 0.01);
+    }
+}
+
+void TrajectoryStoreTest::_benchmarkLoiter()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    static constexpr int pointCount = 108000;
+
+    QList<QGeoCoordinate> points;
+    points.reserve(pointCount);
+    for (int i = 0; i < pointCount; i++) {
+        points.append(_loiterPoint(i));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QVariantList variantPoints;
+    for (const QGeoCoordinate& point : points) {
+        variantPoints.append(QVariant::fromValue(point));
+    }
+    const qint64 variantNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    timer.restart();
+    TrajectoryStore store;
+    for (int i = 0; i < pointCount; i++) {
+        (void) store.append(points[i], i * 100);
+    }
+    const qint64 storeNsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    QCOMPARE(variantPoints.count(), pointCount);
+    QVERIFY(store.size() <= TrajectoryStore::defaultMaxPoints);
+
+    // QVariant holds the coordinate on the heap, its private data is another allocation
+    const qint64 variantBytes = variantPoints.count() * (sizeof(QVariant) + 2 * 48);
+    const qint64 storeBytes = store.size() * static_cast<qint64>((2 * sizeof(double)) + sizeof(float) + sizeof(qint64));
+    qCInfo(UnitTestBenchmarkLog) << "Trajectory points:" << pointCount;
+    qCInfo(UnitTestBenchmarkLog) << "  QVariantList:" << (variantNsecs / pointCount) << "ns/point" << "~" << (variantBytes / 1024) << "KB";
+    qCInfo(UnitTestBenchmarkLog) << "  TrajectoryStore:" << (storeNsecs / pointCount) << "ns/point" << (storeBytes / 1024) << "KB" << "stored:" << store.size();
+    for (int level = 0; level < TrajectoryStore::levelCount; level++) {
+        qCInfo(UnitTestBenchmarkLog) << "  level" << level << "error:" << TrajectoryStore::levelError(level) << "m path points:" << store.pathSize(level);
+    }
+}
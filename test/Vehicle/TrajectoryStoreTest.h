@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QtPositioning/QGeoCoordinate>
+
+class TrajectoryStore;
+
+class TrajectoryStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TrajectoryStoreTest() = default;
+
+private slots:
+    void _appendTest();
+    void _levelsTest();
+    void _compactionTest();
+    void _levelForResolutionTest();
+    void _saveTest();
+    void _benchmarkLoiter();
+
+private:
+    /// Point i of a loiter around a slowly drifting center, a new point every 2 meters
+    static QGeoCoordinate _loiterPoint(int i);
+    /// Largest distance in meters from the stored points to the path at level
+    static double _pathError(const TrajectoryStore& store, int level);
+};
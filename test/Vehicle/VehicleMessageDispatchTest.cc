@@ -0,0 +1,146 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleMessageDispatchTest.h"
+#include "MockLink.h"
+#include "Vehicle.h"
+#include "VehicleBatteryFactGroup.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QTest>
+
+mavlink_message_t VehicleMessageDispatchTest::_gpsRawIntMessage(int32_t lat) const
+{
+    mavlink_gps_raw_int_t gpsRawInt{};
+    gpsRawInt.lat = lat;
+    gpsRawInt.lon = 85455939;
+    gpsRawInt.fix_type = GPS_FIX_TYPE_3D_FIX;
+    gpsRawInt.satellites_visible = 12;
+
+    mavlink_message_t message;
+    (void) mavlink_msg_gps_raw_int_encode(_mockLink->vehicleId(), MAV_COMP_ID_AUTOPILOT1, &message, &gpsRawInt);
+    return message;
+}
+
+mavlink_message_t VehicleMessageDispatchTest::_batteryStatusMessage(uint8_t batteryId) const
+{
+    mavlink_battery_status_t batteryStatus{};
+    batteryStatus.id = batteryId;
+    batteryStatus.current_battery = -1;
+    batteryStatus.battery_remaining = 50;
+
+    mavlink_message_t message;
+    (void) mavlink_msg_battery_status_encode(_mockLink->vehicleId(), MAV_COMP_ID_AUTOPILOT1, &message, &batteryStatus);
+    return message;
+}
+
+void VehicleMessageDispatchTest::_dispatchTableTest()
+{
+    _connectMockLinkNoInitialConnectSequence();
+    Vehicle* const vehicle = _vehicle;
+    QVERIFY(vehicle);
+
+    vehicle->_buildMessageDispatch();
+
+    // Groups only see the messages they declare, the vehicle stays last after its groups
+    const QList<FactGroup*> gpsRawIntGroups = vehicle->_messageDispatch.value(MAVLINK_MSG_ID_GPS_RAW_INT);
+    QCOMPARE(gpsRawIntGroups, QList<FactGroup*>({ vehicle->gpsFactGroup() }));
+    const QList<FactGroup*> attitudeGroups = vehicle->_messageDispatch.value(MAVLINK_MSG_ID_ATTITUDE);
+    QVERIFY(!attitudeGroups.isEmpty());
+    QCOMPARE(attitudeGroups.last(), static_cast<FactGroup*>(vehicle));
+    QVERIFY(!vehicle->_messageDispatch.contains(MAVLINK_MSG_ID_HEARTBEAT));
+
+    // Groups without message handling are never offered anything
+    for (const QList<FactGroup*>& groups : std::as_const(vehicle->_messageDispatch)) {
+        QVERIFY(!groups.contains(vehicle->terrainFactGroup()));
+        QVERIFY(!groups.contains(vehicle->clockFactGroup()));
+    }
+    QVERIFY(!vehicle->_allMessagesFactGroups.contains(vehicle->terrainFactGroup()));
+    QVERIFY(!vehicle->_allMessagesFactGroups.contains(vehicle->clockFactGroup()));
+
+    // A battery showing up mid flight is picked up with its first message
+    const int batteryCount = vehicle->batteries()->count();
+    mavlink_message_t message = _batteryStatusMessage(7);
+    vehicle->_mavlinkMessageReceived(_mockLink, message);
+    QCOMPARE(vehicle->batteries()->count(), batteryCount + 1);
+    VehicleBatteryFactGroup* battery = nullptr;
+    for (int i = 0; i < vehicle->batteries()->count(); i++) {
+        VehicleBatteryFactGroup* const group = vehicle->batteries()->value<VehicleBatteryFactGroup*>(i);
+        if (group->id()->rawValue().toInt() == 7) {
+            battery = group;
+        }
+    }
+    QVERIFY(battery);
+    QVERIFY(vehicle->_messageDispatch.value(MAVLINK_MSG_ID_BATTERY_STATUS).contains(battery));
+    QCOMPARE(battery->percentRemaining()->rawValue().toInt(), 50);
+
+    _disconnectMockLink();
+}
+
+void VehicleMessageDispatchTest::_handlerStatsTest()
+{
+    _connectMockLinkNoInitialConnectSequence();
+    Vehicle* const vehicle = _vehicle;
+    QVERIFY(vehicle);
+
+    const quint64 startCount = vehicle->messageHandlerStats(MAVLINK_MSG_ID_GPS_RAW_INT).count;
+
+    static constexpr int messageCount = 10;
+    for (int i = 0; i < messageCount; i++) {
+        mavlink_message_t message = _gpsRawIntMessage(473977418 + i);
+        vehicle->_mavlinkMessageReceived(_mockLink, message);
+    }
+
+    const Vehicle::MessageHandlerStats stats = vehicle->messageHandlerStats(MAVLINK_MSG_ID_GPS_RAW_INT);
+    QCOMPARE(stats.count, startCount + messageCount);
+    QVERIFY(stats.totalNsecs > 0);
+    QVERIFY(stats.maxNsecs > 0);
+    QVERIFY(stats.maxNsecs <= stats.totalNsecs);
+    QCOMPARE(vehicle->gpsFactGroup()->getFact(QStringLiteral("lat"))->rawValue().toDouble(), (473977418 + messageCount - 1) * 1e-7);
+
+    _disconnectMockLink();
+}
+
+/// Compares handing a message to the fact groups through the dispatch table against offering it to
+/// every group, which is what the vehicle did before.
+void VehicleMessageDispatchTest::_benchmarkDispatch()
+{
+    UT_BENCHMARK_REQUIRES_STRESS();
+
+    _connectMockLinkNoInitialConnectSequence();
+    Vehicle* const vehicle = _vehicle;
+    QVERIFY(vehicle);
+
+    static constexpr int messageCount = 200000;
+    mavlink_message_t message = _gpsRawIntMessage(473977418);
+
+    vehicle->_buildMessageDispatch();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < messageCount; i++) {
+        vehicle->_dispatchToFactGroups(message);
+    }
+    const qint64 tableNsecs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i = 0; i < messageCount; i++) {
+        for (FactGroup* factGroup : vehicle->factGroups()) {
+            factGroup->handleMessage(vehicle, message);
+        }
+        vehicle->handleMessage(vehicle, message);
+    }
+    const qint64 allGroupsNsecs = timer.nsecsElapsed();
+
+    qCInfo(UnitTestBenchmarkLog) << "Fact groups:" << (vehicle->factGroups().count() + 1) << "messages:" << messageCount;
+    qCInfo(UnitTestBenchmarkLog) << "  dispatch table:" << (tableNsecs / messageCount) << "ns/message";
+    qCInfo(UnitTestBenchmarkLog) << "  every group:" << (allGroupsNsecs / messageCount) << "ns/message";
+
+    _disconnectMockLink();
+}
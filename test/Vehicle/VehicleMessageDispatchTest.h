@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MAVLinkLib.h"
+
+class VehicleMessageDispatchTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    VehicleMessageDispatchTest() = default;
+
+private slots:
+    void _dispatchTableTest();
+    void _handlerStatsTest();
+    void _benchmarkDispatch();
+
+private:
+    mavlink_message_t _gpsRawIntMessage(int32_t lat) const;
+    mavlink_message_t _batteryStatusMessage(uint8_t batteryId) const;
+};
@@ -0,0 +1,306 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GstVideoReceiverTest.h"
+
+#include <QtTest/QTest>
+
+#ifdef QGC_GST_STREAMING
+
+#include "GstVideoReceiver.h"
+
+#include <QtCore/QList>
+
+#include <functional>
+
+static constexpr int kFrameRate = 30;
+static constexpr int kFrameCount = 150;
+static constexpr int kFrameSize = 100;
+static constexpr int kKeyframeInterval = 10;
+static constexpr unsigned kPrerollSeconds = 1;
+static constexpr int kTriggerFrame = 90;
+static constexpr int kLatencyFrameCount = 30;
+static constexpr int kDecodeUs = 5000;
+static constexpr qint64 kRenderDelayNs = 20 * GST_MSECOND;
+
+namespace {
+
+struct Frame_t {
+    int     number;     ///< Frame number from the source timestamps
+    bool    keyframe;
+};
+
+struct Context_t {
+    std::function<void()> startRecording;
+    std::function<void()> stopRecording;
+    int                 stopAfterFrames = -1;
+    int                 triggerFrame = -1;
+    QList<Frame_t>      recorded;           ///< Frames out of the valve, pre-roll and live
+    QAtomicInteger<int> endOfStream = 0;    ///< EOS reached the valve, which holds it back while closed
+};
+
+int frameNumber(GstBuffer* buf)
+{
+    return static_cast<int>(gst_util_uint64_scale_round(GST_BUFFER_PTS(buf), kFrameRate, GST_SECOND));
+}
+
+/// Flags the source buffers like an encoder with a fixed keyframe interval would
+GstPadProbeReturn keyframeProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+    Q_UNUSED(user_data)
+
+    GstBuffer* buf = gst_pad_probe_info_get_buffer(info);
+
+    if ((buf != nullptr) && ((frameNumber(buf) % kKeyframeInterval) != 0)) {
+        buf = gst_buffer_make_writable(buf);
+        GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT);
+        GST_PAD_PROBE_INFO_DATA(info) = buf;
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+/// Ahead of the receiver's own probe, starts the recording once the trigger frame reaches the valve
+GstPadProbeReturn triggerProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    Context_t* context = static_cast<Context_t*>(user_data);
+    GstBuffer* buf = gst_pad_probe_info_get_buffer(info);
+
+    if ((buf != nullptr) && (context->triggerFrame < 0) && (frameNumber(buf) >= kTriggerFrame)) {
+        context->triggerFrame = frameNumber(buf);
+        context->startRecording();
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn recordedProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    Context_t* context = static_cast<Context_t*>(user_data);
+    GstBuffer* buf = gst_pad_probe_info_get_buffer(info);
+
+    if (buf != nullptr) {
+        context->recorded.append({ frameNumber(buf), !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT) });
+
+        // From inside the flush, this deadlocks if the pre-roll is pushed with the lock held
+        if (context->recorded.count() == context->stopAfterFrames) {
+            context->stopRecording();
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn endOfStreamProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    GstEvent* event = gst_pad_probe_info_get_event(info);
+
+    if ((event != nullptr) && (GST_EVENT_TYPE(event) == GST_EVENT_EOS)) {
+        static_cast<Context_t*>(user_data)->endOfStream.storeRelease(1);
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+} // namespace
+
+#endif
+
+void GstVideoReceiverTest::_prerollHandoverTest()
+{
+    _prerollTest(-1);
+}
+
+void GstVideoReceiverTest::_prerollStopDuringFlushTest()
+{
+    _prerollTest(3);
+}
+
+void GstVideoReceiverTest::_prerollTest(int stopAfterFrames)
+{
+#ifdef QGC_GST_STREAMING
+    if (!gst_is_initialized()) {
+        GError* error = nullptr;
+        if (!gst_init_check(nullptr, nullptr, &error)) {
+            g_clear_error(&error);
+            QSKIP("GStreamer failed to initialize");
+        }
+    }
+
+    // The recorder branch of the receiver with core elements only, fakesrc stands in for the parsed stream
+    const QString description = QStringLiteral("fakesrc name=source num-buffers=%1 sizetype=fixed sizemax=%2 datarate=%3 "
+                                               "! queue ! valve name=valve drop=true ! fakesink async=false")
+                                    .arg(kFrameCount).arg(kFrameSize).arg(kFrameSize * kFrameRate);
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(description.toUtf8().constData(), &error);
+    if (error != nullptr) {
+        qWarning() << error->message;
+        g_clear_error(&error);
+    }
+    QVERIFY(pipeline != nullptr);
+
+    GstElement* source = gst_bin_get_by_name(GST_BIN(pipeline), "source");
+    GstElement* valve = gst_bin_get_by_name(GST_BIN(pipeline), "valve");
+    QVERIFY(source != nullptr);
+    QVERIFY(valve != nullptr);
+
+    GstVideoReceiver receiver;
+    receiver._recorderValve = valve;
+    receiver._prerollSeconds.storeRelaxed(kPrerollSeconds);
+
+    Context_t context;
+    context.stopAfterFrames = stopAfterFrames;
+    context.startRecording = [&receiver]() {
+        receiver._startPrerollRecording();
+    };
+    context.stopRecording = [&receiver]() {
+        receiver._stopPrerollRecording();
+    };
+
+    GstPad* sourcePad = gst_element_get_static_pad(source, "src");
+    GstPad* sinkPad = gst_element_get_static_pad(valve, "sink");
+    GstPad* srcPad = gst_element_get_static_pad(valve, "src");
+    gst_pad_add_probe(sourcePad, GST_PAD_PROBE_TYPE_BUFFER, keyframeProbe, nullptr, nullptr);
+    gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_BUFFER, triggerProbe, &context, nullptr);
+    gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_BUFFER, GstVideoReceiver::_prerollProbe, &receiver, nullptr);
+    gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, endOfStreamProbe, &context, nullptr);
+    gst_pad_add_probe(srcPad, GST_PAD_PROBE_TYPE_BUFFER, recordedProbe, &context, nullptr);
+    gst_object_unref(sourcePad);
+    gst_object_unref(sinkPad);
+    gst_object_unref(srcPad);
+
+    (void) gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    QTRY_VERIFY_WITH_TIMEOUT(context.endOfStream.loadAcquire() != 0, 30000);
+    (void) gst_element_set_state(pipeline, GST_STATE_NULL);
+
+    gboolean drop = FALSE;
+    g_object_get(valve, "drop", &drop, nullptr);
+
+    receiver._recorderValve = nullptr;
+    gst_object_unref(valve);
+    gst_object_unref(source);
+    gst_object_unref(pipeline);
+
+    QCOMPARE(context.triggerFrame, kTriggerFrame);
+    QVERIFY(!context.recorded.isEmpty());
+
+    // The file starts on a keyframe, at least the pre-roll ahead of the trigger but no more than one GOP beyond it
+    const Frame_t& first = context.recorded.first();
+    QVERIFY(first.keyframe);
+    const int prerollFrames = context.triggerFrame - first.number;
+    QVERIFY2(prerollFrames >= static_cast<int>(kPrerollSeconds * kFrameRate), qPrintable(QString::number(prerollFrames)));
+    QVERIFY2(prerollFrames <= static_cast<int>(kPrerollSeconds * kFrameRate) + kKeyframeInterval, qPrintable(QString::number(prerollFrames)));
+
+    // Pre-roll and live frames join up, no frame twice
+    for (int i = 1; i < context.recorded.count(); i++) {
+        QCOMPARE(context.recorded[i].number, context.recorded[i - 1].number + 1);
+    }
+
+    if (stopAfterFrames < 0) {
+        // Every frame through to the end
+        QCOMPARE(context.recorded.last().number, kFrameCount - 1);
+        QVERIFY(!drop);
+    } else {
+        // The rest of the pre-roll is dropped and the valve stays closed for the live frames
+        QCOMPARE(static_cast<int>(context.recorded.count()), stopAfterFrames);
+        QVERIFY(drop);
+    }
+#else
+    Q_UNUSED(stopAfterFrames)
+    QSKIP("Built without GStreamer");
+#endif
+}
+
+void GstVideoReceiverTest::_latencyTest()
+{
+#ifdef QGC_GST_STREAMING
+    if (!gst_is_initialized()) {
+        GError* error = nullptr;
+        if (!gst_init_check(nullptr, nullptr, &error)) {
+            g_clear_error(&error);
+            QSKIP("GStreamer failed to initialize");
+        }
+    }
+
+    // The decoding branch of the receiver with core elements only. The live source time stamps on arrival,
+    // the decoder is a bin with a ghost pad like decodebin3 and the synced sink holds each frame past its presentation time.
+    const QString description = QStringLiteral("fakesrc is-live=true do-timestamp=true format=time num-buffers=%1 sizetype=fixed sizemax=%2 "
+                                               "! identity name=parser ! ( identity sleep-time=%3 ) "
+                                               "! fakesink name=sink sync=true ts-offset=%4")
+                                    .arg(kLatencyFrameCount).arg(kFrameSize).arg(kDecodeUs).arg(kRenderDelayNs);
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(description.toUtf8().constData(), &error);
+    if (error != nullptr) {
+        qWarning() << error->message;
+        g_clear_error(&error);
+    }
+    QVERIFY(pipeline != nullptr);
+
+    GstElement* parser = gst_bin_get_by_name(GST_BIN(pipeline), "parser");
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    QVERIFY(parser != nullptr);
+    QVERIFY(sink != nullptr);
+
+    GstVideoReceiver receiver;
+    receiver._pipeline = pipeline;
+    receiver._latencyStatsEnabled.storeRelaxed(true);
+
+    GstPad* parserPad = gst_element_get_static_pad(parser, "src");
+    GstPad* sinkPad = gst_element_get_static_pad(sink, "sink");
+    GstPad* decoderPad = gst_pad_get_peer(sinkPad);
+    QVERIFY(decoderPad != nullptr);
+    gst_pad_add_probe(parserPad, GST_PAD_PROBE_TYPE_BUFFER, GstVideoReceiver::_teeProbe, &receiver, nullptr);
+    gst_pad_add_probe(decoderPad, GST_PAD_PROBE_TYPE_BUFFER, GstVideoReceiver::_decoderProbe, &receiver, nullptr);
+    gst_pad_add_probe(decoderPad, GST_PAD_PROBE_TYPE_IDLE, GstVideoReceiver::_renderedProbe, &receiver, nullptr);
+    gst_object_unref(parserPad);
+    gst_object_unref(sinkPad);
+    gst_object_unref(decoderPad);
+
+    (void) gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    GstBus* bus = gst_element_get_bus(pipeline);
+    GstMessage* message = gst_bus_timed_pop_filtered(bus, 30 * GST_SECOND, static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    const bool endOfStream = (message != nullptr) && (GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS);
+    if (message != nullptr) {
+        gst_message_unref(message);
+    }
+    gst_object_unref(bus);
+    (void) gst_element_set_state(pipeline, GST_STATE_NULL);
+
+    receiver._pipeline = nullptr;
+    gst_object_unref(sink);
+    gst_object_unref(parser);
+    gst_object_unref(pipeline);
+
+    QVERIFY(endOfStream);
+
+    const VideoLatencyStats::Summary_t summary = receiver._latencyStats.summary();
+    QCOMPARE(summary.frames, kLatencyFrameCount);
+    QCOMPARE(summary.droppedFrames, 0ull);
+
+    for (const VideoLatencyStats::Frame_t& frame : receiver._latencyStats.frames()) {
+        const qint64* clockNs = frame.clockNs;
+        QVERIFY(clockNs[VideoLatencyStats::StageSource] <= clockNs[VideoLatencyStats::StageParsed]);
+        QVERIFY(clockNs[VideoLatencyStats::StageParsed] + (kDecodeUs * GST_USECOND) <= clockNs[VideoLatencyStats::StageDecoded]);
+
+        // The time the sink gave the frame back, not an estimate from the timestamp. Frames arrive as they are
+        // rendered, so the sink had to wait for the presentation time plus the offset on every one.
+        QVERIFY2(clockNs[VideoLatencyStats::StageSource] + kRenderDelayNs <= clockNs[VideoLatencyStats::StageRendered],
+                 qPrintable(QString::number(clockNs[VideoLatencyStats::StageRendered] - clockNs[VideoLatencyStats::StageSource])));
+    }
+#else
+    QSKIP("Built without GStreamer");
+#endif
+}
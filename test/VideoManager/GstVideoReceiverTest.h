@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class GstVideoReceiverTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    GstVideoReceiverTest() = default;
+
+private slots:
+    void _prerollHandoverTest();
+    void _prerollStopDuringFlushTest();
+    void _latencyTest();
+
+private:
+    /// Runs a recorder branch through the receiver's pre-roll probe and checks what comes out of the valve
+    ///     @param stopAfterFrames Stop the recording from inside the pre-roll flush once this many frames are out, -1 to keep recording
+    void _prerollTest(int stopAfterFrames);
+};
@@ -0,0 +1,185 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoLatencyStatsTest.h"
+#include "VideoLatencyStats.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+static constexpr qint64 kMs = 1000000;
+
+void VideoLatencyStatsTest::_addFrame(VideoLatencyStats& stats, quint64 pts, double latencyMs)
+{
+    const qint64 source = static_cast<qint64>(pts);
+    const qint64 total = static_cast<qint64>(latencyMs * kMs);
+
+    stats.noteParsed(pts, source, source + (total / 4));
+    stats.noteDecoded(pts, source + (total / 2));
+    stats.noteRendered(pts, source + total);
+}
+
+void VideoLatencyStatsTest::_percentileTest()
+{
+    VideoLatencyStats stats;
+
+    // 1 to 100 ms, out of order
+    for (int i = 0; i < 100; i++) {
+        _addFrame(stats, (i + 1) * 33 * kMs, ((i * 37) % 100) + 1);
+    }
+
+    const VideoLatencyStats::Summary_t summary = stats.summary();
+    QCOMPARE(summary.frames, 100);
+    QCOMPARE(summary.droppedFrames, 0ull);
+    QCOMPARE(summary.medianMs, 50.0);
+    QCOMPARE(summary.p95Ms, 95.0);
+    QCOMPARE(summary.p99Ms, 99.0);
+}
+
+void VideoLatencyStatsTest::_stageTest()
+{
+    VideoLatencyStats stats;
+
+    stats.noteParsed(1000, 0, 5 * kMs);
+    stats.noteDecoded(1000, 15 * kMs);
+    stats.noteRendered(1000, 45 * kMs);
+
+    VideoLatencyStats::Summary_t summary = stats.summary();
+    QCOMPARE(summary.parseMs, 5.0);
+    QCOMPARE(summary.decodeMs, 10.0);
+    QCOMPARE(summary.renderMs, 30.0);
+    QCOMPARE(summary.medianMs, 45.0);
+
+    // Without a source time or a decoder stage the frame still completes, the missing stages take no time
+    stats.reset();
+    stats.noteParsed(2000, -1, 10 * kMs);
+    stats.noteRendered(2000, 30 * kMs);
+
+    summary = stats.summary();
+    QCOMPARE(summary.frames, 1);
+    QCOMPARE(summary.parseMs, 0.0);
+    QCOMPARE(summary.decodeMs, 20.0);
+    QCOMPARE(summary.renderMs, 0.0);
+    QCOMPARE(summary.medianMs, 20.0);
+
+    // Frames never parsed are not counted
+    stats.noteDecoded(3000, 40 * kMs);
+    stats.noteRendered(3000, 50 * kMs);
+    QCOMPARE(stats.summary().frames, 1);
+}
+
+void VideoLatencyStatsTest::_droppedTest()
+{
+    VideoLatencyStats stats;
+
+    for (quint64 pts = 1; pts <= 5; pts++) {
+        stats.noteParsed(pts, 0, 0);
+    }
+
+    // 1 and 2 were passed over by the sink
+    stats.noteRendered(3, 10 * kMs);
+    QCOMPARE(stats.summary().droppedFrames, 2ull);
+    QCOMPARE(stats.summary().frames, 1);
+
+    // 4 was passed over as well
+    stats.noteRendered(5, 10 * kMs);
+    QCOMPARE(stats.summary().droppedFrames, 3ull);
+
+    stats.reset();
+    QCOMPARE(stats.summary().droppedFrames, 0ull);
+    QCOMPARE(stats.summary().frames, 0);
+}
+
+void VideoLatencyStatsTest::_duplicateTest()
+{
+    VideoLatencyStats stats;
+
+    // A second arrival with the same timestamp does not restart the frame
+    stats.noteParsed(1000, 0, 5 * kMs);
+    stats.noteParsed(1000, 20 * kMs, 25 * kMs);
+    stats.noteDecoded(1000, 30 * kMs);
+    stats.noteRendered(1000, 40 * kMs);
+
+    const std::vector<VideoLatencyStats::Frame_t> frames = stats.frames();
+    QCOMPARE(frames.size(), static_cast<size_t>(1));
+    QCOMPARE(frames[0].clockNs[VideoLatencyStats::StageSource], 0ll);
+    QCOMPARE(frames[0].clockNs[VideoLatencyStats::StageParsed], 5 * kMs);
+    QCOMPARE(stats.summary().medianMs, 40.0);
+    QCOMPARE(stats.summary().droppedFrames, 0ull);
+
+    // The duplicate was not left in flight either
+    stats.noteParsed(2000, 50 * kMs, 50 * kMs);
+    stats.noteRendered(2000, 60 * kMs);
+    QCOMPARE(stats.summary().droppedFrames, 0ull);
+    QCOMPARE(stats.summary().frames, 2);
+}
+
+void VideoLatencyStatsTest::_jitterTest()
+{
+    VideoLatencyStats stats;
+
+    // Constant latency has no jitter
+    for (quint64 i = 1; i <= 50; i++) {
+        _addFrame(stats, i * 33 * kMs, 40);
+    }
+    QCOMPARE(stats.summary().jitterMs, 0.0);
+
+    // Alternating by 10 ms converges on 10 ms
+    for (quint64 i = 51; i <= 500; i++) {
+        _addFrame(stats, i * 33 * kMs, (i % 2) ? 40 : 50);
+    }
+    QVERIFY(qAbs(stats.summary().jitterMs - 10.0) < 0.01);
+}
+
+void VideoLatencyStatsTest::_windowTest()
+{
+    VideoLatencyStats stats(10);
+
+    for (quint64 i = 1; i <= 25; i++) {
+        _addFrame(stats, i * kMs, static_cast<double>(i));
+    }
+
+    QCOMPARE(stats.summary().frames, 10);
+
+    // Only the last 10 frames, 16 to 25 ms, oldest first
+    const std::vector<VideoLatencyStats::Frame_t> frames = stats.frames();
+    QCOMPARE(frames.size(), static_cast<size_t>(10));
+    for (size_t i = 0; i < frames.size(); i++) {
+        QCOMPARE(frames[i].pts, static_cast<quint64>((16 + i) * kMs));
+    }
+    QCOMPARE(stats.summary().medianMs, 20.0);
+}
+
+void VideoLatencyStatsTest::_csvTest()
+{
+    VideoLatencyStats stats;
+
+    stats.noteParsed(1000, 0, 5 * kMs);
+    stats.noteDecoded(1000, 15 * kMs);
+    stats.noteRendered(1000, 45 * kMs);
+    _addFrame(stats, 2000, 20);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString filename = dir.filePath(QStringLiteral("latency.csv"));
+    QVERIFY(stats.exportCsv(filename));
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    const QStringList lines = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+
+    QCOMPARE(lines.count(), 3);
+    QCOMPARE(lines[0], QString(VideoLatencyStats::csvHeader));
+    QCOMPARE(lines[1], QStringLiteral("1000,0,5000000,15000000,45000000,5,10,30,45"));
+    QCOMPARE(lines[2].split(',').count(), QString(VideoLatencyStats::csvHeader).split(',').count());
+
+    QVERIFY(!stats.exportCsv(dir.filePath(QStringLiteral("missing/latency.csv"))));
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class VideoLatencyStats;
+
+class VideoLatencyStatsTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    VideoLatencyStatsTest() = default;
+
+private slots:
+    void _percentileTest();
+    void _stageTest();
+    void _droppedTest();
+    void _duplicateTest();
+    void _jitterTest();
+    void _windowTest();
+    void _csvTest();
+
+private:
+    /// Passes a frame through every stage, arriving at pts and taking latencyMs to render
+    static void _addFrame(VideoLatencyStats& stats, quint64 pts, double latencyMs);
+};
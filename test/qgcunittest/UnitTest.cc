@@ -18,6 +18,7 @@
 #include "QGC.h"
 #include "Fact.h"
 #include "MissionItem.h"
+#include "QGCLoggingCategory.h"
 
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
@@ -33,6 +34,10 @@ QStringList UnitTest::_fileDialogResponse;
 enum UnitTest::FileDialogType UnitTest::_fileDialogExpectedType = getOpenFileName;
 int UnitTest::_missedFileDialogCount = 0;
 
+bool UnitTest::_stress = false;
+
+QGC_LOGGING_CATEGORY(UnitTestBenchmarkLog, "qgc.test.benchmark")
+
 UnitTest::UnitTest(void)
 {
 
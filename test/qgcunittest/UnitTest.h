@@ -12,6 +12,7 @@
 #include "MockLink.h"
 #include "MAVLinkLib.h"
 
+#include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMessageBox>
@@ -20,6 +21,14 @@
 #define UT_REGISTER_TEST(className)             static UnitTestWrapper<className> className(#className, false);
 #define UT_REGISTER_TEST_STANDALONE(className)  static UnitTestWrapper<className> className(#className, true);  // Test will only be run with specifically called to from command line
 
+// Benchmarks take too long for a regular test run, they only run with --unittest-stress. Results go to UnitTestBenchmarkLog.
+#define UT_BENCHMARK_REQUIRES_STRESS() \
+    if (!UnitTest::stress()) { \
+        QSKIP("Benchmark, only run with --unittest-stress"); \
+    }
+
+Q_DECLARE_LOGGING_CATEGORY(UnitTestBenchmarkLog)
+
 class QGCMessageBox;
 class QGCQFileDialog;
 class LinkManager;
@@ -78,6 +87,10 @@ public:
     bool standalone(void) const{ return _standalone; }
     void setStandalone(bool standalone) { _standalone = standalone; }
 
+    /// true: Tests are run with --unittest-stress, which also enables the benchmarks
+    static bool stress(void) { return _stress; }
+    static void setStress(bool stress) { _stress = stress; }
+
     /// @brief Adds a unit test to the list. Should only be called by UnitTestWrapper.
     static void _addTest(UnitTest* test);
 
@@ -187,6 +200,8 @@ private:
     static enum FileDialogType _fileDialogExpectedType; ///< type of file dialog expected to show
     static int          _missedFileDialogCount;         ///< Count of file dialogs not checked with call to UnitTest::fileDialogWasDisplayed
 
+    static bool         _stress;                        ///< true: Running with --unittest-stress
+
     bool _unitTestRun   = false;    ///< true: Unit Test was run
     bool _initCalled    = false;    ///< true: UnitTest::_init was called
     bool _cleanupCalled = false;    ///< true: UnitTest::_cleanup was called